@@ -0,0 +1,177 @@
+// Create/destroy heavy bullet workload for the flecs OS API allocator. Every
+// frame a burst of bullets is fired the way FireLasers does, worker stages
+// move them and queue the expired ones for deletion, and the merge applies it
+// all to the tables. The same workload runs with the C library heap and with
+// the thread caching allocator installed through ecs_os_set_api.
+//
+// The C library heap is measured through a thin wrapper that counts the
+// allocations and the peak of the requested bytes, as it has no statistics of
+// its own. The caching allocator reports its peak in whole blocks, including
+// the free blocks held by the thread caches. The allocs column counts the heap
+// calls of the measured frames, which the block allocators of flecs keep close
+// to zero once the workload is warmed up.
+#include "../Source/Components/Physics.h"
+#include "../Source/Components/Identification.h"
+#include "../Source/Components/Visuals.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace TeamYellow;
+
+struct Lifetime { int frames; };
+
+// Keeps the size of each block in front of it
+static const size_t systemHeader = 16;
+static std::atomic<long long> systemLive(0);
+static std::atomic<long long> systemPeak(0);
+
+static void* SystemTrack(void* _base, size_t _size)
+{
+	if (!_base)
+		return nullptr;
+	*static_cast<size_t*>(_base) = _size;
+	long long live = systemLive += static_cast<long long>(_size);
+	long long peak = systemPeak;
+	while (live > peak && !systemPeak.compare_exchange_weak(peak, live)) {}
+	return static_cast<char*>(_base) + systemHeader;
+}
+
+static void* SystemMalloc(ecs_size_t _size)
+{
+	ecs_os_linc(&ecs_os_api_malloc_count);
+	return SystemTrack(std::malloc(systemHeader + _size), static_cast<size_t>(_size));
+}
+
+static void* SystemCalloc(ecs_size_t _size)
+{
+	ecs_os_linc(&ecs_os_api_calloc_count);
+	return SystemTrack(std::calloc(1, systemHeader + _size), static_cast<size_t>(_size));
+}
+
+static void* SystemRealloc(void* _ptr, ecs_size_t _size)
+{
+	if (!_ptr)
+		return SystemMalloc(_size);
+	ecs_os_linc(&ecs_os_api_realloc_count);
+	char* base = static_cast<char*>(_ptr) - systemHeader;
+	size_t old = *reinterpret_cast<size_t*>(base);
+	base = static_cast<char*>(std::realloc(base, systemHeader + _size));
+	if (!base)
+		return nullptr;
+	systemLive -= static_cast<long long>(old);
+	return SystemTrack(base, static_cast<size_t>(_size));
+}
+
+static void SystemFree(void* _ptr)
+{
+	if (!_ptr)
+		return;
+	ecs_os_linc(&ecs_os_api_free_count);
+	char* base = static_cast<char*>(_ptr) - systemHeader;
+	systemLive -= static_cast<long long>(*reinterpret_cast<size_t*>(base));
+	std::free(base);
+}
+
+static void Measure(const char* _name, int _threads, int _spawnsPerFrame, int _frames)
+{
+	flecs::world world;
+	world.set_threads(_threads);
+	// components can't be registered from a stage while workers are running
+	world.component<AlliedWith>();
+	world.component<Lifetime>();
+
+	auto bullet = world.prefab()
+		.set<Velocity>({ 0, 1 })
+		.override<Position>()
+		.override<Bullet>()
+		.override<Gameobject>();
+
+	// a system without terms runs once per frame
+	world.system("Fire")
+		.iter([_spawnsPerFrame, bullet](flecs::iter& it) {
+		auto stage = it.world();
+		for (int i = 0; i < _spawnsPerFrame; ++i) {
+			stage.entity().is_a(bullet)
+				.set<Position>({ static_cast<float>(i % 90) - 45.0f, 0 })
+				.set<AlliedWith>({ PLAYER })
+				.set<Lifetime>({ 20 + i % 20 });
+		}
+	});
+	world.system<Position, const Velocity>("Move")
+		.multi_threaded()
+		.iter([](flecs::iter& it, Position* p, const Velocity* v) {
+		for (auto i : it) // velocity is shared through the prefab
+			p[i].value.y += v->value.y * it.delta_time();
+	});
+	world.system<Lifetime>("Expire")
+		.multi_threaded()
+		.iter([](flecs::iter& it, Lifetime* l) {
+		for (auto i : it)
+			if (--l[i].frames <= 0)
+				it.entity(i).destruct();
+	});
+
+	for (int i = 0; i < 60; ++i) // reach a steady state first
+		world.progress(1 / 60.0f);
+
+	int64_t mallocs = ecs_os_api_malloc_count + ecs_os_api_calloc_count + ecs_os_api_realloc_count;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < _frames; ++i)
+		world.progress(1 / 60.0f);
+	auto end = std::chrono::steady_clock::now();
+	mallocs = ecs_os_api_malloc_count + ecs_os_api_calloc_count + ecs_os_api_realloc_count - mallocs;
+
+	char peak[16], reserved[16];
+	ecs_os_alloc_stats_t stats;
+	if (ecs_os_alloc_stats_get(&stats)) {
+		std::snprintf(peak, sizeof(peak), "%.1f", stats.peak_bytes / (1024.0 * 1024.0));
+		std::snprintf(reserved, sizeof(reserved), "%.1f", stats.reserved_bytes / (1024.0 * 1024.0));
+	} else { // the C library heap maps memory on its own
+		std::snprintf(peak, sizeof(peak), "%.1f", systemPeak / (1024.0 * 1024.0));
+		std::snprintf(reserved, sizeof(reserved), "-");
+	}
+	std::printf("%-14s %8d %10d %12.4f %12lld %12s %12s\n", _name, _threads, _spawnsPerFrame,
+		std::chrono::duration<double, std::milli>(end - start).count() / _frames,
+		static_cast<long long>(mallocs), peak, reserved);
+}
+
+int main(int argc, char** argv)
+{
+	// the OS API can only be replaced before the first world is created, so
+	// every allocator is measured in a process of its own
+	if (argc < 2) {
+		std::printf("%-14s %8s %10s %12s %12s %12s %12s\n", "allocator",
+			"threads", "spawns", "frame ms", "allocs", "peak MB", "reserved MB");
+		std::fflush(stdout);
+		const char* allocators[] = { "system", "caching", "caching_huge" };
+		for (const char* allocator : allocators) {
+			std::string cmd = std::string("\"") + argv[0] + "\" " + allocator;
+			if (std::system(cmd.c_str()) != 0)
+				return 1;
+		}
+		return 0;
+	}
+
+	ecs_os_set_api_defaults();
+	ecs_os_api_t os_api = ecs_os_get_api();
+	if (std::strcmp(argv[1], "system") == 0) {
+		os_api.malloc_ = SystemMalloc;
+		os_api.calloc_ = SystemCalloc;
+		os_api.realloc_ = SystemRealloc;
+		os_api.free_ = SystemFree;
+	} else
+		ecs_os_alloc_set_api(&os_api, std::strcmp(argv[1], "caching_huge") == 0);
+	ecs_os_set_api(&os_api);
+
+	const int threadCounts[] = { 1, 4 };
+	const int spawnCounts[] = { 1000, 5000 };
+	for (int threads : threadCounts)
+		for (int count : spawnCounts)
+			Measure(argv[1], threads, count, 200);
+	std::fflush(stdout);
+	return 0;
+}
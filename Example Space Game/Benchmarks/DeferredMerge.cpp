@@ -0,0 +1,74 @@
+// Heavy spawn workload for the deferred command merge. Every frame a system
+// fires a burst of bullets from a prefab, the way FireLasers does, and a
+// cleanup system destroys the ones that expired. Some shots are cancelled in
+// the frame they are fired, so their commands never need to reach a table.
+#include "../Source/Components/Physics.h"
+#include "../Source/Components/Identification.h"
+#include "../Source/Components/Visuals.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace TeamYellow;
+
+struct Lifetime { int frames; };
+
+static void Measure(int _spawnsPerFrame, int _frames)
+{
+	flecs::world world;
+	ecs_measure_frame_time(world, true); // merge time is only recorded when measuring
+
+	auto bullet = world.prefab()
+		.set<Velocity>({ 0, 1 })
+		.override<Position>()
+		.override<Bullet>()
+		.override<Gameobject>();
+
+	// a system without terms runs once per frame
+	world.system("Spawner")
+		.iter([_spawnsPerFrame, bullet](flecs::iter& it) {
+		auto stage = it.world();
+		for (int i = 0; i < _spawnsPerFrame; ++i) {
+			auto b = stage.entity().is_a(bullet)
+				.set<Position>({ static_cast<float>(i % 90) - 45.0f, 0 })
+				.set<AlliedWith>({ PLAYER })
+				.set<Lifetime>({ 30 });
+			if (i % 8 == 0)
+				b.destruct(); // hit something right at the muzzle
+		}
+	});
+	world.system<Lifetime>("Expire")
+		.iter([](flecs::iter& it, Lifetime* l) {
+		for (auto i : it)
+			if (--l[i].frames <= 0)
+				it.entity(i).destruct();
+	});
+
+	for (int i = 0; i < 40; ++i) // reach a steady state first
+		world.progress(1 / 60.0f);
+
+	const ecs_world_info_t* info = ecs_get_world_info(world);
+	double mergeStart = info->merge_time_total;
+	int64_t discardStart = info->cmd.discard_count;
+	int64_t batchedStart = info->cmd.batched_command_count;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < _frames; ++i)
+		world.progress(1 / 60.0f);
+	auto end = std::chrono::steady_clock::now();
+
+	double mergeMs = (info->merge_time_total - mergeStart) * 1000.0 / _frames;
+	std::printf("%10d %12.4f %12.4f %12.4f %12lld %12lld\n", _spawnsPerFrame,
+		std::chrono::duration<double, std::milli>(end - start).count() / _frames,
+		mergeMs, mergeMs * 1000.0 / _spawnsPerFrame,
+		static_cast<long long>((info->cmd.batched_command_count - batchedStart) / _frames),
+		static_cast<long long>((info->cmd.discard_count - discardStart) / _frames));
+}
+
+int main()
+{
+	const int spawnCounts[] = { 1000, 10000, 50000 };
+	std::printf("%10s %12s %12s %12s %12s %12s\n",
+		"spawns", "frame ms", "merge ms", "us/spawn", "batched", "discarded");
+	for (int count : spawnCounts)
+		Measure(count, 100);
+	return 0;
+}
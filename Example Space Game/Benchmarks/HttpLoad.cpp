@@ -0,0 +1,233 @@
+// Load test for the flecs REST server. Runs the bullet workload of the
+// DeferredMerge benchmark at 60 frames per second with the REST api enabled,
+// while local clients send GET requests as fast as the game answers them.
+// Prints the requests per second and the frame time without clients, with
+// keep-alive connections and with a new connection per request.
+//
+// HttpLoad [connections] [seconds per run]
+#include "../Source/Components/Physics.h"
+#include "../Source/Components/Identification.h"
+#include "../Source/Components/Visuals.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET Socket;
+#define CloseSocket closesocket
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+typedef int Socket;
+#define INVALID_SOCKET (-1)
+#define CloseSocket close
+#endif
+
+using namespace TeamYellow;
+
+struct Lifetime { int frames; };
+
+static const uint16_t loadPort = 27790;
+
+struct RunResult
+{
+	double requestsPerSecond;
+	double frameMs;		// average time spent in progress()
+	double frameP99Ms;	// 99th percentile of the time spent in progress()
+};
+
+static Socket Connect()
+{
+	Socket sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (sock == INVALID_SOCKET)
+		return INVALID_SOCKET;
+
+	// don't hang on a reply when the run ends
+#ifdef _WIN32
+	DWORD timeout = 1000;
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+	timeval timeout = { 1, 0 };
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(loadPort);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+	{
+		CloseSocket(sock);
+		return INVALID_SOCKET;
+	}
+	return sock;
+}
+
+// Reads one reply, returns false if the connection failed or was closed before it arrived
+static bool ReadReply(Socket _sock, std::string& _buffer)
+{
+	_buffer.clear();
+	size_t headerEnd = std::string::npos;
+	size_t contentLength = 0;
+	char chunk[16 * 1024];
+	for (;;)
+	{
+		int received = static_cast<int>(recv(_sock, chunk, sizeof(chunk), 0));
+		if (received <= 0)
+			return false;
+		_buffer.append(chunk, received);
+		if (headerEnd == std::string::npos)
+		{
+			headerEnd = _buffer.find("\r\n\r\n");
+			if (headerEnd == std::string::npos)
+				continue;
+			headerEnd += 4;
+			size_t length = _buffer.find("Content-Length:");
+			if (length != std::string::npos && length < headerEnd)
+				contentLength = std::strtoull(_buffer.c_str() + length + 15, nullptr, 10);
+		}
+		if (_buffer.size() >= headerEnd + contentLength)
+			return _buffer.compare(0, 12, "HTTP/1.1 200") == 0;
+	}
+}
+
+static void Client(bool _keepAlive, const std::atomic<bool>& _run, std::atomic<long long>& _replies)
+{
+	const std::string request = _keepAlive ?
+		"GET /entity/Spawner HTTP/1.1\r\nHost: localhost\r\n\r\n" :
+		"GET /entity/Spawner HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+	std::string reply;
+	Socket sock = INVALID_SOCKET;
+	while (_run)
+	{
+		if (sock == INVALID_SOCKET && (sock = Connect()) == INVALID_SOCKET)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+		bool ok = send(sock, request.c_str(), static_cast<int>(request.size()), 0) == static_cast<int>(request.size()) &&
+			ReadReply(sock, reply);
+		if (ok)
+			++_replies;
+		// a server that doesn't keep connections open closes them after the reply
+		if (!ok || !_keepAlive || reply.find("Connection: close") != std::string::npos)
+		{
+			CloseSocket(sock);
+			sock = INVALID_SOCKET;
+		}
+	}
+	if (sock != INVALID_SOCKET)
+		CloseSocket(sock);
+}
+
+static RunResult Run(int _connections, bool _keepAlive, int _seconds)
+{
+	flecs::world world;
+	flecs::Rest rest{};
+	rest.port = loadPort;
+	world.set<flecs::Rest>(rest);
+
+	auto bullet = world.prefab()
+		.set<Velocity>({ 0, 1 })
+		.override<Position>()
+		.override<Bullet>()
+		.override<Gameobject>();
+
+	world.system("Spawner")
+		.iter([bullet](flecs::iter& it) {
+		auto stage = it.world();
+		for (int i = 0; i < 1000; ++i) {
+			auto b = stage.entity().is_a(bullet)
+				.set<Position>({ static_cast<float>(i % 90) - 45.0f, 0 })
+				.set<AlliedWith>({ PLAYER })
+				.set<Lifetime>({ 30 });
+			if (i % 8 == 0)
+				b.destruct(); // hit something right at the muzzle
+		}
+	});
+	world.system<Lifetime>("Expire")
+		.iter([](flecs::iter& it, Lifetime* l) {
+		for (auto i : it)
+			if (--l[i].frames <= 0)
+				it.entity(i).destruct();
+	});
+
+	// the first frame starts the server
+	world.progress(1 / 60.0f);
+
+	std::atomic<bool> run(true);
+	std::atomic<long long> replies(0);
+	std::vector<std::thread> clients;
+	for (int i = 0; i < _connections; ++i)
+		clients.emplace_back(Client, _keepAlive, std::cref(run), std::ref(replies));
+
+	const auto frame = std::chrono::microseconds(16667);
+	std::vector<double> frameTimes;
+	auto start = std::chrono::steady_clock::now();
+	auto next = start;
+	while (next - start < std::chrono::seconds(_seconds))
+	{
+		auto before = std::chrono::steady_clock::now();
+		world.progress(1 / 60.0f);
+		auto after = std::chrono::steady_clock::now();
+		frameTimes.push_back(std::chrono::duration<double, std::milli>(after - before).count());
+		next += frame;
+		std::this_thread::sleep_until(next);
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	long long count = replies;
+
+	run = false;
+	for (auto& client : clients)
+		client.join();
+
+	RunResult result;
+	result.requestsPerSecond = count / elapsed;
+	result.frameMs = 0;
+	for (double t : frameTimes)
+		result.frameMs += t;
+	result.frameMs /= frameTimes.size();
+	std::sort(frameTimes.begin(), frameTimes.end());
+	result.frameP99Ms = frameTimes[frameTimes.size() * 99 / 100];
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	int connections = argc > 1 ? std::atoi(argv[1]) : 50;
+	int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+#ifdef _WIN32
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+	RunResult idle = Run(0, true, seconds);
+	RunResult keepAlive = Run(connections, true, seconds);
+	RunResult reconnect = Run(connections, false, seconds);
+
+	std::printf("%12s %12s %12s %12s %12s %10s\n", "clients", "connections", "requests/s", "frame ms", "p99 ms", "overhead");
+	const char* names[] = { "none", "keep-alive", "close" };
+	const RunResult* results[] = { &idle, &keepAlive, &reconnect };
+	for (int i = 0; i < 3; ++i)
+	{
+		const RunResult& r = *results[i];
+		std::printf("%12s %12d %12.0f %12.4f %12.4f %9.1f%%\n", names[i], i ? connections : 0,
+			r.requestsPerSecond, r.frameMs, r.frameP99Ms, (r.frameMs - idle.frameMs) * 100.0 / idle.frameMs);
+	}
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+	return 0;
+}
@@ -0,0 +1,107 @@
+// Records the bullet workload of the DeferredMerge benchmark into a binary
+// flecs journal, then replays the journal into fresh worlds. Prints the cost
+// of recording (frame time with and without a journal) and how many recorded
+// operations a replay applies per second. Runs with and without a journal take
+// turns and the fastest of each is reported, as a single run is too noisy to
+// see an overhead of a few percent.
+//
+// JournalReplay [journal file]
+//   replays a journal recorded by the game (journal= in defaults.ini) instead
+//   of recording one.
+#include "../Source/Components/Physics.h"
+#include "../Source/Components/Identification.h"
+#include "../Source/Components/Visuals.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace TeamYellow;
+
+struct Lifetime { int frames; };
+
+static const char* workloadJournal = "JournalReplay.bin";
+static const int recordRuns = 5;
+
+// Runs the workload and returns the average frame time in ms
+static double Record(int _spawnsPerFrame, int _frames, const char* _journal)
+{
+	flecs::world world;
+	if (_journal && ecs_journal_open(world, _journal, 256 * 1024 * 1024) != 0)
+		return 0;
+
+	auto bullet = world.prefab()
+		.set<Velocity>({ 0, 1 })
+		.override<Position>()
+		.override<Bullet>()
+		.override<Gameobject>();
+
+	world.system("Spawner")
+		.iter([_spawnsPerFrame, bullet](flecs::iter& it) {
+		auto stage = it.world();
+		for (int i = 0; i < _spawnsPerFrame; ++i) {
+			auto b = stage.entity().is_a(bullet)
+				.set<Position>({ static_cast<float>(i % 90) - 45.0f, 0 })
+				.set<AlliedWith>({ PLAYER })
+				.set<Lifetime>({ 30 });
+			if (i % 8 == 0)
+				b.destruct(); // hit something right at the muzzle
+		}
+	});
+	world.system<Lifetime>("Expire")
+		.iter([](flecs::iter& it, Lifetime* l) {
+		for (auto i : it)
+			if (--l[i].frames <= 0)
+				it.entity(i).destruct();
+	});
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < _frames; ++i)
+		world.progress(1 / 60.0f);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count() / _frames;
+}
+
+static bool Replay(const char* _journal, int _runs)
+{
+	std::printf("%12s %12s %12s %12s %14s\n", "records", "ops", "skipped", "replay ms", "ops/sec");
+	for (int i = 0; i < _runs; ++i)
+	{
+		flecs::world world;
+		ecs_journal_replay_t result;
+		if (ecs_journal_replay(world, _journal, &result) != 0)
+			return false;
+		std::printf("%12lld %12lld %12lld %12.2f %14.0f\n",
+			static_cast<long long>(result.record_count), static_cast<long long>(result.op_count),
+			static_cast<long long>(result.skip_count), result.time_spent * 1000.0,
+			result.op_count / result.time_spent);
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+		return Replay(argv[1], 3) ? 0 : 1;
+
+	const int spawnCounts[] = { 1000, 10000 };
+	std::printf("%10s %14s %14s %10s\n", "spawns", "frame ms", "recording ms", "overhead");
+	for (int count : spawnCounts)
+	{
+		double plain = 0, recording = 0;
+		for (int i = 0; i < recordRuns; ++i)
+		{
+			double p = Record(count, 100, nullptr);
+			double r = Record(count, 100, workloadJournal);
+			plain = i ? std::min(plain, p) : p;
+			recording = i ? std::min(recording, r) : r;
+		}
+		std::printf("%10d %14.4f %14.4f %9.1f%%\n", count, plain, recording,
+			(recording - plain) * 100.0 / plain);
+	}
+	std::printf("\n");
+
+	// the journal of the last (largest) workload
+	bool ok = Replay(workloadJournal, 3);
+	std::remove(workloadJournal);
+	return ok ? 0 : 1;
+}
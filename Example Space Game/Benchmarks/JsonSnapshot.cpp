@@ -0,0 +1,108 @@
+// Serializes a world of 10000 bullets to JSON the way the debug tooling
+// snapshots it: one query result with all component values (ecs_iter_to_json),
+// every entity on its own (ecs_entity_to_json) and the raw component arrays
+// (ecs_array_to_json). The components get reflection data so that their
+// values end up in the JSON. Prints the time per snapshot and the output rate.
+//
+// JsonSnapshot [entities]
+#include "../Source/Components/Identification.h"
+#include "../Source/Components/Gameplay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace TeamYellow;
+
+// Gateware packs its vector types, which reflection can't describe, so the
+// bullets use plain copies of Position and Velocity
+struct Point { float x, y; };
+struct Motion { Point position; Point velocity; };
+
+static void Reflect(flecs::world& _world)
+{
+	_world.component<Point>()
+		.member<float>("x")
+		.member<float>("y");
+	_world.component<Motion>()
+		.member<Point>("position")
+		.member<Point>("velocity");
+	_world.component<Health>()
+		.member<int>("value");
+	_world.component<Faction>()
+		.constant("NEUTRAL", NEUTRAL)
+		.constant("PLAYER", PLAYER)
+		.constant("ENEMY", ENEMY);
+	_world.component<AlliedWith>()
+		.member<Faction>("faction");
+}
+
+template <typename Func>
+static void Report(const char* _name, int _runs, Func _snapshot)
+{
+	size_t bytes = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < _runs; ++i)
+		bytes += _snapshot();
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::printf("%-10s %14.3f %14zu %14.1f\n", _name, seconds * 1000.0 / _runs,
+		bytes / _runs, bytes / seconds / (1024.0 * 1024.0));
+}
+
+int main(int argc, char** argv)
+{
+	int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+	flecs::world world;
+	Reflect(world);
+	for (int i = 0; i < count; ++i)
+	{
+		world.entity()
+			.set<Motion>({ { static_cast<float>(i % 90) - 45.0f, i * 0.37f }, { 0, 1.5f } })
+			.set<Health>({ 100 - i % 50 })
+			.set<AlliedWith>({ i % 3 ? ENEMY : PLAYER });
+	}
+
+	auto query = world.query<Motion, Health, AlliedWith>();
+	std::printf("%-10s %14s %14s %14s\n", "snapshot", "ms", "bytes", "MB/s");
+
+	Report("query", 20, [&]() {
+		ecs_iter_t it = ecs_query_iter(world, query);
+		char* json = ecs_iter_to_json(world, &it, nullptr);
+		size_t length = std::strlen(json);
+		ecs_os_free(json);
+		return length;
+	});
+
+	Report("entities", 5, [&]() {
+		ecs_entity_to_json_desc_t desc = {};
+		desc.serialize_path = true;
+		desc.serialize_values = true;
+		size_t length = 0;
+		query.each([&](flecs::entity e, Motion&, Health&, AlliedWith&) {
+			char* json = ecs_entity_to_json(world, e, &desc);
+			length += std::strlen(json);
+			ecs_os_free(json);
+		});
+		return length;
+	});
+
+	const flecs::entity_t types[] = { world.component<Motion>().id(), world.component<Health>().id(),
+		world.component<AlliedWith>().id() };
+	Report("arrays", 20, [&]() {
+		size_t length = 0;
+		query.iter([&](flecs::iter& it, Motion* m, Health* h, AlliedWith* a) {
+			const void* columns[] = { m, h, a };
+			for (int c = 0; c < 3; ++c)
+			{
+				char* json = ecs_array_to_json(world, types[c], columns[c], static_cast<int32_t>(it.count()));
+				length += std::strlen(json);
+				ecs_os_free(json);
+			}
+		});
+		return length;
+	});
+
+	return 0;
+}
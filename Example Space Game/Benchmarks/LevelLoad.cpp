@@ -0,0 +1,155 @@
+// Loads a synthetic level of 100000 entities from a plecs file: districts of
+// buildings and waves of enemies, each with a placement, health and faction.
+// The level is loaded the way ecs_plecs_from_file used to do it (read the
+// whole file, then parse the string) and with the streaming loader, each in a
+// process of its own so that the peak heap of one doesn't hide the other.
+// Prints the load time per MB, the peak of the flecs heap and the number of
+// ecs_bulk_init calls of the streaming loader.
+//
+// LevelLoad [entities]
+#include "../Source/Components/Identification.h"
+#include "../Source/Components/Gameplay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace TeamYellow;
+
+// Gateware packs its vector types, which reflection can't describe, so the
+// level places entities with a plain struct
+struct Placement { float x, y; };
+
+static const char* levelFile = "LevelLoad.flecs";
+
+static void Reflect(flecs::world& _world)
+{
+	_world.component<Placement>()
+		.member<float>("x")
+		.member<float>("y");
+	_world.component<Health>()
+		.member<int>("value");
+	_world.component<Faction>()
+		.constant("NEUTRAL", NEUTRAL)
+		.constant("PLAYER", PLAYER)
+		.constant("ENEMY", ENEMY);
+	_world.component<AlliedWith>()
+		.member<Faction>("faction");
+	_world.component<Enemy>();
+}
+
+// Half of the entities are buildings in districts of 1000, the other half
+// enemies in waves of 500
+static size_t WriteLevel(int _count)
+{
+	FILE* file = std::fopen(levelFile, "w");
+	if (!file)
+		return 0;
+	std::fprintf(file, "using TeamYellow\n\n");
+	int buildings = _count / 2;
+	for (int i = 0; i < buildings; ++i)
+	{
+		if (i % 1000 == 0)
+			std::fprintf(file, "%sDistrict_%d {\n", i ? "}\n\n" : "", i / 1000);
+		std::fprintf(file,
+			"  // building %d\n"
+			"  Building_%d :- Placement{x: %.2f, y: %.2f},\n"
+			"    Health{value: %d}, AlliedWith{faction: NEUTRAL}\n",
+			i, i, -30.0f + (i % 7), (i % 1000) * 2.5f, 250 + i % 250);
+	}
+	if (buildings)
+		std::fprintf(file, "}\n\n");
+	for (int i = 0; i < _count - buildings; ++i)
+	{
+		if (i % 500 == 0)
+			std::fprintf(file, "%sWave_%d {\n", i ? "}\n\n" : "", i / 500);
+		std::fprintf(file,
+			"  Enemy_%d :- Placement{\n"
+			"    x: %.2f,\n"
+			"    y: %.2f\n"
+			"  }, Health{value: %d}, AlliedWith{faction: ENEMY}, Enemy\n",
+			i, (i % 90) - 45.0f, 100.0f + (i % 500) * 0.75f, 10 + i % 5);
+	}
+	if (_count - buildings)
+		std::fprintf(file, "}\n");
+	size_t bytes = static_cast<size_t>(std::ftell(file));
+	std::fclose(file);
+	return bytes;
+}
+
+// Loads the whole file in memory and parses it as a string
+static int LoadString(flecs::world& _world)
+{
+	FILE* file = std::fopen(levelFile, "r");
+	if (!file)
+		return -1;
+	std::fseek(file, 0, SEEK_END);
+	long bytes = std::ftell(file);
+	std::rewind(file);
+	char* content = static_cast<char*>(ecs_os_malloc(static_cast<ecs_size_t>(bytes) + 1));
+	size_t read = std::fread(content, 1, static_cast<size_t>(bytes), file);
+	content[read] = '\0';
+	std::fclose(file);
+	int result = ecs_plecs_from_str(_world, levelFile, content);
+	ecs_os_free(content);
+	return result;
+}
+
+static int Load(const char* _loader)
+{
+	ecs_os_set_api_defaults();
+	ecs_os_api_t os_api = ecs_os_get_api();
+	ecs_os_alloc_set_api(&os_api, false);
+	ecs_os_set_api(&os_api);
+
+	flecs::world world;
+	Reflect(world);
+	ecs_os_alloc_stats_t before;
+	ecs_os_alloc_stats_get(&before);
+
+	ecs_plecs_load_t stats = {};
+	auto start = std::chrono::steady_clock::now();
+	int result = std::strcmp(_loader, "stream") == 0 ?
+		ecs_plecs_from_file_w_stats(world, levelFile, &stats) : LoadString(world);
+	auto end = std::chrono::steady_clock::now();
+	if (result != 0)
+		return result;
+
+	ecs_os_alloc_stats_t after;
+	ecs_os_alloc_stats_get(&after);
+	FILE* file = std::fopen(levelFile, "r");
+	std::fseek(file, 0, SEEK_END);
+	double mb = std::ftell(file) / (1024.0 * 1024.0);
+	std::fclose(file);
+	double ms = std::chrono::duration<double, std::milli>(end - start).count();
+	std::printf("%-8s %10.2f %10.1f %10.1f %10.1f %12.1f %10d %10d %10d\n", _loader, mb, ms, ms / mb,
+		mb * 1000.0 / ms, (after.peak_bytes - before.live_bytes) / (1024.0 * 1024.0),
+		world.count<Placement>(), stats.buffer_size / 1024, stats.bulk_count);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	// each loader runs in a process of its own, see the top of the file
+	if (argc > 1 && (std::strcmp(argv[1], "string") == 0 || std::strcmp(argv[1], "stream") == 0))
+		return Load(argv[1]);
+
+	int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+	if (!WriteLevel(count))
+		return 1;
+
+	std::printf("%-8s %10s %10s %10s %10s %12s %10s %10s %10s\n", "loader", "MB", "ms",
+		"ms/MB", "MB/s", "peak MB", "entities", "buffer KB", "bulk");
+	std::fflush(stdout);
+	const char* loaders[] = { "string", "stream" };
+	int result = 0;
+	for (const char* loader : loaders)
+	{
+		std::string cmd = std::string("\"") + argv[0] + "\" " + loader;
+		if ((result = std::system(cmd.c_str())) != 0)
+			break;
+	}
+	std::remove(levelFile);
+	return result ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+// Looks up entities by name the way the game does in its event handlers:
+// systems by name (world.entity("Bullet System")), the player
+// (world.lookup("Player One")) and HUD labels by path
+// (world.entity("HUDCanvas::LivesText")), in a world with a few thousand other
+// named entities. Prints the time per lookup with and without the lookup cache.
+//
+// NameLookup [lookups]
+#include "../Source/Components/Identification.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace TeamYellow;
+
+static const char* systemNames[] = { "Bullet System", "Damage System", "Level System", "Bomb System",
+	"Acceleration System", "Homing System", "Translation System", "Cleanup System" };
+static const char* hudPaths[] = { "HUDCanvas::LivesText", "HUDCanvas::HiScoreText",
+	"HUDCanvas::EnemiesRemainingText", "PausedCanvas::PausedLabel", "YouWonCanvas::EndlessLabel" };
+
+static void Populate(flecs::world& _world)
+{
+	for (const char* name : systemNames)
+		_world.entity(name);
+	_world.entity("Player One");
+	for (const char* path : hudPaths)
+		_world.entity(path);
+
+	// level scenery and prefabs that share the root scope with the lookups
+	char name[64];
+	for (int i = 0; i < 4000; ++i)
+	{
+		std::snprintf(name, sizeof(name), "Level%d::Scenery%d", i / 500, i);
+		_world.entity(name);
+	}
+}
+
+template <typename Func>
+static double Measure(int _lookups, Func _lookup)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < _lookups; ++i)
+		_lookup(i);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / _lookups;
+}
+
+int main(int argc, char** argv)
+{
+	int lookups = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+	std::printf("%-10s %14s %14s %14s %10s\n", "cache", "system ns", "player ns", "hud path ns", "hits");
+	for (int cached = 0; cached < 2; ++cached)
+	{
+		flecs::world world;
+		Populate(world);
+		flecs::lookup_cache cache = world.lookup_cache();
+		cache.enable(cached != 0);
+
+		double system = Measure(lookups, [&](int i) {
+			world.entity(systemNames[i % 8]);
+		});
+		double player = Measure(lookups, [&](int) {
+			world.lookup("Player One");
+		});
+		double hud = Measure(lookups, [&](int i) {
+			world.entity(hudPaths[i % 5]);
+		});
+		std::printf("%-10s %14.1f %14.1f %14.1f %10lld\n", cached ? "on" : "off", system, player, hud,
+			static_cast<long long>(cache.hit_count()));
+	}
+	return 0;
+}
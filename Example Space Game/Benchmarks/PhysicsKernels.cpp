@@ -0,0 +1,111 @@
+// Microbenchmark comparing the per entity physics integration the game used to
+// run against the column kernels in PhysicsLogic. Runs single threaded on a
+// bare world so only the integration loops are measured.
+#include "../Source/Components/Physics.h"
+#include "../Source/Components/Identification.h"
+#include "../Source/Utils/SimdKernels.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace TeamYellow;
+
+// the integration as it was written with .each and Gateware helpers
+static void AddEachSystems(flecs::world& _world)
+{
+	_world.system<Velocity, const Acceleration>()
+		.each([](flecs::entity e, Velocity& v, const Acceleration& a) {
+		GW::MATH2D::GVECTOR2F accel;
+		GW::MATH2D::GVector2D::Scale2F(a.value, e.delta_time(), accel);
+		GW::MATH2D::GVector2D::Add2F(accel, v.value, v.value);
+	});
+	_world.system<Position, const Velocity, const PlayerPosition>()
+		.term_at(3).singleton()
+		.each([](flecs::entity e, Position& p, const Velocity& v, const PlayerPosition& player) {
+		GW::MATH2D::GVECTOR2F speed;
+		GW::MATH2D::GVector2D::Scale2F(v.value, e.delta_time(), speed);
+		if (e.has<Enemy>() && !e.has<Bullet>())
+			speed.x += (player.value.x - p.value.x) * e.delta_time() * 0.25;
+		GW::MATH2D::GVector2D::Add2F(speed, p.value, p.value);
+	});
+}
+
+// the same work as PhysicsLogic now does it, over whole columns
+static void AddColumnSystems(flecs::world& _world)
+{
+	_world.system<Velocity, const Acceleration>()
+		.iter([](flecs::iter& it, Velocity* v, const Acceleration* a) {
+		if (it.is_self(2))
+			SimdKernels::ScaleAdd(v[0].value.data, a[0].value.data, it.delta_time(), it.count() * 2);
+		else
+			SimdKernels::ScaleAddBroadcast2(v[0].value.data, a->value.data, it.delta_time(), it.count());
+	});
+	_world.system<Position, const PlayerPosition>()
+		.term_at(2).singleton()
+		.with<Velocity>()
+		.with<Enemy>()
+		.without<Bullet>()
+		.iter([](flecs::iter& it, Position* p, const PlayerPosition* player) {
+		const float pull = it.delta_time() * 0.25f;
+		for (auto i : it)
+			p[i].value.x += (player->value.x - p[i].value.x) * pull;
+	});
+	_world.system<Position, const Velocity>()
+		.iter([](flecs::iter& it, Position* p, const Velocity* v) {
+		if (it.is_self(2))
+			SimdKernels::ScaleAdd(p[0].value.data, v[0].value.data, it.delta_time(), it.count() * 2);
+		else
+			SimdKernels::ScaleAddBroadcast2(p[0].value.data, v->value.data, it.delta_time(), it.count());
+	});
+}
+
+// returns average milliseconds per frame, the checksum keeps results observable
+static double Measure(int _entityCount, bool _columns, float& _checksum)
+{
+	flecs::world world;
+	world.set<PlayerPosition>({ 0, 0 });
+	if (_columns)
+		AddColumnSystems(world);
+	else
+		AddEachSystems(world);
+
+	// a mix of bullets, enemies and neutral objects like a busy level
+	for (int i = 0; i < _entityCount; ++i) {
+		auto e = world.entity()
+			.set<Position>({ static_cast<float>(i % 90) - 45.0f, 0 })
+			.set<Velocity>({ 0, 1 })
+			.set<Acceleration>({ 0, -0.5f });
+		if (i % 4 == 0)
+			e.add<Enemy>();
+		else if (i % 4 == 1)
+			e.add<Bullet>();
+	}
+
+	const int frames = _entityCount >= 1000000 ? 20 : 100;
+	world.progress(1 / 60.0f); // warm up
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; ++i)
+		world.progress(1 / 60.0f);
+	auto end = std::chrono::steady_clock::now();
+
+	_checksum = 0;
+	world.each([&_checksum](const Position& p) { _checksum += p.value.x + p.value.y; });
+	return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+int main()
+{
+	const int entityCounts[] = { 10000, 100000, 1000000 };
+	std::printf("%10s %14s %14s %8s\n", "entities", "each ms", "columns ms", "speedup");
+	for (int count : entityCounts) {
+		float eachSum = 0, columnSum = 0;
+		double each = Measure(count, false, eachSum);
+		double columns = Measure(count, true, columnSum);
+		std::printf("%10d %14.4f %14.4f %7.2fx", count, each, columns, each / columns);
+		// both versions should land in the same place (within float rounding)
+		float diff = eachSum - columnSum;
+		if ((diff < 0 ? -diff : diff) > 1e-3f * (eachSum < 0 ? -eachSum : eachSum) + 1.0f)
+			std::printf("  (results differ: %f vs %f)", eachSum, columnSum);
+		std::printf("\n");
+	}
+	return 0;
+}
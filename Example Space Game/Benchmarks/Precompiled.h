@@ -0,0 +1,13 @@
+// The benchmarks run headless, so they only need the math half of Gateware.
+// Graphics, input, audio and shaderc stay in the game's Source/Precompiled.h
+// Popular and Fast ECS(Entity Component System) library.
+// DOC: https://www.flecs.dev/flecs/index.html
+// Included first, Gateware pulls in Xlib on Linux which defines "Bool"
+#include "../flecs-3.1.4/flecs.h"
+#define GATEWARE_ENABLE_CORE // All libraries need this
+#define GATEWARE_ENABLE_MATH // Enables all 3D Math Libraries
+#define GATEWARE_ENABLE_MATH2D // Enables all 2D Math Libraries
+// DOC: gateware-main/documentation/html/index.html
+#include "../gateware-main/Gateware.h"
+// Library for processing .ini files
+#include "../inifile-cpp-master/include/inicpp.h"
@@ -0,0 +1,107 @@
+// Compares the two ways the render queries can be sorted by meshID: order_by
+// with a comparator (quicksort per table and a comparator driven merge) and
+// order_by_key (radix sort per table and a heap merge). Entities are spread
+// over a few tables the way gameobjects, bullets and enemies are.
+#include "../Source/Components/Physics.h"
+#include "../Source/Components/Identification.h"
+#include "../Source/Components/Visuals.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace TeamYellow;
+
+struct Timings
+{
+	double firstSort;	// sort of all tables on the first iteration
+	double resort;		// average resort after 1% of the meshes changed
+	uint64_t checksum;	// keeps the iteration from being optimized away
+};
+
+static flecs::query<const StaticMeshComponent> BuildQuery(flecs::world& _world, bool _byKey)
+{
+	auto builder = _world.query_builder<const StaticMeshComponent>();
+	if (_byKey)
+		builder.order_by_key<StaticMeshComponent>([](flecs::entity_t, const StaticMeshComponent* sm) -> uint64_t {
+			return sm->meshID;
+		});
+	else
+		builder.order_by<StaticMeshComponent>([](flecs::entity_t, const StaticMeshComponent* sm1, flecs::entity_t, const StaticMeshComponent* sm2) {
+			return (sm1->meshID > sm2->meshID) - (sm1->meshID < sm2->meshID);
+		});
+	return builder.build();
+}
+
+static uint64_t Iterate(const flecs::query<const StaticMeshComponent>& _query)
+{
+	uint64_t sum = 0, last = 0;
+	_query.each([&sum, &last](const StaticMeshComponent& sm) {
+		// order sensitive so a badly sorted result shows up as a checksum difference
+		sum = sum * 31 + (sm.meshID >= last ? sm.meshID : 1000003);
+		last = sm.meshID;
+	});
+	return sum;
+}
+
+static Timings Measure(int _entityCount, bool _byKey)
+{
+	flecs::world world;
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<uint32_t> meshes(0, 255);
+
+	std::vector<flecs::entity> entities;
+	entities.reserve(_entityCount);
+	for (int i = 0; i < _entityCount; ++i) {
+		auto e = world.entity()
+			.set<Position>({ 0, 0 })
+			.set<StaticMeshComponent>({ meshes(rng) })
+			.add<Gameobject>();
+		if (i % 4 == 0)
+			e.add<Enemy>();
+		else if (i % 4 == 1)
+			e.add<Bullet>();
+		entities.push_back(e);
+	}
+
+	Timings result = {};
+	auto query = BuildQuery(world, _byKey);
+	auto start = std::chrono::steady_clock::now();
+	result.checksum = Iterate(query);
+	auto end = std::chrono::steady_clock::now();
+	result.firstSort = std::chrono::duration<double, std::milli>(end - start).count();
+
+	const int frames = _entityCount >= 1000000 ? 5 : 50;
+	const int changes = _entityCount / 100 + 1;
+	std::uniform_int_distribution<int> pick(0, _entityCount - 1);
+	double total = 0;
+	for (int f = 0; f < frames; ++f) {
+		for (int i = 0; i < changes; ++i)
+			entities[pick(rng)].set<StaticMeshComponent>({ meshes(rng) });
+		start = std::chrono::steady_clock::now();
+		result.checksum += Iterate(query);
+		end = std::chrono::steady_clock::now();
+		total += std::chrono::duration<double, std::milli>(end - start).count();
+	}
+	result.resort = total / frames;
+	return result;
+}
+
+int main()
+{
+	const int entityCounts[] = { 1000, 10000, 100000, 1000000 };
+	std::printf("%10s %12s %12s %8s %12s %12s %8s\n", "entities",
+		"cmp sort ms", "key sort ms", "speedup", "cmp re ms", "key re ms", "speedup");
+	for (int count : entityCounts) {
+		Timings cmp = Measure(count, false);
+		Timings key = Measure(count, true);
+		std::printf("%10d %12.3f %12.3f %7.2fx %12.3f %12.3f %7.2fx", count,
+			cmp.firstSort, key.firstSort, cmp.firstSort / key.firstSort,
+			cmp.resort, key.resort, cmp.resort / key.resort);
+		// entities with equal meshIDs may come out in a different order, but
+		// the sequence of meshIDs has to be the same
+		if (cmp.checksum != key.checksum)
+			std::printf("  (results differ)");
+		std::printf("\n");
+	}
+	return 0;
+}
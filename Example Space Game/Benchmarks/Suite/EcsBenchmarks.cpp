@@ -0,0 +1,147 @@
+// ECS operations the game leans on every frame: spawning and destroying
+// gameobjects, instancing prefabs the way EnemyData and FireLasers do, the
+// meshID sorted queries of the renderer and merging deferred commands.
+#include "Harness.h"
+#include "SuiteComponents.h"
+
+using namespace TeamYellow;
+
+// an enemy prefab with the shared and overridden components of "Enemy Type1"
+static flecs::entity EnemyPrefab(flecs::world& _world)
+{
+	return _world.prefab()
+		.set<StaticMeshComponent>({ 1 })
+		.set<Orientation>({ GW::MATH2D::GIdentityMatrix2F, GW::MATH2D::GIdentityMatrix2F })
+		.set<Scale>({ GW::MATH::GVECTORF{ 1, 1, 1, 0 } })
+		.set<AlliedWith>({ ENEMY })
+		.set_override<Health>({ 30 })
+		.override<Acceleration>()
+		.override<Velocity>()
+		.override<Position>()
+		.override<Enemy>()
+		.override<Gameobject>()
+		.override<Collidable>();
+}
+
+static void EntityCreateDestroy(Bench::State& state)
+{
+	flecs::world world;
+	Bench::RegisterComponents(world);
+	std::vector<flecs::entity> entities(static_cast<size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		for (auto& e : entities)
+			e = world.entity()
+				.set<Position>({ 0, 0 })
+				.set<Velocity>({ 0, 1 })
+				.add<Gameobject>();
+		for (auto& e : entities)
+			e.destruct();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(EntityCreateDestroy)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void PrefabInstance(Bench::State& state)
+{
+	flecs::world world;
+	Bench::RegisterComponents(world);
+	auto prefab = EnemyPrefab(world);
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < state.range(0); ++i)
+			world.entity().is_a(prefab);
+		state.PauseTiming();
+		world.delete_with(flecs::IsA, prefab);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(PrefabInstance)->Arg(1000)->Arg(10000);
+
+// Meshes spread over the four tables the render queries match. Args are the
+// entity count and the sort: 0 unsorted, 1 order_by, 2 order_by_key. Every
+// iteration changes 1% of the meshes first, so the sorted queries resort.
+static void QueryMeshes(Bench::State& state)
+{
+	flecs::world world;
+	Bench::RegisterComponents(world);
+	int64_t count = state.range(0);
+	std::vector<flecs::entity> entities;
+	for (int64_t i = 0; i < count; ++i)
+	{
+		auto e = world.entity()
+			.set<Position>({ static_cast<float>(i % 90) - 45.0f, static_cast<float>(i % 160) })
+			.set<Orientation>({ GW::MATH2D::GIdentityMatrix2F, GW::MATH2D::GIdentityMatrix2F })
+			.set<Scale>({ GW::MATH::GVECTORF{ 1, 1, 1, 0 } })
+			.set<StaticMeshComponent>({ static_cast<uint32_t>((i * 7919) % 16) });
+		switch (i % 4)
+		{
+		case 0: e.add<Gameobject>(); break;
+		case 1: e.add<Gameobject>().add<Bullet>(); break;
+		case 2: e.add<Gameobject>().add<Enemy>(); break;
+		default: e.add<Gameobject>().add<Collidable>(); break;
+		}
+		entities.push_back(e);
+	}
+
+	auto builder = world.query_builder<const Position, const StaticMeshComponent>().with<Gameobject>();
+	if (state.range(1) == 1)
+		builder.order_by<StaticMeshComponent>([](flecs::entity_t, const StaticMeshComponent* a, flecs::entity_t, const StaticMeshComponent* b) {
+			return (a->meshID > b->meshID) - (a->meshID < b->meshID);
+		});
+	else if (state.range(1) == 2)
+		builder.order_by_key<StaticMeshComponent>([](flecs::entity_t, const StaticMeshComponent* sm) -> uint64_t {
+			return sm->meshID;
+		});
+	auto query = builder.build();
+
+	size_t changed = 0;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		for (size_t i = 0; i < entities.size() / 100; ++i, changed += 97)
+			entities[changed % entities.size()].set<StaticMeshComponent>({ static_cast<uint32_t>(changed % 16) });
+		state.ResumeTiming();
+		float sum = 0;
+		query.each([&sum](const Position& p, const StaticMeshComponent& sm) {
+			sum += p.value.x * sm.meshID;
+		});
+		Bench::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+	state.SetLabel(state.range(1) == 0 ? "unsorted" : state.range(1) == 1 ? "order_by" : "order_by_key");
+}
+BENCHMARK(QueryMeshes)->Args({ 10000, 0 })->Args({ 10000, 1 })->Args({ 10000, 2 })
+	->Args({ 100000, 0 })->Args({ 100000, 1 })->Args({ 100000, 2 });
+
+// A burst of bullets fired from a prefab inside a deferred block, one in
+// eight destroyed again before the merge like shots that hit at the muzzle
+static void DeferredMerge(Bench::State& state)
+{
+	flecs::world world;
+	Bench::RegisterComponents(world);
+	auto bullet = world.prefab()
+		.set<Velocity>({ 0, 1 })
+		.override<Position>()
+		.override<Bullet>()
+		.override<Gameobject>();
+	for (auto _ : state)
+	{
+		world.defer_begin();
+		for (int64_t i = 0; i < state.range(0); ++i)
+		{
+			auto b = world.entity().is_a(bullet)
+				.set<Position>({ static_cast<float>(i % 90) - 45.0f, 0 })
+				.set<AlliedWith>({ PLAYER });
+			if (i % 8 == 0)
+				b.destruct();
+		}
+		world.defer_end();
+		state.PauseTiming();
+		world.delete_with(flecs::IsA, bullet);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(DeferredMerge)->Arg(1000)->Arg(10000);
@@ -0,0 +1,292 @@
+// Runs the registered benchmarks. Each one is repeated with more iterations
+// until a run takes at least --min_time, the last run is the one reported.
+//
+// EngineBenchmarks [--filter=regex] [--min_time=seconds] [--out=results.json]
+//                  [--compare=baseline.json] [--assets=../Assets]
+#include "Harness.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+using namespace TeamYellow;
+
+namespace
+{
+	std::vector<std::unique_ptr<Bench::Benchmark>>& Registry()
+	{
+		static std::vector<std::unique_ptr<Bench::Benchmark>> benchmarks;
+		return benchmarks;
+	}
+
+	std::string assetFolder = "../Assets";
+
+	struct Result
+	{
+		std::string name;
+		std::string label;
+		std::string error;
+		int64_t iterations;
+		double realNs;	// per iteration
+		double cpuNs;	// per iteration
+		double itemsPerSecond;
+		double bytesPerSecond;
+	};
+
+	std::string RunName(const Bench::Benchmark& _benchmark, const std::vector<int64_t>& _args)
+	{
+		std::string name = _benchmark.name;
+		for (int64_t arg : _args)
+			name += "/" + std::to_string(arg);
+		return name;
+	}
+
+	Result Run(const Bench::Benchmark& _benchmark, const std::vector<int64_t>& _args, double _minTime)
+	{
+		int64_t iterations = _benchmark.fixedIterations ? _benchmark.fixedIterations : 1;
+		for (;;)
+		{
+			Bench::State state(iterations, _args);
+			_benchmark.function(state);
+			bool done = _benchmark.fixedIterations || !state.error.empty() ||
+				state.realSeconds >= _minTime || iterations >= 1000000000;
+			if (done)
+			{
+				Result result = { RunName(_benchmark, _args), state.label, state.error, iterations,
+					state.realSeconds * 1e9 / iterations, state.cpuSeconds * 1e9 / iterations, 0, 0 };
+				if (state.realSeconds > 0)
+				{
+					result.itemsPerSecond = state.items / state.realSeconds;
+					result.bytesPerSecond = state.bytes / state.realSeconds;
+				}
+				return result;
+			}
+			// aim a little past the minimum time, but grow by at most 10x so
+			// that a noisy short run doesn't blow up the estimate
+			double multiplier = _minTime * 1.4 / std::max(state.realSeconds, 1e-9);
+			if (state.realSeconds / _minTime <= 0.1)
+				multiplier = std::min(multiplier, 10.0);
+			iterations = std::max(iterations + 1, static_cast<int64_t>(iterations * multiplier));
+		}
+	}
+
+	std::string Escape(const std::string& _text)
+	{
+		std::string out;
+		for (char c : _text)
+		{
+			if (c == '"' || c == '\\')
+				out += '\\';
+			out += c;
+		}
+		return out;
+	}
+
+	bool WriteJson(const char* _path, const char* _executable, const std::vector<Result>& _results)
+	{
+		std::ofstream file(_path);
+		if (!file.is_open())
+			return false;
+		char date[64];
+		std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+		file << "{\n  \"context\": {\n";
+		file << "    \"date\": \"" << date << "\",\n";
+		file << "    \"executable\": \"" << Escape(_executable) << "\",\n";
+		file << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+		file << "    \"library_build_type\": \"release\"\n";
+#else
+		file << "    \"library_build_type\": \"debug\"\n";
+#endif
+		file << "  },\n  \"benchmarks\": [";
+		bool first = true;
+		char number[64];
+		for (const Result& r : _results)
+		{
+			if (!r.error.empty())
+				continue;
+			file << (first ? "\n" : ",\n") << "    {\n";
+			first = false;
+			file << "      \"name\": \"" << Escape(r.name) << "\",\n";
+			file << "      \"run_name\": \"" << Escape(r.name) << "\",\n";
+			file << "      \"run_type\": \"iteration\",\n";
+			file << "      \"iterations\": " << r.iterations << ",\n";
+			std::snprintf(number, sizeof(number), "%.6e", r.realNs);
+			file << "      \"real_time\": " << number << ",\n";
+			std::snprintf(number, sizeof(number), "%.6e", r.cpuNs);
+			file << "      \"cpu_time\": " << number << ",\n";
+			file << "      \"time_unit\": \"ns\"";
+			if (r.itemsPerSecond > 0)
+			{
+				std::snprintf(number, sizeof(number), "%.6e", r.itemsPerSecond);
+				file << ",\n      \"items_per_second\": " << number;
+			}
+			if (r.bytesPerSecond > 0)
+			{
+				std::snprintf(number, sizeof(number), "%.6e", r.bytesPerSecond);
+				file << ",\n      \"bytes_per_second\": " << number;
+			}
+			if (!r.label.empty())
+				file << ",\n      \"label\": \"" << Escape(r.label) << "\"";
+			file << "\n    }";
+		}
+		file << "\n  ]\n}\n";
+		return file.good();
+	}
+
+	// Reads the real time of every benchmark in an earlier JSON result. Only
+	// the fields this harness writes are looked at, so it is a plain scan
+	// rather than a JSON parser.
+	std::map<std::string, double> ReadBaseline(const char* _path)
+	{
+		std::map<std::string, double> times;
+		std::ifstream file(_path);
+		if (!file.is_open())
+			return times;
+		std::stringstream content;
+		content << file.rdbuf();
+		std::string json = content.str();
+		const std::string nameKey = "\"name\": \"", timeKey = "\"real_time\": ";
+		size_t pos = 0;
+		while ((pos = json.find(nameKey, pos)) != std::string::npos)
+		{
+			pos += nameKey.size();
+			size_t nameEnd = json.find('"', pos);
+			size_t time = json.find(timeKey, nameEnd);
+			if (nameEnd == std::string::npos || time == std::string::npos)
+				break;
+			times[json.substr(pos, nameEnd - pos)] = std::strtod(json.c_str() + time + timeKey.size(), nullptr);
+			pos = time;
+		}
+		return times;
+	}
+
+	const char* Option(const char* _arg, const char* _name)
+	{
+		size_t length = std::strlen(_name);
+		return std::strncmp(_arg, _name, length) == 0 && _arg[length] == '=' ? _arg + length + 1 : nullptr;
+	}
+};
+
+void Bench::State::StartTimer()
+{
+	running = true;
+	realStart = std::chrono::steady_clock::now();
+	cpuStart = std::clock();
+}
+
+void Bench::State::StopTimer()
+{
+	if (!running)
+		return;
+	realSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+	cpuSeconds += static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+	running = false;
+}
+
+void Bench::State::PauseTiming()
+{
+	StopTimer();
+}
+
+void Bench::State::ResumeTiming()
+{
+	StartTimer();
+}
+
+Bench::Benchmark* Bench::RegisterBenchmark(const char* _name, Benchmark::Function _function)
+{
+	Registry().emplace_back(new Benchmark(_name, _function));
+	return Registry().back().get();
+}
+
+std::string Bench::AssetPath(const char* _relativePath)
+{
+	return assetFolder + "/" + _relativePath;
+}
+
+int main(int argc, char** argv)
+{
+	const char* filter = ".";
+	const char* out = nullptr;
+	const char* compare = nullptr;
+	double minTime = 0.5;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* value;
+		if ((value = Option(argv[i], "--filter")))
+			filter = value;
+		else if ((value = Option(argv[i], "--min_time")))
+			minTime = std::atof(value);
+		else if ((value = Option(argv[i], "--out")))
+			out = value;
+		else if ((value = Option(argv[i], "--compare")))
+			compare = value;
+		else if ((value = Option(argv[i], "--assets")))
+			assetFolder = value;
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--filter=regex] [--min_time=seconds] [--out=results.json] "
+				"[--compare=baseline.json] [--assets=folder]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::map<std::string, double> baseline;
+	if (compare)
+	{
+		baseline = ReadBaseline(compare);
+		if (baseline.empty())
+			std::fprintf(stderr, "no results to compare with in %s\n", compare);
+	}
+
+	std::regex pattern(filter);
+	std::printf("%-40s %14s %14s %12s %14s %9s\n", "benchmark", "time ns", "cpu ns", "iterations",
+		"items/s", baseline.empty() ? "" : "vs base");
+	std::vector<Result> results;
+	for (const auto& benchmark : Registry())
+	{
+		std::vector<std::vector<int64_t>> argSets = benchmark->argSets;
+		if (argSets.empty())
+			argSets.push_back({});
+		for (const auto& args : argSets)
+		{
+			if (!std::regex_search(RunName(*benchmark, args), pattern))
+				continue;
+			Result r = Run(*benchmark, args, minTime);
+			results.push_back(r);
+			if (!r.error.empty())
+			{
+				std::printf("%-40s ERROR: %s\n", r.name.c_str(), r.error.c_str());
+				continue;
+			}
+			char items[32] = "";
+			if (r.itemsPerSecond > 0)
+				std::snprintf(items, sizeof(items), "%.4g", r.itemsPerSecond);
+			char delta[32] = "";
+			auto base = baseline.find(r.name);
+			if (base != baseline.end() && base->second > 0)
+				std::snprintf(delta, sizeof(delta), "%+.1f%%", (r.realNs / base->second - 1.0) * 100.0);
+			std::printf("%-40s %14.1f %14.1f %12lld %14s %9s %s\n", r.name.c_str(), r.realNs, r.cpuNs,
+				static_cast<long long>(r.iterations), items, delta, r.label.c_str());
+			std::fflush(stdout);
+		}
+	}
+
+	if (out && !WriteJson(out, argv[0], results))
+	{
+		std::fprintf(stderr, "could not write %s\n", out);
+		return 1;
+	}
+	for (const Result& r : results)
+		if (!r.error.empty())
+			return 1;
+	return 0;
+}
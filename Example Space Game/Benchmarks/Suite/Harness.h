@@ -0,0 +1,127 @@
+// A small benchmark harness in the style of Google Benchmark, so the suite
+// builds with nothing but the game sources. Benchmarks are registered with
+// BENCHMARK(fn)->Arg(n) and time the body of a range-for over the state:
+//
+//	static void CreateEntities(Bench::State& state)
+//	{
+//		for (auto _ : state)
+//			...
+//		state.SetItemsProcessed(state.iterations() * state.range(0));
+//	}
+//	BENCHMARK(CreateEntities)->Arg(1000)->Arg(10000);
+//
+// Results are printed as a table and written in Google Benchmark's JSON
+// format, so its compare.py works on them as well as --compare.
+#ifndef _BENCH_HARNESS_H_
+#define _BENCH_HARNESS_H_
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace TeamYellow
+{
+	namespace Bench
+	{
+		class State
+		{
+		public:
+			// what the range-for yields, marked so an unused "_" doesn't warn
+			struct [[maybe_unused]] Value {};
+
+			struct Iterator
+			{
+				State* state;
+				int64_t left;
+				bool operator!=(const Iterator&)
+				{
+					if (left > 0)
+						return true;
+					state->StopTimer();
+					return false;
+				}
+				void operator++() { --left; }
+				Value operator*() const { return {}; }
+			};
+
+			State(int64_t _iterations, std::vector<int64_t> _args)
+				: maxIterations(_iterations), args(std::move(_args)) {}
+
+			Iterator begin() { StartTimer(); return { this, maxIterations }; }
+			Iterator end() { return { this, 0 }; }
+
+			int64_t range(size_t _index = 0) const { return _index < args.size() ? args[_index] : 0; }
+			int64_t iterations() const { return maxIterations; }
+
+			// leaves setup and teardown inside the loop out of the measurement
+			void PauseTiming();
+			void ResumeTiming();
+
+			void SetItemsProcessed(int64_t _items) { items = _items; }
+			void SetBytesProcessed(int64_t _bytes) { bytes = _bytes; }
+			void SetLabel(const std::string& _label) { label = _label; }
+			// marks the run as failed, it is reported but left out of the JSON
+			void SkipWithError(const char* _error) { error = _error; }
+
+			double realSeconds = 0;
+			double cpuSeconds = 0;
+			int64_t items = 0;
+			int64_t bytes = 0;
+			std::string label;
+			std::string error;
+
+		private:
+			void StartTimer();
+			void StopTimer();
+
+			int64_t maxIterations;
+			std::vector<int64_t> args;
+			bool running = false;
+			std::chrono::steady_clock::time_point realStart;
+			std::clock_t cpuStart = 0;
+		};
+
+		class Benchmark
+		{
+		public:
+			typedef void (*Function)(State&);
+			Benchmark(const char* _name, Function _function) : name(_name), function(_function) {}
+
+			Benchmark* Arg(int64_t _arg) { argSets.push_back({ _arg }); return this; }
+			Benchmark* Args(const std::vector<int64_t>& _args) { argSets.push_back(_args); return this; }
+			// runs exactly this many iterations instead of scaling to the minimum time
+			Benchmark* Iterations(int64_t _iterations) { fixedIterations = _iterations; return this; }
+
+			std::string name;
+			Function function;
+			std::vector<std::vector<int64_t>> argSets;
+			int64_t fixedIterations = 0;
+		};
+
+		Benchmark* RegisterBenchmark(const char* _name, Benchmark::Function _function);
+
+		// path of a file under the game's Assets folder, see --assets
+		std::string AssetPath(const char* _relativePath);
+
+		// keeps the compiler from optimizing away a value that is never used
+		template <typename T>
+		inline void DoNotOptimize(const T& _value)
+		{
+#if defined(_MSC_VER)
+			const volatile char* sink = reinterpret_cast<const volatile char*>(&_value);
+			(void)*sink;
+#else
+			asm volatile("" : : "r,m"(_value) : "memory");
+#endif
+		}
+	};
+};
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+#define BENCHMARK(fn) \
+	static TeamYellow::Bench::Benchmark* BENCH_CONCAT(bench_, __LINE__) = \
+		TeamYellow::Bench::RegisterBenchmark(#fn, fn)
+
+#endif
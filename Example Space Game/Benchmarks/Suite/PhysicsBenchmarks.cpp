@@ -0,0 +1,83 @@
+// The PhysicsLogic collision pass: every Collidable is transformed by its
+// mesh bounds and tested against every other one. The movement systems are
+// switched off so the entities stay where they were placed.
+#include "Harness.h"
+#include "SuiteComponents.h"
+#include "../../Source/Systems/PhysicsLogic.h"
+#include "../../Source/Systems/RenderLogic.h"
+#include "../../Source/Utils/h2bParser.h"
+#include <algorithm>
+
+using namespace TeamYellow;
+
+static std::vector<RenderSystem::MeshBounds> meshBounds;
+
+// PhysicsLogic asks the renderer for the mesh bounds, here they come straight
+// from the models with the same axis swap LoadH2BMesh does
+const std::vector<RenderSystem::MeshBounds>& RenderSystem::GetMeshBoundsVector()
+{
+	return meshBounds;
+}
+
+static bool LoadMeshBounds()
+{
+	if (!meshBounds.empty())
+		return true;
+	const char* models[] = { "Models/PlayerShip.h2b", "Models/EnemyShip.h2b", "Models/Bullet.h2b" };
+	H2B::Parser parser;
+	for (const char* model : models)
+	{
+		if (!parser.Parse(Bench::AssetPath(model).c_str()))
+		{
+			meshBounds.clear();
+			return false;
+		}
+		RenderSystem::MeshBounds bounds = { { 0, 0, 0, 1 }, { 0, 0, 0, 1 } };
+		for (const H2B::VERTEX& v : parser.vertices)
+		{
+			bounds.min.x = std::min(bounds.min.x, v.pos.y);
+			bounds.min.y = std::min(bounds.min.y, v.pos.z);
+			bounds.min.z = std::min(bounds.min.z, v.pos.x);
+			bounds.max.x = std::max(bounds.max.x, v.pos.y);
+			bounds.max.y = std::max(bounds.max.y, v.pos.z);
+			bounds.max.z = std::max(bounds.max.z, v.pos.x);
+		}
+		meshBounds.push_back(bounds);
+	}
+	return true;
+}
+
+static void CollisionPass(Bench::State& state)
+{
+	if (!LoadMeshBounds())
+	{
+		state.SkipWithError("could not load the models, see --assets");
+		return;
+	}
+	auto world = std::make_shared<flecs::world>();
+	Bench::RegisterComponents(*world);
+	PhysicsLogic physics;
+	physics.Init(world, std::weak_ptr<const GameConfig>());
+	physics.Activate(false);
+
+	// a loose grid of ships and bullets, close enough for a few hits per frame
+	for (int64_t i = 0; i < state.range(0); ++i)
+	{
+		uint32_t mesh = i == 0 ? 0 : (i % 4 == 0 ? 1 : 2);
+		world->entity()
+			.set<Position>({ static_cast<float>(i % 30) * 3.0f - 45.0f, static_cast<float>(i / 30) * 3.0f })
+			.set<Orientation>({ GW::MATH2D::GIdentityMatrix2F, GW::MATH2D::GIdentityMatrix2F })
+			.set<Scale>({ GW::MATH::GVECTORF{ 1, 1, 1, 0 } })
+			.set<StaticMeshComponent>({ mesh })
+			.add<Collidable>()
+			.add<Gameobject>();
+	}
+	world->progress(1 / 60.0f); // the first frame adds the CollidedWith pairs
+	for (auto _ : state)
+		world->progress(1 / 60.0f);
+	physics.Shutdown();
+	int64_t n = state.range(0);
+	state.SetItemsProcessed(state.iterations() * n * (n - 1) / 2);
+	state.SetLabel("items are pair tests");
+}
+BENCHMARK(CollisionPass)->Arg(100)->Arg(500)->Arg(2000);
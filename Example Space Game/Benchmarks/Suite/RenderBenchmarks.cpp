@@ -0,0 +1,112 @@
+// The CPU side of the renderer without Vulkan: packing mesh instances the way
+// copyRenderingData does, laying out UIText glyphs with a BMFont and parsing
+// the H2B models. Packing, font loading and glyph layout are the functions
+// RenderLogic uses (Helper/RenderHelper.h), writing to a plain buffer instead
+// of staging memory.
+#include "Harness.h"
+#include "SuiteComponents.h"
+#include "../../Source/Helper/RenderHelper.h"
+#include "../../Source/Utils/h2bParser.h"
+#include <cstring>
+
+using namespace TeamYellow;
+using namespace TeamYellow::RenderSystem;
+
+// Static meshes over the four level layers, packed per layer in meshID order
+static void InstancePacking(Bench::State& state)
+{
+	flecs::world world;
+	Bench::RegisterComponents(world);
+	for (int64_t i = 0; i < state.range(0); ++i)
+	{
+		auto e = world.entity()
+			.set<Position>({ static_cast<float>(i % 90) - 45.0f, static_cast<float>(i % 160) })
+			.set<Orientation>({ GW::MATH2D::GIdentityMatrix2F, GW::MATH2D::GIdentityMatrix2F })
+			.set<Scale>({ GW::MATH::GVECTORF{ 1, 1, 1, 0 } })
+			.set<StaticMeshComponent>({ static_cast<uint32_t>((i * 7919) % 24) });
+		switch (i % 8)
+		{
+		case 0: e.add<Background>(); break;
+		case 1: e.add<Floor>(); break;
+		case 2: e.add<Foreground>(); break;
+		default: e.add<Gameobject>(); break;
+		}
+	}
+	auto byMesh = [](flecs::entity_t, const StaticMeshComponent* sm) -> uint64_t { return sm->meshID; };
+	auto background = world.query_builder<Position, Orientation, Scale, StaticMeshComponent, Background>()
+		.order_by_key<StaticMeshComponent>(byMesh).build();
+	auto floor = world.query_builder<Position, Orientation, Scale, StaticMeshComponent, Floor>()
+		.order_by_key<StaticMeshComponent>(byMesh).build();
+	auto foreground = world.query_builder<Position, Orientation, Scale, StaticMeshComponent, Foreground>()
+		.order_by_key<StaticMeshComponent>(byMesh).build();
+	auto gameObjects = world.query_builder<Position, Orientation, Scale, StaticMeshComponent, Gameobject>()
+		.order_by_key<StaticMeshComponent>(byMesh).build();
+
+	std::vector<MeshInstanceData> instances(static_cast<size_t>(state.range(0)));
+	std::vector<MeshBatch> batches;
+	for (auto _ : state)
+	{
+		uint32_t instanceCount = 0;
+		MeshInstanceData* instanceData = instances.data();
+		batches.clear();
+		PackMeshInstances(background, 40.0f, 0, instanceData, instanceCount, batches);
+		PackMeshInstances(floor, 0.0f, 0, instanceData, instanceCount, batches);
+		PackMeshInstances(foreground, -5.0f, 0, instanceData, instanceCount, batches);
+		PackMeshInstances(gameObjects, 0.0f, 1, instanceData, instanceCount, batches);
+		Bench::DoNotOptimize(instances.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(sizeof(MeshInstanceData)));
+}
+BENCHMARK(InstancePacking)->Arg(1000)->Arg(10000)->Arg(50000);
+
+// Lays out a number of HUD labels with the Pixel font on a 1920x1080 swapchain
+static void GlyphLayout(Bench::State& state)
+{
+	static BMFont font;
+	if (!LoadBMFont(Bench::AssetPath("Fonts/Pixel.fnt").c_str(), font))
+	{
+		state.SkipWithError("could not load Fonts/Pixel.fnt, see --assets");
+		return;
+	}
+	UIText text = {};
+	text.fontSize = 1.0f;
+	std::strcpy(text.text, "SCORE: 00123450\nHI-SCORE: 00999999\nLIVES: 3  BOMBS: 2");
+	const UIRect rect = { -0.95f, -0.9f, 0.5f, 0.2f };
+	const float width = 1920.0f, height = 1080.0f;
+	size_t glyphs = std::strlen(text.text);
+	std::vector<UIInstance> instances(static_cast<size_t>(state.range(0)) * glyphs);
+	for (auto _ : state)
+	{
+		UIInstance* instance = instances.data();
+		for (int64_t label = 0; label < state.range(0); ++label)
+			LayoutUIText(font, rect, text, width, height, [&instance](const UIInstance& _glyph) { *instance++ = _glyph; });
+		Bench::DoNotOptimize(instances.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * static_cast<int64_t>(glyphs));
+	state.SetLabel("items are characters");
+}
+BENCHMARK(GlyphLayout)->Arg(1)->Arg(64);
+
+static const char* models[] = { "Models/Bullet.h2b", "Models/PlayerShip.h2b", "Models/EnemyShip.h2b",
+	"Models/6Story.h2b" };
+
+static void H2BParse(Bench::State& state)
+{
+	const char* model = models[state.range(0)];
+	std::string path = Bench::AssetPath(model);
+	H2B::Parser parser;
+	size_t fileSize = 0;
+	for (auto _ : state)
+	{
+		if (!parser.Parse(path.c_str()))
+		{
+			state.SkipWithError("could not parse the model, see --assets");
+			return;
+		}
+		fileSize = parser.vertices.size() * sizeof(H2B::VERTEX) + parser.indices.size() * sizeof(unsigned);
+	}
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fileSize));
+	state.SetLabel(model);
+}
+BENCHMARK(H2BParse)->Arg(0)->Arg(1)->Arg(2)->Arg(3);
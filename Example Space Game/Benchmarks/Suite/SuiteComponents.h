@@ -0,0 +1,39 @@
+// flecs keeps the ids of C++ components in statics shared by every world of
+// the process. Each benchmark makes a world of its own, so they all register
+// the game components in the same order first and get the same ids.
+#ifndef _BENCH_SUITECOMPONENTS_H_
+#define _BENCH_SUITECOMPONENTS_H_
+#include "../../Source/Components/Physics.h"
+#include "../../Source/Components/Identification.h"
+#include "../../Source/Components/Gameplay.h"
+#include "../../Source/Components/Visuals.h"
+
+namespace TeamYellow
+{
+	namespace Bench
+	{
+		inline void RegisterComponents(flecs::world& _world)
+		{
+			_world.component<Position>();
+			_world.component<Velocity>();
+			_world.component<Orientation>();
+			_world.component<Scale>();
+			_world.component<Acceleration>();
+			_world.component<PlayerPosition>();
+			_world.component<Collidable>();
+			_world.component<CollidedWith>();
+			_world.component<StaticMeshComponent>();
+			_world.component<Foreground>();
+			_world.component<Background>();
+			_world.component<Gameobject>();
+			_world.component<Floor>();
+			_world.component<Player>();
+			_world.component<Bullet>();
+			_world.component<Enemy>();
+			_world.component<AlliedWith>();
+			_world.component<Health>();
+		}
+	};
+};
+
+#endif
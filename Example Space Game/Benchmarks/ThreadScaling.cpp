@@ -0,0 +1,76 @@
+// Headless benchmark measuring how the multi threaded physics systems scale
+// with the number of flecs worker threads. No window or GPU is created, only
+// the PhysicsLogic systems are attached to a bare world.
+#include "../Source/Systems/PhysicsLogic.h"
+#include "../Source/Systems/RenderLogic.h"
+#include "../Source/Components/Identification.h"
+#include <chrono>
+#include <thread>
+#include <cstdio>
+
+using namespace TeamYellow;
+
+// PhysicsLogic asks the renderer for mesh bounds when resolving collisions.
+// Nothing here is Collidable, so an empty list is all it ever needs.
+const std::vector<RenderSystem::MeshBounds>& RenderSystem::GetMeshBoundsVector()
+{
+	static std::vector<MeshBounds> none;
+	return none;
+}
+
+// runs a fixed number of frames and returns the average milliseconds per frame
+static double RunFrames(flecs::world& _world, int _frames)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < _frames; ++i)
+		_world.progress(1 / 60.0f);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count() / _frames;
+}
+
+static double MeasureScene(int _entityCount, int _threads)
+{
+	auto world = std::make_shared<flecs::world>();
+	world->set_threads(_threads);
+	PhysicsLogic physics;
+	physics.Init(world, std::weak_ptr<const GameConfig>());
+
+	world->entity().add<Player>().set<Position>({ 0, 0 });
+	for (int i = 0; i < _entityCount; ++i) {
+		// spread everything inside the cleanup bounds so nothing is destroyed
+		float x = static_cast<float>(i % 80) - 40.0f;
+		float y = static_cast<float>((i / 80) % 140) - 70.0f;
+		auto e = world->entity()
+			.set<Position>({ x, y })
+			.set<Velocity>({ 0, 0 })
+			.set<Acceleration>({ 0, 0 })
+			.add<Gameobject>();
+		if (i % 3 == 0)
+			e.add<Enemy>();
+	}
+	RunFrames(*world, 10); // warm up tables, caches and worker threads
+	double ms = RunFrames(*world, 100);
+	physics.Shutdown();
+	return ms;
+}
+
+int main()
+{
+	const int entityCounts[] = { 1000, 10000, 100000 };
+	const int threadCounts[] = { 1, 2, 4, 8, 16 };
+	unsigned hardwareThreads = std::thread::hardware_concurrency();
+
+	std::printf("%10s %8s %12s %8s\n", "entities", "threads", "ms/frame", "speedup");
+	for (int count : entityCounts) {
+		double baseline = 0;
+		for (int threads : threadCounts) {
+			if (threads > 1 && hardwareThreads && static_cast<unsigned>(threads) > hardwareThreads)
+				break;
+			double ms = MeasureScene(count, threads);
+			if (threads == 1)
+				baseline = ms;
+			std::printf("%10d %8d %12.4f %7.2fx\n", count, threads, ms, baseline / ms);
+		}
+	}
+	return 0;
+}
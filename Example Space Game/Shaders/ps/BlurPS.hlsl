@@ -1,5 +1,6 @@
 struct ROOT_CONSTANTS
 {
+    float2 uvScale; // Scene Viewport size / Scene Target size
     uint blurDirection;
 };
 #ifdef __spirv__
@@ -23,18 +24,21 @@ float4 main(PS_INPUT input) : SV_TARGET
     float2 textureSize;
     inputTexture.GetDimensions(textureSize.x, textureSize.y);
     float2 tex_offset = 1.0 / textureSize * 2;
-    float3 outColor = inputTexture.Sample(inputSampler, input.texCoord).rgb;
+    // Keep taps inside the rendered part of the Scene Target
+    float2 uvMax = root_constants.uvScale - 0.5 / textureSize;
+    float2 texCoord = input.texCoord * root_constants.uvScale;
+    float3 outColor = inputTexture.Sample(inputSampler, min(texCoord, uvMax)).rgb;
     for(int i = 0; i < 5; ++i)
     {
         if(root_constants.blurDirection == 0)
         {
-            outColor += inputTexture.Sample(inputSampler, input.texCoord + float2(tex_offset.x * i, 0.0)).rgb * weight[i];
-            outColor += inputTexture.Sample(inputSampler, input.texCoord - float2(tex_offset.x * i, 0.0)).rgb * weight[i];
+            outColor += inputTexture.Sample(inputSampler, min(texCoord + float2(tex_offset.x * i, 0.0), uvMax)).rgb * weight[i];
+            outColor += inputTexture.Sample(inputSampler, min(texCoord - float2(tex_offset.x * i, 0.0), uvMax)).rgb * weight[i];
         }
         else
         {
-            outColor += inputTexture.Sample(inputSampler, input.texCoord + float2(0.0, tex_offset.y * i)).rgb * weight[i];
-            outColor += inputTexture.Sample(inputSampler, input.texCoord - float2(0.0, tex_offset.y * i)).rgb * weight[i];
+            outColor += inputTexture.Sample(inputSampler, min(texCoord + float2(0.0, tex_offset.y * i), uvMax)).rgb * weight[i];
+            outColor += inputTexture.Sample(inputSampler, min(texCoord - float2(0.0, tex_offset.y * i), uvMax)).rgb * weight[i];
         }
     }
     return float4(outColor, 1.0);
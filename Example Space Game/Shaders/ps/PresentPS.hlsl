@@ -1,11 +1,38 @@
+struct ROOT_CONSTANTS
+{
+    float2 sceneUVScale;    // Scene Viewport size / Scene Target size
+    float2 sceneTexelSize;  // 1 / Scene Target size
+    float sharpenStrength;  // 0 disables sharpening
+};
+#ifdef __spirv__
+[[vk::push_constant]]
+#endif
+ROOT_CONSTANTS root_constants;
 Texture2D       staticMeshTexture   : register(t0, space0);
 Texture2D       bloomTexture        : register(t1, space0);
 Texture2D       uiTexture           : register(t2, space0);
 SamplerState    blitSampler         : register(s3, space0);
 float4 main(float2 texcoord         : TEXCOORD) : SV_TARGET
 {
-    float4 staticMeshColor = staticMeshTexture.Sample(blitSampler, texcoord);
-    float4 bloomColor = bloomTexture.Sample(blitSampler, texcoord);
+    float2 uvMax = root_constants.sceneUVScale - 0.5 * root_constants.sceneTexelSize;
+    float2 sceneCoord = min(texcoord * root_constants.sceneUVScale, uvMax);
+    float4 staticMeshColor = staticMeshTexture.Sample(blitSampler, sceneCoord);
+    // Contrast adaptive sharpening to recover detail lost to a lowered Render Scale
+    if(root_constants.sharpenStrength > 0)
+    {
+        float2 texel = root_constants.sceneTexelSize;
+        float3 n = staticMeshTexture.Sample(blitSampler, min(sceneCoord - float2(0, texel.y), uvMax)).rgb;
+        float3 s = staticMeshTexture.Sample(blitSampler, min(sceneCoord + float2(0, texel.y), uvMax)).rgb;
+        float3 w = staticMeshTexture.Sample(blitSampler, min(sceneCoord - float2(texel.x, 0), uvMax)).rgb;
+        float3 e = staticMeshTexture.Sample(blitSampler, min(sceneCoord + float2(texel.x, 0), uvMax)).rgb;
+        float3 c = staticMeshColor.rgb;
+        float3 minColor = min(c, min(min(n, s), min(w, e)));
+        float3 maxColor = max(c, max(max(n, s), max(w, e)));
+        float3 amp = saturate(min(minColor, 1.0 - maxColor) / max(maxColor, 0.0001));
+        float3 weight = sqrt(amp) * (-1.0 / lerp(8.0, 5.0, root_constants.sharpenStrength));
+        staticMeshColor.rgb = saturate((c + (n + s + w + e) * weight) / (1.0 + 4.0 * weight));
+    }
+    float4 bloomColor = bloomTexture.Sample(blitSampler, sceneCoord);
     if(dot(bloomColor.rgb, bloomColor.rgb) > 0)
         staticMeshColor.rgb += bloomColor.rgb * 0.04;
     float4 uiColor = uiTexture.Sample(blitSampler, texcoord);
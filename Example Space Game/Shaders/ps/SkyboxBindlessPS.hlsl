@@ -0,0 +1,16 @@
+struct ROOT_CONSTANTS
+{
+    // Placed after the two matrices the Static Mesh pipeline pushes
+    [[vk::offset(128)]] uint cubeMapIndex;
+};
+#ifdef __spirv__
+[[vk::push_constant]]
+#endif
+ROOT_CONSTANTS root_constants;
+// Must match MAX_SKYBOX_COUNT in RenderLogic.cpp
+TextureCube     cubeMapTextures[4]  : register(t2, space0);
+SamplerState    cubeMapSampler      : register(s1, space0);
+float4 main(float3 texcoord         : TEXCOORD) : SV_TARGET
+{
+    return cubeMapTextures[root_constants.cubeMapIndex].Sample(cubeMapSampler, texcoord);
+}
\ No newline at end of file
@@ -1,22 +1,39 @@
+struct ROOT_CONSTANTS
+{
+    uint instanceOffset;
+};
+#ifdef __spirv__
+[[vk::push_constant]]
+#endif
+ROOT_CONSTANTS root_constants;
+struct UI_INSTANCE
+{
+    float4 srcRect;
+    float4 dstRect;
+    float4 clipRect;
+    float4 color;
+    float4 outline;
+};
+StructuredBuffer<UI_INSTANCE> uiInstances : register(t0, space1);
 struct VS_INPUT
 {
     uint vertexID   : SV_VertexID;
-    float4 srcRect  : SRC_RECT;
-    float4 dstRect  : DST_RECT;
+    uint instanceID : SV_InstanceID;
 };
 struct VS_OUTPUT
 {
-    float4 position : SV_POSITION;
-    float2 texCoord : TEXCOORD;
-    float4 srcRect  : SRC_RECT;
+    float4 position              : SV_POSITION;
+    float2 texCoord              : TEXCOORD;
+    nointerpolation float4 color : COLOR;
 };
 VS_OUTPUT main(VS_INPUT input)
 {
     VS_OUTPUT output = (VS_OUTPUT)0;
+    UI_INSTANCE instance = uiInstances[root_constants.instanceOffset + input.instanceID];
     uint vertexID = (input.vertexID / 3) + (input.vertexID % 3);
-    output.texCoord = float2((vertexID << 1) & 2, vertexID & 2);
-    output.position = float4(input.dstRect.xy + (output.texCoord * input.dstRect.zw), 0, 1);
-    output.texCoord = output.texCoord * 0.5f;
-    output.srcRect = input.srcRect;
+    float2 corner = float2(vertexID & 1, (vertexID >> 1) & 1);
+    output.position = float4(instance.dstRect.xy + (corner * instance.dstRect.zw), 0, 1);
+    output.texCoord = instance.srcRect.xy + (corner * instance.srcRect.zw);
+    output.color = instance.color;
     return output;
 }
\ No newline at end of file
@@ -1,17 +1,43 @@
+struct ROOT_CONSTANTS
+{
+    uint instanceOffset;
+};
+#ifdef __spirv__
+[[vk::push_constant]]
+#endif
+ROOT_CONSTANTS root_constants;
+struct UI_INSTANCE
+{
+    float4 srcRect;
+    float4 dstRect;
+    float4 clipRect;
+    float4 color;
+    float4 outline;
+};
+StructuredBuffer<UI_INSTANCE> uiInstances : register(t0, space1);
 struct VS_INPUT
 {
-    float2 position : POSITION;
-    float3 texcoord : TEXCOORD;
+    uint vertexID   : SV_VertexID;
+    uint instanceID : SV_InstanceID;
 };
 struct VS_OUTPUT
 {
-    float4 position : SV_POSITION;
-    float2 texcoord : TEXCOORD;
+    float4 position                 : SV_POSITION;
+    float2 texcoord                 : TEXCOORD;
+    nointerpolation float4 clipRect : CLIP_RECT;
+    nointerpolation float4 color    : COLOR;
+    nointerpolation float4 outline  : OUTLINE;
 };
 VS_OUTPUT main(VS_INPUT input)
 {
     VS_OUTPUT output = (VS_OUTPUT)0;
-    output.position = float4(input.position, 0.0, 1.0);
-    output.texcoord = input.texcoord.xy;
+    UI_INSTANCE instance = uiInstances[root_constants.instanceOffset + input.instanceID];
+    uint vertexID = (input.vertexID / 3) + (input.vertexID % 3);
+    float2 corner = float2(vertexID & 1, (vertexID >> 1) & 1);
+    output.position = float4(instance.dstRect.xy + (corner * instance.dstRect.zw), 0.0, 1.0);
+    output.texcoord = instance.srcRect.xy + (corner * instance.srcRect.zw);
+    output.clipRect = instance.clipRect;
+    output.color = instance.color;
+    output.outline = instance.outline;
     return output;
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ struct VS_INPUT
     float4x4    world           : TRANSFORM;
     float4      bloomColor      : BLOOM;
     uint        isGameObject    : GAMEOBJECT;
+    uint        textureIndex    : TEXTUREINDEX;
 };
 struct VS_OUTPUT
 {
@@ -24,6 +25,7 @@ struct VS_OUTPUT
     float4      shadowCoord     : TEXCOORD1;
     float4      bloomColor      : BLOOM;
     uint        isGameObject    : GAMEOBJECT;
+    uint        textureIndex    : TEXTUREINDEX;
 };
 VS_OUTPUT main(VS_INPUT input)
 {
@@ -36,5 +38,6 @@ VS_OUTPUT main(VS_INPUT input)
     output.shadowCoord = mul(worldPosition, root_constants.light);
     output.isGameObject = input.isGameObject;
     output.bloomColor = input.bloomColor;
+    output.textureIndex = input.textureIndex;
     return output;
 }
\ No newline at end of file
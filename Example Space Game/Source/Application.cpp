@@ -3,6 +3,8 @@
 #include "Systems/RenderLogic.h"
 #include "Components/Identification.h"
 #include "Helper/AudioHelper.h"
+#include "Helper/MemoryTracker.h"
+#include "Entities/UIElements.h"
 // open some Gateware namespaces for conveinence 
 // NEVER do this in a header file!
 using namespace GW;
@@ -16,8 +18,37 @@ bool Application::Init()
 	eventPusher.Create();
 	// load all game settigns
 	gameConfig = std::make_shared<GameConfig>(); 
+	// swap in the thread caching allocator before flecs allocates anything
+	std::string allocator = gameConfig->at("ECS").at("allocator").as<std::string>();
+	bool trackMemory = MemoryTracker::Init(gameConfig);
+	if (allocator != "system" || trackMemory)
+	{
+		ecs_os_set_api_defaults();
+		ecs_os_api_t os_api = ecs_os_get_api();
+		if (allocator != "system")
+			ecs_os_alloc_set_api(&os_api, allocator == "caching_huge");
+		// the tracker counts on top of whichever allocator is in use
+		if (trackMemory)
+			MemoryTracker::HookEcs(os_api);
+		ecs_os_set_api(&os_api);
+	}
 	// create the ECS system
 	game = std::make_shared<flecs::world>();
+	// systems marked multi_threaded are split across this many worker stages
+	game->set_threads(gameConfig->at("ECS").at("threads").as<int>());
+	// systems and HUD labels are looked up by name, cache the resolved paths
+	if (gameConfig->at("ECS").at("lookup_cache").as<bool>())
+		game->lookup_cache().enable();
+#ifdef FLECS_JOURNAL
+	// record world changes from here on, so a session can be replayed later
+	std::string journal = gameConfig->at("ECS").at("journal").as<std::string>();
+	if (!journal.empty())
+		ecs_journal_open(*game, journal.c_str(), gameConfig->at("ECS").at("journal_size_mb").as<int>() * 1024 * 1024);
+#endif
+	// serve the flecs REST api, Tools/StatsStream reads live frame stats from it
+	int restPort = gameConfig->at("ECS").at("rest_port").as<int>();
+	if (restPort > 0)
+		game->set<flecs::Rest>({ static_cast<uint16_t>(restPort) });
 	game->set<GameplayStats>({ 0 });
 	// init all other systems
 	if (InitWindow() == false) 
@@ -31,8 +62,8 @@ bool Application::Init()
     // NOTE: We Initialize Rendering here so that
 	// entities can load in Mesh Data when they're
 	// initialized.
-	// TODO: Add Error Checking for Init Failure
-	RenderSystem::InitBackend(gameConfig, vulkan, window);
+	if (RenderSystem::InitBackend(gameConfig, vulkan, window) == false)
+		return false;
 	if (InitEntities() == false)
 		return false;
 	if (InitUIEntities() == false)
@@ -51,6 +82,8 @@ bool Application::Run()
 	clrAndDepth[1].depthStencil = { 1.0f, 0u };
 	// grab vsync selection
 	bool vsync = gameConfig->at("Window").at("vsync").as<bool>();
+	// stress runs measure frame times, vsync would cap them
+	vsync = vsync && !stressSystem.IsEnabled();
 	// set background color from settings
 	const char* channels[] = { "red", "green", "blue" };
 	for (int i = 0; i < std::size(channels); ++i) {
@@ -74,7 +107,8 @@ bool Application::Run()
 		{
 			if (GameLoop() == false) {
 				vulkan.EndFrame(vsync);
-				return false;
+				// finished stress runs and replays quit the world, that's a normal exit
+				return game->should_quit();
 			}
 			if (-vulkan.EndFrame(vsync)) {
 				// failing EndFrame is not always a critical error, see the GW docs for specifics
@@ -99,7 +133,14 @@ bool Application::Shutdown()
 		return false;
 	if (enemySystem.Shutdown() == false)
 		return false;
+	if (stressSystem.Shutdown() == false)
+		return false;
+	if (inputReplay->Shutdown() == false)
+		return false;
     RenderSystem::ExitSystems();
+	// anything still live here was never released
+	if (MemoryTracker::IsEnabled())
+		MemoryTracker::PrintReport();
 
 	return true;
 }
@@ -128,6 +169,10 @@ bool Application::InitInput()
 		return false;
 	if (-bufferedInput.Create(window))
 		return false;
+	// the rest of the game reads the keyboard through the replay layer
+	inputReplay = std::make_shared<InputReplay>();
+	if (inputReplay->Init(gameConfig, immediateInput, bufferedInput) == false)
+		return false;
 	return true;
 }
 
@@ -147,10 +192,12 @@ bool Application::InitGraphics()
 	};
 	if (+vulkan.Create(window, GW::GRAPHICS::DEPTH_BUFFER_SUPPORT,
 		sizeof(debugLayers) / sizeof(debugLayers[0]),
-		debugLayers, 0, nullptr, 0, nullptr, false))
+		debugLayers, 0, nullptr, 0, nullptr, true)) // all features, for bindless material indexing
 		return true;
 #else
-	if (+vulkan.Create(window, GW::GRAPHICS::DEPTH_BUFFER_SUPPORT))
+	// spelled out so release enables the same features RenderSystem checks for bindless
+	if (+vulkan.Create(window, GW::GRAPHICS::DEPTH_BUFFER_SUPPORT,
+		0, nullptr, 0, nullptr, 0, nullptr, true)) // all features, for bindless material indexing
 		return true;
 #endif
 	return false;
@@ -169,6 +216,8 @@ bool Application::InitEntities()
 	// Load the enemy entities
 	if (enemies.Load(game, gameConfig, audioEngine) == false)
 		return false;
+	if (inputReplay->IsDeterministic())
+		level.MakeDeterministic(inputReplay->GetSeed());
 	if (level.Init(game, gameConfig) == false)
 		return false;
 	return true;
@@ -313,15 +362,25 @@ bool Application::InitUIEntities()
 		"GAME OVER"           // Text Buffer
 	});
 	game->set_scope(prevScope);
+	// the state machine toggles these, keep handles instead of names
+	RegisterUIElement(UI_START_CANVAS, startCanvas);
+	RegisterUIElement(UI_PAUSED_CANVAS, gamePaused);
+	RegisterUIElement(UI_LEVEL_COMPLETED_CANVAS, levelCompletedCanvas);
+	RegisterUIElement(UI_YOU_WON_CANVAS, playerWon);
+	RegisterUIElement(UI_YOU_DIED_CANVAS, playerDied);
+	RegisterUIElement(UI_DEFEATED_CANVAS, playerDefeated);
 	return true;
 }
 
 bool Application::InitSystems()
 {
 	// connect systems to global ECS
-	if (playerSystem.Init(	game, gameConfig, immediateInput, bufferedInput, 
+	if (playerSystem.Init(	game, gameConfig, inputReplay, 
 							gamePads, audioEngine, eventPusher) == false)
 		return false;
+	// recorded sessions need the same enemies on every replay
+	if (inputReplay->IsDeterministic())
+		levelSystem.MakeDeterministic(inputReplay->GetSeed());
 	if (levelSystem.Init(game, gameConfig, audioEngine, eventPusher) == false)
 		return false;
 	// TODO: Add Error Checking for Init Failure
@@ -332,6 +391,17 @@ bool Application::InitSystems()
 		return false;
 	if (enemySystem.Init(game, gameConfig, eventPusher) == false)
 		return false;
+	if (stressSystem.Init(game, gameConfig) == false)
+		return false;
+	// once a second is plenty to catch a subsystem growing past its budget
+	game->system("Memory Budget System")
+		.kind(flecs::OnStore)
+		.no_readonly()
+		.interval(1.0f)
+		.iter([](flecs::iter& it) {
+		MemoryTracker::SampleEcs(it.world());
+		MemoryTracker::CheckBudgets();
+	});
 	playerSystem.Activate(false);
 	enemySystem.Activate(false);
 	return true;
@@ -344,18 +414,43 @@ bool Application::GameLoop()
 	double elapsed = std::chrono::duration<double>(
 		std::chrono::steady_clock::now() - start).count();
 	start = std::chrono::steady_clock::now();
+	// recordings and replays step a fixed dt so both simulate the same frames
+	if (inputReplay->IsDeterministic())
+		elapsed = inputReplay->GetFixedDelta();
+	// hand this frame's input to the systems, a replay quits once it runs out
+	if (inputReplay->BeginFrame() == false)
+		game->quit();
 	// let the ECS system run
 	return game->progress(static_cast<float>(elapsed)); 
 }
 
 bool Application::InitStateMachine() {
 	stateEvents.Create(32);
-	bufferedInput.Register(stateEvents);
+	inputReplay->Register(stateEvents);
 	currentLevel = LEVEL_START;
 	level.Load(game, currentLevel);
 	levelSystem.Reset();
 	game->set<GameStateManager>({STATE_START});
+	// a stress run skips the start screen and plays level one with generated load
+	if (stressSystem.IsEnabled()) {
+		RetreiveUIElement(UI_START_CANVAS).get_mut<UICanvas>()->isVisible = false;
+		currentLevel = LEVEL_ONE;
+		level.Load(game, currentLevel);
+		// the level's own spawns are off and killing enemies never clears it
+		LevelStats stats = *game->get<LevelStats>();
+		stats.startingSpawnCount = ~(0u);
+		game->set<LevelStats>(stats);
+		levelSystem.Reset();
+		levelSystem.Activate(false);
+		playerSystem.Activate(true);
+		enemySystem.Clear();
+		enemySystem.Activate(true);
+		stressSystem.Activate(true);
+		game->set<GameStateManager>({ STATE_GAMEPLAY, STATE_UNDEFINED });
+	}
+	// not readonly: level loads bulk insert scenery straight into the world
 	game->system<GameStateManager>("Game State System")
+		.no_readonly()
 		.each([this](flecs::entity e, GameStateManager& gameState) {
 		if(gameState.state == STATE_GAMEPLAY){
 			switch (gameState.target) {
@@ -363,7 +458,7 @@ bool Application::InitStateMachine() {
 					stateEvents.Clear();
 					return;
 				case STATE_PAUSE:
-					game->entity("PausedCanvas").get_mut<UICanvas>()->isVisible = true;
+					RetreiveUIElement(UI_PAUSED_CANVAS).get_mut<UICanvas>()->isVisible = true;
 					playerSystem.Activate(false);
 					levelSystem.Activate(false);
 					enemySystem.Activate(false);
@@ -373,16 +468,16 @@ bool Application::InitStateMachine() {
 					break;
 				case STATE_LEVEL_COMPLETE:
 					if(currentLevel == LEVEL_COUNT - 1)
-						game->entity("YouWonCanvas").get_mut<UICanvas>()->isVisible = true;
+						RetreiveUIElement(UI_YOU_WON_CANVAS).get_mut<UICanvas>()->isVisible = true;
 					else
-						game->entity("LevelCompletedCanvas").get_mut<UICanvas>()->isVisible = true;
+						RetreiveUIElement(UI_LEVEL_COMPLETED_CANVAS).get_mut<UICanvas>()->isVisible = true;
 					enemySystem.Clear();
 					bulletSystem.Clear();
 					levelSystem.Activate(false);
 					break;
 				case STATE_DESTROYED:
-					PlaySound("Enemy Type1");
-					game->entity("YouDiedCanvas").get_mut<UICanvas>()->isVisible = true;
+					PlaySound(PREFAB_ENEMY_TYPE1);
+					RetreiveUIElement(UI_YOU_DIED_CANVAS).get_mut<UICanvas>()->isVisible = true;
 					bulletSystem.Clear();
 					enemySystem.Clear();
 					playerSystem.Activate(false);
@@ -390,7 +485,7 @@ bool Application::InitStateMachine() {
 					levelSystem.Activate(false);
 					break;
 				case STATE_GAMEOVER:
-					game->entity("DefeatedCanvas").get_mut<UICanvas>()->isVisible = true;
+					RetreiveUIElement(UI_DEFEATED_CANVAS).get_mut<UICanvas>()->isVisible = true;
 					bulletSystem.Clear();
 					playerSystem.Activate(false);
 					enemySystem.Activate(false);
@@ -407,7 +502,7 @@ bool Application::InitStateMachine() {
 				if (k_data.data == G_KEY_ENTER && keyboard == GW::INPUT::GBufferedInput::Events::KEYPRESSED) {
 					switch (gameState.state) {
 						case STATE_START:
-							game->entity("StartCanvas").get_mut<UICanvas>()->isVisible = false;
+							RetreiveUIElement(UI_START_CANVAS).get_mut<UICanvas>()->isVisible = false;
 							currentTrack.Create("../Music/level_01.wav", audioEngine, 0.01f);
 							currentTrack.Play(true);
 							gameState.state = STATE_GAMEPLAY;
@@ -420,7 +515,7 @@ bool Application::InitStateMachine() {
 							levelSystem.Reset();
 							break;
 						case STATE_PAUSE:
-							game->entity("PausedCanvas").get_mut<UICanvas>()->isVisible = false;
+							RetreiveUIElement(UI_PAUSED_CANVAS).get_mut<UICanvas>()->isVisible = false;
 							if (currentLevel == LEVEL_ONE) {
 								currentTrack.Create("../Music/level_01.wav", audioEngine, 0.01f);
 								currentTrack.Play(true);
@@ -464,19 +559,19 @@ bool Application::InitStateMachine() {
 							gameState.target = STATE_UNDEFINED;
 							if(currentLevel == LEVEL_START)
 							{
-								game->entity("YouWonCanvas").get_mut<UICanvas>()->isVisible = false;
+								RetreiveUIElement(UI_YOU_WON_CANVAS).get_mut<UICanvas>()->isVisible = false;
 								currentLevel = LEVEL_ENDLESS_ONE;
 							}
 							else
 							{
-								game->entity("LevelCompletedCanvas").get_mut<UICanvas>()->isVisible = false;
+								RetreiveUIElement(UI_LEVEL_COMPLETED_CANVAS).get_mut<UICanvas>()->isVisible = false;
 							}
 							level.Load(game, currentLevel);
 							levelSystem.Reset();
 							levelSystem.Activate(true);
 							break;
 						case STATE_DESTROYED:
-							game->entity("YouDiedCanvas").get_mut<UICanvas>()->isVisible = false;
+							RetreiveUIElement(UI_YOU_DIED_CANVAS).get_mut<UICanvas>()->isVisible = false;
 							gameState.state = STATE_GAMEPLAY;
 							gameState.target = STATE_UNDEFINED;
 							playerSystem.Activate(true);
@@ -486,8 +581,8 @@ bool Application::InitStateMachine() {
 						case STATE_GAMEOVER:
 							gameState.state = STATE_START;
 							currentLevel = LEVEL_START;
-							game->entity("DefeatedCanvas").get_mut<UICanvas>()->isVisible = false;
-							game->entity("StartCanvas").get_mut<UICanvas>()->isVisible = true;
+							RetreiveUIElement(UI_DEFEATED_CANVAS).get_mut<UICanvas>()->isVisible = false;
+							RetreiveUIElement(UI_START_CANVAS).get_mut<UICanvas>()->isVisible = true;
 							enemySystem.Clear();
 							bulletSystem.Clear();
 							level.Unload(game);
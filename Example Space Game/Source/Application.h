@@ -16,6 +16,9 @@
 #include "Systems/PhysicsLogic.h"
 #include "Systems/BulletLogic.h"
 #include "Systems/EnemyLogic.h"
+#include "Systems/StressLogic.h"
+// Records and replays the input of a session
+#include "Helper/InputReplay.h"
 
 namespace TeamYellow { enum LevelState; };
 
@@ -28,6 +31,7 @@ class Application
 	GW::INPUT::GController gamePads; // controller support
 	GW::INPUT::GInput immediateInput; // twitch keybaord/mouse
 	GW::INPUT::GBufferedInput bufferedInput; // event keyboard/mouse
+	std::shared_ptr<TeamYellow::InputReplay> inputReplay; // keyboard as the game sees it, live or replayed
 	GW::AUDIO::GAudio audioEngine; // can create music & sound effects
 	// third-party gameplay & utility libraries
 	std::shared_ptr<flecs::world> game; // ECS database for gameplay
@@ -42,6 +46,7 @@ class Application
 	TeamYellow::PhysicsLogic physicsSystem;
 	TeamYellow::BulletLogic bulletSystem;
 	TeamYellow::EnemyLogic enemySystem;
+	TeamYellow::StressLogic stressSystem;
 	TeamYellow::LevelData level;
 	// EventGenerator for Game Events
 	GW::CORE::GEventGenerator eventPusher;
@@ -32,6 +32,10 @@ namespace TeamYellow
 
 	// powerups
 	struct ChargedShot { int max_destroy; };
+
+	// stress runs
+	struct Lifetime         { float value; }; // seconds left before the entity is destroyed
+	struct AutoPilot        { float xaxis; float yaxis; }; // replaces player input, -1 to 1
 };
 
 #endif
\ No newline at end of file
@@ -11,6 +11,8 @@ namespace TeamYellow
 	struct Orientation { GW::MATH2D::GMATRIX2F value; GW::MATH2D::GMATRIX2F target; };
 	struct Scale { GW::MATH::GVECTORF value; };
 	struct Acceleration { GW::MATH2D::GVECTOR2F value; };
+	// Singleton holding the last known player position, shared with worker threads
+	struct PlayerPosition { GW::MATH2D::GVECTOR2F value; };
 
 	// Individual TAGs
 	struct Collidable {}; 
@@ -38,7 +38,7 @@ bool ESG::BombData::Load(std::shared_ptr<flecs::world> _game,
 		.override<Position>()
 		.override<Bomb>();
 
-	RegisterPrefab("Bomb", bombPrefab);
+	RegisterPrefab(PREFAB_BOMB, bombPrefab);
 
 	return true;
 }
@@ -50,7 +50,7 @@ bool ESG::BombData::Unload(std::shared_ptr<flecs::world> _game) {
 				});
 	_game->defer_end();
 
-	UnregisterPrefab("Bomb");
+	UnregisterPrefab(PREFAB_BOMB);
 
 	return true;
 }
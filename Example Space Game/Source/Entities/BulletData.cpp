@@ -24,6 +24,7 @@ bool TeamYellow::BulletData::Load(	std::shared_ptr<flecs::world> _game,
 	int dmg = (*readCfg).at("Lazers").at("damage").as<int>();
 	int pcount = (*readCfg).at("Lazers").at("projectiles").as<int>();
 	float frate = (*readCfg).at("Lazers").at("firerate").as<float>();
+	int reserve = (*readCfg).at("Lazers").at("reserve").as<int>();
 	std::string fireFX = (*readCfg).at("Lazers").at("fireFX").as<std::string>();
     // NOTE: PlayerData.cpp.l:25
     std::string meshPath = (*readCfg).at("Lazers").at("meshpath").as<std::string>();
@@ -52,8 +53,12 @@ bool TeamYellow::BulletData::Load(	std::shared_ptr<flecs::world> _game,
 		.override<Gameobject>()
 		.override<Collidable>(); // can be collided with
 
-	// register this prefab by name so other systems can use it
-	RegisterPrefab("Lazer Bullet", lazerPrefab);
+	// register this prefab by handle so other systems can use it
+	RegisterPrefab(PREFAB_LAZER_BULLET, lazerPrefab);
+	// lazers are created & destroyed constantly, allocate their tables up front
+	ReservePrefabInstances(PREFAB_LAZER_BULLET, reserve, { _game->id<AlliedWith>() });
+	ReservePrefabInstances(PREFAB_LAZER_BULLET, reserve,
+		{ _game->id<AlliedWith>(), _game->id<ChargedShot>() });
 
 	return true;
 }
@@ -67,8 +72,8 @@ bool TeamYellow::BulletData::Unload(std::shared_ptr<flecs::world> _game)
 	});
 	_game->defer_end(); // required when removing while iterating!
 
-	// unregister this prefab by name
-	UnregisterPrefab("Lazer Bullet");
+	// unregister this prefab
+	UnregisterPrefab(PREFAB_LAZER_BULLET);
 
 	return true;
 }
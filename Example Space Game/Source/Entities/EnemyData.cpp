@@ -24,6 +24,7 @@ bool EnemyData::Load(	std::shared_ptr<flecs::world> _game,
 	int health = (*readCfg).at("Enemy1").at("health").as<int>();
 	int pointValue = (*readCfg).at("Enemy1").at("pointValue").as<int>();
 	float cooldown = (*readCfg).at("Enemy1").at("cooldown").as<float>();
+	int reserve = (*readCfg).at("Enemy1").at("reserve").as<int>();
 	float startY = (*readCfg).at("Enemy1").at("ystart").as<float>();
 	float accmax = (*readCfg).at("Enemy1").at("accmax").as<float>();
 	float accmin = (*readCfg).at("Enemy1").at("accmin").as<float>();
@@ -61,8 +62,10 @@ bool EnemyData::Load(	std::shared_ptr<flecs::world> _game,
 	.set_override<Cooldown>({ cooldown, cooldown })
 	.set_override<Damage>({ 10 });
 
-	// register this prefab by name so other systems can use it
-	RegisterPrefab("Enemy Type1", enemyPrefab);
+	// register this prefab by handle so other systems can use it
+	RegisterPrefab(PREFAB_ENEMY_TYPE1, enemyPrefab);
+	// spawned enemies get their own Orientation, allocate their table up front
+	ReservePrefabInstances(PREFAB_ENEMY_TYPE1, reserve, { _game->id<Orientation>() });
 
 	return true;
 }
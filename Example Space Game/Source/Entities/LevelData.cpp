@@ -8,6 +8,7 @@
 #include "../Components/Physics.h"
 
 #include "../Systems/RenderLogic.h"
+#include "../Utils/BulkInit.h"
 
 using namespace TeamYellow;
 
@@ -26,6 +27,9 @@ bool LevelData::Init(std::shared_ptr<flecs::world> _game,
 	levels[LEVEL_ONE].floorMeshID = floorMeshID;
 	levels[LEVEL_TWO].floorMeshID = floorMeshID;
 	levels[LEVEL_THREE].floorMeshID = floorMeshID;
+	floorPrefab = _game->prefab()
+		.set<Orientation>({ GW::MATH2D::GIdentityMatrix2F, GW::MATH2D::GIdentityMatrix2F })
+		.set<Scale>({ GW::MATH::GVECTORF{ 1, 1, 1, 0 } });
 	InitLevelReadOnlyData(_game, (*readCfg).at("Level1"), levels[LEVEL_ONE]);
 	InitLevelReadOnlyData(_game, (*readCfg).at("Level2"), levels[LEVEL_TWO]);
 	InitLevelReadOnlyData(_game, (*readCfg).at("Level3"), levels[LEVEL_THREE]);
@@ -69,6 +73,19 @@ void LevelData::InitLevelReadOnlyData(std::shared_ptr<flecs::world> _game,
 	/*-----------------------------------------------------------------------*/
 	std::string skyBoxTexturePathStrings = _section.at("skybox").as<std::string>();
 	_data.skyBoxID = RenderSystem::RegisterSkybox(skyBoxTexturePathStrings.c_str());
+	/*-----------------------------------------------------------------------*/
+	/* Shared Building Components                                            */
+	/*-----------------------------------------------------------------------*/
+	float scale = _data.environmentObjectScale;
+	_data.buildingPrefab = _game->prefab()
+		.set<Orientation>({ GW::MATH2D::GIdentityMatrix2F, GW::MATH2D::GIdentityMatrix2F })
+		.set<Scale>({ GW::MATH::GVECTORF{ scale, scale, scale, 0 } });
+}
+
+void LevelData::MakeDeterministic(unsigned _seed)
+{
+	deterministic = true;
+	seed = _seed;
 }
 
 bool LevelData::Load(std::shared_ptr<flecs::world> _game,
@@ -80,42 +97,54 @@ bool LevelData::Load(std::shared_ptr<flecs::world> _game,
 	/*=======================================================================*/
 	/* Populate Environment Entities                                         */
 	/*=======================================================================*/
-	GW::MATH2D::GMATRIX2F world = GW::MATH2D::GIdentityMatrix2F;
+	// Scenery is only generated the first time a level loads. Restarts and
+	// endless loops copy the cached columns back with one bulk insert per layer.
+	SceneryCache& cache = sceneryCache[_level];
+	if (!cache.generated)
+		GenerateScenery(_level, cache);
+	// bulk inserts write straight into tables, state changes load levels from
+	// inside a system so step out of deferred mode while populating
+	bool deferred = _game->is_deferred();
+	if (deferred) _game->defer_suspend();
+	SpawnLayer(*_game, cache.background, _game->id<Background>(), levels[_level].buildingPrefab); // Tag these as Background Objects
+	SpawnLayer(*_game, cache.floor, _game->id<Floor>(), floorPrefab); // Tag these as Floor
+	SpawnLayer(*_game, cache.foreground, _game->id<Foreground>(), levels[_level].buildingPrefab); // Tag these as Foreground Objects
+	if (deferred) _game->defer_resume();
+	return true;
+}
+
+void LevelData::GenerateScenery(LevelState _level, SceneryCache& _cache)
+{
 	std::random_device rd;  // Will be used to obtain a seed for the random number engine
-	std::mt19937 gen(rd()); // Standard mersenne_twister_engine seeded with rd()
+	// recorded sessions need the same scenery, each level gets its own sequence
+	std::mt19937 gen(deterministic ? seed + _level : rd());
 	const auto& meshBounds = RenderSystem::GetMeshBoundsVector();
+	/*-----------------------------------------------------------------------*/
+	/* Background Buildings                                                  */
+	/*-----------------------------------------------------------------------*/
 	std::uniform_int_distribution<uint32_t> bgMeshSelector(2, 4);
 	float xPos = levels[_level].halfWidth;
 	while (xPos > -levels[_level].halfWidth) {
 		uint32_t buildingIndex = bgMeshSelector(gen);
 		const auto& bounds = meshBounds[levels[_level].meshIDs[buildingIndex]];
 		xPos -= fabs(bounds.min.z) * levels[_level].environmentObjectScale;
-		_game->entity() 
-			.set([&](Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm) {
-			p = { -30,  xPos };
-			sm = { levels[_level].meshIDs[buildingIndex] };
-			o = { world, world };
-			s = { levels[_level].environmentObjectScale, levels[_level].environmentObjectScale, levels[_level].environmentObjectScale, 0 };
-				})
-			.add<Background>(); // Tag this entity as a Background Object
-				xPos -= fabs(bounds.max.z) * levels[_level].environmentObjectScale;
+		_cache.background.positions.push_back({ -30,  xPos });
+		_cache.background.meshes.push_back({ levels[_level].meshIDs[buildingIndex] });
+		xPos -= fabs(bounds.max.z) * levels[_level].environmentObjectScale;
 	}
+	/*-----------------------------------------------------------------------*/
+	/* Floor Tiles                                                           */
+	/*-----------------------------------------------------------------------*/
 	xPos = levels[_level].halfWidth;
 	while(xPos > -levels[_level].halfWidth) {
 		const auto& bounds = meshBounds[levels[_level].floorMeshID];
 		xPos -= fabs(bounds.min.y) * 1;
-		_game->entity()
-			.set([&](Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm) {
-				p = { -31,  xPos };
-				sm = { levels[_level].floorMeshID };
-				o = { world, world };
-				s = { 1, 1, 1, 0 };
-			})
-			.add<Floor>(); // Tag this entity as a Floor
+		_cache.floor.positions.push_back({ -31,  xPos });
+		_cache.floor.meshes.push_back({ levels[_level].floorMeshID });
 		xPos-= fabs(bounds.max.y) * 1;
 	}
 	/*-----------------------------------------------------------------------*/
-	/* Spawn Foreground Entities                                             */
+	/* Foreground Buildings                                                  */
 	/*-----------------------------------------------------------------------*/
 	std::uniform_int_distribution<uint32_t> fgMeshSelector(0, 1);
 	xPos = levels[_level].halfWidth;
@@ -123,33 +152,35 @@ bool LevelData::Load(std::shared_ptr<flecs::world> _game,
 		uint32_t buildingIndex = fgMeshSelector(gen);
 		const auto& bounds = meshBounds[levels[_level].meshIDs[buildingIndex]];
 		xPos -= fabs(bounds.min.y) * levels[_level].environmentObjectScale;
-		_game->entity()
-			.set([&](Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm) {
-			p = { -30,  xPos };
-			sm = { levels[_level].meshIDs[buildingIndex] };
-			o = { world, world };
-			s = { levels[_level].environmentObjectScale, levels[_level].environmentObjectScale, levels[_level].environmentObjectScale, 0 };
-				})
-			.add<Foreground>(); // Tag this entity as a Foreground Object
-				xPos -= fabs(bounds.max.y) * levels[_level].environmentObjectScale;
+		_cache.foreground.positions.push_back({ -30,  xPos });
+		_cache.foreground.meshes.push_back({ levels[_level].meshIDs[buildingIndex] });
+		xPos -= fabs(bounds.max.y) * levels[_level].environmentObjectScale;
 	}
-	return true;
+	_cache.generated = true;
+}
+
+void LevelData::SpawnLayer(flecs::world& _game, const SceneryLayer& _layer,
+	flecs::id_t _layerTag, flecs::entity _prefab)
+{
+	if (_layer.positions.empty()) return;
+	// Position & StaticMeshComponent are trivially copyable, so this is a
+	// memcpy of each cached column into the layer's table
+	BulkInit(_game, static_cast<int32_t>(_layer.positions.size()),
+		{ _layerTag, ecs_pair(flecs::IsA, _prefab) },
+		_layer.positions.data(), _layer.meshes.data());
 }
 
 bool LevelData::Unload(std::shared_ptr<flecs::world> _game)
 {
-	// remove all buildings
-	_game->defer_begin(); // required when removing while iterating!
-	_game->each([](flecs::entity e,Foreground&) {
-		e.destruct(); // destroy this entitiy (happens at frame end)
-		});
-	_game->each([](flecs::entity e, Floor&) {
-		e.destruct(); // destroy this entitiy (happens at frame end)
-		});
-	_game->each([](flecs::entity e, Background&) {
-		e.destruct(); // destroy this entitiy (happens at frame end)
-		});
-	_game->defer_end(); // required when removing while iterating!
+	// remove all buildings, a whole table at a time. This has to happen right
+	// away: a deferred delete_with would also catch the scenery of the level
+	// that is loaded next, since Load inserts immediately.
+	bool deferred = _game->is_deferred();
+	if (deferred) _game->defer_suspend();
+	_game->delete_with<Foreground>();
+	_game->delete_with<Floor>();
+	_game->delete_with<Background>();
+	if (deferred) _game->defer_resume();
 
 	return true;
 }
@@ -3,6 +3,8 @@
 
 #include "../GameConfig.h"
 #include "../Components/Identification.h"
+#include "../Components/Physics.h"
+#include "../Components/Visuals.h"
 
 namespace TeamYellow
 {
@@ -17,13 +19,37 @@ namespace TeamYellow
 			uint32_t    floorMeshID;
 			uint32_t    skyBoxID;
 			uint32_t    meshIDs[5];
+			// shares Orientation and Scale with every building of the level
+			flecs::entity buildingPrefab;
 		};
 		LevelReadOnlyData levels[LEVEL_COUNT];
+		// shares Orientation and Scale with every floor tile
+		flecs::entity floorPrefab;
+		// one layer of scenery stored as component columns
+		struct SceneryLayer
+		{
+			std::vector<Position> positions;
+			std::vector<StaticMeshComponent> meshes;
+		};
+		// generated the first time a level loads, copied back on every later load
+		struct SceneryCache
+		{
+			bool generated = false;
+			SceneryLayer background;
+			SceneryLayer floor;
+			SceneryLayer foreground;
+		};
+		SceneryCache sceneryCache[LEVEL_COUNT];
+		// seeds the scenery generator when set, instead of a random device
+		bool deterministic = false;
+		unsigned seed = 0;
 
 	public:
 		GW::MATH2D::GMatrix2D matrixMath;
 		bool Init(std::shared_ptr<flecs::world> _game,
 			std::weak_ptr<const GameConfig> _gameConfig);
+		// generates the same scenery on every run, call before the first Load
+		void MakeDeterministic(unsigned _seed);
 		// Load required entities and/or prefabs into the ECS 
 		bool Load(std::shared_ptr<flecs::world> _game,
 			LevelState _level);
@@ -33,6 +59,9 @@ namespace TeamYellow
 		void InitLevelReadOnlyData(std::shared_ptr<flecs::world> _game,
 			const ini::IniSection& _section,
 			LevelReadOnlyData& _data);
+		void GenerateScenery(LevelState _level, SceneryCache& _cache);
+		void SpawnLayer(flecs::world& _game, const SceneryLayer& _layer,
+			flecs::id_t _layerTag, flecs::entity _prefab);
 	};
 };
 
@@ -1,40 +1,60 @@
 #include "Prefabs.h"
+#include <cassert>
 
 // nameless namespaces are a way to restrict/control global data
 // I prefer them to the singleton design pattern 
 namespace 
 {
-	std::map<std::string, flecs::entity> prefabMap;
+	// indexed by TeamYellow::PrefabID, a null entity marks an empty slot
+	flecs::entity prefabTable[TeamYellow::PREFAB_COUNT];
 }
 // functions defined in this file have access to the data in the nameless namespace above
 namespace TeamYellow
 {
 	// interface implementations to access protected data set above
-	bool RegisterPrefab(const char* prefabName, const flecs::entity inPrefab)
+	bool RegisterPrefab(PrefabID prefabID, const flecs::entity inPrefab)
 	{
-		auto iter = prefabMap.find(prefabName);
-		if (iter == prefabMap.end()) {
-			prefabMap[std::string(prefabName)] = inPrefab;
+		assert(prefabID < PREFAB_COUNT);
+		if (prefabTable[prefabID].id() == 0) {
+			prefabTable[prefabID] = inPrefab;
 			return true;
 		}
 		return false; // already exists
 	}
-	bool RetreivePrefab(const char* prefabName, flecs::entity& outPrefab)
+	bool RetreivePrefab(PrefabID prefabID, flecs::entity& outPrefab)
 	{
-		auto iter = prefabMap.find(prefabName);
-		if (iter != prefabMap.end()) {
-			outPrefab = prefabMap[std::string(prefabName)];
+		assert(prefabID < PREFAB_COUNT);
+		outPrefab = prefabTable[prefabID];
+		if (outPrefab.id() != 0) {
+			// a prefab destroyed without being unregistered leaves a stale handle
+			assert(outPrefab.is_alive() && "stale prefab handle, was it unregistered?");
 			return true;
 		}
 		return false; // prefab not found
 	}
-	bool UnregisterPrefab(const char* prefabName)
+	bool UnregisterPrefab(PrefabID prefabID)
 	{
-		auto iter = prefabMap.find(prefabName);
-		if (iter != prefabMap.end()) {
-			prefabMap.erase(iter);
+		assert(prefabID < PREFAB_COUNT);
+		if (prefabTable[prefabID].id() != 0) {
+			prefabTable[prefabID] = flecs::entity();
 			return true;
 		}
 		return false; // prefab not found
 	}
+	bool ReservePrefabInstances(PrefabID prefabID, int32_t count,
+		std::initializer_list<flecs::id_t> extraIds)
+	{
+		assert(prefabID < PREFAB_COUNT);
+		flecs::entity prefab = prefabTable[prefabID];
+		if (prefab.id() == 0)
+			return false; // prefab not found
+		// find the table instances end up in, adding IsA also adds every
+		// component the prefab overrides
+		flecs::world world = prefab.world();
+		ecs_table_t* table = ecs_table_add_id(world, nullptr, ecs_pair(flecs::IsA, prefab));
+		for (flecs::id_t id : extraIds)
+			table = ecs_table_add_id(world, table, id);
+		ecs_table_reserve(world, table, count);
+		return true;
+	}
 }
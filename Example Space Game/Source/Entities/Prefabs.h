@@ -2,11 +2,26 @@
 #ifndef PREFABS_H
 #define PREFABS_H
 
+#include <initializer_list>
+
 namespace TeamYellow
 {
-	bool RegisterPrefab(const char* prefabName, const flecs::entity inPrefab);
-	bool RetreivePrefab(const char* prefabName, flecs::entity &outPrefab);
-	bool UnregisterPrefab(const char* prefabName);
+	// every prefab the game shares between systems, used as an index so
+	// hot paths (firing, spawning, sounds) never search by name
+	enum PrefabID {
+		PREFAB_LAZER_BULLET,
+		PREFAB_ENEMY_TYPE1,
+		PREFAB_BOMB,
+		PREFAB_COUNT
+	};
+
+	bool RegisterPrefab(PrefabID prefabID, const flecs::entity inPrefab);
+	bool RetreivePrefab(PrefabID prefabID, flecs::entity &outPrefab);
+	bool UnregisterPrefab(PrefabID prefabID);
+	// preallocates table storage for count instances of a registered prefab,
+	// extraIds are what instances add on top of the prefab's overrides
+	bool ReservePrefabInstances(PrefabID prefabID, int32_t count,
+		std::initializer_list<flecs::id_t> extraIds = {});
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,38 @@
+#include "UIElements.h"
+#include <cassert>
+
+namespace
+{
+	// indexed by TeamYellow::UIElementID, a null entity marks an empty slot
+	flecs::entity elementTable[TeamYellow::UI_ELEMENT_COUNT];
+}
+
+namespace TeamYellow
+{
+	bool RegisterUIElement(UIElementID elementID, const flecs::entity inElement)
+	{
+		assert(elementID < UI_ELEMENT_COUNT);
+		if (elementTable[elementID].id() == 0) {
+			elementTable[elementID] = inElement;
+			return true;
+		}
+		return false; // already exists
+	}
+	flecs::entity RetreiveUIElement(UIElementID elementID)
+	{
+		assert(elementID < UI_ELEMENT_COUNT);
+		// an element destroyed without being unregistered leaves a stale handle
+		assert((elementTable[elementID].id() == 0 || elementTable[elementID].is_alive())
+			&& "stale UI element handle, was it unregistered?");
+		return elementTable[elementID];
+	}
+	bool UnregisterUIElement(UIElementID elementID)
+	{
+		assert(elementID < UI_ELEMENT_COUNT);
+		if (elementTable[elementID].id() != 0) {
+			elementTable[elementID] = flecs::entity();
+			return true;
+		}
+		return false; // element not found
+	}
+}
@@ -0,0 +1,30 @@
+// uses a nameless namespace to register and retreive UI entities that are
+// updated while playing, so HUD changes skip flecs path lookups
+#ifndef UIELEMENTS_H
+#define UIELEMENTS_H
+
+namespace TeamYellow
+{
+	enum UIElementID {
+		UI_START_CANVAS,
+		UI_PAUSED_CANVAS,
+		UI_LEVEL_COMPLETED_CANVAS,
+		UI_YOU_WON_CANVAS,
+		UI_YOU_DIED_CANVAS,
+		UI_DEFEATED_CANVAS,
+		UI_HUD_CANVAS,
+		UI_HUD_ENEMIES_REMAINING_TEXT,
+		UI_HUD_HISCORE_TEXT,
+		UI_HUD_SCORE_TEXT,
+		UI_HUD_LIVES_TEXT,
+		UI_HUD_SPECIALS_TEXT,
+		UI_ELEMENT_COUNT
+	};
+
+	bool RegisterUIElement(UIElementID elementID, const flecs::entity inElement);
+	// O(1), returns a null entity if nothing was registered
+	flecs::entity RetreiveUIElement(UIElementID elementID);
+	bool UnregisterUIElement(UIElementID elementID);
+}
+
+#endif
@@ -3,7 +3,7 @@
 
 
 
-void PlaySound(const char* prefabSound) {
+void PlaySound(TeamYellow::PrefabID prefabSound) {
 	flecs::entity sound;
 	TeamYellow::RetreivePrefab(prefabSound, sound);
 	GW::AUDIO::GSound soundFX = *sound.get<GW::AUDIO::GSound>();
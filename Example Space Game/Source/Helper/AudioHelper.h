@@ -1,9 +1,10 @@
 #ifndef AUDIOHELPER_H
 #define AUDIOHELPER_H
 
+#include "../Entities/Prefabs.h"
 
-
-void PlaySound(const char* sound);
+// plays the GSound shared by a registered prefab
+void PlaySound(TeamYellow::PrefabID prefabSound);
 void PlayMusic(const char* music, GW::AUDIO::GAudio audioEngine,
 	float volume, bool play);
 
@@ -0,0 +1,175 @@
+#include "InputReplay.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace TeamYellow;
+using namespace GW::INPUT; // input libs
+
+bool InputReplay::Init(	std::weak_ptr<const GameConfig> _gameConfig,
+						GW::INPUT::GInput _immediateInput,
+						GW::INPUT::GBufferedInput _bufferedInput)
+{
+	immediateInput = _immediateInput;
+	bufferedInput = _bufferedInput;
+	std::shared_ptr<const GameConfig> readCfg = _gameConfig.lock();
+	std::string setting = (*readCfg).at("Replay").at("mode").as<std::string>();
+	mode = setting == "record" ? Mode::RECORD : setting == "replay" ? Mode::REPLAY : Mode::OFF;
+	path = (*readCfg).at("Replay").at("file").as<std::string>();
+	seed = (*readCfg).at("Replay").at("seed").as<unsigned>();
+	fixedDelta = (*readCfg).at("Replay").at("dt").as<float>();
+	if (-frameEvents.Create())
+		return false;
+	if (mode == Mode::REPLAY) {
+		// the recording decides the seed and dt, whatever the settings say now
+		input.open(path, std::ios_base::binary);
+		if (!input.is_open() || !ReadHeader()) {
+			std::cout << "Can't replay " << path << std::endl;
+			return false;
+		}
+		return true;
+	}
+	if (-liveEvents.Create(Max_Frame_Events) || -bufferedInput.Register(liveEvents))
+		return false;
+	if (mode == Mode::RECORD) {
+		output.open(path, std::ios_base::binary | std::ios_base::trunc);
+		if (!output.is_open()) {
+			std::cout << "Can't record to " << path << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool InputReplay::Track(int key)
+{
+	auto found = std::find(keys.begin(), keys.end(), key);
+	if (found != keys.end())
+		return true;
+	// a replay only knows the keys in its header, recordings write theirs on the first frame
+	if (mode == Mode::REPLAY || (mode == Mode::RECORD && frame > 0) || keys.size() >= Max_Keys)
+		return false;
+	keys.push_back(key);
+	return true;
+}
+
+bool InputReplay::Register(GW::CORE::GEventCache cache)
+{
+	return +frameEvents.Register(cache);
+}
+
+GW::GReturn InputReplay::GetState(int key, float& state) const
+{
+	auto found = std::find(keys.begin(), keys.end(), key);
+	if (found == keys.end())
+		return GW::GReturn::INVALID_ARGUMENT;
+	state = static_cast<float>((keyStates >> (found - keys.begin())) & 1u);
+	return GW::GReturn::SUCCESS;
+}
+
+bool InputReplay::BeginFrame()
+{
+	GW::GEvent event;
+	GBufferedInput::Events keyboard;
+	GBufferedInput::EVENT_DATA k_data;
+	if (mode == Mode::REPLAY) {
+		uint32_t recorded = 0;
+		uint16_t count = 0;
+		input.read(reinterpret_cast<char*>(&recorded), sizeof(recorded));
+		input.read(reinterpret_cast<char*>(&keyStates), sizeof(keyStates));
+		input.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!input || recorded != frame) {
+			std::cout << "Replay finished after " << frame << " frames" << std::endl;
+			return false;
+		}
+		for (uint16_t i = 0; i < count; ++i) {
+			uint8_t type = 0;
+			input.read(reinterpret_cast<char*>(&type), sizeof(type));
+			input.read(reinterpret_cast<char*>(&k_data), sizeof(k_data));
+			keyboard = static_cast<GBufferedInput::Events>(type);
+			event.Write(keyboard, k_data);
+			frameEvents.Push(event);
+		}
+		++frame;
+		return true;
+	}
+	// held keys are sampled once, so every system sees the same state this frame
+	keyStates = 0;
+	for (size_t i = 0; i < keys.size(); ++i) {
+		float state = 0;
+		immediateInput.GetState(keys[i], state);
+		if (state > 0)
+			keyStates |= 1u << i;
+	}
+	// the game only reads keys and buttons, mouse motion isn't worth recording
+	std::vector<GW::GEvent> events;
+	while (+liveEvents.Pop(event)) {
+		if (+event.Read(keyboard, k_data) &&
+			keyboard != GBufferedInput::Events::MOUSEMOVE && keyboard != GBufferedInput::Events::MOUSESCROLL)
+			events.push_back(event);
+	}
+	if (mode == Mode::RECORD) {
+		if (frame == 0 && !WriteHeader())
+			return false;
+		uint16_t count = static_cast<uint16_t>(events.size());
+		output.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+		output.write(reinterpret_cast<const char*>(&keyStates), sizeof(keyStates));
+		output.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (const GW::GEvent& e : events) {
+			e.Read(keyboard, k_data);
+			uint8_t type = static_cast<uint8_t>(keyboard);
+			output.write(reinterpret_cast<const char*>(&type), sizeof(type));
+			output.write(reinterpret_cast<const char*>(&k_data), sizeof(k_data));
+		}
+	}
+	for (const GW::GEvent& e : events)
+		frameEvents.Push(e);
+	++frame;
+	return true;
+}
+
+bool InputReplay::Shutdown()
+{
+	if (output.is_open()) {
+		output.close();
+		std::cout << "Recorded " << frame << " frames to " << path << std::endl;
+	}
+	if (input.is_open())
+		input.close();
+	return true;
+}
+
+// magic, version, seed, dt, key count and the tracked keys
+bool InputReplay::WriteHeader()
+{
+	uint32_t count = static_cast<uint32_t>(keys.size());
+	output.write(Magic, sizeof(Magic));
+	output.write(reinterpret_cast<const char*>(&Version), sizeof(Version));
+	output.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+	output.write(reinterpret_cast<const char*>(&fixedDelta), sizeof(fixedDelta));
+	output.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for (int32_t key : keys)
+		output.write(reinterpret_cast<const char*>(&key), sizeof(key));
+	return output.good();
+}
+
+bool InputReplay::ReadHeader()
+{
+	char magic[sizeof(Magic)];
+	uint32_t version = 0, count = 0;
+	input.read(magic, sizeof(magic));
+	input.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (!input || std::memcmp(magic, Magic, sizeof(Magic)) != 0 || version != Version)
+		return false;
+	input.read(reinterpret_cast<char*>(&seed), sizeof(seed));
+	input.read(reinterpret_cast<char*>(&fixedDelta), sizeof(fixedDelta));
+	input.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if (!input || count > Max_Keys)
+		return false;
+	keys.resize(count);
+	for (int& key : keys) {
+		int32_t recorded = 0;
+		input.read(reinterpret_cast<char*>(&recorded), sizeof(recorded));
+		key = recorded;
+	}
+	return input.good();
+}
@@ -0,0 +1,68 @@
+// Records the keyboard input the game reads each frame, or plays a recording back in its place
+#ifndef INPUTREPLAY_H
+#define INPUTREPLAY_H
+
+// Contains our global game settings
+#include "../GameConfig.h"
+#include <fstream>
+#include <vector>
+
+namespace TeamYellow
+{
+	class InputReplay
+	{
+	public:
+		enum class Mode { OFF, RECORD, REPLAY };
+	private:
+		Mode mode = Mode::OFF;
+		// the live input, only read when not replaying
+		GW::INPUT::GInput immediateInput;
+		GW::INPUT::GBufferedInput bufferedInput;
+		// the keyboard events of a frame reach the game's caches through here
+		GW::CORE::GEventGenerator frameEvents;
+		// live events waiting for the next frame
+		GW::CORE::GEventCache liveEvents;
+		// keys whose held state is sampled once per frame, one bit each
+		std::vector<int> keys;
+		uint32_t keyStates = 0;
+		// the recording, frames follow a header with the seed, dt and keys
+		std::ofstream output;
+		std::ifstream input;
+		std::string path;
+		uint32_t frame = 0;
+		float fixedDelta = 0;
+		unsigned seed = 0;
+	public:
+		// opens the recording, replays read the seed, dt and keys from its header
+		bool Init(	std::weak_ptr<const GameConfig> _gameConfig,
+					GW::INPUT::GInput _immediateInput,
+					GW::INPUT::GBufferedInput _bufferedInput);
+		// samples a key every frame, replays can only answer for recorded keys
+		bool Track(int key);
+		// connects an event cache to the keyboard events of each frame
+		bool Register(GW::CORE::GEventCache cache);
+		// held state of a tracked key this frame, 0 or 1
+		GW::GReturn GetState(int key, float& state) const;
+		// records or replays one frame of input, false once a replay runs out
+		bool BeginFrame();
+		Mode GetMode() const { return mode; }
+		// recording and replaying both run on a fixed dt and seeded spawns
+		bool IsDeterministic() const { return mode != Mode::OFF; }
+		float GetFixedDelta() const { return fixedDelta; }
+		unsigned GetSeed() const { return seed; }
+		// flushes and closes the recording
+		bool Shutdown();
+	private:
+		// maximum number of tracked keys, one bit of keyStates each
+		static constexpr unsigned int Max_Keys = 32;
+		// how many live events can arrive between two frames
+		static constexpr unsigned int Max_Frame_Events = 128;
+		static constexpr char Magic[4] = { 'S', 'D', 'R', 'P' };
+		static constexpr uint32_t Version = 1;
+		// helper routines
+		bool WriteHeader();
+		bool ReadHeader();
+	};
+};
+
+#endif
@@ -0,0 +1,262 @@
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstring>
+
+using namespace TeamYellow;
+
+namespace
+{
+// the ini keys of the budgets, in tag order
+const char* tagKeys[MEMORY_TAG_COUNT] = {
+	"ecs_tables", "ecs_indices", "geometry", "textures", "render_targets",
+	"frame_data", "staging", "ui", "pipelines" };
+const char* tagNames[MEMORY_TAG_COUNT] = {
+	"ECS tables", "ECS indices", "Geometry", "Textures", "Render targets",
+	"Frame data", "Staging", "UI", "Pipelines" };
+
+bool enabled = false;
+std::atomic<int64_t> live[MEMORY_TAG_COUNT];
+std::atomic<int64_t> peak[MEMORY_TAG_COUNT];
+std::atomic<int64_t> device[MEMORY_TAG_COUNT];
+int64_t budget[MEMORY_TAG_COUNT];
+bool overBudget[MEMORY_TAG_COUNT];
+// everything flecs holds on the heap, split into two tags by SampleEcs
+std::atomic<int64_t> ecsHeap;
+// the heap functions the hooks forward to
+ecs_os_api_malloc_t nextMalloc;
+ecs_os_api_calloc_t nextCalloc;
+ecs_os_api_realloc_t nextRealloc;
+ecs_os_api_free_t nextFree;
+VkAllocationCallbacks vulkanCallbacks[MEMORY_TAG_COUNT];
+
+// stored in front of every hooked allocation so frees know what to subtract
+struct alignas(16) AllocationHeader
+{
+	int64_t size;
+	uint32_t tag;
+	uint32_t offset; // from the start of the block to the returned pointer
+};
+
+void UpdatePeak(MemoryTag _tag, int64_t _live)
+{
+	int64_t previous = peak[_tag].load(std::memory_order_relaxed);
+	while (_live > previous && !peak[_tag].compare_exchange_weak(previous, _live, std::memory_order_relaxed));
+}
+
+AllocationHeader* HeaderOf(void* _pointer)
+{
+	return reinterpret_cast<AllocationHeader*>(_pointer) - 1;
+}
+
+/*---------------------------------------------------------------------------*/
+/* flecs OS API hooks, chained to whichever allocator was installed before   */
+/*---------------------------------------------------------------------------*/
+void* EcsMalloc(ecs_size_t _size)
+{
+	void* block = nextMalloc(_size + ECS_SIZEOF(AllocationHeader));
+	if (!block)
+		return nullptr;
+	AllocationHeader* header = reinterpret_cast<AllocationHeader*>(block);
+	header->size = _size;
+	ecsHeap.fetch_add(_size, std::memory_order_relaxed);
+	return header + 1;
+}
+
+void* EcsCalloc(ecs_size_t _size)
+{
+	void* block = nextCalloc(_size + ECS_SIZEOF(AllocationHeader));
+	if (!block)
+		return nullptr;
+	AllocationHeader* header = reinterpret_cast<AllocationHeader*>(block);
+	header->size = _size;
+	ecsHeap.fetch_add(_size, std::memory_order_relaxed);
+	return header + 1;
+}
+
+void* EcsRealloc(void* _pointer, ecs_size_t _size)
+{
+	if (!_pointer)
+		return EcsMalloc(_size);
+	AllocationHeader* header = HeaderOf(_pointer);
+	int64_t previous = header->size;
+	void* block = nextRealloc(header, _size + ECS_SIZEOF(AllocationHeader));
+	if (!block)
+		return nullptr;
+	header = reinterpret_cast<AllocationHeader*>(block);
+	header->size = _size;
+	ecsHeap.fetch_add(_size - previous, std::memory_order_relaxed);
+	return header + 1;
+}
+
+void EcsFree(void* _pointer)
+{
+	if (!_pointer)
+		return;
+	AllocationHeader* header = HeaderOf(_pointer);
+	ecsHeap.fetch_sub(header->size, std::memory_order_relaxed);
+	nextFree(header);
+}
+
+/*---------------------------------------------------------------------------*/
+/* Vulkan host allocation callbacks, pUserData holds the tag                 */
+/*---------------------------------------------------------------------------*/
+void* AlignedAlloc(size_t _size, size_t _alignment)
+{
+#ifdef _WIN32
+	return _aligned_malloc(_size, _alignment);
+#else
+	void* block = nullptr;
+	return posix_memalign(&block, _alignment, _size) == 0 ? block : nullptr;
+#endif
+}
+
+void AlignedFree(void* _block)
+{
+#ifdef _WIN32
+	_aligned_free(_block);
+#else
+	free(_block);
+#endif
+}
+
+VKAPI_ATTR void* VKAPI_CALL VulkanAlloc(void* _userData, size_t _size, size_t _alignment, VkSystemAllocationScope)
+{
+	// the header sits right before the returned pointer, which keeps the alignment
+	size_t offset = _alignment > sizeof(AllocationHeader) ? _alignment : sizeof(AllocationHeader);
+	uint8_t* block = static_cast<uint8_t*>(AlignedAlloc(_size + offset, offset));
+	if (!block)
+		return nullptr;
+	MemoryTag tag = static_cast<MemoryTag>(reinterpret_cast<uintptr_t>(_userData));
+	AllocationHeader* header = HeaderOf(block + offset);
+	header->size = static_cast<int64_t>(_size);
+	header->tag = tag;
+	header->offset = static_cast<uint32_t>(offset);
+	MemoryTracker::Allocated(tag, header->size);
+	return block + offset;
+}
+
+VKAPI_ATTR void VKAPI_CALL VulkanFree(void*, void* _pointer)
+{
+	if (!_pointer)
+		return;
+	// objects may be destroyed with another tag's callbacks, the header decides
+	AllocationHeader* header = HeaderOf(_pointer);
+	MemoryTracker::Freed(static_cast<MemoryTag>(header->tag), header->size);
+	AlignedFree(static_cast<uint8_t*>(_pointer) - header->offset);
+}
+
+VKAPI_ATTR void* VKAPI_CALL VulkanRealloc(void* _userData, void* _pointer, size_t _size, size_t _alignment, VkSystemAllocationScope _scope)
+{
+	if (!_pointer)
+		return VulkanAlloc(_userData, _size, _alignment, _scope);
+	if (!_size) {
+		VulkanFree(_userData, _pointer);
+		return nullptr;
+	}
+	void* result = VulkanAlloc(_userData, _size, _alignment, _scope);
+	if (result) {
+		size_t previous = static_cast<size_t>(HeaderOf(_pointer)->size);
+		std::memcpy(result, _pointer, previous < _size ? previous : _size);
+		VulkanFree(_userData, _pointer);
+	}
+	return result;
+}
+}
+
+bool MemoryTracker::Init(std::weak_ptr<const GameConfig> _gameConfig)
+{
+	std::shared_ptr<const GameConfig> readCfg = _gameConfig.lock();
+	enabled = (*readCfg).at("Memory").at("track").as<bool>();
+	for (int i = 0; i < MEMORY_TAG_COUNT; ++i) {
+		budget[i] = static_cast<int64_t>((*readCfg).at("Memory").at(tagKeys[i]).as<unsigned>()) * 1024 * 1024;
+		vulkanCallbacks[i] = { reinterpret_cast<void*>(static_cast<uintptr_t>(i)),
+			VulkanAlloc, VulkanRealloc, VulkanFree, nullptr, nullptr };
+	}
+	return enabled;
+}
+
+bool MemoryTracker::IsEnabled()
+{
+	return enabled;
+}
+
+void MemoryTracker::HookEcs(ecs_os_api_t& _osApi)
+{
+	nextMalloc = _osApi.malloc_;
+	nextCalloc = _osApi.calloc_;
+	nextRealloc = _osApi.realloc_;
+	nextFree = _osApi.free_;
+	_osApi.malloc_ = EcsMalloc;
+	_osApi.calloc_ = EcsCalloc;
+	_osApi.realloc_ = EcsRealloc;
+	_osApi.free_ = EcsFree;
+}
+
+const VkAllocationCallbacks* MemoryTracker::Vulkan(MemoryTag _tag)
+{
+	return enabled ? &vulkanCallbacks[_tag] : nullptr;
+}
+
+void MemoryTracker::Allocated(MemoryTag _tag, int64_t _bytes, bool _device)
+{
+	if (_device)
+		device[_tag].fetch_add(_bytes, std::memory_order_relaxed);
+	UpdatePeak(_tag, live[_tag].fetch_add(_bytes, std::memory_order_relaxed) + _bytes);
+}
+
+void MemoryTracker::Freed(MemoryTag _tag, int64_t _bytes, bool _device)
+{
+	if (_device)
+		device[_tag].fetch_sub(_bytes, std::memory_order_relaxed);
+	live[_tag].fetch_sub(_bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::SampleEcs(const flecs::world& _world)
+{
+	int64_t tables = ecs_get_table_storage_bytes(_world);
+	// without the hooks only the table storage is known
+	int64_t indices = enabled ? ecsHeap.load(std::memory_order_relaxed) - tables : 0;
+	live[MEMORY_TAG_ECS_TABLES] = tables;
+	live[MEMORY_TAG_ECS_INDICES] = indices > 0 ? indices : 0;
+	UpdatePeak(MEMORY_TAG_ECS_TABLES, live[MEMORY_TAG_ECS_TABLES]);
+	UpdatePeak(MEMORY_TAG_ECS_INDICES, live[MEMORY_TAG_ECS_INDICES]);
+}
+
+void MemoryTracker::CheckBudgets()
+{
+	for (int i = 0; i < MEMORY_TAG_COUNT; ++i) {
+		if (!budget[i])
+			continue;
+		bool over = live[i] > budget[i];
+		if (over && !overBudget[i])
+			std::cout << "Memory budget exceeded: " << tagNames[i] << " uses " << (live[i] / 1024) << " KB of "
+				<< (budget[i] / 1024) << " KB" << std::endl;
+		overBudget[i] = over;
+	}
+}
+
+int64_t MemoryTracker::Live(MemoryTag _tag)
+{
+	return live[_tag];
+}
+
+int64_t MemoryTracker::Peak(MemoryTag _tag)
+{
+	return peak[_tag];
+}
+
+void MemoryTracker::PrintReport()
+{
+	std::cout << "Memory Usage (live / peak / budget, device part in brackets)\n";
+	for (int i = 0; i < MEMORY_TAG_COUNT; ++i) {
+		std::cout << "  " << tagNames[i] << ": " << (live[i] / 1024) << " KB / " << (peak[i] / 1024) << " KB / ";
+		if (budget[i])
+			std::cout << (budget[i] / 1024) << " KB";
+		else
+			std::cout << "none";
+		if (device[i])
+			std::cout << " (" << (device[i] / 1024) << " KB device)";
+		std::cout << (budget[i] && live[i] > budget[i] ? " OVER BUDGET\n" : "\n");
+	}
+	std::cout << std::flush;
+}
@@ -0,0 +1,77 @@
+// Live and peak bytes per subsystem across the flecs heap, Vulkan and game containers
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+
+#include "../GameConfig.h"
+#include <memory>
+
+namespace TeamYellow
+{
+enum MemoryTag
+{
+	MEMORY_TAG_ECS_TABLES,		// component columns of every table, sampled
+	MEMORY_TAG_ECS_INDICES,		// the rest of the flecs heap, sampled
+	MEMORY_TAG_GEOMETRY,
+	MEMORY_TAG_TEXTURES,
+	MEMORY_TAG_RENDER_TARGETS,
+	MEMORY_TAG_FRAME_DATA,
+	MEMORY_TAG_STAGING,
+	MEMORY_TAG_UI,
+	MEMORY_TAG_PIPELINES,		// shaders, pipelines, layouts and pools
+	MEMORY_TAG_COUNT
+};
+
+namespace MemoryTracker
+{
+// reads [Memory], returns true when the flecs heap should be hooked
+bool Init(std::weak_ptr<const GameConfig> _gameConfig);
+bool IsEnabled();
+// wraps the heap functions of the OS API, after any allocator is installed
+// and before the world is created
+void HookEcs(ecs_os_api_t& _osApi);
+// host allocations made by the Vulkan driver for objects of this tag,
+// NULL when tracking is off so the driver keeps its own allocator
+const VkAllocationCallbacks* Vulkan(MemoryTag _tag);
+// counts host bytes, or device bytes sub-allocated by the render system
+void Allocated(MemoryTag _tag, int64_t _bytes, bool _device = false);
+void Freed(MemoryTag _tag, int64_t _bytes, bool _device = false);
+// splits the flecs heap into table storage and everything else
+void SampleEcs(const flecs::world& _world);
+// logs each tag that went over its budget since the last check
+void CheckBudgets();
+int64_t Live(MemoryTag _tag);
+int64_t Peak(MemoryTag _tag);
+void PrintReport();
+};
+
+// counts a game side container into a tag
+template <typename T, MemoryTag Tag>
+struct TrackedAllocator
+{
+	using value_type = T;
+	template <typename U>
+	struct rebind { using other = TrackedAllocator<U, Tag>; };
+	TrackedAllocator() = default;
+	template <typename U>
+	TrackedAllocator(const TrackedAllocator<U, Tag>&) {}
+	T* allocate(size_t _count)
+	{
+		MemoryTracker::Allocated(Tag, static_cast<int64_t>(_count * sizeof(T)));
+		return std::allocator<T>().allocate(_count);
+	}
+	void deallocate(T* _pointer, size_t _count)
+	{
+		MemoryTracker::Freed(Tag, static_cast<int64_t>(_count * sizeof(T)));
+		std::allocator<T>().deallocate(_pointer, _count);
+	}
+	template <typename U>
+	bool operator==(const TrackedAllocator<U, Tag>&) const { return true; }
+	template <typename U>
+	bool operator!=(const TrackedAllocator<U, Tag>&) const { return false; }
+};
+
+template <typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+};
+
+#endif
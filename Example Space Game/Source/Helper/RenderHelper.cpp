@@ -0,0 +1,41 @@
+#include "RenderHelper.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace TeamYellow;
+
+bool RenderSystem::LoadBMFont(const char* _filePath, BMFont& _font)
+{
+    std::memset(&_font, 0, sizeof(BMFont));
+    for(unsigned i = 0; i < 255; ++i) _font.chars[i].page = ~(0u);
+    std::ifstream file(_filePath);
+    if(!file.is_open())
+        return false;
+    char linebuf[1024];
+    while(file.getline(linebuf, sizeof(linebuf)))
+    {
+        if(std::strncmp(linebuf, "common", 6) == 0)
+        {
+            _font.lineHeight = std::strtoul(&linebuf[18], nullptr, 10);
+        }
+        else if(std::strncmp(linebuf, "char ", 5) == 0)
+        {
+            uint32_t id = std::strtoul(&linebuf[8], nullptr, 10);
+            if(id >= 255) continue;
+
+            _font.chars[id].x = std::strtoul(&linebuf[18], nullptr, 10);
+            _font.chars[id].y = std::strtoul(&linebuf[25], nullptr, 10);
+
+            _font.chars[id].width  = std::strtoul(&linebuf[36], nullptr, 10);
+            _font.chars[id].height = std::strtoul(&linebuf[48], nullptr, 10);
+
+            _font.chars[id].xoffset = std::strtol(&linebuf[61], nullptr, 10);
+            _font.chars[id].yoffset = std::strtol(&linebuf[74], nullptr, 10);
+
+            _font.chars[id].xadvance = std::strtol(&linebuf[88], nullptr, 10);
+            _font.chars[id].page     = std::strtoul(&linebuf[98], nullptr, 10);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,184 @@
+// The CPU side of the renderer that doesn't need Vulkan: loading BMFont layouts,
+// laying out UIText glyphs and packing static mesh instances. RenderLogic uses it
+// to fill its staging memory and the benchmarks use it on plain buffers.
+#ifndef RENDERHELPER_H
+#define RENDERHELPER_H
+
+#include "../Components/Physics.h"
+#include "../Components/Visuals.h"
+
+namespace TeamYellow
+{
+namespace RenderSystem
+{
+/*---------------------------------------------------------------------------*/
+/* BMFont File Data                                                          */
+/*---------------------------------------------------------------------------*/
+struct BMFontChar
+{
+    uint32_t x, y;
+    uint32_t width, height;
+    int32_t xoffset, yoffset;
+    int32_t xadvance;
+    uint32_t page;
+};
+struct BMFont
+{
+    uint32_t lineHeight;
+    BMFontChar chars[255];
+};
+/*---------------------------------------------------------------------------*/
+/* Single Glyph or Sprite, read by the UI SDF and Blit Vertex Shaders from a */
+/* Storage Buffer shared by every Canvas                                     */
+/*---------------------------------------------------------------------------*/
+struct UIInstance
+{
+    GW::MATH::GVECTORF srcRect;     // Atlas UV (x, y, width, height)
+    GW::MATH::GVECTORF dstRect;     // NDC (x, y, width, height)
+    GW::MATH::GVECTORF clipRect;    // Framebuffer Pixels, stands in for the Scissor
+    GW::MATH::GVECTORF color;       // Font Color, Sprite Tint
+    GW::MATH::GVECTORF outline;     // Outline Color (rgb) and Width (a)
+};
+/*---------------------------------------------------------------------------*/
+/* Per-Instance Rate Vertex Buffer Information                               */
+/*---------------------------------------------------------------------------*/
+struct MeshInstanceData
+{
+    GW::MATH::GMATRIXF transform;
+    GW::MATH::GVECTORF bloomColor;
+    uint32_t isGameObject;
+    uint32_t textureIndex;
+};
+/*---------------------------------------------------------------------------*/
+/* Batch of Mesh Instances grouped by Mesh ID                                */
+/*---------------------------------------------------------------------------*/
+struct MeshBatch
+{
+    uint32_t meshID;
+    uint32_t instanceCount;
+    uint32_t instanceOffset;
+};
+/*===========================================================================*/
+/* Font Data                                                                 */
+/*===========================================================================*/
+/* Reads the Text Format of a BMFont Layout, false if the File can't be read */
+/*---------------------------------------------------------------------------*/
+bool LoadBMFont(const char* _filePath, BMFont& _font);
+/*===========================================================================*/
+/* UI Glyph Layout                                                           */
+/*===========================================================================*/
+/* Calls _emit with a UIInstance for every Glyph of the Text, laid out from  */
+/* the Top-Left of the Rect on a Framebuffer of _width by _height Pixels     */
+/*---------------------------------------------------------------------------*/
+template <typename Emit>
+void LayoutUIText(const BMFont& _font, const UIRect& _rect, const UIText& _text, float _width, float _height, Emit&& _emit)
+{
+    UIInstance instance;
+    instance.color = _text.fontColor;
+    instance.outline = _text.outlineColor;
+    instance.outline.w = _text.outlineWidth;
+    /*-----------------------------------------------------------------------*/
+    /* The Pixel Rect the Label used to be scissored to                      */
+    /*-----------------------------------------------------------------------*/
+    instance.clipRect.x = (float)(int32_t)((_rect.x + 1) * 0.5F * _width);
+    instance.clipRect.y = (float)(int32_t)(((1 - _rect.y) * 0.5F * _height) - _rect.height);
+    instance.clipRect.z = (float)(uint32_t)_rect.width;
+    instance.clipRect.w = (float)(uint32_t)_rect.height;
+    float posX = _rect.x;
+    float posY = _rect.y;
+    float scaleX = (36.F / _width) * _text.fontSize;
+    float scaleY = (36.F / _height) * _text.fontSize;
+    float lineDelta = (_font.lineHeight / 36.F) * scaleY;
+    for(auto it = &_text.text[0]; it != &_text.text[247] && *it != '\0'; ++it)
+    {
+        if(*it == '\n')
+        {
+            posX = _rect.x;
+            posY += lineDelta;
+            continue;
+        }
+        const BMFontChar* fontCharInfo = &_font.chars[(unsigned char)*it];
+        uint32_t glyphWidth = fontCharInfo->width ? fontCharInfo->width : 36;
+        /*===================================================================*/
+        /* Glyph Parameters                                                  */
+        /*===================================================================*/
+        /* Glyph Dimensions                                                  */
+        /*-------------------------------------------------------------------*/
+        float charw = (((float)glyphWidth) / 36.F) * scaleX;
+        float charh = (((float)fontCharInfo->height) / 36.F) * scaleY;
+        /*-------------------------------------------------------------------*/
+        /* Font UV                                                           */
+        /*-------------------------------------------------------------------*/
+        float us = ((float)fontCharInfo->x) / 512.F;
+        float ts = ((float)fontCharInfo->y) / 512.F;
+        float ue = ((float)(fontCharInfo->x + glyphWidth)) / 512.F;
+        float te = ((float)(fontCharInfo->y + fontCharInfo->height)) / 512.F;
+        /*-------------------------------------------------------------------*/
+        /* Offsets relative to Cursor Position                               */
+        /*-------------------------------------------------------------------*/
+        float xo = (((float)fontCharInfo->xoffset) / 36.F) * scaleX;
+        float yo = (((float)fontCharInfo->yoffset) / 36.F) * scaleY;
+        /*===================================================================*/
+        /* Glyph Quad from its Top-Left Corner                               */
+        /*===================================================================*/
+        instance.srcRect = GW::MATH::GVECTORF { us, ts, ue - us, te - ts };
+        instance.dstRect = GW::MATH::GVECTORF { posX + xo, posY + yo, charw, charh };
+        _emit(instance);
+        float advance = ((float)(fontCharInfo->xadvance) / 36.F) * scaleX;
+        posX += advance;
+    }
+}
+/*===========================================================================*/
+/* Static Mesh Instance Packing                                              */
+/*===========================================================================*/
+/* Writes an Instance for every Entity of a Layer Query sorted by Mesh ID,   */
+/* and appends a Batch for every Run of the same Mesh. _depth is the         */
+/* Distance of the Layer to the Gameplay Plane. _tint can change the Bloom   */
+/* Color of an Instance, it is called with the Entity and its Instance.      */
+/*---------------------------------------------------------------------------*/
+template <typename Layer, typename Batches, typename Tint>
+void PackMeshInstances(const flecs::query<Position, Orientation, Scale, StaticMeshComponent, Layer>& _query,
+    float _depth, uint32_t _isGameObject, MeshInstanceData*& _instanceData, uint32_t& _instanceCount,
+    Batches& _batches, Tint&& _tint)
+{
+    MeshBatch meshBatch;
+    meshBatch.meshID = ~(0u);
+    _query.each([&](flecs::entity e, Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm, Layer) {
+        if(meshBatch.meshID != sm.meshID)
+        {
+            if(meshBatch.meshID != ~(0u)) _batches.push_back(meshBatch);
+            meshBatch.meshID = sm.meshID;
+            meshBatch.instanceOffset = _instanceCount;
+            meshBatch.instanceCount = 0;
+        }
+        _instanceData->transform = GW::MATH::GIdentityMatrixF;
+        _instanceData->transform.row4.x = _depth;
+        _instanceData->transform.row4.y = p.value.x;
+        _instanceData->transform.row4.z = p.value.y;
+        _instanceData->transform.row1.x = -o.value.row1.x * s.value.x;
+        _instanceData->transform.row1.z =  o.value.row2.x * s.value.y;
+        _instanceData->transform.row3.x =  o.value.row1.y * s.value.x;
+        _instanceData->transform.row3.z = -o.value.row2.y * s.value.y;
+        _instanceData->transform.row2.y = s.value.z;
+        _instanceData->isGameObject = _isGameObject;
+        _instanceData->bloomColor = { 0, 0, 0, 1 };
+        _instanceData->textureIndex = sm.meshID;
+        _tint(e, *_instanceData);
+        ++meshBatch.instanceCount;
+        ++_instanceCount;
+        ++_instanceData;
+    });
+    if(meshBatch.meshID != ~(0u)) _batches.push_back(meshBatch);
+}
+template <typename Layer, typename Batches>
+void PackMeshInstances(const flecs::query<Position, Orientation, Scale, StaticMeshComponent, Layer>& _query,
+    float _depth, uint32_t _isGameObject, MeshInstanceData*& _instanceData, uint32_t& _instanceCount,
+    Batches& _batches)
+{
+    PackMeshInstances(_query, _depth, _isGameObject, _instanceData, _instanceCount, _batches,
+        [](flecs::entity, MeshInstanceData&) {});
+}
+};
+};
+
+#endif
@@ -14,31 +14,40 @@ bool BulletLogic::Init(	std::shared_ptr<flecs::world> _game,
 	game = _game;
 	gameConfig = _gameConfig;
 
+	// Both systems run on the flecs worker threads, so every entity only writes
+	// its own components. Damage is applied from the side of whatever got hit
+	// instead of the bullet writing into the Health of another entity.
+	game->system<Health, const AlliedWith>("Damage System")
+		.with<CollidedWith>(flecs::Wildcard)
+		.without<Bullet>()
+		.write<Health>() // forces a merge so the Bullet System sees the new Health
+		.multi_threaded()
+		.each([](flecs::entity e, Health& h, const AlliedWith& a) {
+		e.each<CollidedWith>([&](flecs::entity source) {
+			const Damage* d = source.get<Damage>();
+			if (d && source.has<Collidable>() && a.faction != source.get<AlliedWith>()->faction)
+				h.value -= d->value;
+		});
+	});
 	// destroy any bullets that have the CollidedWith relationship
-	game->system<Collidable, Damage>("Bullet System")
-		.each([](flecs::entity e, Collidable, Damage &d) {
+	game->system<Collidable, const Damage, const AlliedWith, ChargedShot*>("Bullet System")
+		.read<Health>()
+		.multi_threaded()
+		.each([](flecs::entity e, Collidable, const Damage&, const AlliedWith& a, ChargedShot* cs) {
 		bool collided = false;
-		// damage anything we come into contact with
 		e.each<CollidedWith>([&](flecs::entity hit) {
-			if (!hit.has<Bullet>() && e.get<AlliedWith>()->faction != hit.get<AlliedWith>()->faction) {
+			if (!hit.has<Bullet>() && a.faction != hit.get<AlliedWith>()->faction) {
 				collided = true;
-				if (hit.has<Health>()) {
-  					int current = hit.get<Health>()->value;
-					hit.set<Health>({ current - d.value });
-					// reduce the amount of hits but the charged shot
-					if (e.has<ChargedShot>() && hit.get<Health>()->value <= 0) 
-					{
-						int md_count = e.get<ChargedShot>()->max_destroy;
-						e.set<ChargedShot>({ md_count - 1 });
-					}
-				}
+				// reduce the amount of hits but the charged shot
+				const Health* h = hit.get<Health>();
+				if (cs && h && h->value <= 0)
+					--cs->max_destroy;
 			}
 		});
 		// if you have collidedWith realtionship then be destroyed
 		if (collided) {
-			if (e.has<ChargedShot>()) {
-			
-				if(e.get<ChargedShot>()->max_destroy <= 0)
+			if (cs) {
+				if (cs->max_destroy <= 0)
 					e.destruct();
 			}
 			else {
@@ -54,6 +63,7 @@ bool BulletLogic::Init(	std::shared_ptr<flecs::world> _game,
 // Free any resources used to run this system
 bool BulletLogic::Shutdown()
 {
+	game->entity("Damage System").destruct();
 	game->entity("Bullet System").destruct();
 	// invalidate the shared pointers
 	game.reset();
@@ -70,9 +80,11 @@ void BulletLogic::Clear()
 bool BulletLogic::Activate(bool runSystem)
 {
 	if (runSystem) {
+		game->entity("Damage System").enable();
 		game->entity("Bullet System").enable();
 	}
 	else {
+		game->entity("Damage System").disable();
 		game->entity("Bullet System").disable();
 	}
 	return false;
@@ -30,7 +30,7 @@ bool EnemyLogic::Init(std::shared_ptr<flecs::world> _game,
 				x.entity_id = e;
 				GW::GEvent explode;
 				explode.Write(PLAY_EVENT::ENEMY_DESTROYED, x);
-				PlaySound("Enemy Type1");
+				PlaySound(PREFAB_ENEMY_TYPE1);
  				eventPusher.Push(explode);
 				return;
 			}
@@ -80,7 +80,7 @@ void UpdateBullet(flecs::entity& b) {
 bool EnemyLogic::FireLasers(flecs::world& stage, Position origin, const Orientation* orient) {
 	// Grab the prefab for a laser round
 	flecs::entity bullet;
-	RetreivePrefab("Lazer Bullet", bullet);
+	RetreivePrefab(PREFAB_LAZER_BULLET, bullet);
 	Velocity v = *bullet.get<Velocity>();
 	v.value.y *= orient->target.data[0] * -1;
 
@@ -5,6 +5,7 @@
 #include "../Components/Physics.h"
 #include "../Components/Visuals.h"
 #include "../Entities/Prefabs.h"
+#include "../Entities/UIElements.h"
 #include "../Utils/Macros.h"
 #include "../Events/Playevents.h"
 #include "../Systems/RenderLogic.h"
@@ -40,35 +41,17 @@ bool LevelLogic::Init(	std::shared_ptr<flecs::world> _game,
 			skyBox->value = { skyBoxRotationAngleCos, skyBoxRotationAngleSin };
 	});
 	// spins up a job in a thread pool to invoke a function at a regular interval
-	timedEvents.Create(spawnDelay * 1000, [this]() {
-		// compute random spawn location
-		std::random_device rd;  // Will be used to obtain a seed for the random number engine
-		std::mt19937 gen(rd()); // Standard mersenne_twister_engine seeded with rd()
-        std::uniform_int_distribution<int> randomDir(0, 1);
-		int factor = randomDir(gen); // 0 or 1
-		int scalar = 1 - 2 * factor; // -1 or 1
-		// grab enemy type 1 prefab
-		flecs::entity et1; 
-		if (RetreivePrefab("Enemy Type1", et1)) {
-			const auto enemy1Stats = et1.get<EnemyStats>();
-			std::uniform_real_distribution<float> x_range(-gameplayAreaHalfHeight, gameplayAreaHalfHeight);
-			std::uniform_real_distribution<float> a_range(enemy1Stats->accMin, enemy1Stats->accMax);
-			float Xstart = x_range(gen); // normal rand() doesn't work great multi-threaded
-			float accel = a_range(gen);
+	if (!deterministic)
+		timedEvents.Create(spawnDelay * 1000, [this]() {
+			// compute random spawn location
+			std::random_device rd;  // Will be used to obtain a seed for the random number engine
+			std::mt19937 gen(rd()); // Standard mersenne_twister_engine seeded with rd()
 			// you must ensure the async_stage is thread safe as it has no built-in synchronization
 			gameLock.LockSyncWrite();
-			// this method of using prefabs is pretty conveinent
-			auto e = gameAsync.entity().is_a(et1)
-				.set<Velocity>({ 0,0 })
-				.set<Acceleration>({ 0, -scalar * accel })
-				.set<Position>({ Xstart, spawnOriginY + scalar * enemy1Stats->startY });
-			GW::MATH2D::GMATRIX2F world;
-			GW::MATH2D::GMatrix2D::Rotate2F(GW::MATH2D::GIdentityMatrix2F, G_PI_F * (1 - factor), world);
-			e.set<Orientation>({ world,world });
+			SpawnEnemy(gameAsync, gen);
 			// be sure to unlock when done so the main thread can safely merge the changes
 			gameLock.UnlockSyncWrite();
-		}
-	}, 5000); // wait 5 seconds to start enemy wave
+		}, 5000); // wait 5 seconds to start enemy wave
 
 	// create a system the runs at the end of the frame only once to merge async changes
 	struct LevelSystem {}; // local definition so we control iteration counts
@@ -76,22 +59,29 @@ bool LevelLogic::Init(	std::shared_ptr<flecs::world> _game,
 	// only happens once per frame at the very start of the frame
 	game->system<LevelSystem>().kind(flecs::OnLoad) // first defined phase
 		.each([this](flecs::entity e, LevelSystem& s) {
+		if (deterministic) {
+			// spawn on the game clock instead, so every replay gets the same waves
+			flecs::world stage = e.world();
+			for (spawnTimer += e.delta_time(); spawnTimer >= spawnDelay; spawnTimer -= spawnDelay)
+				SpawnEnemy(stage, random);
+			return;
+		}
 		// merge any waiting changes from the last frame that happened on other threads
 		gameLock.LockSyncWrite();
 		gameAsync.merge();
 		gameLock.UnlockSyncWrite();
 	});
 
-	snprintf(_game->lookup("HUDCanvas::EnemiesRemainingText").get_mut<UIText>()->text, 247, "%d", spawnCount);
+	snprintf(RetreiveUIElement(UI_HUD_ENEMIES_REMAINING_TEXT).get_mut<UIText>()->text, 247, "%d", spawnCount);
 	onKill.Create([this](const GW::GEvent& e) {
 		PLAY_EVENT event; PLAY_EVENT_DATA eventData;
 		if (+e.Read(event, eventData)) {
 			if (PLAY_EVENT::ENEMY_DESTROYED == event) {
 				spawnCount = spawnCount > 0 ? spawnCount - 1 : 0;
 				auto& world = eventData.entity_id.world();
-				snprintf(world.entity("HUDCanvas::EnemiesRemainingText").get_mut<UIText>()->text, 247, "%d", spawnCount);
+				snprintf(RetreiveUIElement(UI_HUD_ENEMIES_REMAINING_TEXT).mut(world).get_mut<UIText>()->text, 247, "%d", spawnCount);
 				if (spawnCount == 0) {
-					//PlaySound("Enemy Type1");		// TODO: Level Cleared sound.
+					//PlaySound(PREFAB_ENEMY_TYPE1);		// TODO: Level Cleared sound.
 					game->set<GameStateManager>({STATE_GAMEPLAY, STATE_LEVEL_COMPLETE});
 					std::cout << "Level Cleared!" << std::endl;
 					PLAY_EVENT_DATA x = { flecs::entity::null() };
@@ -124,39 +114,55 @@ void TeamYellow::LevelLogic::Reset()
 {
 	spawnDelay = game->get<LevelStats>()->spawnDelay;
 	spawnCount = game->get<LevelStats>()->startingSpawnCount;
-	snprintf(game->entity("HUDCanvas::EnemiesRemainingText").get_mut<UIText>()->text, 247, "%d", spawnCount);
+	snprintf(RetreiveUIElement(UI_HUD_ENEMIES_REMAINING_TEXT).get_mut<UIText>()->text, 247, "%d", spawnCount);
 	timedEvents = nullptr;
+	if (deterministic) {
+		spawnTimer = spawnDelay - 5.0f; // wait 5 seconds to start enemy wave
+		return;
+	}
 	timedEvents.Create(spawnDelay * 1000, [this]() {
 		// compute random spawn location
 		std::random_device rd;  // Will be used to obtain a seed for the random number engine
 		std::mt19937 gen(rd()); // Standard mersenne_twister_engine seeded with rd()
-		std::uniform_int_distribution<int> randomDir(0, 1);
-		int factor = randomDir(gen); // 0 or 1
-		int scalar = 1 - 2 * factor; // -1 or 1
-		// grab enemy type 1 prefab
-		flecs::entity et1; 
-		if (RetreivePrefab("Enemy Type1", et1)) {
-			const auto enemyStats = et1.get<EnemyStats>();
-			std::uniform_real_distribution<float> x_range(-gameplayAreaHalfHeight, gameplayAreaHalfHeight);
-			std::uniform_real_distribution<float> a_range(enemyStats->accMin, enemyStats->accMax);
-			float Xstart = x_range(gen); // normal rand() doesn't work great multi-threaded
-			float accel = a_range(gen);
-			// you must ensure the async_stage is thread safe as it has no built-in synchronization
-			gameLock.LockSyncWrite();
-			// this method of using prefabs is pretty conveinent
-			GW::MATH2D::GMATRIX2F world;
-			GW::MATH2D::GMatrix2D::Rotate2F(GW::MATH2D::GIdentityMatrix2F, G_PI_F * (1 - factor), world);
-			gameAsync.entity().is_a(et1)
-				.set<Velocity>({ 0,0 })
-				.set<Acceleration>({ 0, -scalar * accel })
-				.set<Position>({ Xstart, spawnOriginY + scalar * enemyStats->startY })
-				.set<Orientation>({ world,world });
-			// be sure to unlock when done so the main thread can safely merge the changes
-			gameLock.UnlockSyncWrite();
-		}
+		// you must ensure the async_stage is thread safe as it has no built-in synchronization
+		gameLock.LockSyncWrite();
+		SpawnEnemy(gameAsync, gen);
+		// be sure to unlock when done so the main thread can safely merge the changes
+		gameLock.UnlockSyncWrite();
 	}, 5000); // wait 5 seconds to start enemy wave
 }
 
+void LevelLogic::MakeDeterministic(unsigned seed)
+{
+	deterministic = true;
+	random.seed(seed);
+}
+
+// spawns one enemy ahead of or behind the player
+void LevelLogic::SpawnEnemy(flecs::world& stage, std::mt19937& gen)
+{
+	std::uniform_int_distribution<int> randomDir(0, 1);
+	int factor = randomDir(gen); // 0 or 1
+	int scalar = 1 - 2 * factor; // -1 or 1
+	// grab enemy type 1 prefab
+	flecs::entity et1; 
+	if (RetreivePrefab(PREFAB_ENEMY_TYPE1, et1)) {
+		const auto enemyStats = et1.get<EnemyStats>();
+		std::uniform_real_distribution<float> x_range(-gameplayAreaHalfHeight, gameplayAreaHalfHeight);
+		std::uniform_real_distribution<float> a_range(enemyStats->accMin, enemyStats->accMax);
+		float Xstart = x_range(gen); // normal rand() doesn't work great multi-threaded
+		float accel = a_range(gen);
+		// this method of using prefabs is pretty conveinent
+		GW::MATH2D::GMATRIX2F world;
+		GW::MATH2D::GMatrix2D::Rotate2F(GW::MATH2D::GIdentityMatrix2F, G_PI_F * (1 - factor), world);
+		stage.entity().is_a(et1)
+			.set<Velocity>({ 0,0 })
+			.set<Acceleration>({ 0, -scalar * accel })
+			.set<Position>({ Xstart, spawnOriginY + scalar * enemyStats->startY })
+			.set<Orientation>({ world,world });
+	}
+}
+
 // Toggle if a system's Logic is actively running
 bool LevelLogic::Activate(bool runSystem)
 {
@@ -7,6 +7,7 @@
 // Entities for players, enemies & bullets
 #include "../Entities/PlayerData.h"
 #include "../Entities/BulletData.h"
+#include <random>
 
 namespace TeamYellow
 {
@@ -32,6 +33,10 @@ namespace TeamYellow
 		unsigned spawnCount;
 		float spawnOriginY;
 		float gameplayAreaHalfHeight;
+		// recorded sessions spawn from a seeded generator on the game clock
+		bool deterministic = false;
+		std::mt19937 random;
+		float spawnTimer = 0;
 	public:
 		// attach the required logic to the ECS 
 		bool Init(	std::shared_ptr<flecs::world> _game,
@@ -43,6 +48,11 @@ namespace TeamYellow
 		// release any resources allocated by the system
 		bool Shutdown();
 		void Reset();
+		// fixes the order and timing of spawns, call before Init
+		void MakeDeterministic(unsigned seed);
+	private:
+		// helper routines
+		void SpawnEnemy(flecs::world& stage, std::mt19937& gen);
 	};
 
 };
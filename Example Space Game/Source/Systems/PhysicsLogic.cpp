@@ -3,6 +3,7 @@
 #include "../Components/Identification.h"
 #include "../Systems/RenderLogic.h"
 #include "../Events/Playevents.h"
+#include "../Utils/SimdKernels.h"
 
 
 using namespace TeamYellow;
@@ -14,33 +15,60 @@ bool PhysicsLogic::Init(	std::shared_ptr<flecs::world> _game,
 	game = _game;
 	gameConfig = _gameConfig;
 	// **** MOVEMENT ****
-	game->system<const Position, const Player>("UpdatePlayerPosition")
-		.each([this](flecs::entity e, const Position& p, const Player& _) {
-		playerPosition = p.value;
+	// Movement and cleanup run on the flecs worker threads, so anything they
+	// share lives in singletons and any structural change goes through the stage
+	game->set<PlayerPosition>({ 0, 0 });
+	game->system<const Position, const Player, PlayerPosition>("UpdatePlayerPosition")
+		.term_at(3).singleton()
+		.each([](const Position& p, const Player&, PlayerPosition& player) {
+		player.value = p.value;
 	});
+	// Both integration systems work on whole table columns. The components are
+	// tightly packed float pairs, so each column is one flat float array.
+	static_assert(sizeof(Velocity) == sizeof(float) * 2, "Velocity must be two packed floats");
+	static_assert(sizeof(Acceleration) == sizeof(float) * 2, "Acceleration must be two packed floats");
+	static_assert(sizeof(Position) == sizeof(float) * 2, "Position must be two packed floats");
 	// update velocity by acceleration
 	accSystem = game->system<Velocity, const Acceleration>("Acceleration System")
-		.each([](flecs::entity e, Velocity& v, const Acceleration &a) {
-		GW::MATH2D::GVECTOR2F accel;
-		GW::MATH2D::GVector2D::Scale2F(a.value, e.delta_time(), accel);
-		GW::MATH2D::GVector2D::Add2F(accel, v.value, v.value);
+		.multi_threaded()
+		.iter([](flecs::iter& it, Velocity* v, const Acceleration* a) {
+		if (it.is_self(2)) // each entity owns its acceleration
+			SimdKernels::ScaleAdd(v[0].value.data, a[0].value.data, it.delta_time(), it.count() * 2);
+		else // acceleration is shared through a prefab
+			SimdKernels::ScaleAddBroadcast2(v[0].value.data, a->value.data, it.delta_time(), it.count());
+	});
+	// enemies drift towards the player, the tags are matched per table so
+	// translation itself doesn't branch on them
+	homingSystem = game->system<Position, const PlayerPosition>("Homing System")
+		.term_at(2).singleton()
+		.with<Velocity>()
+		.with<Enemy>()
+		.without<Bullet>()
+		.multi_threaded()
+		.iter([](flecs::iter& it, Position* p, const PlayerPosition* player) {
+		const float pull = it.delta_time() * 0.25f;
+		for (auto i : it)
+			p[i].value.x += (player->value.x - p[i].value.x) * pull;
 	});
 	// update position by velocity
 	transSystem = game->system<Position, const Velocity>("Translation System")
-		.each([&](flecs::entity e, Position& p, const Velocity &v) {
-		GW::MATH2D::GVECTOR2F speed;
-		GW::MATH2D::GVector2D::Scale2F(v.value, e.delta_time(), speed);
-		if (e.has<Enemy>() && !e.has<Bullet>())
-			speed.x += (playerPosition.x - p.value.x) * e.delta_time() * 0.25;
+		.multi_threaded()
+		.iter([](flecs::iter& it, Position* p, const Velocity* v) {
 		// adding is simple but doesn't account for orientation
-		GW::MATH2D::GVector2D::Add2F(speed, p.value, p.value);
+		if (it.is_self(2))
+			SimdKernels::ScaleAdd(p[0].value.data, v[0].value.data, it.delta_time(), it.count() * 2);
+		else
+			SimdKernels::ScaleAddBroadcast2(p[0].value.data, v->value.data, it.delta_time(), it.count());
 	});
 	// **** CLEANUP ****
 	// clean up any objects that end up offscreen
-	cleanSystem = game->system<const Position, const Gameobject>("Cleanup System")
-		.each([this](flecs::entity e, const Position& p, const Gameobject& _) {
+	cleanSystem = game->system<const Position, const Gameobject, const PlayerPosition>("Cleanup System")
+		.term_at(3).singleton()
+		.multi_threaded()
+		.each([](flecs::entity e, const Position& p, const Gameobject&, const PlayerPosition& player) {
 		if (p.value.x > 45.f || p.value.x < -45.f ||
-			p.value.y > playerPosition.y + 80.f || p.value.y < playerPosition.y - 80.f) {
+			p.value.y > player.value.y + 80.f || p.value.y < player.value.y - 80.f) {
+				// e belongs to this worker's stage, so the delete is queued until the next merge
 				e.destruct();
 		}
 	});
@@ -53,10 +81,10 @@ bool PhysicsLogic::Init(	std::shared_ptr<flecs::world> _game,
 	struct CollisionSystem {}; // local definition so we control iteration count (singular)
 	game->entity("Detect-Collisions").add<CollisionSystem>();
 	game->system<CollisionSystem>()
-		.each([this](CollisionSystem& s) {
+		.each([this](CollisionSystem) {
 		const auto& meshBounds = RenderSystem::GetMeshBoundsVector();
 		// collect any and all collidable objects
-		queryCache.each([this, &meshBounds](flecs::entity e, Collidable& c, StaticMeshComponent& sm, Position& p, Orientation& o, Scale& s) {
+		queryCache.each([this, &meshBounds](flecs::entity e, Collidable, StaticMeshComponent& sm, Position& p, Orientation& o, Scale& s) {
 			// create a 3x3 matrix for transformation
 			GW::MATH2D::GMATRIX3F matrix = {
 				s.value.x * o.value.row1.x, o.value.row1.y, 0,
@@ -102,11 +130,13 @@ bool PhysicsLogic::Activate(bool runSystem)
 {
 	if (runSystem) {
 		accSystem.enable();
+		homingSystem.enable();
 		transSystem.enable();
 		cleanSystem.enable();
 	}
 	else {
 		accSystem.disable();
+		homingSystem.disable();
 		transSystem.disable();
 		cleanSystem.disable();
 	}
@@ -117,6 +147,7 @@ bool PhysicsLogic::Shutdown()
 {
 	queryCache.destruct(); // fixes crash on shutdown
 	game->entity("Acceleration System").destruct();
+	game->entity("Homing System").destruct();
 	game->entity("Translation System").destruct();
 	game->entity("Cleanup System").destruct();
 	return true;
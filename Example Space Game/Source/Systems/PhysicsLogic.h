@@ -12,6 +12,7 @@ namespace TeamYellow
 	class PhysicsLogic
 	{
 		flecs::system accSystem;
+		flecs::system homingSystem;
 		flecs::system transSystem;
 		flecs::system cleanSystem;
 		// shared connection to the main ECS engine
@@ -28,7 +29,6 @@ namespace TeamYellow
 		};
 		// vector used to save/cache all active collidables
 		std::vector<SHAPE> testCache;
-		GW::MATH2D::GVECTOR2F playerPosition;
 	public:
 		// attach the required logic to the ECS 
 		bool Init(	std::shared_ptr<flecs::world> _game,
@@ -4,6 +4,7 @@
 #include "../Components/Gameplay.h"
 #include "../Components/Visuals.h"
 #include "../Entities/Prefabs.h"
+#include "../Entities/UIElements.h"
 #include "../Events/Playevents.h"
 #include "../Systems/RenderLogic.h"
 
@@ -15,8 +16,7 @@ using namespace GW::AUDIO; // audio libs
 bool PlayerLogic::Init(
 							std::shared_ptr<flecs::world> _game, 
 							std::weak_ptr<GameConfig> _gameConfig, 
-							GW::INPUT::GInput _immediateInput, 
-							GW::INPUT::GBufferedInput _bufferedInput, 
+							std::shared_ptr<InputReplay> _inputReplay,
 							GW::INPUT::GController _controllerInput,
 							GW::AUDIO::GAudio _audioEngine,
 							GW::CORE::GEventGenerator _eventPusher)
@@ -24,8 +24,7 @@ bool PlayerLogic::Init(
 	// save a handle to the ECS & game settings
 	game = _game;
 	gameConfig = _gameConfig;
-	immediateInput = _immediateInput;
-	bufferedInput = _bufferedInput;
+	inputReplay = _inputReplay;
 	controllerInput =	_controllerInput;
 	audioEngine = _audioEngine;
 	eventPusher = _eventPusher;
@@ -49,6 +48,11 @@ bool PlayerLogic::Init(
 	keyLeft = (*readCfg).at("Keybinds").at("Left").as<int>();
 	keyRight = (*readCfg).at("Keybinds").at("Right").as<int>();
 	keyFire = (*readCfg).at("Keybinds").at("Fire").as<int>();
+	// held keys are sampled once per frame so they can be recorded
+	inputReplay->Track(keyLeft);
+	inputReplay->Track(keyRight);
+	inputReplay->Track(keyUp);
+	inputReplay->Track(keyDown);
 	// add logic for updating players
 	playerEntities[0] = _game->entity("Player One");
 	playerEntities[0].set<PlayerStats>({
@@ -72,7 +76,7 @@ bool PlayerLogic::Init(
 				p[i].value.y = ystart;
 				// Fire Player Destroyed Event
 				std::cout << "Player Was Destroyed!\n";
-				snprintf(it.world().entity("HUDCanvas::LivesText").get_mut<UIText>()->text,
+				snprintf(RetreiveUIElement(UI_HUD_LIVES_TEXT).mut(it.world()).get_mut<UIText>()->text,
 					247, "x%d", playerStats->lives);
 				PLAY_EVENT_DATA x;
 				x.entity_id = it.entity(i);
@@ -103,12 +107,16 @@ bool PlayerLogic::Init(
 			}
 			// left-right movement
 			float xaxis = 0, yaxis = 0, input = 0;
-			// Use the controller/keyboard to move the player around the screen			
-			if (c[i].index == 0) { // enable keyboard controls for player 1
-				immediateInput.GetState(keyLeft, input); yaxis += input;
-				immediateInput.GetState(keyRight, input); yaxis -= input;
-				immediateInput.GetState(keyUp, input); xaxis += input;
-				immediateInput.GetState(keyDown, input); xaxis -= input;
+			// Use the controller/keyboard to move the player around the screen
+			if (const AutoPilot* pilot = it.entity(i).get<AutoPilot>()) { // stress runs fly the ship
+				xaxis = pilot->xaxis;
+				yaxis = pilot->yaxis;
+			}
+			else if (c[i].index == 0) { // enable keyboard controls for player 1
+				inputReplay->GetState(keyLeft, input); yaxis += input;
+				inputReplay->GetState(keyRight, input); yaxis -= input;
+				inputReplay->GetState(keyUp, input); xaxis += input;
+				inputReplay->GetState(keyDown, input); xaxis -= input;
 			}
 			// grab left-thumb stick
 			/*controllerInput.GetState(c[i].index, G_LX_AXIS, input); xaxis += input;
@@ -185,8 +193,10 @@ bool PlayerLogic::Init(
 	pressEvents.Create(Max_Frame_Events); // even 32 is probably overkill for one frame
 		
 	// register for keyboard and controller events
-	bufferedInput.Register(pressEvents);
-	controllerInput.Register(pressEvents);
+	inputReplay->Register(pressEvents);
+	// controllers aren't recorded, so they would make a run impossible to replay
+	if (!inputReplay->IsDeterministic())
+		controllerInput.Register(pressEvents);
 
     // Setup HUD UI
     auto hudCanvas = _game->entity("HUDCanvas").set<UICanvas>({
@@ -244,7 +254,7 @@ bool PlayerLogic::Init(
         1.5F,                       // Font Scale
         "Score: "                   // Text Buffer
     });
-    _game->entity("ScoreText")
+    auto scoreText = _game->entity("ScoreText")
     .set<UIRect>({ -0.6F, 0.8F, 200.F, 80.F })
     .set<UIText>({
         { 0.5F, 0.5F, 0.F, 1.F },   // Font Color
@@ -291,6 +301,14 @@ bool PlayerLogic::Init(
     snprintf(specialsText.get_mut<UIText>()->text, 247, "x%d", startSpecials);
     _game->set_scope(prevScope);
 
+	// resolve the HUD once so score and life updates don't search by path
+	RegisterUIElement(UI_HUD_CANVAS, hudCanvas);
+	RegisterUIElement(UI_HUD_ENEMIES_REMAINING_TEXT, enemiesRemainingText);
+	RegisterUIElement(UI_HUD_HISCORE_TEXT, hScore);
+	RegisterUIElement(UI_HUD_SCORE_TEXT, scoreText);
+	RegisterUIElement(UI_HUD_LIVES_TEXT, livesText);
+	RegisterUIElement(UI_HUD_SPECIALS_TEXT, specialsText);
+
 	// create the on explode handler
 	onExplode.Create([this, scoreToLifeReward, scoreToSpecialReward, readCfg](const GW::GEvent& e) {
 		PLAY_EVENT event; PLAY_EVENT_DATA eventData;
@@ -302,12 +320,12 @@ bool PlayerLogic::Init(
 				auto gameplayStats = world.get_mut<GameplayStats>();
 				auto playerStats = playerEntities[0].get_mut<PlayerStats>();
 				gameplayStats->score += point->value;
-				snprintf(world.entity("HUDCanvas::ScoreText").get_mut<UIText>()->text, 247, "%d", gameplayStats->score);
+				snprintf(RetreiveUIElement(UI_HUD_SCORE_TEXT).mut(world).get_mut<UIText>()->text, 247, "%d", gameplayStats->score);
 
 				// Updating Hi Score based on if its equal to or greater than score.
 				if (highScore < gameplayStats->score)
 				{
-					snprintf(world.entity("HUDCanvas::HiScoreText").get_mut<UIText>()->text, 247, "%d", gameplayStats->score);
+					snprintf(RetreiveUIElement(UI_HUD_HISCORE_TEXT).mut(world).get_mut<UIText>()->text, 247, "%d", gameplayStats->score);
 					(*readCfg)["Player"]["savedScore"] = gameplayStats->score;
 				}
 
@@ -316,14 +334,14 @@ bool PlayerLogic::Init(
 				{
 					playerStats->scoreToNextLifeReward = scoreToLifeReward;
 					++playerStats->lives;
-					snprintf(world.entity("HUDCanvas::LivesText").get_mut<UIText>()->text, 247, "x%d", playerStats->lives);
+					snprintf(RetreiveUIElement(UI_HUD_LIVES_TEXT).mut(world).get_mut<UIText>()->text, 247, "x%d", playerStats->lives);
 				}
 				playerStats->scoreToNextSpecialReward -= point->value;
 				if(playerStats->scoreToNextSpecialReward < 1)
 				{
 					playerStats->scoreToNextSpecialReward = scoreToSpecialReward;
 					++playerStats->specials;
-					snprintf(world.entity("HUDCanvas::SpecialsText").get_mut<UIText>()->text, 247, "x%d", playerStats->specials);
+					snprintf(RetreiveUIElement(UI_HUD_SPECIALS_TEXT).mut(world).get_mut<UIText>()->text, 247, "x%d", playerStats->specials);
 				}
 				std::cout << "Enemy Was Destroyed!\n";
 				std::cout << "Score: "  << gameplayStats->score;
@@ -343,6 +361,7 @@ bool PlayerLogic::Shutdown()
 	playerSystem.destruct();
 	game.reset();
 	gameConfig.reset();
+	inputReplay.reset();
 
 	return true;
 }
@@ -355,10 +374,10 @@ bool PlayerLogic::Activate(bool runSystem)
 	else  playerEntities[0].add<Collidable>();
 	auto gameplayStats = game->get_mut<GameplayStats>();
 	auto playerStats = playerEntities[0].get_mut<PlayerStats>();
-	game->entity("HUDCanvas").get_mut<UICanvas>()->isVisible = runSystem;
-	snprintf(game->entity("HUDCanvas::ScoreText").get_mut<UIText>()->text, 247, "%d", gameplayStats->score);
-	snprintf(game->entity("HUDCanvas::LivesText").get_mut<UIText>()->text, 247, "x%d", playerStats->lives);
-	snprintf(game->entity("HUDCanvas::SpecialsText").get_mut<UIText>()->text, 247, "x%d", playerStats->specials);
+	RetreiveUIElement(UI_HUD_CANVAS).get_mut<UICanvas>()->isVisible = runSystem;
+	snprintf(RetreiveUIElement(UI_HUD_SCORE_TEXT).get_mut<UIText>()->text, 247, "%d", gameplayStats->score);
+	snprintf(RetreiveUIElement(UI_HUD_LIVES_TEXT).get_mut<UIText>()->text, 247, "x%d", playerStats->lives);
+	snprintf(RetreiveUIElement(UI_HUD_SPECIALS_TEXT).get_mut<UIText>()->text, 247, "x%d", playerStats->specials);
 	if (playerSystem.is_alive()) {
 		(runSystem) ? 
 			playerSystem.enable() 
@@ -392,6 +411,8 @@ bool PlayerLogic::ProcessInputEvents(flecs::world& stage)
 					RenderSystem::DebugToggleMeshBoundsDraw();
 				} else if(k_data.data == G_KEY_EQUALS) {
 					RenderSystem::DebugToggleOrthographicProjection();
+				} else if(k_data.data == G_KEY_9) {
+					RenderSystem::PrintMemoryUsageReport();
 #endif
 				}
 			}
@@ -408,7 +429,7 @@ bool PlayerLogic::ProcessInputEvents(flecs::world& stage)
 					PlayerStats* stats = stage.lookup("Player One").get_mut<PlayerStats>();
 					if (0 < stats->specials) {
 						--stats->specials;
-						snprintf(game->entity("HUDCanvas::SpecialsText").get_mut<UIText>()->text,
+						snprintf(RetreiveUIElement(UI_HUD_SPECIALS_TEXT).mut(stage).get_mut<UIText>()->text,
 							247, "x%d", stats->specials);
 						bomb = true;
 					}
@@ -434,7 +455,7 @@ bool PlayerLogic::FireLasers(flecs::world& stage, Position origin, const Orienta
 {
 	// Grab the prefab for a laser round
 	flecs::entity bullet;
-	RetreivePrefab("Lazer Bullet", bullet);
+	RetreivePrefab(PREFAB_LAZER_BULLET, bullet);
 	Velocity v = *bullet.get<Velocity>();
 	v.value.y *= orient->target.data[0];
 
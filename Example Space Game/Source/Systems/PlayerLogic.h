@@ -5,6 +5,7 @@
 // Contains our global game settings
 #include "../GameConfig.h"
 #include "../Components/Physics.h"
+#include "../Helper/InputReplay.h"
 
 namespace TeamYellow 
 {
@@ -19,9 +20,8 @@ namespace TeamYellow
 		// handle to our running ECS system
 		flecs::system playerSystem;
 		flecs::entity playerEntities[1];
-		// permananent handles input systems
-		GW::INPUT::GInput immediateInput;
-		GW::INPUT::GBufferedInput bufferedInput;
+		// permananent handles input systems, the keyboard may be a recording
+		std::shared_ptr<InputReplay> inputReplay;
 		GW::INPUT::GController controllerInput;
 		// permananent handle to audio system
 		GW::AUDIO::GAudio audioEngine;
@@ -40,8 +40,7 @@ namespace TeamYellow
 		// attach the required logic to the ECS 
 		bool Init(	std::shared_ptr<flecs::world> _game,
 					std::weak_ptr<GameConfig> _gameConfig,
-					GW::INPUT::GInput _immediateInput,
-					GW::INPUT::GBufferedInput _bufferedInput,
+					std::shared_ptr<InputReplay> _inputReplay,
 					GW::INPUT::GController _controllerInput,
 					GW::AUDIO::GAudio _audioEngine,
 					GW::CORE::GEventGenerator _eventPusher);
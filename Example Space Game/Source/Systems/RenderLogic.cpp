@@ -5,6 +5,10 @@
 #include "../Components/Identification.h"
 
 #include "../Utils/h2bParser.h"
+#include "../Helper/MemoryTracker.h"
+#include "../Helper/RenderHelper.h"
+#include <algorithm>
+#include <cassert>
 
 using namespace GW::MATH;
 using GVulkanSurface = GW::GRAPHICS::GVulkanSurface;
@@ -30,22 +34,6 @@ struct ShaderFileData
     uint32_t *pixelShaderFileData;
 };
 /*---------------------------------------------------------------------------*/
-/* BMFont File Data                                                          */
-/*---------------------------------------------------------------------------*/
-struct BMFontChar
-{
-    uint32_t x, y;
-    uint32_t width, height;
-    int32_t xoffset, yoffset;
-    int32_t xadvance;
-    uint32_t page;
-};
-struct BMFont
-{
-    uint32_t lineHeight;
-    BMFontChar chars[255];
-};
-/*---------------------------------------------------------------------------*/
 /* TARGA Image Header                                                        */
 /*---------------------------------------------------------------------------*/
 struct TGAHeader
@@ -107,39 +95,34 @@ struct DDSHeader
 /*===========================================================================*/
 /* In-Memory Draw Resource Representations                                   */
 /*===========================================================================*/
-/* Per-Vertex Data for UI SDF Pipeline                                       */
-/*---------------------------------------------------------------------------*/
-struct FontVertex
-{
-    GW::MATH2D::GVECTOR2F pos;
-    GW::MATH2D::GVECTOR2F uv;
-};
+/* UIInstance, MeshInstanceData and MeshBatch are in Helper/RenderHelper.h   */
 /*---------------------------------------------------------------------------*/
-/* Batch of Font Vertices to draw together, grouped by Font ID and Canvas    */
+/* UI Pipelines, Sprites draw under the Text of the same Canvas Depth        */
 /*---------------------------------------------------------------------------*/
-struct FontBatch
+enum UIPipeline
 {
-    uint32_t fontID;
-    uint32_t indexCount;
-    uint32_t indexOffset;
-    float outlineWidth;
-    UIRect rect;
-    GVECTORF fontColor, outlineColor;
+    UI_PIPELINE_BLIT,
+    UI_PIPELINE_SDF
 };
 /*---------------------------------------------------------------------------*/
-/* Single Sprite Instance within a Canvas                                    */
+/* Instance Sort Key (Depth, Pipeline, Atlas), ties keep the Gather Order    */
 /*---------------------------------------------------------------------------*/
-struct SpriteInstance
+struct UIInstanceKey
 {
-    GW::MATH::GVECTORF srcRect;
-    GW::MATH::GVECTORF dstRect;
+    uint64_t key;
+    uint32_t index;
+    bool operator<(const UIInstanceKey& other) const
+    {
+        return key < other.key || (key == other.key && index < other.index);
+    }
 };
 /*---------------------------------------------------------------------------*/
-/* Sprite Batch (Not grouped by specific Sprite, just by Canvas currently)   */
+/* Run of Instances drawn with a single instanced Draw                       */
 /*---------------------------------------------------------------------------*/
-struct SpriteBatch
+struct UIDrawBatch
 {
-    uint32_t spriteAtlasID;
+    UIPipeline pipeline;
+    uint32_t atlasID;           // Font ID or Sprite Atlas ID
     uint32_t instanceOffset;
     uint32_t instanceCount;
 };
@@ -155,23 +138,88 @@ struct Mesh
     uint32_t indexOffset;
 };
 /*---------------------------------------------------------------------------*/
-/* Per-Instance Rate Vertex Buffer Information                               */
+/* Push Constants for the Blur and Present Pipelines. The scene is drawn     */
+/* into the top-left of its Render Targets when Dynamic Resolution lowers    */
+/* the Render Scale, so both passes need the used portion in UV space.       */
 /*---------------------------------------------------------------------------*/
-struct MeshInstanceData
+struct BlurPushConstants
 {
-    GMATRIXF transform;
-    GVECTORF bloomColor;
-    uint32_t isGameObject;
+    GW::MATH2D::GVECTOR2F uvScale;
+    uint32_t blurDirection;
+};
+struct PresentPushConstants
+{
+    GW::MATH2D::GVECTOR2F sceneUVScale;
+    GW::MATH2D::GVECTOR2F sceneTexelSize;
+    float sharpenStrength;
 };
 /*---------------------------------------------------------------------------*/
-/* Batch of Mesh Instances grouped by Mesh ID                                */
+/* Push Constants for the UI Pipelines, the first Instance of the Draw       */
 /*---------------------------------------------------------------------------*/
-struct MeshBatch
+struct UIPushConstants
 {
-    uint32_t meshID;
-    uint32_t instanceCount;
     uint32_t instanceOffset;
 };
+/*===========================================================================*/
+/* Device Memory Sub-Allocation                                              */
+/*===========================================================================*/
+/* Usage Categories tracked for the Memory Usage Report                      */
+/*---------------------------------------------------------------------------*/
+enum MemoryCategory
+{
+    MEMORY_CATEGORY_RENDER_TARGETS,
+    MEMORY_CATEGORY_PER_FRAME_BUFFERS,
+    MEMORY_CATEGORY_TEXTURES,
+    MEMORY_CATEGORY_MESH_BUFFERS,
+    MEMORY_CATEGORY_STAGING,
+    MEMORY_CATEGORY_COUNT
+};
+/*---------------------------------------------------------------------------*/
+/* Free Range inside a General Purpose Heap                                  */
+/*---------------------------------------------------------------------------*/
+struct MemoryRange
+{
+    VkDeviceSize offset;
+    VkDeviceSize size;
+};
+/*---------------------------------------------------------------------------*/
+/* Single vkAllocateMemory Block that Resources are sub-allocated from.      */
+/* Transient Heaps are bump allocated and reset all at once when Per-Frame   */
+/* Resources are destroyed, General Heaps keep a sorted free list.           */
+/*---------------------------------------------------------------------------*/
+struct MemoryHeap
+{
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    VkDeviceSize linearOffset;
+    uint32_t memoryTypeIndex;
+    std::vector<MemoryRange> freeRanges;
+    void* mappedMemory;
+    MemoryTag tag;          // the driver's host memory for the block is counted here
+};
+/*---------------------------------------------------------------------------*/
+/* Handle to a sub-allocated range, owned by the Resource bound to it        */
+/*---------------------------------------------------------------------------*/
+struct MemoryAllocation
+{
+    VkDeviceMemory memory;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    uint32_t heapIndex;
+    MemoryCategory category;
+    bool transient;
+    bool aliased;
+};
+/*---------------------------------------------------------------------------*/
+/* Running Totals for one Usage Category                                     */
+/*---------------------------------------------------------------------------*/
+struct MemoryCategoryStats
+{
+    uint32_t allocationCount;
+    uint32_t aliasCount;
+    VkDeviceSize bytesUsed;
+    VkDeviceSize bytesAliased;
+};
 }
 /*===========================================================================*/
 /* PRIVATE FUNCTION DECLARATIONS                                             */
@@ -187,6 +235,18 @@ void SubmitBloomBlurDrawCommands    (uint32_t bufferIndex);
 void SubmitUIDrawCommands           (uint32_t bufferIndex);
 void SubmitPresentCommandsAndWait   (uint32_t bufferIndex);
 /*===========================================================================*/
+/* UI Render List                                                            */
+/*===========================================================================*/
+void GatherUIInstances              (flecs::entity _parent, const UICanvas& _canvas);
+void AppendUIText                   (const UIRect& _rect, const UIText& _text, const UICanvas& _canvas);
+void AppendUISprite                 (const UIRect& _rect, const UISprite& _sprite, const UICanvas& _canvas);
+void PushUIInstance                 (const UIInstance& _instance, uint32_t _depth, UIPipeline _pipeline, uint32_t _atlasID);
+void BuildUIDrawBatches             (uint32_t bufferIndex);
+/*===========================================================================*/
+/* Dynamic Resolution                                                        */
+/*===========================================================================*/
+void UpdateRenderScale              (uint32_t bufferIndex);
+/*===========================================================================*/
 /* Render Pipeline Objects                                                   */
 /*===========================================================================*/
 void CreateShaderModules            (VkDevice _device, std::shared_ptr<const GameConfig> _readCfg);
@@ -222,25 +282,39 @@ void DestroyPipelines               (VkDevice _device);
 /*===========================================================================*/
 /* Render Resource Objects                                                   */
 /*===========================================================================*/
-void CreatePersistentResources      (VkPhysicalDevice _physicalDevice, VkDevice _device);
-void CreatePerFrameResources        (VkPhysicalDevice _physicalDevice, VkDevice _device, uint32_t bufferCount);
+bool CreatePersistentResources      (VkPhysicalDevice _physicalDevice, VkDevice _device);
+bool CreatePerFrameResources        (VkPhysicalDevice _physicalDevice, VkDevice _device, uint32_t bufferCount);
 void DestroyPersistentResources     (VkDevice _device);
 void DestroyPerFrameResources       (VkDevice _device, uint32_t bufferCount);
+void WriteBindlessTextureDescriptors(uint32_t _binding, uint32_t _firstElement, uint32_t _arraySize, VkImageView _textureSRV);
+/*===========================================================================*/
+/* Device Memory Sub-Allocation                                              */
+/*===========================================================================*/
+void InitMemoryAllocator            (VkPhysicalDevice _physicalDevice);
+void DestroyMemoryAllocator         (VkDevice _device);
+bool AllocateMemory                 (VkDevice _device, const VkMemoryRequirements& _requirements, VkMemoryPropertyFlags _properties, MemoryCategory _category, bool _transient, MemoryAllocation& _allocation);
+void FreeMemory                     (VkDevice _device, MemoryAllocation& _allocation);
+void ResetTransientMemory           (VkDevice _device);
+void* MapMemoryAllocation           (VkDevice _device, const MemoryAllocation& _allocation);
+/*---------------------------------------------------------------------------*/
+/* Resource Creation through the Sub-Allocator                               */
+/*---------------------------------------------------------------------------*/
+bool CreateBuffer   (VkDevice _device, VkDeviceSize _size, VkBufferUsageFlags _usage, VkMemoryPropertyFlags _properties,
+                     MemoryCategory _category, bool _transient, VkBuffer* _buffer, MemoryAllocation* _allocation);
+bool CreateImageSet (VkDevice _device, VkExtent3D _extent, uint32_t _mipLevels, VkFormat _format, VkImageUsageFlags _usage,
+                     VkImageAspectFlags _aspect, VkImageLayout _layout, MemoryCategory _category, bool _transient,
+                     const MemoryAllocation* _aliasOf, VkImage* _image, VkImageView* _imageView, MemoryAllocation* _allocation);
 /*===========================================================================*/
 /* Resource Loading                                                          */
 /*===========================================================================*/
 void LoadShaderFileData (const char *vertexShaderPath, const char *pixelShaderPath, GW::SYSTEM::GFile& _fileInterface, ShaderFileData &data);
 void FreeShaderFileData (ShaderFileData &data);
 /*---------------------------------------------------------------------------*/
-/* Font Data                                                                 */
-/*---------------------------------------------------------------------------*/
-void LoadBMFont         (const char* _filePath, BMFont& _font);
-/*---------------------------------------------------------------------------*/
 /* Texture Data                                                              */
 /*---------------------------------------------------------------------------*/
-void LoadTGATexture     (const char* _filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, VkDeviceMemory* textureMemory, VkImageView* textureSRV);
-void LoadDDSTexture     (const char* _filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, VkDeviceMemory* textureMemory, VkImageView* textureSRV);
-void LoadDDSCubemap     (const char* _filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, VkDeviceMemory* textureMemory, VkImageView* textureSRV);
+bool LoadTGATexture     (const char* _filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, MemoryAllocation* textureMemory, VkImageView* textureSRV);
+bool LoadDDSTexture     (const char* _filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, MemoryAllocation* textureMemory, VkImageView* textureSRV);
+bool LoadDDSCubemap     (const char* _filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, MemoryAllocation* textureMemory, VkImageView* textureSRV);
 /*---------------------------------------------------------------------------*/
 /* Mesh Data                                                                 */
 /*---------------------------------------------------------------------------*/
@@ -259,7 +333,8 @@ void GetSurfaceExtent(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VkE
 /*===========================================================================*/
 namespace RenderSystem
 {
-#define MAX_MESH_COUNT 128 // Note: Currently only used for Descriptor Set Counts
+#define MAX_MESH_COUNT 128 // Note: Currently only used for Descriptor Set and Bindless Array Counts
+#define MAX_SKYBOX_COUNT 4 // Size of the Bindless Cubemap Array
 /*===========================================================================*/
 /* Gateware Objects                                                          */
 /*===========================================================================*/
@@ -278,10 +353,7 @@ flecs::system                   present;
 /*---------------------------------------------------------------------------*/
 /* Queries                                                                   */
 /*---------------------------------------------------------------------------*/
-flecs::query<UIRect, UIText>    uiTextQuery;
-flecs::query<UIRect, UISprite>  uiSpriteQuery;
-flecs::query<UICanvas>          uiCanvasTextQuery;
-flecs::query<UICanvas>          uiCanvasSpriteQuery;
+flecs::query<UICanvas>          uiCanvasQuery;
 flecs::query<Position, Orientation, Scale, StaticMeshComponent, Foreground>
                                 foregroundSortedQuery;
 flecs::query<Position, Orientation, Scale, StaticMeshComponent, Gameobject>
@@ -305,6 +377,27 @@ uint32_t                        swapchainBufferCount;
 VkSurfaceFormatKHR              swapchainFormat;
 VkExtent2D                      swapchainExtent;
 /*===========================================================================*/
+/* Dynamic Resolution                                                        */
+/*===========================================================================*/
+/* Scene Render Targets are allocated once at the Max Render Scale, each     */
+/* frame only the top-left Scene Viewport of them is rendered and sampled,   */
+/* so changing the scale never recreates resources.                          */
+/*---------------------------------------------------------------------------*/
+VkExtent2D                      sceneTargetExtent;
+VkExtent2D                      sceneViewportExtent;
+uint32_t                        shadowMapViewportSize;
+float                           renderScale;
+float                           minRenderScale;
+float                           maxRenderScale;
+float                           targetGPUFrameTime;
+float                           smoothedGPUFrameTime;
+float                           sharpenStrength;
+bool                            timestampsSupported;
+float                           timestampPeriod;
+#define FRAME_TIMESTAMP_COUNT 6 // Begin/End pair for the Shadow, Static Mesh and Blur passes
+VkQueryPool                     frameTimestampQueryPool;
+std::vector<bool>               frameTimestampsWritten;
+/*===========================================================================*/
 /* Shadow Map Render Pass                                                    */
 /*===========================================================================*/
 VkRenderPass                    shadowMapRenderPass;
@@ -349,6 +442,7 @@ VkPipeline                      debugColliderPipeline;
 /* UI Render Pass                                                            */
 /*===========================================================================*/
 VkRenderPass                    uiRenderPass;
+VkDescriptorSetLayout           uiInstanceDescriptorSetLayout;
 VkDescriptorSetLayout           uiSDFDescriptorSetLayout;
 VkPipelineLayout                uiSDFPipelineLayout;
 VkShaderModule                  uiSDFVertexShader;
@@ -371,10 +465,32 @@ VkShaderModule                  presentVertexShader;
 VkShaderModule                  presentPixelShader;
 VkPipeline                      presentPipeline;
 /*===========================================================================*/
+/* Device Memory Sub-Allocator                                               */
+/*===========================================================================*/
+/* General Heaps hold long-lived Textures and Buffers, Transient Heaps hold  */
+/* everything rebuilt in CreatePerFrameResources. Transient Heaps are kept   */
+/* across a resize and only grow, so a resize normally allocates nothing.    */
+/*---------------------------------------------------------------------------*/
+#define GENERAL_HEAP_BLOCK_SIZE     (64 * 1024 * 1024)
+#define TRANSIENT_HEAP_BLOCK_SIZE   (32 * 1024 * 1024)
+VkPhysicalDeviceMemoryProperties memoryProperties;
+VkDeviceSize                    bufferImageGranularity;
+uint32_t                        maxMemoryAllocationCount;
+uint32_t                        deviceMemoryAllocationCount;
+std::vector<MemoryHeap>         generalHeaps;
+std::vector<MemoryHeap>         transientHeaps;
+VkDeviceSize                    transientHeapSizeHints[VK_MAX_MEMORY_TYPES];
+MemoryCategoryStats             memoryCategoryStats[MEMORY_CATEGORY_COUNT];
+const char*                     memoryCategoryNames[MEMORY_CATEGORY_COUNT] = {
+                                    "Render Targets", "Per-Frame Buffers", "Textures", "Mesh Buffers", "Staging" };
+const MemoryTag                 memoryCategoryTags[MEMORY_CATEGORY_COUNT] = {
+                                    MEMORY_TAG_RENDER_TARGETS, MEMORY_TAG_FRAME_DATA, MEMORY_TAG_TEXTURES,
+                                    MEMORY_TAG_GEOMETRY, MEMORY_TAG_STAGING };
+/*===========================================================================*/
 /* Staging Buffer                                                            */
 /*===========================================================================*/
 VkBuffer                        stagingBuffer;
-VkDeviceMemory                  stagingMemory;
+MemoryAllocation                stagingMemory;
 void*                           stagingMappedMemory;
 /*===========================================================================*/
 /* Static Mesh Render Resources                                              */
@@ -384,14 +500,14 @@ void*                           stagingMappedMemory;
 /* one per Frame for these                                                   */
 /*---------------------------------------------------------------------------*/
 VkBuffer                        meshVertexDataBuffer;
-VkDeviceMemory                  meshVertexDataMemory;
+MemoryAllocation                meshVertexDataMemory;
 VkBuffer                        meshIndexDataBuffer;
-VkDeviceMemory                  meshIndexDataMemory;
+MemoryAllocation                meshIndexDataMemory;
 #ifdef DEV_BUILD
 VkBuffer                        debugColliderVertexDataBuffer;
-VkDeviceMemory                  debugColliderVertexDataMemory;
+MemoryAllocation                debugColliderVertexDataMemory;
 VkBuffer                        debugColliderIndexDataBuffer;
-VkDeviceMemory                  debugColliderIndexDataMemory;
+MemoryAllocation                debugColliderIndexDataMemory;
 #endif
 /*---------------------------------------------------------------------------*/
 /* These contain Instance data sorted by MeshID and are updated every frame  */
@@ -399,33 +515,41 @@ VkDeviceMemory                  debugColliderIndexDataMemory;
 /* used by a frame currently in flight.                                      */
 /*---------------------------------------------------------------------------*/
 std::vector<VkBuffer>           instanceVertexDataBuffers;
-std::vector<VkDeviceMemory>     instanceVertexDataMemoryBlocks;
+std::vector<MemoryAllocation>   instanceVertexDataMemoryBlocks;
 /*---------------------------------------------------------------------------*/
 /* Render Pass Attachments - 1 RTV + 1 DTV per frame                         */
 /*---------------------------------------------------------------------------*/
 std::vector<VkImage>            gameObjectRTs;
-std::vector<VkDeviceMemory>     gameObjectRTMemBlocks;
+std::vector<MemoryAllocation>   gameObjectRTMemBlocks;
 std::vector<VkImageView>        gameObjectRTVs;
 std::vector<VkImage>            gameObjectBloomRTs;
-std::vector<VkDeviceMemory>     gameObjectBloomRTMemBlocks;
+std::vector<MemoryAllocation>   gameObjectBloomRTMemBlocks;
 std::vector<VkImageView>        gameObjectBloomRTVs;
 std::vector<VkImage>            gameObjectDTs;
-std::vector<VkDeviceMemory>     gameObjectDTMemBlocks;
+std::vector<MemoryAllocation>   gameObjectDTMemBlocks;
 std::vector<VkImageView>        gameObjectDTVs;
 std::vector<VkFramebuffer>      gameObjectFramebuffers;
 /*---------------------------------------------------------------------------*/
 /* Read-only Texture Data and Descriptor Sets for each Registered Mesh       */
 /*---------------------------------------------------------------------------*/
 std::vector<VkImage>            materialTextures;
-std::vector<VkDeviceMemory>     materialTextureMemBlocks;
+std::vector<MemoryAllocation>   materialTextureMemBlocks;
 std::vector<VkImageView>        materialTextureSRVs;
 VkDescriptorPool                materialDescriptorPool;
 std::vector<VkDescriptorSet>    materialDescriptorSets;
+/*---------------------------------------------------------------------------*/
+/* Bindless Materials: every Material and Cubemap in a single Descriptor Set */
+/* bound once per frame and indexed through MeshInstanceData::textureIndex   */
+/*---------------------------------------------------------------------------*/
+bool                            bindlessMaterialsSupported;
+VkDescriptorSetLayout           bindlessDescriptorSetLayout;
+VkDescriptorPool                bindlessDescriptorPool;
+VkDescriptorSet                 bindlessDescriptorSet;
 /*===========================================================================*/
 /* Shadow Map Render Resources                                               */
 /*===========================================================================*/
 std::vector<VkImage>            shadowMapDTs;
-std::vector<VkDeviceMemory>     shadowMapDTMemBlocks;
+std::vector<MemoryAllocation>   shadowMapDTMemBlocks;
 std::vector<VkImageView>        shadowMapDTVs;
 std::vector<VkFramebuffer>      shadowMapFramebuffers;
 VkDescriptorPool                shadowMapDescriptorPool;
@@ -436,7 +560,7 @@ std::vector<VkDescriptorSet>    shadowMapDescriptorSets;
 /* Read-only Cubemap Data and Descriptor Sets for each Registered Mesh       */
 /*---------------------------------------------------------------------------*/
 std::vector<VkImage>            cubeMapTextures;
-std::vector<VkDeviceMemory>     cubeMapTextureMemBlocks;
+std::vector<MemoryAllocation>   cubeMapTextureMemBlocks;
 std::vector<VkImageView>        cubeMapTextureSRVs;
 VkDescriptorPool                cubeMapDescriptorPool;
 std::vector<VkDescriptorSet>    cubeMapDescriptorSets;
@@ -444,7 +568,7 @@ std::vector<VkDescriptorSet>    cubeMapDescriptorSets;
 /* Blur Render Resources                                                     */
 /*===========================================================================*/
 std::vector<VkImage>            blurRTs;
-std::vector<VkDeviceMemory>     blurRTMemBlocks;
+std::vector<MemoryAllocation>   blurRTMemBlocks;
 std::vector<VkImageView>        blurRTVs;
 std::vector<VkFramebuffer>      blurPingFramebuffers;
 std::vector<VkFramebuffer>      blurPongFramebuffers;
@@ -454,33 +578,32 @@ std::vector<VkDescriptorSet>    blurPongDescriptorSets;
 /*===========================================================================*/
 /* UI Render Resources                                                       */
 /*===========================================================================*/
-/* UI Vertex/Index Buffers                                                   */
+/* UI Instance Storage Buffers, Glyphs and Sprites of every Canvas           */
 /*---------------------------------------------------------------------------*/
 /* These are updated every frame so we have one per swapchain buffer Image   */
 /*---------------------------------------------------------------------------*/
-std::vector<VkBuffer>           uiSDFVertexDataBuffers;
-std::vector<VkDeviceMemory>     uiSDFVertexDataMemoryBlocks;
-std::vector<VkBuffer>           uiSDFIndexDataBuffers;
-std::vector<VkDeviceMemory>     uiSDFIndexDataMemoryBlocks;
-std::vector<VkBuffer>           uiBlitInstanceDataBuffers;
-std::vector<VkDeviceMemory>     uiBlitInstanceDataMemoryBlocks;
+#define UI_INSTANCE_BUFFER_SIZE (1024 * 1024)
+std::vector<VkBuffer>           uiInstanceDataBuffers;
+std::vector<MemoryAllocation>   uiInstanceDataMemoryBlocks;
+VkDescriptorPool                uiInstanceDescriptorPool;
+std::vector<VkDescriptorSet>    uiInstanceDescriptorSets;
 /*---------------------------------------------------------------------------*/
 /* Render Pass Attachments - 1 RTV per frame                                 */
 /*---------------------------------------------------------------------------*/
 std::vector<VkImage>            uiRTs;
-std::vector<VkDeviceMemory>     uiRTMemBlocks;
+std::vector<MemoryAllocation>   uiRTMemBlocks;
 std::vector<VkImageView>        uiRTVs;
 std::vector<VkFramebuffer>      uiFramebuffers;
 /*---------------------------------------------------------------------------*/
 /* Read-only Atlas Texture Data and Descriptor Sets for each Registered Font */
 /*---------------------------------------------------------------------------*/
 std::vector<VkImage>            fontAtlasTextures;
-std::vector<VkDeviceMemory>     fontAtlasTextureMemBlocks;
+std::vector<MemoryAllocation>   fontAtlasTextureMemBlocks;
 std::vector<VkImageView>        fontAtlasTextureSRVs;
 VkDescriptorPool                uiSDFDescriptorPool;
 std::vector<VkDescriptorSet>    uiSDFDescriptorSets;
 std::vector<VkImage>            spriteAtlasTextures;
-std::vector<VkDeviceMemory>     spriteAtlasTextureMemBlocks;
+std::vector<MemoryAllocation>   spriteAtlasTextureMemBlocks;
 std::vector<VkImageView>        spriteAtlasTextureSRVs;
 VkDescriptorPool                uiBlitDescriptorPool;
 std::vector<VkDescriptorSet>    uiBlitDescriptorSets;
@@ -494,26 +617,24 @@ std::vector<VkDescriptorSet>    perFrameDescriptorSets;
 /*===========================================================================*/
 /* Font Layout Data                                                          */
 /*---------------------------------------------------------------------------*/
-std::vector<BMFont>             fontLayouts;
-/*---------------------------------------------------------------------------*/
-/* Per-Frame Font Batch List - Cleared Every Frame                           */
-/*---------------------------------------------------------------------------*/
-std::vector<FontBatch>          fontBatches;
+TrackedVector<BMFont, MEMORY_TAG_UI> fontLayouts;
 /*---------------------------------------------------------------------------*/
-/* Per-Frame Sprite Batch List - Cleared Every Frame                         */
+/* Per-Frame UI Render List - Cleared Every Frame                            */
 /*---------------------------------------------------------------------------*/
-std::vector<SpriteBatch>        spriteBatches;
+TrackedVector<UIInstance, MEMORY_TAG_UI> uiInstances;
+TrackedVector<UIInstanceKey, MEMORY_TAG_UI> uiInstanceKeys;
+TrackedVector<UIDrawBatch, MEMORY_TAG_UI> uiDrawBatches;
 /*---------------------------------------------------------------------------*/
 /* Mesh Vertex/Index Offset Data and Mesh Bounds Data                        */
 /*---------------------------------------------------------------------------*/
-std::vector<Mesh>               meshVector;
+TrackedVector<Mesh, MEMORY_TAG_GEOMETRY> meshVector;
 std::vector<MeshBounds>         meshBoundsVector;
 /*---------------------------------------------------------------------------*/
 /* Per-Frame Mesh Batch List - Cleared Every Frame                           */
 /*---------------------------------------------------------------------------*/
-std::vector<MeshBatch>          foregroundMeshBatchesVector;
-std::vector<MeshBatch>          gameobjectMeshBatchesVector;
-std::vector<MeshBatch>          backgroundMeshBatchesVector;
+TrackedVector<MeshBatch, MEMORY_TAG_GEOMETRY> foregroundMeshBatchesVector;
+TrackedVector<MeshBatch, MEMORY_TAG_GEOMETRY> gameobjectMeshBatchesVector;
+TrackedVector<MeshBatch, MEMORY_TAG_GEOMETRY> backgroundMeshBatchesVector;
 /*===========================================================================*/
 /* INI Configurable Values                                                   */
 /*===========================================================================*/
@@ -526,6 +647,7 @@ const GVECTORF                  globalDirectionalLightDir = { 0, -1, 1, 0 };
 /* Runtime Dependent Values                                                  */
 /*===========================================================================*/
 uint32_t                        swapchainBufferIndex;
+bool                            perFrameResourcesCreated;   // nothing is drawn without them
 #ifdef DEV_BUILD
 bool                            debugDrawMeshBounds;
 bool                            debugDrawOrthographic;
@@ -553,6 +675,25 @@ bool RenderSystem::InitBackend(std::weak_ptr<const GameConfig> _gameConfig, GVul
     gameCameraDistanceToGameplayPlane = (*readCfg).at("RenderSystem").at("CameraDistanceToGameplayPlane").as<float>();
     foregroundObjectDistanceToGameplayPlane = (*readCfg).at("RenderSystem").at("ForegroundObjectDistanceToGameplayPlane").as<float>();
     backgroundObjectDistanceToGameplayPlane = (*readCfg).at("RenderSystem").at("BackgroundObjectDistanceToGameplayPlane").as<float>();
+    minRenderScale = (*readCfg).at("RenderSystem").at("MinRenderScale").as<float>();
+    maxRenderScale = (*readCfg).at("RenderSystem").at("MaxRenderScale").as<float>();
+    targetGPUFrameTime = (*readCfg).at("RenderSystem").at("TargetGPUFrameTime").as<float>();
+    sharpenStrength = (*readCfg).at("RenderSystem").at("SharpenStrength").as<float>();
+    renderScale = maxRenderScale;
+    smoothedGPUFrameTime = targetGPUFrameTime;
+    /*-----------------------------------------------------------------------*/
+    /* Indexing into the Bindless Arrays only needs to be uniform per draw,  */
+    /* since every instance of a Mesh Batch samples the same Material        */
+    /* The Surface is created with all features enabled (Application.cpp),   */
+    /* so the Device features queried here are also the enabled ones         */
+    /*-----------------------------------------------------------------------*/
+    VkPhysicalDeviceFeatures deviceFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &deviceFeatures);
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    bindlessMaterialsSupported = deviceFeatures.shaderSampledImageArrayDynamicIndexing &&
+        deviceProperties.limits.maxPerStageDescriptorSampledImages >= MAX_MESH_COUNT + MAX_SKYBOX_COUNT + 1 &&
+        deviceProperties.limits.maxDescriptorSetSampledImages >= MAX_MESH_COUNT + MAX_SKYBOX_COUNT + 1;
     CreateShaderModules(device, readCfg);
     readCfg.reset();
 
@@ -574,9 +715,16 @@ bool RenderSystem::InitBackend(std::weak_ptr<const GameConfig> _gameConfig, GVul
     CreateUIBlitPipeline(device);
     CreatePresentPipeline(device);
 
-    CreatePersistentResources(physicalDevice, device);
+    timestampsSupported = deviceProperties.limits.timestampComputeAndGraphics;
+    timestampPeriod = deviceProperties.limits.timestampPeriod;
+    InitMemoryAllocator(physicalDevice);
     vulkan.GetSwapchainImageCount(swapchainBufferCount);
-    CreatePerFrameResources(physicalDevice, device, swapchainBufferCount);
+    // Per-Frame Resources are always created so their Destroy stays in bounds
+    bool resourcesCreated = CreatePersistentResources(physicalDevice, device);
+    perFrameResourcesCreated = CreatePerFrameResources(physicalDevice, device, swapchainBufferCount);
+    resourcesCreated = perFrameResourcesCreated && resourcesCreated;
+    if(!resourcesCreated)
+        std::cout << "RenderSystem: out of device memory creating render resources" << std::endl;
 
     shutdown.Create(_vulkan, [&]() {
         if (+shutdown.Find(GVulkanSurface::Events::RELEASE_RESOURCES, true)) {
@@ -584,6 +732,7 @@ bool RenderSystem::InitBackend(std::weak_ptr<const GameConfig> _gameConfig, GVul
 
                 DestroyPerFrameResources(device, swapchainBufferCount);
                 DestroyPersistentResources(device);
+                DestroyMemoryAllocator(device);
 
                 DestroyPipelines(device);
                 DestroyShaderModules(device);
@@ -604,11 +753,13 @@ bool RenderSystem::InitBackend(std::weak_ptr<const GameConfig> _gameConfig, GVul
             swapchainExtent.height = resizeEventData.surfaceExtent[1];
             vulkan.GetSwapchainImageCount(swapchainBufferCount);
 
-            CreatePerFrameResources(physicalDevice, device, swapchainBufferCount);
+            perFrameResourcesCreated = CreatePerFrameResources(physicalDevice, device, swapchainBufferCount);
+            if(!perFrameResourcesCreated)
+                std::cout << "RenderSystem: out of device memory recreating frame resources, not drawing until the next resize" << std::endl;
         }
     });
 
-    return false;
+    return resourcesCreated;
 }
 
 bool RenderSystem::InitSystems(std::shared_ptr<flecs::world> _game)
@@ -616,37 +767,30 @@ bool RenderSystem::InitSystems(std::shared_ptr<flecs::world> _game)
     struct VulkanBackend {};
     _game->entity("Vulkan Backend").add<VulkanBackend>();
 
-    uiSpriteQuery = _game->query_builder<UIRect, UISprite>().build();
-    uiTextQuery = _game->query_builder<UIRect, UIText>().build();
-    uiCanvasTextQuery = _game->query_builder<UICanvas>()
-    .order_by<UICanvas>([](flecs::entity_t e1, const UICanvas *ui1, flecs::entity_t e2, const UICanvas *ui2) {
-        return (ui1->fontID > ui2->fontID) - (ui1->fontID < ui2->fontID);
-    })
-    .build();
-    uiCanvasSpriteQuery = _game->query_builder<UICanvas>()
-    .order_by<UICanvas>([](flecs::entity_t e1, const UICanvas *ui1, flecs::entity_t e2, const UICanvas *ui2) {
-        return (ui1->spriteAtlasID > ui2->spriteAtlasID) - (ui1->spriteAtlasID < ui2->spriteAtlasID);
+    uiCanvasQuery = _game->query_builder<UICanvas>()
+    .order_by_key<UICanvas>([](flecs::entity_t e, const UICanvas *ui) -> uint64_t {
+        return ((uint64_t)ui->depth << 32) | (uint32_t)e;
     })
     .build();
 
     foregroundSortedQuery = _game->query_builder<Position, Orientation, Scale, StaticMeshComponent, Foreground>()
-    .order_by<StaticMeshComponent>([] (flecs::entity_t e1, const StaticMeshComponent *sm1, flecs::entity_t e2, const StaticMeshComponent *sm2) {
-            return (sm1->meshID > sm2->meshID) - (sm1->meshID < sm2->meshID);
+    .order_by_key<StaticMeshComponent>([] (flecs::entity_t, const StaticMeshComponent *sm) -> uint64_t {
+            return sm->meshID;
     })
     .build();
     gameObjectSortedQuery = _game->query_builder<Position, Orientation, Scale, StaticMeshComponent, Gameobject>()
-    .order_by<StaticMeshComponent>([] (flecs::entity_t e1, const StaticMeshComponent *sm1, flecs::entity_t e2, const StaticMeshComponent *sm2) {
-            return (sm1->meshID > sm2->meshID) - (sm1->meshID < sm2->meshID);
+    .order_by_key<StaticMeshComponent>([] (flecs::entity_t, const StaticMeshComponent *sm) -> uint64_t {
+            return sm->meshID;
     })
     .build();
     backgroundSortedQuery = _game->query_builder<Position, Orientation, Scale, StaticMeshComponent, Background>()
-    .order_by<StaticMeshComponent>([] (flecs::entity_t e1, const StaticMeshComponent *sm1, flecs::entity_t e2, const StaticMeshComponent *sm2) {
-            return (sm1->meshID > sm2->meshID) - (sm1->meshID < sm2->meshID);
+    .order_by_key<StaticMeshComponent>([] (flecs::entity_t, const StaticMeshComponent *sm) -> uint64_t {
+            return sm->meshID;
     })
     .build();
     floorSortedQuery = _game->query_builder<Position, Orientation, Scale, StaticMeshComponent, Floor>()
-    .order_by<StaticMeshComponent>([] (flecs::entity_t e1, const StaticMeshComponent *sm1, flecs::entity_t e2, const StaticMeshComponent *sm2) {
-            return (sm1->meshID > sm2->meshID) - (sm1->meshID < sm2->meshID);
+    .order_by_key<StaticMeshComponent>([] (flecs::entity_t, const StaticMeshComponent *sm) -> uint64_t {
+            return sm->meshID;
     })
     .build();
 
@@ -659,256 +803,45 @@ bool RenderSystem::InitSystems(std::shared_ptr<flecs::world> _game)
     copyRenderingData = _game->system<VulkanBackend>()
      .kind(flecs::OnStore)
      .each([&](flecs::entity e, VulkanBackend& s) {
+        if(!perFrameResourcesCreated)
+            return;
         vulkan.GetSwapchainCurrentImage(swapchainBufferIndex);
         /*-------------------------------------------------------------------*/
-        /* Font Glyph Vertex + Index Data                                    */
+        /* UI Glyph and Sprite Instances, Canvases in Depth Order            */
         /*-------------------------------------------------------------------*/
-        fontBatches.clear();
-        uint32_t vertexCount = 0, indexCount = 0;
-        FontVertex* vertex = (FontVertex*)stagingMappedMemory;
-        uiCanvasTextQuery.each([&vertexCount, &indexCount, &vertex](flecs::entity canvasEntity, const UICanvas& canvas) {
-            if(!canvas.isVisible || canvas.fontID == ~(0u)) return;
-            uiTextQuery.each([&](flecs::entity textEntity, const UIRect& rect, const UIText& text) {
-                if(!textEntity.has(flecs::ChildOf, canvasEntity)) return;
-                BMFont& font = fontLayouts[canvas.fontID];
-                FontBatch fontBatch = {};
-                fontBatch.fontID = canvas.fontID;
-                fontBatch.indexOffset = indexCount;
-                fontBatch.outlineWidth = text.outlineWidth;
-                fontBatch.rect = rect;
-                fontBatch.fontColor = text.fontColor;
-                fontBatch.outlineColor = text.outlineColor;
-                float posX = rect.x;
-                float posY = rect.y;
-                float scaleX = (36.F / swapchainExtent.width) * text.fontSize;
-                float scaleY = (36.F / swapchainExtent.height) * text.fontSize;
-                float lineDelta = (font.lineHeight / 36.F) * scaleY;
-                for(auto it = &text.text[0]; it != &text.text[247] && *it != '\0'; ++it)
-                {
-                    if(*it == '\n')
-                    {
-                        posX = rect.x;
-                        posY += lineDelta;
-                        ++it;
-                        continue;
-                    }
-                    BMFontChar* fontCharInfo = &font.chars[*it];
-                    if(fontCharInfo->width == 0) fontCharInfo->width = 36;
-                    /*===================================================================*/
-                    /* Glyph Parameters                                                  */
-                    /*===================================================================*/
-                    /* Glyph Dimensions                                                  */
-                    /*-------------------------------------------------------------------*/
-                    float charw = (((float)fontCharInfo->width) / 36.F) * scaleX;
-                    float charh = (((float)fontCharInfo->height) / 36.F) * scaleY;
-                    /*-------------------------------------------------------------------*/
-                    /* Font UV                                                           */
-                    /*-------------------------------------------------------------------*/
-                    float us = ((float)fontCharInfo->x) / 512.F;
-                    float ts = ((float)fontCharInfo->y) / 512.F;
-                    float ue = ((float)(fontCharInfo->x + fontCharInfo->width)) / 512.F;
-                    float te = ((float)(fontCharInfo->y + fontCharInfo->height)) / 512.F;
-                    /*-------------------------------------------------------------------*/
-                    /* Offsets relative to Cursor Position                               */
-                    /*-------------------------------------------------------------------*/
-                    float xo = (((float)fontCharInfo->xoffset) / 36.F) * scaleX;
-                    float yo = (((float)fontCharInfo->yoffset) / 36.F) * scaleY;
-                    /*===========================================================*/
-                    /* Write Vertices to Buffer                                  */
-                    /*===========================================================*/
-                    /* Bottom-Right                                              */
-                    /*-----------------------------------------------------------*/
-                    vertex[0].pos = GW::MATH2D::GVECTOR2F { posX + charw + xo, posY + yo + charh };
-                    vertex[0].uv = GW::MATH2D::GVECTOR2F { ue, te };
-                    /*-----------------------------------------------------------*/
-                    /* Bottom-Left                                               */
-                    /*-----------------------------------------------------------*/
-                    vertex[1].pos = GW::MATH2D::GVECTOR2F { posX + xo, posY + yo + charh };
-                    vertex[1].uv = GW::MATH2D::GVECTOR2F { us, te };
-                    /*-----------------------------------------------------------*/
-                    /* Top-Left                                                  */
-                    /*-----------------------------------------------------------*/
-                    vertex[2].pos = GW::MATH2D::GVECTOR2F { posX + xo, posY + yo };
-                    vertex[2].uv = GW::MATH2D::GVECTOR2F { us, ts };
-                    /*-----------------------------------------------------------*/
-                    /* Top-Right                                                 */
-                    /*-----------------------------------------------------------*/
-                    vertex[3].pos = GW::MATH2D::GVECTOR2F { posX + charw + xo, posY + yo };
-                    vertex[3].uv = GW::MATH2D::GVECTOR2F { ue, ts };
-                    /*===========================================================*/
-                    vertex = &vertex[4];
-                    vertexCount += 4;
-                    fontBatch.indexCount += 6;
-                    indexCount += 6;
-                    float advance = ((float)(fontCharInfo->xadvance) / 36.F) * scaleX;
-                    posX += advance;
-                }
-                fontBatches.push_back(fontBatch);
-            });
+        uiInstances.clear();
+        uiInstanceKeys.clear();
+        uiCanvasQuery.each([](flecs::entity canvasEntity, const UICanvas& canvas) {
+            if(canvas.isVisible) GatherUIInstances(canvasEntity, canvas);
         });
-        if(vertexCount) {
-            GvkHelper::copy_buffer(device, commandPool, graphicsQueue,
-                stagingBuffer, uiSDFVertexDataBuffers[swapchainBufferIndex],
-                sizeof(FontVertex) * vertexCount);
-        }
-        uint32_t* index = (uint32_t*)stagingMappedMemory;
-        for(int i = 0; i < vertexCount; i += 4)
-        {
-            *index++ = i + 0;
-            *index++ = i + 1;
-            *index++ = i + 2;
-            *index++ = i + 2;
-            *index++ = i + 3;
-            *index++ = i + 0;
-        }
-        if(indexCount) {
-            GvkHelper::copy_buffer(device, commandPool, graphicsQueue,
-                stagingBuffer, uiSDFIndexDataBuffers[swapchainBufferIndex],
-                sizeof(uint32_t) * indexCount);
-        }
-        /*-------------------------------------------------------------------*/
-        /* UI Sprite Instance Data                                           */
-        /*-------------------------------------------------------------------*/
-        spriteBatches.clear();
-        uint32_t spriteInstanceCount = 0;
-        SpriteInstance* instance = (SpriteInstance*)stagingMappedMemory;
-        uiCanvasTextQuery.each([&spriteInstanceCount, &instance](flecs::entity canvasEntity, const UICanvas& canvas) {
-            if(!canvas.isVisible || canvas.spriteAtlasID == ~(0u)) return;
-            SpriteBatch spriteBatch = {};
-            spriteBatch.spriteAtlasID = canvas.spriteAtlasID;
-            spriteBatch.instanceOffset = spriteInstanceCount;
-            uiSpriteQuery.each([&](flecs::entity e, const UIRect& rect, const UISprite& sprite) {
-                instance->srcRect = sprite.srcRect;
-                instance->dstRect.x = rect.x;
-                instance->dstRect.y = rect.y;
-                instance->dstRect.z = rect.width / swapchainExtent.width;
-                instance->dstRect.w = rect.height / swapchainExtent.height;
-                ++instance;
-                ++spriteBatch.instanceCount;
-                ++spriteInstanceCount;
-            });
-            spriteBatches.push_back(spriteBatch);
-        });
-        if(spriteInstanceCount) {
-            GvkHelper::copy_buffer(device, commandPool, graphicsQueue,
-                stagingBuffer, uiBlitInstanceDataBuffers[swapchainBufferIndex],
-                sizeof(SpriteInstance) * spriteInstanceCount);
-        }
+        BuildUIDrawBatches(swapchainBufferIndex);
         /*-------------------------------------------------------------------*/
         /* Static Mesh Instance Data                                         */
         /*-------------------------------------------------------------------*/
         uint32_t instanceCount = 0;
         MeshInstanceData* instanceData = (MeshInstanceData*)stagingMappedMemory;
-        MeshBatch meshBatch;
         backgroundMeshBatchesVector.clear();
-        meshBatch.meshID = ~(0u);
-        backgroundSortedQuery.each([&](flecs::entity e, Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm, Background) {
-            if(meshBatch.meshID != sm.meshID)
-            {
-                if(meshBatch.meshID != ~(0u)) backgroundMeshBatchesVector.push_back(meshBatch);
-                meshBatch.meshID = sm.meshID;
-                meshBatch.instanceOffset = instanceCount;
-                meshBatch.instanceCount = 0;
-            }
-            instanceData->transform = GW::MATH::GIdentityMatrixF;
-            instanceData->transform.row4.x = backgroundObjectDistanceToGameplayPlane;
-            instanceData->transform.row4.y = p.value.x;
-            instanceData->transform.row4.z = p.value.y;
-            instanceData->transform.row1.x = -o.value.row1.x * s.value.x;
-            instanceData->transform.row1.z =  o.value.row2.x * s.value.y;
-            instanceData->transform.row3.x =  o.value.row1.y * s.value.x;
-            instanceData->transform.row3.z = -o.value.row2.y * s.value.y;
-            instanceData->transform.row2.y = s.value.z;
-            instanceData->isGameObject = 0;
-            instanceData->bloomColor = { 0, 0, 0, 1 };
-            ++meshBatch.instanceCount;
-            ++instanceCount;
-            ++instanceData;
-        });
-        if(meshBatch.meshID != ~(0u)) backgroundMeshBatchesVector.push_back(meshBatch);
-        floorSortedQuery.each([&](flecs::entity e, Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm, Floor) {
-            if(meshBatch.meshID != sm.meshID)
-            {
-                if(meshBatch.meshID != ~(0u)) backgroundMeshBatchesVector.push_back(meshBatch);
-                meshBatch.meshID = sm.meshID;
-                meshBatch.instanceOffset = instanceCount;
-                meshBatch.instanceCount = 0;
-            }
-            instanceData->transform = GW::MATH::GIdentityMatrixF;
-            instanceData->transform.row4.y = p.value.x;
-            instanceData->transform.row4.z = p.value.y;
-            instanceData->transform.row1.x = -o.value.row1.x * s.value.x;
-            instanceData->transform.row1.z =  o.value.row2.x * s.value.y;
-            instanceData->transform.row3.x =  o.value.row1.y * s.value.x;
-            instanceData->transform.row3.z = -o.value.row2.y * s.value.y;
-            instanceData->transform.row2.y = s.value.z;
-            instanceData->isGameObject = 0;
-            instanceData->bloomColor = { 0, 0, 0, 1 };
-            ++meshBatch.instanceCount;
-            ++instanceCount;
-            ++instanceData;
-        });
-        if(meshBatch.meshID != ~(0u)) backgroundMeshBatchesVector.push_back(meshBatch);
+        PackMeshInstances(backgroundSortedQuery, backgroundObjectDistanceToGameplayPlane, 0,
+            instanceData, instanceCount, backgroundMeshBatchesVector);
+        PackMeshInstances(floorSortedQuery, 0.F, 0,
+            instanceData, instanceCount, backgroundMeshBatchesVector);
         gameobjectMeshBatchesVector.clear();
-        meshBatch.meshID = ~(0u);
-        gameObjectSortedQuery.each([&](flecs::entity e, Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm, Gameobject) {
-            if(meshBatch.meshID != sm.meshID)
-            {
-                if(meshBatch.meshID != ~(0u)) gameobjectMeshBatchesVector.push_back(meshBatch);
-                meshBatch.meshID = sm.meshID;
-                meshBatch.instanceOffset = instanceCount;
-                meshBatch.instanceCount = 0;
-            }
-            instanceData->transform = GW::MATH::GIdentityMatrixF;
-            instanceData->transform.row4.y = p.value.x;
-            instanceData->transform.row4.z = p.value.y;
-            instanceData->transform.row1.x = -o.value.row1.x * s.value.x;
-            instanceData->transform.row1.z =  o.value.row2.x * s.value.y;
-            instanceData->transform.row3.x =  o.value.row1.y * s.value.x;
-            instanceData->transform.row3.z = -o.value.row2.y * s.value.y;
-            instanceData->transform.row2.y = s.value.z;
-            instanceData->isGameObject = 1;
-            instanceData->bloomColor = { 0, 0, 0, 1 };
-            if(e.has<Bullet>())
-            {
-                instanceData->bloomColor.x = 1;
-                if(e.get<AlliedWith>()->faction == Faction::PLAYER)
+        PackMeshInstances(gameObjectSortedQuery, 0.F, 1,
+            instanceData, instanceCount, gameobjectMeshBatchesVector,
+            [](flecs::entity e, MeshInstanceData& instance) {
+                if(e.has<Bullet>())
                 {
-                    instanceData->bloomColor.y = 1;
-                    instanceData->bloomColor.z = 1;
+                    instance.bloomColor.x = 1;
+                    if(e.get<AlliedWith>()->faction == Faction::PLAYER)
+                    {
+                        instance.bloomColor.y = 1;
+                        instance.bloomColor.z = 1;
+                    }
                 }
-            }
-            ++meshBatch.instanceCount;
-            ++instanceCount;
-            ++instanceData;
-        });
-        if(meshBatch.meshID != ~(0u)) gameobjectMeshBatchesVector.push_back(meshBatch);
+            });
         foregroundMeshBatchesVector.clear();
-        meshBatch.meshID = ~(0u);
-        foregroundSortedQuery.each([&](flecs::entity e, Position& p, Orientation& o, Scale& s, StaticMeshComponent& sm, Foreground) {
-            if(meshBatch.meshID != sm.meshID)
-            {
-                if(meshBatch.meshID != ~(0u)) foregroundMeshBatchesVector.push_back(meshBatch);
-                meshBatch.meshID = sm.meshID;
-                meshBatch.instanceOffset = instanceCount;
-                meshBatch.instanceCount = 0;
-            }
-            instanceData->transform = GW::MATH::GIdentityMatrixF;
-            instanceData->transform.row4.x = foregroundObjectDistanceToGameplayPlane;
-            instanceData->transform.row4.y = p.value.x;
-            instanceData->transform.row4.z = p.value.y;
-            instanceData->transform.row1.x = -o.value.row1.x * s.value.x;
-            instanceData->transform.row1.z =  o.value.row2.x * s.value.y;
-            instanceData->transform.row3.x =  o.value.row1.y * s.value.x;
-            instanceData->transform.row3.z = -o.value.row2.y * s.value.y;
-            instanceData->transform.row2.y = s.value.z;
-            instanceData->isGameObject = 0;
-            instanceData->bloomColor = { 0, 0, 0, 1 };
-            ++meshBatch.instanceCount;
-            ++instanceCount;
-            ++instanceData;
-        });
-        if(meshBatch.meshID != ~(0u)) foregroundMeshBatchesVector.push_back(meshBatch);
+        PackMeshInstances(foregroundSortedQuery, foregroundObjectDistanceToGameplayPlane, 0,
+            instanceData, instanceCount, foregroundMeshBatchesVector);
         if(instanceCount) {
             GvkHelper::copy_buffer(device, commandPool, graphicsQueue,
                 stagingBuffer, instanceVertexDataBuffers[swapchainBufferIndex],
@@ -919,7 +852,10 @@ bool RenderSystem::InitSystems(std::shared_ptr<flecs::world> _game)
     present = _game->system<VulkanBackend>()
         .kind(flecs::OnStore)
         .each([&](flecs::entity e, VulkanBackend& s) {
+            if(!perFrameResourcesCreated)
+                return;
             const Skybox* skybox = e.world().get<Skybox>();
+            UpdateRenderScale(swapchainBufferIndex);
             SubmitShadowMapDrawCommands(swapchainBufferIndex);
             SubmitGameObjectDrawCommands(swapchainBufferIndex, skybox);
             SubmitBloomBlurDrawCommands(swapchainBufferIndex);
@@ -939,28 +875,65 @@ bool RenderSystem::ExitSystems()
     gameObjectSortedQuery.destruct();
     backgroundSortedQuery.destruct();
     floorSortedQuery.destruct();
-    uiCanvasTextQuery.destruct();
-    uiCanvasSpriteQuery.destruct();
-    uiTextQuery.destruct();
-    uiSpriteQuery.destruct();
+    uiCanvasQuery.destruct();
     present.destruct();
 
     return true;
 }
 
+void RenderSystem::WriteBindlessTextureDescriptors(uint32_t _binding, uint32_t _firstElement, uint32_t _arraySize, VkImageView _textureSRV)
+{
+    /*=======================================================================*/
+    /* Without partially bound Descriptors every array element has to stay  */
+    /* valid, so the newest Texture also fills all slots not yet registered  */
+    /*=======================================================================*/
+    assert(_firstElement < _arraySize);
+    std::vector<VkDescriptorImageInfo> imageInfos(_arraySize - _firstElement);
+    for(uint32_t i = 0; i < imageInfos.size(); ++i)
+    {
+        imageInfos[i].sampler = VK_NULL_HANDLE;
+        imageInfos[i].imageView = _textureSRV;
+        imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+    VkWriteDescriptorSet descriptorWrites[1];
+    ZeroMemory(descriptorWrites, sizeof(VkWriteDescriptorSet));
+    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet = bindlessDescriptorSet;
+    descriptorWrites[0].dstBinding = _binding;
+    descriptorWrites[0].dstArrayElement = _firstElement;
+    descriptorWrites[0].descriptorCount = imageInfos.size();
+    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    descriptorWrites[0].pImageInfo = imageInfos.data();
+    vkUpdateDescriptorSets(device, 1, descriptorWrites, 0, NULL);
+}
+
 uint32_t RenderSystem::RegisterSkybox(const char* _cubeMapTexturePath)
 {
-    uint32_t outID = cubeMapDescriptorSets.size();
+    /*-----------------------------------------------------------------------*/
+    /* Numbered by Texture, the Bindless path never allocates a Set          */
+    /*-----------------------------------------------------------------------*/
+    uint32_t outID = cubeMapTextures.size();
+    if(outID >= MAX_SKYBOX_COUNT)
+    {
+        std::cout << "RenderSystem: more than " << MAX_SKYBOX_COUNT << " skyboxes, " << _cubeMapTexturePath << " not loaded" << std::endl;
+        return ~(0u);
+    }
     /*=======================================================================*/
     /* DDS Texture File                                                      */
     /*=======================================================================*/
     VkImage cubeMapTexture;
-    VkDeviceMemory cubeMapTextureMemory;
+    MemoryAllocation cubeMapTextureMemory;
     VkImageView cubeMapTextureSRV;
-    LoadDDSCubemap(_cubeMapTexturePath, physicalDevice, device, &cubeMapTexture, &cubeMapTextureMemory, &cubeMapTextureSRV);
+    if(!LoadDDSCubemap(_cubeMapTexturePath, physicalDevice, device, &cubeMapTexture, &cubeMapTextureMemory, &cubeMapTextureSRV))
+        return ~(0u);
     cubeMapTextures.push_back(cubeMapTexture);
     cubeMapTextureMemBlocks.push_back(cubeMapTextureMemory);
     cubeMapTextureSRVs.push_back(cubeMapTextureSRV);
+    if(bindlessMaterialsSupported)
+    {
+        WriteBindlessTextureDescriptors(2, outID, MAX_SKYBOX_COUNT, cubeMapTextureSRV);
+        return outID;
+    }
     /*=======================================================================*/
     /* Allocate Descriptor Set                                               */
     /*=======================================================================*/
@@ -996,6 +969,11 @@ uint32_t RenderSystem::RegisterSkybox(const char* _cubeMapTexturePath)
 uint32_t RenderSystem::RegisterMesh(const char* _meshPath, const char* _baseTexturePath)
 {
     uint32_t outID = meshVector.size();
+    if(outID >= MAX_MESH_COUNT)
+    {
+        std::cout << "RenderSystem: more than " << MAX_MESH_COUNT << " meshes, " << _meshPath << " not loaded" << std::endl;
+        return ~(0u);
+    }
     /*=======================================================================*/
     /* H2B Mesh File                                                         */
     /*=======================================================================*/
@@ -1020,12 +998,22 @@ uint32_t RenderSystem::RegisterMesh(const char* _meshPath, const char* _baseText
     /* DDS Texture File                                                      */
     /*=======================================================================*/
     VkImage texture;
-    VkDeviceMemory textureMemory;
+    MemoryAllocation textureMemory;
     VkImageView textureSRV;
-    LoadDDSTexture(_baseTexturePath, physicalDevice, device, &texture, &textureMemory, &textureSRV);
+    if(!LoadDDSTexture(_baseTexturePath, physicalDevice, device, &texture, &textureMemory, &textureSRV))
+    {
+        meshVector.pop_back();
+        meshBoundsVector.pop_back();
+        return ~(0u);
+    }
     materialTextures.push_back(texture);
     materialTextureMemBlocks.push_back(textureMemory);
     materialTextureSRVs.push_back(textureSRV);
+    if(bindlessMaterialsSupported)
+    {
+        WriteBindlessTextureDescriptors(0, outID, MAX_MESH_COUNT, textureSRV);
+        return outID;
+    }
     /*=======================================================================*/
     /* Allocate Descriptor Set                                               */
     /*=======================================================================*/
@@ -1062,11 +1050,13 @@ uint32_t RenderSystem::RegisterUIFont(const char* _fontLayoutPath, const char *_
 {
     uint32_t outID = fontLayouts.size();
     BMFont fontLayout;
-    LoadBMFont(_fontLayoutPath, fontLayout);
+    if(!LoadBMFont(_fontLayoutPath, fontLayout))
+        return ~(0u);
     VkImage fontTexture;
-    VkDeviceMemory fontTextureMemory;
+    MemoryAllocation fontTextureMemory;
     VkImageView fontTextureSRV;
-    LoadTGATexture(_atlasTexturePath, physicalDevice, device, &fontTexture, &fontTextureMemory, &fontTextureSRV);
+    if(!LoadTGATexture(_atlasTexturePath, physicalDevice, device, &fontTexture, &fontTextureMemory, &fontTextureSRV))
+        return ~(0u);
     fontLayouts.push_back(fontLayout);
     fontAtlasTextures.push_back(fontTexture);
     fontAtlasTextureMemBlocks.push_back(fontTextureMemory);
@@ -1107,9 +1097,10 @@ uint32_t RenderSystem::RegisterUISpriteAtlas(const char *_atlasTexturePath)
 {
     uint32_t outID = spriteAtlasTextures.size();
     VkImage spriteAtlasTexture;
-    VkDeviceMemory spriteAtlasTextureMemory;
+    MemoryAllocation spriteAtlasTextureMemory;
     VkImageView spriteAtlasTextureSRV;
-    LoadTGATexture(_atlasTexturePath, physicalDevice, device, &spriteAtlasTexture, &spriteAtlasTextureMemory, &spriteAtlasTextureSRV);
+    if(!LoadTGATexture(_atlasTexturePath, physicalDevice, device, &spriteAtlasTexture, &spriteAtlasTextureMemory, &spriteAtlasTextureSRV))
+        return ~(0u);
     spriteAtlasTextures.push_back(spriteAtlasTexture);
     spriteAtlasTextureMemBlocks.push_back(spriteAtlasTextureMemory);
     spriteAtlasTextureSRVs.push_back(spriteAtlasTextureSRV);
@@ -1157,6 +1148,11 @@ void RenderSystem::SubmitShadowMapDrawCommands(uint32_t bufferIndex)
 {
     VkCommandBuffer cmd = VK_NULL_HANDLE;
     GvkHelper::signal_command_start(device, commandPool, &cmd);
+    if(timestampsSupported)
+    {
+        vkCmdResetQueryPool(cmd, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT, FRAME_TIMESTAMP_COUNT);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT + 0);
+    }
     VkClearValue clearValues[1];
     clearValues[0].depthStencil = {1.0f, 0u};
     VkRenderPassBeginInfo begin_info;
@@ -1164,7 +1160,7 @@ void RenderSystem::SubmitShadowMapDrawCommands(uint32_t bufferIndex)
     begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     begin_info.renderPass = shadowMapRenderPass;
     begin_info.framebuffer = shadowMapFramebuffers[bufferIndex];
-    begin_info.renderArea = { 0, 0, 1024, 1024 };
+    begin_info.renderArea = { 0, 0, shadowMapViewportSize, shadowMapViewportSize };
     begin_info.clearValueCount = 1;
     begin_info.pClearValues = clearValues;
     vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
@@ -1187,9 +1183,9 @@ void RenderSystem::SubmitShadowMapDrawCommands(uint32_t bufferIndex)
     GMatrix::TransposeF(lightMatrix, lightMatrix);
     vkCmdPushConstants(cmd, shadowMapPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
         0, sizeof(GMATRIXF), &lightMatrix);
-    VkViewport viewport = { 0, 0, 1024, 1024, 0, 1 };
+    VkViewport viewport = { 0, 0, (float)shadowMapViewportSize, (float)shadowMapViewportSize, 0, 1 };
     vkCmdSetViewport(cmd, 0, 1, &viewport);
-    VkRect2D scissor = { 0, 0, 1024, 1024 };
+    VkRect2D scissor = { 0, 0, shadowMapViewportSize, shadowMapViewportSize };
     vkCmdSetScissor(cmd, 0, 1, &scissor);
     for(uint32_t i = 0; i < backgroundMeshBatchesVector.size(); ++i)
     {
@@ -1219,6 +1215,8 @@ void RenderSystem::SubmitShadowMapDrawCommands(uint32_t bufferIndex)
             mesh.indexOffset, mesh.vertexOffset, meshBatch.instanceOffset);
     }
     vkCmdEndRenderPass(cmd);
+    if(timestampsSupported)
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT + 1);
     GvkHelper::signal_command_end(device, graphicsQueue, commandPool, &cmd);
 }
 
@@ -1280,12 +1278,25 @@ void RenderSystem::SubmitGameObjectDrawCommands(uint32_t bufferIndex, const Skyb
     proj.row3.data[2] = 1.f / (200.f - 0.1f);
     proj.row4.data[2] = -0.1f / (200.f - 0.1f);
     GMatrix::MultiplyMatrixF(lightMatrix, proj, lightMatrix);
+    /*-----------------------------------------------------------------------*/
+    /* The Shadow Map was only drawn into its top-left Viewport, so remap    */
+    /* clip space xy so the shader's (xy * 0.5 + 0.5) lands inside it        */
+    /*-----------------------------------------------------------------------*/
+    float shadowMapScale = shadowMapViewportSize / 1024.f;
+    GMATRIXF shadowViewportMatrix = GIdentityMatrixF;
+    shadowViewportMatrix.row1.x = shadowMapScale;
+    shadowViewportMatrix.row2.y = shadowMapScale;
+    shadowViewportMatrix.row4.x = shadowMapScale - 1;
+    shadowViewportMatrix.row4.y = shadowMapScale - 1;
+    GMatrix::MultiplyMatrixF(lightMatrix, shadowViewportMatrix, lightMatrix);
     GMatrix::TransposeF(lightMatrix, lightMatrix);
     /*=======================================================================*/
     /* Record Rendering Commands                                             */
     /*=======================================================================*/
     VkCommandBuffer cmd = VK_NULL_HANDLE;
     GvkHelper::signal_command_start(device, commandPool, &cmd);
+    if(timestampsSupported)
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT + 2);
     VkClearValue clearValues[3];
     clearValues[0].color = {{0.39F, 0.58F, 0.93f, 1}};
     clearValues[1].color = {{ 0.F, 0.F, 0.f, 0}};
@@ -1295,7 +1306,7 @@ void RenderSystem::SubmitGameObjectDrawCommands(uint32_t bufferIndex, const Skyb
     begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     begin_info.renderPass = staticMeshRenderPass;
     begin_info.framebuffer = gameObjectFramebuffers[bufferIndex];
-    begin_info.renderArea = { 0, 0, swapchainExtent.width, swapchainExtent.height };
+    begin_info.renderArea = { 0, 0, sceneViewportExtent.width, sceneViewportExtent.height };
     begin_info.clearValueCount = 3;
     begin_info.pClearValues = clearValues;
     vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
@@ -1314,23 +1325,28 @@ void RenderSystem::SubmitGameObjectDrawCommands(uint32_t bufferIndex, const Skyb
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
         1, 1, &shadowMapDescriptorSets[bufferIndex],
         0, nullptr);
+    if(bindlessMaterialsSupported)
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
+            0, 1, &bindlessDescriptorSet,
+            0, nullptr);
     VkViewport viewport = {0,
-                           (float)swapchainExtent.height,
-                           (float)swapchainExtent.width,
-                           -1.F * swapchainExtent.height,
+                           (float)sceneViewportExtent.height,
+                           (float)sceneViewportExtent.width,
+                           -1.F * sceneViewportExtent.height,
                            0,
                            1};
     vkCmdSetViewport(cmd, 0, 1, &viewport);
-    VkRect2D scissor = { 0, 0, swapchainExtent.width, swapchainExtent.height };
+    VkRect2D scissor = { 0, 0, sceneViewportExtent.width, sceneViewportExtent.height };
     vkCmdSetScissor(cmd, 0, 1, &scissor);
     for(uint32_t i = 0; i < backgroundMeshBatchesVector.size(); ++i)
     {
         const auto& meshBatch = backgroundMeshBatchesVector[i];
         const auto& mesh = meshVector[meshBatch.meshID];
         if(!meshBatch.instanceCount) continue;
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
-            0, 1, &materialDescriptorSets[meshBatch.meshID],
-            0, nullptr);
+        if(!bindlessMaterialsSupported)
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
+                0, 1, &materialDescriptorSets[meshBatch.meshID],
+                0, nullptr);
         vkCmdDrawIndexed(cmd,
             mesh.indexCount, meshBatch.instanceCount,
             mesh.indexOffset, mesh.vertexOffset, meshBatch.instanceOffset);
@@ -1340,9 +1356,10 @@ void RenderSystem::SubmitGameObjectDrawCommands(uint32_t bufferIndex, const Skyb
         const auto& meshBatch = gameobjectMeshBatchesVector[i];
         const auto& mesh = meshVector[meshBatch.meshID];
         if(!meshBatch.instanceCount) continue;
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
-            0, 1, &materialDescriptorSets[meshBatch.meshID],
-            0, nullptr);
+        if(!bindlessMaterialsSupported)
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
+                0, 1, &materialDescriptorSets[meshBatch.meshID],
+                0, nullptr);
         vkCmdDrawIndexed(cmd,
             mesh.indexCount, meshBatch.instanceCount,
             mesh.indexOffset, mesh.vertexOffset, meshBatch.instanceOffset);
@@ -1352,9 +1369,10 @@ void RenderSystem::SubmitGameObjectDrawCommands(uint32_t bufferIndex, const Skyb
         const auto& meshBatch = foregroundMeshBatchesVector[i];
         const auto& mesh = meshVector[meshBatch.meshID];
         if(!meshBatch.instanceCount) continue;
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
-            0, 1, &materialDescriptorSets[meshBatch.meshID],
-            0, nullptr);
+        if(!bindlessMaterialsSupported)
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, staticMeshPipelineLayout,
+                0, 1, &materialDescriptorSets[meshBatch.meshID],
+                0, nullptr);
         vkCmdDrawIndexed(cmd,
             mesh.indexCount, meshBatch.instanceCount,
             mesh.indexOffset, mesh.vertexOffset, meshBatch.instanceOffset);
@@ -1381,11 +1399,17 @@ void RenderSystem::SubmitGameObjectDrawCommands(uint32_t bufferIndex, const Skyb
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, skyBoxPipeline);
     vkCmdPushConstants(cmd, skyBoxPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
         0, sizeof(GMATRIXF), &skyBoxMatrix);
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, skyBoxPipelineLayout,
-        0, 1, &cubeMapDescriptorSets[skybox->skyBoxTextureID],
-        0, nullptr);
+    if(bindlessMaterialsSupported)
+        vkCmdPushConstants(cmd, skyBoxPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
+            sizeof(GMATRIXF) * 2, sizeof(uint32_t), &skybox->skyBoxTextureID);
+    else
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, skyBoxPipelineLayout,
+            0, 1, &cubeMapDescriptorSets[skybox->skyBoxTextureID],
+            0, nullptr);
     vkCmdDraw(cmd, 36, 1, 0, 0);
     vkCmdEndRenderPass(cmd);
+    if(timestampsSupported)
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT + 3);
     GvkHelper::signal_command_end(device, graphicsQueue, commandPool, &cmd);
 }
 
@@ -1393,53 +1417,139 @@ void RenderSystem::SubmitBloomBlurDrawCommands(uint32_t bufferIndex)
 {
     VkViewport viewport = {
         0, 0,
-        (float)swapchainExtent.width, (float)swapchainExtent.height,
+        (float)sceneViewportExtent.width, (float)sceneViewportExtent.height,
         0, 1 };
     VkRect2D scissor = {
         0, 0,
-        (uint32_t)swapchainExtent.width, (uint32_t)swapchainExtent.height
+        (uint32_t)sceneViewportExtent.width, (uint32_t)sceneViewportExtent.height
     };
     VkCommandBuffer cmd = VK_NULL_HANDLE;
     GvkHelper::signal_command_start(device, commandPool, &cmd);
+    if(timestampsSupported)
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT + 4);
 
     VkRenderPassBeginInfo begin_info;
     ZeroMemory(&begin_info, sizeof(VkRenderPassBeginInfo));
     begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     begin_info.renderPass = blurRenderPass;
-    begin_info.renderArea = { 0, 0, swapchainExtent.width, swapchainExtent.height };
+    begin_info.renderArea = { 0, 0, sceneViewportExtent.width, sceneViewportExtent.height };
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, blurPipeline);
     vkCmdSetViewport(cmd, 0, 1, &viewport);
     vkCmdSetScissor(cmd, 0, 1, &scissor);
+    BlurPushConstants blurConstants;
+    blurConstants.uvScale.x = (float)sceneViewportExtent.width / sceneTargetExtent.width;
+    blurConstants.uvScale.y = (float)sceneViewportExtent.height / sceneTargetExtent.height;
     for(int i = 0; i < 5; ++i)
     {
-        uint32_t blurDirection = 0;
+        blurConstants.blurDirection = 0;
         begin_info.framebuffer = blurPingFramebuffers[bufferIndex];
         vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
         vkCmdPushConstants(cmd, blurPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
-            0, sizeof(uint32_t), &blurDirection);
+            0, sizeof(BlurPushConstants), &blurConstants);
         vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, blurPipelineLayout,
             0, 1, &blurPingDescriptorSets[bufferIndex],
             0, nullptr);
         vkCmdDraw(cmd, 3, 1, 0, 0);
         vkCmdEndRenderPass(cmd);
-        blurDirection = 1;
+        blurConstants.blurDirection = 1;
         begin_info.framebuffer = blurPongFramebuffers[bufferIndex];
         vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
         vkCmdPushConstants(cmd, blurPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
-            0, sizeof(uint32_t), &blurDirection);
+            0, sizeof(BlurPushConstants), &blurConstants);
         vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, blurPipelineLayout,
             0, 1, &blurPongDescriptorSets[bufferIndex],
             0, nullptr);
         vkCmdDraw(cmd, 3, 1, 0, 0);
         vkCmdEndRenderPass(cmd);
     }
-    for(uint32_t i = 0; i < spriteBatches.size(); ++i)
+    if(timestampsSupported)
     {
-        const auto& spriteBatch = spriteBatches[i];
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT + 5);
+        frameTimestampsWritten[bufferIndex] = true;
+    }
+    GvkHelper::signal_command_end(device, graphicsQueue, commandPool, &cmd);
+}
 
+void RenderSystem::GatherUIInstances(flecs::entity _parent, const UICanvas& _canvas)
+{
+    /*-----------------------------------------------------------------------*/
+    /* Walks the whole Hierarchy below the Canvas. Nested Canvases are left  */
+    /* to the Canvas Query, they draw at their own Depth                     */
+    /*-----------------------------------------------------------------------*/
+    _parent.children([&_canvas](flecs::entity child) {
+        if(child.has<UICanvas>()) return;
+        const UIRect* rect = child.get<UIRect>();
+        if(rect)
+        {
+            const UISprite* sprite = child.get<UISprite>();
+            if(sprite && _canvas.spriteAtlasID != ~(0u)) AppendUISprite(*rect, *sprite, _canvas);
+            const UIText* text = child.get<UIText>();
+            if(text && _canvas.fontID != ~(0u)) AppendUIText(*rect, *text, _canvas);
+        }
+        GatherUIInstances(child, _canvas);
+    });
+}
+
+void RenderSystem::AppendUIText(const UIRect& _rect, const UIText& _text, const UICanvas& _canvas)
+{
+    LayoutUIText(fontLayouts[_canvas.fontID], _rect, _text,
+        (float)swapchainExtent.width, (float)swapchainExtent.height,
+        [&_canvas](const UIInstance& _glyph) {
+            PushUIInstance(_glyph, _canvas.depth, UI_PIPELINE_SDF, _canvas.fontID);
+        });
+}
 
+void RenderSystem::AppendUISprite(const UIRect& _rect, const UISprite& _sprite, const UICanvas& _canvas)
+{
+    UIInstance instance;
+    instance.srcRect = _sprite.srcRect;
+    instance.dstRect.x = _rect.x;
+    instance.dstRect.y = _rect.y;
+    instance.dstRect.z = 2.F * _rect.width / swapchainExtent.width;
+    instance.dstRect.w = 2.F * _rect.height / swapchainExtent.height;
+    instance.clipRect = GVECTORF { 0.F, 0.F, (float)swapchainExtent.width, (float)swapchainExtent.height };
+    instance.color = GVECTORF { 1.F, 1.F, 1.F, 1.F };
+    instance.outline = GVECTORF { 0.F, 0.F, 0.F, 0.F };
+    PushUIInstance(instance, _canvas.depth, UI_PIPELINE_BLIT, _canvas.spriteAtlasID);
+}
+
+void RenderSystem::PushUIInstance(const UIInstance& _instance, uint32_t _depth, UIPipeline _pipeline, uint32_t _atlasID)
+{
+    UIInstanceKey key;
+    key.key = ((uint64_t)_depth << 32) | ((uint64_t)_pipeline << 31) | (_atlasID & 0x7FFFFFFF);
+    key.index = (uint32_t)uiInstances.size();
+    uiInstanceKeys.push_back(key);
+    uiInstances.push_back(_instance);
+}
+
+void RenderSystem::BuildUIDrawBatches(uint32_t bufferIndex)
+{
+    /*-----------------------------------------------------------------------*/
+    /* Sorted by Depth, then Pipeline and Atlas. Equal Pipeline and Atlas    */
+    /* runs become one Draw, even across Depths, since Instances of a Draw   */
+    /* still blend in order                                                  */
+    /*-----------------------------------------------------------------------*/
+    std::sort(uiInstanceKeys.begin(), uiInstanceKeys.end());
+    uint32_t instanceCount = (uint32_t)uiInstanceKeys.size();
+    if(instanceCount > UI_INSTANCE_BUFFER_SIZE / sizeof(UIInstance))
+        instanceCount = UI_INSTANCE_BUFFER_SIZE / sizeof(UIInstance);
+    uiDrawBatches.clear();
+    UIInstance* instance = (UIInstance*)stagingMappedMemory;
+    for(uint32_t i = 0; i < instanceCount; ++i)
+    {
+        const UIInstanceKey& key = uiInstanceKeys[i];
+        UIPipeline pipeline = (UIPipeline)((key.key >> 31) & 1);
+        uint32_t atlasID = (uint32_t)(key.key & 0x7FFFFFFF);
+        if(uiDrawBatches.empty() || uiDrawBatches.back().pipeline != pipeline || uiDrawBatches.back().atlasID != atlasID)
+            uiDrawBatches.push_back({ pipeline, atlasID, i, 0 });
+        ++uiDrawBatches.back().instanceCount;
+        instance[i] = uiInstances[key.index];
+    }
+    if(instanceCount) {
+        GvkHelper::copy_buffer(device, commandPool, graphicsQueue,
+            stagingBuffer, uiInstanceDataBuffers[bufferIndex],
+            sizeof(UIInstance) * instanceCount);
     }
-    GvkHelper::signal_command_end(device, graphicsQueue, commandPool, &cmd);
 }
 
 void RenderSystem::SubmitUIDrawCommands(uint32_t bufferIndex)
@@ -1461,53 +1571,43 @@ void RenderSystem::SubmitUIDrawCommands(uint32_t bufferIndex)
     begin_info.clearValueCount = 1;
     begin_info.pClearValues = clearValues;
     vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
-    VkDeviceSize vertexBufferOffset = 0;
-    vkCmdBindVertexBuffers(cmd, 0, 1, &uiSDFVertexDataBuffers[bufferIndex], &vertexBufferOffset);
-    vkCmdBindIndexBuffer(cmd, uiSDFIndexDataBuffers[bufferIndex], 0, VK_INDEX_TYPE_UINT32);
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, uiSDFPipeline);
-    vkCmdSetViewport(cmd, 0, 1, &viewport);
-    uint32_t currentlyBoundFontID = ~(0u);
-    for(uint32_t i = 0; i < fontBatches.size(); ++i)
-    {
-        const auto& fontBatch = fontBatches[i];
-        if(!fontBatch.indexCount) continue;
-        VkRect2D scissor = {
-            (int32_t)((fontBatch.rect.x + 1) * 0.5F * swapchainExtent.width),
-            (int32_t)(((1 - fontBatch.rect.y) * 0.5F * swapchainExtent.height) - fontBatch.rect.height),
-            (uint32_t)fontBatch.rect.width,
-            (uint32_t)fontBatch.rect.height
-        };
-        vkCmdSetScissor(cmd, 0, 1, &scissor);
-        if(currentlyBoundFontID != fontBatch.fontID)
-        {
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, uiSDFPipelineLayout,
-                0, 1, &uiSDFDescriptorSets[fontBatch.fontID],
-                0, nullptr);
-            currentlyBoundFontID = fontBatch.fontID;
-        }
-        vkCmdPushConstants(cmd, uiSDFPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
-            sizeof(GVECTORF) * 0, sizeof(GVECTORF), &fontBatch.fontColor);
-        vkCmdPushConstants(cmd, uiSDFPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
-            sizeof(GVECTORF) * 1, sizeof(GVECTORF), &fontBatch.outlineColor);
-        vkCmdPushConstants(cmd, uiSDFPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
-            sizeof(GVECTORF) * 2, sizeof(float), &fontBatch.outlineWidth);
-        vkCmdDrawIndexed(cmd, fontBatch.indexCount, 1, fontBatch.indexOffset, 0, 0);
-    }
-    vkCmdBindVertexBuffers(cmd, 0, 1, &uiBlitInstanceDataBuffers[bufferIndex], &vertexBufferOffset);
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, uiBlitPipeline);
     vkCmdSetViewport(cmd, 0, 1, &viewport);
     VkRect2D scissor = {
         0, 0,
         (uint32_t)swapchainExtent.width, (uint32_t)swapchainExtent.height
     };
     vkCmdSetScissor(cmd, 0, 1, &scissor);
-    for(uint32_t i = 0; i < spriteBatches.size(); ++i)
+    /*-----------------------------------------------------------------------*/
+    /* One instanced Draw per run of Pipeline and Atlas. Text clips to its   */
+    /* Rect in the Pixel Shader, so Labels don't need a Scissor each         */
+    /*-----------------------------------------------------------------------*/
+    uint32_t currentlyBoundPipeline = ~(0u);
+    uint32_t currentlyBoundAtlasID = ~(0u);
+    for(uint32_t i = 0; i < uiDrawBatches.size(); ++i)
     {
-        const auto& spriteBatch = spriteBatches[i];
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, uiBlitPipelineLayout,
-            0, 1, &uiBlitDescriptorSets[spriteBatch.spriteAtlasID],
-            0, nullptr);
-        vkCmdDraw(cmd, 6, spriteBatch.instanceCount, 0, spriteBatch.instanceOffset);
+        const auto& drawBatch = uiDrawBatches[i];
+        bool sdf = drawBatch.pipeline == UI_PIPELINE_SDF;
+        VkPipelineLayout layout = sdf ? uiSDFPipelineLayout : uiBlitPipelineLayout;
+        if(currentlyBoundPipeline != drawBatch.pipeline)
+        {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, sdf ? uiSDFPipeline : uiBlitPipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                1, 1, &uiInstanceDescriptorSets[bufferIndex],
+                0, nullptr);
+            currentlyBoundPipeline = drawBatch.pipeline;
+            currentlyBoundAtlasID = ~(0u);
+        }
+        if(currentlyBoundAtlasID != drawBatch.atlasID)
+        {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                0, 1, sdf ? &uiSDFDescriptorSets[drawBatch.atlasID] : &uiBlitDescriptorSets[drawBatch.atlasID],
+                0, nullptr);
+            currentlyBoundAtlasID = drawBatch.atlasID;
+        }
+        UIPushConstants uiConstants = { drawBatch.instanceOffset };
+        vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT,
+            0, sizeof(UIPushConstants), &uiConstants);
+        vkCmdDraw(cmd, 6, drawBatch.instanceCount, 0, 0);
     }
     vkCmdEndRenderPass(cmd);
     GvkHelper::signal_command_end(device, graphicsQueue, commandPool, &cmd);
@@ -1530,9 +1630,59 @@ void RenderSystem::SubmitPresentCommandsAndWait(uint32_t bufferIndex)
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, presentPipelineLayout,
         0, 1, &perFrameDescriptorSets[bufferIndex],
         0, nullptr);
+    PresentPushConstants presentConstants;
+    presentConstants.sceneUVScale.x = (float)sceneViewportExtent.width / sceneTargetExtent.width;
+    presentConstants.sceneUVScale.y = (float)sceneViewportExtent.height / sceneTargetExtent.height;
+    presentConstants.sceneTexelSize.x = 1.f / sceneTargetExtent.width;
+    presentConstants.sceneTexelSize.y = 1.f / sceneTargetExtent.height;
+    presentConstants.sharpenStrength = sceneViewportExtent.width < swapchainExtent.width ? sharpenStrength : 0;
+    vkCmdPushConstants(commandBuffer, presentPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
+        0, sizeof(PresentPushConstants), &presentConstants);
     vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 }
 
+void RenderSystem::UpdateRenderScale(uint32_t bufferIndex)
+{
+    /*=======================================================================*/
+    /* Read back the GPU time of the Shadow, Static Mesh and Bloom passes    */
+    /* from the last frame that used this Buffer Index                       */
+    /*=======================================================================*/
+    if(timestampsSupported && frameTimestampsWritten[bufferIndex])
+    {
+        uint64_t timestamps[FRAME_TIMESTAMP_COUNT];
+        if(vkGetQueryPoolResults(device, frameTimestampQueryPool, bufferIndex * FRAME_TIMESTAMP_COUNT, FRAME_TIMESTAMP_COUNT,
+            sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+        {
+            uint64_t gpuTicks = 0;
+            for(uint32_t i = 0; i < FRAME_TIMESTAMP_COUNT; i += 2)
+                gpuTicks += timestamps[i + 1] - timestamps[i];
+            float gpuFrameTime = gpuTicks * timestampPeriod * 1e-6f;
+            smoothedGPUFrameTime += (gpuFrameTime - smoothedGPUFrameTime) * 0.1f;
+            /*---------------------------------------------------------------*/
+            /* Only react outside of a dead band to keep the scale from      */
+            /* oscillating. Cost follows pixel count, hence the square root. */
+            /*---------------------------------------------------------------*/
+            if(smoothedGPUFrameTime > targetGPUFrameTime || smoothedGPUFrameTime < targetGPUFrameTime * 0.8f)
+            {
+                float desiredScale = renderScale * sqrtf(targetGPUFrameTime / (smoothedGPUFrameTime + 0.001f));
+                renderScale += (desiredScale - renderScale) * 0.25f;
+                if(renderScale < minRenderScale) renderScale = minRenderScale;
+                if(renderScale > maxRenderScale) renderScale = maxRenderScale;
+            }
+        }
+    }
+    /*=======================================================================*/
+    /* Scene Viewport inside the over-allocated Scene Targets                */
+    /*=======================================================================*/
+    sceneViewportExtent.width = (uint32_t)(swapchainExtent.width * renderScale + 0.5f);
+    sceneViewportExtent.height = (uint32_t)(swapchainExtent.height * renderScale + 0.5f);
+    if(sceneViewportExtent.width < 1) sceneViewportExtent.width = 1;
+    if(sceneViewportExtent.height < 1) sceneViewportExtent.height = 1;
+    if(sceneViewportExtent.width > sceneTargetExtent.width) sceneViewportExtent.width = sceneTargetExtent.width;
+    if(sceneViewportExtent.height > sceneTargetExtent.height) sceneViewportExtent.height = sceneTargetExtent.height;
+    shadowMapViewportSize = renderScale < 1 ? (uint32_t)(1024 * renderScale) : 1024;
+}
+
 void RenderSystem::CreateShaderModules(VkDevice _device, std::shared_ptr<const GameConfig> _readCfg)
 {
     /*=======================================================================*/
@@ -1551,7 +1701,7 @@ void RenderSystem::CreateShaderModules(VkDevice _device, std::shared_ptr<const G
     /* Static Mesh Shaders                                                   */
     /*-----------------------------------------------------------------------*/
     vertexShaderSource = (*_readCfg).at("RenderSystem").at("StaticMeshVS").as<std::string>();
-    pixelShaderSource = (*_readCfg).at("RenderSystem").at("StaticMeshPS").as<std::string>();
+    pixelShaderSource = (*_readCfg).at("RenderSystem").at(bindlessMaterialsSupported ? "StaticMeshBindlessPS" : "StaticMeshPS").as<std::string>();
     ShaderFileData staticMeshShaders;
     LoadShaderFileData(vertexShaderSource.c_str(), pixelShaderSource.c_str(), fileInterface,
                         staticMeshShaders);
@@ -1567,7 +1717,7 @@ void RenderSystem::CreateShaderModules(VkDevice _device, std::shared_ptr<const G
     /* Skybox Shaders                                                        */
     /*-----------------------------------------------------------------------*/
     vertexShaderSource = (*_readCfg).at("RenderSystem").at("SkyboxVS").as<std::string>();
-    pixelShaderSource = (*_readCfg).at("RenderSystem").at("SkyboxPS").as<std::string>();
+    pixelShaderSource = (*_readCfg).at("RenderSystem").at(bindlessMaterialsSupported ? "SkyboxBindlessPS" : "SkyboxPS").as<std::string>();
     ShaderFileData skyboxShaders;
     LoadShaderFileData(vertexShaderSource.c_str(), pixelShaderSource.c_str(), fileInterface,
                         skyboxShaders);
@@ -1617,99 +1767,99 @@ void RenderSystem::CreateShaderModules(VkDevice _device, std::shared_ptr<const G
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = shadowMapShaders.vertexShaderFileSize;
     create_info.pCode = shadowMapShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &shadowMapVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &shadowMapVertexShader);
     /*-----------------------------------------------------------------------*/
     /* Shadow Map - Pixel Shader                                             */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = shadowMapShaders.pixelShaderFileSize;
     create_info.pCode = shadowMapShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &shadowMapPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &shadowMapPixelShader);
     /*-----------------------------------------------------------------------*/
     /* Static Mesh - Vertex Shader                                           */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = staticMeshShaders.vertexShaderFileSize;
     create_info.pCode = staticMeshShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &staticMeshVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshVertexShader);
     /*-----------------------------------------------------------------------*/
     /* Static Mesh - Pixel Shader                                            */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = staticMeshShaders.pixelShaderFileSize;
     create_info.pCode = staticMeshShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &staticMeshPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshPixelShader);
     /*-----------------------------------------------------------------------*/
     /* Blur - Vertex Shader                                                  */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = blurShaders.vertexShaderFileSize;
     create_info.pCode = blurShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &blurVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &blurVertexShader);
     /*-----------------------------------------------------------------------*/
     /* Blur - Pixel Shader                                                   */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = blurShaders.pixelShaderFileSize;
     create_info.pCode = blurShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &blurPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &blurPixelShader);
     /*-----------------------------------------------------------------------*/
     /* Skybox - Vertex Shader                                           */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = skyboxShaders.vertexShaderFileSize;
     create_info.pCode = skyboxShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &skyBoxVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &skyBoxVertexShader);
     /*-----------------------------------------------------------------------*/
     /* Skybox - Pixel Shader                                            */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = skyboxShaders.pixelShaderFileSize;
     create_info.pCode = skyboxShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &skyBoxPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &skyBoxPixelShader);
 #ifdef DEV_BUILD
     /*-----------------------------------------------------------------------*/
     /* Debug Collider - Vertex Shader                                        */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = debugColliderShaders.vertexShaderFileSize;
     create_info.pCode = debugColliderShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &debugColliderVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &debugColliderVertexShader);
     /*-----------------------------------------------------------------------*/
     /* Debug Collider - Pixel Shader                                         */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = debugColliderShaders.pixelShaderFileSize;
     create_info.pCode = debugColliderShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &debugColliderPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &debugColliderPixelShader);
 #endif
     /*-----------------------------------------------------------------------*/
     /* UI SDF - Vertex Shader                                                */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = uiSDFShaders.vertexShaderFileSize;
     create_info.pCode = uiSDFShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &uiSDFVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiSDFVertexShader);
     /*-----------------------------------------------------------------------*/
     /* UI SDF - Pixel Shader                                                 */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = uiSDFShaders.pixelShaderFileSize;
     create_info.pCode = uiSDFShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &uiSDFPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiSDFPixelShader);
     /*-----------------------------------------------------------------------*/
     /* UI Blit - Vertex Shader                                               */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = uiBlitShaders.vertexShaderFileSize;
     create_info.pCode = uiBlitShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &uiBlitVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiBlitVertexShader);
     /*-----------------------------------------------------------------------*/
     /* UI Blit - Pixel Shader                                                */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = uiBlitShaders.pixelShaderFileSize;
     create_info.pCode = uiBlitShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &uiBlitPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiBlitPixelShader);
     /*-----------------------------------------------------------------------*/
     /* Present - Vertex Shader                                               */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = presentShaders.vertexShaderFileSize;
     create_info.pCode = presentShaders.vertexShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &presentVertexShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &presentVertexShader);
     /*-----------------------------------------------------------------------*/
     /* Present - Pixel Shader                                                */
     /*-----------------------------------------------------------------------*/
     create_info.codeSize = presentShaders.pixelShaderFileSize;
     create_info.pCode = presentShaders.pixelShaderFileData;
-    vkCreateShaderModule(_device, &create_info, NULL, &presentPixelShader);
+    vkCreateShaderModule(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &presentPixelShader);
     /*-----------------------------------------------------------------------*/
     FreeShaderFileData(shadowMapShaders);
     FreeShaderFileData(staticMeshShaders);
@@ -1722,24 +1872,24 @@ void RenderSystem::CreateShaderModules(VkDevice _device, std::shared_ptr<const G
 
 void RenderSystem::DestroyShaderModules(VkDevice _device)
 {
-    vkDestroyShaderModule(_device, skyBoxVertexShader, NULL);
-    vkDestroyShaderModule(_device, skyBoxPixelShader, NULL);
-    vkDestroyShaderModule(_device, shadowMapVertexShader, NULL);
-    vkDestroyShaderModule(_device, shadowMapPixelShader, NULL);
-    vkDestroyShaderModule(_device, staticMeshVertexShader, NULL);
-    vkDestroyShaderModule(_device, staticMeshPixelShader, NULL);
-    vkDestroyShaderModule(_device, blurVertexShader, NULL);
-    vkDestroyShaderModule(_device, blurPixelShader, NULL);
+    vkDestroyShaderModule(_device, skyBoxVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, skyBoxPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, shadowMapVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, shadowMapPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, staticMeshVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, staticMeshPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, blurVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, blurPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 #ifdef DEV_BUILD
-    vkDestroyShaderModule(_device, debugColliderVertexShader, NULL);
-    vkDestroyShaderModule(_device, debugColliderPixelShader, NULL);
+    vkDestroyShaderModule(_device, debugColliderVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, debugColliderPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 #endif
-    vkDestroyShaderModule(_device, uiSDFVertexShader, NULL);
-    vkDestroyShaderModule(_device, uiSDFPixelShader, NULL);
-    vkDestroyShaderModule(_device, uiBlitVertexShader, NULL);
-    vkDestroyShaderModule(_device, uiBlitPixelShader, NULL);
-    vkDestroyShaderModule(_device, presentVertexShader, NULL);
-    vkDestroyShaderModule(_device, presentPixelShader, NULL);
+    vkDestroyShaderModule(_device, uiSDFVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, uiSDFPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, uiBlitVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, uiBlitPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, presentVertexShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyShaderModule(_device, presentPixelShader, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 }
 
 void RenderSystem::CreateShadowMapRenderPass(VkDevice _device)
@@ -1774,7 +1924,7 @@ void RenderSystem::CreateShadowMapRenderPass(VkDevice _device)
     create_info.pAttachments    = renderPassAttachments;
     create_info.subpassCount    = 1;
     create_info.pSubpasses      = renderPassSubpasses;
-    vkCreateRenderPass(_device, &create_info, NULL, &shadowMapRenderPass);
+    vkCreateRenderPass(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &shadowMapRenderPass);
 }
 
 void RenderSystem::CreateStaticMeshRenderPass(VkDevice _device)
@@ -1840,7 +1990,7 @@ void RenderSystem::CreateStaticMeshRenderPass(VkDevice _device)
     create_info.pAttachments = renderPassAttachments;
     create_info.subpassCount = 1;
     create_info.pSubpasses = renderPassSubpasses;
-    vkCreateRenderPass(_device, &create_info, NULL, &staticMeshRenderPass);
+    vkCreateRenderPass(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshRenderPass);
 }
 
 void RenderSystem::CreateBlurRenderPass(VkDevice _device)
@@ -1877,7 +2027,7 @@ void RenderSystem::CreateBlurRenderPass(VkDevice _device)
     create_info.pAttachments = renderPassAttachments;
     create_info.subpassCount = 1;
     create_info.pSubpasses = renderPassSubpasses;
-    vkCreateRenderPass(_device, &create_info, NULL, &blurRenderPass);
+    vkCreateRenderPass(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &blurRenderPass);
 }
 
 void RenderSystem::CreateUIRenderPass(VkDevice _device)
@@ -1919,15 +2069,15 @@ void RenderSystem::CreateUIRenderPass(VkDevice _device)
     create_info.pAttachments = renderPassAttachments;
     create_info.subpassCount = 1;
     create_info.pSubpasses = renderPassSubpasses;
-    vkCreateRenderPass(_device, &create_info, NULL, &uiRenderPass);
+    vkCreateRenderPass(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiRenderPass);
 }
 
 void RenderSystem::DestroyRenderPasses(VkDevice _device)
 {
-    vkDestroyRenderPass(_device, shadowMapRenderPass, NULL);
-    vkDestroyRenderPass(_device, staticMeshRenderPass, NULL);
-    vkDestroyRenderPass(_device, blurRenderPass, NULL);
-    vkDestroyRenderPass(_device, uiRenderPass, NULL);
+    vkDestroyRenderPass(_device, shadowMapRenderPass, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyRenderPass(_device, staticMeshRenderPass, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyRenderPass(_device, blurRenderPass, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyRenderPass(_device, uiRenderPass, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 }
 
 void RenderSystem::CreateImmutableSamplers(VkDevice _device)
@@ -1942,18 +2092,18 @@ void RenderSystem::CreateImmutableSamplers(VkDevice _device)
     create_info.magFilter = VK_FILTER_LINEAR;
     create_info.maxLod = VK_LOD_CLAMP_NONE;
     create_info.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
-    vkCreateSampler(_device, &create_info, NULL, &staticMeshTextureSampler);
-    vkCreateSampler(_device, &create_info, NULL, &presentSampler);
+    vkCreateSampler(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshTextureSampler);
+    vkCreateSampler(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &presentSampler);
     create_info.minFilter = VK_FILTER_NEAREST;
     create_info.magFilter = VK_FILTER_NEAREST;
-    vkCreateSampler(_device, &create_info, NULL, &uiBlitSampler);
+    vkCreateSampler(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiBlitSampler);
 }
 
 void RenderSystem::DestroyImmutableSamplers(VkDevice _device)
 {
-    vkDestroySampler(_device, staticMeshTextureSampler, NULL);
-    vkDestroySampler(_device, presentSampler, NULL);
-    vkDestroySampler(_device, uiBlitSampler, NULL);
+    vkDestroySampler(_device, staticMeshTextureSampler, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroySampler(_device, presentSampler, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroySampler(_device, uiBlitSampler, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 }
 
 void RenderSystem::CreateDescriptorSetLayouts(VkDevice _device)
@@ -1984,11 +2134,11 @@ void RenderSystem::CreateDescriptorSetLayouts(VkDevice _device)
     create_info.bindingCount = 2;
     create_info.pBindings = &bindings[2];
     bindings[3].pImmutableSamplers = &staticMeshTextureSampler;
-    vkCreateDescriptorSetLayout(_device, &create_info, NULL, &staticMeshDescriptorSetLayout);
+    vkCreateDescriptorSetLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshDescriptorSetLayout);
     /*-----------------------------------------------------------------------*/
-    vkCreateDescriptorSetLayout(_device, &create_info, NULL, &uiSDFDescriptorSetLayout);
+    vkCreateDescriptorSetLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiSDFDescriptorSetLayout);
     bindings[3].pImmutableSamplers = &uiBlitSampler;
-    vkCreateDescriptorSetLayout(_device, &create_info, NULL, &uiBlitDescriptorSetLayout);
+    vkCreateDescriptorSetLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiBlitDescriptorSetLayout);
     /*-----------------------------------------------------------------------*/
     bindings[1].binding = 1;
     bindings[2].binding = 2;
@@ -1996,20 +2146,46 @@ void RenderSystem::CreateDescriptorSetLayouts(VkDevice _device)
     create_info.bindingCount = 4;
     create_info.pBindings = bindings;
     bindings[3].pImmutableSamplers = &presentSampler;
-    vkCreateDescriptorSetLayout(_device, &create_info, NULL, &presentDescriptorSetLayout);
+    vkCreateDescriptorSetLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &presentDescriptorSetLayout);
+    /*-----------------------------------------------------------------------*/
+    if(bindlessMaterialsSupported)
+    {
+        bindings[0].descriptorCount = MAX_MESH_COUNT;
+        bindings[1].binding = 1;
+        bindings[1].descriptorCount = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+        bindings[1].pImmutableSamplers = &staticMeshTextureSampler;
+        bindings[2].binding = 2;
+        bindings[2].descriptorCount = MAX_SKYBOX_COUNT;
+        create_info.bindingCount = 3;
+        vkCreateDescriptorSetLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &bindlessDescriptorSetLayout);
+    }
+    /*-----------------------------------------------------------------------*/
+    VkDescriptorSetLayoutBinding instanceBinding;
+    ZeroMemory(&instanceBinding, sizeof(VkDescriptorSetLayoutBinding));
+    instanceBinding.binding = 0;
+    instanceBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    instanceBinding.descriptorCount= 1;
+    instanceBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    create_info.bindingCount = 1;
+    create_info.pBindings = &instanceBinding;
+    vkCreateDescriptorSetLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiInstanceDescriptorSetLayout);
 }
 
 void RenderSystem::DestroyDescriptorSetLayouts(VkDevice _device)
 {
-    vkDestroyDescriptorSetLayout(_device, staticMeshDescriptorSetLayout, NULL);
-    vkDestroyDescriptorSetLayout(_device, uiSDFDescriptorSetLayout, NULL);
-    vkDestroyDescriptorSetLayout(_device, uiBlitDescriptorSetLayout, NULL);
-    vkDestroyDescriptorSetLayout(_device, presentDescriptorSetLayout, NULL);
+    vkDestroyDescriptorSetLayout(_device, staticMeshDescriptorSetLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyDescriptorSetLayout(_device, uiSDFDescriptorSetLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyDescriptorSetLayout(_device, uiBlitDescriptorSetLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyDescriptorSetLayout(_device, presentDescriptorSetLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyDescriptorSetLayout(_device, uiInstanceDescriptorSetLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    if(bindlessMaterialsSupported)
+        vkDestroyDescriptorSetLayout(_device, bindlessDescriptorSetLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 }
 
 void RenderSystem::CreatePipelineLayouts(VkDevice _device)
 {
-    VkPushConstantRange pushConstantRanges[1];
+    VkPushConstantRange pushConstantRanges[2];
     VkDescriptorSetLayout descriptorSetLayouts[2];
     VkPipelineLayoutCreateInfo create_info;
     ZeroMemory(&create_info, sizeof(VkPipelineLayoutCreateInfo));
@@ -2021,44 +2197,69 @@ void RenderSystem::CreatePipelineLayouts(VkDevice _device)
     pushConstantRanges[0].offset=0;
     pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     create_info.pushConstantRangeCount=1;
-    vkCreatePipelineLayout(_device, &create_info, NULL, &shadowMapPipelineLayout);
+    vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &shadowMapPipelineLayout);
     /*-----------------------------------------------------------------------*/
-    create_info.setLayoutCount= 1;
-    descriptorSetLayouts[0]=staticMeshDescriptorSetLayout;
-    vkCreatePipelineLayout(_device, &create_info, NULL, &skyBoxPipelineLayout);
-    /*-----------------------------------------------------------------------*/
-    pushConstantRanges[0].size = sizeof(GMATRIXF) * 2;
-    create_info.setLayoutCount= 2;
-    descriptorSetLayouts[1]=uiBlitDescriptorSetLayout;
-    vkCreatePipelineLayout(_device, &create_info, NULL, &staticMeshPipelineLayout);
+    if(bindlessMaterialsSupported)
+    {
+        // Identically defined Layouts are compatible, so the Bindless Set
+        // bound for the Static Meshes stays valid for the Skybox draw
+        pushConstantRanges[0].size = sizeof(GMATRIXF) * 2;
+        pushConstantRanges[1].offset = sizeof(GMATRIXF) * 2;
+        pushConstantRanges[1].size = sizeof(uint32_t);
+        pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        create_info.pushConstantRangeCount=2;
+        create_info.setLayoutCount= 2;
+        descriptorSetLayouts[0]=bindlessDescriptorSetLayout;
+        descriptorSetLayouts[1]=uiBlitDescriptorSetLayout;
+        vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &skyBoxPipelineLayout);
+        vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshPipelineLayout);
+        create_info.pushConstantRangeCount=1;
+    }
+    else
+    {
+        create_info.setLayoutCount= 1;
+        descriptorSetLayouts[0]=staticMeshDescriptorSetLayout;
+        vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &skyBoxPipelineLayout);
+        pushConstantRanges[0].size = sizeof(GMATRIXF) * 2;
+        create_info.setLayoutCount= 2;
+        descriptorSetLayouts[1]=uiBlitDescriptorSetLayout;
+        vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshPipelineLayout);
+    }
     /*-----------------------------------------------------------------------*/
-    pushConstantRanges[0].size = sizeof(uint32_t);
+    pushConstantRanges[0].size = sizeof(BlurPushConstants);
     pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     create_info.setLayoutCount= 1;
     descriptorSetLayouts[0]=uiBlitDescriptorSetLayout;
-    vkCreatePipelineLayout(_device, &create_info, NULL, &blurPipelineLayout);
+    vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &blurPipelineLayout);
+    /*-----------------------------------------------------------------------*/
+    /* Both UI Pipelines read their Instances from Set 1                     */
     /*-----------------------------------------------------------------------*/
-    pushConstantRanges[0].size = sizeof(GVECTORF) * 3;
+    pushConstantRanges[0].size = sizeof(UIPushConstants);
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    create_info.setLayoutCount= 2;
     descriptorSetLayouts[0]=uiSDFDescriptorSetLayout;
-    vkCreatePipelineLayout(_device, &create_info, NULL, &uiSDFPipelineLayout);
+    descriptorSetLayouts[1]=uiInstanceDescriptorSetLayout;
+    vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiSDFPipelineLayout);
     /*-----------------------------------------------------------------------*/
-    create_info.pushConstantRangeCount=0;
     descriptorSetLayouts[0]=uiBlitDescriptorSetLayout;
-    vkCreatePipelineLayout(_device, &create_info, NULL, &uiBlitPipelineLayout);
+    vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiBlitPipelineLayout);
     /*-----------------------------------------------------------------------*/
+    pushConstantRanges[0].size = sizeof(PresentPushConstants);
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    create_info.setLayoutCount= 1;
     descriptorSetLayouts[0]=presentDescriptorSetLayout;
-    vkCreatePipelineLayout(_device, &create_info, NULL, &presentPipelineLayout);
+    vkCreatePipelineLayout(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &presentPipelineLayout);
 }
 
 void RenderSystem::DestroyPipelineLayouts(VkDevice _device)
 {
-    vkDestroyPipelineLayout(_device, skyBoxPipelineLayout, NULL);
-    vkDestroyPipelineLayout(_device, staticMeshPipelineLayout, NULL);
-    vkDestroyPipelineLayout(_device, blurPipelineLayout, NULL);
-    vkDestroyPipelineLayout(_device, shadowMapPipelineLayout, NULL);
-    vkDestroyPipelineLayout(_device, uiSDFPipelineLayout, NULL);
-    vkDestroyPipelineLayout(_device, uiBlitPipelineLayout, NULL);
-    vkDestroyPipelineLayout(_device, presentPipelineLayout, NULL);
+    vkDestroyPipelineLayout(_device, skyBoxPipelineLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipelineLayout(_device, staticMeshPipelineLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipelineLayout(_device, blurPipelineLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipelineLayout(_device, shadowMapPipelineLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipelineLayout(_device, uiSDFPipelineLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipelineLayout(_device, uiBlitPipelineLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipelineLayout(_device, presentPipelineLayout, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 }
 
 void RenderSystem::CreateShadowMapPipeline(VkDevice _device)
@@ -2222,7 +2423,7 @@ void RenderSystem::CreateShadowMapPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = shadowMapPipelineLayout;
     create_info.renderPass = shadowMapRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &shadowMapPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &shadowMapPipeline);
 }
 
 void RenderSystem::CreateStaticMeshPipeline(VkDevice _device)
@@ -2282,8 +2483,8 @@ void RenderSystem::CreateStaticMeshPipeline(VkDevice _device)
     /*-----------------------------------------------------------------------*/
     /* Vertex Attributes                                                     */
     /*-----------------------------------------------------------------------*/
-    VkVertexInputAttributeDescription vertex_attribute_descriptions[9];
-    ZeroMemory(vertex_attribute_descriptions, sizeof(VkVertexInputAttributeDescription) * 9);
+    VkVertexInputAttributeDescription vertex_attribute_descriptions[10];
+    ZeroMemory(vertex_attribute_descriptions, sizeof(VkVertexInputAttributeDescription) * 10);
     /*-----------------------------------------------------------------------*/
     /* Vertex - Position                                                     */
     /*-----------------------------------------------------------------------*/
@@ -2335,7 +2536,12 @@ void RenderSystem::CreateStaticMeshPipeline(VkDevice _device)
     vertex_attribute_descriptions[8].offset= sizeof(GVECTORF) * 5;
     vertex_attribute_descriptions[8].format = VK_FORMAT_R32_UINT;
     /*-----------------------------------------------------------------------*/
-    input_vertex_info.vertexAttributeDescriptionCount = 9;
+    vertex_attribute_descriptions[9].binding= 1;
+    vertex_attribute_descriptions[9].location= 9;
+    vertex_attribute_descriptions[9].offset= sizeof(GVECTORF) * 5 + sizeof(uint32_t);
+    vertex_attribute_descriptions[9].format = VK_FORMAT_R32_UINT;
+    /*-----------------------------------------------------------------------*/
+    input_vertex_info.vertexAttributeDescriptionCount = 10;
     input_vertex_info.pVertexAttributeDescriptions = vertex_attribute_descriptions;
     /*=======================================================================*/
     /* Viewport State                                                        */
@@ -2427,7 +2633,7 @@ void RenderSystem::CreateStaticMeshPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = staticMeshPipelineLayout;
     create_info.renderPass = staticMeshRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &staticMeshPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &staticMeshPipeline);
 }
 
 void RenderSystem::CreateBlurPipeline(VkDevice _device)
@@ -2541,7 +2747,7 @@ void RenderSystem::CreateBlurPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = blurPipelineLayout;
     create_info.renderPass = blurRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &blurPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &blurPipeline);
 }
 
 void RenderSystem::CreateSkyboxPipeline(VkDevice _device)
@@ -2668,7 +2874,7 @@ void RenderSystem::CreateSkyboxPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = skyBoxPipelineLayout;
     create_info.renderPass = staticMeshRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &skyBoxPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &skyBoxPipeline);
 }
 #ifdef DEV_BUILD
 void RenderSystem::CreateDebugColliderPipeline(VkDevice _device)
@@ -2849,7 +3055,7 @@ void RenderSystem::CreateDebugColliderPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = shadowMapPipelineLayout;
     create_info.renderPass = staticMeshRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &debugColliderPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &debugColliderPipeline);
 }
 #endif
 void RenderSystem::CreateUISDFPipeline(VkDevice _device)
@@ -2886,42 +3092,6 @@ void RenderSystem::CreateUISDFPipeline(VkDevice _device)
     /*=======================================================================*/
     VkPipelineVertexInputStateCreateInfo input_vertex_info = {};
     input_vertex_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    /*-----------------------------------------------------------------------*/
-    /* Vertex Bindings                                                       */
-    /*-----------------------------------------------------------------------*/
-    VkVertexInputBindingDescription vertex_binding_descriptions[1];
-    ZeroMemory(vertex_binding_descriptions, sizeof(VkVertexInputBindingDescription));
-    /*-----------------------------------------------------------------------*/
-    /* Per Vertex Data                                                       */
-    /*-----------------------------------------------------------------------*/
-    vertex_binding_descriptions[0].binding = 0;
-    vertex_binding_descriptions[0].stride = sizeof(FontVertex);
-    vertex_binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    /*-----------------------------------------------------------------------*/
-    input_vertex_info.vertexBindingDescriptionCount = 1;
-    input_vertex_info.pVertexBindingDescriptions = vertex_binding_descriptions;
-    /*-----------------------------------------------------------------------*/
-    /* Vertex Attributes                                                     */
-    /*-----------------------------------------------------------------------*/
-    VkVertexInputAttributeDescription vertex_attribute_descriptions[2];
-    ZeroMemory(vertex_attribute_descriptions, sizeof(VkVertexInputAttributeDescription) * 2);
-    /*-----------------------------------------------------------------------*/
-    /* Vertex - Position                                                     */
-    /*-----------------------------------------------------------------------*/
-    vertex_attribute_descriptions[0].binding=0;
-    vertex_attribute_descriptions[0].location= 0;
-    vertex_attribute_descriptions[0].offset= sizeof(GW::MATH2D::GVECTOR2F) * 0;
-    vertex_attribute_descriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-    /*-----------------------------------------------------------------------*/
-    /* Vertex - Texture Coordinates                                          */
-    /*-----------------------------------------------------------------------*/
-    vertex_attribute_descriptions[1].binding=0;
-    vertex_attribute_descriptions[1].location= 1;
-    vertex_attribute_descriptions[1].offset= sizeof(GW::MATH2D::GVECTOR2F) * 1;
-    vertex_attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-    /*-----------------------------------------------------------------------*/
-    input_vertex_info.vertexAttributeDescriptionCount = 2;
-    input_vertex_info.pVertexAttributeDescriptions = vertex_attribute_descriptions;
     /*=======================================================================*/
     /* Viewport State                                                        */
     /*=======================================================================*/
@@ -2999,7 +3169,7 @@ void RenderSystem::CreateUISDFPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = uiSDFPipelineLayout;
     create_info.renderPass = uiRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &uiSDFPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiSDFPipeline);
 }
 
 void RenderSystem::CreateUIBlitPipeline(VkDevice _device)
@@ -3036,42 +3206,6 @@ void RenderSystem::CreateUIBlitPipeline(VkDevice _device)
     /*=======================================================================*/
     VkPipelineVertexInputStateCreateInfo input_vertex_info = {};
     input_vertex_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    /*-----------------------------------------------------------------------*/
-    /* Vertex Bindings                                                       */
-    /*-----------------------------------------------------------------------*/
-    VkVertexInputBindingDescription vertex_binding_descriptions[1];
-    ZeroMemory(vertex_binding_descriptions, sizeof(VkVertexInputBindingDescription));
-    /*-----------------------------------------------------------------------*/
-    /* Per Vertex Data                                                       */
-    /*-----------------------------------------------------------------------*/
-    vertex_binding_descriptions[0].binding = 0;
-    vertex_binding_descriptions[0].stride = sizeof(SpriteInstance);
-    vertex_binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
-    /*-----------------------------------------------------------------------*/
-    input_vertex_info.vertexBindingDescriptionCount = 1;
-    input_vertex_info.pVertexBindingDescriptions = vertex_binding_descriptions;
-    /*-----------------------------------------------------------------------*/
-    /* Vertex Attributes                                                     */
-    /*-----------------------------------------------------------------------*/
-    VkVertexInputAttributeDescription vertex_attribute_descriptions[2];
-    ZeroMemory(vertex_attribute_descriptions, sizeof(VkVertexInputAttributeDescription) * 2);
-    /*-----------------------------------------------------------------------*/
-    /* Instance - Source Rect (src.x, src.y, src.width, src.height)          */
-    /*-----------------------------------------------------------------------*/
-    vertex_attribute_descriptions[0].binding=0;
-    vertex_attribute_descriptions[0].location= 0;
-    vertex_attribute_descriptions[0].offset= sizeof(GW::MATH::GVECTORF) * 0;
-    vertex_attribute_descriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    /*-----------------------------------------------------------------------*/
-    /* Instance - Destination Rect (dst.x, dst.y, dst.width, dst.height)     */
-    /*-----------------------------------------------------------------------*/
-    vertex_attribute_descriptions[1].binding=0;
-    vertex_attribute_descriptions[1].location= 1;
-    vertex_attribute_descriptions[1].offset= sizeof(GW::MATH::GVECTORF) * 1;
-    vertex_attribute_descriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    /*-----------------------------------------------------------------------*/
-    input_vertex_info.vertexAttributeDescriptionCount = 2;
-    input_vertex_info.pVertexAttributeDescriptions = vertex_attribute_descriptions;
     /*=======================================================================*/
     /* Viewport State                                                        */
     /*=======================================================================*/
@@ -3149,7 +3283,7 @@ void RenderSystem::CreateUIBlitPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = uiBlitPipelineLayout;
     create_info.renderPass = uiRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &uiBlitPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiBlitPipeline);
 }
 
 void RenderSystem::CreatePresentPipeline(VkDevice _device)
@@ -3265,58 +3399,68 @@ void RenderSystem::CreatePresentPipeline(VkDevice _device)
     create_info.pDynamicState = &dynamic_create_info;
     create_info.layout = presentPipelineLayout;
     create_info.renderPass = presentRenderPass;
-    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, NULL, &presentPipeline);
+    vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &presentPipeline);
 }
 
 void RenderSystem::DestroyPipelines(VkDevice _device)
 {
-    vkDestroyPipeline(_device, shadowMapPipeline, NULL);
-    vkDestroyPipeline(_device, staticMeshPipeline, NULL);
-    vkDestroyPipeline(_device, blurPipeline, NULL);
-    vkDestroyPipeline(_device, skyBoxPipeline, NULL);
+    vkDestroyPipeline(_device, shadowMapPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipeline(_device, staticMeshPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipeline(_device, blurPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipeline(_device, skyBoxPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 #ifdef DEV_BUILD
-    vkDestroyPipeline(_device, debugColliderPipeline, NULL);
+    vkDestroyPipeline(_device, debugColliderPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 #endif
-    vkDestroyPipeline(_device, uiSDFPipeline, NULL);
-    vkDestroyPipeline(_device, uiBlitPipeline, NULL);
-    vkDestroyPipeline(_device, presentPipeline, NULL);
+    vkDestroyPipeline(_device, uiSDFPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipeline(_device, uiBlitPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyPipeline(_device, presentPipeline, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
 }
 
-void RenderSystem::CreatePersistentResources(VkPhysicalDevice _physicalDevice, VkDevice _device)
+bool RenderSystem::CreatePersistentResources(VkPhysicalDevice _physicalDevice, VkDevice _device)
 {
-    GvkHelper::create_buffer(_physicalDevice, _device,
-       8 * 1024 * 1024,
+    if(!CreateBuffer(_device,
+        8 * 1024 * 1024,
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        MEMORY_CATEGORY_MESH_BUFFERS, false,
         &meshVertexDataBuffer,
-        &meshVertexDataMemory);
-    GvkHelper::create_buffer(_physicalDevice, _device,
+        &meshVertexDataMemory))
+        return false;
+    if(!CreateBuffer(_device,
         4 * 1024 * 1024,
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        MEMORY_CATEGORY_MESH_BUFFERS, false,
         &meshIndexDataBuffer,
-        &meshIndexDataMemory);
+        &meshIndexDataMemory))
+        return false;
 #ifdef DEV_BUILD
-    GvkHelper::create_buffer(_physicalDevice, _device,
+    if(!CreateBuffer(_device,
         1024 * 1024,
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        MEMORY_CATEGORY_MESH_BUFFERS, false,
         &debugColliderVertexDataBuffer,
-        &debugColliderVertexDataMemory);
-    GvkHelper::create_buffer(_physicalDevice, _device,
+        &debugColliderVertexDataMemory))
+        return false;
+    if(!CreateBuffer(_device,
         1024 * 1024,
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        MEMORY_CATEGORY_MESH_BUFFERS, false,
         &debugColliderIndexDataBuffer,
-        &debugColliderIndexDataMemory);
+        &debugColliderIndexDataMemory))
+        return false;
 #endif
-    GvkHelper::create_buffer(_physicalDevice, _device,
+    if(!CreateBuffer(_device,
         32 * 1024 * 1024,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        MEMORY_CATEGORY_STAGING, false,
         &stagingBuffer,
-        &stagingMemory);
-    vkMapMemory(_device, stagingMemory, 0, 32 * 1024 * 1024, 0, &stagingMappedMemory);
+        &stagingMemory))
+        return false;
+    stagingMappedMemory = MapMemoryAllocation(_device, stagingMemory);
     /*-----------------------------------------------------------------------*/
     VkDescriptorPoolSize pool_sizes[1];
     pool_sizes[0].descriptorCount = 1;
@@ -3327,63 +3471,105 @@ void RenderSystem::CreatePersistentResources(VkPhysicalDevice _physicalDevice, V
     create_info.poolSizeCount= 1;
     create_info.pPoolSizes = pool_sizes;
     create_info.maxSets= MAX_MESH_COUNT;
-    vkCreateDescriptorPool(_device, &create_info, NULL, &materialDescriptorPool);
-    create_info.maxSets= 4;
-    vkCreateDescriptorPool(_device, &create_info, NULL, &cubeMapDescriptorPool);
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &materialDescriptorPool);
+    create_info.maxSets= MAX_SKYBOX_COUNT;
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &cubeMapDescriptorPool);
     create_info.maxSets= 32;
-    vkCreateDescriptorPool(_device, &create_info, NULL, &uiSDFDescriptorPool);
-    vkCreateDescriptorPool(_device, &create_info, NULL, &uiBlitDescriptorPool);
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiSDFDescriptorPool);
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiBlitDescriptorPool);
+    /*-----------------------------------------------------------------------*/
+    if(bindlessMaterialsSupported)
+    {
+        VkDescriptorPoolSize bindless_pool_sizes[2];
+        bindless_pool_sizes[0].descriptorCount = MAX_MESH_COUNT + MAX_SKYBOX_COUNT;
+        bindless_pool_sizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        bindless_pool_sizes[1].descriptorCount = 1;
+        bindless_pool_sizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+        create_info.poolSizeCount= 2;
+        create_info.pPoolSizes = bindless_pool_sizes;
+        create_info.maxSets= 1;
+        vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &bindlessDescriptorPool);
+        VkDescriptorSetAllocateInfo alloc_info;
+        ZeroMemory(&alloc_info, sizeof(VkDescriptorSetAllocateInfo));
+        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc_info.descriptorSetCount= 1;
+        alloc_info.descriptorPool = bindlessDescriptorPool;
+        alloc_info.pSetLayouts = &bindlessDescriptorSetLayout;
+        vkAllocateDescriptorSets(_device, &alloc_info, &bindlessDescriptorSet);
+    }
+    return true;
 }
 
 void RenderSystem::DestroyPersistentResources(VkDevice _device)
 {
-    for(uint32_t i = 0; i < cubeMapDescriptorSets.size(); ++i)
+    for(uint32_t i = 0; i < cubeMapTextures.size(); ++i)
     {
-        vkDestroyImageView(_device, cubeMapTextureSRVs[i], NULL);
-        vkDestroyImage(_device, cubeMapTextures[i], NULL);
-        vkFreeMemory(_device, cubeMapTextureMemBlocks[i], NULL);
+        vkDestroyImageView(_device, cubeMapTextureSRVs[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        vkDestroyImage(_device, cubeMapTextures[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        FreeMemory(_device, cubeMapTextureMemBlocks[i]);
     }
-    vkDestroyDescriptorPool(_device, cubeMapDescriptorPool, NULL);
+    vkDestroyDescriptorPool(_device, cubeMapDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
     for(uint32_t i = 0; i < meshVector.size(); ++i)
     {
-        vkDestroyImageView(_device, materialTextureSRVs[i], NULL);
-        vkDestroyImage(_device, materialTextures[i], NULL);
-        vkFreeMemory(_device, materialTextureMemBlocks[i], NULL);
+        vkDestroyImageView(_device, materialTextureSRVs[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        vkDestroyImage(_device, materialTextures[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        FreeMemory(_device, materialTextureMemBlocks[i]);
     }
-    vkDestroyDescriptorPool(_device, materialDescriptorPool, NULL);
+    vkDestroyDescriptorPool(_device, materialDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
     for(uint32_t i = 0; i < fontLayouts.size(); ++i)
     {
-        vkDestroyImageView(_device, fontAtlasTextureSRVs[i], NULL);
-        vkDestroyImage(_device, fontAtlasTextures[i], NULL);
-        vkFreeMemory(_device, fontAtlasTextureMemBlocks[i], NULL);
+        vkDestroyImageView(_device, fontAtlasTextureSRVs[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        vkDestroyImage(_device, fontAtlasTextures[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        FreeMemory(_device, fontAtlasTextureMemBlocks[i]);
     }
-    vkDestroyDescriptorPool(_device, uiSDFDescriptorPool, NULL);
+    vkDestroyDescriptorPool(_device, uiSDFDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
     for(uint32_t i = 0; i < spriteAtlasTextures.size(); ++i)
     {
-        vkDestroyImageView(_device, spriteAtlasTextureSRVs[i], NULL);
-        vkDestroyImage(_device, spriteAtlasTextures[i], NULL);
-        vkFreeMemory(_device, spriteAtlasTextureMemBlocks[i], NULL);
+        vkDestroyImageView(_device, spriteAtlasTextureSRVs[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        vkDestroyImage(_device, spriteAtlasTextures[i], MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        FreeMemory(_device, spriteAtlasTextureMemBlocks[i]);
     }
-    vkDestroyDescriptorPool(_device, uiBlitDescriptorPool, NULL);
-    vkDestroyBuffer(_device, meshVertexDataBuffer, NULL);
-    vkDestroyBuffer(_device, meshIndexDataBuffer, NULL);
-    vkFreeMemory(_device, meshVertexDataMemory, NULL);
-    vkFreeMemory(_device, meshIndexDataMemory, NULL);
+    vkDestroyDescriptorPool(_device, uiBlitDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    if(bindlessMaterialsSupported)
+        vkDestroyDescriptorPool(_device, bindlessDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    vkDestroyBuffer(_device, meshVertexDataBuffer, MemoryTracker::Vulkan(MEMORY_TAG_GEOMETRY));
+    vkDestroyBuffer(_device, meshIndexDataBuffer, MemoryTracker::Vulkan(MEMORY_TAG_GEOMETRY));
+    FreeMemory(_device, meshVertexDataMemory);
+    FreeMemory(_device, meshIndexDataMemory);
 #ifdef DEV_BUILD
-    vkDestroyBuffer(_device, debugColliderVertexDataBuffer, NULL);
-    vkDestroyBuffer(_device, debugColliderIndexDataBuffer, NULL);
-    vkFreeMemory(_device, debugColliderVertexDataMemory, NULL);
-    vkFreeMemory(_device, debugColliderIndexDataMemory, NULL);
+    vkDestroyBuffer(_device, debugColliderVertexDataBuffer, MemoryTracker::Vulkan(MEMORY_TAG_GEOMETRY));
+    vkDestroyBuffer(_device, debugColliderIndexDataBuffer, MemoryTracker::Vulkan(MEMORY_TAG_GEOMETRY));
+    FreeMemory(_device, debugColliderVertexDataMemory);
+    FreeMemory(_device, debugColliderIndexDataMemory);
 #endif
-    std::vector<Mesh>().swap(meshVector);
+    TrackedVector<Mesh, MEMORY_TAG_GEOMETRY>().swap(meshVector);
 
-    vkUnmapMemory(_device, stagingMemory);
-    vkDestroyBuffer(_device, stagingBuffer, NULL);
-    vkFreeMemory(_device, stagingMemory, NULL);
+    vkDestroyBuffer(_device, stagingBuffer, MemoryTracker::Vulkan(MEMORY_TAG_STAGING));
+    FreeMemory(_device, stagingMemory);
+    stagingMappedMemory = NULL;
 }
 
-void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkDevice _device, uint32_t bufferCount)
+bool RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkDevice _device, uint32_t bufferCount)
 {
+    /*=======================================================================*/
+    /* Dynamic Resolution                                                    */
+    /*=======================================================================*/
+    /* Scene Targets are over-allocated to the Max Render Scale so the scale */
+    /* can change every frame without recreating them                        */
+    /*-----------------------------------------------------------------------*/
+    sceneTargetExtent.width = (uint32_t)(swapchainExtent.width * maxRenderScale + 0.5f);
+    sceneTargetExtent.height = (uint32_t)(swapchainExtent.height * maxRenderScale + 0.5f);
+    if(timestampsSupported)
+    {
+        VkQueryPoolCreateInfo query_create_info;
+        ZeroMemory(&query_create_info, sizeof(VkQueryPoolCreateInfo));
+        query_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        query_create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        query_create_info.queryCount = bufferCount * FRAME_TIMESTAMP_COUNT;
+        vkCreateQueryPool(_device, &query_create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &frameTimestampQueryPool);
+        frameTimestampsWritten.assign(bufferCount, false);
+    }
+    UpdateRenderScale(0);
     /*=======================================================================*/
     /* Descriptors                                                           */
     /*=======================================================================*/
@@ -3391,6 +3577,8 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
     /*-----------------------------------------------------------------------*/
     VkDescriptorImageInfo imageInfos[3];
     ZeroMemory(imageInfos, sizeof(VkDescriptorImageInfo) * 3);
+    VkDescriptorBufferInfo bufferInfo;
+    ZeroMemory(&bufferInfo, sizeof(VkDescriptorBufferInfo));
     VkWriteDescriptorSet descriptorWrites[3];
     ZeroMemory(descriptorWrites, sizeof(VkWriteDescriptorSet) * 3);
     VkDescriptorPoolSize pool_sizes[2];
@@ -3404,10 +3592,15 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
     create_info.poolSizeCount= 2;
     create_info.pPoolSizes = pool_sizes;
     create_info.maxSets= bufferCount;
-    vkCreateDescriptorPool(_device, &create_info, NULL, &perFrameDescriptorPool);
-    vkCreateDescriptorPool(_device, &create_info, NULL, &shadowMapDescriptorPool);
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &perFrameDescriptorPool);
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &shadowMapDescriptorPool);
     create_info.maxSets= bufferCount * 2;
-    vkCreateDescriptorPool(_device, &create_info, NULL, &blurDescriptorPool);
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &blurDescriptorPool);
+    pool_sizes[0].descriptorCount = bufferCount;
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    create_info.poolSizeCount= 1;
+    create_info.maxSets= bufferCount;
+    vkCreateDescriptorPool(_device, &create_info, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES), &uiInstanceDescriptorPool);
     /*-----------------------------------------------------------------------*/
     /* Descriptor Sets                                                       */
     /*-----------------------------------------------------------------------*/
@@ -3415,16 +3608,13 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
     blurPingDescriptorSets.resize(bufferCount);
     blurPongDescriptorSets.resize(bufferCount);
     perFrameDescriptorSets.resize(bufferCount);
+    uiInstanceDescriptorSets.resize(bufferCount);
     VkDescriptorSetAllocateInfo descriptor_alloc_info;
     ZeroMemory(&descriptor_alloc_info, sizeof(VkDescriptorSetAllocateInfo));
     descriptor_alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     /*=======================================================================*/
-    uiSDFVertexDataBuffers.resize(bufferCount);
-    uiSDFVertexDataMemoryBlocks.resize(bufferCount);
-    uiSDFIndexDataBuffers.resize(bufferCount);
-    uiSDFIndexDataMemoryBlocks.resize(bufferCount);
-    uiBlitInstanceDataBuffers.resize(bufferCount);
-    uiBlitInstanceDataMemoryBlocks.resize(bufferCount);
+    uiInstanceDataBuffers.resize(bufferCount);
+    uiInstanceDataMemoryBlocks.resize(bufferCount);
     instanceVertexDataBuffers.resize(bufferCount);
     instanceVertexDataMemoryBlocks.resize(bufferCount);
 
@@ -3464,46 +3654,56 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
     for(uint32_t i = 0;i < bufferCount; ++i)
     {
         /*-------------------------------------------------------------------*/
-        /* Per-Frame UI Vertex and Instance Buffers                          */
+        /* Per-Frame UI Instance Buffer                                      */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_buffer(_physicalDevice, _device,
-            1024 * 1024,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        if(!CreateBuffer(_device,
+            UI_INSTANCE_BUFFER_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            &uiSDFVertexDataBuffers[i],
-            &uiSDFVertexDataMemoryBlocks[i]);
-        GvkHelper::create_buffer(_physicalDevice, _device,
-            1024 * 1024,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            &uiSDFIndexDataBuffers[i],
-            &uiSDFIndexDataMemoryBlocks[i]);
-        GvkHelper::create_buffer(_physicalDevice, _device,
-            1024 * 1024,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            &uiBlitInstanceDataBuffers[i],
-            &uiBlitInstanceDataMemoryBlocks[i]);
+            MEMORY_CATEGORY_PER_FRAME_BUFFERS, true,
+            &uiInstanceDataBuffers[i],
+            &uiInstanceDataMemoryBlocks[i]))
+            return false;
+        /*-------------------------------------------------------------------*/
+        /* UI Instance Descriptor Set for this Buffer Index                  */
+        /*-------------------------------------------------------------------*/
+        descriptor_alloc_info.descriptorSetCount= 1;
+        descriptor_alloc_info.descriptorPool = uiInstanceDescriptorPool;
+        descriptor_alloc_info.pSetLayouts = &uiInstanceDescriptorSetLayout;
+        vkAllocateDescriptorSets(_device, &descriptor_alloc_info, &uiInstanceDescriptorSets[i]);
+        bufferInfo.buffer = uiInstanceDataBuffers[i];
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = uiInstanceDescriptorSets[i];
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[0].pBufferInfo = &bufferInfo;
+        vkUpdateDescriptorSets(_device, 1, descriptorWrites, 0, NULL);
         /*-------------------------------------------------------------------*/
         /* Per-Frame GameObject Instance Buffer                              */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_buffer(_physicalDevice, _device,
+        if(!CreateBuffer(_device,
             1024 * 1024,
             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            MEMORY_CATEGORY_PER_FRAME_BUFFERS, true,
             &instanceVertexDataBuffers[i],
-            &instanceVertexDataMemoryBlocks[i]);
+            &instanceVertexDataMemoryBlocks[i]))
+            return false;
         /*-------------------------------------------------------------------*/
         /* Per-Frame Shadow Map Draw Depth Target                            */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-            { 1024, 1024, 1 }, graphicsQueue,
-            1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_D32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
+        if(!CreateImageSet(_device,
+            { 1024, 1024, 1 }, 1, VK_FORMAT_D32_SFLOAT,
             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_IMAGE_ASPECT_DEPTH_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-            NULL, &shadowMapDTs[i], &shadowMapDTVs[i], &shadowMapDTMemBlocks[i]);
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            MEMORY_CATEGORY_RENDER_TARGETS, true, NULL,
+            &shadowMapDTs[i], &shadowMapDTVs[i], &shadowMapDTMemBlocks[i]))
+            return false;
         /*-------------------------------------------------------------------*/
         /* Shadow Map Framebuffer for this Buffer Index                      */
         /*-------------------------------------------------------------------*/
@@ -3512,7 +3712,7 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
         framebuffer_create_info.width = 1024;
         framebuffer_create_info.height = 1024;
         framebuffer_create_info.renderPass = shadowMapRenderPass;
-        vkCreateFramebuffer(_device, &framebuffer_create_info, NULL, &shadowMapFramebuffers[i]);
+        vkCreateFramebuffer(_device, &framebuffer_create_info, MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS), &shadowMapFramebuffers[i]);
         /*-------------------------------------------------------------------*/
         /* Shadow Map Pass Descriptor Set for this Buffer Index              */
         /*-------------------------------------------------------------------*/
@@ -3533,36 +3733,36 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
         /*-------------------------------------------------------------------*/
         /* Per-Frame GameObject Draw Render Target                           */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-            { swapchainExtent.width, swapchainExtent.height, 1 }, graphicsQueue,
-            1, VK_SAMPLE_COUNT_1_BIT, swapchainFormat.format, VK_IMAGE_TILING_OPTIMAL,
+        if(!CreateImageSet(_device,
+            { sceneTargetExtent.width, sceneTargetExtent.height, 1 }, 1, swapchainFormat.format,
             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_IMAGE_ASPECT_COLOR_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            NULL, &gameObjectRTs[i], &gameObjectRTVs[i], &gameObjectRTMemBlocks[i]);
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            MEMORY_CATEGORY_RENDER_TARGETS, true, NULL,
+            &gameObjectRTs[i], &gameObjectRTVs[i], &gameObjectRTMemBlocks[i]))
+            return false;
         /*-------------------------------------------------------------------*/
         /* Per-Frame GameObject Draw Bloom Render Target                     */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-            { swapchainExtent.width, swapchainExtent.height, 1 }, graphicsQueue,
-            1, VK_SAMPLE_COUNT_1_BIT, swapchainFormat.format, VK_IMAGE_TILING_OPTIMAL,
+        if(!CreateImageSet(_device,
+            { sceneTargetExtent.width, sceneTargetExtent.height, 1 }, 1, swapchainFormat.format,
             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_IMAGE_ASPECT_COLOR_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            NULL, &gameObjectBloomRTs[i], &gameObjectBloomRTVs[i], &gameObjectBloomRTMemBlocks[i]);
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            MEMORY_CATEGORY_RENDER_TARGETS, true, NULL,
+            &gameObjectBloomRTs[i], &gameObjectBloomRTVs[i], &gameObjectBloomRTMemBlocks[i]))
+            return false;
         /*-------------------------------------------------------------------*/
         /* Per-Frame GameObject Draw Depth Target                            */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-            { swapchainExtent.width, swapchainExtent.height, 1 }, graphicsQueue,
-            1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_D16_UNORM, VK_IMAGE_TILING_OPTIMAL,
+        if(!CreateImageSet(_device,
+            { sceneTargetExtent.width, sceneTargetExtent.height, 1 }, 1, VK_FORMAT_D16_UNORM,
             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
             VK_IMAGE_ASPECT_DEPTH_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-            NULL, &gameObjectDTs[i], &gameObjectDTVs[i], &gameObjectDTMemBlocks[i]);
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            MEMORY_CATEGORY_RENDER_TARGETS, true, NULL,
+            &gameObjectDTs[i], &gameObjectDTVs[i], &gameObjectDTMemBlocks[i]))
+            return false;
         /*-------------------------------------------------------------------*/
         /* Game Object Framebuffer for this Buffer Index                     */
         /*-------------------------------------------------------------------*/
@@ -3570,39 +3770,39 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
         framebufferAttachments[0] = gameObjectRTVs[i];
         framebufferAttachments[1] = gameObjectBloomRTVs[i];
         framebufferAttachments[2] = gameObjectDTVs[i];
-        framebuffer_create_info.width = swapchainExtent.width;
-        framebuffer_create_info.height = swapchainExtent.height;
+        framebuffer_create_info.width = sceneTargetExtent.width;
+        framebuffer_create_info.height = sceneTargetExtent.height;
         framebuffer_create_info.renderPass = staticMeshRenderPass;
-        vkCreateFramebuffer(_device, &framebuffer_create_info, NULL, &gameObjectFramebuffers[i]);
+        vkCreateFramebuffer(_device, &framebuffer_create_info, MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS), &gameObjectFramebuffers[i]);
         /*-------------------------------------------------------------------*/
         /* Per-Frame Blur Render Target                                      */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-            { swapchainExtent.width, swapchainExtent.height, 1 }, graphicsQueue,
-            1, VK_SAMPLE_COUNT_1_BIT, swapchainFormat.format, VK_IMAGE_TILING_OPTIMAL,
+        if(!CreateImageSet(_device,
+            { sceneTargetExtent.width, sceneTargetExtent.height, 1 }, 1, swapchainFormat.format,
             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_IMAGE_ASPECT_COLOR_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            NULL, &blurRTs[i], &blurRTVs[i], &blurRTMemBlocks[i]);
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            MEMORY_CATEGORY_RENDER_TARGETS, true, NULL,
+            &blurRTs[i], &blurRTVs[i], &blurRTMemBlocks[i]))
+            return false;
         /*-------------------------------------------------------------------*/
         /* Blur Ping Framebuffer for this Buffer Index                       */
         /*-------------------------------------------------------------------*/
         framebuffer_create_info.attachmentCount = 1;
         framebufferAttachments[0] = blurRTVs[i];
-        framebuffer_create_info.width = swapchainExtent.width;
-        framebuffer_create_info.height = swapchainExtent.height;
+        framebuffer_create_info.width = sceneTargetExtent.width;
+        framebuffer_create_info.height = sceneTargetExtent.height;
         framebuffer_create_info.renderPass = blurRenderPass;
-        vkCreateFramebuffer(_device, &framebuffer_create_info, NULL, &blurPingFramebuffers[i]);
+        vkCreateFramebuffer(_device, &framebuffer_create_info, MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS), &blurPingFramebuffers[i]);
         /*-------------------------------------------------------------------*/
         /* Blur Pong Framebuffer for this Buffer Index                       */
         /*-------------------------------------------------------------------*/
         framebuffer_create_info.attachmentCount = 1;
         framebufferAttachments[0] = gameObjectBloomRTVs[i];
-        framebuffer_create_info.width = swapchainExtent.width;
-        framebuffer_create_info.height = swapchainExtent.height;
+        framebuffer_create_info.width = sceneTargetExtent.width;
+        framebuffer_create_info.height = sceneTargetExtent.height;
         framebuffer_create_info.renderPass = blurRenderPass;
-        vkCreateFramebuffer(_device, &framebuffer_create_info, NULL, &blurPongFramebuffers[i]);
+        vkCreateFramebuffer(_device, &framebuffer_create_info, MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS), &blurPongFramebuffers[i]);
         /*-------------------------------------------------------------------*/
         /* Blur Descriptor Set for this Buffer Index                 */
         /*-------------------------------------------------------------------*/
@@ -3633,14 +3833,17 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
         /*-------------------------------------------------------------------*/
         /* Per-Frame UI Draw Render Target                                   */
         /*-------------------------------------------------------------------*/
-        GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-            { swapchainExtent.width, swapchainExtent.height, 1 }, graphicsQueue,
-            1, VK_SAMPLE_COUNT_1_BIT, swapchainFormat.format, VK_IMAGE_TILING_OPTIMAL,
+        /* Aliases the Bloom (blur pong) Target. Nothing reads it after the  */
+        /* blur passes end, Present samples blurRTs and the UI pass clears.  */
+        /*-------------------------------------------------------------------*/
+        if(!CreateImageSet(_device,
+            { swapchainExtent.width, swapchainExtent.height, 1 }, 1, swapchainFormat.format,
             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             VK_IMAGE_ASPECT_COLOR_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            NULL, &uiRTs[i], &uiRTVs[i], &uiRTMemBlocks[i]);
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            MEMORY_CATEGORY_RENDER_TARGETS, true, &gameObjectBloomRTMemBlocks[i],
+            &uiRTs[i], &uiRTVs[i], &uiRTMemBlocks[i]))
+            return false;
         /*-------------------------------------------------------------------*/
         /* UI Framebuffer for this Buffer Index                              */
         /*-------------------------------------------------------------------*/
@@ -3649,7 +3852,7 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
         framebuffer_create_info.width = swapchainExtent.width;
         framebuffer_create_info.height = swapchainExtent.height;
         framebuffer_create_info.renderPass = uiRenderPass;
-        vkCreateFramebuffer(_device, &framebuffer_create_info, NULL, &uiFramebuffers[i]);
+        vkCreateFramebuffer(_device, &framebuffer_create_info, MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS), &uiFramebuffers[i]);
         /*-------------------------------------------------------------------*/
         /* Present Pass Descriptor Set for this Buffer Index                 */
         /*-------------------------------------------------------------------*/
@@ -3686,51 +3889,387 @@ void RenderSystem::CreatePerFrameResources(VkPhysicalDevice _physicalDevice, VkD
         descriptorWrites[2].pImageInfo = &imageInfos[2];
         vkUpdateDescriptorSets(_device, 3, descriptorWrites, 0, NULL);
     }
+    return true;
 }
 
+/*---------------------------------------------------------------------------*/
+/* Handles are reset after they're destroyed, so resources that a failed     */
+/* CreatePerFrameResources never got to are skipped and a second Destroy     */
+/* is harmless. FreeMemory resets the allocations.                           */
+/*---------------------------------------------------------------------------*/
 void RenderSystem::DestroyPerFrameResources(VkDevice _device, uint32_t bufferCount)
 {
     for(uint32_t i=0;i<bufferCount;++i)
     {
-        vkDestroyFramebuffer(_device, uiFramebuffers[i], NULL);
-        vkDestroyImageView(_device, uiRTVs[i], NULL);
-        vkDestroyImage(_device, uiRTs[i], NULL);
-        vkFreeMemory(_device, uiRTMemBlocks[i], NULL);
-
-        vkDestroyFramebuffer(_device, gameObjectFramebuffers[i], NULL);
-        vkDestroyImageView(_device, gameObjectRTVs[i], NULL);
-        vkDestroyImage(_device, gameObjectRTs[i], NULL);
-        vkFreeMemory(_device, gameObjectRTMemBlocks[i], NULL);
-        vkDestroyImageView(_device, gameObjectBloomRTVs[i], NULL);
-        vkDestroyImage(_device, gameObjectBloomRTs[i], NULL);
-        vkFreeMemory(_device, gameObjectBloomRTMemBlocks[i], NULL);
-        vkDestroyImageView(_device, gameObjectDTVs[i], NULL);
-        vkDestroyImage(_device, gameObjectDTs[i], NULL);
-        vkFreeMemory(_device, gameObjectDTMemBlocks[i], NULL);
-
-        vkDestroyFramebuffer(_device, shadowMapFramebuffers[i], NULL);
-        vkDestroyImageView(_device, shadowMapDTVs[i], NULL);
-        vkDestroyImage(_device, shadowMapDTs[i], NULL);
-        vkFreeMemory(_device, shadowMapDTMemBlocks[i], NULL);
-
-        vkDestroyFramebuffer(_device, blurPingFramebuffers[i], NULL);
-        vkDestroyFramebuffer(_device, blurPongFramebuffers[i], NULL);
-        vkDestroyImageView(_device, blurRTVs[i], NULL);
-        vkDestroyImage(_device, blurRTs[i], NULL);
-        vkFreeMemory(_device, blurRTMemBlocks[i], NULL);
-
-        vkDestroyBuffer(_device, uiSDFVertexDataBuffers[i], NULL);
-        vkFreeMemory(_device, uiSDFVertexDataMemoryBlocks[i], NULL);
-        vkDestroyBuffer(_device, uiSDFIndexDataBuffers[i], NULL);
-        vkFreeMemory(_device, uiSDFIndexDataMemoryBlocks[i], NULL);
-        vkDestroyBuffer(_device, uiBlitInstanceDataBuffers[i], NULL);
-        vkFreeMemory(_device, uiBlitInstanceDataMemoryBlocks[i], NULL);
-        vkDestroyBuffer(_device, instanceVertexDataBuffers[i], NULL);
-        vkFreeMemory(_device, instanceVertexDataMemoryBlocks[i], NULL);
+        vkDestroyFramebuffer(_device, uiFramebuffers[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        uiFramebuffers[i] = VK_NULL_HANDLE;
+        vkDestroyImageView(_device, uiRTVs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        uiRTVs[i] = VK_NULL_HANDLE;
+        vkDestroyImage(_device, uiRTs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        uiRTs[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, uiRTMemBlocks[i]);
+
+        vkDestroyFramebuffer(_device, gameObjectFramebuffers[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        gameObjectFramebuffers[i] = VK_NULL_HANDLE;
+        vkDestroyImageView(_device, gameObjectRTVs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        gameObjectRTVs[i] = VK_NULL_HANDLE;
+        vkDestroyImage(_device, gameObjectRTs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        gameObjectRTs[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, gameObjectRTMemBlocks[i]);
+        vkDestroyImageView(_device, gameObjectBloomRTVs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        gameObjectBloomRTVs[i] = VK_NULL_HANDLE;
+        vkDestroyImage(_device, gameObjectBloomRTs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        gameObjectBloomRTs[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, gameObjectBloomRTMemBlocks[i]);
+        vkDestroyImageView(_device, gameObjectDTVs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        gameObjectDTVs[i] = VK_NULL_HANDLE;
+        vkDestroyImage(_device, gameObjectDTs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        gameObjectDTs[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, gameObjectDTMemBlocks[i]);
+
+        vkDestroyFramebuffer(_device, shadowMapFramebuffers[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        shadowMapFramebuffers[i] = VK_NULL_HANDLE;
+        vkDestroyImageView(_device, shadowMapDTVs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        shadowMapDTVs[i] = VK_NULL_HANDLE;
+        vkDestroyImage(_device, shadowMapDTs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        shadowMapDTs[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, shadowMapDTMemBlocks[i]);
+
+        vkDestroyFramebuffer(_device, blurPingFramebuffers[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        blurPingFramebuffers[i] = VK_NULL_HANDLE;
+        vkDestroyFramebuffer(_device, blurPongFramebuffers[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        blurPongFramebuffers[i] = VK_NULL_HANDLE;
+        vkDestroyImageView(_device, blurRTVs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        blurRTVs[i] = VK_NULL_HANDLE;
+        vkDestroyImage(_device, blurRTs[i], MemoryTracker::Vulkan(MEMORY_TAG_RENDER_TARGETS));
+        blurRTs[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, blurRTMemBlocks[i]);
+
+        vkDestroyBuffer(_device, uiInstanceDataBuffers[i], MemoryTracker::Vulkan(MEMORY_TAG_FRAME_DATA));
+        uiInstanceDataBuffers[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, uiInstanceDataMemoryBlocks[i]);
+        vkDestroyBuffer(_device, instanceVertexDataBuffers[i], MemoryTracker::Vulkan(MEMORY_TAG_FRAME_DATA));
+        instanceVertexDataBuffers[i] = VK_NULL_HANDLE;
+        FreeMemory(_device, instanceVertexDataMemoryBlocks[i]);
+    }
+    vkDestroyDescriptorPool(_device, shadowMapDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    shadowMapDescriptorPool = VK_NULL_HANDLE;
+    vkDestroyDescriptorPool(_device, blurDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    blurDescriptorPool = VK_NULL_HANDLE;
+    vkDestroyDescriptorPool(_device, perFrameDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    perFrameDescriptorPool = VK_NULL_HANDLE;
+    vkDestroyDescriptorPool(_device, uiInstanceDescriptorPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    uiInstanceDescriptorPool = VK_NULL_HANDLE;
+    if(timestampsSupported)
+        vkDestroyQueryPool(_device, frameTimestampQueryPool, MemoryTracker::Vulkan(MEMORY_TAG_PIPELINES));
+    frameTimestampQueryPool = VK_NULL_HANDLE;
+    ResetTransientMemory(_device);
+}
+
+void RenderSystem::InitMemoryAllocator(VkPhysicalDevice _physicalDevice)
+{
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(_physicalDevice, &deviceProperties);
+    vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &memoryProperties);
+    bufferImageGranularity = deviceProperties.limits.bufferImageGranularity;
+    maxMemoryAllocationCount = deviceProperties.limits.maxMemoryAllocationCount;
+    deviceMemoryAllocationCount = 0;
+    ZeroMemory(transientHeapSizeHints, sizeof(transientHeapSizeHints));
+    ZeroMemory(memoryCategoryStats, sizeof(memoryCategoryStats));
+}
+
+void RenderSystem::DestroyMemoryAllocator(VkDevice _device)
+{
+    for(uint32_t i = 0; i < generalHeaps.size(); ++i)
+    {
+        if(generalHeaps[i].mappedMemory)
+            vkUnmapMemory(_device, generalHeaps[i].memory);
+        vkFreeMemory(_device, generalHeaps[i].memory, MemoryTracker::Vulkan(generalHeaps[i].tag));
+    }
+    for(uint32_t i = 0; i < transientHeaps.size(); ++i)
+    {
+        if(transientHeaps[i].mappedMemory)
+            vkUnmapMemory(_device, transientHeaps[i].memory);
+        vkFreeMemory(_device, transientHeaps[i].memory, MemoryTracker::Vulkan(transientHeaps[i].tag));
     }
-    vkDestroyDescriptorPool(_device, shadowMapDescriptorPool, NULL);
-    vkDestroyDescriptorPool(_device, blurDescriptorPool, NULL);
-    vkDestroyDescriptorPool(_device, perFrameDescriptorPool, NULL);
+    std::vector<MemoryHeap>().swap(generalHeaps);
+    std::vector<MemoryHeap>().swap(transientHeaps);
+    deviceMemoryAllocationCount = 0;
+}
+
+bool RenderSystem::AllocateMemory(VkDevice _device, const VkMemoryRequirements& _requirements, VkMemoryPropertyFlags _properties,
+    MemoryCategory _category, bool _transient, MemoryAllocation& _allocation)
+{
+    ZeroMemory(&_allocation, sizeof(MemoryAllocation));
+    _allocation.category = _category;
+    _allocation.transient = _transient;
+    uint32_t memoryTypeIndex = VK_MAX_MEMORY_TYPES;
+    for(uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        if((_requirements.memoryTypeBits & (1 << i)) &&
+            (memoryProperties.memoryTypes[i].propertyFlags & _properties) == _properties)
+        {
+            memoryTypeIndex = i;
+            break;
+        }
+    }
+    if(memoryTypeIndex == VK_MAX_MEMORY_TYPES)
+        return false;
+    /*-----------------------------------------------------------------------*/
+    /* Buffers and optimal-tiled Images share Heaps, so every offset is      */
+    /* rounded up to the Buffer/Image Granularity as well as the alignment   */
+    /*-----------------------------------------------------------------------*/
+    VkDeviceSize alignment = _requirements.alignment > bufferImageGranularity ? _requirements.alignment : bufferImageGranularity;
+    VkDeviceSize size = (_requirements.size + alignment - 1) & ~(alignment - 1);
+    std::vector<MemoryHeap>& heaps = _transient ? transientHeaps : generalHeaps;
+    uint32_t heapIndex = ~(0u);
+    VkDeviceSize offset = 0;
+    for(uint32_t i = 0; i < heaps.size() && heapIndex == ~(0u); ++i)
+    {
+        MemoryHeap& heap = heaps[i];
+        if(heap.memoryTypeIndex != memoryTypeIndex) continue;
+        if(_transient)
+        {
+            offset = (heap.linearOffset + alignment - 1) & ~(alignment - 1);
+            if(offset + size > heap.size) continue;
+            heap.linearOffset = offset + size;
+            heapIndex = i;
+        }
+        else
+        {
+            for(uint32_t j = 0; j < heap.freeRanges.size(); ++j)
+            {
+                MemoryRange& range = heap.freeRanges[j];
+                offset = (range.offset + alignment - 1) & ~(alignment - 1);
+                if(offset + size > range.offset + range.size) continue;
+                /*-----------------------------------------------------------*/
+                /* Split the free Range around the allocated block           */
+                /*-----------------------------------------------------------*/
+                MemoryRange tail = { offset + size, range.offset + range.size - (offset + size) };
+                range.size = offset - range.offset;
+                if(!range.size)
+                    heap.freeRanges.erase(heap.freeRanges.begin() + j);
+                else
+                    ++j;
+                if(tail.size)
+                    heap.freeRanges.insert(heap.freeRanges.begin() + j, tail);
+                heapIndex = i;
+                break;
+            }
+        }
+    }
+    if(heapIndex == ~(0u))
+    {
+        /*-------------------------------------------------------------------*/
+        /* No Heap of this Memory Type had room, allocate a new block        */
+        /*-------------------------------------------------------------------*/
+        if(deviceMemoryAllocationCount >= maxMemoryAllocationCount)
+            return false;
+        MemoryHeap heap;
+        heap.size = _transient ? TRANSIENT_HEAP_BLOCK_SIZE : GENERAL_HEAP_BLOCK_SIZE;
+        if(_transient && transientHeapSizeHints[memoryTypeIndex] > heap.size)
+            heap.size = transientHeapSizeHints[memoryTypeIndex];
+        if(size > heap.size)
+            heap.size = size;
+        heap.memoryTypeIndex = memoryTypeIndex;
+        heap.linearOffset = size;
+        heap.mappedMemory = NULL;
+        heap.tag = memoryCategoryTags[_category];
+        if(!_transient && heap.size > size)
+            heap.freeRanges.push_back({ size, heap.size - size });
+        VkMemoryAllocateInfo alloc_info;
+        ZeroMemory(&alloc_info, sizeof(VkMemoryAllocateInfo));
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = heap.size;
+        alloc_info.memoryTypeIndex = memoryTypeIndex;
+        if(vkAllocateMemory(_device, &alloc_info, MemoryTracker::Vulkan(memoryCategoryTags[_category]), &heap.memory) != VK_SUCCESS)
+            return false;
+        ++deviceMemoryAllocationCount;
+        heapIndex = heaps.size();
+        offset = 0;
+        heaps.push_back(heap);
+    }
+    _allocation.memory = heaps[heapIndex].memory;
+    _allocation.offset = offset;
+    _allocation.size = size;
+    _allocation.heapIndex = heapIndex;
+    memoryCategoryStats[_category].allocationCount++;
+    memoryCategoryStats[_category].bytesUsed += size;
+    MemoryTracker::Allocated(memoryCategoryTags[_category], size, true);
+    return true;
+}
+
+void RenderSystem::FreeMemory(VkDevice _device, MemoryAllocation& _allocation)
+{
+    if(_allocation.memory == VK_NULL_HANDLE)
+        return;
+    MemoryCategoryStats& stats = memoryCategoryStats[_allocation.category];
+    if(_allocation.aliased)
+    {
+        stats.aliasCount--;
+        stats.bytesAliased -= _allocation.size;
+    }
+    else
+    {
+        stats.allocationCount--;
+        stats.bytesUsed -= _allocation.size;
+        MemoryTracker::Freed(memoryCategoryTags[_allocation.category], _allocation.size, true);
+        /*-------------------------------------------------------------------*/
+        /* Transient blocks are reclaimed all at once in ResetTransientMemory*/
+        /*-------------------------------------------------------------------*/
+        if(!_allocation.transient)
+        {
+            std::vector<MemoryRange>& freeRanges = generalHeaps[_allocation.heapIndex].freeRanges;
+            uint32_t j = 0;
+            while(j < freeRanges.size() && freeRanges[j].offset < _allocation.offset) ++j;
+            freeRanges.insert(freeRanges.begin() + j, { _allocation.offset, _allocation.size });
+            if(j + 1 < freeRanges.size() && freeRanges[j].offset + freeRanges[j].size == freeRanges[j + 1].offset)
+            {
+                freeRanges[j].size += freeRanges[j + 1].size;
+                freeRanges.erase(freeRanges.begin() + j + 1);
+            }
+            if(j > 0 && freeRanges[j - 1].offset + freeRanges[j - 1].size == freeRanges[j].offset)
+            {
+                freeRanges[j - 1].size += freeRanges[j].size;
+                freeRanges.erase(freeRanges.begin() + j);
+            }
+        }
+    }
+    ZeroMemory(&_allocation, sizeof(MemoryAllocation));
+}
+
+void RenderSystem::ResetTransientMemory(VkDevice _device)
+{
+    /*-----------------------------------------------------------------------*/
+    /* If a Memory Type spilled into more than one block, fold them into a   */
+    /* single larger block on the next allocation so a resize doesn't keep   */
+    /* paying for several vkAllocateMemory calls                             */
+    /*-----------------------------------------------------------------------*/
+    uint32_t heapCounts[VK_MAX_MEMORY_TYPES] = {};
+    VkDeviceSize heapSizes[VK_MAX_MEMORY_TYPES] = {};
+    for(uint32_t i = 0; i < transientHeaps.size(); ++i)
+    {
+        heapCounts[transientHeaps[i].memoryTypeIndex]++;
+        heapSizes[transientHeaps[i].memoryTypeIndex] += transientHeaps[i].size;
+    }
+    for(uint32_t i = 0; i < transientHeaps.size();)
+    {
+        MemoryHeap& heap = transientHeaps[i];
+        if(heapCounts[heap.memoryTypeIndex] > 1)
+        {
+            transientHeapSizeHints[heap.memoryTypeIndex] = heapSizes[heap.memoryTypeIndex];
+            if(heap.mappedMemory)
+                vkUnmapMemory(_device, heap.memory);
+            vkFreeMemory(_device, heap.memory, MemoryTracker::Vulkan(heap.tag));
+            --deviceMemoryAllocationCount;
+            transientHeaps.erase(transientHeaps.begin() + i);
+            continue;
+        }
+        heap.linearOffset = 0;
+        ++i;
+    }
+}
+
+void* RenderSystem::MapMemoryAllocation(VkDevice _device, const MemoryAllocation& _allocation)
+{
+    MemoryHeap& heap = _allocation.transient ? transientHeaps[_allocation.heapIndex] : generalHeaps[_allocation.heapIndex];
+    if(!heap.mappedMemory)
+        vkMapMemory(_device, heap.memory, 0, VK_WHOLE_SIZE, 0, &heap.mappedMemory);
+    return (uint8_t*)heap.mappedMemory + _allocation.offset;
+}
+
+bool RenderSystem::CreateBuffer(VkDevice _device, VkDeviceSize _size, VkBufferUsageFlags _usage, VkMemoryPropertyFlags _properties,
+    MemoryCategory _category, bool _transient, VkBuffer* _buffer, MemoryAllocation* _allocation)
+{
+    VkBufferCreateInfo create_info;
+    ZeroMemory(&create_info, sizeof(VkBufferCreateInfo));
+    create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    create_info.size = _size;
+    create_info.usage = _usage;
+    create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    vkCreateBuffer(_device, &create_info, MemoryTracker::Vulkan(memoryCategoryTags[_category]), _buffer);
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(_device, *_buffer, &memReqs);
+    if(!AllocateMemory(_device, memReqs, _properties, _category, _transient, *_allocation))
+    {
+        vkDestroyBuffer(_device, *_buffer, MemoryTracker::Vulkan(memoryCategoryTags[_category]));
+        *_buffer = VK_NULL_HANDLE;
+        return false;
+    }
+    vkBindBufferMemory(_device, *_buffer, _allocation->memory, _allocation->offset);
+    return true;
+}
+
+bool RenderSystem::CreateImageSet(VkDevice _device, VkExtent3D _extent, uint32_t _mipLevels, VkFormat _format, VkImageUsageFlags _usage,
+    VkImageAspectFlags _aspect, VkImageLayout _layout, MemoryCategory _category, bool _transient,
+    const MemoryAllocation* _aliasOf, VkImage* _image, VkImageView* _imageView, MemoryAllocation* _allocation)
+{
+    VkImageCreateInfo create_info;
+    ZeroMemory(&create_info, sizeof(VkImageCreateInfo));
+    create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    create_info.imageType = VK_IMAGE_TYPE_2D;
+    create_info.extent = _extent;
+    create_info.mipLevels = _mipLevels;
+    create_info.arrayLayers = 1;
+    create_info.format = _format;
+    create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    create_info.usage = _usage;
+    create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    vkCreateImage(_device, &create_info, MemoryTracker::Vulkan(memoryCategoryTags[_category]), _image);
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(_device, *_image, &memReqs);
+    /*-----------------------------------------------------------------------*/
+    /* Alias an existing block when the caller guarantees the two Images are */
+    /* never live at the same time, otherwise fall back to a new allocation  */
+    /*-----------------------------------------------------------------------*/
+    if(_aliasOf && _aliasOf->memory != VK_NULL_HANDLE &&
+        memReqs.size <= _aliasOf->size &&
+        (_aliasOf->offset % memReqs.alignment) == 0 &&
+        (memReqs.memoryTypeBits & (1 << (_aliasOf->transient ? transientHeaps : generalHeaps)[_aliasOf->heapIndex].memoryTypeIndex)))
+    {
+        *_allocation = *_aliasOf;
+        _allocation->category = _category;
+        _allocation->aliased = true;
+        memoryCategoryStats[_category].aliasCount++;
+        memoryCategoryStats[_category].bytesAliased += _allocation->size;
+    }
+    else if(!AllocateMemory(_device, memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _category, _transient, *_allocation))
+    {
+        vkDestroyImage(_device, *_image, MemoryTracker::Vulkan(memoryCategoryTags[_category]));
+        *_image = VK_NULL_HANDLE;
+        *_imageView = VK_NULL_HANDLE;
+        return false;
+    }
+    vkBindImageMemory(_device, *_image, _allocation->memory, _allocation->offset);
+    GvkHelper::create_image_view(_device, *_image, _format, _aspect, _mipLevels,
+        const_cast<VkAllocationCallbacks*>(MemoryTracker::Vulkan(memoryCategoryTags[_category])), _imageView);
+    GvkHelper::transition_image_layout(_device, commandPool, graphicsQueue, _mipLevels, *_image, _format,
+        VK_IMAGE_LAYOUT_UNDEFINED, _layout);
+    return true;
+}
+
+void RenderSystem::PrintMemoryUsageReport()
+{
+    std::cout << "RenderSystem Device Memory Usage\n";
+    for(uint32_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i)
+    {
+        const MemoryCategoryStats& stats = memoryCategoryStats[i];
+        std::cout << "  " << memoryCategoryNames[i] << ": "
+                  << stats.allocationCount << " allocations, "
+                  << (stats.bytesUsed / 1024) << " KB";
+        if(stats.aliasCount)
+            std::cout << " (+" << stats.aliasCount << " aliased, "
+                      << (stats.bytesAliased / 1024) << " KB saved)";
+        std::cout << "\n";
+    }
+    VkDeviceSize generalHeapBytes = 0, transientHeapBytes = 0;
+    for(uint32_t i = 0; i < generalHeaps.size(); ++i) generalHeapBytes += generalHeaps[i].size;
+    for(uint32_t i = 0; i < transientHeaps.size(); ++i) transientHeapBytes += transientHeaps[i].size;
+    std::cout << "  General Heaps: " << generalHeaps.size() << " blocks, " << (generalHeapBytes / 1024) << " KB reserved\n";
+    std::cout << "  Transient Heaps: " << transientHeaps.size() << " blocks, " << (transientHeapBytes / 1024) << " KB reserved\n";
+    std::cout << "  vkAllocateMemory: " << deviceMemoryAllocationCount << " of " << maxMemoryAllocationCount << std::endl;
 }
 
 #define ptr_offset(x, offset) ((void*)((uint8_t*)x + offset))
@@ -3755,41 +4294,7 @@ void RenderSystem::FreeShaderFileData(ShaderFileData &data)
 {
     free(data.vertexShaderFileData);
 }
-void RenderSystem::LoadBMFont(const char *_filePath, BMFont &_font)
-{
-    for(unsigned i=0; i < 255; ++i) _font.chars[i].page = ~(0u);
-    uint32_t fileSize;
-    fileInterface.GetFileSize(_filePath, fileSize);
-    fileInterface.OpenTextRead(_filePath);
-    char linebuf[1024];
-    while(fileInterface.ReadLine(linebuf, 1024, '\n') == GW::GReturn::SUCCESS)
-    {
-        if(strncmp(linebuf, "common", 6) == 0)
-        {
-            char* ptr= nullptr;
-            _font.lineHeight = strtoul(&linebuf[18], &ptr, 10);
-        }
-        else if(strncmp(linebuf, "char", 4) == 0)
-        {
-            char* ptr= nullptr;
-            uint32_t id = strtoul(&linebuf[8], &ptr, 10);
-
-            _font.chars[id].x = strtoul(&linebuf[18], &ptr, 10);
-            _font.chars[id].y = strtoul(&linebuf[25], &ptr, 10);
-
-            _font.chars[id].width  = strtoul(&linebuf[36], &ptr, 10);
-            _font.chars[id].height = strtoul(&linebuf[48], &ptr, 10);
-
-            _font.chars[id].xoffset = strtol(&linebuf[61], &ptr, 10);
-            _font.chars[id].yoffset = strtol(&linebuf[74], &ptr, 10);
-
-            _font.chars[id].xadvance = strtol(&linebuf[88], &ptr, 10);
-            _font.chars[id].page     = strtoul(&linebuf[98], &ptr, 10);
-        }
-    }
-    fileInterface.CloseFile();
-}
-void RenderSystem::LoadTGATexture(const char *_filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, VkDeviceMemory* textureMemory, VkImageView* textureSRV)
+bool RenderSystem::LoadTGATexture(const char *_filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, MemoryAllocation* textureMemory, VkImageView* textureSRV)
 {
     fileInterface.OpenBinaryRead(_filePath);
     TGAHeader tgaHeader;
@@ -3798,14 +4303,17 @@ void RenderSystem::LoadTGATexture(const char *_filePath, VkPhysicalDevice _physi
     fileInterface.Read((char*)&tgaHeader.entrySize, sizeof(uint8_t));
     fileInterface.Read((char*)&tgaHeader.xOrigin, sizeof(uint16_t) * 4);
     fileInterface.Read((char*)&tgaHeader.bitsPerPixel, sizeof(uint8_t) * 2);
-    GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-        { tgaHeader.width, tgaHeader.height,1 }, graphicsQueue, 1,
-        VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+    if(!CreateImageSet(_device,
+        { tgaHeader.width, tgaHeader.height,1 }, 1, VK_FORMAT_R8G8B8A8_UNORM,
         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
         VK_IMAGE_ASPECT_COLOR_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        NULL, texture, textureSRV, textureMemory);
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        MEMORY_CATEGORY_TEXTURES, false, NULL,
+        texture, textureSRV, textureMemory))
+    {
+        fileInterface.CloseFile();
+        return false;
+    }
     /*-----------------------------------------------------------------------*/
     uint32_t textureDataSize = (tgaHeader.bitsPerPixel / 8);
     textureDataSize *= tgaHeader.width * tgaHeader.height;
@@ -3819,8 +4327,9 @@ void RenderSystem::LoadTGATexture(const char *_filePath, VkPhysicalDevice _physi
         1, *texture, VK_FORMAT_R8G8B8A8_UNORM,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     /*-----------------------------------------------------------------------*/
+    return true;
 }
-void RenderSystem::LoadDDSTexture(const char *_filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, VkDeviceMemory* textureMemory, VkImageView* textureSRV)
+bool RenderSystem::LoadDDSTexture(const char *_filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, MemoryAllocation* textureMemory, VkImageView* textureSRV)
 {
     uint32_t textureDataSize;
     fileInterface.GetFileSize(_filePath, textureDataSize);
@@ -3832,14 +4341,17 @@ void RenderSystem::LoadDDSTexture(const char *_filePath, VkPhysicalDevice _physi
     DDSHeaderDX10 ddsHeaderDX10;
     fileInterface.Read((char *)&ddsHeaderDX10, sizeof(DDSHeaderDX10));
     /*-----------------------------------------------------------------------*/
-    GvkHelper::create_image_set(_physicalDevice, _device, commandPool,
-        {ddsHeader.width, ddsHeader.height,1}, graphicsQueue, ddsHeader.mipCount,
-        VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_BC7_UNORM_BLOCK, VK_IMAGE_TILING_OPTIMAL,
+    if(!CreateImageSet(_device,
+        {ddsHeader.width, ddsHeader.height,1}, ddsHeader.mipCount, VK_FORMAT_BC7_UNORM_BLOCK,
         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
         VK_IMAGE_ASPECT_COLOR_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        NULL, texture, textureSRV, textureMemory);
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        MEMORY_CATEGORY_TEXTURES, false, NULL,
+        texture, textureSRV, textureMemory))
+    {
+        fileInterface.CloseFile();
+        return false;
+    }
     /*-----------------------------------------------------------------------*/
     uint32_t textureDataOffset = sizeof(uint32_t) + sizeof(DDSHeader) + sizeof(DDSHeaderDX10);
     textureDataSize -= textureDataOffset;
@@ -3853,8 +4365,9 @@ void RenderSystem::LoadDDSTexture(const char *_filePath, VkPhysicalDevice _physi
         1, *texture, VK_FORMAT_BC7_UNORM_BLOCK,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     /*-----------------------------------------------------------------------*/
+    return true;
 }
-void RenderSystem::LoadDDSCubemap(const char *_filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, VkDeviceMemory* textureMemory, VkImageView* textureSRV)
+bool RenderSystem::LoadDDSCubemap(const char *_filePath, VkPhysicalDevice _physicalDevice, VkDevice _device, VkImage* texture, MemoryAllocation* textureMemory, VkImageView* textureSRV)
 {
     uint32_t textureDataSize;
     fileInterface.GetFileSize(_filePath, textureDataSize);
@@ -3879,7 +4392,7 @@ void RenderSystem::LoadDDSCubemap(const char *_filePath, VkPhysicalDevice _physi
         VK_SHARING_MODE_EXCLUSIVE, 0, NULL,
         VK_IMAGE_LAYOUT_UNDEFINED 
     };
-    vkCreateImage(_device, &image_create_info, NULL, texture);
+    vkCreateImage(_device, &image_create_info, MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES), texture);
     /*-----------------------------------------------------------------------*/
     uint32_t textureDataOffset = sizeof(uint32_t) + sizeof(DDSHeader) + sizeof(DDSHeaderDX10);
     textureDataSize -= textureDataOffset;
@@ -3888,17 +4401,13 @@ void RenderSystem::LoadDDSCubemap(const char *_filePath, VkPhysicalDevice _physi
     /*-----------------------------------------------------------------------*/
     VkMemoryRequirements memReqs;
     vkGetImageMemoryRequirements(_device, *texture, &memReqs);
-    uint32_t memTypeIndex;
-    GvkHelper::find_memory_type(_physicalDevice,
-        memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memTypeIndex);
-    VkMemoryAllocateInfo alloc_info = {
-        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        NULL,
-        textureDataSize,
-        memTypeIndex
-    };
-    vkAllocateMemory(_device, &alloc_info, NULL, textureMemory);
-    vkBindImageMemory(_device, *texture, *textureMemory, 0);
+    if(!AllocateMemory(_device, memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        MEMORY_CATEGORY_TEXTURES, false, *textureMemory))
+    {
+        vkDestroyImage(_device, *texture, MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES));
+        return false;
+    }
+    vkBindImageMemory(_device, *texture, textureMemory->memory, textureMemory->offset);
     /*-----------------------------------------------------------------------*/
     VkImageViewCreateInfo image_view_create_info = {
         VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -3910,7 +4419,7 @@ void RenderSystem::LoadDDSCubemap(const char *_filePath, VkPhysicalDevice _physi
         { VK_COMPONENT_SWIZZLE_IDENTITY },
         { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 }
     };
-    vkCreateImageView(_device, &image_view_create_info, NULL, textureSRV);
+    vkCreateImageView(_device, &image_view_create_info, MemoryTracker::Vulkan(MEMORY_TAG_TEXTURES), textureSRV);
     /*-----------------------------------------------------------------------*/
     VkCommandBuffer cmd;
     GvkHelper::signal_command_start(_device, commandPool, &cmd);
@@ -3962,6 +4471,7 @@ void RenderSystem::LoadDDSCubemap(const char *_filePath, VkPhysicalDevice _physi
         1, &dst_barrier);
     GvkHelper::signal_command_end(_device, graphicsQueue, commandPool, &cmd);
     /*-----------------------------------------------------------------------*/
+    return true;
 }
 void RenderSystem::LoadH2BMesh(const char* _filePath, Mesh& _mesh, MeshBounds& _bounds)
 {
@@ -19,6 +19,8 @@ uint32_t RegisterMesh(const char* _meshPath, const char* _baseTexturePath);
 uint32_t RegisterUIFont(const char* _fontLayoutPath, const char* _atlasTexturePath);
 
 uint32_t RegisterUISpriteAtlas(const char* _atlasTexturePath);
+
+void PrintMemoryUsageReport();
 #ifdef DEV_BUILD
 void DebugToggleMeshBoundsDraw();
 void DebugToggleOrthographicProjection();
@@ -0,0 +1,268 @@
+#include "StressLogic.h"
+#include "../Components/Identification.h"
+#include "../Components/Physics.h"
+#include "../Components/Gameplay.h"
+#include "../Components/Visuals.h"
+#include "../Entities/Prefabs.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+using namespace TeamYellow;
+
+// Connects the scenario generator and the frame time recorder to the ECS
+bool StressLogic::Init(	std::shared_ptr<flecs::world> _game,
+						std::weak_ptr<const GameConfig> _gameConfig)
+{
+	// save a handle to the ECS & game settings
+	game = _game;
+	gameConfig = _gameConfig;
+	std::shared_ptr<const GameConfig> readCfg = _gameConfig.lock();
+	enabled = (*readCfg).at("Stress").at("enabled").as<bool>();
+	if (!enabled)
+		return true;
+	random.seed((*readCfg).at("Stress").at("seed").as<unsigned>());
+	enemies = (*readCfg).at("Stress").at("enemies").as<unsigned>();
+	enemyFirerate = (*readCfg).at("Stress").at("enemyFirerate").as<float>();
+	bulletsPerSecond = (*readCfg).at("Stress").at("bulletsPerSecond").as<float>();
+	spread = (*readCfg).at("Stress").at("spread").as<float>();
+	lifetime = (*readCfg).at("Stress").at("lifetime").as<float>();
+	steps = (*readCfg).at("Stress").at("steps").as<unsigned>();
+	stepDuration = (*readCfg).at("Stress").at("stepDuration").as<float>();
+	warmup = (*readCfg).at("Stress").at("warmup").as<float>();
+	autopilot = (*readCfg).at("Stress").at("autopilot").as<bool>();
+	report = (*readCfg).at("Stress").at("report").as<std::string>();
+	build = (*readCfg).at("Stress").at("build").as<std::string>();
+	playerFirerate = (*readCfg).at("Lazers").at("firerate").as<float>();
+	gameplayAreaHalfHeight = (*readCfg).at("Player").at("GameplayAreaHalfHeight").as<float>();
+	// merge and system times are only recorded while measuring
+	ecs_measure_frame_time(*game, true);
+	ecs_measure_system_time(*game, true);
+	worldStats = std::make_unique<ecs_world_stats_t>();
+
+	enemyQuery = game->query<const Enemy>();
+	bulletQuery = game->query<const Bullet>();
+	gameobjectQuery = game->query<const Gameobject>();
+
+	// flies the player in a weave across the lane, firing as fast as the lazers allow
+	pilotSystem = game->system<AutoPilot>("Stress Pilot")
+		.kind(flecs::PreUpdate)
+		.with<Player>()
+		.each([this](flecs::entity e, AutoPilot& pilot) {
+		float time = static_cast<float>(e.world().time());
+		pilot.xaxis = sinf(time * 1.3f);
+		pilot.yaxis = sinf(time * 0.2f);
+		fireTime += e.delta_time();
+		if (fireTime >= playerFirerate) {
+			fireTime = 0;
+			e.add<Firing>();
+		}
+	});
+	// keeps the enemy count up and fires the generated bullets
+	spawnSystem = game->system("Stress Spawner")
+		.kind(flecs::OnUpdate)
+		.iter([this](flecs::iter& it) {
+		auto stage = it.world();
+		float playerY = stage.get<PlayerPosition>()->value.y;
+		unsigned alive = 0;
+		enemyQuery.iter([&alive](flecs::iter& q) { alive += static_cast<unsigned>(q.count()); });
+		if (alive < enemies * step)
+			SpawnEnemies(stage, enemies * step - alive, playerY);
+		bulletBudget += bulletsPerSecond * step * it.delta_time();
+		unsigned count = static_cast<unsigned>(bulletBudget);
+		bulletBudget -= count;
+		SpawnBullets(stage, count, playerY);
+	});
+	// generated bullets expire even when they never leave the screen
+	lifetimeSystem = game->system<Lifetime>("Stress Lifetime")
+		.multi_threaded()
+		.each([](flecs::entity e, Lifetime& l) {
+		l.value -= e.delta_time();
+		if (l.value <= 0)
+			e.destruct(); // queued until the next merge, like the cleanup system
+	});
+	// records the frame times and moves on to the next step, the last one quits.
+	// Steps advance with the delta time, so a replay with a fixed dt runs the
+	// same frames, but the report has the wall clock time between two frames.
+	reportSystem = game->system("Stress Report")
+		.kind(flecs::OnStore)
+		.no_readonly()
+		.iter([this](flecs::iter& it) {
+		auto now = std::chrono::steady_clock::now();
+		float frameMs = std::chrono::duration<float, std::milli>(now - frameStart).count();
+		frameStart = now;
+		float before = stepTime;
+		stepTime += it.delta_time();
+		if (stepTime <= warmup)
+			return;
+		if (before <= warmup) { // the measured part of the step starts here
+			const ecs_world_info_t* info = ecs_get_world_info(*game);
+			mergeStart = info->merge_time_total;
+			systemStart = info->system_time_total;
+			return;
+		}
+		frameTimes.push_back(frameMs);
+		if (stepTime < stepDuration)
+			return;
+		WriteReport();
+		if (++step > steps) {
+			std::cout << "Stress run done, results in " << report << std::endl;
+			game->quit();
+			return;
+		}
+		BeginStep();
+	});
+	Activate(false);
+	return true;
+}
+
+// Free any resources used to run this system
+bool StressLogic::Shutdown()
+{
+	if (enabled) {
+		pilotSystem.destruct();
+		spawnSystem.destruct();
+		lifetimeSystem.destruct();
+		reportSystem.destruct();
+		enemyQuery.destruct();
+		bulletQuery.destruct();
+		gameobjectQuery.destruct();
+	}
+	// invalidate the shared pointers
+	game.reset();
+	gameConfig.reset();
+	return true;
+}
+
+// Toggle if a system's Logic is actively running
+bool StressLogic::Activate(bool runSystem)
+{
+	if (!enabled)
+		return false;
+	auto player = game->lookup("Player One");
+	if (runSystem) {
+		// a lost life resets the level, so nothing can hit the player during a run
+		player.remove<Collidable>();
+		if (autopilot)
+			player.set<AutoPilot>({ 0, 0 });
+		pilotSystem.enable();
+		spawnSystem.enable();
+		lifetimeSystem.enable();
+		reportSystem.enable();
+		BeginStep();
+	}
+	else {
+		player.remove<AutoPilot>();
+		pilotSystem.disable();
+		spawnSystem.disable();
+		lifetimeSystem.disable();
+		reportSystem.disable();
+	}
+	return true;
+}
+
+// spawns enemies the way the level system does, ahead of or behind the player
+void StressLogic::SpawnEnemies(flecs::world& stage, unsigned count, float playerY)
+{
+	flecs::entity et1;
+	if (!RetreivePrefab(PREFAB_ENEMY_TYPE1, et1))
+		return;
+	const auto enemyStats = et1.get<EnemyStats>();
+	std::uniform_int_distribution<int> randomDir(0, 1);
+	std::uniform_real_distribution<float> x_range(-gameplayAreaHalfHeight, gameplayAreaHalfHeight);
+	std::uniform_real_distribution<float> a_range(enemyStats->accMin, enemyStats->accMax);
+	std::uniform_real_distribution<float> cooldown(0, enemyFirerate); // so they don't all fire together
+	for (unsigned i = 0; i < count; ++i) {
+		int factor = randomDir(random); // 0 or 1
+		int scalar = 1 - 2 * factor; // -1 or 1
+		GW::MATH2D::GMATRIX2F world;
+		GW::MATH2D::GMatrix2D::Rotate2F(GW::MATH2D::GIdentityMatrix2F, G_PI_F * (1 - factor), world);
+		stage.entity().is_a(et1)
+			.set<Velocity>({ 0, 0 })
+			.set<Acceleration>({ 0, -scalar * a_range(random) })
+			.set<Position>({ x_range(random), playerY + scalar * enemyStats->startY })
+			.set<Orientation>({ world, world })
+			.set<Cooldown>({ cooldown(random), enemyFirerate });
+	}
+}
+
+// Fans bullets out of the lazer prefab, every other one an enemy shot coming
+// down the lane and a player shot going up it so both sides take hits
+void StressLogic::SpawnBullets(flecs::world& stage, unsigned count, float playerY)
+{
+	flecs::entity bullet;
+	if (!count || !RetreivePrefab(PREFAB_LAZER_BULLET, bullet))
+		return;
+	float speed = bullet.get<Velocity>()->value.y;
+	float halfSpread = G_DEGREE_TO_RADIAN_F(spread) * 0.5f;
+	std::uniform_real_distribution<float> x_range(-gameplayAreaHalfHeight, gameplayAreaHalfHeight);
+	std::uniform_real_distribution<float> angle(-halfSpread, halfSpread);
+	for (unsigned i = 0; i < count; ++i) {
+		bool enemyShot = (i & 1) == 0;
+		float direction = enemyShot ? -1.0f : 1.0f;
+		float a = angle(random);
+		stage.entity().is_a(bullet)
+			.set<Position>({ x_range(random), playerY + (enemyShot ? 60.0f : -30.0f) })
+			.set<Velocity>({ speed * sinf(a), direction * speed * cosf(a) })
+			.set<AlliedWith>({ enemyShot ? ENEMY : PLAYER })
+			.set<Lifetime>({ lifetime });
+	}
+}
+
+void StressLogic::BeginStep()
+{
+	stepTime = 0;
+	bulletBudget = 0;
+	frameTimes.clear();
+	std::cout << "Stress step " << step << "/" << steps << ": " << enemies * step << " enemies, "
+		<< bulletsPerSecond * step << " bullets per second" << std::endl;
+}
+
+// appends one row per step, the header is only written to a new file
+bool StressLogic::WriteReport()
+{
+	if (frameTimes.empty())
+		return false;
+	bool header = !std::filesystem::exists(report);
+	std::ofstream file(report, std::ios_base::app);
+	if (!file.is_open())
+		return false;
+	if (header) {
+		file << "build,date,step,enemies_target,bullets_per_second,frames,fps,"
+			"frame_ms_p50,frame_ms_p90,frame_ms_p99,frame_ms_max,merge_ms,systems_ms,"
+			"entities,gameobjects,enemies,bullets,tables,empty_tables\n";
+	}
+	std::vector<float> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&sorted](float p) {
+		size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5f);
+		return sorted[std::min(index, sorted.size() - 1)];
+	};
+	double measured = 0;
+	for (float ms : frameTimes)
+		measured += ms;
+	size_t frames = frameTimes.size();
+	// times are averaged over the measured frames of the step
+	const ecs_world_info_t* info = ecs_get_world_info(*game);
+	double mergeMs = (info->merge_time_total - mergeStart) * 1000.0 / frames;
+	double systemMs = (info->system_time_total - systemStart) * 1000.0 / frames;
+	ecs_world_stats_get(*game, worldStats.get());
+	int32_t t = worldStats->t;
+	auto count = [](auto& query) {
+		int32_t total = 0;
+		query.iter([&total](flecs::iter& it) { total += static_cast<int32_t>(it.count()); });
+		return total;
+	};
+	char date[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+	file << build << ',' << date << ',' << step << ',' << enemies * step << ','
+		<< bulletsPerSecond * step << ',' << frames << ',' << frames * 1000.0 / measured << ','
+		<< percentile(0.5f) << ',' << percentile(0.9f) << ',' << percentile(0.99f) << ','
+		<< sorted.back() << ',' << mergeMs << ',' << systemMs << ','
+		<< static_cast<int64_t>(worldStats->entities.count.gauge.avg[t]) << ','
+		<< count(gameobjectQuery) << ',' << count(enemyQuery) << ',' << count(bulletQuery) << ','
+		<< info->table_count << ',' << info->empty_table_count << '\n';
+	return file.good();
+}
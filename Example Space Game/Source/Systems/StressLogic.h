@@ -0,0 +1,79 @@
+// The stress system replaces hand tuned levels with a generated bullet hell
+#ifndef STRESSLOGIC_H
+#define STRESSLOGIC_H
+
+// Contains our global game settings
+#include "../GameConfig.h"
+#include "../Components/Physics.h"
+#include <chrono>
+#include <random>
+
+namespace TeamYellow
+{
+	struct Enemy;
+	struct Bullet;
+	struct Gameobject;
+	class StressLogic
+	{
+		// shared connection to the main ECS engine
+		std::shared_ptr<flecs::world> game;
+		// non-ownership handle to configuration settings
+		std::weak_ptr<const GameConfig> gameConfig;
+		// handles to our running ECS systems
+		flecs::system pilotSystem;
+		flecs::system spawnSystem;
+		flecs::system lifetimeSystem;
+		flecs::system reportSystem;
+		// used to count what is alive each frame
+		flecs::query<const Enemy> enemyQuery;
+		flecs::query<const Bullet> bulletQuery;
+		flecs::query<const Gameobject> gameobjectQuery;
+		// [Stress] settings, the load of step n is n times the base load
+		bool enabled = false;
+		unsigned enemies;
+		float enemyFirerate;
+		float bulletsPerSecond;
+		float spread;
+		float lifetime;
+		unsigned steps;
+		float stepDuration;
+		float warmup;
+		bool autopilot;
+		float playerFirerate;
+		std::string report;
+		std::string build;
+		// a fixed seed so every build gets the same scenario
+		std::mt19937 random;
+		float gameplayAreaHalfHeight;
+		// state of the current step
+		unsigned step = 1;
+		float stepTime = 0;
+		float bulletBudget = 0;
+		float fireTime = 0;
+		std::vector<float> frameTimes;
+		// wall clock time of the last frame, a step always starts with a warmup frame
+		std::chrono::steady_clock::time_point frameStart;
+		double mergeStart = 0, systemStart = 0;
+		// only written between two steps, it's too big for the stack
+		std::unique_ptr<ecs_world_stats_t> worldStats;
+	public:
+		// attach the required logic to the ECS, does nothing unless [Stress] is enabled
+		bool Init(std::shared_ptr<flecs::world> _game,
+			std::weak_ptr<const GameConfig> _gameConfig);
+		// true when the game should start a stress run instead of the start screen
+		bool IsEnabled() const { return enabled; }
+		// control if the system is actively running
+		bool Activate(bool runSystem);
+		// release any resources allocated by the system
+		bool Shutdown();
+	private:
+		// helper routines
+		void SpawnEnemies(flecs::world& stage, unsigned count, float playerY);
+		void SpawnBullets(flecs::world& stage, unsigned count, float playerY);
+		void BeginStep();
+		bool WriteReport();
+	};
+
+};
+
+#endif
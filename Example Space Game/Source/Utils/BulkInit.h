@@ -0,0 +1,37 @@
+// Typed wrapper over ecs_bulk_init that creates a batch of entities directly
+// in their final table, copying one array per component column
+#ifndef BULKINIT_H
+#define BULKINIT_H
+
+#include <cassert>
+#include <initializer_list>
+
+namespace TeamYellow
+{
+	// _columns holds one array of _count values per component type. _extraIds
+	// are added without data, for tags and pairs such as (IsA, prefab).
+	// Must run on a world that isn't deferred or readonly. The ids have to fit
+	// in ecs_bulk_desc_t::ids with a 0 terminator, returns nullptr if they don't.
+	template <typename... Components>
+	const flecs::entity_t* BulkInit(flecs::world& _world, int32_t _count,
+		std::initializer_list<flecs::id_t> _extraIds, const Components*... _columns)
+	{
+		constexpr size_t capacity = sizeof(ecs_bulk_desc_t::ids) / sizeof(ecs_bulk_desc_t::ids[0]);
+		static_assert(sizeof...(Components) > 0, "BulkInit needs at least one component column");
+		static_assert(sizeof...(Components) < capacity, "BulkInit has more columns than ecs_bulk_desc_t ids");
+		assert(sizeof...(Components) + _extraIds.size() < capacity && "too many ids for ecs_bulk_init");
+		if (sizeof...(Components) + _extraIds.size() >= capacity)
+			return nullptr;
+		ecs_bulk_desc_t desc = {};
+		void* data[capacity] = {};
+		int32_t i = 0;
+		((desc.ids[i] = _world.id<Components>(), data[i] = const_cast<Components*>(_columns), ++i), ...);
+		for (flecs::id_t id : _extraIds)
+			desc.ids[i++] = id;
+		desc.count = _count;
+		desc.data = data;
+		return ecs_bulk_init(_world, &desc);
+	}
+}
+
+#endif
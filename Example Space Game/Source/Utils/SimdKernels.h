@@ -0,0 +1,62 @@
+// Small vectorized loops used by systems that integrate whole component columns
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#if defined(__AVX__) || defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <immintrin.h>
+#define SIMDKERNELS_SSE
+#endif
+
+namespace TeamYellow
+{
+namespace SimdKernels
+{
+	// _out[i] += _in[i] * _scale for _count floats
+	inline void ScaleAdd(float* _out, const float* _in, float _scale, size_t _count)
+	{
+		size_t i = 0;
+#if defined(__AVX__)
+		const __m256 scale8 = _mm256_set1_ps(_scale);
+		for (; i + 8 <= _count; i += 8) {
+			__m256 sum = _mm256_add_ps(_mm256_loadu_ps(_out + i),
+				_mm256_mul_ps(_mm256_loadu_ps(_in + i), scale8));
+			_mm256_storeu_ps(_out + i, sum);
+		}
+#endif
+#if defined(SIMDKERNELS_SSE)
+		const __m128 scale4 = _mm_set1_ps(_scale);
+		for (; i + 4 <= _count; i += 4) {
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(_out + i),
+				_mm_mul_ps(_mm_loadu_ps(_in + i), scale4));
+			_mm_storeu_ps(_out + i, sum);
+		}
+#endif
+		for (; i < _count; ++i)
+			_out[i] += _in[i] * _scale;
+	}
+
+	// adds the same (x, y) * _scale to each of the _count float pairs in _out
+	// used when the input component is shared through a prefab
+	inline void ScaleAddBroadcast2(float* _out, const float _in[2], float _scale, size_t _count)
+	{
+		const float x = _in[0] * _scale, y = _in[1] * _scale;
+		size_t i = 0, floats = _count * 2;
+#if defined(__AVX__)
+		const __m256 xy8 = _mm256_setr_ps(x, y, x, y, x, y, x, y);
+		for (; i + 8 <= floats; i += 8)
+			_mm256_storeu_ps(_out + i, _mm256_add_ps(_mm256_loadu_ps(_out + i), xy8));
+#endif
+#if defined(SIMDKERNELS_SSE)
+		const __m128 xy4 = _mm_setr_ps(x, y, x, y);
+		for (; i + 4 <= floats; i += 4)
+			_mm_storeu_ps(_out + i, _mm_add_ps(_mm_loadu_ps(_out + i), xy4));
+#endif
+		for (; i < floats; i += 2) {
+			_out[i] += x;
+			_out[i + 1] += y;
+		}
+	}
+}
+}
+
+#endif
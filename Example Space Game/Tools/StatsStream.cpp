@@ -0,0 +1,318 @@
+// Reads the binary stats stream of a running game (GET /stats/stream on the
+// flecs REST api, enable it with rest_port in defaults.ini) and writes one CSV
+// row per frame to stdout. The stream only holds the metrics that changed
+// since the last poll, so polling a few times per second costs the game next
+// to nothing. See ecs_stats_stream_encode in flecs for the format.
+//
+// StatsStream [-h host] [-p port] [-i poll interval ms] [-n poll count] [-r]
+//   -r writes counters (frame count, times, command counts, ...) as the
+//      change per frame instead of the running total.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET Socket;
+#define CloseSocket closesocket
+#else
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int Socket;
+#define INVALID_SOCKET (-1)
+#define CloseSocket close
+#endif
+
+struct Metric
+{
+	std::string name;
+	bool counter;
+};
+
+struct StreamState
+{
+	std::vector<Metric> metrics;
+	std::vector<int64_t> values;	// values of the last received frame
+	std::vector<int64_t> previous;	// values of the frame before it
+	int64_t seq = 0;				// sequence number of the last received frame
+	bool hasPrevious = false;		// false right after a gap in the stream
+};
+
+class Reader
+{
+public:
+	Reader(const std::string& _data) : ptr(reinterpret_cast<const uint8_t*>(_data.data())), end(ptr + _data.size()) {}
+
+	bool Ok() const { return ok; }
+
+	uint8_t Byte()
+	{
+		if (ptr >= end)
+		{
+			ok = false;
+			return 0;
+		}
+		return *ptr++;
+	}
+
+	uint64_t Uint()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			uint8_t b = Byte();
+			value |= static_cast<uint64_t>(b & 0x7F) << shift;
+			if (!(b & 0x80))
+				return value;
+		}
+		ok = false;
+		return value;
+	}
+
+	int64_t Int()
+	{
+		uint64_t value = Uint();
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	std::string String(size_t _length)
+	{
+		if (static_cast<size_t>(end - ptr) < _length)
+		{
+			ok = false;
+			return std::string();
+		}
+		std::string result(reinterpret_cast<const char*>(ptr), _length);
+		ptr += _length;
+		return result;
+	}
+
+private:
+	const uint8_t* ptr;
+	const uint8_t* end;
+	bool ok = true;
+};
+
+// Sends a GET request and returns the body, or false if the game can't be reached
+static bool HttpGet(const std::string& _host, const std::string& _port, const std::string& _path, std::string& _body)
+{
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* addr = nullptr;
+	if (getaddrinfo(_host.c_str(), _port.c_str(), &hints, &addr) != 0)
+		return false;
+
+	Socket sock = INVALID_SOCKET;
+	for (addrinfo* a = addr; a; a = a->ai_next)
+	{
+		sock = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+		if (sock == INVALID_SOCKET)
+			continue;
+		if (connect(sock, a->ai_addr, static_cast<int>(a->ai_addrlen)) == 0)
+			break;
+		CloseSocket(sock);
+		sock = INVALID_SOCKET;
+	}
+	freeaddrinfo(addr);
+	if (sock == INVALID_SOCKET)
+		return false;
+
+	std::string request = "GET " + _path + " HTTP/1.1\r\nHost: " + _host + "\r\nConnection: close\r\n\r\n";
+	if (send(sock, request.c_str(), static_cast<int>(request.size()), 0) != static_cast<int>(request.size()))
+	{
+		CloseSocket(sock);
+		return false;
+	}
+
+	// read until the whole body arrived. Without a Content-Length the body
+	// ends when the server closes the connection, which the request asks for
+	std::string response;
+	size_t headerEnd = std::string::npos;
+	size_t contentLength = std::string::npos;
+	bool chunked = false;
+	char buffer[16 * 1024];
+	for (;;)
+	{
+		int received = static_cast<int>(recv(sock, buffer, sizeof(buffer), 0));
+		if (received <= 0)
+			break;
+		response.append(buffer, received);
+		if (headerEnd == std::string::npos)
+		{
+			headerEnd = response.find("\r\n\r\n");
+			if (headerEnd == std::string::npos)
+				continue;
+			headerEnd += 4;
+			size_t length = response.find("Content-Length:");
+			if (length != std::string::npos && length < headerEnd)
+				contentLength = std::strtoull(response.c_str() + length + 15, nullptr, 10);
+			size_t encoding = response.find("Transfer-Encoding: chunked");
+			chunked = encoding != std::string::npos && encoding < headerEnd;
+		}
+		if (contentLength != std::string::npos && response.size() >= headerEnd + contentLength)
+			break;
+	}
+	CloseSocket(sock);
+
+	if (headerEnd == std::string::npos || response.compare(0, 12, "HTTP/1.1 200") != 0)
+		return false;
+	if (chunked)
+	{
+		std::fprintf(stderr, "stats stream: chunked replies are not supported\n");
+		return false;
+	}
+	if (contentLength != std::string::npos && response.size() < headerEnd + contentLength)
+	{
+		std::fprintf(stderr, "stats stream: reply cut short\n");
+		return false;
+	}
+	_body = response.substr(headerEnd, contentLength);
+	return true;
+}
+
+static void WriteHeader(const StreamState& _state)
+{
+	std::printf("seq");
+	for (const Metric& metric : _state.metrics)
+		std::printf(",%s", metric.name.c_str());
+	std::printf("\n");
+}
+
+static void WriteRow(const StreamState& _state, bool _rates)
+{
+	std::printf("%lld", static_cast<long long>(_state.seq));
+	for (size_t i = 0; i < _state.metrics.size(); ++i)
+	{
+		if (!_rates || !_state.metrics[i].counter)
+			std::printf(",%lld", static_cast<long long>(_state.values[i]));
+		else if (_state.hasPrevious)
+			std::printf(",%lld", static_cast<long long>(_state.values[i] - _state.previous[i]));
+		else
+			std::printf(",");
+	}
+	std::printf("\n");
+}
+
+// Applies one reply to the state and writes a row per frame, returns false if the reply is malformed
+static bool Decode(const std::string& _data, StreamState& _state, bool _rates)
+{
+	Reader reader(_data);
+	if (reader.String(4) != "FLST" || reader.Uint() != 1)
+		return false;
+
+	size_t metricCount = static_cast<size_t>(reader.Uint());
+	if (reader.Uint())
+	{
+		_state.metrics.clear();
+		for (size_t i = 0; i < metricCount && reader.Ok(); ++i)
+		{
+			Metric metric;
+			metric.counter = reader.Byte() != 0;
+			metric.name = reader.String(static_cast<size_t>(reader.Uint()));
+			_state.metrics.push_back(metric);
+		}
+		WriteHeader(_state);
+	}
+	if (_state.metrics.size() != metricCount)
+		return false;
+
+	int64_t first = static_cast<int64_t>(reader.Uint());
+	int64_t frameCount = static_cast<int64_t>(reader.Uint());
+	int64_t base = static_cast<int64_t>(reader.Uint());
+	if (frameCount && !base)
+	{
+		// the frames we had are gone (or the game restarted), the first frame holds full values
+		if (_state.seq)
+			std::fprintf(stderr, "stats stream: missed frames %lld to %lld\n",
+				static_cast<long long>(_state.seq + 1), static_cast<long long>(first - 1));
+		_state.values.assign(metricCount, 0);
+		_state.hasPrevious = false;
+	}
+
+	for (int64_t f = 0; f < frameCount && reader.Ok(); ++f)
+	{
+		_state.previous = _state.values;
+		uint64_t changed = reader.Uint();
+		size_t index = static_cast<size_t>(-1);
+		for (uint64_t c = 0; c < changed && reader.Ok(); ++c)
+		{
+			index += static_cast<size_t>(reader.Uint()) + 1;
+			if (index >= metricCount)
+				return false;
+			_state.values[index] += reader.Int();
+		}
+		_state.seq = first + f;
+		WriteRow(_state, _rates);
+		_state.hasPrevious = true;
+	}
+	std::fflush(stdout);
+	return reader.Ok();
+}
+
+int main(int argc, char** argv)
+{
+	std::string host = "localhost";
+	std::string port = "27750";
+	int intervalMs = 250;
+	long long pollCount = -1;
+	bool rates = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "-r")
+			rates = true;
+		else if (i + 1 < argc && arg == "-h")
+			host = argv[++i];
+		else if (i + 1 < argc && arg == "-p")
+			port = argv[++i];
+		else if (i + 1 < argc && arg == "-i")
+			intervalMs = std::atoi(argv[++i]);
+		else if (i + 1 < argc && arg == "-n")
+			pollCount = std::atoll(argv[++i]);
+		else
+		{
+			std::fprintf(stderr, "usage: %s [-h host] [-p port] [-i poll interval ms] [-n poll count] [-r]\n", argv[0]);
+			return 1;
+		}
+	}
+
+#ifdef _WIN32
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+	StreamState state;
+	for (long long poll = 0; pollCount < 0 || poll < pollCount; ++poll)
+	{
+		if (poll)
+			std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+
+		std::string path = "/stats/stream?seq=" + std::to_string(state.seq);
+		if (state.metrics.empty())
+			path += "&names=true";
+		std::string body;
+		if (!HttpGet(host, port, path, body))
+		{
+			std::fprintf(stderr, "stats stream: no reply from %s:%s\n", host.c_str(), port.c_str());
+			continue;
+		}
+		if (!Decode(body, state, rates))
+		{
+			std::fprintf(stderr, "stats stream: malformed reply\n");
+			return 1;
+		}
+	}
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+	return 0;
+}
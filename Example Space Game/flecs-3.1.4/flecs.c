@@ -532,6 +532,8 @@ struct ecs_table_t {
     int32_t refcount;                /* Increased when used as storage table */
     int32_t lock;                    /* Prevents modifications */
     int32_t observed_count;          /* Number of observed entities in table */
+    int32_t reserve_count;           /* Storage kept by ecs_table_reserve */
+    int32_t realloc_count;           /* Number of times storage was resized */
     uint16_t record_count;           /* Table record count including wildcards */
 };
 
@@ -679,6 +681,7 @@ struct ecs_query_t {
     /* Table sorting */
     ecs_entity_t order_by_component;
     ecs_order_by_action_t order_by;
+    ecs_order_by_key_action_t order_by_key;
     ecs_sort_table_action_t sort_table;
     ecs_vector_t *table_slices;
 
@@ -802,8 +805,9 @@ typedef struct ecs_cmd_t {
 
 /* Entity specific metadata for command in defer queue */
 typedef struct ecs_cmd_entry_t {
-    int32_t first;
+    int32_t first; /* If -1, entity was created but has no commands yet */
     int32_t last; /* If -1, a delete command was inserted */
+    bool is_new;  /* Entity was created in the same batch */
 } ecs_cmd_entry_t;
 
 /** A stage is a context that allows for safely using the API from multiple 
@@ -826,6 +830,7 @@ struct ecs_stage_t {
     ecs_world_t *thread_ctx;     /* Points to stage when a thread stage */
     ecs_world_t *world;          /* Reference to world */
     ecs_os_thread_t thread;      /* Thread handle (0 if no threading is used) */
+    int32_t sync_spin;           /* Adaptive spin budget for sync points */
 
     /* One-shot actions to be executed after the merge */
     ecs_vector_t *post_frame_actions;
@@ -893,6 +898,11 @@ typedef struct ecs_action_elem_t {
 
 /** The world stores and manages all ECS data. An application can have more than
  * one world, but data is not shared between worlds. */
+#ifdef FLECS_JOURNAL
+/** Binary journal writer (see addons/journal.c) */
+typedef struct ecs_journal_writer_t ecs_journal_writer_t;
+#endif
+
 struct ecs_world_t {
     ecs_header_t hdr;
 
@@ -919,6 +929,9 @@ struct ecs_world_t {
     /* Is entity range checking enabled? */
     bool range_check_enabled;
 
+    /* Factor by which table storage grows when it runs out of space */
+    int32_t table_growth_factor;
+
     /* --  Data storage -- */
     ecs_store_t store;
 
@@ -935,6 +948,8 @@ struct ecs_world_t {
     /* -- Identifiers -- */
     ecs_hashmap_t aliases;
     ecs_hashmap_t symbols;
+    ecs_hashmap_t lookup_cache;  /* hashmap<lookup arguments, entity> */
+    bool lookup_cache_dirty;     /* Names or parents changed since last lookup */
 
     /* -- Staging -- */
     ecs_stage_t *stages;         /* Stages */
@@ -946,6 +961,9 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;   /* Mutex for job_cond */
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
+    int32_t workers_parked;      /* Number of workers blocked on worker_cond */
+    int32_t worker_generation;   /* Increases each time workers are released */
+    bool main_parked;            /* Is main thread blocked on sync_cond */
 
     /* -- Time management -- */
     ecs_time_t world_start_time; /* Timestamp of simulation start */
@@ -967,6 +985,10 @@ struct ecs_world_t {
 
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
+
+#ifdef FLECS_JOURNAL
+    ecs_journal_writer_t *journal; /* Binary journal, if open */
+#endif
 };
 
 #endif
@@ -1450,6 +1472,12 @@ void flecs_table_swap(
     int32_t row_1,
     int32_t row_2);
 
+/* Reorder table rows so that row i holds what was in rows[i] */
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *rows);
+
 ecs_table_t *flecs_table_traverse_add(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -1664,6 +1692,11 @@ bool flecs_defer_begin(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Entity was created while deferred, by the batch that is being recorded */
+void flecs_defer_new_entity(
+    ecs_stage_t *stage,
+    ecs_entity_t entity);
+
 bool flecs_defer_modified(
     ecs_stage_t *stage,
     ecs_entity_t entity,
@@ -2186,6 +2219,14 @@ ecs_entity_t flecs_get_oneof(
     const ecs_world_t *world,
     ecs_entity_t e);
 
+/* Invalidate the lookup cache after an entity name or parent changed */
+void flecs_lookup_cache_invalidate(
+    ecs_world_t *world);
+
+/* Free the lookup cache */
+void flecs_lookup_cache_fini(
+    ecs_world_t *world);
+
 void flecs_notify_on_remove(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -2415,6 +2456,26 @@ void ecs_colorize_buf(
 bool flecs_isident(
     char ch);
 
+/* Minimum size of the buffer passed to flecs_ftoa */
+#define FLECS_FTOA_SIZE (64)
+
+/* Write integer to buffer, returns end of the written string (not terminated) */
+char* flecs_itoa(
+    char *buf,
+    int64_t v);
+
+char* flecs_utoa(
+    char *buf,
+    uint64_t v);
+
+/* Write floating point number in the format of ecs_strbuf_appendflt to buffer,
+ * returns the number of characters written */
+int32_t flecs_ftoa(
+    char *buf,
+    double f,
+    int32_t precision,
+    char nan_delim);
+
 int32_t flecs_search_relation_w_idr(
     const ecs_world_t *world,
     const ecs_table_t *table,
@@ -2789,6 +2850,8 @@ void flecs_table_init_flags(
                     table->sw_count ++;
                 } else if (r == ecs_id(EcsPoly)) {
                     table->flags |= EcsTableHasBuiltins;
+                } else if (id == ecs_pair(ecs_id(EcsIdentifier), EcsName)) {
+                    table->flags |= EcsTableHasName;
                 }
             } else {
                 if (ECS_HAS_ID_FLAG(id, TOGGLE)) {
@@ -3825,13 +3888,15 @@ void* flecs_table_grow_column(
             ecs_vec_set_size(&world->allocator, column, size, dst_size);
         }
 
-        result = ecs_vec_grow(&world->allocator, column, size, to_add);
+        if (to_add) {
+            result = ecs_vec_grow(&world->allocator, column, size, to_add);
 
-        ecs_xtor_t ctor;
-        if (construct && (ctor = ti->hooks.ctor)) {
-            /* If new elements need to be constructed and component has a
-             * constructor, construct */
-            ctor(result, to_add, ti);
+            ecs_xtor_t ctor;
+            if (construct && (ctor = ti->hooks.ctor)) {
+                /* If new elements need to be constructed and component has a
+                 * constructor, construct */
+                ctor(result, to_add, ti);
+            }
         }
     }
 
@@ -3840,6 +3905,52 @@ void* flecs_table_grow_column(
     return result;
 }
 
+/* Resize storage of the entity, record and component vectors of a table to the
+ * same size, without changing the number of entities in the table. */
+static
+void flecs_table_resize_data(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t size)
+{
+    ecs_vec_set_size_t(&world->allocator, &data->entities, ecs_entity_t, size);
+    size = data->entities.size; /* Vector sizes are rounded to a power of 2 */
+    ecs_vec_set_size_t(&world->allocator, &data->records, ecs_record_t*, size);
+
+    int32_t i, column_count = table->storage_count;
+    for (i = 0; i < column_count; i ++) {
+        flecs_table_grow_column(world, &data->columns[i], table->type_info[i], 
+            0, size, false);
+    }
+
+    table->realloc_count ++;
+    world->info.table_realloc_total ++;
+}
+
+/* Make room for count entities in a table. When the table is full it grows by
+ * the world's growth factor, so the column appends that follow don't have to 
+ * reallocate one by one. */
+static
+void flecs_table_ensure_size(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t count)
+{
+    int32_t size = data->entities.size;
+    if (count <= size) {
+        return;
+    }
+
+    size *= world->table_growth_factor;
+    if (size < count) {
+        size = count;
+    }
+
+    flecs_table_resize_data(world, table, data, size);
+}
+
 static
 int32_t flecs_table_grow_data(
     ecs_world_t *world,
@@ -3952,6 +4063,7 @@ int32_t flecs_table_append(
     int32_t count = data->entities.count;
     int32_t column_count = table->storage_count;
     ecs_vec_t *columns = table->data.columns;
+    flecs_table_ensure_size(world, table, data, count + 1);
 
     /* Grow buffer with entity ids, set new element to new entity */
     ecs_entity_t *e = ecs_vec_append_t(&world->allocator, 
@@ -4362,8 +4474,9 @@ int32_t flecs_table_appendn(
 
     flecs_table_check_sanity(table);
     int32_t cur_count = flecs_table_data_count(data);
+    flecs_table_ensure_size(world, table, data, cur_count + to_add);
     int32_t result = flecs_table_grow_data(
-        world, table, data, to_add, cur_count + to_add, ids);
+        world, table, data, to_add, data->entities.size, ids);
     flecs_table_check_sanity(table);
 
     return result;
@@ -4380,14 +4493,68 @@ void flecs_table_set_size(
 
     flecs_table_check_sanity(table);
 
-    int32_t cur_count = flecs_table_data_count(data);
-
-    if (cur_count < size) {
-        flecs_table_grow_data(world, table, data, 0, size, NULL);
+    if (data->entities.size < size) {
+        flecs_table_resize_data(world, table, data, size);
         flecs_table_check_sanity(table);
     }
 }
 
+void ecs_table_reserve(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    if (count > table->reserve_count) {
+        table->reserve_count = count;
+        flecs_table_set_size(world, table, &table->data, count);
+    }
+error:
+    return;
+}
+
+int32_t ecs_table_get_realloc_count(
+    const ecs_table_t *table)
+{
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    return table->realloc_count;
+error:
+    return 0;
+}
+
+static
+int64_t flecs_table_storage_bytes(
+    const ecs_table_t *table)
+{
+    const ecs_data_t *data = &table->data;
+    int64_t result = (int64_t)ecs_vec_size(&data->entities) * ECS_SIZEOF(ecs_entity_t);
+    result += (int64_t)ecs_vec_size(&data->records) * ECS_SIZEOF(ecs_record_t*);
+    int32_t i, count = table->storage_count;
+    for (i = 0; i < count; i ++) {
+        result += (int64_t)ecs_vec_size(&data->columns[i]) * 
+            table->type_info[i]->size;
+    }
+    return result;
+}
+
+int64_t ecs_get_table_storage_bytes(
+    const ecs_world_t *world)
+{
+    world = ecs_get_world(world);
+    int64_t result = flecs_table_storage_bytes(&world->store.root);
+    int32_t i, count = flecs_sparse_count(&world->store.tables);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get_dense_t(&world->store.tables,
+            ecs_table_t, i);
+        result += flecs_table_storage_bytes(table);
+    }
+    return result;
+}
+
 bool flecs_table_shrink(
     ecs_world_t *world,
     ecs_table_t *table)
@@ -4399,6 +4566,17 @@ bool flecs_table_shrink(
     flecs_table_check_sanity(table);
 
     ecs_data_t *data = &table->data;
+
+    /* Tables with reserved storage only give back what they grew beyond it */
+    int32_t reserve_count = table->reserve_count;
+    if (reserve_count) {
+        if (flecs_next_pow_of_2(reserve_count) < data->entities.size) {
+            flecs_table_resize_data(world, table, data, reserve_count);
+            return true;
+        }
+        return false;
+    }
+
     bool has_payload = data->entities.array != NULL;
     ecs_vec_reclaim_t(&world->allocator, &data->entities, ecs_entity_t);
     ecs_vec_reclaim_t(&world->allocator, &data->records, ecs_record_t*);
@@ -4544,6 +4722,107 @@ void flecs_table_swap(
     flecs_table_check_sanity(table);
 }
 
+static
+void flecs_table_permute_swap(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *rows,
+    int32_t count)
+{
+    /* Track where each row is while swapping, since earlier swaps move rows 
+     * that haven't been placed yet */
+    int32_t *pos = ecs_os_malloc_n(int32_t, count * 2);
+    int32_t *row_at = &pos[count];
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        pos[i] = i;
+        row_at[i] = i;
+    }
+
+    for (i = 0; i < count; i ++) {
+        int32_t row = rows[i];
+        int32_t cur = pos[row];
+        if (cur != i) {
+            int32_t displaced = row_at[i];
+            flecs_table_swap(world, table, i, cur);
+            row_at[i] = row;
+            row_at[cur] = displaced;
+            pos[row] = i;
+            pos[displaced] = cur;
+        }
+    }
+
+    ecs_os_free(pos);
+}
+
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *rows)
+{
+    ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
+
+    flecs_table_check_sanity(table);
+
+    int32_t i, count = ecs_table_count(table);
+    if (count < 2) {
+        return;
+    }
+
+    /* Union and bitset columns only support swapping rows */
+    if (table->sw_count || table->bs_count) {
+        flecs_table_permute_swap(world, table, rows, count);
+        return;
+    }
+
+    /* Like flecs_table_swap, elements are relocated with memcpy */
+    ecs_type_info_t **type_info = table->type_info;
+    int32_t column_count = table->storage_count;
+    int32_t elem_size = ECS_SIZEOF(ecs_record_t*);
+    for (i = 0; i < column_count; i ++) {
+        elem_size = ECS_MAX(elem_size, type_info[i]->size);
+    }
+
+    flecs_table_mark_table_dirty(world, table, 0);
+
+    /* Gather each column into a temporary buffer in the new order. This moves
+     * every element once, where swapping moves it up to three times and has
+     * to update the records of both entities each time */
+    void *tmp = ecs_os_malloc(elem_size * count);
+    ecs_data_t *data = &table->data;
+    ecs_entity_t *entities = data->entities.array;
+    ecs_record_t **records = data->records.array;
+
+    ecs_entity_t *tmp_entities = tmp;
+    for (i = 0; i < count; i ++) {
+        tmp_entities[i] = entities[rows[i]];
+    }
+    ecs_os_memcpy_n(entities, tmp_entities, ecs_entity_t, count);
+
+    ecs_record_t **tmp_records = tmp;
+    for (i = 0; i < count; i ++) {
+        ecs_record_t *r = records[rows[i]];
+        r->row = ECS_ROW_TO_RECORD(i, ECS_RECORD_TO_ROW_FLAGS(r->row));
+        tmp_records[i] = r;
+    }
+    ecs_os_memcpy_n(records, tmp_records, ecs_record_t*, count);
+
+    int32_t c;
+    for (c = 0; c < column_count; c ++) {
+        int32_t size = type_info[c]->size;
+        void *ptr = data->columns[c].array;
+        for (i = 0; i < count; i ++) {
+            ecs_os_memcpy(ECS_ELEM(tmp, size, i), 
+                ECS_ELEM(ptr, size, rows[i]), size);
+        }
+        ecs_os_memcpy(ptr, tmp, size * count);
+    }
+
+    ecs_os_free(tmp);
+
+    flecs_table_check_sanity(table);
+}
+
 static
 void flecs_merge_column(
     ecs_world_t *world,
@@ -4555,7 +4834,8 @@ void flecs_merge_column(
 {
     int32_t dst_count = dst->count;
 
-    if (!dst_count) {
+    /* Take over the src buffer unless dst has enough storage (reserved) */
+    if (!dst_count && dst->size < src->count) {
         ecs_vec_fini(&world->allocator, dst, size);
         *dst = *src;
         src->array = NULL;
@@ -4624,6 +4904,12 @@ void flecs_merge_table_data(
         return;
     }
 
+    /* Grow destination storage up front so the columns only need to copy */
+    if (dst_count) {
+        flecs_table_ensure_size(world, dst_table, dst_data, 
+            src_count + dst_count);
+    }
+
     /* Merge entities */
     flecs_merge_column(world, &dst_data->entities, &src_data->entities, 
         ECS_SIZEOF(ecs_entity_t), 0, NULL);
@@ -5866,6 +6152,10 @@ void flecs_notify_on_add(
 {
     ecs_assert(added != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (flags & EcsEventNoOnAdd) {
+        return;
+    }
+
     if (added->count) {
         ecs_flags32_t table_flags = table->flags;
 
@@ -6203,6 +6493,27 @@ const ecs_entity_t* flecs_bulk_new(
         flecs_notify_on_set(world, table, row, count, NULL, true);
     }
 
+#ifdef FLECS_JOURNAL
+    if (world->journal) {
+        /* Entity by entity, then value by value, so each ends up in one
+         * journal record */
+        ecs_entity_t *created = ecs_vec_get_t(
+            &data->entities, ecs_entity_t, row);
+        for (i = 0; i < count; i ++) {
+            flecs_journal(world, EcsJournalMove, created[i], 
+                &diff->added, NULL);
+        }
+        if (component_data) {
+            for (i = 0; i < component_ids->count; i ++) {
+                if (component_data[i]) {
+                    flecs_journal_set_range(world, table, row, count, 
+                        component_ids->array[i]);
+                }
+            }
+        }
+    }
+#endif
+
     flecs_defer_end(world, &world->stages[0]);
 
     if (row_out) {
@@ -6447,7 +6758,7 @@ bool ecs_commit(
         diff.added = *added;
     }
     if (removed) {
-        diff.added = *removed;
+        diff.removed = *removed;
     }
     
     flecs_commit(world, entity, record, table, &diff, true, 0);
@@ -6512,6 +6823,14 @@ ecs_entity_t ecs_new_id(
         ecs_entity_t_lo(entity) <= unsafe_world->info.max_id, 
         ECS_OUT_OF_RANGE, NULL);
 
+    /* Lets a delete in the same batch drop the commands for the entity. Not
+     * done on the main stage while other threads may be using it. */
+    if (ecs_poly_is(world, ecs_stage_t) || 
+        !(unsafe_world->flags & EcsWorldMultiThreaded)) 
+    {
+        flecs_defer_new_entity((ecs_stage_t*)stage, entity);
+    }
+
     flecs_journal(world, EcsJournalNew, entity, 0, 0);
 
     return entity;
@@ -6604,6 +6923,7 @@ ecs_entity_t ecs_new_w_id(
         ecs_table_diff_t table_diff;
         flecs_table_diff_build_noalloc(&diff, &table_diff);
         ecs_record_t *r = flecs_entities_get(world, entity);
+        flecs_journal(world, EcsJournalMove, entity, &table_diff.added, NULL);
         flecs_new_entity(world, entity, r, table, &table_diff, true, true);
         flecs_table_diff_builder_fini(world, &diff);
     } else {
@@ -7258,6 +7578,8 @@ void ecs_clear(
 
     ecs_table_t *table = r->table;
     if (table) {
+        flecs_journal_begin(world, EcsJournalClear, entity, NULL, NULL);
+
         ecs_table_diff_t diff = {
             .removed = table->type
         };
@@ -7268,6 +7590,8 @@ void ecs_clear(
         if (r->row & EcsEntityObservedAcyclic) {
             flecs_table_observer_add(table, -1);
         }
+
+        flecs_journal_end();
     }    
 
     flecs_defer_end(world, stage);
@@ -7718,13 +8042,13 @@ void ecs_delete_with(
     ecs_world_t *world,
     ecs_id_t id)
 {
-    flecs_journal_begin(world, EcsJournalDeleteWith, id, NULL, NULL);
-
     ecs_stage_t *stage = flecs_stage_from_world(&world);
     if (flecs_defer_on_delete_action(stage, id, EcsDelete)) {
         return;
     }
 
+    flecs_journal_begin(world, EcsJournalDeleteWith, id, NULL, NULL);
+
     flecs_on_delete(world, id, EcsDelete, false);
     flecs_defer_end(world, stage);
 
@@ -7735,13 +8059,13 @@ void ecs_remove_all(
     ecs_world_t *world,
     ecs_id_t id)
 {
-    flecs_journal_begin(world, EcsJournalRemoveAll, id, NULL, NULL);
-
     ecs_stage_t *stage = flecs_stage_from_world(&world);
     if (flecs_defer_on_delete_action(stage, id, EcsRemove)) {
         return;
     }
 
+    flecs_journal_begin(world, EcsJournalRemoveAll, id, NULL, NULL);
+
     flecs_on_delete(world, id, EcsRemove, false);
     flecs_defer_end(world, stage);
 
@@ -7877,6 +8201,7 @@ ecs_entity_t ecs_clone(
     ecs_type_t src_type = src_table->type;
     ecs_table_diff_t diff = { .added = src_type };
     ecs_record_t *dst_r = flecs_entities_get(world, dst);
+    flecs_journal(world, EcsJournalMove, dst, &diff.added, NULL);
     flecs_new_entity(world, dst, dst_r, src_table, &diff, true, true);
     int32_t row = ECS_RECORD_TO_ROW(dst_r->row);
 
@@ -7884,6 +8209,12 @@ ecs_entity_t ecs_clone(
         flecs_table_move(world, dst, src, src_table,
             row, src_table, ECS_RECORD_TO_ROW(src_r->row), true);
         flecs_notify_on_set(world, src_table, row, 1, NULL, true);
+#ifdef FLECS_JOURNAL
+        int32_t i;
+        for (i = 0; i < src_type.count; i ++) {
+            flecs_journal_set(world, dst, src_type.array[i]);
+        }
+#endif
     }
 
 done:
@@ -8203,7 +8534,7 @@ void flecs_modified_id_if(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
-    if (!flecs_table_record_get(world, table, id)) {
+    if (!table || !flecs_table_record_get(world, table, id)) {
         flecs_defer_end(world, stage);
         return;
     }
@@ -8212,6 +8543,7 @@ void flecs_modified_id_if(
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
     flecs_table_mark_dirty(world, table, id);
+    flecs_journal_set(world, entity, id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -8244,6 +8576,7 @@ void ecs_modified_id(
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
     flecs_table_mark_dirty(world, table, id);
+    flecs_journal_set(world, entity, id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -8289,6 +8622,7 @@ void flecs_copy_ptr_w_id(
             world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
     }
 
+    flecs_journal_set(world, entity, id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -8330,6 +8664,7 @@ void flecs_move_ptr_w_id(
 
     flecs_table_mark_dirty(world, r->table, id);
 
+    /* Mut and Emplace are followed by a Modified, which is journaled */
     if (cmd_kind == EcsOpSet) {
         ecs_table_t *table = r->table;
         if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
@@ -8337,6 +8672,7 @@ void flecs_move_ptr_w_id(
             flecs_notify_on_set(
                 world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
         }
+        flecs_journal_set(world, entity, id);
     }
 
     flecs_defer_end(world, stage);
@@ -9380,6 +9716,83 @@ bool flecs_remove_invalid(
     return true;
 }
 
+/* Skip earlier commands for an entity that set the same id as the command at
+ * cur, as only the last value is visible after the merge. Skipped commands are
+ * discarded (their values destructed) by the merge loop. */
+static
+void flecs_cmd_collapse(
+    ecs_cmd_t *cmds,
+    int32_t start,
+    int32_t cur,
+    ecs_cmd_kind_t kind)
+{
+    ecs_id_t id = cmds[cur].id;
+    int32_t prev = start;
+    while (prev != cur) {
+        ecs_cmd_t *cmd = &cmds[prev];
+        int32_t next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        if (cmd->id == id) {
+            ecs_cmd_kind_t prev_kind = cmd->kind;
+            if (kind == EcsOpSet) {
+                if (prev_kind == EcsOpSet || prev_kind == EcsOpMut) {
+                    cmd->kind = EcsOpSkip;
+                }
+            } else if (prev_kind == kind) {
+                cmd->kind = EcsOpSkip;
+            }
+        }
+        prev = next_for_entity;
+    }
+}
+
+/* Remove ids from the diff that were added and then removed again before the
+ * merge, like a tag that only exists for a frame. The entity didn't have those
+ * ids before and won't have them after, so no events are emitted for them. Ids
+ * that were removed and then added again are kept, as that resets the value
+ * of (for example) an overridden component. */
+static
+void flecs_cmd_diff_collapse(
+    const ecs_world_t *world,
+    ecs_table_diff_builder_t *diff,
+    const ecs_table_t *src_table)
+{
+    int32_t added_count = ecs_vec_count(&diff->added);
+    int32_t removed_count = ecs_vec_count(&diff->removed);
+    if (!added_count || !removed_count) {
+        return;
+    }
+
+    ecs_id_t *added = ecs_vec_first_t(&diff->added, ecs_id_t);
+    ecs_id_t *removed = ecs_vec_first_t(&diff->removed, ecs_id_t);
+    int32_t i = 0, j;
+    while (i < removed_count) {
+        for (j = 0; j < added_count; j ++) {
+            if (added[j] == removed[i]) {
+                break;
+            }
+        }
+        if (j == added_count || (src_table && 
+            ecs_search(world, src_table, removed[i], NULL) != -1)) 
+        {
+            i ++;
+            continue;
+        }
+
+        added_count --;
+        removed_count --;
+        ecs_os_memmove(&added[j], &added[j + 1], 
+            (added_count - j) * ECS_SIZEOF(ecs_id_t));
+        ecs_os_memmove(&removed[i], &removed[i + 1], 
+            (removed_count - i) * ECS_SIZEOF(ecs_id_t));
+    }
+
+    diff->added.count = added_count;
+    diff->removed.count = removed_count;
+}
+
 static
 void flecs_cmd_batch_for_entity(
     ecs_world_t *world,
@@ -9437,6 +9850,7 @@ void flecs_cmd_batch_for_entity(
             /* Add is batched, but keep Modified */
             cmd->kind = EcsOpModified;
             kind = EcsOpAdd;
+            flecs_cmd_collapse(cmds, start, cur, EcsOpModified);
 
             /* fallthrough */
         case EcsOpAdd:
@@ -9444,6 +9858,8 @@ void flecs_cmd_batch_for_entity(
             world->info.cmd.batched_command_count ++;
             break;
         case EcsOpSet:
+            flecs_cmd_collapse(cmds, start, cur, EcsOpSet);
+            /* fallthrough */
         case EcsOpMut:
             table = flecs_find_table_add(world, table, id, diff);
             world->info.cmd.batched_command_count ++;
@@ -9473,6 +9889,8 @@ void flecs_cmd_batch_for_entity(
     } while ((cur = next_for_entity));
 
     /* Move entity to destination table in single operation */
+    bool has_remove = ecs_vec_count(&diff->removed) != 0;
+    flecs_cmd_diff_collapse(world, diff, r ? r->table : NULL);
     flecs_table_diff_build_noalloc(diff, &table_diff);
     flecs_defer_begin(world, &world->stages[0]);
     flecs_commit(world, entity, r, table, &table_diff, true, 0);
@@ -9482,7 +9900,7 @@ void flecs_cmd_batch_for_entity(
     /* If ids were both removed and set, check if there are ids that were both
      * set and removed. If so, skip the set command so that the id won't get
      * re-added */
-    if (has_set && table_diff.removed.count) {
+    if (has_set && has_remove) {
         cur = start;
         do {
             cmd = &cmds[cur];
@@ -9513,6 +9931,419 @@ void flecs_cmd_batch_for_entity(
     }
 }
 
+/* Return the number of commands for an entity if they are stored next to each
+ * other in the queue and only add, set or mark components modified, or 0 if
+ * not. Modified commands aren't linked with the other commands of an entity,
+ * which is why the commands are found by scanning ahead. */
+static
+int32_t flecs_cmd_run_len(
+    ecs_cmd_t *cmds,
+    int32_t first,
+    int32_t count)
+{
+    if (cmds[first].next_for_entity >= 0) {
+        return 0; /* Not the first of multiple commands for an entity */
+    }
+
+    ecs_entity_t e = cmds[first].entity;
+    int32_t cur, end, linked = 0;
+    for (end = first; end < count && cmds[end].entity == e; end ++) {
+        ecs_cmd_kind_t kind = cmds[end].kind;
+        if (kind == EcsOpModified) {
+            continue;
+        }
+        if (kind != EcsOpAdd && kind != EcsOpSet && kind != EcsOpMut) {
+            return 0;
+        }
+        linked ++;
+    }
+
+    /* All linked commands for the entity must be in the range */
+    cur = first;
+    do {
+        int32_t next_for_entity = cmds[cur].next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        linked --;
+        if (!next_for_entity) {
+            break;
+        }
+        if (next_for_entity <= cur || next_for_entity >= end) {
+            return 0;
+        }
+        cur = next_for_entity;
+    } while (true);
+
+    if (linked) {
+        return 0;
+    }
+
+    return end - first;
+}
+
+/* Merge the commands of a run of entities that were queued one after another
+ * with the same commands, and that are in the same table, like a burst of
+ * instances created from a prefab. All entities are moved to the destination
+ * table first, after which OnAdd and OnSet are emitted once for the range of
+ * rows instead of once per entity. Returns the number of merged commands, or 0
+ * if the commands at start don't begin a run. */
+static
+int32_t flecs_cmd_batch_for_run(
+    ecs_world_t *world,
+    ecs_table_diff_builder_t *diff,
+    ecs_cmd_t *cmds,
+    int32_t start,
+    int32_t count)
+{
+    int32_t len = flecs_cmd_run_len(cmds, start, count);
+    if (!len) {
+        return 0;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, cmds[start].entity);
+    if (!r) {
+        return 0;
+    }
+
+    /* Find entities with the same commands that follow the first one */
+    ecs_table_t *src_table = r->table;
+    int32_t i, entity_count = 1, cur = start + len;
+    while ((cur + len) <= count) {
+        ecs_entity_t e = cmds[cur].entity;
+        if (flecs_cmd_run_len(cmds, cur, count) != len) {
+            break;
+        }
+        if (!flecs_entities_is_valid(world, e)) {
+            break;
+        }
+        ecs_record_t *er = flecs_entities_get(world, e);
+        if (!er || er->table != src_table) {
+            break;
+        }
+        for (i = 0; i < len; i ++) {
+            ecs_cmd_t *cmd = &cmds[cur + i], *first = &cmds[start + i];
+            if (cmd->kind != first->kind || cmd->id != first->id) {
+                break;
+            }
+        }
+        if (i != len) {
+            break;
+        }
+        entity_count ++;
+        cur += len;
+    }
+
+    if (entity_count < 2) {
+        return 0;
+    }
+
+    /* Find the destination table. Skip runs that remove ids, as OnRemove would
+     * have to be emitted for rows that aren't next to each other. */
+    ecs_table_t *table = src_table;
+    int32_t value_count = 0, modified_count = 0;
+    for (i = 0; i < len; i ++) {
+        ecs_cmd_t *cmd = &cmds[start + i];
+        if (cmd->kind == EcsOpModified) {
+            modified_count ++;
+            continue;
+        }
+
+        ecs_id_t id = cmd->id;
+        if (!flecs_remove_invalid(world, id, &id) || (id != cmd->id)) {
+            goto skip;
+        }
+        table = flecs_find_table_add(world, table, id, diff);
+        value_count += cmd->kind != EcsOpAdd;
+    }
+
+    ecs_table_diff_t table_diff;
+    flecs_table_diff_build_noalloc(diff, &table_diff);
+    if (table == src_table || !table->type.count || table_diff.removed.count) {
+        goto skip;
+    }
+
+    for (i = 0; i < len; i ++) {
+        ecs_cmd_t *cmd = &cmds[start + i];
+        if (cmd->kind != EcsOpAdd) {
+            if (!table->storage_table || !flecs_table_record_get(
+                world, table->storage_table, cmd->id)) 
+            {
+                goto skip;
+            }
+        }
+    }
+
+    /* Move entities without notifying, so that they end up in adjacent rows */
+    int32_t row = ecs_table_count(table);
+    for (i = 0; i < entity_count; i ++) {
+        ecs_entity_t e = cmds[start + i * len].entity;
+        ecs_record_t *er = flecs_entities_get(world, e);
+        flecs_commit(world, e, er, table, &table_diff, true, EcsEventNoOnAdd);
+        ecs_assert(er->table == table, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(ECS_RECORD_TO_ROW(er->row) == (row + i), 
+            ECS_INTERNAL_ERROR, NULL);
+    }
+
+    world->info.cmd.batched_entity_count += entity_count;
+    world->info.cmd.batched_command_count += 
+        (len - modified_count) * entity_count;
+
+    ecs_stage_t *stage = &world->stages[0];
+    flecs_defer_begin(world, stage);
+    flecs_notify_on_add(world, table, src_table, row, entity_count, 
+        &table_diff.added, 0);
+    flecs_defer_end(world, stage);
+    flecs_table_diff_builder_clear(diff);
+
+    if (!value_count && !modified_count) {
+        return len * entity_count;
+    }
+
+    /* Observers for OnAdd could have changed the entities, in which case the
+     * values are assigned one entity at a time. */
+    bool in_place = true;
+    for (i = 0; i < entity_count; i ++) {
+        ecs_entity_t e = cmds[start + i * len].entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            in_place = false;
+            break;
+        }
+        ecs_record_t *er = flecs_entities_get(world, e);
+        if (er->table != table || ECS_RECORD_TO_ROW(er->row) != (row + i)) {
+            in_place = false;
+            break;
+        }
+    }
+
+    for (cur = start; cur < (start + len * entity_count); cur ++) {
+        ecs_cmd_t *cmd = &cmds[cur];
+        ecs_cmd_kind_t kind = cmd->kind;
+        if (kind == EcsOpAdd) {
+            continue;
+        }
+
+        ecs_entity_t e = cmd->entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            world->info.cmd.discard_count ++;
+            flecs_discard_cmd(world, cmd);
+            continue;
+        }
+
+        if (kind == EcsOpModified) {
+            if (!in_place) {
+                flecs_modified_id_if(world, e, cmd->id);
+            }
+            world->info.cmd.modified_count ++;
+            continue;
+        }
+
+        if (kind == EcsOpSet) {
+            world->info.cmd.set_count ++;
+        } else {
+            world->info.cmd.get_mut_count ++;
+        }
+
+        void *value = cmd->is._1.value;
+        ecs_size_t size = cmd->is._1.size;
+        if (!in_place) {
+            flecs_move_ptr_w_id(world, stage, e, cmd->id, 
+                flecs_itosize(size), value, kind);
+        } else {
+            const ecs_table_record_t *tr = flecs_table_record_get(
+                world, table->storage_table, cmd->id);
+            int32_t column = tr->column;
+            const ecs_type_info_t *ti = table->type_info[column];
+            void *ptr = ecs_vec_get(&table->data.columns[column], ti->size, 
+                row + (cur - start) / len);
+            ecs_move_t move = ti->hooks.move;
+            if (move) {
+                move(ptr, value, 1, ti);
+            } else {
+                ecs_os_memcpy(ptr, value, size);
+            }
+        }
+        flecs_stack_free(value, size);
+    }
+
+    if (in_place) {
+        flecs_defer_begin(world, stage);
+        for (i = 0; i < len; i ++) {
+            ecs_cmd_t *cmd = &cmds[start + i];
+            if (cmd->kind != EcsOpSet && cmd->kind != EcsOpModified) {
+                continue;
+            }
+
+            /* Emit once for ids that were set more than once */
+            int32_t j;
+            for (j = 0; j < i; j ++) {
+                ecs_cmd_t *prev = &cmds[start + j];
+                if (prev->id == cmd->id && (prev->kind == EcsOpSet || 
+                    prev->kind == EcsOpModified)) 
+                {
+                    break;
+                }
+            }
+            if (j != i) {
+                continue;
+            }
+
+            ecs_type_t ids = { .array = &cmd->id, .count = 1 };
+            flecs_notify_on_set(world, table, row, entity_count, &ids, true);
+            flecs_table_mark_dirty(world, table, cmd->id);
+
+            flecs_journal_set_range(world, table, row, entity_count, cmd->id);
+        }
+        flecs_defer_end(world, stage);
+    }
+
+    return len * entity_count;
+skip:
+    flecs_table_diff_builder_clear(diff);
+    return 0;
+}
+
+/* Delete entities that are stored in the same table. If the table has remove
+ * actions, the entities are first swapped to the last rows of the table so that
+ * OnRemove is emitted once for all of them. */
+static
+void flecs_cmd_delete_w_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_cmd_t *cmds,
+    int32_t count)
+{
+    ecs_stage_t *stage = &world->stages[0];
+    int32_t i;
+
+    for (i = 0; i < count; i ++) {
+        flecs_journal(world, EcsJournalDelete, cmds[i].entity, NULL, NULL);
+    }
+
+    flecs_defer_begin(world, stage);
+    if (table->flags & (EcsTableHasOnRemove|EcsTableHasUnSet|EcsTableHasIsA|
+        EcsTableHasObserved)) 
+    {
+        int32_t last = ecs_table_count(table);
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, cmds[i].entity);
+            flecs_table_swap(world, table, ECS_RECORD_TO_ROW(r->row), -- last);
+        }
+
+        flecs_notify_on_remove(world, table, NULL, last, count, &table->type);
+        for (i = last + count - 1; i >= last; i --) {
+            flecs_table_delete(world, table, i, true);
+        }
+    } else {
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, cmds[i].entity);
+            flecs_table_delete(world, table, ECS_RECORD_TO_ROW(r->row), true);
+        }
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = cmds[i].entity;
+        ecs_record_t *r = flecs_entities_get(world, e);
+        r->row = 0;
+        r->table = NULL;
+        flecs_entities_remove(world, e);
+    }
+
+    world->info.cmd.delete_count += count;
+    flecs_defer_end(world, stage);
+}
+
+/* Merge a run of delete commands, like the ones queued by a system that
+ * destructs expired bullets. Entities that are used as an id or relationship
+ * target are deleted one at a time, as their cleanup can delete or move other
+ * entities. The others are grouped by table and removed from their table
+ * together. Returns the number of merged commands, or 0 if the command at
+ * start doesn't begin a run. */
+static
+int32_t flecs_cmd_delete_run(
+    ecs_world_t *world,
+    ecs_cmd_t *cmds,
+    int32_t start,
+    int32_t count)
+{
+    int32_t i, j, end;
+    for (end = start; end < count; end ++) {
+        if (cmds[end].kind != EcsOpDelete) {
+            break;
+        }
+    }
+
+    if ((end - start) < 2) {
+        return 0;
+    }
+
+    for (i = start; i < end; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        ecs_entity_t e = cmd->entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            world->info.cmd.discard_count ++;
+            cmd->kind = EcsOpSkip;
+            continue;
+        }
+
+        ecs_record_t *r = flecs_entities_get(world, e);
+        if (!r->table || ECS_RECORD_TO_ROW_FLAGS(r->row)) {
+            ecs_delete(world, e);
+            world->info.cmd.delete_count ++;
+            cmd->kind = EcsOpSkip;
+        }
+    }
+
+    /* Deleting one group can run observers that delete or move entities of
+     * the next, which is why each group is collected right before deleting */
+    for (i = start; i < end; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        if (cmd->kind == EcsOpSkip) {
+            continue;
+        }
+
+        ecs_entity_t e = cmd->entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            world->info.cmd.discard_count ++;
+            continue;
+        }
+
+        ecs_table_t *table = flecs_entities_get(world, e)->table;
+        int32_t group_end = i + 1;
+        for (j = i + 1; j < end; j ++) {
+            ecs_cmd_t *other = &cmds[j];
+            if (other->kind == EcsOpSkip) {
+                continue;
+            }
+            if (!flecs_entities_is_valid(world, other->entity)) {
+                continue;
+            }
+            if (flecs_entities_get(world, other->entity)->table != table) {
+                continue;
+            }
+
+            /* Commands in a run only differ by entity, swap them to group */
+            ecs_cmd_t tmp = cmds[group_end];
+            cmds[group_end] = *other;
+            *other = tmp;
+            group_end ++;
+        }
+
+        if (table) {
+            flecs_cmd_delete_w_table(world, table, cmd, group_end - i);
+        } else {
+            for (j = i; j < group_end; j ++) {
+                ecs_delete(world, cmds[j].entity);
+                world->info.cmd.delete_count ++;
+            }
+        }
+
+        i = group_end - 1;
+    }
+
+    return end - start;
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool flecs_defer_end(
     ecs_world_t *world,
@@ -9564,6 +10395,12 @@ bool flecs_defer_end(
                 if (merge_to_world && (cmd->next_for_entity < 0)) {
                     /* Batch commands for entity to limit archetype moves */
                     if (is_alive) {
+                        int32_t merged = flecs_cmd_batch_for_run(
+                            world, &diff, cmds, i, count);
+                        if (merged) {
+                            i += merged - 1;
+                            continue;
+                        }
                         flecs_cmd_batch_for_entity(world, &diff, e, cmds, i);
                     } else {
                         world->info.cmd.discard_count ++;
@@ -9580,6 +10417,15 @@ bool flecs_defer_end(
                     continue;
                 }
 
+                if (merge_to_world && (kind == EcsOpDelete)) {
+                    int32_t merged = flecs_cmd_delete_run(
+                        world, cmds, i, count);
+                    if (merged) {
+                        i += merged - 1;
+                        continue;
+                    }
+                }
+
                 ecs_id_t id = cmd->id;
 
                 switch(kind) {
@@ -9645,7 +10491,11 @@ bool flecs_defer_end(
                     world->info.cmd.clear_count ++;
                     break;
                 case EcsOpOnDeleteAction:
+                    flecs_journal_begin(world, e == EcsDelete ? 
+                        EcsJournalDeleteWith : EcsJournalRemoveAll, 
+                        id, NULL, NULL);
                     flecs_on_delete(world, id, e, false);
+                    flecs_journal_end();
                     world->info.cmd.other_count ++;
                     break;
                 case EcsOpEnable:
@@ -9749,6 +10599,30 @@ ecs_cmd_t* flecs_cmd_alloc(
     return cmd;
 }
 
+/* Commands queued for an entity that is created and deleted in the same batch
+ * have no visible effect. Skip them, so that the merge doesn't create the
+ * entity in a table right before deleting it. Entities that existed before the
+ * batch keep their commands, so observers still see e.g. OnSet before the
+ * entity is deleted. */
+static
+void flecs_cmd_skip_for_entity(
+    ecs_vec_t *cmds,
+    int32_t first)
+{
+    ecs_cmd_t *arr = ecs_vec_first_t(cmds, ecs_cmd_t);
+    int32_t cur = first;
+    do {
+        ecs_cmd_t *cmd = &arr[cur];
+        int32_t next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        cmd->kind = EcsOpSkip;
+        cmd->next_for_entity = 0;
+        cur = next_for_entity;
+    } while (cur);
+}
+
 static
 ecs_cmd_t* flecs_cmd_new(
     ecs_stage_t *stage, 
@@ -9768,7 +10642,10 @@ ecs_cmd_t* flecs_cmd_new(
                 return NULL;
             }
 
-            if (can_batch) {
+            if (can_batch && entry->first == -1) {
+                /* First command for an entity created in this batch */
+                entry->first = cur;
+            } else if (can_batch) {
                 ecs_cmd_t *arr = ecs_vec_first_t(cmds, ecs_cmd_t);
                 ecs_assert(arr[last].entity == e, ECS_INTERNAL_ERROR, NULL);
                 ecs_cmd_t *last_op = &arr[last];
@@ -9778,11 +10655,14 @@ ecs_cmd_t* flecs_cmd_new(
                      * is the first for an entity */
                     last_op->next_for_entity *= -1;
                 }
+            } else if (is_delete && entry->is_new && entry->first != -1) {
+                flecs_cmd_skip_for_entity(cmds, entry->first);
             }
         } else if (can_batch || is_delete) {
             entry = flecs_sparse_ensure_t(&stage->cmd_entries, 
                 ecs_cmd_entry_t, e);
             entry->first = cur;
+            entry->is_new = false;
         }
         if (can_batch) {
             entry->last = cur;
@@ -9889,6 +10769,19 @@ bool flecs_defer_cmd(
     return false;
 }
 
+void flecs_defer_new_entity(
+    ecs_stage_t *stage,
+    ecs_entity_t entity)
+{
+    if (stage->defer > 0) {
+        ecs_cmd_entry_t *entry = flecs_sparse_ensure_t(
+            &stage->cmd_entries, ecs_cmd_entry_t, entity);
+        entry->first = -1; /* No commands queued yet */
+        entry->last = 0;
+        entry->is_new = true;
+    }
+}
+
 bool flecs_defer_modified(
     ecs_stage_t *stage,
     ecs_entity_t entity,
@@ -13215,6 +14108,9 @@ error:
 #define EXP_THRESHOLD   (3)
 #define INT64_MAX_F ((double)INT64_MAX)
 
+/* Largest double below which every integer is exactly representable (2^53) */
+#define EXACT_INT_MAX_F (9007199254740992.0)
+
 static const double rounders[MAX_PRECISION + 1] =
 {
 	0.5,				// 0
@@ -13230,75 +14126,96 @@ static const double rounders[MAX_PRECISION + 1] =
 	0.00000000005		// 10
 };
 
-static
-char* flecs_strbuf_itoa(
+static const uint64_t powers_of_10[MAX_PRECISION + 1] =
+{
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 
+    10000000ull, 100000000ull, 1000000000ull, 10000000000ull
+};
+
+/* Two digits at a time halves the number of divisions when converting
+ * integers, the same table trick Ryu and Grisu use to print their digits. */
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* Write the last 'count' digits of v, with leading zeros, ending at end */
+static
+void flecs_strbuf_digits(
+    char *end,
+    uint64_t v,
+    int32_t count)
+{
+    while (count >= 2) {
+        uint64_t pair = (v % 100) * 2;
+        v /= 100;
+        end -= 2;
+        end[0] = digit_pairs[pair];
+        end[1] = digit_pairs[pair + 1];
+        count -= 2;
+    }
+    if (count) {
+        end[-1] = (char)('0' + (v % 10));
+    }
+}
+
+char* flecs_utoa(
     char *buf,
-    int64_t v)
+    uint64_t v)
 {
-    char *ptr = buf;
-    char * p1;
-	char c;
+    int32_t count = 1;
+    uint64_t t = v;
+    while (t >= 10) {
+        t /= 10;
+        count ++;
+    }
 
-	if (!v) {
-		*ptr++ = '0';
-    } else {
-        if (v < 0) {
-            ptr[0] = '-';
-            ptr ++;
-            v *= -1;
-        }
-
-		char *p = ptr;
-		while (v) {
-            int64_t vdiv = v / 10;
-            int64_t vmod = v - (vdiv * 10);
-			p[0] = (char)('0' + vmod);
-            p ++;
-			v = vdiv;
-		}
-
-		p1 = p;
-
-		while (p > ptr) {
-			c = *--p;
-			*p = *ptr;
-			*ptr++ = c;
-		}
-		ptr = p1;
-	}
-    return ptr;
+    flecs_strbuf_digits(buf + count, v, count);
+    return buf + count;
 }
 
-static
-int flecs_strbuf_ftoa(
-    ecs_strbuf_t *out, 
+char* flecs_itoa(
+    char *buf,
+    int64_t v)
+{
+    if (v < 0) {
+        *buf++ = '-';
+        /* Negate as unsigned so that INT64_MIN doesn't overflow */
+        return flecs_utoa(buf, 0 - (uint64_t)v);
+    }
+    return flecs_utoa(buf, (uint64_t)v);
+}
+
+int32_t flecs_ftoa(
+    char *buf,
     double f, 
-    int precision,
+    int32_t precision,
     char nan_delim)
 {
-    char buf[64];
 	char * ptr = buf;
 	char c;
 	int64_t intPart;
     int64_t exp = 0;
 
-    if (isnan(f)) {
+    if (isnan(f) || isinf(f)) {
+        const char *str = isnan(f) ? "NaN" : "Inf";
         if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "NaN");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "NaN");
+            *ptr++ = nan_delim;
         }
-    }
-    if (isinf(f)) {
+        ecs_os_memcpy(ptr, str, 3);
+        ptr += 3;
         if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "Inf");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "Inf");
+            *ptr++ = nan_delim;
         }
+        *ptr = '\0';
+        return (int32_t)(ptr - buf);
     }
 
 	if (precision > MAX_PRECISION) {
@@ -13320,30 +14237,54 @@ int flecs_strbuf_ftoa(
 		else precision = 0;
 	}
 
-	if (precision) {
-		f += rounders[precision];
-    }
+    if (f * (double)powers_of_10[precision] < EXACT_INT_MAX_F) {
+        /* Scale the fraction so that the digits after the dot become an
+         * integer. Rounding the scaled fraction is the same as adding the
+         * rounder, and the digits no longer depend on repeated (inexact)
+         * multiplications. Only done while the scaled number is below 2^53,
+         * above that a double can't hold every integer and the scaled value
+         * would lose the low digits. The integer part is split off first
+         * (exactly), so only the fraction goes through the multiplication. */
+        uint64_t scale = powers_of_10[precision];
+        uint64_t int_v = (uint64_t)f;
+        uint64_t frac_v = (uint64_t)((f - (double)int_v) * (double)scale + 0.5);
+        if (frac_v >= scale) {
+            frac_v -= scale;
+            int_v ++;
+        }
 
-    /* Make sure that number can be represented as 64bit int, increase exp */
-    while (f > INT64_MAX_F) {
-        f /= 1000 * 1000 * 1000;
-        exp += 9;
-    }
+        ptr = flecs_utoa(ptr, int_v);
+        if (precision) {
+            *ptr++ = '.';
+            flecs_strbuf_digits(ptr + precision, frac_v, precision);
+            ptr += precision;
+        }
+    } else {
+        if (precision) {
+            f += rounders[precision];
+        }
+
+        /* Make sure that number can be represented as 64bit int, increase exp */
+        while (f > INT64_MAX_F) {
+            f /= 1000 * 1000 * 1000;
+            exp += 9;
+        }
 
-	intPart = (int64_t)f;
-	f -= (double)intPart;
+        intPart = (int64_t)f;
+        f -= (double)intPart;
 
-    ptr = flecs_strbuf_itoa(ptr, intPart);
+        ptr = flecs_itoa(ptr, intPart);
 
-	if (precision) {
-		*ptr++ = '.';
-		while (precision--) {
-			f *= 10.0;
-			c = (char)f;
-			*ptr++ = (char)('0' + c);
-			f -= c;
-		}
-	}
+        if (precision) {
+            *ptr++ = '.';
+            while (precision--) {
+                f *= 10.0;
+                c = (char)f;
+                *ptr++ = (char)('0' + c);
+                f -= c;
+            }
+        }
+    }
 	*ptr = 0;
 
     /* Remove trailing 0s */
@@ -13395,7 +14336,7 @@ int flecs_strbuf_ftoa(
 
 
         ptr[0] = 'e';
-        ptr = flecs_strbuf_itoa(ptr + 1, exp);
+        ptr = flecs_itoa(ptr + 1, exp);
 
         if (nan_delim) {
             ptr[0] = nan_delim;
@@ -13405,7 +14346,7 @@ int flecs_strbuf_ftoa(
         ptr[0] = '\0';
     }
     
-    return ecs_strbuf_appendstrn(out, buf, (int32_t)(ptr - buf));
+    return (int32_t)(ptr - buf);
 }
 
 /* Add an extra element to the buffer */
@@ -13580,8 +14521,8 @@ bool flecs_strbuf_appendstr(
 
     int32_t memLeftInElement = flecs_strbuf_memLeftInCurrentElement(b);
     int32_t memLeft = flecs_strbuf_memLeft(b);
-    if (memLeft <= 0) {
-        return false;
+    if (memLeft <= 0 || n <= 0) {
+        return memLeft > 0;
     }
 
     /* Never write more than what the buffer can store */
@@ -13589,12 +14530,19 @@ bool flecs_strbuf_appendstr(
         n = memLeft;
     }
 
+    /* An element is never filled past its size. Clamped anyway so that the
+     * copy sizes below are provably in range, also when asserts are off. */
+    if (memLeftInElement < 0) {
+        memLeftInElement = 0;
+    }
+
+    /* str does not have to be terminated after n, copy exactly n chars */
     if (n <= memLeftInElement) {
         /* Element was large enough to fit string */
-        ecs_os_strncpy(flecs_strbuf_ptr(b), str, n);
+        ecs_os_memcpy(flecs_strbuf_ptr(b), str, n);
         b->current->pos += n;
     } else if ((n - memLeftInElement) < memLeft) {
-        ecs_os_strncpy(flecs_strbuf_ptr(b), str, memLeftInElement);
+        ecs_os_memcpy(flecs_strbuf_ptr(b), str, memLeftInElement);
 
         /* Element was not large enough, but buffer still has space */
         b->current->pos += memLeftInElement;
@@ -13606,22 +14554,15 @@ bool flecs_strbuf_appendstr(
             flecs_strbuf_grow(b);
 
             /* Copy the remainder to the new buffer */
-            if (n) {
-                /* If a max number of characters to write is set, only a
-                 * subset of the string should be copied to the buffer */
-                ecs_os_strncpy(
-                    flecs_strbuf_ptr(b),
-                    str + memLeftInElement,
-                    (size_t)n);
-            } else {
-                ecs_os_strcpy(flecs_strbuf_ptr(b), str + memLeftInElement);
-            }
+            ecs_os_memcpy(flecs_strbuf_ptr(b), str + memLeftInElement, n);
 
             /* Update to number of characters copied to new buffer */
             b->current->pos += n;
         } else {
-            /* String doesn't fit in a single element, strdup */
-            char *remainder = ecs_os_strdup(str + memLeftInElement);
+            /* String doesn't fit in a single element, copy the remainder */
+            char *remainder = ecs_os_malloc(n + 1);
+            ecs_os_memcpy(remainder, str + memLeftInElement, n);
+            remainder[n] = '\0';
             flecs_strbuf_grow_str(b, remainder, remainder, n);
         }
     } else {
@@ -13708,7 +14649,7 @@ bool ecs_strbuf_appendint(
 {
     ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL); 
     char numbuf[32];
-    char *ptr = flecs_strbuf_itoa(numbuf, v);
+    char *ptr = flecs_itoa(numbuf, v);
     return ecs_strbuf_appendstrn(b, numbuf, flecs_ito(int32_t, ptr - numbuf));
 }
 
@@ -13718,7 +14659,14 @@ bool ecs_strbuf_appendflt(
     char nan_delim)
 {
     ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL); 
-    return flecs_strbuf_ftoa(b, flt, 10, nan_delim);
+    char numbuf[FLECS_FTOA_SIZE];
+    int32_t len = flecs_ftoa(numbuf, flt, 10, nan_delim);
+    ecs_assert(len < FLECS_FTOA_SIZE, ECS_INTERNAL_ERROR, NULL);
+    /* Also clamp in release, so the compiler can see the copy fits numbuf */
+    if (len >= FLECS_FTOA_SIZE) {
+        len = FLECS_FTOA_SIZE - 1;
+    }
+    return ecs_strbuf_appendstrn(b, numbuf, len);
 }
 
 bool ecs_strbuf_appendstr_zerocpy(
@@ -13871,6 +14819,9 @@ void ecs_strbuf_reset(
         do {
             next = e->next;
             if (e != (ecs_strbuf_element*)&b->firstElement) {
+                if (!e->buffer_embedded) {
+                    ecs_os_free(((ecs_strbuf_element_str*)e)->alloc_str);
+                }
                 ecs_os_free(e);
             }
         } while ((e = next));
@@ -15199,11 +16150,10 @@ void* _flecs_hashmap_next(
     int32_t index = ++ it->index;
     ecs_hm_bucket_t *bucket = it->bucket;
     while (!bucket || it->index >= ecs_vec_count(&bucket->keys)) {
-        ecs_map_next(&it->it);
-        bucket = it->bucket = ecs_map_ptr(&it->it);
-        if (!bucket) {
+        if (!ecs_map_next(&it->it)) {
             return NULL;
         }
+        bucket = it->bucket = ecs_map_ptr(&it->it);
         index = it->index = 0;
     }
 
@@ -16484,6 +17434,11 @@ typedef struct ecs_pipeline_state_t {
     int32_t cur_i;              /* Index in current result */
     int32_t ran_since_merge;    /* Index in current op */
     bool no_readonly;           /* Is pipeline in readonly mode */
+
+    /* Sync point statistics, only written by the main thread */
+    int64_t sync_count_total;       /* Number of sync points */
+    double sync_time_total;         /* Time spent in sync points (wait & merge) */
+    double sync_wait_time_total;    /* Time spent waiting on workers */
 } ecs_pipeline_state_t;
 
 typedef struct EcsPipeline {
@@ -16517,7 +17472,8 @@ bool flecs_worker_begin(
 
 void flecs_worker_end(
     ecs_world_t *world,
-    ecs_stage_t *stage);
+    ecs_stage_t *stage,
+    ecs_pipeline_state_t *pq);
 
 bool flecs_worker_sync(
     ecs_world_t *world,
@@ -16534,11 +17490,146 @@ void flecs_workers_progress(
 #endif
 
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Bounds for the number of times a thread polls a barrier before it parks on
+ * a condition variable. Most sync points are short, so spinning avoids a round
+ * trip through the kernel for each merge. The budget adapts per thread, so
+ * that threads stop spinning when that doesn't pay off, for example when there
+ * are more threads than cores. */
+#define FLECS_WORKER_SPIN_MIN (16)
+#define FLECS_WORKER_SPIN_MAX (4096)
+
 typedef struct ecs_worker_state_t {
     ecs_stage_t *stage;
     ecs_pipeline_state_t *pq;
 } ecs_worker_state_t;
 
+/* Read barrier counter written by other threads (acquire semantics) */
+static
+int32_t flecs_worker_load(
+    int32_t *ptr)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    int32_t result = *(volatile int32_t*)ptr;
+    _ReadWriteBarrier();
+    return result;
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchange((volatile long*)ptr, 0, 0);
+#else
+    return *(volatile int32_t*)ptr;
+#endif
+}
+
+/* Hint to the CPU that the thread is spinning */
+static
+void flecs_worker_pause(void) {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __yield();
+#endif
+}
+
+/* Get spin budget for thread. Threads start out with the maximum budget. */
+static
+int32_t flecs_spin_get(
+    ecs_stage_t *stage)
+{
+    return stage->sync_spin ? stage->sync_spin : FLECS_WORKER_SPIN_MAX;
+}
+
+/* Grow spin budget if spinning was enough to pass the barrier, shrink if not */
+static
+void flecs_spin_update(
+    ecs_stage_t *stage,
+    int32_t spin,
+    bool spin_passed)
+{
+    if (spin_passed) {
+        spin *= 2;
+        spin = spin > FLECS_WORKER_SPIN_MAX ? FLECS_WORKER_SPIN_MAX : spin;
+    } else {
+        spin /= 2;
+    }
+    stage->sync_spin = spin < FLECS_WORKER_SPIN_MIN ? FLECS_WORKER_SPIN_MIN : spin;
+}
+
+/* Wake up main thread if it parked while waiting on workers */
+static
+void flecs_wake_main(
+    ecs_world_t *world)
+{
+    ecs_os_mutex_lock(world->sync_mutex);
+    if (world->main_parked) {
+        ecs_os_cond_signal(world->sync_cond);
+    }
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
+/* Wait on main thread until a counter incremented by workers reaches value */
+static
+void flecs_wait_main(
+    ecs_world_t *world,
+    int32_t *counter,
+    int32_t value)
+{
+    ecs_stage_t *stage = &world->stages[0];
+    int32_t i, spin = flecs_spin_get(stage);
+    for (i = 0; i < spin; i ++) {
+        if (flecs_worker_load(counter) == value) {
+            flecs_spin_update(stage, spin, true);
+            return;
+        }
+        flecs_worker_pause();
+    }
+
+    flecs_spin_update(stage, spin, false);
+
+    ecs_os_mutex_lock(world->sync_mutex);
+    while (flecs_worker_load(counter) != value) {
+        world->main_parked = true;
+        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    }
+    world->main_parked = false;
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
+/* Wait on worker thread until main thread moves past generation */
+static
+void flecs_wait_worker(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    int32_t generation)
+{
+    int32_t i, spin = flecs_spin_get(stage);
+    for (i = 0; i < spin; i ++) {
+        if (flecs_worker_load(&world->worker_generation) != generation) {
+            flecs_spin_update(stage, spin, true);
+            return;
+        }
+        flecs_worker_pause();
+    }
+
+    flecs_spin_update(stage, spin, false);
+
+    ecs_os_mutex_lock(world->sync_mutex);
+    while (flecs_worker_load(&world->worker_generation) == generation) {
+        world->workers_parked ++;
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+        world->workers_parked --;
+    }
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
 /* Worker thread */
 static
 void* flecs_worker(void *arg) {
@@ -16553,15 +17644,16 @@ void* flecs_worker(void *arg) {
     ecs_dbg_2("worker %d: start", stage->id);
 
     /* Start worker, increase counter so main thread knows how many
-     * workers are ready */
-    ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running ++;
-
-    if (!(world->flags & EcsWorldQuitWorkers)) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+     * workers are ready. The generation must be read before the counter is
+     * increased, as the main thread may release workers right after. */
+    int32_t generation = flecs_worker_load(&world->worker_generation);
+    if (ecs_os_ainc(&world->workers_running) == 
+        (ecs_get_stage_count(world) - 1)) 
+    {
+        flecs_wake_main(world);
     }
 
-    ecs_os_mutex_unlock(world->sync_mutex);
+    flecs_wait_worker(world, stage, generation);
 
     while (!(world->flags & EcsWorldQuitWorkers)) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
@@ -16575,9 +17667,7 @@ void* flecs_worker(void *arg) {
 
     ecs_dbg_2("worker %d: finalizing", stage->id);
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running --;
-    ecs_os_mutex_unlock(world->sync_mutex);
+    ecs_os_adec(&world->workers_running);
 
     ecs_dbg_2("worker %d: stop", stage->id);
 
@@ -16644,14 +17734,7 @@ void flecs_wait_for_workers(
         return;
     }
 
-    bool wait = true;
-    do {
-        ecs_os_mutex_lock(world->sync_mutex);
-        if (world->workers_running == (stage_count - 1)) {
-            wait = false;
-        }
-        ecs_os_mutex_unlock(world->sync_mutex);
-    } while (wait);
+    flecs_wait_main(world, &world->workers_running, stage_count - 1);
 }
 
 /* Wait until all threads are waiting on sync point */
@@ -16666,17 +17749,11 @@ void flecs_wait_for_sync(
 
     ecs_dbg_3("#[bold]pipeline: waiting for worker sync");
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != (stage_count - 1)) {
-        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
-    }
-
-    /* We shouldn't have been signalled unless all workers are waiting on sync */
-    ecs_assert(world->workers_waiting == (stage_count - 1), 
-        ECS_INTERNAL_ERROR, NULL);
+    flecs_wait_main(world, &world->workers_waiting, stage_count - 1);
 
+    /* Workers don't touch the counter again until they are released by the
+     * next generation, which publishes the reset. */
     world->workers_waiting = 0;
-    ecs_os_mutex_unlock(world->sync_mutex);
 
     ecs_dbg_3("#[bold]pipeline: workers synced");
 }
@@ -16684,23 +17761,25 @@ void flecs_wait_for_sync(
 /* Synchronize workers */
 static
 void flecs_sync_worker(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t stage_count = ecs_get_stage_count(world);
     if (stage_count <= 1) {
         return;
     }
 
-    /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == (stage_count - 1)) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    /* Read generation before signalling that the thread is waiting, so that
+     * the release by the main thread can't be missed */
+    int32_t generation = flecs_worker_load(&world->worker_generation);
+
+    /* Only wake main thread when all threads are waiting */
+    if (ecs_os_ainc(&world->workers_waiting) == (stage_count - 1)) {
+        flecs_wake_main(world);
     }
 
     /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    flecs_wait_worker(world, stage, generation);
 }
 
 /* Signal workers that they can start/resume work */
@@ -16714,8 +17793,15 @@ void flecs_signal_workers(
     }
 
     ecs_dbg_3("#[bold]pipeline: signal workers");
+
+    /* Spinning workers resume as soon as they see the new generation. Only
+     * go through the condition variable if a worker has parked. */
+    ecs_os_ainc(&world->worker_generation);
+
     ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
+    if (world->workers_parked) {
+        ecs_os_cond_broadcast(world->worker_cond);
+    }
     ecs_os_mutex_unlock(world->sync_mutex);
 }
 
@@ -16810,24 +17896,43 @@ bool flecs_worker_begin(
 
 void flecs_worker_end(
     ecs_world_t *world,
-    ecs_stage_t *stage)
+    ecs_stage_t *stage,
+    ecs_pipeline_state_t *pq)
 {
     ecs_poly_assert(world, ecs_world_t);
     ecs_poly_assert(stage, ecs_stage_t);
 
-    if (flecs_is_multithreaded(world)) {
-        if (flecs_is_main_thread(stage)) {
-            flecs_wait_for_sync(world);
-        } else {
-            flecs_sync_worker(world);
+    if (!flecs_is_main_thread(stage)) {
+        if (flecs_is_multithreaded(world)) {
+            flecs_sync_worker(world, stage);
         }
+        return;
     }
 
-    if (flecs_is_main_thread(stage)) {
-        if (ecs_stage_is_readonly(world)) {
-            ecs_readonly_end(world);
+    ecs_time_t t = {0};
+    bool measure_time = world->flags & EcsWorldMeasureSystemTime;
+    if (measure_time) {
+        ecs_time_measure(&t);
+    }
+
+    if (flecs_is_multithreaded(world)) {
+        flecs_wait_for_sync(world);
+        if (measure_time) {
+            double wait_time = ecs_time_measure(&t);
+            pq->sync_wait_time_total += wait_time;
+            pq->sync_time_total += wait_time;
         }
     }
+
+    if (ecs_stage_is_readonly(world)) {
+        ecs_readonly_end(world);
+    }
+
+    if (measure_time) {
+        pq->sync_time_total += ecs_time_measure(&t);
+    }
+
+    pq->sync_count_total ++;
 }
 
 bool flecs_worker_sync(
@@ -16842,7 +17947,7 @@ bool flecs_worker_sync(
     bool main_thread = flecs_is_main_thread(stage);
 
     /* Synchronize workers */
-    flecs_worker_end(world, stage);
+    flecs_worker_end(world, stage, pq);
 
     /* Store the current state of the schedule after we synchronized the
      * threads, to avoid race conditions. */
@@ -17508,7 +18613,7 @@ void flecs_run_pipeline(
         world->info.system_time_total += (ecs_ftime_t)ecs_time_measure(&st);
     }
 
-    flecs_worker_end(world, stage);
+    flecs_worker_end(world, stage, pq);
 
     return;
 }
@@ -19445,243 +20550,1573 @@ void ecs_set_os_api_impl(void) {
 #endif
 
 /**
- * @file addons/plecs.c
- * @brief Plecs addon.
+ * @file addons/os_alloc.c
+ * @brief Thread caching allocator for the OS API.
+ *
+ * Allocations up to 256KB are rounded up to one of a fixed set of size classes.
+ * Every thread has a cache with a list of free blocks per class, and only
+ * takes a lock when its list runs empty or grows too long. In that case it
+ * exchanges a batch of blocks with the central heap of the class.
+ *
+ * The central heap of a class carves blocks from chunks that hold at least 16
+ * blocks. Chunks are made of 64KB pages, and the chunks of all classes are cut
+ * from shared 2MB regions mapped from the OS, so a class that is barely used
+ * doesn't reserve a region of its own. Chunks that don't fit in a region are
+ * mapped by themselves. A two level map stores for each page how far it is
+ * from the start of its chunk, which is how free() finds the chunk of a block
+ * and tells blocks apart from memory that was allocated with malloc() before
+ * the allocator was installed. Larger allocations get their own mapping,
+ * which is returned to the OS when freed.
  */
 
+/* MAP_ANONYMOUS and madvise are not part of the _POSIX_C_SOURCE that the
+ * private headers set, so request the default glibc feature set first. */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
 
-#ifdef FLECS_PLECS
-
-#include <ctype.h>
 
-#define TOK_NEWLINE '\n'
-#define TOK_WITH "with"
-#define TOK_USING "using"
-#define TOK_CONST "const"
+#ifdef FLECS_OS_ALLOC
 
-#define STACK_MAX_SIZE (64)
+#ifdef ECS_TARGET_WINDOWS
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
 
-typedef struct {
-    const char *name;
-    const char *code;
+#define FLECS_ALLOC_PAGE_SHIFT (16)
+#define FLECS_ALLOC_PAGE_SIZE ((size_t)1 << FLECS_ALLOC_PAGE_SHIFT)
+#define FLECS_ALLOC_REGION_SIZE ((size_t)2 * 1024 * 1024)
+#define FLECS_ALLOC_HEADER_SIZE (64)
+#define FLECS_ALLOC_CHUNK_BLOCKS (16) /* Chunks of 256KB blocks are 65 pages */
+#define FLECS_ALLOC_SMALL_CLASS_COUNT (8) /* 16 byte steps up to 128 bytes */
+#define FLECS_ALLOC_MAX_CLASS_SIZE (256 * 1024)
+#define FLECS_ALLOC_BATCH_BYTES (32 * 1024)
+#define FLECS_ALLOC_BATCH_MAX (64)
+#define FLECS_ALLOC_MAP_LEAF_SHIFT (16)
+#define FLECS_ALLOC_MAP_LEAF_SIZE ((size_t)1 << FLECS_ALLOC_MAP_LEAF_SHIFT)
+#define FLECS_ALLOC_MAP_ROOT_SIZE (1 << 16) /* Covers 48 bit addresses */
+#define FLECS_ALLOC_LARGE (-1)
+
+#ifdef ECS_TARGET_MSVC
+#define FLECS_ALLOC_TLS __declspec(thread)
+#else
+#define FLECS_ALLOC_TLS __thread
+#endif
 
-    ecs_entity_t last_predicate;
-    ecs_entity_t last_subject;
-    ecs_entity_t last_object;
+/* Locks are held for a short time, except when a new chunk is mapped */
+#ifdef ECS_TARGET_WINDOWS
+typedef volatile LONG flecs_alloc_lock_t;
+#define flecs_alloc_try_lock(lock) (!InterlockedExchange(lock, 1))
+#define flecs_alloc_unlock(lock) InterlockedExchange(lock, 0)
+#define flecs_alloc_yield() SwitchToThread()
+#define flecs_alloc_add(ptr, value) InterlockedExchangeAdd64(ptr, value)
+#define flecs_alloc_cas(ptr, old, value)\
+    (InterlockedCompareExchange64(ptr, value, old) == (old))
+#define flecs_alloc_load32(ptr) ReadNoFence((volatile LONG*)(ptr))
+#define flecs_alloc_store32(ptr, value)\
+    WriteNoFence((volatile LONG*)(ptr), value)
+#define flecs_alloc_load64(ptr) ReadNoFence64(ptr)
+#define flecs_alloc_store64(ptr, value) WriteNoFence64(ptr, value)
+#else
+typedef volatile int32_t flecs_alloc_lock_t;
+#define flecs_alloc_try_lock(lock) (!__sync_lock_test_and_set(lock, 1))
+#define flecs_alloc_unlock(lock) __sync_lock_release(lock)
+#define flecs_alloc_yield() sched_yield()
+#define flecs_alloc_add(ptr, value) __sync_fetch_and_add(ptr, value)
+#define flecs_alloc_cas(ptr, old, value)\
+    __sync_bool_compare_and_swap(ptr, old, value)
+#define flecs_alloc_load32(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define flecs_alloc_store32(ptr, value)\
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#define flecs_alloc_load64(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define flecs_alloc_store64(ptr, value)\
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#endif
 
-    ecs_id_t last_assign_id;
-    ecs_entity_t assign_to;
+typedef struct flecs_alloc_block_t {
+    struct flecs_alloc_block_t *next;
+} flecs_alloc_block_t;
+
+/* Stored at the start of each chunk */
+typedef struct flecs_alloc_chunk_t {
+    int32_t size_class;         /* FLECS_ALLOC_LARGE for large allocations */
+    size_t size;                /* Mapped size of chunk */
+} flecs_alloc_chunk_t;
+
+/* Central heap of a size class */
+typedef union flecs_alloc_class_t {
+    struct {
+        flecs_alloc_lock_t lock;
+        int32_t size;
+        int32_t batch;          /* Blocks exchanged with a thread cache */
+        flecs_alloc_block_t *free; /* Blocks returned by thread caches */
+        char *cur;              /* Unused part of the current chunk */
+        char *end;
+        size_t chunk_size;
+    } h;
+    char padding[64];           /* Don't share cache lines between locks */
+} flecs_alloc_class_t;
+
+typedef struct flecs_alloc_bin_t {
+    flecs_alloc_block_t *first;
+    int32_t count;
+} flecs_alloc_bin_t;
+
+/* The counts of a thread cache are only written by its thread, but are read by
+ * ecs_os_alloc_stats_get on other threads, so they're accessed atomically */
+typedef struct flecs_alloc_cache_t {
+    flecs_alloc_bin_t bins[ECS_OS_ALLOC_CLASS_COUNT];
+    int64_t alloc_count[ECS_OS_ALLOC_CLASS_COUNT]; /* Allocated by thread */
+    int64_t free_count[ECS_OS_ALLOC_CLASS_COUNT];  /* Freed by thread */
+    struct flecs_alloc_cache_t *next;
+    bool in_use;                /* Caches of exited threads are reused */
+} flecs_alloc_cache_t;
+
+static struct {
+    flecs_alloc_class_t classes[ECS_OS_ALLOC_CLASS_COUNT];
+    flecs_alloc_lock_t lock;    /* Protects map, cache list and OS mappings */
+    uint8_t *map[FLECS_ALLOC_MAP_ROOT_SIZE];
+    char *region_cur;           /* Unused part of the current region */
+    char *region_end;
+    flecs_alloc_cache_t *caches;
+    int64_t outstanding_bytes;  /* Bytes handed out to thread caches */
+    int64_t peak_bytes;
+    int64_t reserved_bytes;
+    int64_t large_alloc_count;
+    int64_t large_live_bytes;
+    bool huge_pages;
+    bool no_hugetlb;            /* Explicit huge pages are not available */
+    bool initialized;
+#ifdef ECS_TARGET_WINDOWS
+    DWORD thread_exit_key;
+#else
+    pthread_key_t thread_exit_key;
+#endif
+} flecs_alloc;
 
-    ecs_entity_t scope[STACK_MAX_SIZE];
-    ecs_entity_t default_scope_type[STACK_MAX_SIZE];
-    ecs_entity_t with[STACK_MAX_SIZE];
-    ecs_entity_t using[STACK_MAX_SIZE];
-    int32_t with_frames[STACK_MAX_SIZE];
-    int32_t using_frames[STACK_MAX_SIZE];
-    int32_t sp;
-    int32_t with_frame;
-    int32_t using_frame;
+static FLECS_ALLOC_TLS flecs_alloc_cache_t *flecs_alloc_thread_cache;
 
-    char *annot[STACK_MAX_SIZE];
-    int32_t annot_count;
+static
+void flecs_alloc_lock(
+    flecs_alloc_lock_t *lock)
+{
+    int32_t spin = 0;
+    while (!flecs_alloc_try_lock(lock)) {
+        if (++ spin > 64) {
+            flecs_alloc_yield();
+            spin = 0;
+        }
+    }
+}
 
-#ifdef FLECS_EXPR
-    ecs_vars_t vars;
-    char var_name[256];
-#endif
+static
+int32_t flecs_alloc_class_of(
+    size_t size)
+{
+    if (size <= 128) {
+        return size ? (int32_t)((size + 15) >> 4) - 1 : 0;
+    }
 
-    bool with_stmt;
-    bool scope_assign_stmt;
-    bool using_stmt;
-    bool assign_stmt;
-    bool isa_stmt;
-    bool decl_stmt;
-    bool decl_type;
-    bool const_stmt;
+    /* Four classes for each power of two above 128 bytes */
+    size_t s = size - 1;
+    int32_t log2 = 7;
+    while (s >> (log2 + 1)) {
+        log2 ++;
+    }
 
-    int32_t errors;
-} plecs_state_t;
+    return FLECS_ALLOC_SMALL_CLASS_COUNT + (log2 - 7) * 4 +
+        (int32_t)((s - ((size_t)1 << log2)) >> (log2 - 2));
+}
 
 static
-ecs_entity_t plecs_lookup(
-    const ecs_world_t *world,
-    const char *path,
-    plecs_state_t *state,
-    ecs_entity_t rel,
-    bool is_subject)
+int32_t flecs_alloc_class_size(
+    int32_t size_class)
 {
-    ecs_entity_t e = 0;
+    if (size_class < FLECS_ALLOC_SMALL_CLASS_COUNT) {
+        return (size_class + 1) * 16;
+    }
 
-    if (!is_subject) {
-        ecs_entity_t oneof = 0;
-        if (rel) {
-            if (ecs_has_id(world, rel, EcsOneOf)) {
-                oneof = rel;
-            } else {
-                oneof = ecs_get_target(world, rel, EcsOneOf, 0);
-            }
-            if (oneof) {
-                return ecs_lookup_path_w_sep(
-                    world, oneof, path, NULL, NULL, false);
-            }
-        }
-        int using_scope = state->using_frame - 1;
-        for (; using_scope >= 0; using_scope--) {
-            e = ecs_lookup_path_w_sep(
-                world, state->using[using_scope], path, NULL, NULL, false);
-            if (e) {
+    int32_t c = size_class - FLECS_ALLOC_SMALL_CLASS_COUNT;
+    int32_t log2 = 7 + c / 4;
+    return (1 << log2) + ((c % 4) + 1) * (1 << (log2 - 2));
+}
+
+static
+void flecs_alloc_update_outstanding(
+    int64_t delta)
+{
+    int64_t value = flecs_alloc_add(&flecs_alloc.outstanding_bytes, delta);
+    value += delta;
+    if (delta > 0) {
+        int64_t peak;
+        while (value >
+            (peak = flecs_alloc_load64(&flecs_alloc.peak_bytes)))
+        {
+            if (flecs_alloc_cas(&flecs_alloc.peak_bytes, peak, value)) {
                 break;
             }
         }
     }
+}
 
-    if (!e) {
-        e = ecs_lookup_path_w_sep(world, 0, path, NULL, NULL, !is_subject);
+/* Map memory from the OS at a region aligned address, so that regions can be
+ * backed by huge pages. Must be called with the allocator lock held. */
+static
+void* flecs_alloc_os_map(
+    size_t size)
+{
+#ifdef ECS_TARGET_WINDOWS
+    for (;;) {
+        char *raw = VirtualAlloc(NULL, size + FLECS_ALLOC_REGION_SIZE,
+            MEM_RESERVE, PAGE_NOACCESS);
+        if (!raw) {
+            return NULL;
+        }
+
+        VirtualFree(raw, 0, MEM_RELEASE);
+        char *aligned = (char*)(((uintptr_t)raw + FLECS_ALLOC_REGION_SIZE - 1) &
+            ~(uintptr_t)(FLECS_ALLOC_REGION_SIZE - 1));
+        void *result = VirtualAlloc(aligned, size,
+            MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (result) {
+            return result;
+        }
+
+        /* Another thread mapped memory in the range, try again */
+    }
+#else
+#ifdef MAP_HUGETLB
+    if (flecs_alloc.huge_pages && !flecs_alloc.no_hugetlb &&
+        !(size & (FLECS_ALLOC_REGION_SIZE - 1)))
+    {
+        /* Explicit huge pages are aligned to their size. This only succeeds
+         * if the system has huge pages reserved, otherwise fall back to
+         * transparent huge pages. */
+        void *result = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (result != MAP_FAILED) {
+            return result;
+        }
+        flecs_alloc.no_hugetlb = true;
     }
+#endif
 
-    return e;
+    size_t map_size = size + FLECS_ALLOC_REGION_SIZE;
+    char *raw = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+
+    char *aligned = (char*)(((uintptr_t)raw + FLECS_ALLOC_REGION_SIZE - 1) &
+        ~(uintptr_t)(FLECS_ALLOC_REGION_SIZE - 1));
+    if (aligned != raw) {
+        munmap(raw, (size_t)(aligned - raw));
+    }
+    size_t tail = (size_t)((raw + map_size) - (aligned + size));
+    if (tail) {
+        munmap(aligned + size, tail);
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (flecs_alloc.huge_pages) {
+        madvise(aligned, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    return aligned;
+#endif
 }
 
-/* Lookup action used for deserializing entity refs in component values */
-#ifdef FLECS_EXPR
 static
-ecs_entity_t plecs_lookup_action(
-    const ecs_world_t *world,
-    const char *path,
-    void *ctx)
+void flecs_alloc_os_unmap(
+    void *ptr,
+    size_t size)
 {
-    return plecs_lookup(world, path, ctx, 0, false);
-}
+#ifdef ECS_TARGET_WINDOWS
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
 #endif
+}
 
+/* Mark the pages of a chunk as owned (or not owned) by the allocator. An owned
+ * page stores its distance to the start of the chunk plus one. Must be called
+ * with the allocator lock held. */
 static
-ecs_entity_t plecs_ensure_entity(
-    ecs_world_t *world,
-    plecs_state_t *state,
-    const char *path,
-    ecs_entity_t rel,
-    bool is_subject)
+bool flecs_alloc_map_set(
+    void *ptr,
+    size_t size,
+    bool owned)
 {
-    if (!path) {
-        return 0;
+    uintptr_t first = (uintptr_t)ptr >> FLECS_ALLOC_PAGE_SHIFT, index;
+    uintptr_t last = first + (size >> FLECS_ALLOC_PAGE_SHIFT);
+    for (index = first; index < last; index ++) {
+        uintptr_t root = index >> FLECS_ALLOC_MAP_LEAF_SHIFT;
+        if (root >= FLECS_ALLOC_MAP_ROOT_SIZE) {
+            return false;
+        }
+
+        uint8_t *leaf = flecs_alloc.map[root];
+        if (!leaf) {
+            leaf = calloc(1, FLECS_ALLOC_MAP_LEAF_SIZE);
+            if (!leaf) {
+                return false;
+            }
+            flecs_alloc.map[root] = leaf;
+        }
+
+        leaf[index & (FLECS_ALLOC_MAP_LEAF_SIZE - 1)] =
+            owned ? (uint8_t)(index - first + 1) : 0;
     }
 
-    ecs_entity_t e = 0;
-    bool is_anonymous = !ecs_os_strcmp(path, "_");
-    if (is_anonymous) {
-        path = NULL;
-        e = ecs_new_id(world);
+    return true;
+}
+
+static
+flecs_alloc_chunk_t* flecs_alloc_chunk_of(
+    void *ptr)
+{
+    uintptr_t index = (uintptr_t)ptr >> FLECS_ALLOC_PAGE_SHIFT;
+    uintptr_t root = index >> FLECS_ALLOC_MAP_LEAF_SHIFT;
+    if (root >= FLECS_ALLOC_MAP_ROOT_SIZE) {
+        return NULL;
     }
 
-    if (!e) {
-        e = plecs_lookup(world, path, state, rel, is_subject);
+    uint8_t *leaf = flecs_alloc.map[root];
+    if (!leaf) {
+        return NULL;
     }
 
-    if (!e) {
-        if (rel && flecs_get_oneof(world, rel)) {
-            /* If relationship has oneof and entity was not found, don't proceed
-             * with creating an entity as this can cause asserts later on */
-            char *relstr = ecs_get_fullpath(world, rel);
-            ecs_parser_error(state->name, 0, 0, 
-                "invalid identifier '%s' for relationship '%s'", path, relstr);
-            ecs_os_free(relstr);
-            return 0;
+    uint8_t distance = leaf[index & (FLECS_ALLOC_MAP_LEAF_SIZE - 1)];
+    if (!distance) {
+        return NULL;
+    }
+
+    return (flecs_alloc_chunk_t*)((index - (distance - 1u)) <<
+        FLECS_ALLOC_PAGE_SHIFT);
+}
+
+/* Cut a chunk for a size class from the current region. The rest of a region
+ * that is too small for the chunk is left unused. */
+static
+flecs_alloc_chunk_t* flecs_alloc_region_take(
+    size_t size)
+{
+    if ((size_t)(flecs_alloc.region_end - flecs_alloc.region_cur) < size) {
+        char *region = flecs_alloc_os_map(FLECS_ALLOC_REGION_SIZE);
+        if (!region) {
+            return NULL;
         }
 
-        if (!is_subject) {
-            /* If this is not a subject create an existing empty id, which 
-             * ensures that scope & with are not applied */
-            e = ecs_new_id(world);
+        /* Create the map leaves of the region up front, so marking the pages
+         * of its chunks can't fail */
+        if (!flecs_alloc_map_set(region, FLECS_ALLOC_REGION_SIZE, false)) {
+            flecs_alloc_os_unmap(region, FLECS_ALLOC_REGION_SIZE);
+            return NULL;
         }
 
-        e = ecs_add_path(world, e, 0, path);
-        ecs_assert(e != 0, ECS_INTERNAL_ERROR, NULL);
-    } else {
-        /* If entity exists, make sure it gets the right scope and with */
-        if (is_subject) {
-            ecs_entity_t scope = ecs_get_scope(world);
-            if (scope) {
-                ecs_add_pair(world, e, EcsChildOf, scope);
-            }
+        flecs_alloc.region_cur = region;
+        flecs_alloc.region_end = region + FLECS_ALLOC_REGION_SIZE;
+        flecs_alloc.reserved_bytes += (int64_t)FLECS_ALLOC_REGION_SIZE;
+    }
 
-            ecs_entity_t with = ecs_get_with(world);
-            if (with) {
-                ecs_add_id(world, e, with);
+    flecs_alloc_chunk_t *chunk = (flecs_alloc_chunk_t*)flecs_alloc.region_cur;
+    flecs_alloc.region_cur += size;
+    return chunk;
+}
+
+static
+flecs_alloc_chunk_t* flecs_alloc_chunk_new(
+    int32_t size_class,
+    size_t size)
+{
+    /* Use whole pages, so that no memory the allocator doesn't own ends up in
+     * a page that is marked as owned */
+    size = (size + FLECS_ALLOC_PAGE_SIZE - 1) & ~(FLECS_ALLOC_PAGE_SIZE - 1);
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_chunk_t *chunk;
+    if (size_class != FLECS_ALLOC_LARGE && size < FLECS_ALLOC_REGION_SIZE) {
+        chunk = flecs_alloc_region_take(size);
+        if (chunk) {
+            flecs_alloc_map_set(chunk, size, true);
+        }
+    } else {
+        /* Pointers passed to free() only point into the first page of a
+         * large allocation, and a page can't be further than 255 pages from
+         * the start of its chunk, so only the first page is marked. */
+        size_t marked = size_class == FLECS_ALLOC_LARGE ?
+            FLECS_ALLOC_PAGE_SIZE : size;
+        chunk = flecs_alloc_os_map(size);
+        if (chunk) {
+            if (flecs_alloc_map_set(chunk, marked, true)) {
+                flecs_alloc.reserved_bytes += (int64_t)size;
+            } else {
+                flecs_alloc_map_set(chunk, marked, false);
+                flecs_alloc_os_unmap(chunk, size);
+                chunk = NULL;
             }
         }
     }
 
-    return e;
+    if (chunk) {
+        chunk->size_class = size_class;
+        chunk->size = size;
+    }
+    flecs_alloc_unlock(&flecs_alloc.lock);
+
+    return chunk;
 }
 
 static
-bool plecs_pred_is_subj(
-    ecs_term_t *term,
-    plecs_state_t *state)
+void* flecs_alloc_large(
+    size_t size)
 {
-    if (term->src.name != NULL) {
-        return false;
+    flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_new(
+        FLECS_ALLOC_LARGE, size + FLECS_ALLOC_HEADER_SIZE);
+    if (!chunk) {
+        /* Address space is not covered by the map, leave it to the C lib */
+        return malloc(size);
     }
-    if (term->second.name != NULL) {
-        return false;
+
+    flecs_alloc_add(&flecs_alloc.large_alloc_count, 1);
+    flecs_alloc_add(&flecs_alloc.large_live_bytes, (int64_t)chunk->size);
+    flecs_alloc_update_outstanding((int64_t)chunk->size);
+
+    return ECS_OFFSET(chunk, FLECS_ALLOC_HEADER_SIZE);
+}
+
+static
+void flecs_alloc_large_free(
+    flecs_alloc_chunk_t *chunk)
+{
+    int64_t size = (int64_t)chunk->size;
+    flecs_alloc_add(&flecs_alloc.large_live_bytes, -size);
+    flecs_alloc_update_outstanding(-size);
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_map_set(chunk, FLECS_ALLOC_PAGE_SIZE, false);
+    flecs_alloc.reserved_bytes -= size;
+    flecs_alloc_os_unmap(chunk, chunk->size);
+    flecs_alloc_unlock(&flecs_alloc.lock);
+}
+
+static
+void flecs_alloc_thread_exit(
+    void *ptr);
+
+static
+flecs_alloc_cache_t* flecs_alloc_cache_new(void) {
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_cache_t *cache = flecs_alloc.caches;
+    while (cache && cache->in_use) {
+        cache = cache->next;
     }
-    if (ecs_term_match_0(term)) {
-        return false;
+
+    if (!cache) {
+        cache = calloc(1, sizeof(flecs_alloc_cache_t));
+        if (cache) {
+            cache->next = flecs_alloc.caches;
+            flecs_alloc.caches = cache;
+        }
     }
-    if (state->with_stmt) {
-        return false;
+
+    if (cache) {
+        cache->in_use = true;
     }
-    if (state->assign_stmt) {
-        return false;
+    flecs_alloc_unlock(&flecs_alloc.lock);
+
+    if (cache) {
+        /* Register the cache so its blocks are returned when the thread exits */
+#ifdef ECS_TARGET_WINDOWS
+        FlsSetValue(flecs_alloc.thread_exit_key, cache);
+#else
+        pthread_setspecific(flecs_alloc.thread_exit_key, cache);
+#endif
+        flecs_alloc_thread_cache = cache;
     }
-    if (state->isa_stmt) {
-        return false;
+
+    return cache;
+}
+
+/* Move count blocks from a thread cache bin to the central heap */
+static
+void flecs_alloc_bin_release(
+    flecs_alloc_bin_t *bin,
+    int32_t size_class,
+    int32_t count)
+{
+    flecs_alloc_class_t *cl = &flecs_alloc.classes[size_class];
+    flecs_alloc_block_t *first = bin->first, *last = first;
+    int32_t i;
+    for (i = 1; i < count; i ++) {
+        last = last->next;
     }
-    if (state->using_stmt) {
-        return false;
+
+    bin->first = last->next;
+    flecs_alloc_store32(&bin->count, bin->count - count);
+
+    flecs_alloc_lock(&cl->h.lock);
+    last->next = cl->h.free;
+    cl->h.free = first;
+    flecs_alloc_unlock(&cl->h.lock);
+
+    flecs_alloc_update_outstanding(-(int64_t)count * cl->h.size);
+}
+
+/* Fill an empty thread cache bin with a batch from the central heap */
+static
+bool flecs_alloc_bin_refill(
+    flecs_alloc_bin_t *bin,
+    int32_t size_class)
+{
+    flecs_alloc_class_t *cl = &flecs_alloc.classes[size_class];
+    int32_t size = cl->h.size, batch = cl->h.batch, count = 0;
+    size_t chunk_size = cl->h.chunk_size;
+    flecs_alloc_block_t *first = NULL;
+
+    flecs_alloc_lock(&cl->h.lock);
+    while (count < batch) {
+        flecs_alloc_block_t *block = cl->h.free;
+        if (block) {
+            cl->h.free = block->next;
+        } else {
+            if ((cl->h.end - cl->h.cur) < size) {
+                flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_new(
+                    size_class, chunk_size);
+                if (!chunk) {
+                    break;
+                }
+                cl->h.cur = ECS_OFFSET(chunk, FLECS_ALLOC_HEADER_SIZE);
+                cl->h.end = ECS_OFFSET(chunk, chunk->size);
+            }
+            block = (flecs_alloc_block_t*)cl->h.cur;
+            cl->h.cur += size;
+        }
+
+        block->next = first;
+        first = block;
+        count ++;
     }
-    if (state->decl_type) {
+    flecs_alloc_unlock(&cl->h.lock);
+
+    if (!count) {
         return false;
     }
 
+    bin->first = first;
+    flecs_alloc_store32(&bin->count, count);
+    flecs_alloc_update_outstanding((int64_t)count * size);
+
     return true;
 }
 
-/* Set masks aren't useful in plecs, so translate them back to entity names */
 static
-const char* plecs_set_mask_to_name(
-    ecs_flags32_t flags) 
+void flecs_alloc_thread_exit(
+    void *ptr)
 {
-    flags &= EcsTraverseFlags;
-    if (flags == EcsSelf) {
-        return "self";
-    } else if (flags == EcsUp) {
-        return "up";
-    } else if (flags == EcsDown) {
-        return "down";
-    } else if (flags == EcsCascade || flags == (EcsUp|EcsCascade)) {
-        return "cascade";
-    } else if (flags == EcsParent) {
-        return "parent";
+    flecs_alloc_cache_t *cache = ptr;
+    int32_t i;
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        flecs_alloc_bin_t *bin = &cache->bins[i];
+        if (bin->count) {
+            flecs_alloc_bin_release(bin, i, bin->count);
+        }
     }
-    return NULL;
+
+    flecs_alloc_thread_cache = NULL;
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    cache->in_use = false;
+    flecs_alloc_unlock(&flecs_alloc.lock);
 }
 
+#ifdef ECS_TARGET_WINDOWS
 static
-char* plecs_trim_annot(
-    char *annot)
+void WINAPI flecs_alloc_fls_callback(
+    void *ptr)
 {
-    annot = (char*)ecs_parse_whitespace(annot);
-    int32_t len = ecs_os_strlen(annot) - 1;
-    while (isspace(annot[len]) && (len > 0)) {
-        annot[len] = '\0';
-        len --;
+    if (ptr) {
+        flecs_alloc_thread_exit(ptr);
     }
-    return annot;
 }
+#endif
 
 static
-void plecs_apply_annotations(
+void* flecs_alloc_block(
+    size_t size)
+{
+    if (size > FLECS_ALLOC_MAX_CLASS_SIZE) {
+        return flecs_alloc_large(size);
+    }
+
+    flecs_alloc_cache_t *cache = flecs_alloc_thread_cache;
+    if (!cache) {
+        cache = flecs_alloc_cache_new();
+        if (!cache) {
+            return NULL;
+        }
+    }
+
+    int32_t size_class = flecs_alloc_class_of(size);
+    flecs_alloc_bin_t *bin = &cache->bins[size_class];
+    flecs_alloc_block_t *block = bin->first;
+    if (!block) {
+        if (!flecs_alloc_bin_refill(bin, size_class)) {
+            return NULL;
+        }
+        block = bin->first;
+    }
+
+    bin->first = block->next;
+    flecs_alloc_store32(&bin->count, bin->count - 1);
+    flecs_alloc_store64(&cache->alloc_count[size_class],
+        cache->alloc_count[size_class] + 1);
+
+    return block;
+}
+
+static
+void flecs_alloc_block_free(
+    void *ptr)
+{
+    flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_of(ptr);
+    if (!chunk) {
+        /* Allocated before the allocator was installed */
+        free(ptr);
+        return;
+    }
+
+    int32_t size_class = chunk->size_class;
+    if (size_class == FLECS_ALLOC_LARGE) {
+        flecs_alloc_large_free(chunk);
+        return;
+    }
+
+    flecs_alloc_cache_t *cache = flecs_alloc_thread_cache;
+    if (!cache) {
+        cache = flecs_alloc_cache_new();
+        if (!cache) {
+            /* Can't cache the block, give it straight back to the heap */
+            flecs_alloc_bin_t bin = { ptr, 1 };
+            ((flecs_alloc_block_t*)ptr)->next = NULL;
+            flecs_alloc_bin_release(&bin, size_class, 1);
+            return;
+        }
+    }
+
+    flecs_alloc_bin_t *bin = &cache->bins[size_class];
+    flecs_alloc_block_t *block = ptr;
+    block->next = bin->first;
+    bin->first = block;
+    flecs_alloc_store32(&bin->count, bin->count + 1);
+    flecs_alloc_store64(&cache->free_count[size_class],
+        cache->free_count[size_class] + 1);
+
+    /* Keep up to two batches, so alternating allocs and frees don't cause a
+     * batch to be exchanged each time */
+    int32_t batch = flecs_alloc.classes[size_class].h.batch;
+    if (bin->count > 2 * batch) {
+        flecs_alloc_bin_release(bin, size_class, batch);
+    }
+}
+
+static
+void* flecs_alloc_malloc(
+    ecs_size_t size)
+{
+    ecs_os_linc(&ecs_os_api_malloc_count);
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+    return flecs_alloc_block((size_t)size);
+}
+
+static
+void* flecs_alloc_calloc(
+    ecs_size_t size)
+{
+    ecs_os_linc(&ecs_os_api_calloc_count);
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+    void *result = flecs_alloc_block((size_t)size);
+    if (result) {
+        ecs_os_memset(result, 0, size);
+    }
+    return result;
+}
+
+static
+void* flecs_alloc_realloc(
+    void *ptr,
+    ecs_size_t size)
+{
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!ptr) {
+        /* If not actually reallocing, treat as malloc */
+        ecs_os_linc(&ecs_os_api_malloc_count);
+        return flecs_alloc_block((size_t)size);
+    }
+
+    ecs_os_linc(&ecs_os_api_realloc_count);
+
+    flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_of(ptr);
+    if (!chunk) {
+        return realloc(ptr, (size_t)size);
+    }
+
+    size_t old_size;
+    if (chunk->size_class == FLECS_ALLOC_LARGE) {
+        old_size = chunk->size - FLECS_ALLOC_HEADER_SIZE;
+        if ((size_t)size <= old_size &&
+            (size_t)size > FLECS_ALLOC_MAX_CLASS_SIZE)
+        {
+            return ptr;
+        }
+    } else {
+        old_size = (size_t)flecs_alloc_class_size(chunk->size_class);
+        if ((size_t)size <= FLECS_ALLOC_MAX_CLASS_SIZE &&
+            flecs_alloc_class_of((size_t)size) == chunk->size_class)
+        {
+            return ptr;
+        }
+    }
+
+    void *result = flecs_alloc_block((size_t)size);
+    if (result) {
+        ecs_os_memcpy(result, ptr, ECS_MIN((size_t)size, old_size));
+        flecs_alloc_block_free(ptr);
+    }
+
+    return result;
+}
+
+static
+void flecs_alloc_free(
+    void *ptr)
+{
+    if (ptr) {
+        ecs_os_linc(&ecs_os_api_free_count);
+        flecs_alloc_block_free(ptr);
+    }
+}
+
+static
+void flecs_alloc_init(
+    bool huge_pages)
+{
+    flecs_alloc.huge_pages = huge_pages;
+
+    int32_t i;
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        flecs_alloc_class_t *cl = &flecs_alloc.classes[i];
+        int32_t size = flecs_alloc_class_size(i);
+        int32_t batch = FLECS_ALLOC_BATCH_BYTES / size;
+        size_t chunk_size = FLECS_ALLOC_HEADER_SIZE +
+            (size_t)size * FLECS_ALLOC_CHUNK_BLOCKS;
+        cl->h.size = size;
+        cl->h.batch = ECS_MAX(2, ECS_MIN(batch, FLECS_ALLOC_BATCH_MAX));
+        cl->h.chunk_size = ECS_MAX(chunk_size, FLECS_ALLOC_PAGE_SIZE);
+    }
+
+#ifdef ECS_TARGET_WINDOWS
+    flecs_alloc.thread_exit_key = FlsAlloc(flecs_alloc_fls_callback);
+#else
+    pthread_key_create(&flecs_alloc.thread_exit_key, flecs_alloc_thread_exit);
+#endif
+
+    flecs_alloc.initialized = true;
+}
+
+void ecs_os_alloc_set_api(
+    ecs_os_api_t *os_api,
+    bool huge_pages)
+{
+    ecs_assert(os_api != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    if (!flecs_alloc.initialized) {
+        flecs_alloc_init(huge_pages);
+    }
+
+    os_api->malloc_ = flecs_alloc_malloc;
+    os_api->calloc_ = flecs_alloc_calloc;
+    os_api->realloc_ = flecs_alloc_realloc;
+    os_api->free_ = flecs_alloc_free;
+}
+
+bool ecs_os_alloc_stats_get(
+    ecs_os_alloc_stats_t *stats)
+{
+    ecs_assert(stats != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_os_zeromem(stats);
+
+    if (!flecs_alloc.initialized) {
+        return false;
+    }
+
+    int32_t i;
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        stats->class_size[i] = flecs_alloc.classes[i].h.size;
+    }
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_cache_t *cache;
+    for (cache = flecs_alloc.caches; cache; cache = cache->next) {
+        for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+            int64_t alloc_count = flecs_alloc_load64(&cache->alloc_count[i]);
+            int64_t free_count = flecs_alloc_load64(&cache->free_count[i]);
+            int32_t cached = flecs_alloc_load32(&cache->bins[i].count);
+            stats->class_alloc_count[i] += alloc_count;
+            stats->class_live_count[i] += alloc_count - free_count;
+            stats->cached_bytes += (int64_t)cached * stats->class_size[i];
+        }
+        stats->thread_count += cache->in_use;
+    }
+    stats->reserved_bytes = flecs_alloc.reserved_bytes;
+    flecs_alloc_unlock(&flecs_alloc.lock);
+
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        stats->live_bytes += stats->class_live_count[i] * stats->class_size[i];
+    }
+
+    stats->large_alloc_count =
+        flecs_alloc_load64(&flecs_alloc.large_alloc_count);
+    stats->large_live_bytes =
+        flecs_alloc_load64(&flecs_alloc.large_live_bytes);
+    stats->live_bytes += stats->large_live_bytes;
+    stats->peak_bytes = flecs_alloc_load64(&flecs_alloc.peak_bytes);
+
+    return true;
+}
+
+#endif
+
+/**
+ * @file addons/plecs.c
+ * @brief Plecs addon.
+ */
+
+
+#ifdef FLECS_PLECS
+
+#include <ctype.h>
+
+#define TOK_NEWLINE '\n'
+#define TOK_WITH "with"
+#define TOK_USING "using"
+#define TOK_CONST "const"
+
+#define STACK_MAX_SIZE (64)
+
+/* Initial size of the buffer that files are read into */
+#define PLECS_READ_SIZE (64 * 1024)
+
+/* Entity of the statement that is being parsed. The entity isn't created
+ * until the statement is done: its ids are added to the row and its values
+ * parsed into the row, so the entity can be created in bulk. */
+typedef struct {
+    ecs_entity_t entity;
+    const char *name;
+    ecs_id_t ids[ECS_ID_CACHE_SIZE];
+    void *values[ECS_ID_CACHE_SIZE];
+    int32_t id_count;
+} plecs_row_t;
+
+/* Rows of consecutive statements that have the same ids, created with a
+ * single ecs_bulk_init when a statement with different ids is parsed */
+typedef struct {
+    ecs_id_t ids[ECS_ID_CACHE_SIZE];
+    const ecs_type_info_t *type_info[ECS_ID_CACHE_SIZE];
+    ecs_vec_t values[ECS_ID_CACHE_SIZE]; /* vec<void*>, values of component */
+    ecs_vec_t entities;
+    ecs_hashmap_t names; /* names of the rows, for lookups */
+    int32_t id_count;
+    bool observed;
+} plecs_batch_t;
+
+typedef struct {
+    const char *name;
+    const char *code;
+
+    ecs_entity_t last_predicate;
+    ecs_entity_t last_subject;
+    ecs_entity_t last_object;
+
+    ecs_id_t last_assign_id;
+    ecs_entity_t assign_to;
+
+    ecs_entity_t scope[STACK_MAX_SIZE];
+    ecs_entity_t default_scope_type[STACK_MAX_SIZE];
+    ecs_entity_t with[STACK_MAX_SIZE];
+    ecs_entity_t using[STACK_MAX_SIZE];
+    int32_t with_frames[STACK_MAX_SIZE];
+    int32_t using_frames[STACK_MAX_SIZE];
+    int32_t sp;
+    int32_t with_frame;
+    int32_t using_frame;
+
+    char *annot[STACK_MAX_SIZE];
+    int32_t annot_count;
+
+    /* Cache with identifiers that were resolved in a scope */
+    ecs_map_t lookup_cache;     /* map<scope, name index> */
+    ecs_hashmap_t lookup_names; /* identifiers in the cache */
+
+    int32_t entity_count;
+    int32_t cache_hit_count;
+    int32_t bulk_count;
+
+    /* Entities that are created in bulk, if the world isn't deferred */
+    plecs_row_t row;
+    plecs_batch_t batch;
+    bool bulk;
+
+#ifdef FLECS_EXPR
+    ecs_vars_t vars;
+    char var_name[256];
+#endif
+
+    bool with_stmt;
+    bool scope_assign_stmt;
+    bool using_stmt;
+    bool assign_stmt;
+    bool isa_stmt;
+    bool decl_stmt;
+    bool decl_type;
+    bool const_stmt;
+
+    int32_t errors;
+} plecs_state_t;
+
+static
+void plecs_cache_clear(
+    plecs_state_t *state)
+{
+    ecs_map_iter_t it = ecs_map_iter(&state->lookup_cache);
+    while (ecs_map_next(&it)) {
+        ecs_hashmap_t *names = ecs_map_ptr(&it);
+        flecs_hashmap_iter_t nit = flecs_hashmap_iter(names);
+        ecs_hashed_string_t *key;
+        while (_flecs_hashmap_next(&nit, ECS_SIZEOF(ecs_hashed_string_t), 
+            &key, ECS_SIZEOF(uint64_t))) 
+        {
+            ecs_os_free(key->value);
+        }
+        flecs_name_index_fini(names);
+        ecs_os_free(names);
+    }
+
+    ecs_map_clear(&state->lookup_cache);
+    flecs_name_index_fini(&state->lookup_names);
+    flecs_name_index_init(&state->lookup_names, NULL);
+}
+
+static
+ecs_entity_t plecs_cache_get(
+    const ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t scope,
+    const ecs_hashed_string_t *key)
+{
+    ecs_hashmap_t *names = ecs_map_get_deref(
+        &state->lookup_cache, ecs_hashmap_t, scope);
+    if (!names) {
+        return 0;
+    }
+
+    ecs_entity_t e = flecs_name_index_find(
+        names, key->value, key->length, key->hash);
+    if (e && !ecs_is_alive(world, e)) {
+        return 0;
+    }
+
+    return e;
+}
+
+static
+void plecs_cache_set(
+    plecs_state_t *state,
+    ecs_entity_t scope,
+    const ecs_hashed_string_t *key,
+    ecs_entity_t e)
+{
+    ecs_hashmap_t **names = ecs_map_ensure_ref(
+        &state->lookup_cache, ecs_hashmap_t, scope);
+    if (!names[0]) {
+        names[0] = ecs_os_calloc_t(ecs_hashmap_t);
+        flecs_name_index_init(names[0], NULL);
+    }
+
+    uint64_t *ptr = (uint64_t*)flecs_name_index_find_ptr(
+        names[0], key->value, key->length, key->hash);
+    if (ptr) {
+        ptr[0] = e;
+        return;
+    }
+
+    /* The cache owns the identifiers, the name set points to the same string */
+    char *path = ecs_os_strdup(key->value);
+    flecs_name_index_ensure(names[0], e, path, key->length, key->hash);
+    if (!flecs_name_index_find(
+        &state->lookup_names, path, key->length, key->hash)) 
+    {
+        flecs_name_index_ensure(
+            &state->lookup_names, 1, path, key->length, key->hash);
+    }
+}
+
+/* A new entity can shadow an identifier that resolved to an entity in a
+ * parent scope or a using scope, which invalidates the cache. */
+static
+void plecs_cache_invalidate(
+    plecs_state_t *state,
+    const char *path)
+{
+    const char *name = strrchr(path, '.');
+    name = name ? name + 1 : path;
+
+    if (flecs_name_index_find(&state->lookup_names, path, 0, 0) ||
+        flecs_name_index_find(&state->lookup_names, name, 0, 0)) 
+    {
+        plecs_cache_clear(state);
+    }
+}
+
+static
+void plecs_value_free(
+    ecs_world_t *world,
+    const ecs_type_info_t *ti,
+    void *ptr)
+{
+    ecs_value_fini_w_type_info(world, ti, ptr);
+    flecs_free(&world->allocator, ti->size, ptr);
+}
+
+/* Create the entities of the batch in the table for its ids */
+static
+void plecs_batch_flush(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    plecs_batch_t *batch = &state->batch;
+    int32_t i, j, count = ecs_vec_count(&batch->entities);
+    if (!count) {
+        return;
+    }
+
+    /* The values of each row were parsed in memory of their own, move them to
+     * the array per component that ecs_bulk_init moves into the table */
+    ecs_bulk_desc_t desc = {
+        .entities = ecs_vec_first(&batch->entities),
+        .count = count
+    };
+    void *data[ECS_ID_CACHE_SIZE] = {0};
+
+    for (i = 0; i < batch->id_count; i ++) {
+        desc.ids[i] = batch->ids[i];
+
+        const ecs_type_info_t *ti = batch->type_info[i];
+        if (!ti) {
+            continue;
+        }
+
+        ecs_size_t size = ti->size;
+        void **values = ecs_vec_first(&batch->values[i]);
+        data[i] = ecs_os_malloc(size * count);
+        for (j = 0; j < count; j ++) {
+            void *dst = ECS_ELEM(data[i], size, j);
+            if (ti->hooks.move_ctor) {
+                ti->hooks.move_ctor(dst, values[j], 1, ti);
+                ecs_value_fini_w_type_info(world, ti, values[j]);
+            } else {
+                ecs_os_memcpy(dst, values[j], size);
+            }
+            flecs_free(&world->allocator, size, values[j]);
+        }
+        ecs_vec_clear(&batch->values[i]);
+    }
+
+    desc.data = data;
+    ecs_bulk_init(world, &desc);
+    state->bulk_count ++;
+
+    for (i = 0; i < batch->id_count; i ++) {
+        const ecs_type_info_t *ti = batch->type_info[i];
+        if (ti) {
+            ecs_xtor_t dtor = ti->hooks.dtor;
+            if (dtor) {
+                dtor(data[i], count, ti);
+            }
+            ecs_os_free(data[i]);
+        }
+    }
+
+    ecs_vec_clear(&batch->entities);
+    flecs_name_index_fini(&batch->names);
+    flecs_name_index_init(&batch->names, NULL);
+}
+
+/* Add the row of the last statement to the batch. A row is created by itself
+ * if it has a component that wasn't assigned a value, as ecs_bulk_init would
+ * invoke OnSet for it, or if its components have OnAdd or OnSet observers, as
+ * those would run for all rows at once while the world is deferred. The pairs
+ * of a row are its parent and name, for which the builtin observers and hooks
+ * handle any number of entities. */
+static
+void plecs_row_commit(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    plecs_row_t *row = &state->row;
+    plecs_batch_t *batch = &state->batch;
+    ecs_entity_t e = row->entity;
+    if (!e) {
+        return;
+    }
+
+    row->entity = 0;
+
+    int32_t i, count = row->id_count;
+    if (count != batch->id_count || ecs_os_memcmp(row->ids, batch->ids, 
+        count * ECS_SIZEOF(ecs_id_t))) 
+    {
+        plecs_batch_flush(world, state);
+
+        ecs_flags32_t observed = EcsIdHasOnAdd|EcsIdHasOnSet;
+        batch->observed = world->idr_wildcard->flags & observed;
+        for (i = 0; i < count; i ++) {
+            ecs_id_t id = batch->ids[i] = row->ids[i];
+            batch->type_info[i] = ecs_get_type_info(world, id);
+            if (!ECS_IS_PAIR(id)) {
+                ecs_id_record_t *idr = flecs_id_record_get(world, id);
+                batch->observed |= idr && (idr->flags & observed);
+            }
+        }
+        batch->id_count = count;
+    }
+
+    bool batched = !batch->observed;
+    for (i = 0; batched && i < count; i ++) {
+        batched = !batch->type_info[i] || row->values[i];
+    }
+
+    if (batched) {
+        ecs_vec_append_t(NULL, &batch->entities, ecs_entity_t)[0] = e;
+        for (i = 0; i < count; i ++) {
+            if (batch->type_info[i]) {
+                ecs_vec_append_t(NULL, &batch->values[i], void*)[0] = 
+                    row->values[i];
+            }
+        }
+        flecs_name_index_ensure(&batch->names, e, row->name, 0, 0);
+        return;
+    }
+
+    plecs_batch_flush(world, state);
+
+    for (i = 0; i < count; i ++) {
+        void *value = row->values[i];
+        if (value) {
+            const ecs_type_info_t *ti = batch->type_info[i];
+            ecs_set_id(world, e, row->ids[i], flecs_itosize(ti->size), value);
+            plecs_value_free(world, ti, value);
+        } else {
+            ecs_add_id(world, e, row->ids[i]);
+        }
+    }
+}
+
+/* Create the entities that weren't created yet */
+static
+void plecs_flush(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    plecs_row_commit(world, state);
+    plecs_batch_flush(world, state);
+}
+
+/* Start the row for the entity of a new statement. Returns 0 if the entity
+ * can't be created in bulk, in which case it's created right away. */
+static
+ecs_entity_t plecs_row_new(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    const char *path)
+{
+    if (!state->bulk || strchr(path, '.') || ecs_get_with(world)) {
+        return 0;
+    }
+
+    plecs_row_commit(world, state);
+
+    plecs_row_t *row = &state->row;
+    row->entity = ecs_new_id(world);
+    row->id_count = 0;
+
+    ecs_entity_t scope = ecs_get_scope(world);
+    if (scope) {
+        row->ids[row->id_count] = ecs_childof(scope);
+        row->values[row->id_count ++] = NULL;
+    }
+
+    EcsIdentifier *name = ecs_value_new(world, ecs_id(EcsIdentifier));
+    name->value = ecs_os_strdup(path);
+    row->name = name->value;
+    row->ids[row->id_count] = ecs_pair(ecs_id(EcsIdentifier), EcsName);
+    row->values[row->id_count ++] = name;
+
+    return row->entity;
+}
+
+/* Add id to the row of the statement. Returns the index of the id in the row, 
+ * or -1 if the entity had to be created, because the id is a pair (which can
+ * replace other ids) or the row is full. */
+static
+int32_t plecs_row_add(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_id_t id)
+{
+    plecs_row_t *row = &state->row;
+    if (!(id & ECS_ID_FLAGS_MASK) && row->id_count < (ECS_ID_CACHE_SIZE - 1)) {
+        int32_t i;
+        for (i = 0; i < row->id_count; i ++) {
+            if (row->ids[i] == id) {
+                return i;
+            }
+        }
+
+        row->ids[i] = id;
+        row->values[i] = NULL;
+        return row->id_count ++;
+    }
+
+    plecs_flush(world, state);
+    return -1;
+}
+
+static
+void plecs_add_id(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t e,
+    ecs_id_t id)
+{
+    if (e == state->row.entity && plecs_row_add(world, state, id) != -1) {
+        return;
+    }
+
+    ecs_add_id(world, e, id);
+}
+
+static
+void* plecs_get_mut(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t e,
+    ecs_id_t id,
+    ecs_entity_t type)
+{
+    if (e == state->row.entity) {
+        int32_t i = plecs_row_add(world, state, id);
+        if (i != -1) {
+            void **value = &state->row.values[i];
+            if (!value[0]) {
+                value[0] = ecs_value_new(world, type);
+            }
+            return value[0];
+        }
+    }
+
+    return ecs_get_mut_id(world, e, id);
+}
+
+/* Find an entity in the current scope that wasn't created yet */
+static
+ecs_entity_t plecs_pending_find(
+    plecs_state_t *state,
+    const char *name)
+{
+    plecs_row_t *row = &state->row;
+    if (row->entity && !ecs_os_strcmp(row->name, name)) {
+        return row->entity;
+    }
+
+    if (!ecs_vec_count(&state->batch.entities)) {
+        return 0;
+    }
+
+    return flecs_name_index_find(&state->batch.names, name, 0, 0);
+}
+
+/* Before a path is resolved in the world, create the entities that weren't 
+ * created yet if the path starts with one of them */
+static
+void plecs_pending_flush(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    const char *path)
+{
+    if (!state->row.entity && !ecs_vec_count(&state->batch.entities)) {
+        return;
+    }
+
+    const char *sep = strchr(path, '.');
+    if (!sep) {
+        if (plecs_pending_find(state, path)) {
+            plecs_flush(world, state);
+        }
+        return;
+    }
+
+    ecs_size_t len = flecs_ito(ecs_size_t, sep - path);
+    char *name = ecs_os_malloc(len + 1);
+    ecs_os_memcpy(name, path, len);
+    name[len] = '\0';
+    if (plecs_pending_find(state, name)) {
+        plecs_flush(world, state);
+    }
+    ecs_os_free(name);
+}
+
+static
+ecs_entity_t plecs_lookup(
+    const ecs_world_t *world,
+    const char *path,
+    plecs_state_t *state,
+    ecs_entity_t rel,
+    bool is_subject)
+{
+    ecs_entity_t e = 0;
+    ecs_entity_t scope = ecs_get_scope(world);
+
+    if (!is_subject) {
+        ecs_entity_t oneof = 0;
+        if (rel) {
+            if (ecs_has_id(world, rel, EcsOneOf)) {
+                oneof = rel;
+            } else {
+                oneof = ecs_get_target(world, rel, EcsOneOf, 0);
+            }
+            if (oneof) {
+                return ecs_lookup_path_w_sep(
+                    world, oneof, path, NULL, NULL, false);
+            }
+        }
+
+        /* Identifiers that aren't subjects are resolved recursively and in
+         * the using scopes, which is expensive for components that are used
+         * by every statement in a scope. */
+        ecs_hashed_string_t key = flecs_get_hashed_string(path, 0, 0);
+        e = plecs_cache_get(world, state, scope, &key);
+        if (e) {
+            state->cache_hit_count ++;
+            return e;
+        }
+
+        int using_scope = state->using_frame - 1;
+        for (; using_scope >= 0; using_scope--) {
+            e = ecs_lookup_path_w_sep(
+                world, state->using[using_scope], path, NULL, NULL, false);
+            if (e) {
+                break;
+            }
+        }
+
+        /* Entities of statements that weren't created yet are only found
+         * here while parsing values, which only need the entity id */
+        if (!e && (e = plecs_pending_find(state, path))) {
+            return e;
+        }
+
+        if (!e) {
+            e = ecs_lookup_path_w_sep(world, 0, path, NULL, NULL, true);
+        }
+
+        if (e) {
+            plecs_cache_set(state, scope, &key, e);
+        }
+
+        return e;
+    }
+
+    return ecs_lookup_path_w_sep(world, 0, path, NULL, NULL, false);
+}
+
+/* Lookup action used for deserializing entity refs in component values */
+#ifdef FLECS_EXPR
+static
+ecs_entity_t plecs_lookup_action(
+    const ecs_world_t *world,
+    const char *path,
+    void *ctx)
+{
+    return plecs_lookup(world, path, ctx, 0, false);
+}
+#endif
+
+static
+ecs_entity_t plecs_new_entity(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t e,
+    const char *path,
+    bool is_stmt_subject)
+{
+    plecs_cache_invalidate(state, path);
+    state->entity_count ++;
+
+    /* The subject of a statement is created in bulk with the subjects of the
+     * statements after it that have the same ids */
+    if (is_stmt_subject) {
+        ecs_entity_t row = plecs_row_new(world, state, path);
+        if (row) {
+            return row;
+        }
+    }
+
+    return ecs_add_path(world, e, 0, path);
+}
+
+static
+ecs_entity_t plecs_ensure_entity(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    const char *path,
+    ecs_entity_t rel,
+    bool is_subject)
+{
+    if (!path) {
+        return 0;
+    }
+
+    ecs_entity_t e = 0;
+    bool is_anonymous = !ecs_os_strcmp(path, "_");
+    if (is_anonymous) {
+        path = NULL;
+        e = ecs_new_id(world);
+    }
+
+    if (!e) {
+        plecs_pending_flush(world, state, path);
+        e = plecs_lookup(world, path, state, rel, is_subject);
+    }
+
+    if (!e) {
+        if (rel && flecs_get_oneof(world, rel)) {
+            /* If relationship has oneof and entity was not found, don't proceed
+             * with creating an entity as this can cause asserts later on */
+            char *relstr = ecs_get_fullpath(world, rel);
+            ecs_parser_error(state->name, 0, 0, 
+                "invalid identifier '%s' for relationship '%s'", path, relstr);
+            ecs_os_free(relstr);
+            return 0;
+        }
+
+        if (!is_subject) {
+            /* If this is not a subject create an existing empty id, which 
+             * ensures that scope & with are not applied */
+            e = ecs_new_id(world);
+        }
+
+        e = plecs_new_entity(world, state, e, path, is_subject && !rel);
+        ecs_assert(e != 0, ECS_INTERNAL_ERROR, NULL);
+    } else {
+        /* If entity exists, make sure it gets the right scope and with */
+        if (is_subject) {
+            ecs_entity_t scope = ecs_get_scope(world);
+            if (scope) {
+                ecs_add_pair(world, e, EcsChildOf, scope);
+            }
+
+            ecs_entity_t with = ecs_get_with(world);
+            if (with) {
+                ecs_add_id(world, e, with);
+            }
+        }
+    }
+
+    return e;
+}
+
+static
+bool plecs_pred_is_subj(
+    ecs_term_t *term,
+    plecs_state_t *state)
+{
+    if (term->src.name != NULL) {
+        return false;
+    }
+    if (term->second.name != NULL) {
+        return false;
+    }
+    if (ecs_term_match_0(term)) {
+        return false;
+    }
+    if (state->with_stmt) {
+        return false;
+    }
+    if (state->assign_stmt) {
+        return false;
+    }
+    if (state->isa_stmt) {
+        return false;
+    }
+    if (state->using_stmt) {
+        return false;
+    }
+    if (state->decl_type) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Set masks aren't useful in plecs, so translate them back to entity names */
+static
+const char* plecs_set_mask_to_name(
+    ecs_flags32_t flags) 
+{
+    flags &= EcsTraverseFlags;
+    if (flags == EcsSelf) {
+        return "self";
+    } else if (flags == EcsUp) {
+        return "up";
+    } else if (flags == EcsDown) {
+        return "down";
+    } else if (flags == EcsCascade || flags == (EcsUp|EcsCascade)) {
+        return "cascade";
+    } else if (flags == EcsParent) {
+        return "parent";
+    }
+    return NULL;
+}
+
+static
+char* plecs_trim_annot(
+    char *annot)
+{
+    annot = (char*)ecs_parse_whitespace(annot);
+    int32_t len = ecs_os_strlen(annot) - 1;
+    while (isspace(annot[len]) && (len > 0)) {
+        annot[len] = '\0';
+        len --;
+    }
+    return annot;
+}
+
+static
+void plecs_apply_annotations(
     ecs_world_t *world,
     ecs_entity_t subj,
     plecs_state_t *state)
@@ -19783,10 +22218,10 @@ int plecs_create_term(
 
     if (subj) {
         if (!obj) {
-            ecs_add_id(world, subj, pred);
+            plecs_add_id(world, state, subj, pred);
             state->last_assign_id = pred;
         } else {
-            ecs_add_pair(world, subj, pred, obj);
+            plecs_add_id(world, state, subj, ecs_pair(pred, obj));
             state->last_object = obj;
             state->last_assign_id = ecs_pair(pred, obj);
         }
@@ -19832,13 +22267,14 @@ int plecs_create_term(
 
         state->using[state->using_frame ++] = pred;
         state->using_frames[state->sp] = state->using_frame;
+        plecs_cache_clear(state);
 
     /* If this is not a with/using clause, add with frames to subject */
     } else {
         if (subj) {
             int32_t i, frame_count = state->with_frames[state->sp];
             for (i = 0; i < frame_count; i ++) {
-                ecs_add_id(world, subj, state->with[i]);
+                plecs_add_id(world, state, subj, state->with[i]);
             }
         }
     }
@@ -19846,7 +22282,7 @@ int plecs_create_term(
     /* If an id was provided by itself, add default scope type to it */
     ecs_entity_t default_scope_type = state->default_scope_type[state->sp];
     if (pred_as_subj && default_scope_type) {
-        ecs_add_id(world, subj, default_scope_type);
+        plecs_add_id(world, state, subj, default_scope_type);
     }
 
     /* If annotations preceded the statement, append */
@@ -19857,6 +22293,10 @@ int plecs_create_term(
             return -1;
         }
 
+        if (subj == state->row.entity) {
+            plecs_flush(world, state);
+        }
+
         plecs_apply_annotations(world, subj, state);
     }
 
@@ -19992,7 +22432,7 @@ const char* plecs_parse_assign_expr(
         return NULL;
     }
 
-    void *value_ptr = ecs_get_mut_id(world, assign_to, assign_id);
+    void *value_ptr = plecs_get_mut(world, state, assign_to, assign_id, type);
 
     ptr = ecs_parse_expr(world, ptr, &(ecs_value_t){type, value_ptr}, 
         &(ecs_parse_expr_desc_t){
@@ -20006,7 +22446,9 @@ const char* plecs_parse_assign_expr(
         return NULL;
     }
 
-    ecs_modified_id(world, assign_to, assign_id);
+    if (assign_to != state->row.entity) {
+        ecs_modified_id(world, assign_to, assign_id);
+    }
 #endif
 
     return ptr;
@@ -20155,6 +22597,9 @@ const char* plecs_parse_scope_open(
         return NULL;
     }
 
+    /* Entities are created in bulk per scope */
+    plecs_flush(world, state);
+
     state->sp ++;
 
     ecs_entity_t scope = 0;
@@ -20225,6 +22670,8 @@ const char* plecs_parse_scope_close(
         return NULL;
     }
 
+    plecs_flush(world, state);
+
     state->scope[state->sp] = 0;
     state->default_scope_type[state->sp] = 0;
     state->sp --;
@@ -20245,7 +22692,10 @@ const char* plecs_parse_scope_close(
     }
 
     state->with_frame = state->with_frames[state->sp];
-    state->using_frame = state->using_frames[state->sp];
+    if (state->using_frame != state->using_frames[state->sp]) {
+        state->using_frame = state->using_frames[state->sp];
+        plecs_cache_clear(state);
+    }
     state->last_subject = 0;
     state->assign_stmt = false;
 
@@ -20290,7 +22740,7 @@ const char *plecs_parse_plecs_term(
     }
 
     if (decl_id && state->last_subject) {
-        ecs_add_id(world, state->last_subject, decl_id);
+        plecs_add_id(world, state, state->last_subject, decl_id);
     }
 
     state->decl_type = false;
@@ -20527,114 +22977,335 @@ error:
     return NULL;
 }
 
-int ecs_plecs_from_str(
+static
+void plecs_state_init(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    (void)world;
+    ecs_map_init(&state->lookup_cache, NULL);
+    flecs_name_index_init(&state->lookup_names, NULL);
+
+    /* ecs_bulk_init can't be deferred */
+    state->bulk = ecs_poly_is(world, ecs_world_t) && !ecs_is_deferred(world) &&
+        !(world->flags & EcsWorldReadonly);
+    ecs_vec_init_t(NULL, &state->batch.entities, ecs_entity_t, 0);
+    int32_t i;
+    for (i = 0; i < ECS_ID_CACHE_SIZE; i ++) {
+        ecs_vec_init_t(NULL, &state->batch.values[i], void*, 0);
+    }
+    flecs_name_index_init(&state->batch.names, NULL);
+#ifdef FLECS_EXPR
+    ecs_vars_init(world, &state->vars);
+#endif
+}
+
+/* Restore scope & with of the world and check that the script was complete */
+static
+int plecs_state_fini(
     ecs_world_t *world,
     const char *name,
-    const char *expr) 
+    const char *expr,
+    plecs_state_t *state,
+    ecs_entity_t prev_scope,
+    ecs_entity_t prev_with,
+    int result)
 {
-    const char *ptr = expr;
-    ecs_term_t term = {0};
-    plecs_state_t state = {0};
+    plecs_flush(world, state);
+    plecs_clear_annotations(state);
 
-    if (!expr) {
-        return 0;
+    if (!result) {
+        ecs_set_scope(world, prev_scope);
+        ecs_set_with(world, prev_with);
+
+        if (state->sp != 0) {
+            ecs_parser_error(name, expr, 0, "missing end of scope");
+            result = -1;
+        } else if (state->assign_stmt) {
+            ecs_parser_error(name, expr, 0, "unfinished assignment");
+            result = -1;
+        } else if (state->errors) {
+            result = -1;
+        }
     }
 
-    state.scope[0] = 0;
-    ecs_entity_t prev_scope = ecs_set_scope(world, 0);
-    ecs_entity_t prev_with = ecs_set_with(world, 0);
+    if (result) {
+        ecs_set_scope(world, state->scope[0]);
+        ecs_set_with(world, prev_with);
+    }
 
+    plecs_cache_clear(state);
+    ecs_map_fini(&state->lookup_cache);
+    flecs_name_index_fini(&state->lookup_names);
+
+    int32_t i;
+    for (i = 0; i < ECS_ID_CACHE_SIZE; i ++) {
+        ecs_vec_fini_t(NULL, &state->batch.values[i], void*);
+    }
+    ecs_vec_fini_t(NULL, &state->batch.entities, ecs_entity_t);
+    flecs_name_index_fini(&state->batch.names);
 #ifdef FLECS_EXPR
-    ecs_vars_init(world, &state.vars);
+    ecs_vars_fini(&state->vars);
 #endif
+    return result;
+}
+
+/* Parse all statements in a string */
+static
+int plecs_parse_stmts(
+    ecs_world_t *world,
+    const char *name,
+    const char *expr,
+    plecs_state_t *state)
+{
+    const char *ptr = expr;
 
     do {
-        expr = ptr = plecs_parse_stmt(world, name, expr, ptr, &state);
+        expr = ptr = plecs_parse_stmt(world, name, expr, ptr, state);
         if (!ptr) {
-            goto error;
+            return -1;
         }
+    } while (ptr[0]);
 
-        if (!ptr[0]) {
-            break; /* End of expression */
+    return 0;
+}
+
+static
+bool plecs_stmt_continues(
+    char ch)
+{
+    return ch == ',' || ch == ':' || ch == '-' || ch == '=' || ch == '@';
+}
+
+/* Find the end of the last complete statement in a buffer with the start of
+ * a file. Statements can span multiple lines, so a newline only ends one when
+ * it isn't in a string, value or pair, when the line doesn't end with a token
+ * that continues the statement (like ',' and ':-'), when the next line doesn't
+ * start with one (like '{' and ','), and when the line isn't an annotation.
+ * Returns zero if the buffer doesn't contain a complete statement. The buffer
+ * must be terminated at len, as runs of characters that can't change the
+ * state (identifiers, numbers, spaces) are skipped with strcspn. */
+static
+ecs_size_t plecs_chunk_end(
+    const char *buf,
+    ecs_size_t len)
+{
+    ecs_size_t i, end = 0, newline = 0;
+    int32_t depth = 0; /* nesting of (), [] and braces of values */
+    bool assign = false; /* in assignment, braces enclose values */
+    bool stmt_start = true;
+    char prev = 0; /* last token character */
+
+    for (i = 0; i < len; i ++) {
+        /* Only the first and last non-space character of a run matter: the
+         * first ends the statement on the previous line unless it continues
+         * it, the last is the token a newline checks. */
+        ecs_size_t run = (ecs_size_t)strcspn(&buf[i], "\n/\"@-=()[]{}");
+        ecs_size_t first = i, last = i + run;
+        while (first < last && isspace(buf[first])) {
+            first ++;
+        }
+        while (last > first && isspace(buf[last - 1])) {
+            last --;
+        }
+        if (first < last) {
+            if (newline && buf[first] != ':' && buf[first] != ',') {
+                end = newline;
+                assign = false;
+            }
+            newline = 0;
+            prev = buf[last - 1];
+            stmt_start = false;
         }
-    } while (true);
 
-    ecs_set_scope(world, prev_scope);
-    ecs_set_with(world, prev_with);
-    plecs_clear_annotations(&state);
+        i += run;
+        if (i >= len) {
+            break;
+        }
 
-    if (state.sp != 0) {
-        ecs_parser_error(name, expr, 0, "missing end of scope");
-        goto error;
-    }
+        char ch = buf[i];
 
-    if (state.assign_stmt) {
-        ecs_parser_error(name, expr, 0, "unfinished assignment");
-        goto error;
+        if (ch == TOK_NEWLINE) {
+            if (!depth && !plecs_stmt_continues(prev)) {
+                newline = i + 1;
+            }
+            continue;
+        }
+
+        if (ch == '/' && (i + 1) < len && buf[i + 1] == '/') {
+            while (i < len && buf[i] != TOK_NEWLINE) {
+                i ++;
+            }
+            i --; /* Process the newline */
+            continue;
+        }
+
+        if (newline) {
+            if (ch != '{') {
+                end = newline;
+                assign = false;
+                stmt_start = true;
+            }
+            newline = 0;
+        }
+
+        if (ch == '"') {
+            for (i ++; i < len && buf[i] != '"'; i ++) {
+                if (buf[i] == '\\') {
+                    i ++;
+                }
+            }
+            if (i >= len) {
+                break;
+            }
+        } else if (stmt_start && ch == '@') {
+            /* Annotations apply to the statement on the next line */
+            while (i < len && buf[i] != TOK_NEWLINE) {
+                i ++;
+            }
+            i --;
+            prev = ch;
+            continue;
+        } else if (ch == '-' && (stmt_start || prev == ':')) {
+            assign = true;
+        } else if (ch == '=') {
+            assign = true;
+        } else if (ch == '(' || ch == '[') {
+            depth ++;
+        } else if (ch == ')' || ch == ']') {
+            depth -= depth != 0;
+        } else if (ch == '{') {
+            depth += depth || assign; /* Scope open ends the statement */
+        } else if (ch == '}') {
+            depth -= depth != 0; /* Scope close ends the statement */
+        }
+
+        prev = ch;
+        stmt_start = false;
     }
 
-    if (state.errors) {
-        goto error;
+    return end;
+}
+
+int ecs_plecs_from_str(
+    ecs_world_t *world,
+    const char *name,
+    const char *expr) 
+{
+    plecs_state_t state = {0};
+
+    if (!expr) {
+        return 0;
     }
 
-#ifdef FLECS_EXPR
-    ecs_vars_fini(&state.vars);
-#endif
-    return 0;
-error:
-#ifdef FLECS_EXPR
-    ecs_vars_fini(&state.vars);
-#endif
-    ecs_set_scope(world, state.scope[0]);
-    ecs_set_with(world, prev_with);
-    ecs_term_fini(&term);
-    return -1;
+    state.scope[0] = 0;
+    ecs_entity_t prev_scope = ecs_set_scope(world, 0);
+    ecs_entity_t prev_with = ecs_set_with(world, 0);
+    plecs_state_init(world, &state);
+
+    int result = plecs_parse_stmts(world, name, expr, &state);
+    return plecs_state_fini(
+        world, name, expr, &state, prev_scope, prev_with, result);
 }
 
 int ecs_plecs_from_file(
     ecs_world_t *world,
     const char *filename) 
+{
+    return ecs_plecs_from_file_w_stats(world, filename, NULL);
+}
+
+int ecs_plecs_from_file_w_stats(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_plecs_load_t *stats)
 {
     FILE* file;
-    char* content = NULL;
-    int32_t bytes;
-    size_t size;
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
 
     /* Open file for reading */
     ecs_os_fopen(&file, filename, "r");
     if (!file) {
         ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
-        goto error;
+        return -1;
     }
 
-    /* Determine file size */
-    fseek(file, 0 , SEEK_END);
-    bytes = (int32_t)ftell(file);
-    if (bytes == -1) {
-        goto error;
-    }
-    rewind(file);
+    plecs_state_t state = {0};
+    ecs_entity_t prev_scope = ecs_set_scope(world, 0);
+    ecs_entity_t prev_with = ecs_set_with(world, 0);
+    plecs_state_init(world, &state);
 
-    /* Load contents in memory */
-    content = ecs_os_malloc(bytes + 1);
-    size = (size_t)bytes;
-    if (!(size = fread(content, 1, size, file)) && bytes) {
-        ecs_err("%s: read zero bytes instead of %d", filename, size);
-        ecs_os_free(content);
-        content = NULL;
-        goto error;
-    } else {
-        content[size] = '\0';
-    }
+    ecs_size_t size = PLECS_READ_SIZE, count = 0;
+    char *buf = ecs_os_malloc(size + 1);
+    int64_t byte_count = 0;
+    int32_t read_count = 0;
+    bool eof = false;
+    int result = 0;
+
+    do {
+        /* Read after the part of the previous read that wasn't parsed yet */
+        if (!eof) {
+            ecs_size_t read = (ecs_size_t)fread(
+                &buf[count], 1, (size_t)(size - count), file);
+            if (read < (size - count)) {
+                if (ferror(file)) {
+                    ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
+                    result = -1;
+                    break;
+                }
+                eof = true;
+            }
+            count += read;
+            byte_count += read;
+            read_count ++;
+        }
+
+        /* Parse complete statements, the rest is parsed after the next read */
+        buf[count] = '\0';
+        ecs_size_t end = eof ? count : plecs_chunk_end(buf, count);
+        if (!end) {
+            if (count == size) {
+                /* Statement doesn't fit in the buffer */
+                size *= 2;
+                buf = ecs_os_realloc(buf, size + 1);
+            }
+            continue;
+        }
+
+        char ch = buf[end];
+        buf[end] = '\0';
+        result = plecs_parse_stmts(world, filename, buf, &state);
+        buf[end] = ch;
+        if (result) {
+            break;
+        }
+
+        count -= end;
+        ecs_os_memmove(buf, &buf[end], count);
+    } while (!eof || count);
 
     fclose(file);
+    ecs_os_free(buf);
+
+    if (stats) {
+        stats->byte_count = byte_count;
+        stats->read_count = read_count;
+        stats->buffer_size = size;
+        stats->entity_count = state.entity_count;
+        stats->cache_hit_count = state.cache_hit_count;
+    }
+
+    result = plecs_state_fini(
+        world, filename, NULL, &state, prev_scope, prev_with, result);
+
+    if (stats) {
+        /* The last entities are created when the state is cleaned up */
+        stats->bulk_count = state.bulk_count;
+        stats->time_spent = (ecs_ftime_t)ecs_time_measure(&t);
+    }
 
-    int result = ecs_plecs_from_str(world, filename, content);
-    ecs_os_free(content);
     return result;
-error:
-    ecs_os_free(content);
-    return -1;
 }
 
 #endif
@@ -20642,11 +23313,130 @@ error:
 /**
  * @file addons/journal.c
  * @brief Journal addon.
+ *
+ * The binary journal is a ring of records in a file. Records are aligned to 8
+ * bytes and never wrap around the end of the ring, a pad record fills the space
+ * that is left. The file header stores the total number of bytes written (head)
+ * and the offset of the oldest record that has not been overwritten (tail), so
+ * a reader can find the first complete record.
+ *
+ * Records are appended to a buffer of FLECS_JOURNAL_FLUSH_SIZE bytes, which
+ * is written to the file at the end of every frame, when it is full and when
+ * the journal is closed. The buffer is reused after it is written, so that
+ * recording only touches memory that is already mapped and in the cache.
+ * Keeping a copy of the whole ring in memory instead page faulted on every new
+ * page, and writing through a shared mapping did the same for the file.
+ *
+ * Old records are not read back when the ring is full. The tail moves to a
+ * checkpoint, which is the head of an earlier flush, so a few records more
+ * than necessary can be dropped.
+ *
+ * Commit, Set and Delete records hold a range of entities. When the same
+ * operation is done on another entity right after, the entity (and value) is
+ * appended to the last record instead of writing a new one. Merging a burst of
+ * spawned entities then writes one record per id instead of one per entity.
+ * Values that are assigned to the entities of the last commit are written as
+ * one array, without the entities, which is most of the data of a burst.
+ *
+ * Entities are recorded as their id. The first time a named entity or a
+ * component is referenced, a declare record with its path and size is written
+ * so a replay can find it in another world. The writer remembers where each
+ * declare record is. When it is behind the tail or the entity is renamed, the
+ * entity is declared again the next time it is used.
  */
 
 
 #ifdef FLECS_JOURNAL
 
+#ifdef ECS_TARGET_WINDOWS
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define FLECS_JOURNAL_MAGIC "FLJR"
+#define FLECS_JOURNAL_VERSION (3)
+#define FLECS_JOURNAL_FLUSH_SIZE (1024 * 1024)
+#define FLECS_JOURNAL_RANGE_MAX (64 * 1024)
+#define FLECS_JOURNAL_CHECKPOINT_COUNT (1024)
+
+/* The entity of a record is the first entity of a range, the payload ends with
+ * the other entities. Set records repeat (entity, value) for each of them. */
+typedef enum {
+    EcsJournalOpPad,
+    EcsJournalOpDeclare,   /* payload: u32 size, path */
+    EcsJournalOpCommit,    /* payload: u32 add count, u32 remove count, ids,
+                            *          entities */
+    EcsJournalOpSet,       /* payload: u32 value size, u32 0, value, 
+                            *          (entity, value)... 
+                            * values are aligned to 8, empty if not copyable */
+    EcsJournalOpName,      /* payload: name */
+    EcsJournalOpClear,
+    EcsJournalOpDelete,    /* payload: entities */
+    EcsJournalOpDeleteWith,
+    EcsJournalOpRemoveAll,
+    EcsJournalOpSetValues  /* payload: u32 value size, u32 count, values
+                            * values are for the last count entities of the
+                            * last Commit record and are not aligned */
+} ecs_journal_op_t;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t capacity;      /* Size of the ring */
+    uint64_t head;          /* Total number of bytes written */
+    uint64_t tail;          /* Total offset of oldest record */
+    uint64_t record_count;  /* Number of records written */
+    uint64_t reserved[3];
+} ecs_journal_header_t;
+
+typedef struct {
+    uint8_t op;
+    uint8_t reserved;
+    uint16_t alignment;     /* Alignment of value (Declare, Set) */
+    uint32_t size;          /* Size of record including header */
+    uint64_t entity;
+    uint64_t id;
+} ecs_journal_record_t;
+
+struct ecs_journal_writer_t {
+    ecs_journal_header_t header;
+    char *buf;              /* Records since the last flush */
+    uint64_t buf_size;
+    uint64_t capacity;
+    uint64_t offset;        /* Offset of head in the ring */
+    uint64_t range_limit;   /* Max size of a record that entities are added to */
+    uint64_t flushed;       /* Value of head when the file was last written */
+    bool failed;            /* Writing the file failed, stop recording */
+    ecs_journal_record_t *range; /* Last record, if entities can be added */
+    ecs_journal_record_t *commit; /* Last Commit record, if not written yet */
+    ecs_map_t declared;     /* Offset of declare record + 1, by entity */
+    uint64_t declared_lo[ECS_HI_COMPONENT_ID]; /* Same, for component ids */
+
+    /* Heads of earlier flushes, which the tail can move to */
+    uint64_t checkpoints[FLECS_JOURNAL_CHECKPOINT_COUNT];
+    int32_t checkpoint_first;
+    int32_t checkpoint_count;
+#ifdef ECS_TARGET_WINDOWS
+    HANDLE file;
+#else
+    int fd;
+#endif
+};
+
+/* Builtin ids are the same in every world and are never declared */
+static
+bool flecs_journal_is_builtin(
+    uint32_t index)
+{
+    return index < EcsFirstUserComponentId || 
+        (index >= ECS_HI_COMPONENT_ID && index < EcsFirstUserEntityId);
+}
+
 static
 char* flecs_journal_entitystr(
     ecs_world_t *world,
@@ -20657,7 +23447,7 @@ char* flecs_journal_entitystr(
     if (_path && !strchr(_path, '.')) {
         path = ecs_asprintf("#[blue]%s", _path);
     } else {
-        uint32_t gen = entity >> 32;
+        uint32_t gen = (uint32_t)ECS_GENERATION(entity);
         if (gen) {
             path = ecs_asprintf("#[normal]_%u_%u", (uint32_t)entity, gen);
         } else {
@@ -20689,6 +23479,472 @@ char* flecs_journal_idstr(
     }
 }
 
+static
+int flecs_journal_write_file(
+    ecs_journal_writer_t *j,
+    uint64_t offset,
+    const void *data,
+    size_t size)
+{
+#ifdef ECS_TARGET_WINDOWS
+    while (size) {
+        DWORD written = 0;
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        OVERLAPPED ov = {0};
+        ov.Offset = (DWORD)offset;
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+        if (!WriteFile(j->file, data, chunk, &written, &ov) || !written) {
+            return -1;
+        }
+        data = ECS_OFFSET(data, written);
+        offset += written;
+        size -= written;
+    }
+#else
+    while (size) {
+        ssize_t written = pwrite(j->fd, data, size, (off_t)offset);
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data = ECS_OFFSET(data, written);
+        offset += (uint64_t)written;
+        size -= (size_t)written;
+    }
+#endif
+    return 0;
+}
+
+/* Write the records appended since the last flush, then the header */
+static
+int flecs_journal_flush(
+    ecs_journal_writer_t *j)
+{
+    ecs_journal_header_t *hdr = &j->header;
+    if (j->failed) {
+        return -1;
+    }
+
+    /* Records don't wrap around the end of the ring, but the buffer can */
+    uint64_t offset = j->flushed;
+    const char *data = j->buf;
+    while (offset < hdr->head) {
+        uint64_t start = offset % j->capacity;
+        uint64_t size = hdr->head - offset;
+        if (size > (j->capacity - start)) {
+            size = j->capacity - start;
+        }
+        if (flecs_journal_write_file(j, 
+            (uint64_t)ECS_SIZEOF(ecs_journal_header_t) + start, 
+            data, (size_t)size)) 
+        {
+            goto error;
+        }
+        data += size;
+        offset += size;
+    }
+
+    if (flecs_journal_write_file(j, 0, hdr, 
+        (size_t)ECS_SIZEOF(ecs_journal_header_t))) 
+    {
+        goto error;
+    }
+
+    /* The file has the record as it is now, so it can't grow anymore. Values
+     * can't refer to a commit that may be dropped before them. */
+    j->range = NULL;
+    j->commit = NULL;
+
+    /* Keep checkpoints spread out over the ring */
+    int32_t count = j->checkpoint_count;
+    uint64_t last = count ? j->checkpoints[(j->checkpoint_first + count - 1) % 
+        FLECS_JOURNAL_CHECKPOINT_COUNT] : hdr->tail;
+    if (count < FLECS_JOURNAL_CHECKPOINT_COUNT && 
+        (hdr->head - last) >= (j->capacity / FLECS_JOURNAL_CHECKPOINT_COUNT)) 
+    {
+        j->checkpoints[(j->checkpoint_first + count) % 
+            FLECS_JOURNAL_CHECKPOINT_COUNT] = hdr->head;
+        j->checkpoint_count ++;
+    }
+
+    j->flushed = hdr->head;
+    return 0;
+error:
+    ecs_err("journal: failed to write: %s", ecs_os_strerror(errno));
+    j->failed = true;
+    return -1;
+}
+
+/* Move the tail to the first checkpoint that leaves room for size bytes. The
+ * buffer is at most half the ring, so the last flush is always far enough. */
+static
+void flecs_journal_make_room(
+    ecs_journal_writer_t *j,
+    uint64_t size)
+{
+    ecs_journal_header_t *hdr = &j->header;
+    uint64_t tail = hdr->head + size - j->capacity;
+    if ((hdr->head + size) <= j->capacity || tail <= hdr->tail) {
+        return;
+    }
+
+    while (j->checkpoint_count) {
+        uint64_t checkpoint = j->checkpoints[j->checkpoint_first];
+        j->checkpoint_first = (j->checkpoint_first + 1) % 
+            FLECS_JOURNAL_CHECKPOINT_COUNT;
+        j->checkpoint_count --;
+        if (checkpoint >= tail) {
+            hdr->tail = checkpoint;
+            return;
+        }
+    }
+
+    ecs_assert(j->flushed >= tail, ECS_INTERNAL_ERROR, NULL);
+    hdr->tail = j->flushed;
+}
+
+/* Move the head, records end before or at the end of the ring */
+static
+void flecs_journal_advance(
+    ecs_journal_writer_t *j,
+    uint64_t size)
+{
+    j->header.head += size;
+    j->offset += size;
+    if (j->offset == j->capacity) {
+        j->offset = 0;
+    }
+}
+
+static
+void* flecs_journal_append(
+    ecs_journal_writer_t *j,
+    ecs_journal_op_t op,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    ecs_size_t payload_size)
+{
+    ecs_assert(payload_size >= 0, ECS_INVALID_PARAMETER, NULL);
+    uint64_t size = (uint64_t)ECS_ALIGN(
+        (size_t)(ECS_SIZEOF(ecs_journal_record_t) + payload_size), 8);
+    if (j->failed || size > j->buf_size) {
+        return NULL;
+    }
+
+    ecs_journal_header_t *hdr = &j->header;
+    if ((hdr->head - j->flushed + size) > j->buf_size) {
+        /* Only complete records are flushed, so not after the append */
+        if (flecs_journal_flush(j)) {
+            return NULL;
+        }
+    }
+
+    /* The pad is written by itself, so it doesn't take up the buffer */
+    uint64_t remaining = j->capacity - j->offset;
+    if (remaining < size) {
+        if (flecs_journal_flush(j)) {
+            return NULL;
+        }
+        flecs_journal_make_room(j, remaining);
+        ecs_journal_record_t pad = { .op = EcsJournalOpPad, 
+            .size = (uint32_t)remaining };
+        if (flecs_journal_write_file(j, (uint64_t)ECS_SIZEOF(
+            ecs_journal_header_t) + j->offset, &pad, 
+                (size_t)(remaining < ECS_SIZEOF(pad) ? 
+                    remaining : ECS_SIZEOF(pad))))
+        {
+            ecs_err("journal: failed to write: %s", ecs_os_strerror(errno));
+            j->failed = true;
+            return NULL;
+        }
+        flecs_journal_advance(j, remaining);
+        j->flushed = hdr->head;
+    }
+
+    flecs_journal_make_room(j, size);
+    ecs_journal_record_t *r = ECS_CAST(ecs_journal_record_t*, 
+        &j->buf[hdr->head - j->flushed]);
+    r->op = (uint8_t)op;
+    r->reserved = 0;
+    r->alignment = 0;
+    r->size = (uint32_t)size;
+    r->entity = entity;
+    r->id = id;
+    flecs_journal_advance(j, size);
+    hdr->record_count ++;
+    j->range = NULL;
+    return ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+}
+
+/* Number of entities after the first in a range record, given where they
+ * start and the size of the value that follows each entity */
+static
+int32_t flecs_journal_range_count(
+    const ecs_journal_record_t *r,
+    const void *elems,
+    ecs_size_t value_size)
+{
+    uintptr_t start = (uintptr_t)elems - (uintptr_t)r;
+    return (int32_t)(((uintptr_t)r->size - start) / 
+        (uintptr_t)(ECS_SIZEOF(uint64_t) + value_size));
+}
+
+/* Number of bytes that can be appended to the last record */
+static
+uint64_t flecs_journal_range_max(
+    ecs_journal_writer_t *j)
+{
+    ecs_journal_record_t *r = j->range;
+    if (!r || !j->offset || r->size >= j->range_limit) {
+        return 0;
+    }
+
+    /* The record is at the end of the ring and can't wrap around */
+    uint64_t space = j->range_limit - r->size;
+    if (space > (j->capacity - j->offset)) {
+        space = j->capacity - j->offset;
+    }
+    uint64_t buffered = j->header.head - j->flushed;
+    if (space > (j->buf_size - buffered)) {
+        space = j->buf_size - buffered;
+    }
+    return space;
+}
+
+/* Number of elements that can be appended to the last record */
+static
+int32_t flecs_journal_range_space(
+    ecs_journal_writer_t *j,
+    ecs_size_t elem_size)
+{
+    return (int32_t)(flecs_journal_range_max(j) / (uint64_t)elem_size);
+}
+
+/* Grow the last record by size bytes, if it is a range that can grow */
+static
+void* flecs_journal_extend(
+    ecs_journal_writer_t *j,
+    ecs_journal_op_t op,
+    ecs_id_t id,
+    ecs_size_t size)
+{
+    ecs_journal_record_t *r = j->range;
+    if (!r || r->op != op || r->id != id) {
+        return NULL;
+    }
+
+    uint64_t grow = (uint64_t)size;
+    if (flecs_journal_range_max(j) < grow) {
+        return NULL;
+    }
+
+    ecs_journal_header_t *hdr = &j->header;
+    void *result = &j->buf[hdr->head - j->flushed];
+    flecs_journal_make_room(j, grow);
+    r->size += (uint32_t)grow;
+    flecs_journal_advance(j, grow);
+    return result;
+}
+
+/* Component ids are in an array, other entities in the map */
+static
+uint64_t* flecs_journal_declared(
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity)
+{
+    if (entity < ECS_HI_COMPONENT_ID) {
+        return &j->declared_lo[entity];
+    }
+    return ecs_map_ensure(&j->declared, entity);
+}
+
+static
+void flecs_journal_undeclare(
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity)
+{
+    if (entity < ECS_HI_COMPONENT_ID) {
+        j->declared_lo[entity] = 0;
+    } else {
+        ecs_map_remove(&j->declared, entity);
+    }
+}
+
+static
+void flecs_journal_declare(
+    ecs_world_t *world,
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity)
+{
+    if (!entity || flecs_journal_is_builtin((uint32_t)entity)) {
+        return;
+    }
+
+    /* Components are declared for almost every record, so check those before
+     * looking up the entity */
+    if (entity < ECS_HI_COMPONENT_ID && 
+        j->declared_lo[entity] > j->header.tail) 
+    {
+        return;
+    }
+
+    /* Unnamed entities are created on replay when they're first used. Check
+     * the table flags first, so most entities don't need a map lookup. */
+    ecs_record_t *record = flecs_entities_try(world, entity);
+    if (!record || !record->table || !(record->table->flags & 
+        (EcsTableHasName | EcsTableHasBuiltins))) 
+    {
+        return;
+    }
+
+    /* Declared if the record is still in the ring */
+    uint64_t *declared = flecs_journal_declared(j, entity);
+    if (*declared > j->header.tail) {
+        return;
+    }
+
+    const char *name = ecs_get_name(world, entity);
+    const ecs_type_info_t *ti = flecs_type_info_get(world, entity);
+    if (!name && !ti) {
+        *declared = UINT64_MAX;
+        return;
+    }
+
+    char *path = name ? ecs_get_fullpath(world, entity) : NULL;
+    ecs_size_t len = path ? ecs_os_strlen(path) : 0;
+    uint32_t *payload = flecs_journal_append(j, EcsJournalOpDeclare, 
+        entity, 0, ECS_SIZEOF(uint32_t) + len + 1);
+    if (payload) {
+        ecs_journal_record_t *r = ECS_OFFSET(payload, 
+            -ECS_SIZEOF(ecs_journal_record_t));
+        payload[0] = ti ? (uint32_t)ti->size : 0;
+        r->alignment = ti ? (uint16_t)ti->alignment : 0;
+        char *str = ECS_OFFSET(payload, ECS_SIZEOF(uint32_t));
+        if (len) {
+            ecs_os_memcpy(str, path, len);
+        }
+        str[len] = '\0';
+        *flecs_journal_declared(j, entity) = j->header.head - r->size + 1;
+    }
+    ecs_os_free(path);
+}
+
+static
+void flecs_journal_declare_id(
+    ecs_world_t *world,
+    ecs_journal_writer_t *j,
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        flecs_journal_declare(world, j, ecs_pair_first(world, id));
+        flecs_journal_declare(world, j, ecs_pair_second(world, id));
+    } else {
+        flecs_journal_declare(world, j, id & ECS_COMPONENT_MASK);
+    }
+}
+
+static
+void flecs_journal_write(
+    ecs_world_t *world,
+    ecs_journal_writer_t *j,
+    ecs_journal_kind_t kind,
+    ecs_entity_t entity,
+    ecs_type_t *add,
+    ecs_type_t *remove)
+{
+    if (kind == EcsJournalMove) {
+        int32_t i, add_count = add ? add->count : 0;
+        int32_t remove_count = remove ? remove->count : 0;
+        if (!add_count && !remove_count) {
+            return;
+        }
+
+        flecs_journal_declare(world, j, entity);
+
+        /* Same ids as the last commit, add the entity to its range */
+        ecs_journal_record_t *range = j->range;
+        if (range && range->op == EcsJournalOpCommit) {
+            const uint32_t *counts = ECS_OFFSET(range, 
+                ECS_SIZEOF(ecs_journal_record_t));
+            const ecs_id_t *ids = ECS_OFFSET(counts, 
+                2 * ECS_SIZEOF(uint32_t));
+            if (counts[0] == (uint32_t)add_count && 
+                counts[1] == (uint32_t)remove_count &&
+                (!add_count || !ecs_os_memcmp(ids, add->array, 
+                    add_count * ECS_SIZEOF(ecs_id_t))) &&
+                (!remove_count || !ecs_os_memcmp(&ids[add_count], 
+                    remove->array, remove_count * ECS_SIZEOF(ecs_id_t))))
+            {
+                ecs_entity_t *e = flecs_journal_extend(j, EcsJournalOpCommit, 
+                    0, ECS_SIZEOF(ecs_entity_t));
+                if (e) {
+                    *e = entity;
+                    return;
+                }
+            }
+        }
+
+        for (i = 0; i < add_count; i ++) {
+            flecs_journal_declare_id(world, j, add->array[i]);
+        }
+        for (i = 0; i < remove_count; i ++) {
+            flecs_journal_declare_id(world, j, remove->array[i]);
+        }
+
+        uint32_t *payload = flecs_journal_append(j, EcsJournalOpCommit, 
+            entity, 0, 2 * ECS_SIZEOF(uint32_t) + 
+                (add_count + remove_count) * ECS_SIZEOF(ecs_id_t));
+        if (payload) {
+            payload[0] = (uint32_t)add_count;
+            payload[1] = (uint32_t)remove_count;
+            ecs_id_t *ids = ECS_OFFSET(payload, 2 * ECS_SIZEOF(uint32_t));
+            if (add_count) {
+                ecs_os_memcpy_n(ids, add->array, ecs_id_t, add_count);
+            }
+            if (remove_count) {
+                ecs_os_memcpy_n(&ids[add_count], remove->array, ecs_id_t, 
+                    remove_count);
+            }
+            j->range = j->commit = ECS_OFFSET(payload, 
+                -ECS_SIZEOF(ecs_journal_record_t));
+        }
+    } else if (kind == EcsJournalClear) {
+        flecs_journal_append(j, EcsJournalOpClear, entity, 0, 0);
+    } else if (kind == EcsJournalDelete) {
+        /* Entities that never had components don't exist on replay */
+        ecs_record_t *record = flecs_entities_try(world, entity);
+        if (!record || !record->table) {
+            return;
+        }
+
+        /* Only entities with a name or builtin component were declared */
+        if (record->table->flags & (EcsTableHasName | EcsTableHasBuiltins)) {
+            flecs_journal_undeclare(j, entity);
+        }
+
+        ecs_entity_t *e = flecs_journal_extend(j, EcsJournalOpDelete, 0, 
+            ECS_SIZEOF(ecs_entity_t));
+        if (e) {
+            *e = entity;
+            return;
+        }
+
+        void *payload = flecs_journal_append(
+            j, EcsJournalOpDelete, entity, 0, 0);
+        if (payload) {
+            j->range = ECS_OFFSET(payload, -ECS_SIZEOF(ecs_journal_record_t));
+        }
+    } else if (kind == EcsJournalDeleteWith) {
+        flecs_journal_declare_id(world, j, entity);
+        flecs_journal_append(j, EcsJournalOpDeleteWith, 0, entity, 0);
+    } else if (kind == EcsJournalRemoveAll) {
+        flecs_journal_declare_id(world, j, entity);
+        flecs_journal_append(j, EcsJournalOpRemoveAll, 0, entity, 0);
+    }
+}
+
 static int flecs_journal_sp = 0;
 
 void flecs_journal_begin(
@@ -20700,6 +23956,12 @@ void flecs_journal_begin(
 {
     flecs_journal_sp ++;
 
+    /* New ids can be created from stages, which are not recorded. Entities
+     * are created on replay when they are first used. */
+    if (kind != EcsJournalNew && world->journal) {
+        flecs_journal_write(world, world->journal, kind, entity, add, remove);
+    }
+
     if (ecs_os_api.log_level_ < FLECS_JOURNAL_LOG_LEVEL) {
         return;
     }
@@ -20768,6 +24030,810 @@ void flecs_journal_end(void) {
     ecs_log_pop();
 }
 
+/* Append a value to the last Set record if it's for the same id, or write a
+ * new record. The entity and id must have been declared. */
+static
+void flecs_journal_write_set(
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    const ecs_type_info_t *ti,
+    const void *ptr)
+{
+    /* Values with a copy hook can own resources, replay just adds those */
+    ecs_size_t size = ti->hooks.copy ? 0 : ti->size;
+    ecs_size_t aligned = ECS_ALIGN(size, 8);
+
+    uint64_t *elem = flecs_journal_extend(j, EcsJournalOpSet, id, 
+        ECS_SIZEOF(ecs_entity_t) + aligned);
+    if (elem) {
+        elem[0] = entity;
+        if (size) {
+            ecs_os_memcpy(&elem[1], ptr, size);
+        }
+        return;
+    }
+
+    uint32_t *payload = flecs_journal_append(j, EcsJournalOpSet, entity, id, 
+        2 * ECS_SIZEOF(uint32_t) + aligned);
+    if (payload) {
+        ecs_journal_record_t *r = ECS_OFFSET(payload, 
+            -ECS_SIZEOF(ecs_journal_record_t));
+        r->alignment = (uint16_t)ti->alignment;
+        payload[0] = (uint32_t)size;
+        payload[1] = 0;
+        if (size) {
+            ecs_os_memcpy(&payload[2], ptr, size);
+        }
+        j->range = r;
+    }
+}
+
+/* Write the values of entities that were just committed without repeating the
+ * entities. Returns false if the entities aren't the last of the commit. */
+static
+bool flecs_journal_write_values(
+    ecs_journal_writer_t *j,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    ecs_size_t size,
+    const void *ptr)
+{
+    ecs_journal_record_t *c = j->commit;
+    if (!c) {
+        return false;
+    }
+
+    const uint32_t *counts = ECS_OFFSET(c, ECS_SIZEOF(ecs_journal_record_t));
+    const uint64_t *committed = ECS_OFFSET(counts, 2 * ECS_SIZEOF(uint32_t) +
+        (int32_t)(counts[0] + counts[1]) * ECS_SIZEOF(ecs_id_t));
+    int32_t skip = 1 + flecs_journal_range_count(c, committed, 0) - count;
+    if (skip < 0) {
+        return false;
+    }
+    if (!skip) {
+        if (entities[0] != c->entity || (count > 1 && ecs_os_memcmp(
+            committed, &entities[1], (count - 1) * ECS_SIZEOF(uint64_t)))) 
+        {
+            return false;
+        }
+    } else if (ecs_os_memcmp(&committed[skip - 1], entities, 
+        count * ECS_SIZEOF(uint64_t))) 
+    {
+        return false;
+    }
+
+    /* The commit must still be in the buffer after the append */
+    ecs_size_t payload_size = 2 * ECS_SIZEOF(uint32_t) + count * size;
+    uint64_t record_size = (uint64_t)ECS_ALIGN(
+        (size_t)(ECS_SIZEOF(ecs_journal_record_t) + payload_size), 8);
+    if ((j->header.head - j->flushed + record_size) > j->buf_size ||
+        (j->capacity - j->offset) < record_size)
+    {
+        return false;
+    }
+
+    uint32_t *payload = flecs_journal_append(j, EcsJournalOpSetValues, 0, id,
+        payload_size);
+    if (payload) {
+        payload[0] = (uint32_t)size;
+        payload[1] = (uint32_t)count;
+        if (size) {
+            ecs_os_memcpy(&payload[2], ptr, count * size);
+        }
+    }
+    return true;
+}
+
+void flecs_journal_set(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_journal_writer_t *j = world->journal;
+    if (!j) {
+        return;
+    }
+
+    const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+    const void *ptr = ecs_get_id(world, entity, id);
+    if (!ti || !ptr) {
+        return;
+    }
+
+    flecs_journal_declare(world, j, entity);
+
+    if (id == ecs_pair(ecs_id(EcsIdentifier), EcsName)) {
+        const char *name = ((const EcsIdentifier*)ptr)->value;
+        ecs_size_t len = name ? ecs_os_strlen(name) : 0;
+        char *str = flecs_journal_append(j, EcsJournalOpName, entity, 0, 
+            len + 1);
+        if (str) {
+            if (len) {
+                ecs_os_memcpy(str, name, len);
+            }
+            str[len] = '\0';
+        }
+
+        /* Declare the entity with its new path when it's used again, so the
+         * name survives the Name record being overwritten */
+        flecs_journal_undeclare(j, entity);
+        return;
+    }
+
+    ecs_journal_record_t *range = j->range;
+    if (!range || range->op != EcsJournalOpSet || range->id != id) {
+        flecs_journal_declare_id(world, j, id);
+    }
+
+    flecs_journal_write_set(j, entity, id, ti, ptr);
+}
+
+void flecs_journal_set_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_journal_writer_t *j = world->journal;
+    if (!j || !count) {
+        return;
+    }
+
+    ecs_assert(table->storage_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    const ecs_table_record_t *tr = flecs_table_record_get(
+        world, table->storage_table, id);
+    if (!tr || id == ecs_pair(ecs_id(EcsIdentifier), EcsName)) {
+        /* Names are recorded one at a time */
+        int32_t i;
+        ecs_entity_t *entities = ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, row);
+        for (i = 0; i < count; i ++) {
+            flecs_journal_set(world, entities[i], id);
+        }
+        return;
+    }
+
+    const ecs_type_info_t *ti = table->type_info[tr->column];
+    const ecs_entity_t *entities = ecs_vec_get_t(
+        &table->data.entities, ecs_entity_t, row);
+    const void *ptr = ecs_vec_get(
+        &table->data.columns[tr->column], ti->size, row);
+
+    ecs_size_t size = ti->hooks.copy ? 0 : ti->size;
+
+    /* The entities were declared by the commit */
+    flecs_journal_declare_id(world, j, id);
+    if (flecs_journal_write_values(j, entities, count, id, size, ptr)) {
+        return;
+    }
+
+    /* Check the table once instead of looking up each entity */
+    bool declare = (table->flags & (EcsTableHasName | EcsTableHasBuiltins)) 
+        != 0;
+    ecs_size_t elem_size = ECS_SIZEOF(ecs_entity_t) + ECS_ALIGN(size, 8);
+
+    int32_t i = 0;
+    while (i < count) {
+        if (declare) {
+            flecs_journal_declare(world, j, entities[i]);
+        }
+
+        ecs_journal_record_t *range = j->range;
+        if (!range || range->op != EcsJournalOpSet || range->id != id) {
+            flecs_journal_declare_id(world, j, id);
+            flecs_journal_write_set(j, entities[i], id, ti, ptr);
+            ptr = ECS_OFFSET(ptr, ti->size);
+            i ++;
+            continue;
+        }
+
+        /* Append as many values as fit in the range in one go */
+        int32_t n = declare ? 1 : flecs_journal_range_space(j, elem_size);
+        if (n > (count - i)) {
+            n = count - i;
+        }
+        uint64_t *elem = NULL;
+        if (n) {
+            elem = flecs_journal_extend(j, EcsJournalOpSet, id, n * elem_size);
+        }
+        if (!elem) {
+            j->range = NULL;
+            continue;
+        }
+
+        int32_t last = i + n;
+        for (; i < last; i ++) {
+            elem[0] = entities[i];
+            if (size) {
+                ecs_os_memcpy(&elem[1], ptr, size);
+            }
+            elem = ECS_OFFSET(elem, elem_size);
+            ptr = ECS_OFFSET(ptr, ti->size);
+        }
+    }
+}
+
+static
+void flecs_journal_close_file(
+    ecs_journal_writer_t *j)
+{
+#ifdef ECS_TARGET_WINDOWS
+    if (j->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(j->file);
+    }
+#else
+    if (j->fd != -1) {
+        close(j->fd);
+    }
+#endif
+}
+
+int ecs_journal_open(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_size_t size)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(filename != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_journal_close(world);
+
+    if (!size) {
+        size = ECS_JOURNAL_DEFAULT_SIZE;
+    }
+
+    ecs_journal_writer_t *j = ecs_os_calloc_t(ecs_journal_writer_t);
+    j->capacity = (uint64_t)ECS_ALIGN(size, 8);
+    uint64_t file_size = (uint64_t)ECS_SIZEOF(ecs_journal_header_t) + 
+        j->capacity;
+
+    /* The file has its full size from the start, so a reader can load the
+     * ring in one go, even if it hasn't been filled yet. */
+#ifdef ECS_TARGET_WINDOWS
+    j->file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 
+        FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (j->file == INVALID_HANDLE_VALUE) {
+        goto error_open;
+    }
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)file_size;
+    if (!SetFilePointerEx(j->file, end, NULL, FILE_BEGIN) || 
+        !SetEndOfFile(j->file)) 
+    {
+        goto error_open;
+    }
+#else
+    j->fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (j->fd == -1) {
+        goto error_open;
+    }
+    if (ftruncate(j->fd, (off_t)file_size) != 0) {
+        goto error_open;
+    }
+#endif
+
+    j->range_limit = j->capacity / 4;
+    if (j->range_limit > FLECS_JOURNAL_RANGE_MAX) {
+        j->range_limit = FLECS_JOURNAL_RANGE_MAX;
+    }
+
+    j->buf_size = j->capacity / 2;
+    if (j->buf_size > FLECS_JOURNAL_FLUSH_SIZE) {
+        j->buf_size = FLECS_JOURNAL_FLUSH_SIZE;
+    }
+    j->buf = ecs_os_malloc((ecs_size_t)j->buf_size);
+    if (!j->buf) {
+        goto error_open;
+    }
+
+    ecs_os_memcpy(j->header.magic, FLECS_JOURNAL_MAGIC, 4);
+    j->header.version = FLECS_JOURNAL_VERSION;
+    j->header.capacity = j->capacity;
+    if (flecs_journal_flush(j)) {
+        ecs_os_free(j->buf);
+        flecs_journal_close_file(j);
+        ecs_os_free(j);
+        return -1;
+    }
+
+    ecs_map_init(&j->declared, NULL);
+
+    world->journal = j;
+    return 0;
+error_open:
+    ecs_err("journal: failed to open '%s': %s", filename, 
+        ecs_os_strerror(errno));
+    flecs_journal_close_file(j);
+    ecs_os_free(j);
+error:
+    return -1;
+}
+
+int ecs_journal_flush(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_journal_writer_t *j = world->journal;
+    if (!j) {
+        return 0;
+    }
+    return flecs_journal_flush(j);
+}
+
+void ecs_journal_close(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_journal_writer_t *j = world->journal;
+    if (j) {
+        flecs_journal_flush(j);
+        flecs_journal_close_file(j);
+        ecs_map_fini(&j->declared);
+        ecs_os_free(j->buf);
+        ecs_os_free(j);
+        world->journal = NULL;
+    }
+}
+
+typedef struct {
+    ecs_world_t *world;
+    ecs_vec_t entities;     /* vec<entity>, indexed by recorded entity index */
+    ecs_map_t declared;     /* map<recorded entity index, declare record> */
+    ecs_vec_t ids;          /* Translated ids of commit record */
+    const ecs_journal_record_t *commit; /* Last commit record */
+    ecs_journal_replay_t *result;
+} ecs_journal_reader_t;
+
+static
+ecs_entity_t* flecs_journal_replay_slot(
+    ecs_journal_reader_t *reader,
+    uint32_t index)
+{
+    ecs_assert(index < INT32_MAX, ECS_INVALID_PARAMETER, NULL);
+    int32_t count = ecs_vec_count(&reader->entities);
+    if ((int32_t)index >= count) {
+        int32_t grow = (int32_t)index + 1 - count;
+        ecs_entity_t *slots = ecs_vec_grow_t(NULL, &reader->entities, 
+            ecs_entity_t, grow);
+        ecs_os_memset_n(slots, 0, ecs_entity_t, grow);
+    }
+    return ecs_vec_get_t(&reader->entities, ecs_entity_t, (int32_t)index);
+}
+
+static
+ecs_entity_t flecs_journal_replay_entity(
+    ecs_journal_reader_t *reader,
+    uint32_t index)
+{
+    ecs_world_t *world = reader->world;
+
+    if (flecs_journal_is_builtin(index)) {
+        return index;
+    }
+
+    ecs_entity_t *entity = flecs_journal_replay_slot(reader, index);
+    if (*entity && ecs_is_alive(world, *entity)) {
+        return *entity;
+    }
+
+    ecs_entity_t result = 0;
+    const ecs_journal_record_t *decl = ecs_map_get_deref(
+        &reader->declared, ecs_journal_record_t, index);
+    if (decl) {
+        const uint32_t *size = ECS_OFFSET(decl, 
+            ECS_SIZEOF(ecs_journal_record_t));
+        const char *path = ECS_OFFSET(size, ECS_SIZEOF(uint32_t));
+        if (path[0]) {
+            /* Don't search the lookup path, Tag is not flecs.core.Tag */
+            result = ecs_lookup_path_w_sep(world, 0, path, ".", NULL, false);
+            if (!result) {
+                result = ecs_new_from_fullpath(world, path);
+            }
+        } else {
+            result = ecs_new_id(world);
+        }
+
+        if (size[0] && !ecs_has(world, result, EcsComponent)) {
+            ecs_component_init(world, &(ecs_component_desc_t){
+                .entity = result,
+                .type.size = (ecs_size_t)size[0],
+                .type.alignment = decl->alignment
+            });
+        }
+    } else {
+        result = ecs_new_id(world);
+    }
+
+    *flecs_journal_replay_slot(reader, index) = result;
+    return result;
+}
+
+static
+ecs_id_t flecs_journal_replay_id(
+    ecs_journal_reader_t *reader,
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t first = flecs_journal_replay_entity(
+            reader, ECS_PAIR_FIRST(id));
+        ecs_entity_t second = flecs_journal_replay_entity(
+            reader, ECS_PAIR_SECOND(id));
+        return ecs_pair(first, second);
+    }
+
+    return (id & ECS_ID_FLAGS_MASK) | 
+        flecs_journal_replay_entity(reader, (uint32_t)id);
+}
+
+/* Systems, observers and queries can't be restored from the journal, the
+ * entities that held them are replayed as plain entities */
+static
+bool flecs_journal_replay_skip(
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        return ECS_PAIR_FIRST(id) == ecs_id(EcsPoly);
+    }
+    return id == EcsQuery || id == EcsObserver || id == EcsSystem;
+}
+
+/* Check that the payload of a record fits in the record */
+static
+bool flecs_journal_record_valid(
+    const ecs_journal_record_t *r)
+{
+    if (r->op == EcsJournalOpPad) {
+        /* Can be smaller than a record header at the end of the ring */
+        return true;
+    }
+    if (r->size < ECS_SIZEOF(ecs_journal_record_t)) {
+        return false;
+    }
+
+    uint32_t payload = r->size - (uint32_t)ECS_SIZEOF(ecs_journal_record_t);
+    const uint32_t *data = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+
+    switch(r->op) {
+    case EcsJournalOpCommit: {
+        if (payload < 2 * ECS_SIZEOF(uint32_t)) {
+            return false;
+        }
+        uint64_t ids = (uint64_t)data[0] + data[1];
+        return (2 * ECS_SIZEOF(uint32_t) + ids * ECS_SIZEOF(ecs_id_t)) <= 
+            payload;
+    }
+    case EcsJournalOpSet: {
+        if (payload < 2 * ECS_SIZEOF(uint32_t)) {
+            return false;
+        }
+        uint64_t elem = (uint64_t)ECS_ALIGN(data[0], 8);
+        uint64_t rest = payload - 2 * ECS_SIZEOF(uint32_t);
+        return elem <= rest && 
+            !((rest - elem) % (ECS_SIZEOF(uint64_t) + elem));
+    }
+    case EcsJournalOpSetValues:
+        if (payload < 2 * ECS_SIZEOF(uint32_t)) {
+            return false;
+        }
+        return (2 * ECS_SIZEOF(uint32_t) + (uint64_t)data[0] * data[1]) <=
+            payload;
+    default:
+        return true;
+    }
+}
+
+static
+void flecs_journal_replay_commit(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint32_t *counts = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    const ecs_id_t *ids = ECS_OFFSET(counts, 2 * ECS_SIZEOF(uint32_t));
+    int32_t i, add_count = (int32_t)counts[0];
+    int32_t count = add_count + (int32_t)counts[1];
+
+    ecs_vec_clear(&reader->ids);
+    ecs_id_t *dst_ids = ecs_vec_grow_t(NULL, &reader->ids, ecs_id_t, count);
+    int32_t dst_count = 0, dst_add_count = 0;
+    for (i = 0; i < count; i ++) {
+        if (flecs_journal_replay_skip(ids[i])) {
+            continue;
+        }
+        dst_ids[dst_count ++] = flecs_journal_replay_id(reader, ids[i]);
+        dst_add_count += i < add_count;
+    }
+
+    reader->commit = r;
+
+    ecs_type_t added = { .array = dst_ids, .count = dst_add_count };
+    ecs_type_t removed = { .array = &dst_ids[dst_add_count], 
+        .count = dst_count - dst_add_count };
+
+    /* The first entity is in the record, the others follow the ids */
+    const uint64_t *entities = (const uint64_t*)&ids[count];
+    int32_t e_i, entity_count = 1 + flecs_journal_range_count(r, entities, 0);
+    for (e_i = 0; e_i < entity_count; e_i ++) {
+        uint64_t index = e_i ? entities[e_i - 1] : r->entity;
+        ecs_entity_t e = flecs_journal_replay_entity(reader, (uint32_t)index);
+        ecs_table_t *table = ecs_get_table(world, e);
+        for (i = 0; i < added.count; i ++) {
+            table = ecs_table_add_id(world, table, added.array[i]);
+        }
+        for (i = 0; i < removed.count; i ++) {
+            table = ecs_table_remove_id(world, table, removed.array[i]);
+        }
+        ecs_commit(world, e, NULL, table, &added, &removed);
+        reader->result->op_count ++;
+    }
+}
+
+static
+void flecs_journal_replay_set(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint32_t *payload = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    ecs_size_t size = (ecs_size_t)payload[0];
+    ecs_size_t aligned = ECS_ALIGN(size, 8);
+    int32_t count = 1 + flecs_journal_range_count(
+        r, ECS_OFFSET(&payload[2], aligned), aligned);
+
+    if (flecs_journal_replay_skip(r->id)) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    ecs_id_t id = flecs_journal_replay_id(reader, r->id);
+    const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+    if (!ti || (size && ti->size != size)) {
+        /* Component has a different size than in the recording world */
+        reader->result->skip_count += count;
+        return;
+    }
+
+    /* The first value is for the entity in the record, the others are 
+     * preceded by their entity */
+    const void *value = &payload[2];
+    uint64_t index = r->entity;
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = flecs_journal_replay_entity(reader, (uint32_t)index);
+        if (!size) {
+            ecs_add_id(world, e, id);
+        } else {
+            ecs_set_id(world, e, id, (size_t)size, value);
+        }
+        reader->result->op_count ++;
+
+        const uint64_t *next = ECS_OFFSET(value, aligned);
+        index = next[0];
+        value = &next[1];
+    }
+}
+
+static
+void flecs_journal_replay_values(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint32_t *payload = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    ecs_size_t size = (ecs_size_t)payload[0];
+    int32_t count = (int32_t)payload[1];
+
+    /* The commit is in the ring, unless the values are corrupt */
+    const ecs_journal_record_t *c = reader->commit;
+    if (!c || flecs_journal_replay_skip(r->id)) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    const uint32_t *counts = ECS_OFFSET(c, ECS_SIZEOF(ecs_journal_record_t));
+    const uint64_t *committed = ECS_OFFSET(counts, 2 * ECS_SIZEOF(uint32_t) +
+        (int32_t)(counts[0] + counts[1]) * ECS_SIZEOF(ecs_id_t));
+    int32_t committed_count = 1 + flecs_journal_range_count(c, committed, 0);
+    if (count > committed_count) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    ecs_id_t id = flecs_journal_replay_id(reader, r->id);
+    const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+    if (!ti || (size && ti->size != size)) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    const void *value = &payload[2];
+    int32_t i;
+    for (i = committed_count - count; i < committed_count; i ++) {
+        uint64_t index = i ? committed[i - 1] : c->entity;
+        ecs_entity_t e = flecs_journal_replay_entity(reader, (uint32_t)index);
+        if (!size) {
+            ecs_add_id(world, e, id);
+        } else {
+            ecs_set_id(world, e, id, (size_t)size, value);
+        }
+        reader->result->op_count ++;
+        value = ECS_OFFSET(value, size);
+    }
+}
+
+static
+void flecs_journal_replay_delete(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint64_t *entities = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    int32_t i, count = 1 + flecs_journal_range_count(r, entities, 0);
+    for (i = 0; i < count; i ++) {
+        uint64_t index = i ? entities[i - 1] : r->entity;
+        ecs_entity_t *e = flecs_journal_replay_slot(reader, (uint32_t)index);
+        if (!*e || !ecs_is_alive(world, *e)) {
+            reader->result->skip_count ++;
+        } else {
+            ecs_delete(world, *e);
+            *e = 0;
+            reader->result->op_count ++;
+        }
+    }
+}
+
+static
+void flecs_journal_replay_record(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    ecs_journal_replay_t *result = reader->result;
+
+    switch(r->op) {
+    case EcsJournalOpDeclare:
+        /* Entities created after this point use the latest declaration */
+        *ecs_map_ensure(&reader->declared, (uint32_t)r->entity) = 
+            (ecs_map_val_t)r;
+        return;
+    case EcsJournalOpCommit:
+        flecs_journal_replay_commit(reader, r);
+        return;
+    case EcsJournalOpSet:
+        flecs_journal_replay_set(reader, r);
+        return;
+    case EcsJournalOpSetValues:
+        flecs_journal_replay_values(reader, r);
+        return;
+    case EcsJournalOpDelete:
+        flecs_journal_replay_delete(reader, r);
+        return;
+    case EcsJournalOpName:
+        ecs_set_name(world, 
+            flecs_journal_replay_entity(reader, (uint32_t)r->entity),
+            ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t)));
+        break;
+    case EcsJournalOpClear: {
+        ecs_entity_t *e = flecs_journal_replay_slot(
+            reader, (uint32_t)r->entity);
+        if (!*e || !ecs_is_alive(world, *e)) {
+            result->skip_count ++;
+            return;
+        }
+        ecs_clear(world, *e);
+        break;
+    }
+    case EcsJournalOpDeleteWith:
+        ecs_delete_with(world, flecs_journal_replay_id(reader, r->id));
+        break;
+    case EcsJournalOpRemoveAll:
+        ecs_remove_all(world, flecs_journal_replay_id(reader, r->id));
+        break;
+    default:
+        return;
+    }
+
+    result->op_count ++;
+}
+
+int ecs_journal_replay(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_journal_replay_t *result)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(filename != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_journal_replay_t dummy;
+    if (!result) {
+        result = &dummy;
+    }
+    ecs_os_zeromem(result);
+
+    FILE *file;
+    ecs_os_fopen(&file, filename, "rb");
+    if (!file) {
+        ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
+        return -1;
+    }
+
+    ecs_journal_header_t hdr;
+    if (fread(&hdr, ECS_SIZEOF(hdr), 1, file) != 1 || 
+        ecs_os_memcmp(hdr.magic, FLECS_JOURNAL_MAGIC, 4) ||
+        hdr.version != FLECS_JOURNAL_VERSION || (hdr.capacity % 8) ||
+        hdr.tail > hdr.head || (hdr.head - hdr.tail) > hdr.capacity)
+    {
+        ecs_err("journal: '%s' is not a valid journal", filename);
+        fclose(file);
+        return -1;
+    }
+
+    char *ring = ecs_os_malloc((ecs_size_t)hdr.capacity);
+    size_t read = fread(ring, 1, (size_t)hdr.capacity, file);
+    fclose(file);
+    if (read != (size_t)hdr.capacity) {
+        ecs_err("journal: '%s' is truncated", filename);
+        ecs_os_free(ring);
+        return -1;
+    }
+
+    ecs_journal_reader_t reader = { .world = world, .result = result };
+    ecs_vec_init_t(NULL, &reader.entities, ecs_entity_t, 0);
+    ecs_map_init(&reader.declared, NULL);
+    ecs_vec_init_t(NULL, &reader.ids, ecs_id_t, 0);
+
+    /* Collect the first declaration of each entity, since a declaration that
+     * was overwritten is only written again after records that use it. */
+    uint64_t offset;
+    const ecs_journal_record_t *r;
+    for (offset = hdr.tail; offset < hdr.head; offset += r->size) {
+        r = ECS_OFFSET(ring, offset % hdr.capacity);
+        if (!r->size || (r->size % 8) || 
+            ((offset % hdr.capacity) + r->size) > hdr.capacity ||
+            !flecs_journal_record_valid(r)) 
+        {
+            ecs_err("journal: '%s' has an invalid record", filename);
+            goto error;
+        }
+        if (r->op == EcsJournalOpDeclare) {
+            ecs_map_val_t *decl = ecs_map_ensure(
+                &reader.declared, (uint32_t)r->entity);
+            if (!*decl) {
+                *decl = (ecs_map_val_t)r;
+            }
+        }
+        if (r->op != EcsJournalOpPad) {
+            result->record_count ++;
+        }
+    }
+
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    for (offset = hdr.tail; offset < hdr.head; offset += r->size) {
+        r = ECS_OFFSET(ring, offset % hdr.capacity);
+        flecs_journal_replay_record(&reader, r);
+    }
+
+    result->time_spent = (ecs_ftime_t)ecs_time_measure(&t);
+
+    ecs_vec_fini_t(NULL, &reader.ids, ecs_id_t);
+    ecs_map_fini(&reader.declared);
+    ecs_vec_fini_t(NULL, &reader.entities, ecs_entity_t);
+    ecs_os_free(ring);
+    return 0;
+error:
+    ecs_vec_fini_t(NULL, &reader.ids, ecs_id_t);
+    ecs_map_fini(&reader.declared);
+    ecs_vec_fini_t(NULL, &reader.entities, ecs_entity_t);
+    ecs_os_free(ring);
+    return -1;
+}
+
 #endif
 
 /**
@@ -25455,6 +29521,15 @@ void ecs_meta_type_serialized_init(
 void ecs_meta_dtor_serialized(
     EcsMetaTypeSerialized *ptr);
 
+#ifdef FLECS_JSON
+/* Serializer plans are compiled from the type ops by the JSON addon */
+struct ecs_json_ser_plan_t* flecs_json_ser_plan_init(
+    const ecs_vector_t *ops);
+
+void flecs_json_ser_plan_free(
+    struct ecs_json_ser_plan_t *plan);
+#endif
+
 
 bool flecs_unit_validate(
     ecs_world_t *world,
@@ -26030,6 +30105,10 @@ void ecs_meta_type_serialized_init(
         }
 
         ptr->ops = ops;
+
+#ifdef FLECS_JSON
+        ptr->json_plan = flecs_json_ser_plan_init(ops);
+#endif
     }
 }
 
@@ -26078,6 +30157,23 @@ void ecs_meta_dtor_serialized(
     }
 
     ecs_vector_free(ptr->ops);
+
+#ifdef FLECS_JSON
+    flecs_json_ser_plan_free(ptr->json_plan);
+    ptr->json_plan = NULL;
+#endif
+}
+
+/* Called from ECS_COPY, which can't contain the FLECS_JSON check itself */
+static
+void flecs_meta_serialized_init_plan(
+    EcsMetaTypeSerialized *ptr)
+{
+#ifdef FLECS_JSON
+    ptr->json_plan = flecs_json_ser_plan_init(ptr->ops);
+#else
+    ptr->json_plan = NULL;
+#endif
 }
 
 static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
@@ -26094,12 +30190,16 @@ static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
             op->members = flecs_name_index_copy(op->members);
         }
     }
+
+    flecs_meta_serialized_init_plan(dst);
 })
 
 static ECS_MOVE(EcsMetaTypeSerialized, dst, src, {
     ecs_meta_dtor_serialized(dst);
     dst->ops = src->ops;
+    dst->json_plan = src->json_plan;
     src->ops = NULL;
+    src->json_plan = NULL;
 })
 
 static ECS_DTOR(EcsMetaTypeSerialized, ptr, { 
@@ -30842,6 +34942,7 @@ void ecs_world_stats_get(
     }
     ECS_COUNTER_RECORD(&s->tables.create_count, t, world->info.table_create_total);
     ECS_COUNTER_RECORD(&s->tables.delete_count, t, world->info.table_delete_total);
+    ECS_COUNTER_RECORD(&s->tables.realloc_count, t, world->info.table_realloc_total);
     ECS_GAUGE_RECORD(&s->tables.count, t, world->info.table_count);
     ECS_GAUGE_RECORD(&s->tables.empty_count, t, world->info.empty_table_count);
     ECS_GAUGE_RECORD(&s->tables.tag_only_count, t, world->info.tag_table_count);
@@ -30878,6 +34979,15 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->memory.stack_free_count, t, ecs_stack_allocator_free_count);
     ECS_GAUGE_RECORD(&s->memory.stack_outstanding_alloc_count, t, outstanding_allocs);
 
+#ifdef FLECS_OS_ALLOC
+    ecs_os_alloc_stats_t alloc_stats;
+    ecs_os_alloc_stats_get(&alloc_stats);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_live_bytes, t, alloc_stats.live_bytes);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_peak_bytes, t, alloc_stats.peak_bytes);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_cached_bytes, t, alloc_stats.cached_bytes);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_reserved_bytes, t, alloc_stats.reserved_bytes);
+#endif
+
 #ifdef FLECS_REST
     ECS_COUNTER_RECORD(&s->rest.request_count, t, ecs_rest_request_count);
     ECS_COUNTER_RECORD(&s->rest.entity_count, t, ecs_rest_entity_count);
@@ -30892,6 +35002,7 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->rest.world_stats_count, t, ecs_rest_world_stats_count);
     ECS_COUNTER_RECORD(&s->rest.pipeline_stats_count, t, ecs_rest_pipeline_stats_count);
     ECS_COUNTER_RECORD(&s->rest.stats_error_count, t, ecs_rest_stats_error_count);
+    ECS_COUNTER_RECORD(&s->rest.stats_stream_count, t, ecs_rest_stats_stream_count);
 #endif
 
 #ifdef FLECS_HTTP
@@ -31174,7 +35285,10 @@ bool ecs_pipeline_stats_get(
         }
     }
 
-    s->t = t_next(s->t);
+    int32_t t = s->t = t_next(s->t);
+    ECS_COUNTER_RECORD(&s->sync_count, t, pq->sync_count_total);
+    ECS_COUNTER_RECORD(&s->sync_time, t, pq->sync_time_total);
+    ECS_COUNTER_RECORD(&s->sync_wait_time, t, pq->sync_wait_time_total);
 
     return true;
 error:
@@ -31214,7 +35328,9 @@ void ecs_pipeline_stats_reduce(
         sys_dst->query.t = dst->t;
         ecs_system_stats_reduce(sys_dst, sys_src);
     }
-    dst->t = t_next(dst->t);
+
+    flecs_stats_reduce(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
+        ECS_METRIC_FIRST(src), (dst->t = t_next(dst->t)), src->t);
 }
 
 void ecs_pipeline_stats_reduce_last(
@@ -31231,7 +35347,9 @@ void ecs_pipeline_stats_reduce_last(
         sys_dst->query.t = dst->t;
         ecs_system_stats_reduce_last(sys_dst, sys_src, count);
     }
-    dst->t = t_prev(dst->t);
+
+    flecs_stats_reduce_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
+        ECS_METRIC_FIRST(src), (dst->t = t_prev(dst->t)), src->t, count);
 }
 
 void ecs_pipeline_stats_repeat_last(
@@ -31243,7 +35361,9 @@ void ecs_pipeline_stats_repeat_last(
         sys->query.t = stats->t;
         ecs_system_stats_repeat_last(sys);
     }
-    stats->t = t_next(stats->t);
+
+    flecs_stats_repeat_last(ECS_METRIC_FIRST(stats), ECS_METRIC_LAST(stats),
+        (stats->t = t_next(stats->t)));
 }
 
 void ecs_pipeline_stats_copy_last(
@@ -31260,6 +35380,9 @@ void ecs_pipeline_stats_copy_last(
         sys_dst->query.t = dst->t;
         ecs_system_stats_copy_last(sys_dst, sys_src);
     }
+
+    flecs_stats_copy_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst),
+        ECS_METRIC_FIRST(src), dst->t, t_next(src->t));
 }
 
 #endif
@@ -31313,6 +35436,7 @@ void ecs_world_stats_log(
     flecs_gauge_print("table cache record count", t, &s->tables.record_count);
     flecs_counter_print("table create count", t, &s->tables.create_count);
     flecs_counter_print("table delete count", t, &s->tables.delete_count);
+    flecs_counter_print("table realloc count", t, &s->tables.realloc_count);
     ecs_trace("");
     flecs_counter_print("add commands", t, &s->commands.add_count);
     flecs_counter_print("remove commands", t, &s->commands.remove_count);
@@ -31331,6 +35455,393 @@ error:
     return;
 }
 
+static const struct {
+    const char *name;
+    ecs_stats_stream_kind_t kind;
+} flecs_stats_stream_metrics[ECS_STATS_STREAM_METRIC_COUNT] = {
+    {"frame.frame_count", EcsStatsStreamCounter},
+    {"frame.merge_count", EcsStatsStreamCounter},
+    {"frame.rematch_count", EcsStatsStreamCounter},
+    {"frame.pipeline_build_count", EcsStatsStreamCounter},
+    {"frame.systems_ran", EcsStatsStreamCounter},
+    {"frame.observers_ran", EcsStatsStreamCounter},
+    {"frame.event_emit_count", EcsStatsStreamCounter},
+    {"performance.world_time_raw_us", EcsStatsStreamCounter},
+    {"performance.world_time_us", EcsStatsStreamCounter},
+    {"performance.frame_time_us", EcsStatsStreamCounter},
+    {"performance.system_time_us", EcsStatsStreamCounter},
+    {"performance.emit_time_us", EcsStatsStreamCounter},
+    {"performance.merge_time_us", EcsStatsStreamCounter},
+    {"performance.rematch_time_us", EcsStatsStreamCounter},
+    {"entities.count", EcsStatsStreamGauge},
+    {"entities.not_alive_count", EcsStatsStreamGauge},
+    {"ids.count", EcsStatsStreamGauge},
+    {"ids.tag_count", EcsStatsStreamGauge},
+    {"ids.component_count", EcsStatsStreamGauge},
+    {"ids.pair_count", EcsStatsStreamGauge},
+    {"ids.wildcard_count", EcsStatsStreamGauge},
+    {"ids.type_count", EcsStatsStreamGauge},
+    {"ids.create_count", EcsStatsStreamCounter},
+    {"ids.delete_count", EcsStatsStreamCounter},
+    {"tables.count", EcsStatsStreamGauge},
+    {"tables.empty_count", EcsStatsStreamGauge},
+    {"tables.tag_only_count", EcsStatsStreamGauge},
+    {"tables.trivial_only_count", EcsStatsStreamGauge},
+    {"tables.record_count", EcsStatsStreamGauge},
+    {"tables.storage_count", EcsStatsStreamGauge},
+    {"tables.create_count", EcsStatsStreamCounter},
+    {"tables.delete_count", EcsStatsStreamCounter},
+    {"tables.realloc_count", EcsStatsStreamCounter},
+    {"commands.add_count", EcsStatsStreamCounter},
+    {"commands.remove_count", EcsStatsStreamCounter},
+    {"commands.delete_count", EcsStatsStreamCounter},
+    {"commands.clear_count", EcsStatsStreamCounter},
+    {"commands.set_count", EcsStatsStreamCounter},
+    {"commands.get_mut_count", EcsStatsStreamCounter},
+    {"commands.modified_count", EcsStatsStreamCounter},
+    {"commands.other_count", EcsStatsStreamCounter},
+    {"commands.discard_count", EcsStatsStreamCounter},
+    {"commands.batched_entity_count", EcsStatsStreamCounter},
+    {"commands.batched_count", EcsStatsStreamCounter},
+    {"memory.alloc_count", EcsStatsStreamCounter},
+    {"memory.realloc_count", EcsStatsStreamCounter},
+    {"memory.free_count", EcsStatsStreamCounter},
+    {"memory.block_alloc_count", EcsStatsStreamCounter},
+    {"memory.block_free_count", EcsStatsStreamCounter},
+    {"memory.stack_alloc_count", EcsStatsStreamCounter},
+    {"memory.stack_free_count", EcsStatsStreamCounter},
+    {"memory.os_alloc_live_bytes", EcsStatsStreamGauge},
+    {"memory.os_alloc_peak_bytes", EcsStatsStreamGauge},
+    {"memory.os_alloc_cached_bytes", EcsStatsStreamGauge},
+    {"memory.os_alloc_reserved_bytes", EcsStatsStreamGauge},
+    {"pipeline.system_count", EcsStatsStreamGauge},
+    {"pipeline.active_system_count", EcsStatsStreamGauge},
+    {"pipeline.rebuild_count", EcsStatsStreamCounter},
+    {"pipeline.sync_count", EcsStatsStreamCounter},
+    {"pipeline.sync_time_us", EcsStatsStreamCounter},
+    {"pipeline.sync_wait_time_us", EcsStatsStreamCounter}
+};
+
+#define ECS_STATS_STREAM_US(value)\
+    ((int64_t)((double)(value) * 1000000.0))
+
+void ecs_stats_stream_init(
+    ecs_stats_stream_t *stream,
+    int32_t capacity)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(capacity >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!capacity) {
+        capacity = ECS_STATS_STREAM_DEFAULT_CAPACITY;
+    }
+
+    stream->samples = ecs_os_calloc_n(int64_t, 
+        capacity * ECS_STATS_STREAM_METRIC_COUNT);
+    stream->capacity = capacity;
+    stream->seq = 0;
+error:
+    return;
+}
+
+void ecs_stats_stream_fini(
+    ecs_stats_stream_t *stream)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_os_free(stream->samples);
+    ecs_os_zeromem(stream);
+error:
+    return;
+}
+
+static
+int64_t* flecs_stats_stream_frame(
+    const ecs_stats_stream_t *stream,
+    int64_t seq)
+{
+    return &stream->samples[(seq % stream->capacity) * 
+        ECS_STATS_STREAM_METRIC_COUNT];
+}
+
+void ecs_stats_stream_sample(
+    const ecs_world_t *world,
+    ecs_stats_stream_t *stream)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(stream->samples != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    int64_t *v = flecs_stats_stream_frame(stream, ++ stream->seq);
+    const ecs_world_info_t *info = &world->info;
+    int32_t i = 0;
+
+    v[i ++] = info->frame_count_total;
+    v[i ++] = info->merge_count_total;
+    v[i ++] = info->rematch_count_total;
+    v[i ++] = info->pipeline_build_count_total;
+    v[i ++] = info->systems_ran_frame;
+    v[i ++] = info->observers_ran_frame;
+    v[i ++] = (int64_t)world->event_id;
+
+    v[i ++] = ECS_STATS_STREAM_US(info->world_time_total_raw);
+    v[i ++] = ECS_STATS_STREAM_US(info->world_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->frame_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->system_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->emit_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->merge_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->rematch_time_total);
+
+    v[i ++] = flecs_sparse_count(ecs_eis(world));
+    v[i ++] = flecs_sparse_not_alive_count(ecs_eis(world));
+
+    v[i ++] = info->id_count;
+    v[i ++] = info->tag_id_count;
+    v[i ++] = info->component_id_count;
+    v[i ++] = info->pair_id_count;
+    v[i ++] = info->wildcard_id_count;
+    v[i ++] = ecs_sparse_count(&world->type_info);
+    v[i ++] = info->id_create_total;
+    v[i ++] = info->id_delete_total;
+
+    v[i ++] = info->table_count;
+    v[i ++] = info->empty_table_count;
+    v[i ++] = info->tag_table_count;
+    v[i ++] = info->trivial_table_count;
+    v[i ++] = info->table_record_count;
+    v[i ++] = info->table_storage_count;
+    v[i ++] = info->table_create_total;
+    v[i ++] = info->table_delete_total;
+    v[i ++] = info->table_realloc_total;
+
+    v[i ++] = info->cmd.add_count;
+    v[i ++] = info->cmd.remove_count;
+    v[i ++] = info->cmd.delete_count;
+    v[i ++] = info->cmd.clear_count;
+    v[i ++] = info->cmd.set_count;
+    v[i ++] = info->cmd.get_mut_count;
+    v[i ++] = info->cmd.modified_count;
+    v[i ++] = info->cmd.other_count;
+    v[i ++] = info->cmd.discard_count;
+    v[i ++] = info->cmd.batched_entity_count;
+    v[i ++] = info->cmd.batched_command_count;
+
+    v[i ++] = ecs_os_api_malloc_count + ecs_os_api_calloc_count;
+    v[i ++] = ecs_os_api_realloc_count;
+    v[i ++] = ecs_os_api_free_count;
+    v[i ++] = ecs_block_allocator_alloc_count;
+    v[i ++] = ecs_block_allocator_free_count;
+    v[i ++] = ecs_stack_allocator_alloc_count;
+    v[i ++] = ecs_stack_allocator_free_count;
+
+#ifdef FLECS_OS_ALLOC
+    ecs_os_alloc_stats_t alloc_stats;
+    ecs_os_alloc_stats_get(&alloc_stats);
+    v[i ++] = alloc_stats.live_bytes;
+    v[i ++] = alloc_stats.peak_bytes;
+    v[i ++] = alloc_stats.cached_bytes;
+    v[i ++] = alloc_stats.reserved_bytes;
+#else
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+#endif
+
+    /* Individual systems are not streamed, see ecs_stats_stream_sample docs */
+#ifdef FLECS_PIPELINE
+    const EcsPipeline *pqc = world->pipeline ? 
+        ecs_get(world, world->pipeline, EcsPipeline) : NULL;
+    const ecs_pipeline_state_t *pq = pqc ? pqc->state : NULL;
+
+    /* Don't use ecs_query_entity_count, as sampling should not process the
+     * pending tables of the world. The pipeline does that before it runs. */
+    int32_t system_count = 0;
+    if (pq) {
+        ecs_table_cache_hdr_t *cur;
+        for (cur = pq->query->cache.tables.first; cur; cur = cur->next) {
+            system_count += ecs_table_count(cur->table);
+        }
+    }
+
+    v[i ++] = system_count;
+    v[i ++] = pq ? ecs_vec_count(&pq->systems) : 0;
+    v[i ++] = pq ? pq->rebuild_count : 0;
+    v[i ++] = pq ? pq->sync_count_total : 0;
+    v[i ++] = pq ? ECS_STATS_STREAM_US(pq->sync_time_total) : 0;
+    v[i ++] = pq ? ECS_STATS_STREAM_US(pq->sync_wait_time_total) : 0;
+#else
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+#endif
+
+    ecs_assert(i == ECS_STATS_STREAM_METRIC_COUNT, ECS_INTERNAL_ERROR, NULL);
+error:
+    return;
+}
+
+const char* ecs_stats_stream_metric_name(
+    int32_t index,
+    ecs_stats_stream_kind_t *kind)
+{
+    if (index < 0 || index >= ECS_STATS_STREAM_METRIC_COUNT) {
+        return NULL;
+    }
+    if (kind) {
+        *kind = flecs_stats_stream_metrics[index].kind;
+    }
+    return flecs_stats_stream_metrics[index].name;
+}
+
+typedef struct {
+    char *ptr;
+    ecs_size_t count;
+    ecs_size_t size;
+} flecs_stats_stream_buf_t;
+
+static
+uint8_t* flecs_stats_stream_reserve(
+    flecs_stats_stream_buf_t *buf,
+    ecs_size_t size)
+{
+    if ((buf->count + size) > buf->size) {
+        ecs_size_t new_size = buf->size * 2;
+        if (new_size < (buf->count + size)) {
+            new_size = buf->count + size;
+        }
+        buf->ptr = ecs_os_realloc(buf->ptr, new_size);
+        buf->size = new_size;
+    }
+    return (uint8_t*)&buf->ptr[buf->count];
+}
+
+static
+void flecs_stats_stream_uint(
+    flecs_stats_stream_buf_t *buf,
+    uint64_t value)
+{
+    uint8_t *ptr = flecs_stats_stream_reserve(buf, 10), *start = ptr;
+    while (value >= 0x80) {
+        *(ptr ++) = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *(ptr ++) = (uint8_t)value;
+    buf->count += (ecs_size_t)(ptr - start);
+}
+
+static
+void flecs_stats_stream_int(
+    flecs_stats_stream_buf_t *buf,
+    int64_t value)
+{
+    flecs_stats_stream_uint(buf, 
+        ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static
+void flecs_stats_stream_bytes(
+    flecs_stats_stream_buf_t *buf,
+    const void *data,
+    ecs_size_t size)
+{
+    ecs_os_memcpy(flecs_stats_stream_reserve(buf, size), data, size);
+    buf->count += size;
+}
+
+static
+void flecs_stats_stream_encode_frame(
+    flecs_stats_stream_buf_t *buf,
+    const int64_t *prev,
+    const int64_t *cur)
+{
+    /* Reserve the worst case so the changed count can be patched in place. A
+     * single byte varint is enough as long as there are less than 128 metrics */
+    flecs_stats_stream_reserve(buf, 1 + ECS_STATS_STREAM_METRIC_COUNT * 11);
+    ecs_size_t count_offset = buf->count ++;
+
+    int32_t i, changed = 0, last = -1;
+    for (i = 0; i < ECS_STATS_STREAM_METRIC_COUNT; i ++) {
+        int64_t value = prev ? (cur[i] - prev[i]) : cur[i];
+        if (value) {
+            flecs_stats_stream_uint(buf, (uint64_t)(i - last - 1));
+            flecs_stats_stream_int(buf, value);
+            last = i;
+            changed ++;
+        }
+    }
+
+    ecs_assert(changed < 128, ECS_INTERNAL_ERROR, NULL);
+    buf->ptr[count_offset] = (char)changed;
+}
+
+char* ecs_stats_stream_encode(
+    const ecs_stats_stream_t *stream,
+    int64_t since,
+    bool names,
+    ecs_size_t *size)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(since >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    flecs_stats_stream_buf_t buf = {0};
+    flecs_stats_stream_bytes(&buf, "FLST", 4);
+    flecs_stats_stream_uint(&buf, 1);
+    flecs_stats_stream_uint(&buf, ECS_STATS_STREAM_METRIC_COUNT);
+    flecs_stats_stream_uint(&buf, names);
+
+    int32_t i;
+    if (names) {
+        for (i = 0; i < ECS_STATS_STREAM_METRIC_COUNT; i ++) {
+            const char *name = flecs_stats_stream_metrics[i].name;
+            ecs_size_t len = ecs_os_strlen(name);
+            uint8_t kind = (uint8_t)flecs_stats_stream_metrics[i].kind;
+            flecs_stats_stream_bytes(&buf, &kind, 1);
+            flecs_stats_stream_uint(&buf, (uint64_t)len);
+            flecs_stats_stream_bytes(&buf, name, len);
+        }
+    }
+
+    /* Oldest frame that is still in the stream */
+    int64_t last = stream->seq;
+    int64_t oldest = last - stream->capacity + 1;
+    if (oldest < 1) {
+        oldest = 1;
+    }
+
+    /* Encode against the client frame if we still have it. If the client is
+     * too far behind or ahead (the stream was recreated) send all frames. */
+    int64_t base = 0, first = oldest;
+    if (since >= oldest && since <= last) {
+        base = since;
+        first = since + 1;
+    }
+
+    int64_t frame_count = last - first + 1;
+
+    flecs_stats_stream_uint(&buf, frame_count ? (uint64_t)first : 0);
+    flecs_stats_stream_uint(&buf, (uint64_t)frame_count);
+    flecs_stats_stream_uint(&buf, frame_count ? (uint64_t)base : 0);
+
+    const int64_t *prev = base ? flecs_stats_stream_frame(stream, base) : NULL;
+    int64_t seq;
+    for (seq = first; seq < (first + frame_count); seq ++) {
+        const int64_t *cur = flecs_stats_stream_frame(stream, seq);
+        flecs_stats_stream_encode_frame(&buf, prev, cur);
+        prev = cur;
+    }
+
+    *size = buf.count;
+    return buf.ptr;
+error:
+    return NULL;
+}
+
 #endif
 
 /**
@@ -33259,6 +37770,10 @@ void flecs_json_string_escape(
     ecs_strbuf_t *buf,
     const char *value);
 
+bool flecs_json_needs_escape(
+    const char *value,
+    ecs_size_t len);
+
 void flecs_json_member(
     ecs_strbuf_t *buf,
     const char *name);
@@ -33294,6 +37809,33 @@ void flecs_json_id(
 ecs_primitive_kind_t flecs_json_op_to_primitive_kind(
     ecs_meta_type_op_kind_t kind);
 
+/* Serializer plan, compiled from the type ops of a type and cached on its
+ * EcsMetaTypeSerialized component. A plan flattens nested structs and small
+ * inline arrays into a list of steps, where each step appends a precomputed
+ * literal (braces, separators and member names) followed by a value. */
+typedef struct ecs_json_ser_step_t {
+    int32_t lit;                  /* Offset of literal in plan literals */
+    int32_t lit_len;              /* Length of literal appended before value */
+    int32_t op;                   /* Type op of value, -1 if step has no value */
+    ecs_size_t offset;            /* Offset of value */
+    ecs_meta_type_op_kind_t kind; /* Kind of value */
+    bool elements;                /* Value is an inline array that's too large
+                                   * to unroll, serialized by type ops */
+} ecs_json_ser_step_t;
+
+typedef struct ecs_json_ser_plan_t {
+    ecs_json_ser_step_t *steps;
+    int32_t step_count;
+    char *literals;
+    int32_t size_hint;            /* Expected length of a serialized value */
+} ecs_json_ser_plan_t;
+
+ecs_json_ser_plan_t* flecs_json_ser_plan_init(
+    const ecs_vector_t *ops);
+
+void flecs_json_ser_plan_free(
+    ecs_json_ser_plan_t *plan);
+
 #endif
 
 
@@ -33372,12 +37914,13 @@ void flecs_json_string_escape(
     ecs_strbuf_t *buf,
     const char *value)
 {
-    ecs_size_t length = ecs_stresc(NULL, 0, '"', value);
-    if (length == ecs_os_strlen(value)) {
+    ecs_size_t len = ecs_os_strlen(value);
+    if (!flecs_json_needs_escape(value, len)) {
         ecs_strbuf_appendch(buf, '"');
-        ecs_strbuf_appendstrn(buf, value, length);
+        ecs_strbuf_appendstrn(buf, value, len);
         ecs_strbuf_appendch(buf, '"');
     } else {
+        ecs_size_t length = ecs_stresc(NULL, 0, '"', value);
         char *out = ecs_os_malloc(length + 3);
         ecs_stresc(out + 1, length, '"', value);
         out[0] = '"';
@@ -33387,6 +37930,42 @@ void flecs_json_string_escape(
     }
 }
 
+/* Characters that ecs_stresc escapes, for a '"' delimiter */
+#define flecs_json_escaped(ch)\
+    (((ch) >= '\a' && (ch) <= '\r') || (ch) == '"' || (ch) == '\\')
+
+bool flecs_json_needs_escape(
+    const char *value,
+    ecs_size_t len)
+{
+    /* Test 8 characters at a time, with the "has zero byte" bit trick. Words
+     * with a character below 0x0E (which includes all escaped control
+     * characters), a '"' or a '\\' are inspected per character. */
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    ecs_size_t i = 0;
+
+    for (; (i + 8) <= len; i += 8) {
+        uint64_t w, q, b;
+        ecs_os_memcpy(&w, &value[i], 8);
+        q = w ^ (ones * '"');
+        b = w ^ (ones * '\\');
+        if ((((w - ones * 0x0E) & ~w) | ((q - ones) & ~q) | 
+            ((b - ones) & ~b)) & highs) 
+        {
+            break;
+        }
+    }
+
+    for (; i < len; i ++) {
+        if (flecs_json_escaped(value[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void flecs_json_member(
     ecs_strbuf_t *buf,
     const char *name)
@@ -33486,7 +38065,7 @@ ecs_primitive_kind_t flecs_json_op_to_primitive_kind(
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *ser, 
+    const EcsMetaTypeSerialized *ser, 
     const void *base, 
     ecs_strbuf_t *str);
 
@@ -33506,6 +38085,15 @@ int json_ser_type_op(
     const void *base,
     ecs_strbuf_t *str);
 
+static
+int flecs_json_ser_plan_array(
+    const ecs_world_t *world,
+    const EcsMetaTypeSerialized *ser,
+    const void *ptr,
+    int32_t count,
+    ecs_size_t size,
+    ecs_strbuf_t *str);
+
 /* Serialize enumeration */
 static
 int json_ser_enum(
@@ -33624,6 +38212,11 @@ int json_ser_type_elements(
     const EcsComponent *comp = ecs_get(world, type, EcsComponent);
     ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (ser->json_plan && elem_count) {
+        return flecs_json_ser_plan_array(
+            world, ser, base, elem_count, comp->size, str);
+    }
+
     ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
     int32_t op_count = ecs_vector_count(ser->ops);
 
@@ -33796,16 +38389,554 @@ error:
     return -1;
 }
 
+/* Inline arrays with more elements are not unrolled in a serializer plan */
+#define FLECS_JSON_PLAN_MAX_UNROLL (64)
+
+/* Types with a longer literal (member names) don't get a plan */
+#define FLECS_JSON_PLAN_MAX_LITERAL (512)
+
+/* Size of the stack buffer of the plan writer, fits the longest literal and
+ * value of a step. */
+#define FLECS_JSON_WRITER_STACK_SIZE (1024)
+
+/* Max size of heap chunks handed over to the output buffer */
+#define FLECS_JSON_WRITER_CHUNK_SIZE (64 * 1024)
+
+typedef struct flecs_json_plan_builder_t {
+    ecs_vec_t steps;        /* vec<ecs_json_ser_step_t> */
+    ecs_vec_t literals;     /* vec<char> */
+    int32_t lit;            /* Start of the literal of the next step */
+    int32_t value_count;
+
+    /* Mirrors the list stack of ecs_strbuf_t, so that separators end up in
+     * the same places as when serializing with type ops */
+    int32_t list_count[ECS_STRBUF_MAX_LIST_DEPTH];
+    int32_t list_sp;
+    bool invalid;
+} flecs_json_plan_builder_t;
+
+static
+void flecs_json_plan_lit(
+    flecs_json_plan_builder_t *b,
+    const char *str,
+    int32_t len)
+{
+    if (!len) {
+        return;
+    }
+    char *dst = ecs_vec_grow_t(NULL, &b->literals, char, len);
+    ecs_os_memcpy(dst, str, len);
+}
+
+#define flecs_json_plan_litl(b, str)\
+    flecs_json_plan_lit(b, str, sizeof(str) - 1)
+
+static
+void flecs_json_plan_push(
+    flecs_json_plan_builder_t *b,
+    const char *open)
+{
+    flecs_json_plan_lit(b, open, 1);
+    if (++ b->list_sp >= ECS_STRBUF_MAX_LIST_DEPTH) {
+        b->invalid = true;
+        b->list_sp --;
+    }
+    b->list_count[b->list_sp] = 0;
+}
+
+static
+void flecs_json_plan_pop(
+    flecs_json_plan_builder_t *b,
+    const char *close)
+{
+    flecs_json_plan_lit(b, close, 1);
+    if (b->list_sp) {
+        b->list_sp --;
+    }
+}
+
+static
+void flecs_json_plan_next(
+    flecs_json_plan_builder_t *b)
+{
+    if (b->list_count[b->list_sp] ++) {
+        flecs_json_plan_litl(b, ", ");
+    }
+}
+
+static
+void flecs_json_plan_step(
+    flecs_json_plan_builder_t *b,
+    int32_t op,
+    ecs_meta_type_op_kind_t kind,
+    ecs_size_t offset,
+    bool elements)
+{
+    int32_t lit_end = ecs_vec_count(&b->literals);
+    if (lit_end - b->lit > FLECS_JSON_PLAN_MAX_LITERAL) {
+        b->invalid = true;
+    }
+
+    ecs_json_ser_step_t *step = ecs_vec_append_t(
+        NULL, &b->steps, ecs_json_ser_step_t);
+    step->lit = b->lit;
+    step->lit_len = lit_end - b->lit;
+    step->op = op;
+    step->offset = offset;
+    step->kind = kind;
+    step->elements = elements;
+    b->lit = lit_end;
+
+    if (op != -1) {
+        b->value_count ++;
+    }
+}
+
+/* Compile ops into steps, follows the same logic as json_ser_type_ops */
+static
+void flecs_json_plan_ops(
+    flecs_json_plan_builder_t *b,
+    const ecs_meta_type_op_t *ops_base,
+    const ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    ecs_size_t offset,
+    int32_t in_array)
+{
+    for (int i = 0; i < op_count; i ++) {
+        const ecs_meta_type_op_t *op = &ops[i];
+
+        if (in_array <= 0) {
+            if (op->name) {
+                flecs_json_plan_next(b);
+                flecs_json_plan_litl(b, "\"");
+                flecs_json_plan_lit(b, op->name, ecs_os_strlen(op->name));
+                flecs_json_plan_litl(b, "\":");
+            }
+
+            int32_t elem_count = op->count;
+            if (elem_count > FLECS_JSON_PLAN_MAX_UNROLL) {
+                flecs_json_plan_step(b, (int32_t)(op - ops_base), op->kind, 
+                    offset + op->offset, true);
+                i += op->op_count - 1;
+                continue;
+            } else if (elem_count > 1) {
+                flecs_json_plan_push(b, "[");
+                for (int e = 0; e < elem_count; e ++) {
+                    flecs_json_plan_next(b);
+                    flecs_json_plan_ops(b, ops_base, op, op->op_count, 
+                        offset + e * op->size, 1);
+                }
+                flecs_json_plan_pop(b, "]");
+
+                i += op->op_count - 1;
+                continue;
+            }
+        }
+
+        switch(op->kind) {
+        case EcsOpPush:
+            flecs_json_plan_push(b, "{");
+            in_array --;
+            break;
+        case EcsOpPop:
+            flecs_json_plan_pop(b, "}");
+            in_array ++;
+            break;
+        default:
+            flecs_json_plan_step(b, (int32_t)(op - ops_base), op->kind, 
+                offset + op->offset, false);
+            break;
+        }
+    }
+}
+
+ecs_json_ser_plan_t* flecs_json_ser_plan_init(
+    const ecs_vector_t *v_ops)
+{
+    const ecs_meta_type_op_t *ops = ecs_vector_first(
+        v_ops, ecs_meta_type_op_t);
+    int32_t op_count = ecs_vector_count(v_ops);
+    if (!op_count) {
+        return NULL;
+    }
+
+    flecs_json_plan_builder_t b = {0};
+    ecs_vec_init_t(NULL, &b.steps, ecs_json_ser_step_t, op_count);
+    ecs_vec_init_t(NULL, &b.literals, char, 64);
+
+    flecs_json_plan_ops(&b, ops, ops, op_count, 0, 0);
+
+    /* Trailing literal (closing braces) */
+    if (ecs_vec_count(&b.literals) != b.lit) {
+        flecs_json_plan_step(&b, -1, 0, 0, false);
+    }
+
+    ecs_json_ser_plan_t *plan = NULL;
+    if (!b.invalid) {
+        /* Store plan in a single allocation */
+        int32_t step_count = ecs_vec_count(&b.steps);
+        int32_t lit_count = ecs_vec_count(&b.literals);
+        ecs_size_t steps_size = step_count * ECS_SIZEOF(ecs_json_ser_step_t);
+        plan = ecs_os_malloc(ECS_SIZEOF(ecs_json_ser_plan_t) + 
+            steps_size + lit_count);
+        plan->steps = ECS_OFFSET(plan, ECS_SIZEOF(ecs_json_ser_plan_t));
+        plan->step_count = step_count;
+        plan->literals = ECS_OFFSET(plan->steps, steps_size);
+        plan->size_hint = lit_count + b.value_count * 8;
+        ecs_os_memcpy(plan->steps, ecs_vec_first(&b.steps), steps_size);
+        ecs_os_memcpy(plan->literals, ecs_vec_first(&b.literals), lit_count);
+    }
+
+    ecs_vec_fini_t(NULL, &b.steps, ecs_json_ser_step_t);
+    ecs_vec_fini_t(NULL, &b.literals, char);
+
+    return plan;
+}
+
+void flecs_json_ser_plan_free(
+    ecs_json_ser_plan_t *plan)
+{
+    ecs_os_free(plan);
+}
+
+/* Writes the output of a plan straight to memory. Output either goes to a
+ * stack buffer that is copied to the strbuf, or, for large arrays, to heap
+ * chunks that are handed over to the strbuf without copying. */
+typedef struct flecs_json_writer_t {
+    ecs_strbuf_t *str;
+    char *buf;              /* Start of output not yet added to str */
+    char *ptr;              /* Write position */
+    char *end;              /* End of the current buffer */
+    ecs_size_t chunk_size;  /* Size of heap chunks, 0 if writer uses stack */
+    char stack[FLECS_JSON_WRITER_STACK_SIZE];
+} flecs_json_writer_t;
+
+static
+void flecs_json_writer_init(
+    flecs_json_writer_t *w,
+    ecs_strbuf_t *str,
+    ecs_size_t size_hint)
+{
+    w->str = str;
+    w->chunk_size = 0;
+    if (size_hint > FLECS_JSON_WRITER_STACK_SIZE && !str->buf && !str->max) {
+        w->chunk_size = size_hint < FLECS_JSON_WRITER_CHUNK_SIZE ? 
+            size_hint : FLECS_JSON_WRITER_CHUNK_SIZE;
+        w->buf = w->ptr = w->end = NULL;
+    } else {
+        w->buf = w->ptr = w->stack;
+        w->end = w->stack + FLECS_JSON_WRITER_STACK_SIZE;
+    }
+}
+
+/* Add pending output to str, so it can be appended to directly */
+static
+void flecs_json_writer_sync(
+    flecs_json_writer_t *w)
+{
+    if (w->ptr != w->buf) {
+        ecs_strbuf_appendstrn(w->str, w->buf, (int32_t)(w->ptr - w->buf));
+        w->ptr = w->buf;
+    }
+}
+
+static
+void flecs_json_writer_fini(
+    flecs_json_writer_t *w)
+{
+    if (w->chunk_size && w->buf) {
+        int32_t written = (int32_t)(w->ptr - w->buf);
+        if (written > ECS_STRBUF_ELEMENT_SIZE) {
+            ecs_strbuf_appendstr_zerocpyn(w->str, w->buf, written);
+        } else {
+            flecs_json_writer_sync(w);
+            ecs_os_free(w->buf);
+        }
+    } else {
+        flecs_json_writer_sync(w);
+    }
+}
+
+static
+char* flecs_json_writer_grow(
+    flecs_json_writer_t *w,
+    ecs_size_t size)
+{
+    if (w->chunk_size) {
+        if (w->ptr != w->buf) {
+            ecs_strbuf_appendstr_zerocpyn(
+                w->str, w->buf, (int32_t)(w->ptr - w->buf));
+        } else {
+            ecs_os_free(w->buf);
+        }
+        if (size < w->chunk_size) {
+            size = w->chunk_size;
+        }
+        w->buf = w->ptr = ecs_os_malloc(size);
+        w->end = w->buf + size;
+    } else {
+        ecs_assert(size <= FLECS_JSON_WRITER_STACK_SIZE, 
+            ECS_INTERNAL_ERROR, NULL);
+        flecs_json_writer_sync(w);
+    }
+    return w->ptr;
+}
+
+/* Return a pointer with at least size bytes of space */
+static
+char* flecs_json_writer_reserve(
+    flecs_json_writer_t *w,
+    ecs_size_t size)
+{
+    if ((w->end - w->ptr) >= size) {
+        return w->ptr;
+    }
+    return flecs_json_writer_grow(w, size);
+}
+
+static
+void flecs_json_writer_string(
+    flecs_json_writer_t *w,
+    const char *value,
+    ecs_size_t len)
+{
+    if (len > FLECS_JSON_PLAN_MAX_LITERAL) {
+        flecs_json_writer_sync(w);
+        ecs_strbuf_appendch(w->str, '"');
+        ecs_strbuf_appendstrn(w->str, value, len);
+        ecs_strbuf_appendch(w->str, '"');
+    } else {
+        char *ptr = flecs_json_writer_reserve(w, len + 2);
+        ptr[0] = '"';
+        ecs_os_memcpy(&ptr[1], value, len);
+        ptr[len + 1] = '"';
+        w->ptr = &ptr[len + 2];
+    }
+}
+
+static
+int flecs_json_writer_enum(
+    const ecs_world_t *world,
+    flecs_json_writer_t *w,
+    const ecs_meta_type_op_t *op,
+    const void *ptr)
+{
+    const EcsEnum *enum_type = ecs_get(world, op->type, EcsEnum);
+    ecs_check(enum_type != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t value = *(int32_t*)ptr;
+    ecs_enum_constant_t *constant = ecs_map_get_deref(&enum_type->constants,
+        ecs_enum_constant_t, (ecs_map_key_t)value);
+    if (!constant) {
+        goto error;
+    }
+
+    const char *name = ecs_get_name(world, constant->constant);
+    flecs_json_writer_string(w, name, ecs_os_strlen(name));
+
+    return 0;
+error:
+    return -1;
+}
+
+/* Serialize a value with a plan */
+static
+int flecs_json_ser_plan(
+    const ecs_world_t *world,
+    const ecs_meta_type_op_t *ops,
+    const ecs_json_ser_plan_t *plan,
+    const void *base,
+    flecs_json_writer_t *w)
+{
+    const ecs_json_ser_step_t *steps = plan->steps;
+    int32_t s, step_count = plan->step_count;
+
+    for (s = 0; s < step_count; s ++) {
+        const ecs_json_ser_step_t *step = &steps[s];
+        char *ptr = flecs_json_writer_reserve(w, 
+            step->lit_len + FLECS_FTOA_SIZE);
+        ecs_os_memcpy(ptr, &plan->literals[step->lit], step->lit_len);
+        ptr += step->lit_len;
+
+        if (step->op == -1) {
+            w->ptr = ptr;
+            continue;
+        }
+
+        const void *vptr = ECS_OFFSET(base, step->offset);
+        const ecs_meta_type_op_t *op = &ops[step->op];
+
+        if (step->elements) {
+            w->ptr = ptr;
+            flecs_json_writer_sync(w);
+            if (json_ser_elements(world, (ecs_meta_type_op_t*)op, 
+                op->op_count, ECS_OFFSET(vptr, -op->offset), op->count, 
+                op->size, w->str))
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        switch(step->kind) {
+        case EcsOpBool:
+            if (*(bool*)vptr) {
+                ecs_os_memcpy(ptr, "true", 4);
+                ptr += 4;
+            } else {
+                ecs_os_memcpy(ptr, "false", 5);
+                ptr += 5;
+            }
+            break;
+        case EcsOpChar: {
+            char ch = *(char*)vptr;
+            if (ch) {
+                *ptr++ = '"';
+                ptr = ecs_chresc(ptr, ch, '"');
+                *ptr++ = '"';
+            } else {
+                *ptr++ = '0';
+            }
+            break;
+        }
+        case EcsOpByte:
+        case EcsOpU8:
+            ptr = flecs_utoa(ptr, *(uint8_t*)vptr);
+            break;
+        case EcsOpU16:
+            ptr = flecs_utoa(ptr, *(uint16_t*)vptr);
+            break;
+        case EcsOpU32:
+            ptr = flecs_utoa(ptr, *(uint32_t*)vptr);
+            break;
+        case EcsOpU64:
+            ptr = flecs_utoa(ptr, *(uint64_t*)vptr);
+            break;
+        case EcsOpI8:
+            ptr = flecs_itoa(ptr, *(int8_t*)vptr);
+            break;
+        case EcsOpI16:
+            ptr = flecs_itoa(ptr, *(int16_t*)vptr);
+            break;
+        case EcsOpI32:
+            ptr = flecs_itoa(ptr, *(int32_t*)vptr);
+            break;
+        case EcsOpI64:
+            ptr = flecs_itoa(ptr, *(int64_t*)vptr);
+            break;
+        case EcsOpIPtr:
+            ptr = flecs_itoa(ptr, *(intptr_t*)vptr);
+            break;
+        case EcsOpF32:
+            ptr += flecs_ftoa(ptr, (ecs_f64_t)*(ecs_f32_t*)vptr, 10, '"');
+            break;
+        case EcsOpF64:
+            ptr += flecs_ftoa(ptr, *(ecs_f64_t*)vptr, 10, '"');
+            break;
+        case EcsOpString: {
+            const char *value = *(char**)vptr;
+            if (!value) {
+                ecs_os_memcpy(ptr, "null", 4);
+                ptr += 4;
+                break;
+            }
+
+            w->ptr = ptr;
+            ecs_size_t len = ecs_os_strlen(value);
+            if (!flecs_json_needs_escape(value, len)) {
+                flecs_json_writer_string(w, value, len);
+            } else {
+                flecs_json_writer_sync(w);
+                flecs_json_string_escape(w->str, value);
+            }
+            continue;
+        }
+        case EcsOpEnum:
+            w->ptr = ptr;
+            if (flecs_json_writer_enum(world, w, op, vptr)) {
+                return -1;
+            }
+            continue;
+        default:
+            /* Values that are appended by the type op (entities, bitmasks,
+             * collections) */
+            w->ptr = ptr;
+            flecs_json_writer_sync(w);
+            if (json_ser_type_op(world, (ecs_meta_type_op_t*)op, 
+                ECS_OFFSET(vptr, -op->offset), w->str)) 
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        w->ptr = ptr;
+    }
+
+    return 0;
+}
+
+/* Serialize value or array of values with a plan */
+static
+int flecs_json_ser_plan_array(
+    const ecs_world_t *world,
+    const EcsMetaTypeSerialized *ser,
+    const void *ptr,
+    int32_t count,
+    ecs_size_t size,
+    ecs_strbuf_t *str)
+{
+    const ecs_json_ser_plan_t *plan = ser->json_plan;
+    const ecs_meta_type_op_t *ops = ecs_vector_first(
+        ser->ops, ecs_meta_type_op_t);
+    flecs_json_writer_t w;
+    int result = 0;
+
+    if (!count) {
+        flecs_json_writer_init(&w, str, 0);
+        result = flecs_json_ser_plan(world, ops, plan, ptr, &w);
+    } else {
+        /* Size chunks of output for the whole array */
+        flecs_json_writer_init(&w, str, count * plan->size_hint);
+        *flecs_json_writer_reserve(&w, 1) = '[';
+        w.ptr ++;
+
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            if (i) {
+                char *sep = flecs_json_writer_reserve(&w, 2);
+                sep[0] = ',';
+                sep[1] = ' ';
+                w.ptr += 2;
+            }
+            if ((result = flecs_json_ser_plan(world, ops, plan, ptr, &w))) {
+                break;
+            }
+            ptr = ECS_OFFSET(ptr, size);
+        }
+
+        *flecs_json_writer_reserve(&w, 1) = ']';
+        w.ptr ++;
+    }
+
+    flecs_json_writer_fini(&w);
+    return result;
+}
+
 /* Iterate over the type ops of a type */
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *v_ops,
+    const EcsMetaTypeSerialized *ser,
     const void *base, 
     ecs_strbuf_t *str) 
 {
-    ecs_meta_type_op_t *ops = ecs_vector_first(v_ops, ecs_meta_type_op_t);
-    int32_t count = ecs_vector_count(v_ops);
+    if (ser->json_plan) {
+        return flecs_json_ser_plan_array(world, ser, base, 0, 0, str);
+    }
+
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t count = ecs_vector_count(ser->ops);
     return json_ser_type_ops(world, ops, count, base, str, 0);
 }
 
@@ -33818,14 +38949,17 @@ int array_to_json_buf_w_type_data(
     const EcsComponent *comp,
     const EcsMetaTypeSerialized *ser)
 {
-    if (count) {
+    if (count && ser->json_plan) {
+        return flecs_json_ser_plan_array(
+            world, ser, ptr, count, comp->size, buf);
+    } else if (count) {
         ecs_size_t size = comp->size;
 
         flecs_json_array_push(buf);
 
         do {
             ecs_strbuf_list_next(buf);
-            if (json_ser_type(world, ser->ops, ptr, buf)) {
+            if (json_ser_type(world, ser, ptr, buf)) {
                 return -1;
             }
 
@@ -33834,7 +38968,7 @@ int array_to_json_buf_w_type_data(
 
         flecs_json_array_pop(buf);
     } else {
-        if (json_ser_type(world, ser->ops, ptr, buf)) {
+        if (json_ser_type(world, ser, ptr, buf)) {
             return -1;
         }
     }
@@ -34066,7 +39200,7 @@ int flecs_json_append_type_values(
                     ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
 
                     flecs_json_next(buf);
-                    if (json_ser_type(world, ser->ops, ptr, buf) != 0) {
+                    if (json_ser_type(world, ser, ptr, buf) != 0) {
                         /* Entity contains invalid value */
                         return -1;
                     }
@@ -35695,6 +40829,9 @@ typedef struct {
     ecs_map_t reply_cache;
     int32_t rc;
     ecs_ftime_t time;
+#ifdef FLECS_STATS
+    ecs_stats_stream_t stats_stream; /* Sampled once a client requests it */
+#endif
 } ecs_rest_ctx_t;
 
 /* Global statistics */
@@ -35715,6 +40852,7 @@ int64_t ecs_rest_delete_error_count = 0;
 int64_t ecs_rest_world_stats_count = 0;
 int64_t ecs_rest_pipeline_stats_count = 0;
 int64_t ecs_rest_stats_error_count = 0;
+int64_t ecs_rest_stats_stream_count = 0;
 
 static
 void flecs_rest_free_reply_cache(ecs_map_t *reply_cache) {
@@ -35729,6 +40867,16 @@ void flecs_rest_free_reply_cache(ecs_map_t *reply_cache) {
     }
 }
 
+/* Kept out of the hook macros, directives in macro arguments aren't portable */
+static
+void flecs_rest_fini_stats_stream(ecs_rest_ctx_t *impl) {
+#ifdef FLECS_STATS
+    ecs_stats_stream_fini(&impl->stats_stream);
+#else
+    (void)impl;
+#endif
+}
+
 static ECS_COPY(EcsRest, dst, src, {
     ecs_rest_ctx_t *impl = src->impl;
     if (impl) {
@@ -35753,6 +40901,7 @@ static ECS_DTOR(EcsRest, ptr, {
         if (!impl->rc) {
             ecs_http_server_fini(impl->srv);
             flecs_rest_free_reply_cache(&impl->reply_cache);
+            flecs_rest_fini_stats_stream(impl);
             ecs_os_free(impl);
         }
     }
@@ -36250,6 +41399,7 @@ void flecs_world_stats_to_json(
     ECS_GAUGE_APPEND(reply, stats, tables.storage_count, "Component storages for all tables");
     ECS_COUNTER_APPEND(reply, stats, tables.create_count, "Number of new tables created");
     ECS_COUNTER_APPEND(reply, stats, tables.delete_count, "Number of tables deleted");
+    ECS_COUNTER_APPEND(reply, stats, tables.realloc_count, "Number of table storage resizes");
 
     ECS_GAUGE_APPEND(reply, stats, ids.count, "Component, tag and pair ids in use");
     ECS_GAUGE_APPEND(reply, stats, ids.tag_count, "Tag ids in use");
@@ -36274,6 +41424,10 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
     ECS_COUNTER_APPEND(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
     ECS_GAUGE_APPEND(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_live_bytes, "Bytes in use, thread caching allocator");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_peak_bytes, "Peak bytes in use or cached, thread caching allocator");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_cached_bytes, "Bytes in thread caches, thread caching allocator");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_reserved_bytes, "Bytes reserved from OS, thread caching allocator");
 
     ECS_COUNTER_APPEND(reply, stats, rest.request_count, "Received requests");
     ECS_COUNTER_APPEND(reply, stats, rest.entity_count, "Received entity/ requests");
@@ -36288,6 +41442,7 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, rest.world_stats_count, "Received world stats requests");
     ECS_COUNTER_APPEND(reply, stats, rest.pipeline_stats_count, "Received pipeline stats requests");
     ECS_COUNTER_APPEND(reply, stats, rest.stats_error_count, "Failed stats requests");
+    ECS_COUNTER_APPEND(reply, stats, rest.stats_stream_count, "Received stats stream requests");
 
     ECS_COUNTER_APPEND(reply, stats, http.request_received_count, "Received requests");
     ECS_COUNTER_APPEND(reply, stats, http.request_invalid_count, "Received invalid requests");
@@ -36412,6 +41567,54 @@ bool flecs_rest_reply_stats(
 }
 #endif
 
+#ifdef FLECS_STATS
+static
+bool flecs_rest_reply_stats_stream(
+    ecs_world_t *world,
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    const char *seq_str = ecs_http_get_param(req, "seq");
+    int64_t seq = seq_str ? atoll(seq_str) : 0;
+    if (seq < 0) {
+        seq = 0;
+    }
+
+    bool names = false;
+    flecs_rest_bool_param(req, "names", &names);
+
+    /* Sampling starts with the first request, so applications that don't
+     * use the stream don't pay for it */
+    ecs_stats_stream_t *stream = &impl->stats_stream;
+    if (!stream->samples) {
+        ecs_stats_stream_init(stream, 0);
+        ecs_stats_stream_sample(world, stream);
+    }
+
+    ecs_size_t size = 0;
+    char *data = ecs_stats_stream_encode(stream, seq, names, &size);
+    ecs_strbuf_appendstr_zerocpyn(&reply->body, data, size);
+    reply->content_type = "application/octet-stream";
+    ecs_os_linc(&ecs_rest_stats_stream_count);
+    return true;
+}
+#else
+static
+bool flecs_rest_reply_stats_stream(
+    ecs_world_t *world,
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    (void)world;
+    (void)impl;
+    (void)req;
+    (void)reply;
+    return false;
+}
+#endif
+
 static
 void flecs_rest_reply_table_append_type(
     ecs_world_t *world,
@@ -36522,6 +41725,10 @@ bool flecs_rest_reply(
         } else if (!ecs_os_strcmp(req->path, "query")) {
             return flecs_rest_reply_query(world, impl, req, reply);
 
+        /* Stats stream endpoint */
+        } else if (!ecs_os_strcmp(req->path, "stats/stream")) {
+            return flecs_rest_reply_stats_stream(world, impl, req, reply);
+
         /* Stats endpoint */
         } else if (!ecs_os_strncmp(req->path, "stats/", 6)) {
             return flecs_rest_reply_stats(world, req, reply);
@@ -36605,6 +41812,11 @@ void DequeueRest(ecs_iter_t *it) {
         ecs_rest_ctx_t *ctx = rest[i].impl;
         if (ctx) {
             ctx->time += it->delta_time;
+#ifdef FLECS_STATS
+            if (ctx->stats_stream.samples) {
+                ecs_stats_stream_sample(it->world, &ctx->stats_stream);
+            }
+#endif
             ecs_http_server_dequeue(ctx->srv, it->delta_time);
         }
     } 
@@ -36860,8 +42072,12 @@ void FlecsCoreDocImport(
 typedef SOCKET ecs_http_socket_t;
 #else
 #include <unistd.h>
+#include <fcntl.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/time.h>
 #include <netdb.h>
 #include <strings.h>
@@ -36869,36 +42085,76 @@ typedef SOCKET ecs_http_socket_t;
 typedef int ecs_http_socket_t;
 #endif
 
-#if !defined(MSG_NOSIGNAL)
-#define MSG_NOSIGNAL (0)
+/* The server thread waits for socket events with epoll where available, and
+ * falls back to poll (WSAPoll on Windows) otherwise. */
+#if defined(ECS_TARGET_LINUX)
+#define ECS_HTTP_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#elif !defined(ECS_TARGET_WINDOWS)
+#include <poll.h>
+#endif
+
+/* Loads/stores of the queue indices shared by the server and main thread */
+#if defined(ECS_TARGET_MSVC)
+#define http_atomic_load(ptr)\
+    ((uint32_t)InterlockedCompareExchange((volatile LONG*)(ptr), 0, 0))
+#define http_atomic_store(ptr, value)\
+    InterlockedExchange((volatile LONG*)(ptr), (LONG)(value))
+#else
+#define http_atomic_load(ptr)\
+    __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define http_atomic_store(ptr, value)\
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
 #endif
 
 /* Max length of request method */
-#define ECS_HTTP_METHOD_LEN_MAX (8) 
+#define ECS_HTTP_METHOD_LEN_MAX (8)
+
+/* Timeout (s) before an idle connection is closed */
+#define ECS_HTTP_CONNECTION_IDLE_TIMEOUT (10.0)
 
-/* Timeout (s) before connection purge */
-#define ECS_HTTP_CONNECTION_PURGE_TIMEOUT (1.0)
+/* Interval (s) between checking connections for the idle timeout */
+#define ECS_HTTP_CONNECTION_PURGE_INTERVAL (1.0)
 
-/* Number of dequeues before purging */
-#define ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT (5)
+/* Max number of requests handled by a single dequeue */
+#define ECS_HTTP_DEQUEUE_MAX (64)
 
-/* Minimum interval between dequeueing requests (ms) */
-#define ECS_HTTP_MIN_DEQUEUE_INTERVAL (50)
+/* Max time (s) spent on requests by a single dequeue. Requests that don't fit
+ * in the budget are handled by the next dequeue. */
+#define ECS_HTTP_DEQUEUE_BUDGET (0.002)
 
 /* Minimum interval between printing statistics (ms) */
 #define ECS_HTTP_MIN_STATS_INTERVAL (10 * 1000)
 
-/* Max length of headers in reply */
-#define ECS_HTTP_REPLY_HEADER_SIZE (1024)
-
 /* Receive buffer size */
 #define ECS_HTTP_SEND_RECV_BUFFER_SIZE (16 * 1024)
 
 /* Max length of request (path + query + headers + body) */
 #define ECS_HTTP_REQUEST_LEN_MAX (10 * 1024 * 1024)
 
-/* Total number of outstanding send requests */
-#define ECS_HTTP_SEND_QUEUE_MAX (256)
+/* Max number of requests that are handed to the main thread and not yet
+ * replied to. Must be a power of 2. */
+#define ECS_HTTP_QUEUE_SIZE (256)
+
+/* Max number of socket events handled per server thread wakeup */
+#define ECS_HTTP_POLL_EVENTS_MAX (64)
+
+/* Max time (ms) the server thread waits for socket events */
+#define ECS_HTTP_POLL_TIMEOUT (100)
+
+/* Max number of buffers passed to a single send */
+#define ECS_HTTP_SEND_BUFFERS_MAX (64)
+
+/* Socket events */
+#define HTTP_POLL_IN (1)
+#define HTTP_POLL_OUT (2)
+#define HTTP_POLL_ERR (4)
+
+/* Poll ids of the listening socket and wakeup signal. Connections are polled
+ * with the connection id. */
+#define HTTP_POLL_ID_LISTEN (0)
+#define HTTP_POLL_ID_WAKE (UINT64_MAX)
 
 /* Global statistics */
 int64_t ecs_http_request_received_count = 0;
@@ -36911,22 +42167,35 @@ int64_t ecs_http_send_ok_count = 0;
 int64_t ecs_http_send_error_count = 0;
 int64_t ecs_http_busy_count = 0;
 
-/* Send request queue */
-typedef struct ecs_http_send_request_t {
-    ecs_http_socket_t sock;
-    char *headers;
-    int32_t header_length;
-    char *content;
-    int32_t content_length;
-} ecs_http_send_request_t;
+/* Single producer, single consumer queue. Hands requests from the server
+ * thread to the main thread, and replies back. */
+typedef struct ecs_http_queue_t {
+    void *elems[ECS_HTTP_QUEUE_SIZE];
+    uint32_t head; /* Next element to pop, written by consumer */
+    uint32_t tail; /* Next element to push, written by producer */
+} ecs_http_queue_t;
 
-typedef struct ecs_http_send_queue_t {
-    ecs_http_send_request_t requests[ECS_HTTP_SEND_QUEUE_MAX];
-    int32_t cur;
-    int32_t count;
-    ecs_os_thread_t thread;
-    int32_t wait_ms;
-} ecs_http_send_queue_t;
+/* Buffer of an outgoing reply */
+typedef struct ecs_http_send_buf_t {
+    const char *ptr;
+    int32_t length;
+    void *alloc; /* Freed when the reply is freed */
+} ecs_http_send_buf_t;
+
+/* Outgoing reply. Holds the chunks of the header and body strbufs so they can
+ * be sent without first copying them into a single buffer. */
+typedef struct ecs_http_send_t {
+    uint64_t conn_id;
+    ecs_vec_t bufs; /* vec<ecs_http_send_buf_t> */
+    int32_t cur; /* First buffer that isn't completely sent */
+    int32_t offset; /* Number of bytes sent from the current buffer */
+    bool close; /* Close connection after sending the reply */
+} ecs_http_send_t;
+
+typedef struct {
+    uint64_t id;
+    int32_t events;
+} ecs_http_poll_event_t;
 
 /* HTTP server struct */
 struct ecs_http_server_t {
@@ -36934,30 +42203,44 @@ struct ecs_http_server_t {
     bool running;
 
     ecs_http_socket_t sock;
-    ecs_os_mutex_t lock;
     ecs_os_thread_t thread;
 
     ecs_http_reply_action_t callback;
     void *ctx;
 
+    /* Only accessed by the server thread */
     ecs_sparse_t connections; /* sparse<http_connection_t> */
-    ecs_sparse_t requests; /* sparse<http_request_t> */
+    int32_t inflight; /* requests handed to main thread without a reply */
+    uint64_t request_id; /* id of last received request */
+    double now; /* time of the current server thread iteration */
+    double purge_time; /* time connections were last checked for timeout */
+
+    ecs_http_queue_t requests; /* queue<ecs_http_request_impl_t*> */
+    ecs_http_queue_t replies; /* queue<ecs_http_send_t*> */
+
+#ifdef ECS_HTTP_EPOLL
+    int epoll_fd;
+    int wake_fd; /* eventfd used to wake up the server thread */
+#else
+    ecs_vec_t poll_fds; /* vec<struct pollfd> */
+    ecs_vec_t poll_ids; /* vec<uint64_t> */
+#ifndef ECS_TARGET_WINDOWS
+    int wake_fds[2]; /* pipe used to wake up the server thread */
+#endif
+#endif
 
     bool initialized;
 
     uint16_t port;
     const char *ipaddr;
 
-    double dequeue_timeout; /* used to not lock request queue too often */
     double stats_timeout; /* used for periodic reporting of statistics */
 
     double request_time; /* time spent on requests in last stats interval */
     double request_time_total; /* total time spent on requests */
     int32_t requests_processed; /* requests processed in last stats interval */
     int32_t requests_processed_total; /* total requests processed */
-    int32_t dequeue_count; /* number of dequeues in last stats interval */ 
-
-    ecs_http_send_queue_t send_queue;
+    int32_t dequeue_count; /* number of dequeues in last stats interval */
 };
 
 /** Fragment state, used by HTTP request parser */
@@ -36994,173 +42277,648 @@ typedef struct {
     char *header_buf_ptr;
     char header_buf[32];
     bool parse_content_length;
+    bool parse_connection;
+    bool close; /* HTTP/1.0 or Connection: close */
     bool invalid;
 } ecs_http_fragment_t;
 
+/** Connection state */
+typedef enum {
+    HttpConnReading, /* Receiving request */
+    HttpConnWaiting, /* Request is handled by main thread */
+    HttpConnWriting  /* Sending reply */
+} HttpConnState;
+
 /** Extend public connection type with fragment data */
 typedef struct {
     ecs_http_connection_t pub;
     ecs_http_socket_t sock;
-
-    /* Connection is purged after both timeout expires and connection has
-     * exceeded retry count. This ensures that a connection does not immediately
-     * timeout when a frame takes longer than usual */
-    double dequeue_timeout;
-    int32_t dequeue_retries;    
+    HttpConnState state;
+    ecs_http_fragment_t frag; /* request that is being received */
+    ecs_vec_t pending; /* vec<char>, data received after the request */
+    ecs_http_send_t *send; /* reply that is being sent */
+    int32_t events; /* events the socket is polled for */
+    double last_active; /* time of last send or receive */
 } ecs_http_connection_impl_t;
 
 typedef struct {
     ecs_http_request_t pub;
-    uint64_t conn_id; /* for sanity check */
+    ecs_http_connection_t conn; /* connection is owned by the server thread */
     void *res;
+    bool close;
 } ecs_http_request_impl_t;
 
 static
-ecs_size_t http_send(
-    ecs_http_socket_t sock, 
-    const void *buf, 
-    ecs_size_t size, 
+bool http_queue_push(
+    ecs_http_queue_t *q,
+    void *elem)
+{
+    uint32_t tail = q->tail;
+    if ((tail - http_atomic_load(&q->head)) == ECS_HTTP_QUEUE_SIZE) {
+        return false;
+    }
+
+    q->elems[tail & (ECS_HTTP_QUEUE_SIZE - 1)] = elem;
+    http_atomic_store(&q->tail, tail + 1);
+    return true;
+}
+
+static
+void* http_queue_pop(
+    ecs_http_queue_t *q)
+{
+    uint32_t head = q->head;
+    if (head == http_atomic_load(&q->tail)) {
+        return NULL;
+    }
+
+    void *elem = q->elems[head & (ECS_HTTP_QUEUE_SIZE - 1)];
+    http_atomic_store(&q->head, head + 1);
+    return elem;
+}
+
+static
+double http_time_now(void) {
+    ecs_time_t t;
+    ecs_os_get_time(&t);
+    return ecs_time_to_double(t);
+}
+
+static
+bool http_would_block(void) {
+#if defined(ECS_TARGET_WINDOWS)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static
+ecs_size_t http_sendv(
+    ecs_http_socket_t sock,
+    const ecs_http_send_buf_t *bufs,
+    int32_t count,
+    int32_t offset)
+{
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(offset < bufs[0].length, ECS_INTERNAL_ERROR, NULL);
+    if (count > ECS_HTTP_SEND_BUFFERS_MAX) {
+        count = ECS_HTTP_SEND_BUFFERS_MAX;
+    }
+
+    int32_t i;
+#ifdef ECS_TARGET_POSIX
+    struct iovec iov[ECS_HTTP_SEND_BUFFERS_MAX];
+    for (i = 0; i < count; i ++) {
+        iov[i].iov_base = (char*)bufs[i].ptr;
+        iov[i].iov_len = flecs_itosize(bufs[i].length);
+    }
+    iov[0].iov_base = (char*)iov[0].iov_base + offset;
+    iov[0].iov_len -= flecs_itosize(offset);
+
+    /* SIGPIPE is ignored by ecs_http_server_init */
+    ssize_t send_bytes = writev(sock, iov, count);
+    return flecs_itoi32(send_bytes);
+#else
+    WSABUF wsa_bufs[ECS_HTTP_SEND_BUFFERS_MAX];
+    for (i = 0; i < count; i ++) {
+        wsa_bufs[i].buf = (char*)bufs[i].ptr;
+        wsa_bufs[i].len = (ULONG)bufs[i].length;
+    }
+    wsa_bufs[0].buf += offset;
+    wsa_bufs[0].len -= (ULONG)offset;
+
+    DWORD send_bytes = 0;
+    if (WSASend(sock, wsa_bufs, (DWORD)count, &send_bytes, 0, NULL, NULL)) {
+        return -1;
+    }
+    return flecs_itoi32(send_bytes);
+#endif
+}
+
+static
+ecs_size_t http_recv(
+    ecs_http_socket_t sock,
+    void *buf,
+    ecs_size_t size,
+    int flags)
+{
+    ecs_size_t ret;
+#ifdef ECS_TARGET_POSIX
+    ssize_t recv_bytes = recv(sock, buf, flecs_itosize(size), flags);
+    ret = flecs_itoi32(recv_bytes);
+#else
+    int recv_bytes = recv(sock, buf, size, flags);
+    ret = flecs_itoi32(recv_bytes);
+#endif
+    if (ret == -1) {
+        if (!http_would_block()) {
+            ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
+        }
+    } else if (ret == 0) {
+        ecs_dbg_2("recv: received 0 bytes (sock = %d)", sock);
+    }
+
+    return ret;
+}
+
+static
+void http_sock_nonblock(
+    ecs_http_socket_t sock)
+{
+    int r;
+#ifdef ECS_TARGET_POSIX
+    int flags = fcntl(sock, F_GETFL, 0);
+    r = flags == -1 ? -1 : fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+#else
+    u_long v = 1;
+    r = ioctlsocket(sock, FIONBIO, &v);
+#endif
+    if (r) {
+        ecs_warn("http: failed to make socket non-blocking: %s",
+            ecs_os_strerror(errno));
+    }
+}
+
+static
+void http_sock_nodelay(
+    ecs_http_socket_t sock)
+{
+    int v = 1;
+    if (setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&v, sizeof v)) {
+        ecs_warn("http: failed to set socket NODELAY: %s",
+            ecs_os_strerror(errno));
+    }
+}
+
+static
+void http_sock_keep_alive(
+    ecs_http_socket_t sock)
+{
+    int v = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (const char*)&v, sizeof v)) {
+        ecs_warn("http: failed to set socket KEEPALIVE: %s",
+            ecs_os_strerror(errno));
+    }
+}
+
+static
+int http_getnameinfo(
+    const struct sockaddr* addr,
+    ecs_size_t addr_len,
+    char *host,
+    ecs_size_t host_len,
+    char *port,
+    ecs_size_t port_len,
     int flags)
 {
-    ecs_assert(size >= 0, ECS_INTERNAL_ERROR, NULL);
-#ifdef ECS_TARGET_POSIX
-    ssize_t send_bytes = send(sock, buf, flecs_itosize(size), 
-        flags | MSG_NOSIGNAL);
-    return flecs_itoi32(send_bytes);
-#else
-    int send_bytes = send(sock, buf, size, flags);
-    return flecs_itoi32(send_bytes);
+    ecs_assert(addr_len > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(host_len > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(port_len > 0, ECS_INTERNAL_ERROR, NULL);
+    return getnameinfo(addr, (uint32_t)addr_len, host, (uint32_t)host_len,
+        port, (uint32_t)port_len, flags);
+}
+
+static
+int http_bind(
+    ecs_http_socket_t sock,
+    const struct sockaddr* addr,
+    ecs_size_t addr_len)
+{
+    ecs_assert(addr_len > 0, ECS_INTERNAL_ERROR, NULL);
+    return bind(sock, addr, (uint32_t)addr_len);
+}
+
+static
+bool http_socket_is_valid(
+    ecs_http_socket_t sock)
+{
+#if defined(ECS_TARGET_WINDOWS)
+    return sock != INVALID_SOCKET;
+#else
+    return sock >= 0;
+#endif
+}
+
+#if defined(ECS_TARGET_WINDOWS)
+#define HTTP_SOCKET_INVALID INVALID_SOCKET
+#else
+#define HTTP_SOCKET_INVALID (-1)
+#endif
+
+static
+void http_close(
+    ecs_http_socket_t *sock)
+{
+    ecs_assert(sock != NULL, ECS_INTERNAL_ERROR, NULL);
+#if defined(ECS_TARGET_WINDOWS)
+    closesocket(*sock);
+#else
+    ecs_dbg_2("http: closing socket %u", *sock);
+    shutdown(*sock, SHUT_RDWR);
+    close(*sock);
+#endif
+    *sock = HTTP_SOCKET_INVALID;
+}
+
+static
+ecs_http_socket_t http_accept(
+    ecs_http_socket_t sock,
+    struct sockaddr* addr,
+    ecs_size_t *addr_len)
+{
+    socklen_t len = (socklen_t)addr_len[0];
+    ecs_http_socket_t result = accept(sock, addr, &len);
+    addr_len[0] = (ecs_size_t)len;
+    return result;
+}
+
+#ifdef ECS_HTTP_EPOLL
+
+static
+int http_poll_ctl(
+    ecs_http_server_t *srv,
+    int op,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    struct epoll_event ev = {0};
+    if (events & HTTP_POLL_IN) {
+        ev.events |= EPOLLIN;
+    }
+    if (events & HTTP_POLL_OUT) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.u64 = id;
+
+    if (epoll_ctl(srv->epoll_fd, op, sock, &ev)) {
+        ecs_err("http: failed to poll socket %d: %s", sock,
+            ecs_os_strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static
+int http_poll_add(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    return http_poll_ctl(srv, EPOLL_CTL_ADD, sock, id, events);
+}
+
+static
+int http_poll_mod(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    return http_poll_ctl(srv, EPOLL_CTL_MOD, sock, id, events);
+}
+
+static
+int http_poll_init(
+    ecs_http_server_t *srv)
+{
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (srv->epoll_fd == -1) {
+        ecs_err("http: failed to create epoll instance: %s",
+            ecs_os_strerror(errno));
+        return -1;
+    }
+
+    srv->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (srv->wake_fd == -1) {
+        ecs_err("http: failed to create eventfd: %s", ecs_os_strerror(errno));
+        close(srv->epoll_fd);
+        return -1;
+    }
+
+    if (http_poll_add(srv, srv->wake_fd, HTTP_POLL_ID_WAKE, HTTP_POLL_IN)) {
+        close(srv->wake_fd);
+        close(srv->epoll_fd);
+        return -1;
+    }
+
+    return 0;
+}
+
+static
+void http_poll_fini(
+    ecs_http_server_t *srv)
+{
+    close(srv->wake_fd);
+    close(srv->epoll_fd);
+}
+
+static
+int32_t http_poll_wait(
+    ecs_http_server_t *srv,
+    ecs_http_poll_event_t *events,
+    int32_t timeout_ms)
+{
+    struct epoll_event ev[ECS_HTTP_POLL_EVENTS_MAX];
+    int count = epoll_wait(
+        srv->epoll_fd, ev, ECS_HTTP_POLL_EVENTS_MAX, timeout_ms);
+    if (count < 0) {
+        if (errno != EINTR) {
+            ecs_err("http: epoll_wait failed: %s", ecs_os_strerror(errno));
+        }
+        return 0;
+    }
+
+    int i;
+    for (i = 0; i < count; i ++) {
+        uint32_t e = ev[i].events;
+        events[i].id = ev[i].data.u64;
+        events[i].events =
+            ((e & EPOLLIN) ? HTTP_POLL_IN : 0) |
+            ((e & EPOLLOUT) ? HTTP_POLL_OUT : 0) |
+            ((e & (EPOLLERR | EPOLLHUP)) ? HTTP_POLL_ERR : 0);
+    }
+
+    return count;
+}
+
+static
+void http_wake(
+    ecs_http_server_t *srv)
+{
+    uint64_t v = 1;
+    ssize_t r = write(srv->wake_fd, &v, sizeof(v));
+    (void)r; /* nonzero counter already wakes up the server thread */
+}
+
+static
+void http_wake_clear(
+    ecs_http_server_t *srv)
+{
+    uint64_t v;
+    ssize_t r = read(srv->wake_fd, &v, sizeof(v));
+    (void)r;
+}
+
+#else
+
+/* Sockets are collected from the connections each time the server thread
+ * waits, so there is nothing to register. */
+static
+int http_poll_add(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    (void)srv; (void)sock; (void)id; (void)events;
+    return 0;
+}
+
+static
+int http_poll_mod(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    (void)srv; (void)sock; (void)id; (void)events;
+    return 0;
+}
+
+static
+int http_poll_init(
+    ecs_http_server_t *srv)
+{
+    ecs_vec_init_t(NULL, &srv->poll_fds, struct pollfd, 0);
+    ecs_vec_init_t(NULL, &srv->poll_ids, uint64_t, 0);
+#ifndef ECS_TARGET_WINDOWS
+    if (pipe(srv->wake_fds)) {
+        ecs_err("http: failed to create pipe: %s", ecs_os_strerror(errno));
+        ecs_vec_fini_t(NULL, &srv->poll_fds, struct pollfd);
+        ecs_vec_fini_t(NULL, &srv->poll_ids, uint64_t);
+        return -1;
+    }
+    http_sock_nonblock(srv->wake_fds[0]);
+    http_sock_nonblock(srv->wake_fds[1]);
+#endif
+    return 0;
+}
+
+static
+void http_poll_fini(
+    ecs_http_server_t *srv)
+{
+#ifndef ECS_TARGET_WINDOWS
+    close(srv->wake_fds[0]);
+    close(srv->wake_fds[1]);
 #endif
+    ecs_vec_fini_t(NULL, &srv->poll_fds, struct pollfd);
+    ecs_vec_fini_t(NULL, &srv->poll_ids, uint64_t);
 }
 
 static
-ecs_size_t http_recv(
+void http_poll_fd(
+    ecs_http_server_t *srv,
     ecs_http_socket_t sock,
-    void *buf,
-    ecs_size_t size,
-    int flags)
+    uint64_t id,
+    int32_t events)
 {
-    ecs_size_t ret;
-#ifdef ECS_TARGET_POSIX
-    ssize_t recv_bytes = recv(sock, buf, flecs_itosize(size), flags);
-    ret = flecs_itoi32(recv_bytes);
+    struct pollfd *fd = ecs_vec_append_t(NULL, &srv->poll_fds, struct pollfd);
+    fd->fd = sock;
+    fd->events = (short)(
+        ((events & HTTP_POLL_IN) ? POLLIN : 0) |
+        ((events & HTTP_POLL_OUT) ? POLLOUT : 0));
+    fd->revents = 0;
+    ecs_vec_append_t(NULL, &srv->poll_ids, uint64_t)[0] = id;
+}
+
+static
+int32_t http_poll_wait(
+    ecs_http_server_t *srv,
+    ecs_http_poll_event_t *events,
+    int32_t timeout_ms)
+{
+    ecs_vec_clear(&srv->poll_fds);
+    ecs_vec_clear(&srv->poll_ids);
+
+#ifndef ECS_TARGET_WINDOWS
+    http_poll_fd(srv, srv->wake_fds[0], HTTP_POLL_ID_WAKE, HTTP_POLL_IN);
 #else
-    int recv_bytes = recv(sock, buf, size, flags);
-    ret = flecs_itoi32(recv_bytes);
+    /* Without a wakeup signal, poll often while the main thread has requests
+     * so replies don't wait for the timeout */
+    if (srv->inflight) {
+        timeout_ms = 1;
+    }
 #endif
-    if (ret == -1) {
-        ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
-    } else if (ret == 0) {
-        ecs_dbg("recv: received 0 bytes (sock = %d)", sock);
+
+    if (http_socket_is_valid(srv->sock)) {
+        http_poll_fd(srv, srv->sock, HTTP_POLL_ID_LISTEN, HTTP_POLL_IN);
     }
 
-    return ret;
+    int32_t i, count = flecs_sparse_count(&srv->connections);
+    for (i = 1; i < count; i ++) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense_t(
+            &srv->connections, ecs_http_connection_impl_t, i);
+        if (conn->events) {
+            http_poll_fd(srv, conn->sock, conn->pub.id, conn->events);
+        }
+    }
+
+    struct pollfd *fds = ecs_vec_first(&srv->poll_fds);
+    uint64_t *ids = ecs_vec_first(&srv->poll_ids);
+    int32_t fd_count = ecs_vec_count(&srv->poll_fds);
+#ifdef ECS_TARGET_WINDOWS
+    int r = WSAPoll(fds, (ULONG)fd_count, timeout_ms);
+#else
+    int r = poll(fds, (nfds_t)fd_count, timeout_ms);
+#endif
+    if (r <= 0) {
+        return 0;
+    }
+
+    int32_t result = 0;
+    for (i = 0; i < fd_count && result < ECS_HTTP_POLL_EVENTS_MAX; i ++) {
+        short e = fds[i].revents;
+        if (!e) {
+            continue;
+        }
+        events[result].id = ids[i];
+        events[result].events =
+            ((e & POLLIN) ? HTTP_POLL_IN : 0) |
+            ((e & POLLOUT) ? HTTP_POLL_OUT : 0) |
+            ((e & (POLLERR | POLLHUP | POLLNVAL)) ? HTTP_POLL_ERR : 0);
+        result ++;
+    }
+
+    return result;
 }
 
 static
-void http_sock_set_timeout(
-    ecs_http_socket_t sock,
-    int32_t timeout_ms)
+void http_wake(
+    ecs_http_server_t *srv)
 {
-    int r;
-#ifdef ECS_TARGET_POSIX
-    struct timeval tv;
-    tv.tv_sec = timeout_ms * 1000;
-    tv.tv_usec = 0;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
+#ifndef ECS_TARGET_WINDOWS
+    char v = 0;
+    ssize_t r = write(srv->wake_fds[1], &v, 1);
+    (void)r; /* full pipe already wakes up the server thread */
 #else
-    DWORD t = (DWORD)timeout_ms;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&t, sizeof t);
+    (void)srv;
 #endif
-    if (r) {
-        ecs_warn("http: failed to set socket timeout: %s", 
-            ecs_os_strerror(errno));
-    }
 }
 
 static
-void http_sock_keep_alive(
-    ecs_http_socket_t sock)
+void http_wake_clear(
+    ecs_http_server_t *srv)
 {
-    int v = 1;
-    if (setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (const char*)&v, sizeof v)) {
-        ecs_warn("http: failed to set socket KEEPALIVE: %s",
-            ecs_os_strerror(errno));
-    }
+#ifndef ECS_TARGET_WINDOWS
+    char buf[64];
+    while (read(srv->wake_fds[0], buf, sizeof(buf)) > 0) { }
+#else
+    (void)srv;
+#endif
 }
 
+#endif
+
 static
-int http_getnameinfo(
-    const struct sockaddr* addr,
-    ecs_size_t addr_len,
-    char *host,
-    ecs_size_t host_len,
-    char *port,
-    ecs_size_t port_len,
-    int flags)
+ecs_http_send_t* http_send_new(
+    uint64_t conn_id,
+    bool close)
 {
-    ecs_assert(addr_len > 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(host_len > 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(port_len > 0, ECS_INTERNAL_ERROR, NULL);
-    return getnameinfo(addr, (uint32_t)addr_len, host, (uint32_t)host_len, 
-        port, (uint32_t)port_len, flags);
+    ecs_http_send_t *send = ecs_os_calloc_t(ecs_http_send_t);
+    send->conn_id = conn_id;
+    send->close = close;
+    ecs_vec_init_t(NULL, &send->bufs, ecs_http_send_buf_t, 4);
+    return send;
 }
 
 static
-int http_bind(
-    ecs_http_socket_t sock,
-    const struct sockaddr* addr,
-    ecs_size_t addr_len)
+void http_send_free(
+    ecs_http_send_t *send)
 {
-    ecs_assert(addr_len > 0, ECS_INTERNAL_ERROR, NULL);
-    return bind(sock, addr, (uint32_t)addr_len);
+    int32_t i, count = ecs_vec_count(&send->bufs);
+    ecs_http_send_buf_t *bufs = ecs_vec_first(&send->bufs);
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(bufs[i].alloc);
+    }
+    ecs_vec_fini_t(NULL, &send->bufs, ecs_http_send_buf_t);
+    ecs_os_free(send);
 }
 
 static
-bool http_socket_is_valid(
-    ecs_http_socket_t sock)
+void http_send_append(
+    ecs_http_send_t *send,
+    const char *ptr,
+    int32_t length,
+    void *alloc)
 {
-#if defined(ECS_TARGET_WINDOWS)
-    return sock != INVALID_SOCKET;
-#else
-    return sock >= 0;
-#endif
-}
+    if (!length) {
+        ecs_os_free(alloc);
+        return;
+    }
 
-#if defined(ECS_TARGET_WINDOWS)
-#define HTTP_SOCKET_INVALID INVALID_SOCKET
-#else
-#define HTTP_SOCKET_INVALID (-1)
-#endif
+    ecs_http_send_buf_t *buf = ecs_vec_append_t(
+        NULL, &send->bufs, ecs_http_send_buf_t);
+    buf->ptr = ptr;
+    buf->length = length;
+    buf->alloc = alloc;
+}
 
 static
-void http_close(
-    ecs_http_socket_t *sock)
+void http_send_append_copy(
+    ecs_http_send_t *send,
+    const char *ptr,
+    int32_t length)
 {
-    ecs_assert(sock != NULL, ECS_INTERNAL_ERROR, NULL);
-#if defined(ECS_TARGET_WINDOWS)
-    closesocket(*sock);
-#else
-    ecs_dbg_2("http: closing socket %u", *sock);
-    shutdown(*sock, SHUT_RDWR);
-    close(*sock);
-#endif
-    *sock = HTTP_SOCKET_INVALID;
+    if (length) {
+        char *copy = ecs_os_malloc(length);
+        ecs_os_memcpy(copy, ptr, length);
+        http_send_append(send, copy, length, copy);
+    }
 }
 
+/* Move strbuf chunks to reply. Only the element that is inlined in the strbuf
+ * and strings the strbuf doesn't own (appended with a _const function) are
+ * copied, other chunks are sent as is. */
 static
-ecs_http_socket_t http_accept(
-    ecs_http_socket_t sock,
-    struct sockaddr* addr,
-    ecs_size_t *addr_len)
+void http_send_append_strbuf(
+    ecs_http_send_t *send,
+    ecs_strbuf_t *b)
 {
-    socklen_t len = (socklen_t)addr_len[0];
-    ecs_http_socket_t result = accept(sock, addr, &len);
-    addr_len[0] = (ecs_size_t)len;
-    return result;
+    if (!b->elementCount) {
+        return;
+    }
+
+    if (b->buf) {
+        /* Application provided buffer */
+        http_send_append_copy(send, b->buf, ecs_strbuf_written(b));
+    } else {
+        ecs_strbuf_element *e = &b->firstElement.super, *next;
+        http_send_append_copy(send, e->buf, e->pos);
+
+        for (e = e->next; e; e = next) {
+            next = e->next;
+            if (e->buffer_embedded) {
+                http_send_append(send, e->buf, e->pos, e);
+            } else {
+                char *alloc_str = ((ecs_strbuf_element_str*)e)->alloc_str;
+                if (alloc_str) {
+                    http_send_append(send, e->buf, e->pos, alloc_str);
+                } else {
+                    http_send_append_copy(send, e->buf, e->pos);
+                }
+                ecs_os_free(e);
+            }
+        }
+    }
+
+    *b = ECS_STRBUF_INIT;
 }
 
-static 
+static
 void http_reply_free(ecs_http_reply_t* response) {
     ecs_assert(response != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_os_free(response->body.content);
@@ -37169,26 +42927,47 @@ void http_reply_free(ecs_http_reply_t* response) {
 static
 void http_request_free(ecs_http_request_impl_t *req) {
     ecs_assert(req != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(req->pub.conn != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(req->pub.conn->server != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(req->pub.conn->id == req->conn_id, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(req->pub.conn == &req->conn, ECS_INTERNAL_ERROR, NULL);
     ecs_os_free(req->res);
-    flecs_sparse_remove_t(&req->pub.conn->server->requests, 
-        ecs_http_request_impl_t, req->pub.id);
+    ecs_os_free(req);
 }
 
 static
-void http_connection_free(ecs_http_connection_impl_t *conn) {
+void http_connection_close(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
     ecs_assert(conn != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(conn->pub.id != 0, ECS_INTERNAL_ERROR, NULL);
-    uint64_t conn_id = conn->pub.id;
 
+    ecs_dbg_2("http: closing connection '%s:%s' (sock = %d)",
+        conn->pub.host, conn->pub.port, conn->sock);
+
+    /* Closing the socket also removes it from the poll set */
     if (http_socket_is_valid(conn->sock)) {
         http_close(&conn->sock);
     }
 
-    flecs_sparse_remove_t(&conn->pub.server->connections, 
-        ecs_http_connection_impl_t, conn_id);
+    ecs_strbuf_reset(&conn->frag.buf);
+    ecs_vec_fini_t(NULL, &conn->pending, char);
+    if (conn->send) {
+        http_send_free(conn->send);
+    }
+
+    flecs_sparse_remove_t(&srv->connections,
+        ecs_http_connection_impl_t, conn->pub.id);
+}
+
+static
+void http_connection_poll(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int32_t events)
+{
+    if (conn->events != events) {
+        http_poll_mod(srv, conn->sock, conn->pub.id, events);
+        conn->events = events;
+    }
 }
 
 // https://stackoverflow.com/questions/10156409/convert-hex-string-char-to-int
@@ -37217,6 +42996,13 @@ void http_decode_url_str(
     dst[0] = '\0';
 }
 
+static
+char http_tolower(
+    char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? (char)(ch - 'A' + 'a') : ch;
+}
+
 static
 void http_parse_method(
     ecs_http_fragment_t *frag)
@@ -37264,59 +43050,11 @@ void http_header_buf_append(
     }
 }
 
+/* Parses request data, returns the number of bytes that were consumed. Parsing
+ * stops when the request is complete, so that data of a next request on the
+ * same connection isn't consumed. */
 static
-void http_enqueue_request(
-    ecs_http_connection_impl_t *conn,
-    uint64_t conn_id,
-    ecs_http_fragment_t *frag)
-{
-    ecs_http_server_t *srv = conn->pub.server;
-
-    ecs_os_mutex_lock(srv->lock);
-    bool is_alive = conn->pub.id == conn_id;
-
-    if (!is_alive || frag->invalid) { 
-        /* Don't enqueue invalid requests or requests for purged connections */
-        ecs_strbuf_reset(&frag->buf);
-    } else {
-        char *res = ecs_strbuf_get(&frag->buf);
-        if (res) {
-            ecs_http_request_impl_t *req = flecs_sparse_add_t(
-                &srv->requests, ecs_http_request_impl_t);
-            req->pub.id = flecs_sparse_last_id(&srv->requests);
-            req->conn_id = conn->pub.id;
-
-            req->pub.conn = (ecs_http_connection_t*)conn;
-            req->pub.method = frag->method;
-            req->pub.path = res + 1;
-            if (frag->body_offset) {
-                req->pub.body = &res[frag->body_offset];
-            }
-            int32_t i, count = frag->header_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.headers[i].key = &res[frag->header_offsets[i]];
-                req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
-            }
-            count = frag->param_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.params[i].key = &res[frag->param_offsets[i]];
-                req->pub.params[i].value = &res[frag->param_value_offsets[i]];
-                http_decode_url_str((char*)req->pub.params[i].value);
-            }
-
-            req->pub.header_count = frag->header_count;
-            req->pub.param_count = frag->param_count;
-            req->res = res;
-
-            ecs_os_linc(&ecs_http_request_received_count);
-        }
-    }
-
-    ecs_os_mutex_unlock(srv->lock);
-}
-
-static
-bool http_parse_request(
+ecs_size_t http_parse_request(
     ecs_http_fragment_t *frag,
     const char* req_frag, 
     ecs_size_t req_frag_len) 
@@ -37344,6 +43082,7 @@ bool http_parse_request(
             if (c == ' ') {
                 frag->state = HttpFragStateVersion;
                 ecs_strbuf_appendch(&frag->buf, '\0');
+                http_header_buf_reset(frag);
             } else {
                 if (c == '?' || c == '=' || c == '&') {
                     ecs_strbuf_appendch(&frag->buf, '\0');
@@ -37361,7 +43100,12 @@ bool http_parse_request(
             break;
         case HttpFragStateVersion:
             if (c == '\r') {
+                /* HTTP/1.0 connections are closed after the reply */
+                http_header_buf_append(frag, '\0');
+                frag->close = !ecs_os_strcmp(frag->header_buf, "HTTP/1.0");
                 frag->state = HttpFragStateCR;
+            } else {
+                http_header_buf_append(frag, c);
             } /* version is not stored */
             break;
         case HttpFragStateHeaderStart:
@@ -37377,7 +43121,9 @@ bool http_parse_request(
                 frag->state = HttpFragStateHeaderValueStart;
                 http_header_buf_append(frag, '\0');
                 frag->parse_content_length = !ecs_os_strcmp(
-                    frag->header_buf, "Content-Length");
+                    frag->header_buf, "content-length");
+                frag->parse_connection = !ecs_os_strcmp(
+                    frag->header_buf, "connection");
 
                 if (http_header_writable(frag)) {
                     ecs_strbuf_appendch(&frag->buf, '\0');
@@ -37387,7 +43133,8 @@ bool http_parse_request(
             } else if (c == '\r') {
                 frag->state = HttpFragStateCR;
             } else  {
-                http_header_buf_append(frag, c);
+                /* Header names are case insensitive */
+                http_header_buf_append(frag, http_tolower(c));
                 if (http_header_writable(frag)) {
                     ecs_strbuf_appendch(&frag->buf, c);
                 }
@@ -37405,13 +43152,22 @@ bool http_parse_request(
                 if (frag->parse_content_length) {
                     http_header_buf_append(frag, '\0');
                     int32_t len = atoi(frag->header_buf);
-                    if (len < 0) {
+                    if (len < 0 || len > ECS_HTTP_REQUEST_LEN_MAX) {
                         frag->invalid = true;
                     } else {
                         frag->content_length = len;
                     }
                     frag->parse_content_length = false;
                 }
+                if (frag->parse_connection) {
+                    http_header_buf_append(frag, '\0');
+                    if (strstr(frag->header_buf, "close")) {
+                        frag->close = true;
+                    } else if (strstr(frag->header_buf, "keep-alive")) {
+                        frag->close = false;
+                    }
+                    frag->parse_connection = false;
+                }
                 if (http_header_writable(frag)) {
                     int32_t cur = ecs_strbuf_written(&frag->buf);
                     if (frag->header_offsets[frag->header_count] < cur &&
@@ -37425,6 +43181,8 @@ bool http_parse_request(
             } else {
                 if (frag->parse_content_length) {
                     http_header_buf_append(frag, c);
+                } else if (frag->parse_connection) {
+                    http_header_buf_append(frag, http_tolower(c));
                 }
                 if (http_header_writable(frag)) {
                     ecs_strbuf_appendch(&frag->buf, c);
@@ -37448,7 +43206,7 @@ bool http_parse_request(
             break;
         case HttpFragStateCRLFCR:
             if (c == '\n') {
-                if (frag->content_length != 0) {
+                if (frag->content_length != 0 && !frag->invalid) {
                     frag->body_offset = ecs_strbuf_written(&frag->buf);
                     frag->state = HttpFragStateBody;
                 } else {
@@ -37470,105 +43228,13 @@ bool http_parse_request(
         case HttpFragStateDone:
             break;
         }
-    }
-
-    if (frag->state == HttpFragStateDone) {
-        return true;
-    } else {
-        return false;
-    }
-}
-
-static
-ecs_http_send_request_t* http_send_queue_post(
-    ecs_http_server_t *srv)
-{
-    /* This function should only be called while the server is locked. Before 
-     * the lock is released, the returned element should be populated. */
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    ecs_assert(sq->count <= ECS_HTTP_SEND_QUEUE_MAX, ECS_INTERNAL_ERROR, NULL);
-    if (sq->count == ECS_HTTP_SEND_QUEUE_MAX) {
-        return NULL;
-    }
-
-    /* Don't enqueue new requests if server is shutting down */
-    if (!srv->should_run) {
-        return NULL;
-    }
-
-    /* Return element at end of the queue */
-    return &sq->requests[(sq->cur + sq->count ++) % ECS_HTTP_SEND_QUEUE_MAX];
-}
-
-static
-ecs_http_send_request_t* http_send_queue_get(
-    ecs_http_server_t *srv)
-{
-    ecs_http_send_request_t *result = NULL;
-    ecs_os_mutex_lock(srv->lock);
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    if (sq->count) {
-        result = &sq->requests[sq->cur];
-        sq->cur = (sq->cur + 1) % ECS_HTTP_SEND_QUEUE_MAX;
-        sq->count --;
-    }
-    return result;
-}
-
-static
-void* http_server_send_queue(void* arg) {
-    ecs_http_server_t *srv = arg;
-    int32_t wait_ms = srv->send_queue.wait_ms;
-
-    /* Run for as long as the server is running or there are messages. When the
-     * server is stopping, no new messages will be enqueued */
-    while (srv->should_run || srv->send_queue.count) {
-        ecs_http_send_request_t* r = http_send_queue_get(srv);
-        if (!r) {
-            ecs_os_mutex_unlock(srv->lock);
-            /* If the queue is empty, wait so we don't run too fast */
-            if (srv->should_run) {
-                ecs_os_sleep(0, wait_ms);
-            }
-        } else {
-            ecs_http_socket_t sock = r->sock;
-            char *headers = r->headers;
-            int32_t headers_length = r->header_length;
-            char *content = r->content;
-            int32_t content_length = r->content_length;
-            ecs_os_mutex_unlock(srv->lock);
-
-            if (http_socket_is_valid(sock)) {
-                bool error = false;
-
-                /* Write headers */
-                ecs_size_t written = http_send(sock, headers, headers_length, 0);
-                if (written != headers_length) {
-                    ecs_err("http: failed to write HTTP response headers: %s",
-                        ecs_os_strerror(errno));
-                    ecs_os_linc(&ecs_http_send_error_count);
-                    error = true;
-                } else if (content_length >= 0) {
-                    /* Write content */
-                    written = http_send(sock, content, content_length, 0);
-                    if (written != content_length) {
-                        ecs_err("http: failed to write HTTP response body: %s",
-                            ecs_os_strerror(errno));
-                        ecs_os_linc(&ecs_http_send_error_count);
-                        error = true;
-                    }
-                }
-                if (!error) {
-                    ecs_os_linc(&ecs_http_send_ok_count);
-                }
-                http_close(&sock);
-            }
 
-            ecs_os_free(content);
-            ecs_os_free(headers);
+        if (frag->state == HttpFragStateDone) {
+            return i + 1;
         }
     }
-    return NULL;
+
+    return req_frag_len;
 }
 
 static
@@ -37579,6 +43245,7 @@ void http_append_send_headers(
     const char* content_type,  
     ecs_strbuf_t *extra_headers,
     ecs_size_t content_len,
+    bool close,
     bool preflight)
 {
     ecs_strbuf_appendlit(hdrs, "HTTP/1.1 ");
@@ -37593,10 +43260,14 @@ void http_append_send_headers(
         ecs_strbuf_appendlit(hdrs, "\r\n");
     }
 
-    if (content_len >= 0) {
-        ecs_strbuf_appendlit(hdrs, "Content-Length: ");
-        ecs_strbuf_append(hdrs, "%d", content_len);
-        ecs_strbuf_appendlit(hdrs, "\r\n");
+    /* Always send the length, keep-alive clients rely on it to find the end
+     * of the reply */
+    ecs_strbuf_appendlit(hdrs, "Content-Length: ");
+    ecs_strbuf_append(hdrs, "%d", content_len);
+    ecs_strbuf_appendlit(hdrs, "\r\n");
+
+    if (close) {
+        ecs_strbuf_appendlit(hdrs, "Connection: close\r\n");
     }
 
     ecs_strbuf_appendlit(hdrs, "Access-Control-Allow-Origin: *\r\n");
@@ -37614,107 +43285,289 @@ void http_append_send_headers(
 }
 
 static
-void http_send_reply(
-    ecs_http_connection_impl_t* conn, 
-    ecs_http_reply_t* reply,
-    bool preflight) 
+ecs_http_send_t* http_send_from_reply(
+    uint64_t conn_id,
+    ecs_http_reply_t *reply,
+    bool close,
+    bool preflight)
 {
+    ecs_http_send_t *send = http_send_new(conn_id, close);
     ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
-    char *content = ecs_strbuf_get(&reply->body);
-    int32_t content_length = reply->body.length - 1;
+    http_append_send_headers(&hdrs, reply->code, reply->status, 
+        reply->content_type, &reply->headers, 
+        ecs_strbuf_written(&reply->body), close, preflight);
+    http_send_append_strbuf(send, &hdrs);
+    http_send_append_strbuf(send, &reply->body);
+    return send;
+}
+
+/* Reply from the server thread, for requests that aren't passed to the main
+ * thread. The reply is sent when the socket is writable. */
+static
+void http_connection_reply(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int code,
+    const char *status,
+    bool close,
+    bool preflight)
+{
+    ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
+    reply.code = code;
+    reply.status = status;
+    reply.content_type = NULL;
 
-    /* Use asynchronous send queue for outgoing data so send operations won't
-     * hold up main thread */
-    ecs_http_send_request_t *req = NULL;
+    conn->send = http_send_from_reply(conn->pub.id, &reply, close, preflight);
+    conn->state = HttpConnWriting;
+    http_connection_poll(srv, conn, HTTP_POLL_OUT);
+}
+
+static
+ecs_http_request_impl_t* http_request_new(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    ecs_http_fragment_t *frag)
+{
+    char *res = ecs_strbuf_get(&frag->buf);
+    if (!res) {
+        return NULL;
+    }
+
+    ecs_http_request_impl_t *req = ecs_os_calloc_t(ecs_http_request_impl_t);
+    req->pub.id = ++ srv->request_id;
+    req->conn = conn->pub;
+    req->close = frag->close;
+
+    req->pub.conn = &req->conn;
+    req->pub.method = frag->method;
+    req->pub.path = res + 1;
+    if (frag->body_offset) {
+        req->pub.body = &res[frag->body_offset];
+    }
+    int32_t i, count = frag->header_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.headers[i].key = &res[frag->header_offsets[i]];
+        req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
+    }
+    count = frag->param_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.params[i].key = &res[frag->param_offsets[i]];
+        req->pub.params[i].value = &res[frag->param_value_offsets[i]];
+        http_decode_url_str((char*)req->pub.params[i].value);
+    }
 
-    if (!preflight) {
-        req = http_send_queue_post(conn->pub.server);
+    req->pub.header_count = frag->header_count;
+    req->pub.param_count = frag->param_count;
+    req->res = res;
+
+    return req;
+}
+
+/* Handle a completely received request */
+static
+void http_connection_request(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    ecs_http_fragment_t *frag = &conn->frag;
+    frag->state = HttpFragStateBegin;
+
+    if (frag->invalid) {
+        ecs_strbuf_reset(&frag->buf);
+        ecs_os_linc(&ecs_http_request_invalid_count);
+        http_connection_reply(srv, conn, 400, "Bad Request", true, false);
+    } else if (frag->method == EcsHttpOptions) {
+        ecs_strbuf_reset(&frag->buf);
+        ecs_os_linc(&ecs_http_request_preflight_count);
+        http_connection_reply(srv, conn, 200, "OK", frag->close, true);
+    } else if (srv->inflight == ECS_HTTP_QUEUE_SIZE) {
+        /* Main thread isn't keeping up */
+        ecs_strbuf_reset(&frag->buf);
+        ecs_os_linc(&ecs_http_busy_count);
+        http_connection_reply(srv, conn, 503, "Service Unavailable", 
+            frag->close, false);
+    } else {
+        ecs_http_request_impl_t *req = http_request_new(srv, conn, frag);
         if (!req) {
-            reply->code = 503; /* queue full, server is busy */
-            ecs_os_linc(&ecs_http_busy_count);
+            ecs_os_linc(&ecs_http_request_invalid_count);
+            http_connection_reply(srv, conn, 400, "Bad Request", true, false);
+            return;
         }
+
+        bool pushed = http_queue_push(&srv->requests, req);
+        ecs_assert(pushed, ECS_INTERNAL_ERROR, NULL);
+        (void)pushed;
+        srv->inflight ++;
+        conn->state = HttpConnWaiting;
+        http_connection_poll(srv, conn, HTTP_POLL_IN);
+        ecs_os_linc(&ecs_http_request_received_count);
+
+        ecs_dbg_2("http: request received from '%s:%s'", 
+            conn->pub.host, conn->pub.port);
+    }
+}
+
+/* Parse received data, returns true if a request was completed. Data received
+ * after the request is kept until the connection is done with the reply. */
+static
+bool http_connection_parse(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    const char *data,
+    ecs_size_t size)
+{
+    ecs_size_t parsed = http_parse_request(&conn->frag, data, size);
+    if (conn->frag.state != HttpFragStateDone) {
+        ecs_assert(parsed == size, ECS_INTERNAL_ERROR, NULL);
+        return false;
     }
 
-    http_append_send_headers(&hdrs, reply->code, reply->status, 
-        reply->content_type, &reply->headers, content_length, preflight);
-    char *headers = ecs_strbuf_get(&hdrs);
-    ecs_size_t headers_length = ecs_strbuf_written(&hdrs);
+    if (parsed < size) {
+        char *dst = ecs_vec_grow_t(NULL, &conn->pending, char, size - parsed);
+        ecs_os_memcpy(dst, &data[parsed], size - parsed);
+    }
 
-    if (!req) {
-        ecs_size_t written = http_send(conn->sock, headers, headers_length, 0);
-        if (written != headers_length) {
-            ecs_err("http: failed to send reply to '%s:%s': %s",
-                conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
-            ecs_os_linc(&ecs_http_send_error_count);
+    http_connection_request(srv, conn);
+    return true;
+}
+
+/* Start on the next request of a keep-alive connection */
+static
+void http_connection_resume(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    conn->state = HttpConnReading;
+    conn->last_active = srv->now;
+
+    if (ecs_vec_count(&conn->pending)) {
+        ecs_vec_t pending = conn->pending;
+        ecs_vec_init_t(NULL, &conn->pending, char, 0);
+        bool done = http_connection_parse(srv, conn, 
+            ecs_vec_first(&pending), ecs_vec_count(&pending));
+        ecs_vec_fini_t(NULL, &pending, char);
+        if (done) {
+            return;
         }
-        ecs_os_free(content);
-        ecs_os_free(headers);
-        http_close(&conn->sock);
-        return;
     }
 
-    /* Second, enqueue send request for response body */
-    req->sock = conn->sock;
-    req->headers = headers;
-    req->header_length = headers_length;
-    req->content = content;
-    req->content_length = content_length;
-
-    /* Take ownership of values */
-    reply->body.content = NULL;
-    conn->sock = HTTP_SOCKET_INVALID;
+    http_connection_poll(srv, conn, HTTP_POLL_IN);
 }
 
 static
-void http_recv_request(
+void http_connection_recv(
     ecs_http_server_t *srv,
-    ecs_http_connection_impl_t *conn, 
-    uint64_t conn_id,
-    ecs_http_socket_t sock)
+    ecs_http_connection_impl_t *conn)
 {
-    ecs_size_t bytes_read;
     char recv_buf[ECS_HTTP_SEND_RECV_BUFFER_SIZE];
-    ecs_http_fragment_t frag = {0};
 
-    while ((bytes_read = http_recv(
-        sock, recv_buf, ECS_SIZEOF(recv_buf), 0)) > 0) 
-    {
-        bool is_alive = conn->pub.id == conn_id;
-        if (!is_alive) {
-            /* Connection has been purged by main thread */
+    for (;;) {
+        ecs_size_t bytes_read = http_recv(
+            conn->sock, recv_buf, ECS_SIZEOF(recv_buf), 0);
+        if (bytes_read <= 0) {
+            if (bytes_read < 0 && http_would_block()) {
+                return;
+            }
+
+            /* Connection closed by remote, or error */
+            http_connection_close(srv, conn);
             return;
         }
 
-        if (http_parse_request(&frag, recv_buf, bytes_read)) {
-            if (frag.method == EcsHttpOptions) {
-                ecs_http_reply_t reply;
-                reply.body = ECS_STRBUF_INIT;
-                reply.code = 200;
-                reply.content_type = NULL;
-                reply.headers = ECS_STRBUF_INIT;
-                reply.status = "OK";
-                http_send_reply(conn, &reply, true);
-                ecs_os_linc(&ecs_http_request_preflight_count);
-            } else {
-                http_enqueue_request(conn, conn_id, &frag);
-            }
+        conn->last_active = srv->now;
+
+        if (http_connection_parse(srv, conn, recv_buf, bytes_read)) {
             return;
-        } else {
-            ecs_os_linc(&ecs_http_request_invalid_count);
         }
+
+        if (bytes_read < ECS_SIZEOF(recv_buf)) {
+            /* Socket is drained, poll notifies when there's more */
+            return;
+        }
+    }
+}
+
+/* Send (remainder of) reply, returns false if the connection was closed */
+static
+bool http_connection_send(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    ecs_http_send_t *send = conn->send;
+    ecs_http_send_buf_t *bufs = ecs_vec_first(&send->bufs);
+    int32_t count = ecs_vec_count(&send->bufs);
+
+    while (send->cur < count) {
+        ecs_size_t written = http_sendv(
+            conn->sock, &bufs[send->cur], count - send->cur, send->offset);
+        if (written < 0) {
+            if (http_would_block()) {
+                http_connection_poll(srv, conn, HTTP_POLL_OUT);
+                return true;
+            }
+
+            ecs_dbg("http: failed to send reply to '%s:%s': %s",
+                conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
+            ecs_os_linc(&ecs_http_send_error_count);
+            http_connection_close(srv, conn);
+            return false;
+        }
+
+        conn->last_active = srv->now;
+
+        /* Skip buffers that were completely sent */
+        written += send->offset;
+        while (send->cur < count && written >= bufs[send->cur].length) {
+            written -= bufs[send->cur].length;
+            send->cur ++;
+        }
+        send->offset = written;
+    }
+
+    ecs_os_linc(&ecs_http_send_ok_count);
+    ecs_dbg_2("http: reply sent to '%s:%s'", conn->pub.host, conn->pub.port);
+
+    bool close = send->close;
+    http_send_free(send);
+    conn->send = NULL;
+
+    if (close) {
+        http_connection_close(srv, conn);
+        return false;
     }
 
-    /* Partial request received, cleanup resources */
-    ecs_strbuf_reset(&frag.buf);
+    http_connection_resume(srv, conn);
+    return true;
+}
 
-    /* No request was enqueued, flag connection so it'll get purged */
-    ecs_os_mutex_lock(srv->lock);
-    if (conn->pub.id == conn_id) {
-        /* Only flag connection if it was still alive */
-        conn->dequeue_timeout = ECS_HTTP_CONNECTION_PURGE_TIMEOUT;
-        conn->dequeue_retries = ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT;
+static
+void http_connection_event(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int32_t events)
+{
+    switch(conn->state) {
+    case HttpConnReading:
+        if (events & (HTTP_POLL_IN | HTTP_POLL_ERR)) {
+            http_connection_recv(srv, conn);
+        }
+        break;
+    case HttpConnWriting:
+        if (events & (HTTP_POLL_OUT | HTTP_POLL_ERR)) {
+            http_connection_send(srv, conn);
+        }
+        break;
+    case HttpConnWaiting:
+        if (events & HTTP_POLL_ERR) {
+            /* Reply is dropped when it arrives */
+            http_connection_close(srv, conn);
+        } else {
+            /* Client sent the next request before getting the reply. Don't
+             * read it until the reply is sent. */
+            http_connection_poll(srv, conn, 0);
+        }
+        break;
     }
-    ecs_os_mutex_unlock(srv->lock);
 }
 
 static
@@ -37724,17 +43577,20 @@ void http_init_connection(
     struct sockaddr_storage *remote_addr, 
     ecs_size_t remote_addr_len) 
 {
-    http_sock_set_timeout(sock_conn, 100);
+    http_sock_nonblock(sock_conn);
+    http_sock_nodelay(sock_conn);
     http_sock_keep_alive(sock_conn);
 
     /* Create new connection */
-    ecs_os_mutex_lock(srv->lock);
     ecs_http_connection_impl_t *conn = flecs_sparse_add_t(
         &srv->connections, ecs_http_connection_impl_t);
-    uint64_t conn_id = conn->pub.id = flecs_sparse_last_id(&srv->connections);
+    ecs_os_zeromem(conn);
+    conn->pub.id = flecs_sparse_last_id(&srv->connections);
     conn->pub.server = srv;
     conn->sock = sock_conn;
-    ecs_os_mutex_unlock(srv->lock);
+    conn->state = HttpConnReading;
+    conn->last_active = srv->now;
+    ecs_vec_init_t(NULL, &conn->pending, char, 0);
 
     char *remote_host = conn->pub.host;
     char *remote_port = conn->pub.port;
@@ -37749,17 +43605,95 @@ void http_init_connection(
         ecs_os_strcpy(remote_port, "unknown");
     }
 
+    if (http_poll_add(srv, sock_conn, conn->pub.id, HTTP_POLL_IN)) {
+        http_connection_close(srv, conn);
+        return;
+    }
+    conn->events = HTTP_POLL_IN;
+
     ecs_dbg_2("http: connection established from '%s:%s' (socket %u)", 
         remote_host, remote_port, sock_conn);
+}
+
+static
+void http_accept_connections(
+    ecs_http_server_t* srv)
+{
+    ecs_http_socket_t sock_conn;
+    struct sockaddr_storage remote_addr;
+    ecs_size_t remote_addr_len;
 
-    http_recv_request(srv, conn, conn_id, sock_conn);
+    for (;;) {
+        remote_addr_len = ECS_SIZEOF(remote_addr);
+        sock_conn = http_accept(srv->sock, (struct sockaddr*) &remote_addr, 
+            &remote_addr_len);
+
+        if (!http_socket_is_valid(sock_conn)) {
+            if (!http_would_block()) {
+                ecs_dbg("http: connection attempt failed: %s", 
+                    ecs_os_strerror(errno));
+            }
+            return;
+        }
 
-    ecs_dbg_2("http: request received from '%s:%s'", 
-        remote_host, remote_port);
+        http_init_connection(srv, sock_conn, &remote_addr, remote_addr_len);
+    }
 }
 
+/* Hand replies from the main thread to their connections */
 static
-void http_accept_connections(
+void http_recv_replies(
+    ecs_http_server_t *srv)
+{
+    ecs_http_send_t *send;
+    while ((send = http_queue_pop(&srv->replies))) {
+        srv->inflight --;
+
+        ecs_http_connection_impl_t *conn = flecs_sparse_try_t(
+            &srv->connections, ecs_http_connection_impl_t, send->conn_id);
+        if (!conn || conn->state != HttpConnWaiting) {
+            /* Connection was closed while the request was handled */
+            http_send_free(send);
+            continue;
+        }
+
+        conn->send = send;
+        conn->state = HttpConnWriting;
+        http_connection_send(srv, conn);
+    }
+}
+
+static
+void http_purge_connections(
+    ecs_http_server_t *srv)
+{
+    if ((srv->now - srv->purge_time) < ECS_HTTP_CONNECTION_PURGE_INTERVAL) {
+        return;
+    }
+
+    srv->purge_time = srv->now;
+
+    int32_t i, count = flecs_sparse_count(&srv->connections);
+    for (i = count - 1; i >= 1; i --) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense_t(
+            &srv->connections, ecs_http_connection_impl_t, i);
+
+        /* Don't time out connections that are waiting for the main thread. The
+         * main thread could be stalled (loading, debugger). */
+        if (conn->state == HttpConnWaiting) {
+            continue;
+        }
+
+        if ((srv->now - conn->last_active) > ECS_HTTP_CONNECTION_IDLE_TIMEOUT) {
+            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
+                conn->pub.host, conn->pub.port, conn->sock);
+            http_connection_close(srv, conn);
+        }
+    }
+}
+
+static
+int http_listen(
     ecs_http_server_t* srv, 
     const struct sockaddr* addr, 
     ecs_size_t addr_len) 
@@ -37773,7 +43707,7 @@ void http_accept_connections(
         if (result) {
             ecs_warn("http: WSAStartup failed with GetLastError = %d\n", 
                 GetLastError());
-            return;
+            return -1;
         }
     } else {
         http_close(&testsocket);
@@ -37784,7 +43718,6 @@ void http_accept_connections(
     char addr_host[256];
     char addr_port[20];
 
-    ecs_http_socket_t sock = HTTP_SOCKET_INVALID;
     ecs_assert(srv->sock == HTTP_SOCKET_INVALID, ECS_INTERNAL_ERROR, NULL);
 
     if (http_getnameinfo(
@@ -37795,90 +43728,59 @@ void http_accept_connections(
         ecs_os_strcpy(addr_port, "unknown");
     }
 
-    ecs_os_mutex_lock(srv->lock);
-    if (srv->should_run) {
-        ecs_dbg_2("http: initializing connection socket");
-
-        sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
-        if (!http_socket_is_valid(sock)) {
-            ecs_err("http: unable to create new connection socket: %s", 
-                ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
-        }
-
-        int reuse = 1;
-        int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
-            (char*)&reuse, ECS_SIZEOF(reuse)); 
-        if (result) {
-            ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
-        }
-
-        if (addr->sa_family == AF_INET6) {
-            int ipv6only = 0;
-            if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
-                (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
-            {
-                ecs_warn("http: failed to setsockopt: %s", 
-                    ecs_os_strerror(errno));
-            }
-        }
-
-        result = http_bind(sock, addr, addr_len);
-        if (result) {
-            ecs_err("http: failed to bind to '%s:%s': %s", 
-                addr_host, addr_port, ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
-        }
+    ecs_dbg_2("http: initializing connection socket");
 
-        http_sock_set_timeout(sock, 1000);
+    ecs_http_socket_t sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (!http_socket_is_valid(sock)) {
+        ecs_err("http: unable to create new connection socket: %s", 
+            ecs_os_strerror(errno));
+        return -1;
+    }
 
-        srv->sock = sock;
+    int reuse = 1;
+    int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
+        (char*)&reuse, ECS_SIZEOF(reuse)); 
+    if (result) {
+        ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
+    }
 
-        result = listen(srv->sock, SOMAXCONN);
-        if (result) {
-            ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
-                SOMAXCONN, ecs_os_strerror(errno));
+    if (addr->sa_family == AF_INET6) {
+        int ipv6only = 0;
+        if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
+            (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
+        {
+            ecs_warn("http: failed to setsockopt: %s", 
+                ecs_os_strerror(errno));
         }
-
-        ecs_trace("http: listening for incoming connections on '%s:%s'",
-            addr_host, addr_port);
-    } else {
-        ecs_dbg_2("http: server shut down while initializing");
     }
-    ecs_os_mutex_unlock(srv->lock);
 
-    ecs_http_socket_t sock_conn;
-    struct sockaddr_storage remote_addr;
-    ecs_size_t remote_addr_len;
-
-    while (srv->should_run) {
-        remote_addr_len = ECS_SIZEOF(remote_addr);
-        sock_conn = http_accept(srv->sock, (struct sockaddr*) &remote_addr, 
-            &remote_addr_len);
+    result = http_bind(sock, addr, addr_len);
+    if (result) {
+        ecs_err("http: failed to bind to '%s:%s': %s", 
+            addr_host, addr_port, ecs_os_strerror(errno));
+        http_close(&sock);
+        return -1;
+    }
 
-        if (!http_socket_is_valid(sock_conn)) {
-            if (srv->should_run) {
-                ecs_dbg("http: connection attempt failed: %s", 
-                    ecs_os_strerror(errno));
-            }
-            continue;
-        }
+    http_sock_nonblock(sock);
 
-        http_init_connection(srv, sock_conn, &remote_addr, remote_addr_len);
+    result = listen(sock, SOMAXCONN);
+    if (result) {
+        ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
+            SOMAXCONN, ecs_os_strerror(errno));
     }
 
-done:
-    ecs_os_mutex_lock(srv->lock);
-    if (http_socket_is_valid(sock) && errno != EBADF) {
+    if (http_poll_add(srv, sock, HTTP_POLL_ID_LISTEN, HTTP_POLL_IN)) {
         http_close(&sock);
-        srv->sock = sock;
+        return -1;
     }
-    ecs_os_mutex_unlock(srv->lock);
 
-    ecs_trace("http: no longer accepting connections on '%s:%s'",
+    srv->sock = sock;
+
+    ecs_trace("http: listening for incoming connections on '%s:%s'",
         addr_host, addr_port);
+
+    return 0;
 }
 
 static
@@ -37895,7 +43797,48 @@ void* http_server_thread(void* arg) {
         inet_pton(AF_INET, srv->ipaddr, &(addr.sin_addr));
     }
 
-    http_accept_connections(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr));
+    if (http_listen(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr))) {
+        return NULL;
+    }
+
+    ecs_http_poll_event_t events[ECS_HTTP_POLL_EVENTS_MAX];
+    srv->now = srv->purge_time = http_time_now();
+
+    while (srv->should_run) {
+        int32_t i, count = http_poll_wait(srv, events, ECS_HTTP_POLL_TIMEOUT);
+        srv->now = http_time_now();
+
+        for (i = 0; i < count; i ++) {
+            uint64_t id = events[i].id;
+            if (id == HTTP_POLL_ID_LISTEN) {
+                http_accept_connections(srv);
+            } else if (id == HTTP_POLL_ID_WAKE) {
+                http_wake_clear(srv);
+            } else {
+                /* Connection may have been closed by an earlier event */
+                ecs_http_connection_impl_t *conn = flecs_sparse_try_t(
+                    &srv->connections, ecs_http_connection_impl_t, id);
+                if (conn) {
+                    http_connection_event(srv, conn, events[i].events);
+                }
+            }
+        }
+
+        http_recv_replies(srv);
+        http_purge_connections(srv);
+    }
+
+    /* Close all connections */
+    int32_t i, count = flecs_sparse_count(&srv->connections);
+    for (i = count - 1; i >= 1; i --) {
+        http_connection_close(srv, flecs_sparse_get_dense_t(
+            &srv->connections, ecs_http_connection_impl_t, i));
+    }
+
+    http_close(&srv->sock);
+
+    ecs_trace("http: no longer accepting connections");
+
     return NULL;
 }
 
@@ -37905,68 +43848,60 @@ void http_handle_request(
     ecs_http_request_impl_t *req)
 {
     ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
-    ecs_http_connection_impl_t *conn = 
-        (ecs_http_connection_impl_t*)req->pub.conn;
-
-    if (req->pub.method != EcsHttpOptions) {
-        if (srv->callback((ecs_http_request_t*)req, &reply, srv->ctx) == false) {
-            reply.code = 404;
-            reply.status = "Resource not found";
-            ecs_os_linc(&ecs_http_request_not_handled_count);
-        } else {
-            if (reply.code >= 400) {
-                ecs_os_linc(&ecs_http_request_handled_error_count);
-            } else {
-                ecs_os_linc(&ecs_http_request_handled_ok_count);
-            }
-        }
 
-        http_send_reply(conn, &reply, false);
-        ecs_dbg_2("http: reply sent to '%s:%s'", conn->pub.host, conn->pub.port);
+    if (srv->callback((ecs_http_request_t*)req, &reply, srv->ctx) == false) {
+        reply.code = 404;
+        reply.status = "Resource not found";
+        ecs_os_linc(&ecs_http_request_not_handled_count);
     } else {
-        /* Already taken care of */
+        if (reply.code >= 400) {
+            ecs_os_linc(&ecs_http_request_handled_error_count);
+        } else {
+            ecs_os_linc(&ecs_http_request_handled_ok_count);
+        }
     }
 
+    /* The server thread has reserved a slot for the reply when it passed the
+     * request, so the queue can't be full */
+    ecs_http_send_t *send = http_send_from_reply(
+        req->conn.id, &reply, req->close, false);
+    bool pushed = http_queue_push(&srv->replies, send);
+    ecs_assert(pushed, ECS_INTERNAL_ERROR, NULL);
+    (void)pushed;
+
     http_reply_free(&reply);
     http_request_free(req);
-    http_connection_free(conn);
 }
 
 static
 int32_t http_dequeue_requests(
     ecs_http_server_t *srv,
-    double delta_time)
+    double *time_spent)
 {
-    ecs_os_mutex_lock(srv->lock);
-
-    int32_t i, request_count = flecs_sparse_count(&srv->requests);
-    for (i = request_count - 1; i >= 1; i --) {
-        ecs_http_request_impl_t *req = flecs_sparse_get_dense_t(
-            &srv->requests, ecs_http_request_impl_t, i);
-        http_handle_request(srv, req);
+    ecs_http_request_impl_t *req = http_queue_pop(&srv->requests);
+    if (!req) {
+        return 0;
     }
 
-    int32_t connections_count = flecs_sparse_count(&srv->connections);
-    for (i = connections_count - 1; i >= 1; i --) {
-        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense_t(
-            &srv->connections, ecs_http_connection_impl_t, i);
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
 
-        conn->dequeue_timeout += delta_time;
-        conn->dequeue_retries ++;
-        
-        if ((conn->dequeue_timeout > 
-            (double)ECS_HTTP_CONNECTION_PURGE_TIMEOUT) &&
-             (conn->dequeue_retries > ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT)) 
-        {
-            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
-                conn->pub.host, conn->pub.port, conn->sock);
-            http_connection_free(conn);
-        }
-    }
+    /* Limit requests per dequeue so the cost per frame stays bounded. Requests
+     * that remain are handled by the next dequeue. */
+    int32_t count = 0;
+    double elapsed = 0;
+    do {
+        http_handle_request(srv, req);
+        elapsed += ecs_time_measure(&t);
+        count ++;
+    } while (count < ECS_HTTP_DEQUEUE_MAX && 
+        elapsed < ECS_HTTP_DEQUEUE_BUDGET &&
+        (req = http_queue_pop(&srv->requests)));
 
-    ecs_os_mutex_unlock(srv->lock);
+    http_wake(srv);
 
-    return request_count - 1;
+    *time_spent = elapsed;
+    return count;
 }
 
 const char* ecs_http_get_header(
@@ -38000,7 +43935,6 @@ ecs_http_server_t* ecs_http_server_init(
         "missing OS API implementation");
 
     ecs_http_server_t* srv = ecs_os_calloc_t(ecs_http_server_t);
-    srv->lock = ecs_os_mutex_new();
     srv->sock = HTTP_SOCKET_INVALID;
 
     srv->should_run = false;
@@ -38010,17 +43944,11 @@ ecs_http_server_t* ecs_http_server_init(
     srv->ctx = desc->ctx;
     srv->port = desc->port;
     srv->ipaddr = desc->ipaddr;
-    srv->send_queue.wait_ms = desc->send_queue_wait_ms;
-    if (!srv->send_queue.wait_ms) {
-        srv->send_queue.wait_ms = 100 * 1000 * 1000;
-    }
 
     flecs_sparse_init_t(&srv->connections, NULL, NULL, ecs_http_connection_impl_t);
-    flecs_sparse_init_t(&srv->requests, NULL, NULL, ecs_http_request_impl_t);
 
     /* Start at id 1 */
     flecs_sparse_new_id(&srv->connections);
-    flecs_sparse_new_id(&srv->requests);
 
 #ifndef ECS_TARGET_WINDOWS
     /* Ignore pipe signal. SIGPIPE can occur when a message is sent to a client
@@ -38039,9 +43967,7 @@ void ecs_http_server_fini(
     if (srv->should_run) {
         ecs_http_server_stop(srv);
     }
-    ecs_os_mutex_free(srv->lock);
     flecs_sparse_fini(&srv->connections);
-    flecs_sparse_fini(&srv->requests);
     ecs_os_free(srv);
 }
 
@@ -38053,17 +43979,18 @@ int ecs_http_server_start(
     ecs_check(!srv->should_run, ECS_INVALID_PARAMETER, NULL);
     ecs_check(!srv->thread, ECS_INVALID_PARAMETER, NULL);
 
+    if (http_poll_init(srv)) {
+        goto error;
+    }
+
     srv->should_run = true;
 
     ecs_dbg("http: starting server thread");
 
     srv->thread = ecs_os_thread_new(http_server_thread, srv);
     if (!srv->thread) {
-        goto error;
-    }
-
-    srv->send_queue.thread = ecs_os_thread_new(http_server_send_queue, srv);
-    if (!srv->send_queue.thread) {
+        srv->should_run = false;
+        http_poll_fini(srv);
         goto error;
     }
 
@@ -38082,36 +44009,27 @@ void ecs_http_server_stop(
     /* Stop server thread */
     ecs_dbg("http: shutting down server thread");
 
-    ecs_os_mutex_lock(srv->lock);
     srv->should_run = false;
-    if (http_socket_is_valid(srv->sock)) {
-        http_close(&srv->sock);
-    }
-    ecs_os_mutex_unlock(srv->lock);
-
+    http_wake(srv);
     ecs_os_thread_join(srv->thread);
-    ecs_os_thread_join(srv->send_queue.thread);
-    ecs_trace("http: server threads shut down");
+    http_poll_fini(srv);
+    ecs_trace("http: server thread shut down");
 
-    /* Cleanup all outstanding requests */
-    int i, count = flecs_sparse_count(&srv->requests);
-    for (i = count - 1; i >= 1; i --) {
-        http_request_free(flecs_sparse_get_dense_t(
-            &srv->requests, ecs_http_request_impl_t, i));
+    /* Cleanup all outstanding requests and replies */
+    ecs_http_request_impl_t *req;
+    while ((req = http_queue_pop(&srv->requests))) {
+        http_request_free(req);
     }
 
-    /* Close all connections */
-    count = flecs_sparse_count(&srv->connections);
-    for (i = count - 1; i >= 1; i --) {
-        http_connection_free(flecs_sparse_get_dense_t(
-            &srv->connections, ecs_http_connection_impl_t, i));
+    ecs_http_send_t *send;
+    while ((send = http_queue_pop(&srv->replies))) {
+        http_send_free(send);
     }
 
     ecs_assert(flecs_sparse_count(&srv->connections) == 1, 
         ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(flecs_sparse_count(&srv->requests) == 1,
-        ECS_INTERNAL_ERROR, NULL);
 
+    srv->inflight = 0;
     srv->thread = 0;
 error:
     return;
@@ -38125,22 +44043,15 @@ void ecs_http_server_dequeue(
     ecs_check(srv->initialized, ECS_INVALID_PARAMETER, NULL);
     ecs_check(srv->should_run, ECS_INVALID_PARAMETER, NULL);
     
-    srv->dequeue_timeout += (double)delta_time;
     srv->stats_timeout += (double)delta_time;
 
-    if ((1000 * srv->dequeue_timeout) > (double)ECS_HTTP_MIN_DEQUEUE_INTERVAL) {
-        srv->dequeue_timeout = 0;
-
-        ecs_time_t t = {0};
-        ecs_time_measure(&t);
-        int32_t request_count = http_dequeue_requests(srv, srv->dequeue_timeout);
-        srv->requests_processed += request_count;
-        srv->requests_processed_total += request_count;
-        double time_spent = ecs_time_measure(&t);
-        srv->request_time += time_spent;
-        srv->request_time_total += time_spent;
-        srv->dequeue_count ++;
-    }
+    double time_spent = 0;
+    int32_t request_count = http_dequeue_requests(srv, &time_spent);
+    srv->requests_processed += request_count;
+    srv->requests_processed_total += request_count;
+    srv->request_time += time_spent;
+    srv->request_time_total += time_spent;
+    srv->dequeue_count ++;
 
     if ((1000 * srv->stats_timeout) > (double)ECS_HTTP_MIN_STATS_INTERVAL) {
         srv->stats_timeout = 0;
@@ -41021,6 +46932,7 @@ ecs_world_t *ecs_mini(void) {
     flecs_name_index_init(&world->symbols, &world->allocator);
 
     world->info.time_scale = 1.0;
+    world->table_growth_factor = 2;
 
     if (ecs_os_has_time()) {
         ecs_os_get_time(&world->world_start_time);
@@ -41474,6 +47386,11 @@ int ecs_fini(
 
     world->flags |= EcsWorldQuit;
 
+#ifdef FLECS_JOURNAL
+    /* Don't record the cleanup of the world */
+    ecs_journal_close(world);
+#endif
+
     /* Delete root entities first using regular APIs. This ensures that cleanup
      * policies get a chance to execute. */
     ecs_dbg_1("#[bold]cleanup root entities");
@@ -41526,6 +47443,7 @@ int ecs_fini(
     flecs_observable_fini(&world->observable);
     flecs_name_index_fini(&world->aliases);
     flecs_name_index_fini(&world->symbols);
+    flecs_lookup_cache_fini(world);
     ecs_set_stage_count(world, 0);
     ecs_log_pop_1();
 
@@ -41651,6 +47569,17 @@ bool ecs_enable_range_check(
     return old_value;
 }
 
+void ecs_set_table_growth_factor(
+    ecs_world_t *world,
+    int32_t factor)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(factor >= 2, ECS_INVALID_PARAMETER, NULL);
+    world->table_growth_factor = factor;
+error:
+    return;
+}
+
 void ecs_set_entity_generation(
     ecs_world_t *world,
     ecs_entity_t entity_with_generation)
@@ -41927,6 +47856,10 @@ void ecs_frame_end(
         flecs_stage_merge_post_frame(world, &stages[i]);
     }
 
+#ifdef FLECS_JOURNAL
+    ecs_journal_flush(world);
+#endif
+
     flecs_stop_measure_frame(world);
 error:
     return;
@@ -42219,7 +48152,9 @@ int32_t ecs_delete_empty_tables(
             }
 
             uint16_t gen = ++ table->generation;
-            if (delete_generation && (gen > delete_generation)) {
+            if (delete_generation && (gen > delete_generation) && 
+                !table->reserve_count) 
+            {
                 if (flecs_table_release(world, table)) {
                     delete_count ++;
                 }
@@ -45188,7 +51123,12 @@ bool flecs_term_match_table(
             oper = EcsOptional;
         }
 
-        match_table = ecs_get_table(world, src_id);
+        /* Source can already be deleted when tables are created while the
+         * world is cleaning up */
+        match_table = NULL;
+        if (ecs_is_valid(world, src_id)) {
+            match_table = ecs_get_table(world, src_id);
+        }
         if (match_table) {
         } else if (oper != EcsOptional) {
             return false;
@@ -45343,7 +51283,10 @@ bool flecs_filter_match_table(
         }
 
         if (!ecs_term_match_this(term)) {
-            match_table = ecs_get_table(world, src_id);
+            match_table = NULL;
+            if (ecs_is_valid(world, src_id)) {
+                match_table = ecs_get_table(world, src_id);
+            }
         } else {
             if (ECS_BIT_IS_SET(iter_flags, EcsIterIgnoreThis)) {
                 or_result = true;
@@ -49289,6 +55232,111 @@ void flecs_query_sort_table(
     }
 }
 
+/* Key & original row of an entity, used by the radix sort */
+typedef struct flecs_sort_key_t {
+    uint64_t key;
+    int32_t row;
+} flecs_sort_key_t;
+
+/* Stable LSD radix sort on 8 bit digits. Digits that are the same for all keys
+ * are skipped, so 32 bit keys take at most 4 passes. Returns the array that
+ * holds the result, which is either keys or tmp. */
+static
+flecs_sort_key_t* flecs_query_radix_sort(
+    flecs_sort_key_t *keys,
+    flecs_sort_key_t *tmp,
+    int32_t count)
+{
+    int32_t histogram[8][256] = {{0}};
+    uint64_t first = keys[0].key, diff = 0;
+    int32_t i, d;
+    for (i = 0; i < count; i ++) {
+        uint64_t key = keys[i].key;
+        diff |= key ^ first;
+        for (d = 0; d < 8; d ++) {
+            histogram[d][(key >> (d * 8)) & 0xFF] ++;
+        }
+    }
+
+    for (d = 0; d < 8; d ++) {
+        if (!((diff >> (d * 8)) & 0xFF)) {
+            continue; /* All keys have the same digit */
+        }
+
+        int32_t offset = 0, *h = histogram[d];
+        for (i = 0; i < 256; i ++) {
+            int32_t c = h[i];
+            h[i] = offset;
+            offset += c;
+        }
+
+        for (i = 0; i < count; i ++) {
+            tmp[h[(keys[i].key >> (d * 8)) & 0xFF] ++] = keys[i];
+        }
+
+        flecs_sort_key_t *t = keys;
+        keys = tmp;
+        tmp = t;
+    }
+
+    return keys;
+}
+
+/* Sort table by integer key. Keys are extracted once and radix sorted together
+ * with their rows, after which the table is reordered in one pass. */
+static
+void flecs_query_sort_table_by_key(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column_index,
+    ecs_order_by_key_action_t key_of)
+{
+    ecs_data_t *data = &table->data;
+    int32_t count = flecs_table_data_count(data);
+    if (count < 2) {
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vec_first(&data->entities);
+
+    void *ptr = NULL;
+    int32_t size = 0;
+    if (column_index != -1) {
+        ecs_type_info_t *ti = table->type_info[column_index];
+        ecs_vec_t *column = &data->columns[column_index];
+        size = ti->size;
+        ptr = ecs_vec_first(column);
+    }
+
+    flecs_sort_key_t *keys = ecs_os_malloc_n(flecs_sort_key_t, count * 2);
+    bool sorted = true;
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        keys[i].key = key_of(entities[i], ECS_ELEM(ptr, size, i));
+        keys[i].row = i;
+        sorted &= !i || (keys[i - 1].key <= keys[i].key);
+    }
+
+    if (sorted) {
+        /* Common when rows were only added at the end with larger keys, or when
+         * another column in the table changed */
+        ecs_os_free(keys);
+        return;
+    }
+
+    flecs_sort_key_t *result = flecs_query_radix_sort(keys, &keys[count], count);
+
+    /* The buffer that didn't hold the result is free, reuse it for the rows */
+    int32_t *rows = (int32_t*)(result == keys ? &keys[count] : keys);
+    for (i = 0; i < count; i ++) {
+        rows[i] = result[i].row;
+    }
+
+    flecs_table_permute(world, table, rows);
+
+    ecs_os_free(keys);
+}
+
 /* Helper struct for building sorted table ranges */
 typedef struct sort_helper_t {
     ecs_query_table_match_t *match;
@@ -49298,6 +55346,7 @@ typedef struct sort_helper_t {
     int32_t elem_size;
     int32_t count;
     bool shared;
+    uint64_t key; /* Key of current row when ordering by key */
 } sort_helper_t;
 
 static
@@ -49325,6 +55374,107 @@ ecs_entity_t e_from_helper(
     }
 }
 
+/* Compare helpers by the key of their current row. Ties go to the table that
+ * comes first, which matches the order in which order_by merges tables. */
+static
+bool flecs_sort_helper_lt(
+    const sort_helper_t *helper,
+    int32_t h1,
+    int32_t h2)
+{
+    uint64_t k1 = helper[h1].key, k2 = helper[h2].key;
+    return (k1 < k2) || ((k1 == k2) && (h1 < h2));
+}
+
+static
+void flecs_sort_heap_down(
+    const sort_helper_t *helper,
+    int32_t *heap,
+    int32_t count,
+    int32_t i)
+{
+    for (;;) {
+        int32_t l = i * 2 + 1, r = l + 1, min = i;
+        if (l < count && flecs_sort_helper_lt(helper, heap[l], heap[min])) {
+            min = l;
+        }
+        if (r < count && flecs_sort_helper_lt(helper, heap[r], heap[min])) {
+            min = r;
+        }
+        if (min == i) {
+            break;
+        }
+
+        int32_t t = heap[i];
+        heap[i] = heap[min];
+        heap[min] = t;
+        i = min;
+    }
+}
+
+/* Merge tables that are sorted by key using a min heap. Each step emits the 
+ * run of rows from the top table that sorts before the next table as a single
+ * slice, so no comparator is called and tables that don't interleave produce
+ * one slice. */
+static
+void flecs_query_merge_sorted_by_key(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t count)
+{
+    ecs_order_by_key_action_t key_of = query->order_by_key;
+    int32_t *heap = ecs_os_malloc_n(int32_t, count);
+    int32_t i, heap_count = count;
+
+    for (i = 0; i < count; i ++) {
+        sort_helper_t *h = &helper[i];
+        h->key = key_of(e_from_helper(h), ptr_from_helper(h));
+        heap[i] = i;
+    }
+
+    for (i = count / 2 - 1; i >= 0; i --) {
+        flecs_sort_heap_down(helper, heap, count, i);
+    }
+
+    while (heap_count) {
+        int32_t top = heap[0];
+        sort_helper_t *h = &helper[top];
+        int32_t start = h->row;
+
+        /* The table that sorts next is one of the children of the root */
+        int32_t next = -1;
+        if (heap_count > 1) {
+            next = heap[1];
+        }
+        if (heap_count > 2 && flecs_sort_helper_lt(helper, heap[2], next)) {
+            next = heap[2];
+        }
+
+        do {
+            h->row ++;
+            if (h->row == h->count) {
+                break;
+            }
+            h->key = key_of(e_from_helper(h), ptr_from_helper(h));
+        } while (next == -1 || flecs_sort_helper_lt(helper, top, next));
+
+        ecs_query_table_node_t *slice = ecs_vector_add(
+            &query->table_slices, ecs_query_table_node_t);
+        ecs_assert(slice != NULL, ECS_INTERNAL_ERROR, NULL);
+        slice->match = h->match;
+        slice->offset = start;
+        slice->count = h->row - start;
+
+        if (h->row == h->count) {
+            heap[0] = heap[-- heap_count];
+        }
+
+        flecs_sort_heap_down(helper, heap, heap_count, 0);
+    }
+
+    ecs_os_free(heap);
+}
+
 static
 void flecs_query_build_sorted_table_range(
     ecs_query_t *query,
@@ -49392,52 +55542,56 @@ void flecs_query_build_sorted_table_range(
 
     ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
-
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
+    if (query->order_by_key) {
+        flecs_query_merge_sorted_by_key(query, helper, to_sort);
+    } else {
+        bool proceed;
+        do {
+            int32_t j, min = 0;
+            proceed = true;
+
+            ecs_entity_t e1;
+            while (!(e1 = e_from_helper(&helper[min]))) {
+                min ++;
+                if (min == to_sort) {
+                    proceed = false;
+                    break;
+                }
             }
-        }
 
-        if (!proceed) {
-            break;
-        }
-
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
+            if (!proceed) {
+                break;
             }
 
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
+            for (j = min + 1; j < to_sort; j++) {
+                ecs_entity_t e2 = e_from_helper(&helper[j]);
+                if (!e2) {
+                    continue;
+                }
+
+                const void *ptr1 = ptr_from_helper(&helper[min]);
+                const void *ptr2 = ptr_from_helper(&helper[j]);
 
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
-                e1 = e_from_helper(&helper[min]);
+                if (compare(e1, ptr1, e2, ptr2) > 0) {
+                    min = j;
+                    e1 = e_from_helper(&helper[min]);
+                }
             }
-        }
 
-        sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->match != cur_helper->match) {
-            cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
-            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
-            cur->match = cur_helper->match;
-            cur->offset = cur_helper->row;
-            cur->count = 1;
-        } else {
-            cur->count ++;
-        }
+            sort_helper_t *cur_helper = &helper[min];
+            if (!cur || cur->match != cur_helper->match) {
+                cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
+                ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
+                cur->match = cur_helper->match;
+                cur->offset = cur_helper->row;
+                cur->count = 1;
+            } else {
+                cur->count ++;
+            }
 
-        cur_helper->row ++;
-    } while (proceed);
+            cur_helper->row ++;
+        } while (proceed);
+    }
 
     /* Iterate through the vector of slices to set the prev/next ptrs. This
      * can't be done while building the vector, as reallocs may occur */
@@ -49492,7 +55646,8 @@ void flecs_query_sort_tables(
     ecs_query_t *query)
 {
     ecs_order_by_action_t compare = query->order_by;
-    if (!compare) {
+    ecs_order_by_key_action_t key_of = query->order_by_key;
+    if (!compare && !key_of) {
         return;
     }
 
@@ -49564,7 +55719,11 @@ void flecs_query_sort_tables(
         }
 
         /* Something has changed, sort the table. Prefers using flecs_query_sort_table when available */
-        flecs_query_sort_table(world, table, column, compare, sort);
+        if (key_of) {
+            flecs_query_sort_table_by_key(world, table, column, key_of);
+        } else {
+            flecs_query_sort_table(world, table, column, compare, sort);
+        }
         tables_sorted = true;
     }
 
@@ -49982,6 +56141,7 @@ void flecs_query_order_by(
     ecs_query_t *query,
     ecs_entity_t order_by_component,
     ecs_order_by_action_t order_by,
+    ecs_order_by_key_action_t order_by_key,
     ecs_sort_table_action_t action)
 {
     ecs_check(query != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -49989,6 +56149,7 @@ void flecs_query_order_by(
 
     query->order_by_component = order_by_component;
     query->order_by = order_by;
+    query->order_by_key = order_by_key;
     query->sort_table = action;
 
     ecs_vector_free(query->table_slices);
@@ -50299,10 +56460,10 @@ ecs_query_t* ecs_query_init(
         result->parent = desc->parent;
     }
 
-    if (desc->order_by) {
+    if (desc->order_by || desc->order_by_key) {
         flecs_query_order_by(
             world, result, desc->order_by_component, desc->order_by,
-            desc->sort_table);
+            desc->order_by_key, desc->sort_table);
     }
 
     if (!ecs_query_table_count(result) && result->filter.term_count) {
@@ -50376,7 +56537,9 @@ ecs_iter_t ecs_query_iter(
         .last = NULL
     };
 
-    if (query->order_by && query->list.info.table_count) {
+    if ((query->order_by || query->order_by_key) && 
+        query->list.info.table_count) 
+    {
         it.node = ecs_vector_first(query->table_slices, ecs_query_table_node_t);
     }
 
@@ -53641,6 +59804,10 @@ void ecs_on_set(EcsIdentifier)(ecs_iter_t *it) {
     ecs_id_t pair = ecs_childof(0);
     ecs_hashmap_t *index = NULL;
 
+    if (kind != EcsSymbol) {
+        flecs_lookup_cache_invalidate(world);
+    }
+
     if (kind == EcsSymbol) {
         index = &world->symbols;
     } else if (kind == EcsAlias) {
@@ -54028,6 +60195,9 @@ void flecs_on_parent_change(ecs_iter_t *it) {
     ecs_world_t *world = it->world;
     ecs_table_t *other_table = it->other_table, *table = it->table;
 
+    /* Paths of children change too, also when the entity has no name */
+    flecs_lookup_cache_invalidate(it->real_world);
+
     EcsIdentifier *names = ecs_table_get_pair(it->real_world, 
         table, EcsIdentifier, EcsName, it->offset);
     bool has_name = names != NULL;
@@ -54779,6 +60949,184 @@ void flecs_on_set_symbol(ecs_iter_t *it) {
     }
 }
 
+/* Key of the lookup cache. A lookup is cached with all the arguments that
+ * determine its result, so that repeated lookups of the same path are resolved
+ * with a single hash probe. The cache owns the strings of the keys it stores. */
+typedef struct {
+    ecs_hashed_string_t path;
+    const char *sep;
+    const char *prefix;
+    ecs_entity_t parent;        /* Parent, or scope if no parent was provided */
+    uint64_t lookup_path;       /* Hash of lookup path for recursive lookups */
+    uint64_t hash;
+    bool recursive;
+} ecs_lookup_key_t;
+
+static
+uint64_t flecs_lookup_key_hash(
+    const void *ptr)
+{
+    const ecs_lookup_key_t *key = ptr;
+    return key->hash;
+}
+
+static
+int flecs_lookup_key_strcmp(
+    const char *str1,
+    const char *str2)
+{
+    if (str1 == str2) {
+        return 0;
+    }
+    if (!str1 || !str2) {
+        return (str1 != NULL) - (str2 != NULL);
+    }
+    return ecs_os_strcmp(str1, str2);
+}
+
+static
+int flecs_lookup_key_compare(
+    const void *ptr1,
+    const void *ptr2)
+{
+    const ecs_lookup_key_t *key1 = ptr1;
+    const ecs_lookup_key_t *key2 = ptr2;
+    if (key1->parent != key2->parent) {
+        return (key1->parent > key2->parent) - (key1->parent < key2->parent);
+    }
+    if (key1->recursive != key2->recursive) {
+        return key1->recursive - key2->recursive;
+    }
+    if (key1->lookup_path != key2->lookup_path) {
+        return (key1->lookup_path > key2->lookup_path) - 
+            (key1->lookup_path < key2->lookup_path);
+    }
+
+    ecs_size_t len1 = key1->path.length, len2 = key2->path.length;
+    if (len1 != len2) {
+        return (len1 > len2) - (len1 < len2);
+    }
+
+    int result = ecs_os_memcmp(key1->path.value, key2->path.value, len1);
+    if (result) {
+        return result;
+    }
+
+    result = flecs_lookup_key_strcmp(key1->sep, key2->sep);
+    if (result) {
+        return result;
+    }
+
+    return flecs_lookup_key_strcmp(key1->prefix, key2->prefix);
+}
+
+static
+void flecs_lookup_key_init(
+    const ecs_world_t *stage,
+    ecs_lookup_key_t *key,
+    ecs_entity_t parent,
+    const char *path,
+    const char *sep,
+    const char *prefix,
+    bool recursive)
+{
+    key->path = flecs_get_hashed_string(path, 0, 0);
+    key->sep = sep;
+    key->prefix = prefix;
+    key->parent = parent ? parent : ecs_get_scope(stage);
+    key->lookup_path = 0;
+    key->recursive = recursive;
+
+    /* The lookup path can be modified without calling ecs_set_lookup_path, so
+     * its contents are part of the key */
+    const ecs_entity_t *lookup_path = ecs_get_lookup_path(stage);
+    if (recursive && lookup_path) {
+        int32_t count = 0;
+        while (lookup_path[count]) {
+            count ++;
+        }
+        key->lookup_path = flecs_hash(lookup_path, 
+            count * ECS_SIZEOF(ecs_entity_t));
+    }
+
+    uint64_t h[4] = { key->path.hash, key->parent, key->lookup_path,
+        ((uint64_t)recursive << 16) | ((uint64_t)(sep ? sep[0] : 0) << 8) |
+            (uint64_t)(prefix ? prefix[0] : 0) };
+    key->hash = flecs_hash(h, ECS_SIZEOF(h));
+}
+
+static
+void flecs_lookup_cache_clear(
+    ecs_world_t *world)
+{
+    flecs_hashmap_iter_t it = flecs_hashmap_iter(&world->lookup_cache);
+    ecs_lookup_key_t *key;
+    while (_flecs_hashmap_next(&it, ECS_SIZEOF(ecs_lookup_key_t), 
+        &key, ECS_SIZEOF(ecs_entity_t))) 
+    {
+        ecs_os_free(key->path.value);
+        ecs_os_free((char*)key->sep);
+        ecs_os_free((char*)key->prefix);
+    }
+
+    flecs_hashmap_fini(&world->lookup_cache);
+    flecs_hashmap_init(&world->lookup_cache, ecs_lookup_key_t, ecs_entity_t,
+        flecs_lookup_key_hash, flecs_lookup_key_compare, &world->allocator);
+    world->lookup_cache_dirty = false;
+}
+
+static
+ecs_entity_t flecs_lookup_cache_get(
+    const ecs_world_t *world,
+    const ecs_lookup_key_t *key)
+{
+    ecs_entity_t *e = flecs_hashmap_get(
+        &world->lookup_cache, key, ecs_entity_t);
+    if (e && ecs_is_alive(world, *e)) {
+        return *e;
+    }
+    return 0;
+}
+
+static
+void flecs_lookup_cache_set(
+    ecs_world_t *world,
+    const ecs_lookup_key_t *key,
+    ecs_entity_t e)
+{
+    flecs_hashmap_result_t r = flecs_hashmap_ensure(
+        &world->lookup_cache, key, ecs_entity_t);
+    ecs_entity_t *value = r.value;
+    if (!value[0]) {
+        /* New entry, intern the strings of the key */
+        ecs_lookup_key_t *elem = r.key;
+        elem->path.value = ecs_os_memdup(key->path.value, key->path.length + 1);
+        elem->sep = key->sep ? ecs_os_strdup(key->sep) : NULL;
+        elem->prefix = key->prefix ? ecs_os_strdup(key->prefix) : NULL;
+    }
+    value[0] = e;
+}
+
+void flecs_lookup_cache_invalidate(
+    ecs_world_t *world)
+{
+    /* The cache is cleared by the next lookup, so that a burst of renames or
+     * reparents doesn't clear it more than once */
+    if (world->flags & EcsWorldLookupCache) {
+        world->lookup_cache_dirty = true;
+    }
+}
+
+void flecs_lookup_cache_fini(
+    ecs_world_t *world)
+{
+    if (world->flags & EcsWorldLookupCache) {
+        flecs_lookup_cache_clear(world);
+        flecs_hashmap_fini(&world->lookup_cache);
+        world->flags &= ~EcsWorldLookupCache;
+    }
+}
+
 void flecs_bootstrap_hierarchy(ecs_world_t *world) {
     ecs_observer_init(world, &(ecs_observer_desc_t){
         .entity = ecs_entity(world, {.add = {ecs_childof(EcsFlecsInternals)}}),
@@ -54948,6 +61296,41 @@ ecs_entity_t ecs_lookup_path_w_sep(
         return e;
     }
 
+    if (!sep) {
+        sep = ".";
+    }
+
+    /* Don't write to the cache while the world is readonly, as lookups may
+     * then run on multiple threads */
+    ecs_lookup_key_t key;
+    bool cache = (world->flags & EcsWorldLookupCache) && sep[0];
+    bool cache_write = cache && !(world->flags & EcsWorldReadonly);
+    if (cache) {
+        if (world->lookup_cache_dirty) {
+            if (cache_write) {
+                flecs_lookup_cache_clear((ecs_world_t*)world);
+            } else {
+                cache = false;
+            }
+        }
+    }
+
+    if (cache) {
+        flecs_lookup_key_init(stage, &key, parent, path, sep, prefix, recursive);
+        e = flecs_lookup_cache_get(world, &key);
+        if (cache_write) {
+            ecs_world_t *w = (ecs_world_t*)world;
+            if (e) {
+                w->info.lookup_cache_hit_total ++;
+            } else {
+                w->info.lookup_cache_miss_total ++;
+            }
+        }
+        if (e) {
+            return e;
+        }
+    }
+
     e = flecs_name_index_find(&world->aliases, path, 0, 0);
     if (e) {
         return e;
@@ -54966,10 +61349,6 @@ ecs_entity_t ecs_lookup_path_w_sep(
         lookup_path_cur ++;
     }
 
-    if (!sep) {
-        sep = ".";
-    }
-
     parent = flecs_get_parent_from_path(stage, parent, &path, prefix, true);
 
     if (!sep[0]) {
@@ -55026,11 +61405,33 @@ tail:
         ecs_os_free(elem);
     }
 
+    if (cur && cache_write) {
+        flecs_lookup_cache_set((ecs_world_t*)world, &key, cur);
+    }
+
     return cur;
 error:
     return 0;
 }
 
+bool ecs_enable_lookup_cache(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    bool old_value = (world->flags & EcsWorldLookupCache) != 0;
+    if (enable && !old_value) {
+        flecs_hashmap_init(&world->lookup_cache, ecs_lookup_key_t, 
+            ecs_entity_t, flecs_lookup_key_hash, flecs_lookup_key_compare,
+            &world->allocator);
+        world->lookup_cache_dirty = false;
+        world->flags |= EcsWorldLookupCache;
+    } else if (!enable && old_value) {
+        flecs_lookup_cache_fini(world);
+    }
+    return old_value;
+}
+
 ecs_entity_t ecs_set_scope(
     ecs_world_t *world,
     ecs_entity_t scope)
@@ -161,6 +161,7 @@
 #define FLECS_LOG           /**< When enabled ECS provides more detailed logs */
 #define FLECS_APP           /**< Application addon */
 #define FLECS_OS_API_IMPL   /**< Default implementation for OS API */
+#define FLECS_OS_ALLOC      /**< Thread caching allocator for OS API (opt in) */
 #define FLECS_HTTP          /**< Tiny HTTP server for connecting to remote UI */
 #define FLECS_REST          /**< REST API for querying application data */
 // #define FLECS_JOURNAL    /**< Journaling addon (disabled by default) */
@@ -372,6 +373,12 @@ typedef int (*ecs_order_by_action_t)(
     ecs_entity_t e2,
     const void *ptr2);
 
+/** Callback that returns an integer key used for ordering components. Entities
+ * are ordered by ascending key. */
+typedef uint64_t (*ecs_order_by_key_action_t)(
+    ecs_entity_t e,
+    const void *ptr);
+
 /** Callback used for sorting the entire table of components */
 typedef void (*ecs_sort_table_action_t)(
     ecs_world_t* world,
@@ -821,6 +828,14 @@ typedef struct ecs_query_desc_t {
      * but more efficient. */
     ecs_sort_table_action_t sort_table;
 
+    /** Callback that returns an integer key for ordering query results. When
+     * set, results are ordered by ascending key and order_by is ignored. Tables
+     * are sorted with a radix sort, and the sorted tables are merged without
+     * calling a comparator, which is faster than order_by for large numbers of 
+     * entities. Signed keys must be mapped to unsigned keys that preserve
+     * their order (for example by flipping the sign bit). */
+    ecs_order_by_key_action_t order_by_key;
+
     /** Id to be used by group_by. This id is passed to the group_by function and
      * can be used identify the part of an entity type that should be used for
      * grouping. */
@@ -950,7 +965,10 @@ typedef struct ecs_world_info_t {
     int64_t id_delete_total;          /**< Total number of times an id was deleted */
     int64_t table_create_total;       /**< Total number of times a table was created */
     int64_t table_delete_total;       /**< Total number of times a table was deleted */
+    int64_t table_realloc_total;      /**< Total number of times table storage was resized */
     int64_t pipeline_build_count_total; /**< Total number of pipeline builds */
+    int64_t lookup_cache_hit_total;   /**< Total number of lookups resolved by the lookup cache */
+    int64_t lookup_cache_miss_total;  /**< Total number of lookups not in the lookup cache */
     int64_t systems_ran_frame;        /**< Total number of systems ran in last frame */
     int64_t observers_ran_frame;      /**< Total number of times observer was invoked */
 
@@ -1841,6 +1859,23 @@ bool ecs_enable_range_check(
     ecs_world_t *world,
     bool enable);
 
+/** Set the growth factor for table storage.
+ * When a table runs out of space for new entities, its storage is resized to
+ * its current size multiplied by this factor. Storage sizes are rounded up to a
+ * power of two. A larger factor means fewer reallocations for tables that grow
+ * quickly, at the cost of more unused memory. The default is 2.
+ *
+ * To prevent reallocations altogether for a table with a known upper bound,
+ * use ecs_table_reserve.
+ *
+ * @param world The world.
+ * @param factor The growth factor (must be at least 2).
+ */
+FLECS_API
+void ecs_set_table_growth_factor(
+    ecs_world_t *world,
+    int32_t factor);
+
 /** Force aperiodic actions.
  * The world may delay certain operations until they are necessary for the
  * application to function correctly. This may cause observable side effects
@@ -2983,6 +3018,23 @@ ecs_entity_t ecs_lookup_path_w_sep(
     const char *prefix,
     bool recursive);
 
+/** Enable/disable the lookup cache.
+ * When enabled, the results of ecs_lookup_path_w_sep are cached by path, scope
+ * and lookup arguments, so that looking up the same path again takes a single
+ * hash probe instead of resolving each element of the path. The cache is
+ * invalidated when an entity name, alias or parent changes.
+ *
+ * While the world is readonly lookups use the cache, but don't add to it.
+ *
+ * @param world The world.
+ * @param enable True to enable the cache, false to disable and free it.
+ * @return The previous value.
+ */
+FLECS_API
+bool ecs_enable_lookup_cache(
+    ecs_world_t *world,
+    bool enable);
+
 /** Lookup an entity by its symbol name.
  * This looks up an entity by symbol stored in (EcsIdentifier, EcsSymbol). The
  * operation does not take into account hierarchies.
@@ -4736,6 +4788,49 @@ ecs_table_t* ecs_table_remove_id(
     ecs_table_t *table,
     ecs_id_t id);
 
+/** Reserve storage in a table.
+ * This operation resizes the storage of a table so that it can hold at least
+ * count entities without reallocating. The reservation sticks to the table:
+ * ecs_delete_empty_tables will neither delete the table nor shrink its storage
+ * below the reserved size. This makes it possible to preallocate tables for
+ * entities that are frequently created and deleted, like projectiles.
+ *
+ * Reserving less than the current reservation has no effect.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param count The number of entities to reserve storage for.
+ */
+FLECS_API
+void ecs_table_reserve(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count);
+
+/** Return the number of times the storage of a table was resized.
+ * This counts storage resizes caused by adding entities to a full table, by
+ * ecs_table_reserve and by shrinking empty tables.
+ *
+ * @param table The table.
+ * @return The number of times the table storage was resized.
+ */
+FLECS_API
+int32_t ecs_table_get_realloc_count(
+    const ecs_table_t *table);
+
+/** Return the number of bytes allocated for table storage.
+ * This adds up the entity, record and component columns of all tables in the
+ * world, including unused capacity. Table headers, graph edges and the id
+ * index are not included. The function visits every table, so it is meant
+ * for memory reports rather than for calling every frame.
+ *
+ * @param world The world (or stage).
+ * @return The bytes allocated for the storage of all tables.
+ */
+FLECS_API
+int64_t ecs_get_table_storage_bytes(
+    const ecs_world_t *world);
+
 /** Lock or unlock table.
  * When a table is locked, modifications to it will throw an assert. When the 
  * table is locked recursively, it will take an equal amount of unlock
@@ -94,6 +94,7 @@ struct each_invoker;
 #include "pair.hpp"
 #include "lifecycle_traits.hpp"
 #include "ref.hpp"
+#include "lookup_cache.hpp"
 #include "world.hpp"
 #include "iter.hpp"
 #include "entity.hpp"
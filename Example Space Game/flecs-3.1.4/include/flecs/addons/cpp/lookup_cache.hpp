@@ -0,0 +1,63 @@
+/**
+ * @file addons/cpp/lookup_cache.hpp
+ * @brief Handle to the lookup cache of a world.
+ */
+
+#pragma once
+
+namespace flecs
+{
+
+/**
+ * @defgroup cpp_lookup_cache Lookup cache
+ * @brief Cache that resolves repeated lookups by path with a single hash probe.
+ * 
+ * \ingroup cpp_core
+ * @{
+ */
+
+/** Lookup cache.
+ * Handle to the lookup cache of a world. While the cache is enabled, repeated
+ * lookups by path (world::lookup, entity_view::lookup, world::entity with a
+ * name) are resolved from the cache. The cache is invalidated when an entity
+ * name or parent changes.
+ */
+struct lookup_cache {
+    lookup_cache(world_t *world)
+    {
+        // the world we were called with may be a stage; convert it to a world
+        // here if that is the case
+        m_world = const_cast<flecs::world_t *>(ecs_get_world(world));
+    }
+
+    /** Enable or disable the cache.
+     *
+     * @param enabled True to enable the cache, false to disable and free it.
+     * @return True if the cache was enabled before the call.
+     */
+    bool enable(bool enabled = true) const {
+        return ecs_enable_lookup_cache(m_world, enabled);
+    }
+
+    /** Disable and free the cache. */
+    bool disable() const {
+        return enable(false);
+    }
+
+    /** Number of lookups resolved from the cache. */
+    int64_t hit_count() const {
+        return ecs_get_world_info(m_world)->lookup_cache_hit_total;
+    }
+
+    /** Number of lookups that weren't in the cache. */
+    int64_t miss_count() const {
+        return ecs_get_world_info(m_world)->lookup_cache_miss_total;
+    }
+
+private:
+    world_t *m_world;
+};
+
+/** @} */
+
+}
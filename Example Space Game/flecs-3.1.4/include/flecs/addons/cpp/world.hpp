@@ -530,6 +530,14 @@ struct world {
      */
     flecs::entity lookup(const char *name) const;
 
+    /** Get handle to the lookup cache.
+     * 
+     * @see ecs_enable_lookup_cache
+     */
+    flecs::lookup_cache lookup_cache() const {
+        return flecs::lookup_cache(m_world);
+    }
+
     /** Set singleton component.
      */
     template <typename T, if_t< !is_callable<T>::value > = 0>
@@ -7,7 +7,9 @@
  * Flecs application (for example, with a web-based UI) and request/visualize
  * data from the ECS world.
  * 
- * Each server instance creates a single thread used for receiving requests.
+ * Each server instance creates a single thread that receives requests and sends
+ * replies on non-blocking sockets. Connections are kept alive between requests
+ * unless the client asks to close them.
  * Receiving requests are enqueued and handled when the application calls
  * ecs_http_server_dequeue. This increases latency of request handling vs.
  * responding directly in the receive thread, but is better suited for 
@@ -125,7 +127,7 @@ typedef struct {
     void *ctx;                        /**< Passed to callback (optional) */
     uint16_t port;                    /**< HTTP port */
     const char *ipaddr;               /**< Interface to listen on (optional) */
-    int32_t send_queue_wait_ms;       /**< Send queue wait time when empty */
+    int32_t send_queue_wait_ms;       /**< Unused, replies are sent by the server thread */
 } ecs_http_server_desc_t;
 
 /** Create server. 
@@ -158,8 +160,10 @@ int ecs_http_server_start(
     ecs_http_server_t* server);
 
 /** Process server requests. 
- * This operation invokes the reply callback for each received request. No new
- * requests will be enqueued while processing requests.
+ * This operation invokes the reply callback for received requests. To keep the
+ * cost per call bounded, a single call handles a limited number of requests
+ * and stops when it exceeds a small time budget. Remaining requests are handled
+ * by the next call.
  * 
  * @param server The server for which to process requests.
  */
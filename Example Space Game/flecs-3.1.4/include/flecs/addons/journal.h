@@ -8,6 +8,11 @@
  * 
  * The journaling addon is disabled by default. Enabling it can have a 
  * significant impact on performance.
+ *
+ * The addon can also write a binary journal, which records operations and
+ * component values in a ring file without formatting them. A
+ * binary journal can be replayed on another world, which turns a recorded
+ * session into a reproducible workload.
  */
 
 #ifdef FLECS_JOURNAL
@@ -57,10 +62,105 @@ void flecs_journal_begin(
 FLECS_DBG_API
 void flecs_journal_end(void);
 
+FLECS_DBG_API
+void flecs_journal_set(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/* Record the values of an id for count rows of a table, starting at row */
+FLECS_DBG_API
+void flecs_journal_set_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    ecs_id_t id);
+
 #define flecs_journal(...)\
     flecs_journal_begin(__VA_ARGS__);\
     flecs_journal_end();
 
+/* Binary journal API */
+
+/** Default size of the ring in a binary journal file */
+#define ECS_JOURNAL_DEFAULT_SIZE (64 * 1024 * 1024)
+
+/** Binary journal statistics (use ecs_journal_replay) */
+typedef struct ecs_journal_replay_t {
+    int64_t record_count;      /**< Records in the journal */
+    int64_t op_count;          /**< Replayed operations */
+    int64_t skip_count;        /**< Operations that could not be replayed */
+    ecs_ftime_t time_spent;    /**< Time spent replaying, excluding loading */
+} ecs_journal_replay_t;
+
+/** Start writing a binary journal.
+ * Operations that change the world are appended to a ring: moves between 
+ * tables with the added and removed ids, component values, names, clear, 
+ * delete, delete_with and remove_all. When the ring is full the oldest records
+ * are overwritten. Records are buffered and written to the file at the end of
+ * each frame, when 1 MB is waiting and when the journal is closed.
+ *
+ * Recording is not free. Each entity that is committed, set or deleted costs
+ * about 30ns, and a spawned entity with a few components adds about 50 bytes
+ * to the file. In the JournalReplay benchmark, which spawns and deletes 1000
+ * to 10000 bullets per frame, the frame time goes up by 15 to 20%. Workloads
+ * that mostly change few entities per frame pay less.
+ *
+ * Only operations on the world are recorded, deferred operations are recorded
+ * when they are merged. Values written directly to component arrays, as
+ * systems do, are only recorded when ecs_modified is called. Values of
+ * components with a copy hook (other than names) are not recorded, as they
+ * can't be restored from their bytes.
+ *
+ * @param world The world.
+ * @param filename The journal file, truncated if it exists.
+ * @param size Size of the ring in bytes (0 = ECS_JOURNAL_DEFAULT_SIZE).
+ * @return Zero if success, non-zero if the file could not be created.
+ */
+FLECS_API
+int ecs_journal_open(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_size_t size);
+
+/** Write the records of the binary journal to its file.
+ * This is done automatically at the end of each frame. Use it to make sure the
+ * file is complete before reading it while the journal is still open.
+ *
+ * @param world The world.
+ * @return Zero if success (or no journal is open), non-zero if writing failed.
+ */
+FLECS_API
+int ecs_journal_flush(
+    ecs_world_t *world);
+
+/** Stop writing the binary journal.
+ * This is done automatically when the world is deleted.
+ *
+ * @param world The world.
+ */
+FLECS_API
+void ecs_journal_close(
+    ecs_world_t *world);
+
+/** Replay a binary journal.
+ * Entities in the journal are mapped to new entities. Named entities and
+ * components are looked up by path, components that don't exist are created
+ * with the recorded size. The world should not have the observers and systems
+ * of the recording world, as operations done by them are in the journal.
+ *
+ * @param world The world to replay the journal on.
+ * @param filename The journal file.
+ * @param result Out parameter for replay statistics (optional).
+ * @return Zero if success, non-zero if the file is not a valid journal.
+ */
+FLECS_API
+int ecs_journal_replay(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_journal_replay_t *result);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -68,6 +168,8 @@ void flecs_journal_end(void);
 #else
 #define flecs_journal_begin(...)
 #define flecs_journal_end(...)
+#define flecs_journal_set(...)
+#define flecs_journal_set_range(...)
 #define flecs_journal(...)
 
 /** @} */
@@ -330,6 +330,7 @@ typedef struct ecs_meta_type_op_t {
 
 typedef struct EcsMetaTypeSerialized {
     ecs_vector_t* ops;      /**< vector<ecs_meta_type_op_t> */
+    struct ecs_json_ser_plan_t *json_plan; /**< Cached JSON serializer plan */
 } EcsMetaTypeSerialized;
 
 
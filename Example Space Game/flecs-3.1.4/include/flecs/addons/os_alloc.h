@@ -0,0 +1,92 @@
+/**
+ * @file addons/os_alloc.h
+ * @brief Thread caching allocator for the OS API.
+ *
+ * The allocator replaces the heap functions of the OS API. Small allocations
+ * are served from per thread caches, which exchange free blocks with a shared
+ * heap in batches. This keeps worker threads that create and delete entities
+ * from contending on the global malloc.
+ *
+ * The allocator is not used unless an application installs it with
+ * ecs_os_alloc_set_api.
+ */
+
+#ifdef FLECS_OS_ALLOC
+
+/**
+ * @defgroup c_addons_os_alloc OS Allocator
+ * @brief Thread caching allocator for the OS API.
+ *
+ * \ingroup c_addons
+ * @{
+ */
+
+#ifndef FLECS_OS_ALLOC_H
+#define FLECS_OS_ALLOC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of size classes. Allocations larger than the largest class (256KB)
+ * are mapped directly from the OS. */
+#define ECS_OS_ALLOC_CLASS_COUNT (52)
+
+/** Allocator statistics (use ecs_os_alloc_stats_get) */
+typedef struct ecs_os_alloc_stats_t {
+    int64_t live_bytes;         /**< Bytes in blocks in use by the application */
+    int64_t peak_bytes;         /**< Peak of live bytes plus bytes in thread caches */
+    int64_t cached_bytes;       /**< Bytes in free blocks held by thread caches */
+    int64_t reserved_bytes;     /**< Bytes mapped from the OS */
+    int64_t large_alloc_count;  /**< Allocations larger than the largest class */
+    int64_t large_live_bytes;   /**< Bytes in use by large allocations */
+    int32_t thread_count;       /**< Threads with an allocation cache */
+
+    int32_t class_size[ECS_OS_ALLOC_CLASS_COUNT];        /**< Block size of class */
+    int64_t class_alloc_count[ECS_OS_ALLOC_CLASS_COUNT]; /**< Allocations per class */
+    int64_t class_live_count[ECS_OS_ALLOC_CLASS_COUNT];  /**< Blocks in use per class */
+} ecs_os_alloc_stats_t;
+
+/** Use the thread caching allocator for the OS API heap functions.
+ * This replaces malloc_, calloc_, realloc_ and free_ of the provided OS API.
+ * Call it on the result of ecs_os_get_api and pass the result to
+ * ecs_os_set_api before creating a world:
+ *
+ * @code
+ * ecs_os_set_api_defaults();
+ * ecs_os_api_t os_api = ecs_os_get_api();
+ * ecs_os_alloc_set_api(&os_api, false);
+ * ecs_os_set_api(&os_api);
+ * @endcode
+ *
+ * Memory that was allocated before the allocator was installed may still be
+ * passed to free_ and realloc_, which hand it back to the C library.
+ *
+ * @param os_api The OS API to update.
+ * @param huge_pages Back allocator chunks with huge pages (Linux only).
+ */
+FLECS_API
+void ecs_os_alloc_set_api(
+    ecs_os_api_t *os_api,
+    bool huge_pages);
+
+/** Get allocator statistics.
+ * Statistics are collected from all thread caches without stopping the
+ * threads, so values are approximate while other threads allocate.
+ *
+ * @param stats Out parameter for statistics.
+ * @return Whether the allocator is in use. If not, stats are zeroed.
+ */
+FLECS_API
+bool ecs_os_alloc_stats_get(
+    ecs_os_alloc_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLECS_OS_ALLOC_H
+
+/** @} */
+
+#endif // FLECS_OS_ALLOC
@@ -55,6 +55,9 @@ extern "C" {
 
 /** Parse plecs string.
  * This parses a plecs string and instantiates the entities in the world.
+ * Consecutive statements that create entities with the same components in the
+ * same scope create them with a single ecs_bulk_init, after the last of the
+ * statements is parsed.
  *
  * @param world The world.
  * @param name The script name (typically the file).
@@ -67,10 +70,24 @@ int ecs_plecs_from_str(
     const char *name,
     const char *str);
 
+/** Plecs file load statistics (use ecs_plecs_from_file_w_stats) */
+typedef struct ecs_plecs_load_t {
+    int64_t byte_count;         /**< Bytes read from the file */
+    int32_t read_count;         /**< Number of reads from the file */
+    int32_t entity_count;       /**< Entities created by the script */
+    int32_t cache_hit_count;    /**< Identifiers resolved from the lookup cache */
+    int32_t bulk_count;         /**< Number of ecs_bulk_init calls */
+    ecs_size_t buffer_size;     /**< Size of the read buffer */
+    ecs_ftime_t time_spent;     /**< Time spent loading the file */
+} ecs_plecs_load_t;
+
 /** Parse plecs file.
- * This parses a plecs file and instantiates the entities in the world. This
- * operation is equivalent to loading the file contents and passing it to
- * ecs_plecs_from_str.
+ * This parses a plecs file and instantiates the entities in the world. The
+ * result is the same as loading the file contents and passing it to
+ * ecs_plecs_from_str, but the file is read and parsed in chunks of complete
+ * statements, so the file doesn't have to fit in memory. The read buffer only
+ * grows for statements that are larger than a chunk. Entities are created in
+ * bulk like with ecs_plecs_from_str, also across chunks.
  *
  * @param world The world.
  * @param filename The plecs file name.
@@ -81,6 +98,19 @@ int ecs_plecs_from_file(
     ecs_world_t *world,
     const char *filename);
 
+/** Same as ecs_plecs_from_file, but also returns load statistics.
+ *
+ * @param world The world.
+ * @param filename The plecs file name.
+ * @param stats Out parameter for the load statistics (optional).
+ * @return Zero if success, non-zero otherwise.
+ */
+FLECS_API
+int ecs_plecs_from_file_w_stats(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_plecs_load_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -72,6 +72,7 @@ extern int64_t ecs_rest_delete_error_count;
 extern int64_t ecs_rest_world_stats_count;
 extern int64_t ecs_rest_pipeline_stats_count;
 extern int64_t ecs_rest_stats_error_count;
+extern int64_t ecs_rest_stats_stream_count;
 
 /* Module import */
 FLECS_API
@@ -75,6 +75,7 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t storage_count;        /**< Number of table storages */
         ecs_metric_t create_count;         /**< Number of times table has been created */
         ecs_metric_t delete_count;         /**< Number of times table has been deleted */
+        ecs_metric_t realloc_count;        /**< Number of times table storage has been resized */
     } tables;
 
     /* Queries & events */
@@ -137,6 +138,12 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t stack_alloc_count;    /**< Page allocations per frame */
         ecs_metric_t stack_free_count;     /**< Page frees per frame */
         ecs_metric_t stack_outstanding_alloc_count; /**< Difference between allocs & frees */
+
+        /* Thread caching allocator data (zero if allocator is not in use) */
+        ecs_metric_t os_alloc_live_bytes;    /**< Bytes in use by the application */
+        ecs_metric_t os_alloc_peak_bytes;    /**< Peak of live and thread cached bytes */
+        ecs_metric_t os_alloc_cached_bytes;  /**< Free bytes held by thread caches */
+        ecs_metric_t os_alloc_reserved_bytes; /**< Bytes mapped from the OS */
     } memory;
 
     /* REST statistics */
@@ -154,6 +161,7 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t world_stats_count;
         ecs_metric_t pipeline_stats_count;
         ecs_metric_t stats_error_count;
+        ecs_metric_t stats_stream_count;
     } rest;
 
     /* HTTP statistics */
@@ -217,8 +225,36 @@ typedef struct ecs_pipeline_stats_t {
     int32_t system_count;        /**< Number of systems in pipeline */
     int32_t active_system_count; /**< Number of active systems in pipeline */
     int32_t rebuild_count;       /**< Number of times pipeline has rebuilt */
+
+    int64_t first_;
+    ecs_metric_t sync_count;     /**< Number of sync points, including end of frame */
+    ecs_metric_t sync_time;      /**< Time spent in sync points (wait & merge) */
+    ecs_metric_t sync_wait_time; /**< Time main thread spent waiting on workers */
+    int64_t last_;
 } ecs_pipeline_stats_t;
 
+/** Number of metrics in a stats stream sample */
+#define ECS_STATS_STREAM_METRIC_COUNT (61)
+
+/** Number of frames kept by a stats stream when no capacity is provided */
+#define ECS_STATS_STREAM_DEFAULT_CAPACITY (256)
+
+/** Kind of a stats stream metric */
+typedef enum ecs_stats_stream_kind_t {
+    EcsStatsStreamGauge,   /**< Value that indicates current state */
+    EcsStatsStreamCounter  /**< Monotonically increasing value */
+} ecs_stats_stream_kind_t;
+
+/** Ringbuffer with raw world metrics (use ecs_stats_stream_sample).
+ * A stream stores the unprocessed integer value of each metric per frame,
+ * which makes sampling cheap enough to do every frame. Clients read the
+ * stream incrementally with ecs_stats_stream_encode. */
+typedef struct ecs_stats_stream_t {
+    int64_t *samples;  /**< capacity * ECS_STATS_STREAM_METRIC_COUNT values */
+    int32_t capacity;  /**< Number of frames kept */
+    int64_t seq;       /**< Sequence number of last sample (0 if none) */
+} ecs_stats_stream_t;
+
 /** Get world statistics.
  *
  * @param world The world.
@@ -412,6 +448,83 @@ void ecs_metric_copy(
     int32_t dst,
     int32_t src);
 
+/** Initialize stats stream.
+ *
+ * @param stream The stream to initialize.
+ * @param capacity Number of frames to keep (0 = default).
+ */
+FLECS_API
+void ecs_stats_stream_init(
+    ecs_stats_stream_t *stream,
+    int32_t capacity);
+
+/** Free resources of stats stream. */
+FLECS_API
+void ecs_stats_stream_fini(
+    ecs_stats_stream_t *stream);
+
+/** Append current world metrics to stream.
+ * Time metrics are stored in microseconds. When the stream is full the oldest
+ * frame is overwritten.
+ *
+ * Besides the world metrics the stream has the system count, rebuild count and
+ * sync point metrics of the current pipeline (see ecs_pipeline_stats_t). The
+ * statistics of individual systems are not streamed: the metrics of a stream
+ * are fixed when a client receives their names, while systems can be created
+ * and deleted at any time. Use ecs_pipeline_stats_get for those.
+ *
+ * @param world The world.
+ * @param stream The stream.
+ */
+FLECS_API
+void ecs_stats_stream_sample(
+    const ecs_world_t *world,
+    ecs_stats_stream_t *stream);
+
+/** Get name of stats stream metric.
+ * Names use the same category and member names as the world stats, for
+ * example "frame.merge_count" or "performance.frame_time_us".
+ *
+ * @param index Index of metric.
+ * @param kind Out parameter for metric kind (optional).
+ * @return The metric name, or NULL if the index is out of range.
+ */
+FLECS_API
+const char* ecs_stats_stream_metric_name(
+    int32_t index,
+    ecs_stats_stream_kind_t *kind);
+
+/** Encode frames sampled after a sequence number.
+ * The encoding only contains the metrics that changed between frames, which
+ * makes it compact enough to poll at a high frequency. All integers are
+ * LEB128 varints, signed values are zigzag encoded:
+ *
+ * @code
+ * "FLST" varint:version varint:metric_count varint:has_names
+ * [has_names] metric_count x (u8:kind varint:length bytes:name)
+ * varint:first_seq varint:frame_count varint:base_seq
+ * frame_count x (varint:changed_count changed_count x (varint:gap zigzag:delta))
+ * @endcode
+ *
+ * The first frame is encoded as a delta to frame base_seq, which is the frame
+ * the client last received. A base_seq of 0 means the first frame is encoded
+ * against all zeros, which happens when the client frame is no longer in the
+ * stream. Each next frame is a delta to its predecessor. The gap is the
+ * number of unchanged metrics since the previous changed metric.
+ *
+ * @param stream The stream.
+ * @param since Last sequence number received by client (0 for all frames).
+ * @param names Whether to include metric names.
+ * @param size Out parameter for size of the encoded data.
+ * @return Encoded data, must be freed with ecs_os_free.
+ */
+FLECS_API
+char* ecs_stats_stream_encode(
+    const ecs_stats_stream_t *stream,
+    int64_t since,
+    bool names,
+    ecs_size_t *size);
+
 #ifdef __cplusplus
 }
 #endif
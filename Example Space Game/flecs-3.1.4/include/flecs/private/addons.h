@@ -83,6 +83,9 @@
 #ifdef FLECS_NO_OS_API_IMPL
 #undef FLECS_OS_API_IMPL
 #endif
+#ifdef FLECS_NO_OS_ALLOC
+#undef FLECS_OS_ALLOC
+#endif
 #ifdef FLECS_NO_HTTP
 #undef FLECS_HTTP
 #endif
@@ -234,6 +237,12 @@
 #endif
 #include "../addons/os_api_impl.h"
 #endif
+#ifdef FLECS_OS_ALLOC
+#ifdef FLECS_NO_OS_ALLOC
+#error "FLECS_NO_OS_ALLOC failed: OS_ALLOC is required by other addons"
+#endif
+#include "../addons/os_alloc.h"
+#endif
 #ifdef FLECS_MODULE
 #ifdef FLECS_NO_MODULE
 #error "FLECS_NO_MODULE failed: MODULE is required by other addons"
@@ -22,6 +22,7 @@ extern "C" {
 #define EcsWorldMeasureFrameTime      (1u << 4)
 #define EcsWorldMeasureSystemTime     (1u << 5)
 #define EcsWorldMultiThreaded         (1u << 6)
+#define EcsWorldLookupCache           (1u << 7)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -106,6 +107,7 @@ extern "C" {
 
 #define EcsEventTableOnly              (1u << 8u)   /* Table event (no data, same as iter flags) */
 #define EcsEventNoOnSet                (1u << 16u)  /* Don't emit OnSet/UnSet for inherited ids */
+#define EcsEventNoOnAdd                (1u << 17u)  /* Don't emit OnAdd, caller notifies a range of rows */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Filter flags (used by ecs_filter_t::flags)
@@ -147,6 +149,7 @@ extern "C" {
 #define EcsTableHasUnSet               (1u << 18u)
 
 #define EcsTableHasObserved            (1u << 20u)
+#define EcsTableHasName                (1u << 21u) /* Does the table have (Identifier, Name) */
 
 #define EcsTableMarkedForDelete        (1u << 30u)
 
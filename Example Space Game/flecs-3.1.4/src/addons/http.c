@@ -49,8 +49,12 @@
 typedef SOCKET ecs_http_socket_t;
 #else
 #include <unistd.h>
+#include <fcntl.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/time.h>
 #include <netdb.h>
 #include <strings.h>
@@ -58,36 +62,76 @@ typedef SOCKET ecs_http_socket_t;
 typedef int ecs_http_socket_t;
 #endif
 
-#if !defined(MSG_NOSIGNAL)
-#define MSG_NOSIGNAL (0)
+/* The server thread waits for socket events with epoll where available, and
+ * falls back to poll (WSAPoll on Windows) otherwise. */
+#if defined(ECS_TARGET_LINUX)
+#define ECS_HTTP_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#elif !defined(ECS_TARGET_WINDOWS)
+#include <poll.h>
+#endif
+
+/* Loads/stores of the queue indices shared by the server and main thread */
+#if defined(ECS_TARGET_MSVC)
+#define http_atomic_load(ptr)\
+    ((uint32_t)InterlockedCompareExchange((volatile LONG*)(ptr), 0, 0))
+#define http_atomic_store(ptr, value)\
+    InterlockedExchange((volatile LONG*)(ptr), (LONG)(value))
+#else
+#define http_atomic_load(ptr)\
+    __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define http_atomic_store(ptr, value)\
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
 #endif
 
 /* Max length of request method */
-#define ECS_HTTP_METHOD_LEN_MAX (8) 
+#define ECS_HTTP_METHOD_LEN_MAX (8)
 
-/* Timeout (s) before connection purge */
-#define ECS_HTTP_CONNECTION_PURGE_TIMEOUT (1.0)
+/* Timeout (s) before an idle connection is closed */
+#define ECS_HTTP_CONNECTION_IDLE_TIMEOUT (10.0)
 
-/* Number of dequeues before purging */
-#define ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT (5)
+/* Interval (s) between checking connections for the idle timeout */
+#define ECS_HTTP_CONNECTION_PURGE_INTERVAL (1.0)
 
-/* Minimum interval between dequeueing requests (ms) */
-#define ECS_HTTP_MIN_DEQUEUE_INTERVAL (50)
+/* Max number of requests handled by a single dequeue */
+#define ECS_HTTP_DEQUEUE_MAX (64)
+
+/* Max time (s) spent on requests by a single dequeue. Requests that don't fit
+ * in the budget are handled by the next dequeue. */
+#define ECS_HTTP_DEQUEUE_BUDGET (0.002)
 
 /* Minimum interval between printing statistics (ms) */
 #define ECS_HTTP_MIN_STATS_INTERVAL (10 * 1000)
 
-/* Max length of headers in reply */
-#define ECS_HTTP_REPLY_HEADER_SIZE (1024)
-
 /* Receive buffer size */
 #define ECS_HTTP_SEND_RECV_BUFFER_SIZE (16 * 1024)
 
 /* Max length of request (path + query + headers + body) */
 #define ECS_HTTP_REQUEST_LEN_MAX (10 * 1024 * 1024)
 
-/* Total number of outstanding send requests */
-#define ECS_HTTP_SEND_QUEUE_MAX (256)
+/* Max number of requests that are handed to the main thread and not yet
+ * replied to. Must be a power of 2. */
+#define ECS_HTTP_QUEUE_SIZE (256)
+
+/* Max number of socket events handled per server thread wakeup */
+#define ECS_HTTP_POLL_EVENTS_MAX (64)
+
+/* Max time (ms) the server thread waits for socket events */
+#define ECS_HTTP_POLL_TIMEOUT (100)
+
+/* Max number of buffers passed to a single send */
+#define ECS_HTTP_SEND_BUFFERS_MAX (64)
+
+/* Socket events */
+#define HTTP_POLL_IN (1)
+#define HTTP_POLL_OUT (2)
+#define HTTP_POLL_ERR (4)
+
+/* Poll ids of the listening socket and wakeup signal. Connections are polled
+ * with the connection id. */
+#define HTTP_POLL_ID_LISTEN (0)
+#define HTTP_POLL_ID_WAKE (UINT64_MAX)
 
 /* Global statistics */
 int64_t ecs_http_request_received_count = 0;
@@ -100,22 +144,35 @@ int64_t ecs_http_send_ok_count = 0;
 int64_t ecs_http_send_error_count = 0;
 int64_t ecs_http_busy_count = 0;
 
-/* Send request queue */
-typedef struct ecs_http_send_request_t {
-    ecs_http_socket_t sock;
-    char *headers;
-    int32_t header_length;
-    char *content;
-    int32_t content_length;
-} ecs_http_send_request_t;
+/* Single producer, single consumer queue. Hands requests from the server
+ * thread to the main thread, and replies back. */
+typedef struct ecs_http_queue_t {
+    void *elems[ECS_HTTP_QUEUE_SIZE];
+    uint32_t head; /* Next element to pop, written by consumer */
+    uint32_t tail; /* Next element to push, written by producer */
+} ecs_http_queue_t;
+
+/* Buffer of an outgoing reply */
+typedef struct ecs_http_send_buf_t {
+    const char *ptr;
+    int32_t length;
+    void *alloc; /* Freed when the reply is freed */
+} ecs_http_send_buf_t;
+
+/* Outgoing reply. Holds the chunks of the header and body strbufs so they can
+ * be sent without first copying them into a single buffer. */
+typedef struct ecs_http_send_t {
+    uint64_t conn_id;
+    ecs_vec_t bufs; /* vec<ecs_http_send_buf_t> */
+    int32_t cur; /* First buffer that isn't completely sent */
+    int32_t offset; /* Number of bytes sent from the current buffer */
+    bool close; /* Close connection after sending the reply */
+} ecs_http_send_t;
 
-typedef struct ecs_http_send_queue_t {
-    ecs_http_send_request_t requests[ECS_HTTP_SEND_QUEUE_MAX];
-    int32_t cur;
-    int32_t count;
-    ecs_os_thread_t thread;
-    int32_t wait_ms;
-} ecs_http_send_queue_t;
+typedef struct {
+    uint64_t id;
+    int32_t events;
+} ecs_http_poll_event_t;
 
 /* HTTP server struct */
 struct ecs_http_server_t {
@@ -123,30 +180,44 @@ struct ecs_http_server_t {
     bool running;
 
     ecs_http_socket_t sock;
-    ecs_os_mutex_t lock;
     ecs_os_thread_t thread;
 
     ecs_http_reply_action_t callback;
     void *ctx;
 
+    /* Only accessed by the server thread */
     ecs_sparse_t connections; /* sparse<http_connection_t> */
-    ecs_sparse_t requests; /* sparse<http_request_t> */
+    int32_t inflight; /* requests handed to main thread without a reply */
+    uint64_t request_id; /* id of last received request */
+    double now; /* time of the current server thread iteration */
+    double purge_time; /* time connections were last checked for timeout */
+
+    ecs_http_queue_t requests; /* queue<ecs_http_request_impl_t*> */
+    ecs_http_queue_t replies; /* queue<ecs_http_send_t*> */
+
+#ifdef ECS_HTTP_EPOLL
+    int epoll_fd;
+    int wake_fd; /* eventfd used to wake up the server thread */
+#else
+    ecs_vec_t poll_fds; /* vec<struct pollfd> */
+    ecs_vec_t poll_ids; /* vec<uint64_t> */
+#ifndef ECS_TARGET_WINDOWS
+    int wake_fds[2]; /* pipe used to wake up the server thread */
+#endif
+#endif
 
     bool initialized;
 
     uint16_t port;
     const char *ipaddr;
 
-    double dequeue_timeout; /* used to not lock request queue too often */
     double stats_timeout; /* used for periodic reporting of statistics */
 
     double request_time; /* time spent on requests in last stats interval */
     double request_time_total; /* total time spent on requests */
     int32_t requests_processed; /* requests processed in last stats interval */
     int32_t requests_processed_total; /* total requests processed */
-    int32_t dequeue_count; /* number of dequeues in last stats interval */ 
-
-    ecs_http_send_queue_t send_queue;
+    int32_t dequeue_count; /* number of dequeues in last stats interval */
 };
 
 /** Fragment state, used by HTTP request parser */
@@ -183,41 +254,121 @@ typedef struct {
     char *header_buf_ptr;
     char header_buf[32];
     bool parse_content_length;
+    bool parse_connection;
+    bool close; /* HTTP/1.0 or Connection: close */
     bool invalid;
 } ecs_http_fragment_t;
 
+/** Connection state */
+typedef enum {
+    HttpConnReading, /* Receiving request */
+    HttpConnWaiting, /* Request is handled by main thread */
+    HttpConnWriting  /* Sending reply */
+} HttpConnState;
+
 /** Extend public connection type with fragment data */
 typedef struct {
     ecs_http_connection_t pub;
     ecs_http_socket_t sock;
-
-    /* Connection is purged after both timeout expires and connection has
-     * exceeded retry count. This ensures that a connection does not immediately
-     * timeout when a frame takes longer than usual */
-    double dequeue_timeout;
-    int32_t dequeue_retries;    
+    HttpConnState state;
+    ecs_http_fragment_t frag; /* request that is being received */
+    ecs_vec_t pending; /* vec<char>, data received after the request */
+    ecs_http_send_t *send; /* reply that is being sent */
+    int32_t events; /* events the socket is polled for */
+    double last_active; /* time of last send or receive */
 } ecs_http_connection_impl_t;
 
 typedef struct {
     ecs_http_request_t pub;
-    uint64_t conn_id; /* for sanity check */
+    ecs_http_connection_t conn; /* connection is owned by the server thread */
     void *res;
+    bool close;
 } ecs_http_request_impl_t;
 
 static
-ecs_size_t http_send(
-    ecs_http_socket_t sock, 
-    const void *buf, 
-    ecs_size_t size, 
-    int flags)
+bool http_queue_push(
+    ecs_http_queue_t *q,
+    void *elem)
+{
+    uint32_t tail = q->tail;
+    if ((tail - http_atomic_load(&q->head)) == ECS_HTTP_QUEUE_SIZE) {
+        return false;
+    }
+
+    q->elems[tail & (ECS_HTTP_QUEUE_SIZE - 1)] = elem;
+    http_atomic_store(&q->tail, tail + 1);
+    return true;
+}
+
+static
+void* http_queue_pop(
+    ecs_http_queue_t *q)
+{
+    uint32_t head = q->head;
+    if (head == http_atomic_load(&q->tail)) {
+        return NULL;
+    }
+
+    void *elem = q->elems[head & (ECS_HTTP_QUEUE_SIZE - 1)];
+    http_atomic_store(&q->head, head + 1);
+    return elem;
+}
+
+static
+double http_time_now(void) {
+    ecs_time_t t;
+    ecs_os_get_time(&t);
+    return ecs_time_to_double(t);
+}
+
+static
+bool http_would_block(void) {
+#if defined(ECS_TARGET_WINDOWS)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+static
+ecs_size_t http_sendv(
+    ecs_http_socket_t sock,
+    const ecs_http_send_buf_t *bufs,
+    int32_t count,
+    int32_t offset)
 {
-    ecs_assert(size >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(offset < bufs[0].length, ECS_INTERNAL_ERROR, NULL);
+    if (count > ECS_HTTP_SEND_BUFFERS_MAX) {
+        count = ECS_HTTP_SEND_BUFFERS_MAX;
+    }
+
+    int32_t i;
 #ifdef ECS_TARGET_POSIX
-    ssize_t send_bytes = send(sock, buf, flecs_itosize(size), 
-        flags | MSG_NOSIGNAL);
+    struct iovec iov[ECS_HTTP_SEND_BUFFERS_MAX];
+    for (i = 0; i < count; i ++) {
+        iov[i].iov_base = (char*)bufs[i].ptr;
+        iov[i].iov_len = flecs_itosize(bufs[i].length);
+    }
+    iov[0].iov_base = (char*)iov[0].iov_base + offset;
+    iov[0].iov_len -= flecs_itosize(offset);
+
+    /* SIGPIPE is ignored by ecs_http_server_init */
+    ssize_t send_bytes = writev(sock, iov, count);
     return flecs_itoi32(send_bytes);
 #else
-    int send_bytes = send(sock, buf, size, flags);
+    WSABUF wsa_bufs[ECS_HTTP_SEND_BUFFERS_MAX];
+    for (i = 0; i < count; i ++) {
+        wsa_bufs[i].buf = (char*)bufs[i].ptr;
+        wsa_bufs[i].len = (ULONG)bufs[i].length;
+    }
+    wsa_bufs[0].buf += offset;
+    wsa_bufs[0].len -= (ULONG)offset;
+
+    DWORD send_bytes = 0;
+    if (WSASend(sock, wsa_bufs, (DWORD)count, &send_bytes, 0, NULL, NULL)) {
+        return -1;
+    }
     return flecs_itoi32(send_bytes);
 #endif
 }
@@ -238,31 +389,41 @@ ecs_size_t http_recv(
     ret = flecs_itoi32(recv_bytes);
 #endif
     if (ret == -1) {
-        ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
+        if (!http_would_block()) {
+            ecs_dbg("recv failed: %s (sock = %d)", ecs_os_strerror(errno), sock);
+        }
     } else if (ret == 0) {
-        ecs_dbg("recv: received 0 bytes (sock = %d)", sock);
+        ecs_dbg_2("recv: received 0 bytes (sock = %d)", sock);
     }
 
     return ret;
 }
 
 static
-void http_sock_set_timeout(
-    ecs_http_socket_t sock,
-    int32_t timeout_ms)
+void http_sock_nonblock(
+    ecs_http_socket_t sock)
 {
     int r;
 #ifdef ECS_TARGET_POSIX
-    struct timeval tv;
-    tv.tv_sec = timeout_ms * 1000;
-    tv.tv_usec = 0;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
+    int flags = fcntl(sock, F_GETFL, 0);
+    r = flags == -1 ? -1 : fcntl(sock, F_SETFL, flags | O_NONBLOCK);
 #else
-    DWORD t = (DWORD)timeout_ms;
-    r = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&t, sizeof t);
+    u_long v = 1;
+    r = ioctlsocket(sock, FIONBIO, &v);
 #endif
     if (r) {
-        ecs_warn("http: failed to set socket timeout: %s", 
+        ecs_warn("http: failed to make socket non-blocking: %s",
+            ecs_os_strerror(errno));
+    }
+}
+
+static
+void http_sock_nodelay(
+    ecs_http_socket_t sock)
+{
+    int v = 1;
+    if (setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&v, sizeof v)) {
+        ecs_warn("http: failed to set socket NODELAY: %s",
             ecs_os_strerror(errno));
     }
 }
@@ -291,7 +452,7 @@ int http_getnameinfo(
     ecs_assert(addr_len > 0, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(host_len > 0, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(port_len > 0, ECS_INTERNAL_ERROR, NULL);
-    return getnameinfo(addr, (uint32_t)addr_len, host, (uint32_t)host_len, 
+    return getnameinfo(addr, (uint32_t)addr_len, host, (uint32_t)host_len,
         port, (uint32_t)port_len, flags);
 }
 
@@ -349,7 +510,392 @@ ecs_http_socket_t http_accept(
     return result;
 }
 
-static 
+#ifdef ECS_HTTP_EPOLL
+
+static
+int http_poll_ctl(
+    ecs_http_server_t *srv,
+    int op,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    struct epoll_event ev = {0};
+    if (events & HTTP_POLL_IN) {
+        ev.events |= EPOLLIN;
+    }
+    if (events & HTTP_POLL_OUT) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.u64 = id;
+
+    if (epoll_ctl(srv->epoll_fd, op, sock, &ev)) {
+        ecs_err("http: failed to poll socket %d: %s", sock,
+            ecs_os_strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static
+int http_poll_add(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    return http_poll_ctl(srv, EPOLL_CTL_ADD, sock, id, events);
+}
+
+static
+int http_poll_mod(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    return http_poll_ctl(srv, EPOLL_CTL_MOD, sock, id, events);
+}
+
+static
+int http_poll_init(
+    ecs_http_server_t *srv)
+{
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (srv->epoll_fd == -1) {
+        ecs_err("http: failed to create epoll instance: %s",
+            ecs_os_strerror(errno));
+        return -1;
+    }
+
+    srv->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (srv->wake_fd == -1) {
+        ecs_err("http: failed to create eventfd: %s", ecs_os_strerror(errno));
+        close(srv->epoll_fd);
+        return -1;
+    }
+
+    if (http_poll_add(srv, srv->wake_fd, HTTP_POLL_ID_WAKE, HTTP_POLL_IN)) {
+        close(srv->wake_fd);
+        close(srv->epoll_fd);
+        return -1;
+    }
+
+    return 0;
+}
+
+static
+void http_poll_fini(
+    ecs_http_server_t *srv)
+{
+    close(srv->wake_fd);
+    close(srv->epoll_fd);
+}
+
+static
+int32_t http_poll_wait(
+    ecs_http_server_t *srv,
+    ecs_http_poll_event_t *events,
+    int32_t timeout_ms)
+{
+    struct epoll_event ev[ECS_HTTP_POLL_EVENTS_MAX];
+    int count = epoll_wait(
+        srv->epoll_fd, ev, ECS_HTTP_POLL_EVENTS_MAX, timeout_ms);
+    if (count < 0) {
+        if (errno != EINTR) {
+            ecs_err("http: epoll_wait failed: %s", ecs_os_strerror(errno));
+        }
+        return 0;
+    }
+
+    int i;
+    for (i = 0; i < count; i ++) {
+        uint32_t e = ev[i].events;
+        events[i].id = ev[i].data.u64;
+        events[i].events =
+            ((e & EPOLLIN) ? HTTP_POLL_IN : 0) |
+            ((e & EPOLLOUT) ? HTTP_POLL_OUT : 0) |
+            ((e & (EPOLLERR | EPOLLHUP)) ? HTTP_POLL_ERR : 0);
+    }
+
+    return count;
+}
+
+static
+void http_wake(
+    ecs_http_server_t *srv)
+{
+    uint64_t v = 1;
+    ssize_t r = write(srv->wake_fd, &v, sizeof(v));
+    (void)r; /* nonzero counter already wakes up the server thread */
+}
+
+static
+void http_wake_clear(
+    ecs_http_server_t *srv)
+{
+    uint64_t v;
+    ssize_t r = read(srv->wake_fd, &v, sizeof(v));
+    (void)r;
+}
+
+#else
+
+/* Sockets are collected from the connections each time the server thread
+ * waits, so there is nothing to register. */
+static
+int http_poll_add(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    (void)srv; (void)sock; (void)id; (void)events;
+    return 0;
+}
+
+static
+int http_poll_mod(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    (void)srv; (void)sock; (void)id; (void)events;
+    return 0;
+}
+
+static
+int http_poll_init(
+    ecs_http_server_t *srv)
+{
+    ecs_vec_init_t(NULL, &srv->poll_fds, struct pollfd, 0);
+    ecs_vec_init_t(NULL, &srv->poll_ids, uint64_t, 0);
+#ifndef ECS_TARGET_WINDOWS
+    if (pipe(srv->wake_fds)) {
+        ecs_err("http: failed to create pipe: %s", ecs_os_strerror(errno));
+        ecs_vec_fini_t(NULL, &srv->poll_fds, struct pollfd);
+        ecs_vec_fini_t(NULL, &srv->poll_ids, uint64_t);
+        return -1;
+    }
+    http_sock_nonblock(srv->wake_fds[0]);
+    http_sock_nonblock(srv->wake_fds[1]);
+#endif
+    return 0;
+}
+
+static
+void http_poll_fini(
+    ecs_http_server_t *srv)
+{
+#ifndef ECS_TARGET_WINDOWS
+    close(srv->wake_fds[0]);
+    close(srv->wake_fds[1]);
+#endif
+    ecs_vec_fini_t(NULL, &srv->poll_fds, struct pollfd);
+    ecs_vec_fini_t(NULL, &srv->poll_ids, uint64_t);
+}
+
+static
+void http_poll_fd(
+    ecs_http_server_t *srv,
+    ecs_http_socket_t sock,
+    uint64_t id,
+    int32_t events)
+{
+    struct pollfd *fd = ecs_vec_append_t(NULL, &srv->poll_fds, struct pollfd);
+    fd->fd = sock;
+    fd->events = (short)(
+        ((events & HTTP_POLL_IN) ? POLLIN : 0) |
+        ((events & HTTP_POLL_OUT) ? POLLOUT : 0));
+    fd->revents = 0;
+    ecs_vec_append_t(NULL, &srv->poll_ids, uint64_t)[0] = id;
+}
+
+static
+int32_t http_poll_wait(
+    ecs_http_server_t *srv,
+    ecs_http_poll_event_t *events,
+    int32_t timeout_ms)
+{
+    ecs_vec_clear(&srv->poll_fds);
+    ecs_vec_clear(&srv->poll_ids);
+
+#ifndef ECS_TARGET_WINDOWS
+    http_poll_fd(srv, srv->wake_fds[0], HTTP_POLL_ID_WAKE, HTTP_POLL_IN);
+#else
+    /* Without a wakeup signal, poll often while the main thread has requests
+     * so replies don't wait for the timeout */
+    if (srv->inflight) {
+        timeout_ms = 1;
+    }
+#endif
+
+    if (http_socket_is_valid(srv->sock)) {
+        http_poll_fd(srv, srv->sock, HTTP_POLL_ID_LISTEN, HTTP_POLL_IN);
+    }
+
+    int32_t i, count = flecs_sparse_count(&srv->connections);
+    for (i = 1; i < count; i ++) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense_t(
+            &srv->connections, ecs_http_connection_impl_t, i);
+        if (conn->events) {
+            http_poll_fd(srv, conn->sock, conn->pub.id, conn->events);
+        }
+    }
+
+    struct pollfd *fds = ecs_vec_first(&srv->poll_fds);
+    uint64_t *ids = ecs_vec_first(&srv->poll_ids);
+    int32_t fd_count = ecs_vec_count(&srv->poll_fds);
+#ifdef ECS_TARGET_WINDOWS
+    int r = WSAPoll(fds, (ULONG)fd_count, timeout_ms);
+#else
+    int r = poll(fds, (nfds_t)fd_count, timeout_ms);
+#endif
+    if (r <= 0) {
+        return 0;
+    }
+
+    int32_t result = 0;
+    for (i = 0; i < fd_count && result < ECS_HTTP_POLL_EVENTS_MAX; i ++) {
+        short e = fds[i].revents;
+        if (!e) {
+            continue;
+        }
+        events[result].id = ids[i];
+        events[result].events =
+            ((e & POLLIN) ? HTTP_POLL_IN : 0) |
+            ((e & POLLOUT) ? HTTP_POLL_OUT : 0) |
+            ((e & (POLLERR | POLLHUP | POLLNVAL)) ? HTTP_POLL_ERR : 0);
+        result ++;
+    }
+
+    return result;
+}
+
+static
+void http_wake(
+    ecs_http_server_t *srv)
+{
+#ifndef ECS_TARGET_WINDOWS
+    char v = 0;
+    ssize_t r = write(srv->wake_fds[1], &v, 1);
+    (void)r; /* full pipe already wakes up the server thread */
+#else
+    (void)srv;
+#endif
+}
+
+static
+void http_wake_clear(
+    ecs_http_server_t *srv)
+{
+#ifndef ECS_TARGET_WINDOWS
+    char buf[64];
+    while (read(srv->wake_fds[0], buf, sizeof(buf)) > 0) { }
+#else
+    (void)srv;
+#endif
+}
+
+#endif
+
+static
+ecs_http_send_t* http_send_new(
+    uint64_t conn_id,
+    bool close)
+{
+    ecs_http_send_t *send = ecs_os_calloc_t(ecs_http_send_t);
+    send->conn_id = conn_id;
+    send->close = close;
+    ecs_vec_init_t(NULL, &send->bufs, ecs_http_send_buf_t, 4);
+    return send;
+}
+
+static
+void http_send_free(
+    ecs_http_send_t *send)
+{
+    int32_t i, count = ecs_vec_count(&send->bufs);
+    ecs_http_send_buf_t *bufs = ecs_vec_first(&send->bufs);
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(bufs[i].alloc);
+    }
+    ecs_vec_fini_t(NULL, &send->bufs, ecs_http_send_buf_t);
+    ecs_os_free(send);
+}
+
+static
+void http_send_append(
+    ecs_http_send_t *send,
+    const char *ptr,
+    int32_t length,
+    void *alloc)
+{
+    if (!length) {
+        ecs_os_free(alloc);
+        return;
+    }
+
+    ecs_http_send_buf_t *buf = ecs_vec_append_t(
+        NULL, &send->bufs, ecs_http_send_buf_t);
+    buf->ptr = ptr;
+    buf->length = length;
+    buf->alloc = alloc;
+}
+
+static
+void http_send_append_copy(
+    ecs_http_send_t *send,
+    const char *ptr,
+    int32_t length)
+{
+    if (length) {
+        char *copy = ecs_os_malloc(length);
+        ecs_os_memcpy(copy, ptr, length);
+        http_send_append(send, copy, length, copy);
+    }
+}
+
+/* Move strbuf chunks to reply. Only the element that is inlined in the strbuf
+ * and strings the strbuf doesn't own (appended with a _const function) are
+ * copied, other chunks are sent as is. */
+static
+void http_send_append_strbuf(
+    ecs_http_send_t *send,
+    ecs_strbuf_t *b)
+{
+    if (!b->elementCount) {
+        return;
+    }
+
+    if (b->buf) {
+        /* Application provided buffer */
+        http_send_append_copy(send, b->buf, ecs_strbuf_written(b));
+    } else {
+        ecs_strbuf_element *e = &b->firstElement.super, *next;
+        http_send_append_copy(send, e->buf, e->pos);
+
+        for (e = e->next; e; e = next) {
+            next = e->next;
+            if (e->buffer_embedded) {
+                http_send_append(send, e->buf, e->pos, e);
+            } else {
+                char *alloc_str = ((ecs_strbuf_element_str*)e)->alloc_str;
+                if (alloc_str) {
+                    http_send_append(send, e->buf, e->pos, alloc_str);
+                } else {
+                    http_send_append_copy(send, e->buf, e->pos);
+                }
+                ecs_os_free(e);
+            }
+        }
+    }
+
+    *b = ECS_STRBUF_INIT;
+}
+
+static
 void http_reply_free(ecs_http_reply_t* response) {
     ecs_assert(response != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_os_free(response->body.content);
@@ -358,26 +904,47 @@ void http_reply_free(ecs_http_reply_t* response) {
 static
 void http_request_free(ecs_http_request_impl_t *req) {
     ecs_assert(req != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(req->pub.conn != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(req->pub.conn->server != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(req->pub.conn->id == req->conn_id, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(req->pub.conn == &req->conn, ECS_INTERNAL_ERROR, NULL);
     ecs_os_free(req->res);
-    flecs_sparse_remove_t(&req->pub.conn->server->requests, 
-        ecs_http_request_impl_t, req->pub.id);
+    ecs_os_free(req);
 }
 
 static
-void http_connection_free(ecs_http_connection_impl_t *conn) {
+void http_connection_close(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
     ecs_assert(conn != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(conn->pub.id != 0, ECS_INTERNAL_ERROR, NULL);
-    uint64_t conn_id = conn->pub.id;
 
+    ecs_dbg_2("http: closing connection '%s:%s' (sock = %d)",
+        conn->pub.host, conn->pub.port, conn->sock);
+
+    /* Closing the socket also removes it from the poll set */
     if (http_socket_is_valid(conn->sock)) {
         http_close(&conn->sock);
     }
 
-    flecs_sparse_remove_t(&conn->pub.server->connections, 
-        ecs_http_connection_impl_t, conn_id);
+    ecs_strbuf_reset(&conn->frag.buf);
+    ecs_vec_fini_t(NULL, &conn->pending, char);
+    if (conn->send) {
+        http_send_free(conn->send);
+    }
+
+    flecs_sparse_remove_t(&srv->connections,
+        ecs_http_connection_impl_t, conn->pub.id);
+}
+
+static
+void http_connection_poll(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int32_t events)
+{
+    if (conn->events != events) {
+        http_poll_mod(srv, conn->sock, conn->pub.id, events);
+        conn->events = events;
+    }
 }
 
 // https://stackoverflow.com/questions/10156409/convert-hex-string-char-to-int
@@ -406,6 +973,13 @@ void http_decode_url_str(
     dst[0] = '\0';
 }
 
+static
+char http_tolower(
+    char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? (char)(ch - 'A' + 'a') : ch;
+}
+
 static
 void http_parse_method(
     ecs_http_fragment_t *frag)
@@ -453,59 +1027,11 @@ void http_header_buf_append(
     }
 }
 
+/* Parses request data, returns the number of bytes that were consumed. Parsing
+ * stops when the request is complete, so that data of a next request on the
+ * same connection isn't consumed. */
 static
-void http_enqueue_request(
-    ecs_http_connection_impl_t *conn,
-    uint64_t conn_id,
-    ecs_http_fragment_t *frag)
-{
-    ecs_http_server_t *srv = conn->pub.server;
-
-    ecs_os_mutex_lock(srv->lock);
-    bool is_alive = conn->pub.id == conn_id;
-
-    if (!is_alive || frag->invalid) { 
-        /* Don't enqueue invalid requests or requests for purged connections */
-        ecs_strbuf_reset(&frag->buf);
-    } else {
-        char *res = ecs_strbuf_get(&frag->buf);
-        if (res) {
-            ecs_http_request_impl_t *req = flecs_sparse_add_t(
-                &srv->requests, ecs_http_request_impl_t);
-            req->pub.id = flecs_sparse_last_id(&srv->requests);
-            req->conn_id = conn->pub.id;
-
-            req->pub.conn = (ecs_http_connection_t*)conn;
-            req->pub.method = frag->method;
-            req->pub.path = res + 1;
-            if (frag->body_offset) {
-                req->pub.body = &res[frag->body_offset];
-            }
-            int32_t i, count = frag->header_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.headers[i].key = &res[frag->header_offsets[i]];
-                req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
-            }
-            count = frag->param_count;
-            for (i = 0; i < count; i ++) {
-                req->pub.params[i].key = &res[frag->param_offsets[i]];
-                req->pub.params[i].value = &res[frag->param_value_offsets[i]];
-                http_decode_url_str((char*)req->pub.params[i].value);
-            }
-
-            req->pub.header_count = frag->header_count;
-            req->pub.param_count = frag->param_count;
-            req->res = res;
-
-            ecs_os_linc(&ecs_http_request_received_count);
-        }
-    }
-
-    ecs_os_mutex_unlock(srv->lock);
-}
-
-static
-bool http_parse_request(
+ecs_size_t http_parse_request(
     ecs_http_fragment_t *frag,
     const char* req_frag, 
     ecs_size_t req_frag_len) 
@@ -533,6 +1059,7 @@ bool http_parse_request(
             if (c == ' ') {
                 frag->state = HttpFragStateVersion;
                 ecs_strbuf_appendch(&frag->buf, '\0');
+                http_header_buf_reset(frag);
             } else {
                 if (c == '?' || c == '=' || c == '&') {
                     ecs_strbuf_appendch(&frag->buf, '\0');
@@ -550,7 +1077,12 @@ bool http_parse_request(
             break;
         case HttpFragStateVersion:
             if (c == '\r') {
+                /* HTTP/1.0 connections are closed after the reply */
+                http_header_buf_append(frag, '\0');
+                frag->close = !ecs_os_strcmp(frag->header_buf, "HTTP/1.0");
                 frag->state = HttpFragStateCR;
+            } else {
+                http_header_buf_append(frag, c);
             } /* version is not stored */
             break;
         case HttpFragStateHeaderStart:
@@ -566,7 +1098,9 @@ bool http_parse_request(
                 frag->state = HttpFragStateHeaderValueStart;
                 http_header_buf_append(frag, '\0');
                 frag->parse_content_length = !ecs_os_strcmp(
-                    frag->header_buf, "Content-Length");
+                    frag->header_buf, "content-length");
+                frag->parse_connection = !ecs_os_strcmp(
+                    frag->header_buf, "connection");
 
                 if (http_header_writable(frag)) {
                     ecs_strbuf_appendch(&frag->buf, '\0');
@@ -576,7 +1110,8 @@ bool http_parse_request(
             } else if (c == '\r') {
                 frag->state = HttpFragStateCR;
             } else  {
-                http_header_buf_append(frag, c);
+                /* Header names are case insensitive */
+                http_header_buf_append(frag, http_tolower(c));
                 if (http_header_writable(frag)) {
                     ecs_strbuf_appendch(&frag->buf, c);
                 }
@@ -594,13 +1129,22 @@ bool http_parse_request(
                 if (frag->parse_content_length) {
                     http_header_buf_append(frag, '\0');
                     int32_t len = atoi(frag->header_buf);
-                    if (len < 0) {
+                    if (len < 0 || len > ECS_HTTP_REQUEST_LEN_MAX) {
                         frag->invalid = true;
                     } else {
                         frag->content_length = len;
                     }
                     frag->parse_content_length = false;
                 }
+                if (frag->parse_connection) {
+                    http_header_buf_append(frag, '\0');
+                    if (strstr(frag->header_buf, "close")) {
+                        frag->close = true;
+                    } else if (strstr(frag->header_buf, "keep-alive")) {
+                        frag->close = false;
+                    }
+                    frag->parse_connection = false;
+                }
                 if (http_header_writable(frag)) {
                     int32_t cur = ecs_strbuf_written(&frag->buf);
                     if (frag->header_offsets[frag->header_count] < cur &&
@@ -614,6 +1158,8 @@ bool http_parse_request(
             } else {
                 if (frag->parse_content_length) {
                     http_header_buf_append(frag, c);
+                } else if (frag->parse_connection) {
+                    http_header_buf_append(frag, http_tolower(c));
                 }
                 if (http_header_writable(frag)) {
                     ecs_strbuf_appendch(&frag->buf, c);
@@ -637,7 +1183,7 @@ bool http_parse_request(
             break;
         case HttpFragStateCRLFCR:
             if (c == '\n') {
-                if (frag->content_length != 0) {
+                if (frag->content_length != 0 && !frag->invalid) {
                     frag->body_offset = ecs_strbuf_written(&frag->buf);
                     frag->state = HttpFragStateBody;
                 } else {
@@ -659,105 +1205,13 @@ bool http_parse_request(
         case HttpFragStateDone:
             break;
         }
-    }
-
-    if (frag->state == HttpFragStateDone) {
-        return true;
-    } else {
-        return false;
-    }
-}
-
-static
-ecs_http_send_request_t* http_send_queue_post(
-    ecs_http_server_t *srv)
-{
-    /* This function should only be called while the server is locked. Before 
-     * the lock is released, the returned element should be populated. */
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    ecs_assert(sq->count <= ECS_HTTP_SEND_QUEUE_MAX, ECS_INTERNAL_ERROR, NULL);
-    if (sq->count == ECS_HTTP_SEND_QUEUE_MAX) {
-        return NULL;
-    }
-
-    /* Don't enqueue new requests if server is shutting down */
-    if (!srv->should_run) {
-        return NULL;
-    }
 
-    /* Return element at end of the queue */
-    return &sq->requests[(sq->cur + sq->count ++) % ECS_HTTP_SEND_QUEUE_MAX];
-}
-
-static
-ecs_http_send_request_t* http_send_queue_get(
-    ecs_http_server_t *srv)
-{
-    ecs_http_send_request_t *result = NULL;
-    ecs_os_mutex_lock(srv->lock);
-    ecs_http_send_queue_t *sq = &srv->send_queue;
-    if (sq->count) {
-        result = &sq->requests[sq->cur];
-        sq->cur = (sq->cur + 1) % ECS_HTTP_SEND_QUEUE_MAX;
-        sq->count --;
-    }
-    return result;
-}
-
-static
-void* http_server_send_queue(void* arg) {
-    ecs_http_server_t *srv = arg;
-    int32_t wait_ms = srv->send_queue.wait_ms;
-
-    /* Run for as long as the server is running or there are messages. When the
-     * server is stopping, no new messages will be enqueued */
-    while (srv->should_run || srv->send_queue.count) {
-        ecs_http_send_request_t* r = http_send_queue_get(srv);
-        if (!r) {
-            ecs_os_mutex_unlock(srv->lock);
-            /* If the queue is empty, wait so we don't run too fast */
-            if (srv->should_run) {
-                ecs_os_sleep(0, wait_ms);
-            }
-        } else {
-            ecs_http_socket_t sock = r->sock;
-            char *headers = r->headers;
-            int32_t headers_length = r->header_length;
-            char *content = r->content;
-            int32_t content_length = r->content_length;
-            ecs_os_mutex_unlock(srv->lock);
-
-            if (http_socket_is_valid(sock)) {
-                bool error = false;
-
-                /* Write headers */
-                ecs_size_t written = http_send(sock, headers, headers_length, 0);
-                if (written != headers_length) {
-                    ecs_err("http: failed to write HTTP response headers: %s",
-                        ecs_os_strerror(errno));
-                    ecs_os_linc(&ecs_http_send_error_count);
-                    error = true;
-                } else if (content_length >= 0) {
-                    /* Write content */
-                    written = http_send(sock, content, content_length, 0);
-                    if (written != content_length) {
-                        ecs_err("http: failed to write HTTP response body: %s",
-                            ecs_os_strerror(errno));
-                        ecs_os_linc(&ecs_http_send_error_count);
-                        error = true;
-                    }
-                }
-                if (!error) {
-                    ecs_os_linc(&ecs_http_send_ok_count);
-                }
-                http_close(&sock);
-            }
-
-            ecs_os_free(content);
-            ecs_os_free(headers);
+        if (frag->state == HttpFragStateDone) {
+            return i + 1;
         }
     }
-    return NULL;
+
+    return req_frag_len;
 }
 
 static
@@ -768,6 +1222,7 @@ void http_append_send_headers(
     const char* content_type,  
     ecs_strbuf_t *extra_headers,
     ecs_size_t content_len,
+    bool close,
     bool preflight)
 {
     ecs_strbuf_appendlit(hdrs, "HTTP/1.1 ");
@@ -782,10 +1237,14 @@ void http_append_send_headers(
         ecs_strbuf_appendlit(hdrs, "\r\n");
     }
 
-    if (content_len >= 0) {
-        ecs_strbuf_appendlit(hdrs, "Content-Length: ");
-        ecs_strbuf_append(hdrs, "%d", content_len);
-        ecs_strbuf_appendlit(hdrs, "\r\n");
+    /* Always send the length, keep-alive clients rely on it to find the end
+     * of the reply */
+    ecs_strbuf_appendlit(hdrs, "Content-Length: ");
+    ecs_strbuf_append(hdrs, "%d", content_len);
+    ecs_strbuf_appendlit(hdrs, "\r\n");
+
+    if (close) {
+        ecs_strbuf_appendlit(hdrs, "Connection: close\r\n");
     }
 
     ecs_strbuf_appendlit(hdrs, "Access-Control-Allow-Origin: *\r\n");
@@ -803,107 +1262,289 @@ void http_append_send_headers(
 }
 
 static
-void http_send_reply(
-    ecs_http_connection_impl_t* conn, 
-    ecs_http_reply_t* reply,
-    bool preflight) 
+ecs_http_send_t* http_send_from_reply(
+    uint64_t conn_id,
+    ecs_http_reply_t *reply,
+    bool close,
+    bool preflight)
 {
+    ecs_http_send_t *send = http_send_new(conn_id, close);
     ecs_strbuf_t hdrs = ECS_STRBUF_INIT;
-    char *content = ecs_strbuf_get(&reply->body);
-    int32_t content_length = reply->body.length - 1;
+    http_append_send_headers(&hdrs, reply->code, reply->status, 
+        reply->content_type, &reply->headers, 
+        ecs_strbuf_written(&reply->body), close, preflight);
+    http_send_append_strbuf(send, &hdrs);
+    http_send_append_strbuf(send, &reply->body);
+    return send;
+}
+
+/* Reply from the server thread, for requests that aren't passed to the main
+ * thread. The reply is sent when the socket is writable. */
+static
+void http_connection_reply(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int code,
+    const char *status,
+    bool close,
+    bool preflight)
+{
+    ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
+    reply.code = code;
+    reply.status = status;
+    reply.content_type = NULL;
+
+    conn->send = http_send_from_reply(conn->pub.id, &reply, close, preflight);
+    conn->state = HttpConnWriting;
+    http_connection_poll(srv, conn, HTTP_POLL_OUT);
+}
+
+static
+ecs_http_request_impl_t* http_request_new(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    ecs_http_fragment_t *frag)
+{
+    char *res = ecs_strbuf_get(&frag->buf);
+    if (!res) {
+        return NULL;
+    }
+
+    ecs_http_request_impl_t *req = ecs_os_calloc_t(ecs_http_request_impl_t);
+    req->pub.id = ++ srv->request_id;
+    req->conn = conn->pub;
+    req->close = frag->close;
+
+    req->pub.conn = &req->conn;
+    req->pub.method = frag->method;
+    req->pub.path = res + 1;
+    if (frag->body_offset) {
+        req->pub.body = &res[frag->body_offset];
+    }
+    int32_t i, count = frag->header_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.headers[i].key = &res[frag->header_offsets[i]];
+        req->pub.headers[i].value = &res[frag->header_value_offsets[i]];
+    }
+    count = frag->param_count;
+    for (i = 0; i < count; i ++) {
+        req->pub.params[i].key = &res[frag->param_offsets[i]];
+        req->pub.params[i].value = &res[frag->param_value_offsets[i]];
+        http_decode_url_str((char*)req->pub.params[i].value);
+    }
+
+    req->pub.header_count = frag->header_count;
+    req->pub.param_count = frag->param_count;
+    req->res = res;
+
+    return req;
+}
 
-    /* Use asynchronous send queue for outgoing data so send operations won't
-     * hold up main thread */
-    ecs_http_send_request_t *req = NULL;
+/* Handle a completely received request */
+static
+void http_connection_request(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    ecs_http_fragment_t *frag = &conn->frag;
+    frag->state = HttpFragStateBegin;
 
-    if (!preflight) {
-        req = http_send_queue_post(conn->pub.server);
+    if (frag->invalid) {
+        ecs_strbuf_reset(&frag->buf);
+        ecs_os_linc(&ecs_http_request_invalid_count);
+        http_connection_reply(srv, conn, 400, "Bad Request", true, false);
+    } else if (frag->method == EcsHttpOptions) {
+        ecs_strbuf_reset(&frag->buf);
+        ecs_os_linc(&ecs_http_request_preflight_count);
+        http_connection_reply(srv, conn, 200, "OK", frag->close, true);
+    } else if (srv->inflight == ECS_HTTP_QUEUE_SIZE) {
+        /* Main thread isn't keeping up */
+        ecs_strbuf_reset(&frag->buf);
+        ecs_os_linc(&ecs_http_busy_count);
+        http_connection_reply(srv, conn, 503, "Service Unavailable", 
+            frag->close, false);
+    } else {
+        ecs_http_request_impl_t *req = http_request_new(srv, conn, frag);
         if (!req) {
-            reply->code = 503; /* queue full, server is busy */
-            ecs_os_linc(&ecs_http_busy_count);
+            ecs_os_linc(&ecs_http_request_invalid_count);
+            http_connection_reply(srv, conn, 400, "Bad Request", true, false);
+            return;
         }
+
+        bool pushed = http_queue_push(&srv->requests, req);
+        ecs_assert(pushed, ECS_INTERNAL_ERROR, NULL);
+        (void)pushed;
+        srv->inflight ++;
+        conn->state = HttpConnWaiting;
+        http_connection_poll(srv, conn, HTTP_POLL_IN);
+        ecs_os_linc(&ecs_http_request_received_count);
+
+        ecs_dbg_2("http: request received from '%s:%s'", 
+            conn->pub.host, conn->pub.port);
     }
+}
 
-    http_append_send_headers(&hdrs, reply->code, reply->status, 
-        reply->content_type, &reply->headers, content_length, preflight);
-    char *headers = ecs_strbuf_get(&hdrs);
-    ecs_size_t headers_length = ecs_strbuf_written(&hdrs);
+/* Parse received data, returns true if a request was completed. Data received
+ * after the request is kept until the connection is done with the reply. */
+static
+bool http_connection_parse(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    const char *data,
+    ecs_size_t size)
+{
+    ecs_size_t parsed = http_parse_request(&conn->frag, data, size);
+    if (conn->frag.state != HttpFragStateDone) {
+        ecs_assert(parsed == size, ECS_INTERNAL_ERROR, NULL);
+        return false;
+    }
 
-    if (!req) {
-        ecs_size_t written = http_send(conn->sock, headers, headers_length, 0);
-        if (written != headers_length) {
-            ecs_err("http: failed to send reply to '%s:%s': %s",
-                conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
-            ecs_os_linc(&ecs_http_send_error_count);
-        }
-        ecs_os_free(content);
-        ecs_os_free(headers);
-        http_close(&conn->sock);
-        return;
+    if (parsed < size) {
+        char *dst = ecs_vec_grow_t(NULL, &conn->pending, char, size - parsed);
+        ecs_os_memcpy(dst, &data[parsed], size - parsed);
     }
 
-    /* Second, enqueue send request for response body */
-    req->sock = conn->sock;
-    req->headers = headers;
-    req->header_length = headers_length;
-    req->content = content;
-    req->content_length = content_length;
+    http_connection_request(srv, conn);
+    return true;
+}
+
+/* Start on the next request of a keep-alive connection */
+static
+void http_connection_resume(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    conn->state = HttpConnReading;
+    conn->last_active = srv->now;
+
+    if (ecs_vec_count(&conn->pending)) {
+        ecs_vec_t pending = conn->pending;
+        ecs_vec_init_t(NULL, &conn->pending, char, 0);
+        bool done = http_connection_parse(srv, conn, 
+            ecs_vec_first(&pending), ecs_vec_count(&pending));
+        ecs_vec_fini_t(NULL, &pending, char);
+        if (done) {
+            return;
+        }
+    }
 
-    /* Take ownership of values */
-    reply->body.content = NULL;
-    conn->sock = HTTP_SOCKET_INVALID;
+    http_connection_poll(srv, conn, HTTP_POLL_IN);
 }
 
 static
-void http_recv_request(
+void http_connection_recv(
     ecs_http_server_t *srv,
-    ecs_http_connection_impl_t *conn, 
-    uint64_t conn_id,
-    ecs_http_socket_t sock)
+    ecs_http_connection_impl_t *conn)
 {
-    ecs_size_t bytes_read;
     char recv_buf[ECS_HTTP_SEND_RECV_BUFFER_SIZE];
-    ecs_http_fragment_t frag = {0};
 
-    while ((bytes_read = http_recv(
-        sock, recv_buf, ECS_SIZEOF(recv_buf), 0)) > 0) 
-    {
-        bool is_alive = conn->pub.id == conn_id;
-        if (!is_alive) {
-            /* Connection has been purged by main thread */
+    for (;;) {
+        ecs_size_t bytes_read = http_recv(
+            conn->sock, recv_buf, ECS_SIZEOF(recv_buf), 0);
+        if (bytes_read <= 0) {
+            if (bytes_read < 0 && http_would_block()) {
+                return;
+            }
+
+            /* Connection closed by remote, or error */
+            http_connection_close(srv, conn);
             return;
         }
 
-        if (http_parse_request(&frag, recv_buf, bytes_read)) {
-            if (frag.method == EcsHttpOptions) {
-                ecs_http_reply_t reply;
-                reply.body = ECS_STRBUF_INIT;
-                reply.code = 200;
-                reply.content_type = NULL;
-                reply.headers = ECS_STRBUF_INIT;
-                reply.status = "OK";
-                http_send_reply(conn, &reply, true);
-                ecs_os_linc(&ecs_http_request_preflight_count);
-            } else {
-                http_enqueue_request(conn, conn_id, &frag);
-            }
+        conn->last_active = srv->now;
+
+        if (http_connection_parse(srv, conn, recv_buf, bytes_read)) {
             return;
-        } else {
-            ecs_os_linc(&ecs_http_request_invalid_count);
         }
+
+        if (bytes_read < ECS_SIZEOF(recv_buf)) {
+            /* Socket is drained, poll notifies when there's more */
+            return;
+        }
+    }
+}
+
+/* Send (remainder of) reply, returns false if the connection was closed */
+static
+bool http_connection_send(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn)
+{
+    ecs_http_send_t *send = conn->send;
+    ecs_http_send_buf_t *bufs = ecs_vec_first(&send->bufs);
+    int32_t count = ecs_vec_count(&send->bufs);
+
+    while (send->cur < count) {
+        ecs_size_t written = http_sendv(
+            conn->sock, &bufs[send->cur], count - send->cur, send->offset);
+        if (written < 0) {
+            if (http_would_block()) {
+                http_connection_poll(srv, conn, HTTP_POLL_OUT);
+                return true;
+            }
+
+            ecs_dbg("http: failed to send reply to '%s:%s': %s",
+                conn->pub.host, conn->pub.port, ecs_os_strerror(errno));
+            ecs_os_linc(&ecs_http_send_error_count);
+            http_connection_close(srv, conn);
+            return false;
+        }
+
+        conn->last_active = srv->now;
+
+        /* Skip buffers that were completely sent */
+        written += send->offset;
+        while (send->cur < count && written >= bufs[send->cur].length) {
+            written -= bufs[send->cur].length;
+            send->cur ++;
+        }
+        send->offset = written;
+    }
+
+    ecs_os_linc(&ecs_http_send_ok_count);
+    ecs_dbg_2("http: reply sent to '%s:%s'", conn->pub.host, conn->pub.port);
+
+    bool close = send->close;
+    http_send_free(send);
+    conn->send = NULL;
+
+    if (close) {
+        http_connection_close(srv, conn);
+        return false;
     }
 
-    /* Partial request received, cleanup resources */
-    ecs_strbuf_reset(&frag.buf);
+    http_connection_resume(srv, conn);
+    return true;
+}
 
-    /* No request was enqueued, flag connection so it'll get purged */
-    ecs_os_mutex_lock(srv->lock);
-    if (conn->pub.id == conn_id) {
-        /* Only flag connection if it was still alive */
-        conn->dequeue_timeout = ECS_HTTP_CONNECTION_PURGE_TIMEOUT;
-        conn->dequeue_retries = ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT;
+static
+void http_connection_event(
+    ecs_http_server_t *srv,
+    ecs_http_connection_impl_t *conn,
+    int32_t events)
+{
+    switch(conn->state) {
+    case HttpConnReading:
+        if (events & (HTTP_POLL_IN | HTTP_POLL_ERR)) {
+            http_connection_recv(srv, conn);
+        }
+        break;
+    case HttpConnWriting:
+        if (events & (HTTP_POLL_OUT | HTTP_POLL_ERR)) {
+            http_connection_send(srv, conn);
+        }
+        break;
+    case HttpConnWaiting:
+        if (events & HTTP_POLL_ERR) {
+            /* Reply is dropped when it arrives */
+            http_connection_close(srv, conn);
+        } else {
+            /* Client sent the next request before getting the reply. Don't
+             * read it until the reply is sent. */
+            http_connection_poll(srv, conn, 0);
+        }
+        break;
     }
-    ecs_os_mutex_unlock(srv->lock);
 }
 
 static
@@ -913,17 +1554,20 @@ void http_init_connection(
     struct sockaddr_storage *remote_addr, 
     ecs_size_t remote_addr_len) 
 {
-    http_sock_set_timeout(sock_conn, 100);
+    http_sock_nonblock(sock_conn);
+    http_sock_nodelay(sock_conn);
     http_sock_keep_alive(sock_conn);
 
     /* Create new connection */
-    ecs_os_mutex_lock(srv->lock);
     ecs_http_connection_impl_t *conn = flecs_sparse_add_t(
         &srv->connections, ecs_http_connection_impl_t);
-    uint64_t conn_id = conn->pub.id = flecs_sparse_last_id(&srv->connections);
+    ecs_os_zeromem(conn);
+    conn->pub.id = flecs_sparse_last_id(&srv->connections);
     conn->pub.server = srv;
     conn->sock = sock_conn;
-    ecs_os_mutex_unlock(srv->lock);
+    conn->state = HttpConnReading;
+    conn->last_active = srv->now;
+    ecs_vec_init_t(NULL, &conn->pending, char, 0);
 
     char *remote_host = conn->pub.host;
     char *remote_port = conn->pub.port;
@@ -938,17 +1582,95 @@ void http_init_connection(
         ecs_os_strcpy(remote_port, "unknown");
     }
 
+    if (http_poll_add(srv, sock_conn, conn->pub.id, HTTP_POLL_IN)) {
+        http_connection_close(srv, conn);
+        return;
+    }
+    conn->events = HTTP_POLL_IN;
+
     ecs_dbg_2("http: connection established from '%s:%s' (socket %u)", 
         remote_host, remote_port, sock_conn);
+}
+
+static
+void http_accept_connections(
+    ecs_http_server_t* srv)
+{
+    ecs_http_socket_t sock_conn;
+    struct sockaddr_storage remote_addr;
+    ecs_size_t remote_addr_len;
+
+    for (;;) {
+        remote_addr_len = ECS_SIZEOF(remote_addr);
+        sock_conn = http_accept(srv->sock, (struct sockaddr*) &remote_addr, 
+            &remote_addr_len);
+
+        if (!http_socket_is_valid(sock_conn)) {
+            if (!http_would_block()) {
+                ecs_dbg("http: connection attempt failed: %s", 
+                    ecs_os_strerror(errno));
+            }
+            return;
+        }
 
-    http_recv_request(srv, conn, conn_id, sock_conn);
+        http_init_connection(srv, sock_conn, &remote_addr, remote_addr_len);
+    }
+}
+
+/* Hand replies from the main thread to their connections */
+static
+void http_recv_replies(
+    ecs_http_server_t *srv)
+{
+    ecs_http_send_t *send;
+    while ((send = http_queue_pop(&srv->replies))) {
+        srv->inflight --;
+
+        ecs_http_connection_impl_t *conn = flecs_sparse_try_t(
+            &srv->connections, ecs_http_connection_impl_t, send->conn_id);
+        if (!conn || conn->state != HttpConnWaiting) {
+            /* Connection was closed while the request was handled */
+            http_send_free(send);
+            continue;
+        }
 
-    ecs_dbg_2("http: request received from '%s:%s'", 
-        remote_host, remote_port);
+        conn->send = send;
+        conn->state = HttpConnWriting;
+        http_connection_send(srv, conn);
+    }
 }
 
 static
-void http_accept_connections(
+void http_purge_connections(
+    ecs_http_server_t *srv)
+{
+    if ((srv->now - srv->purge_time) < ECS_HTTP_CONNECTION_PURGE_INTERVAL) {
+        return;
+    }
+
+    srv->purge_time = srv->now;
+
+    int32_t i, count = flecs_sparse_count(&srv->connections);
+    for (i = count - 1; i >= 1; i --) {
+        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense_t(
+            &srv->connections, ecs_http_connection_impl_t, i);
+
+        /* Don't time out connections that are waiting for the main thread. The
+         * main thread could be stalled (loading, debugger). */
+        if (conn->state == HttpConnWaiting) {
+            continue;
+        }
+
+        if ((srv->now - conn->last_active) > ECS_HTTP_CONNECTION_IDLE_TIMEOUT) {
+            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
+                conn->pub.host, conn->pub.port, conn->sock);
+            http_connection_close(srv, conn);
+        }
+    }
+}
+
+static
+int http_listen(
     ecs_http_server_t* srv, 
     const struct sockaddr* addr, 
     ecs_size_t addr_len) 
@@ -962,7 +1684,7 @@ void http_accept_connections(
         if (result) {
             ecs_warn("http: WSAStartup failed with GetLastError = %d\n", 
                 GetLastError());
-            return;
+            return -1;
         }
     } else {
         http_close(&testsocket);
@@ -973,7 +1695,6 @@ void http_accept_connections(
     char addr_host[256];
     char addr_port[20];
 
-    ecs_http_socket_t sock = HTTP_SOCKET_INVALID;
     ecs_assert(srv->sock == HTTP_SOCKET_INVALID, ECS_INTERNAL_ERROR, NULL);
 
     if (http_getnameinfo(
@@ -984,90 +1705,59 @@ void http_accept_connections(
         ecs_os_strcpy(addr_port, "unknown");
     }
 
-    ecs_os_mutex_lock(srv->lock);
-    if (srv->should_run) {
-        ecs_dbg_2("http: initializing connection socket");
-
-        sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
-        if (!http_socket_is_valid(sock)) {
-            ecs_err("http: unable to create new connection socket: %s", 
-                ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
-        }
-
-        int reuse = 1;
-        int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
-            (char*)&reuse, ECS_SIZEOF(reuse)); 
-        if (result) {
-            ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
-        }
-
-        if (addr->sa_family == AF_INET6) {
-            int ipv6only = 0;
-            if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
-                (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
-            {
-                ecs_warn("http: failed to setsockopt: %s", 
-                    ecs_os_strerror(errno));
-            }
-        }
-
-        result = http_bind(sock, addr, addr_len);
-        if (result) {
-            ecs_err("http: failed to bind to '%s:%s': %s", 
-                addr_host, addr_port, ecs_os_strerror(errno));
-            ecs_os_mutex_unlock(srv->lock);
-            goto done;
-        }
+    ecs_dbg_2("http: initializing connection socket");
 
-        http_sock_set_timeout(sock, 1000);
+    ecs_http_socket_t sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (!http_socket_is_valid(sock)) {
+        ecs_err("http: unable to create new connection socket: %s", 
+            ecs_os_strerror(errno));
+        return -1;
+    }
 
-        srv->sock = sock;
+    int reuse = 1;
+    int result = setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, 
+        (char*)&reuse, ECS_SIZEOF(reuse)); 
+    if (result) {
+        ecs_warn("http: failed to setsockopt: %s", ecs_os_strerror(errno));
+    }
 
-        result = listen(srv->sock, SOMAXCONN);
-        if (result) {
-            ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
-                SOMAXCONN, ecs_os_strerror(errno));
+    if (addr->sa_family == AF_INET6) {
+        int ipv6only = 0;
+        if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, 
+            (char*)&ipv6only, ECS_SIZEOF(ipv6only)))
+        {
+            ecs_warn("http: failed to setsockopt: %s", 
+                ecs_os_strerror(errno));
         }
-
-        ecs_trace("http: listening for incoming connections on '%s:%s'",
-            addr_host, addr_port);
-    } else {
-        ecs_dbg_2("http: server shut down while initializing");
     }
-    ecs_os_mutex_unlock(srv->lock);
-
-    ecs_http_socket_t sock_conn;
-    struct sockaddr_storage remote_addr;
-    ecs_size_t remote_addr_len;
 
-    while (srv->should_run) {
-        remote_addr_len = ECS_SIZEOF(remote_addr);
-        sock_conn = http_accept(srv->sock, (struct sockaddr*) &remote_addr, 
-            &remote_addr_len);
+    result = http_bind(sock, addr, addr_len);
+    if (result) {
+        ecs_err("http: failed to bind to '%s:%s': %s", 
+            addr_host, addr_port, ecs_os_strerror(errno));
+        http_close(&sock);
+        return -1;
+    }
 
-        if (!http_socket_is_valid(sock_conn)) {
-            if (srv->should_run) {
-                ecs_dbg("http: connection attempt failed: %s", 
-                    ecs_os_strerror(errno));
-            }
-            continue;
-        }
+    http_sock_nonblock(sock);
 
-        http_init_connection(srv, sock_conn, &remote_addr, remote_addr_len);
+    result = listen(sock, SOMAXCONN);
+    if (result) {
+        ecs_warn("http: could not listen for SOMAXCONN (%d) connections: %s", 
+            SOMAXCONN, ecs_os_strerror(errno));
     }
 
-done:
-    ecs_os_mutex_lock(srv->lock);
-    if (http_socket_is_valid(sock) && errno != EBADF) {
+    if (http_poll_add(srv, sock, HTTP_POLL_ID_LISTEN, HTTP_POLL_IN)) {
         http_close(&sock);
-        srv->sock = sock;
+        return -1;
     }
-    ecs_os_mutex_unlock(srv->lock);
 
-    ecs_trace("http: no longer accepting connections on '%s:%s'",
+    srv->sock = sock;
+
+    ecs_trace("http: listening for incoming connections on '%s:%s'",
         addr_host, addr_port);
+
+    return 0;
 }
 
 static
@@ -1084,7 +1774,48 @@ void* http_server_thread(void* arg) {
         inet_pton(AF_INET, srv->ipaddr, &(addr.sin_addr));
     }
 
-    http_accept_connections(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr));
+    if (http_listen(srv, (struct sockaddr*)&addr, ECS_SIZEOF(addr))) {
+        return NULL;
+    }
+
+    ecs_http_poll_event_t events[ECS_HTTP_POLL_EVENTS_MAX];
+    srv->now = srv->purge_time = http_time_now();
+
+    while (srv->should_run) {
+        int32_t i, count = http_poll_wait(srv, events, ECS_HTTP_POLL_TIMEOUT);
+        srv->now = http_time_now();
+
+        for (i = 0; i < count; i ++) {
+            uint64_t id = events[i].id;
+            if (id == HTTP_POLL_ID_LISTEN) {
+                http_accept_connections(srv);
+            } else if (id == HTTP_POLL_ID_WAKE) {
+                http_wake_clear(srv);
+            } else {
+                /* Connection may have been closed by an earlier event */
+                ecs_http_connection_impl_t *conn = flecs_sparse_try_t(
+                    &srv->connections, ecs_http_connection_impl_t, id);
+                if (conn) {
+                    http_connection_event(srv, conn, events[i].events);
+                }
+            }
+        }
+
+        http_recv_replies(srv);
+        http_purge_connections(srv);
+    }
+
+    /* Close all connections */
+    int32_t i, count = flecs_sparse_count(&srv->connections);
+    for (i = count - 1; i >= 1; i --) {
+        http_connection_close(srv, flecs_sparse_get_dense_t(
+            &srv->connections, ecs_http_connection_impl_t, i));
+    }
+
+    http_close(&srv->sock);
+
+    ecs_trace("http: no longer accepting connections");
+
     return NULL;
 }
 
@@ -1094,68 +1825,60 @@ void http_handle_request(
     ecs_http_request_impl_t *req)
 {
     ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
-    ecs_http_connection_impl_t *conn = 
-        (ecs_http_connection_impl_t*)req->pub.conn;
-
-    if (req->pub.method != EcsHttpOptions) {
-        if (srv->callback((ecs_http_request_t*)req, &reply, srv->ctx) == false) {
-            reply.code = 404;
-            reply.status = "Resource not found";
-            ecs_os_linc(&ecs_http_request_not_handled_count);
-        } else {
-            if (reply.code >= 400) {
-                ecs_os_linc(&ecs_http_request_handled_error_count);
-            } else {
-                ecs_os_linc(&ecs_http_request_handled_ok_count);
-            }
-        }
 
-        http_send_reply(conn, &reply, false);
-        ecs_dbg_2("http: reply sent to '%s:%s'", conn->pub.host, conn->pub.port);
+    if (srv->callback((ecs_http_request_t*)req, &reply, srv->ctx) == false) {
+        reply.code = 404;
+        reply.status = "Resource not found";
+        ecs_os_linc(&ecs_http_request_not_handled_count);
     } else {
-        /* Already taken care of */
+        if (reply.code >= 400) {
+            ecs_os_linc(&ecs_http_request_handled_error_count);
+        } else {
+            ecs_os_linc(&ecs_http_request_handled_ok_count);
+        }
     }
 
+    /* The server thread has reserved a slot for the reply when it passed the
+     * request, so the queue can't be full */
+    ecs_http_send_t *send = http_send_from_reply(
+        req->conn.id, &reply, req->close, false);
+    bool pushed = http_queue_push(&srv->replies, send);
+    ecs_assert(pushed, ECS_INTERNAL_ERROR, NULL);
+    (void)pushed;
+
     http_reply_free(&reply);
     http_request_free(req);
-    http_connection_free(conn);
 }
 
 static
 int32_t http_dequeue_requests(
     ecs_http_server_t *srv,
-    double delta_time)
+    double *time_spent)
 {
-    ecs_os_mutex_lock(srv->lock);
-
-    int32_t i, request_count = flecs_sparse_count(&srv->requests);
-    for (i = request_count - 1; i >= 1; i --) {
-        ecs_http_request_impl_t *req = flecs_sparse_get_dense_t(
-            &srv->requests, ecs_http_request_impl_t, i);
-        http_handle_request(srv, req);
+    ecs_http_request_impl_t *req = http_queue_pop(&srv->requests);
+    if (!req) {
+        return 0;
     }
 
-    int32_t connections_count = flecs_sparse_count(&srv->connections);
-    for (i = connections_count - 1; i >= 1; i --) {
-        ecs_http_connection_impl_t *conn = flecs_sparse_get_dense_t(
-            &srv->connections, ecs_http_connection_impl_t, i);
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
 
-        conn->dequeue_timeout += delta_time;
-        conn->dequeue_retries ++;
-        
-        if ((conn->dequeue_timeout > 
-            (double)ECS_HTTP_CONNECTION_PURGE_TIMEOUT) &&
-             (conn->dequeue_retries > ECS_HTTP_CONNECTION_PURGE_RETRY_COUNT)) 
-        {
-            ecs_dbg("http: purging connection '%s:%s' (sock = %d)", 
-                conn->pub.host, conn->pub.port, conn->sock);
-            http_connection_free(conn);
-        }
-    }
+    /* Limit requests per dequeue so the cost per frame stays bounded. Requests
+     * that remain are handled by the next dequeue. */
+    int32_t count = 0;
+    double elapsed = 0;
+    do {
+        http_handle_request(srv, req);
+        elapsed += ecs_time_measure(&t);
+        count ++;
+    } while (count < ECS_HTTP_DEQUEUE_MAX && 
+        elapsed < ECS_HTTP_DEQUEUE_BUDGET &&
+        (req = http_queue_pop(&srv->requests)));
 
-    ecs_os_mutex_unlock(srv->lock);
+    http_wake(srv);
 
-    return request_count - 1;
+    *time_spent = elapsed;
+    return count;
 }
 
 const char* ecs_http_get_header(
@@ -1189,7 +1912,6 @@ ecs_http_server_t* ecs_http_server_init(
         "missing OS API implementation");
 
     ecs_http_server_t* srv = ecs_os_calloc_t(ecs_http_server_t);
-    srv->lock = ecs_os_mutex_new();
     srv->sock = HTTP_SOCKET_INVALID;
 
     srv->should_run = false;
@@ -1199,17 +1921,11 @@ ecs_http_server_t* ecs_http_server_init(
     srv->ctx = desc->ctx;
     srv->port = desc->port;
     srv->ipaddr = desc->ipaddr;
-    srv->send_queue.wait_ms = desc->send_queue_wait_ms;
-    if (!srv->send_queue.wait_ms) {
-        srv->send_queue.wait_ms = 100 * 1000 * 1000;
-    }
 
     flecs_sparse_init_t(&srv->connections, NULL, NULL, ecs_http_connection_impl_t);
-    flecs_sparse_init_t(&srv->requests, NULL, NULL, ecs_http_request_impl_t);
 
     /* Start at id 1 */
     flecs_sparse_new_id(&srv->connections);
-    flecs_sparse_new_id(&srv->requests);
 
 #ifndef ECS_TARGET_WINDOWS
     /* Ignore pipe signal. SIGPIPE can occur when a message is sent to a client
@@ -1228,9 +1944,7 @@ void ecs_http_server_fini(
     if (srv->should_run) {
         ecs_http_server_stop(srv);
     }
-    ecs_os_mutex_free(srv->lock);
     flecs_sparse_fini(&srv->connections);
-    flecs_sparse_fini(&srv->requests);
     ecs_os_free(srv);
 }
 
@@ -1242,17 +1956,18 @@ int ecs_http_server_start(
     ecs_check(!srv->should_run, ECS_INVALID_PARAMETER, NULL);
     ecs_check(!srv->thread, ECS_INVALID_PARAMETER, NULL);
 
+    if (http_poll_init(srv)) {
+        goto error;
+    }
+
     srv->should_run = true;
 
     ecs_dbg("http: starting server thread");
 
     srv->thread = ecs_os_thread_new(http_server_thread, srv);
     if (!srv->thread) {
-        goto error;
-    }
-
-    srv->send_queue.thread = ecs_os_thread_new(http_server_send_queue, srv);
-    if (!srv->send_queue.thread) {
+        srv->should_run = false;
+        http_poll_fini(srv);
         goto error;
     }
 
@@ -1271,36 +1986,27 @@ void ecs_http_server_stop(
     /* Stop server thread */
     ecs_dbg("http: shutting down server thread");
 
-    ecs_os_mutex_lock(srv->lock);
     srv->should_run = false;
-    if (http_socket_is_valid(srv->sock)) {
-        http_close(&srv->sock);
-    }
-    ecs_os_mutex_unlock(srv->lock);
-
+    http_wake(srv);
     ecs_os_thread_join(srv->thread);
-    ecs_os_thread_join(srv->send_queue.thread);
-    ecs_trace("http: server threads shut down");
+    http_poll_fini(srv);
+    ecs_trace("http: server thread shut down");
 
-    /* Cleanup all outstanding requests */
-    int i, count = flecs_sparse_count(&srv->requests);
-    for (i = count - 1; i >= 1; i --) {
-        http_request_free(flecs_sparse_get_dense_t(
-            &srv->requests, ecs_http_request_impl_t, i));
+    /* Cleanup all outstanding requests and replies */
+    ecs_http_request_impl_t *req;
+    while ((req = http_queue_pop(&srv->requests))) {
+        http_request_free(req);
     }
 
-    /* Close all connections */
-    count = flecs_sparse_count(&srv->connections);
-    for (i = count - 1; i >= 1; i --) {
-        http_connection_free(flecs_sparse_get_dense_t(
-            &srv->connections, ecs_http_connection_impl_t, i));
+    ecs_http_send_t *send;
+    while ((send = http_queue_pop(&srv->replies))) {
+        http_send_free(send);
     }
 
     ecs_assert(flecs_sparse_count(&srv->connections) == 1, 
         ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(flecs_sparse_count(&srv->requests) == 1,
-        ECS_INTERNAL_ERROR, NULL);
 
+    srv->inflight = 0;
     srv->thread = 0;
 error:
     return;
@@ -1314,22 +2020,15 @@ void ecs_http_server_dequeue(
     ecs_check(srv->initialized, ECS_INVALID_PARAMETER, NULL);
     ecs_check(srv->should_run, ECS_INVALID_PARAMETER, NULL);
     
-    srv->dequeue_timeout += (double)delta_time;
     srv->stats_timeout += (double)delta_time;
 
-    if ((1000 * srv->dequeue_timeout) > (double)ECS_HTTP_MIN_DEQUEUE_INTERVAL) {
-        srv->dequeue_timeout = 0;
-
-        ecs_time_t t = {0};
-        ecs_time_measure(&t);
-        int32_t request_count = http_dequeue_requests(srv, srv->dequeue_timeout);
-        srv->requests_processed += request_count;
-        srv->requests_processed_total += request_count;
-        double time_spent = ecs_time_measure(&t);
-        srv->request_time += time_spent;
-        srv->request_time_total += time_spent;
-        srv->dequeue_count ++;
-    }
+    double time_spent = 0;
+    int32_t request_count = http_dequeue_requests(srv, &time_spent);
+    srv->requests_processed += request_count;
+    srv->requests_processed_total += request_count;
+    srv->request_time += time_spent;
+    srv->request_time_total += time_spent;
+    srv->dequeue_count ++;
 
     if ((1000 * srv->stats_timeout) > (double)ECS_HTTP_MIN_STATS_INTERVAL) {
         srv->stats_timeout = 0;
@@ -1,12 +1,131 @@
 /**
  * @file addons/journal.c
  * @brief Journal addon.
+ *
+ * The binary journal is a ring of records in a file. Records are aligned to 8
+ * bytes and never wrap around the end of the ring, a pad record fills the space
+ * that is left. The file header stores the total number of bytes written (head)
+ * and the offset of the oldest record that has not been overwritten (tail), so
+ * a reader can find the first complete record.
+ *
+ * Records are appended to a buffer of FLECS_JOURNAL_FLUSH_SIZE bytes, which
+ * is written to the file at the end of every frame, when it is full and when
+ * the journal is closed. The buffer is reused after it is written, so that
+ * recording only touches memory that is already mapped and in the cache.
+ * Keeping a copy of the whole ring in memory instead page faulted on every new
+ * page, and writing through a shared mapping did the same for the file.
+ *
+ * Old records are not read back when the ring is full. The tail moves to a
+ * checkpoint, which is the head of an earlier flush, so a few records more
+ * than necessary can be dropped.
+ *
+ * Commit, Set and Delete records hold a range of entities. When the same
+ * operation is done on another entity right after, the entity (and value) is
+ * appended to the last record instead of writing a new one. Merging a burst of
+ * spawned entities then writes one record per id instead of one per entity.
+ * Values that are assigned to the entities of the last commit are written as
+ * one array, without the entities, which is most of the data of a burst.
+ *
+ * Entities are recorded as their id. The first time a named entity or a
+ * component is referenced, a declare record with its path and size is written
+ * so a replay can find it in another world. The writer remembers where each
+ * declare record is. When it is behind the tail or the entity is renamed, the
+ * entity is declared again the next time it is used.
  */
 
 #include "../private_api.h"
 
 #ifdef FLECS_JOURNAL
 
+#ifdef ECS_TARGET_WINDOWS
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define FLECS_JOURNAL_MAGIC "FLJR"
+#define FLECS_JOURNAL_VERSION (3)
+#define FLECS_JOURNAL_FLUSH_SIZE (1024 * 1024)
+#define FLECS_JOURNAL_RANGE_MAX (64 * 1024)
+#define FLECS_JOURNAL_CHECKPOINT_COUNT (1024)
+
+/* The entity of a record is the first entity of a range, the payload ends with
+ * the other entities. Set records repeat (entity, value) for each of them. */
+typedef enum {
+    EcsJournalOpPad,
+    EcsJournalOpDeclare,   /* payload: u32 size, path */
+    EcsJournalOpCommit,    /* payload: u32 add count, u32 remove count, ids,
+                            *          entities */
+    EcsJournalOpSet,       /* payload: u32 value size, u32 0, value, 
+                            *          (entity, value)... 
+                            * values are aligned to 8, empty if not copyable */
+    EcsJournalOpName,      /* payload: name */
+    EcsJournalOpClear,
+    EcsJournalOpDelete,    /* payload: entities */
+    EcsJournalOpDeleteWith,
+    EcsJournalOpRemoveAll,
+    EcsJournalOpSetValues  /* payload: u32 value size, u32 count, values
+                            * values are for the last count entities of the
+                            * last Commit record and are not aligned */
+} ecs_journal_op_t;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t capacity;      /* Size of the ring */
+    uint64_t head;          /* Total number of bytes written */
+    uint64_t tail;          /* Total offset of oldest record */
+    uint64_t record_count;  /* Number of records written */
+    uint64_t reserved[3];
+} ecs_journal_header_t;
+
+typedef struct {
+    uint8_t op;
+    uint8_t reserved;
+    uint16_t alignment;     /* Alignment of value (Declare, Set) */
+    uint32_t size;          /* Size of record including header */
+    uint64_t entity;
+    uint64_t id;
+} ecs_journal_record_t;
+
+struct ecs_journal_writer_t {
+    ecs_journal_header_t header;
+    char *buf;              /* Records since the last flush */
+    uint64_t buf_size;
+    uint64_t capacity;
+    uint64_t offset;        /* Offset of head in the ring */
+    uint64_t range_limit;   /* Max size of a record that entities are added to */
+    uint64_t flushed;       /* Value of head when the file was last written */
+    bool failed;            /* Writing the file failed, stop recording */
+    ecs_journal_record_t *range; /* Last record, if entities can be added */
+    ecs_journal_record_t *commit; /* Last Commit record, if not written yet */
+    ecs_map_t declared;     /* Offset of declare record + 1, by entity */
+    uint64_t declared_lo[ECS_HI_COMPONENT_ID]; /* Same, for component ids */
+
+    /* Heads of earlier flushes, which the tail can move to */
+    uint64_t checkpoints[FLECS_JOURNAL_CHECKPOINT_COUNT];
+    int32_t checkpoint_first;
+    int32_t checkpoint_count;
+#ifdef ECS_TARGET_WINDOWS
+    HANDLE file;
+#else
+    int fd;
+#endif
+};
+
+/* Builtin ids are the same in every world and are never declared */
+static
+bool flecs_journal_is_builtin(
+    uint32_t index)
+{
+    return index < EcsFirstUserComponentId || 
+        (index >= ECS_HI_COMPONENT_ID && index < EcsFirstUserEntityId);
+}
+
 static
 char* flecs_journal_entitystr(
     ecs_world_t *world,
@@ -17,7 +136,7 @@ char* flecs_journal_entitystr(
     if (_path && !strchr(_path, '.')) {
         path = ecs_asprintf("#[blue]%s", _path);
     } else {
-        uint32_t gen = entity >> 32;
+        uint32_t gen = (uint32_t)ECS_GENERATION(entity);
         if (gen) {
             path = ecs_asprintf("#[normal]_%u_%u", (uint32_t)entity, gen);
         } else {
@@ -49,6 +168,472 @@ char* flecs_journal_idstr(
     }
 }
 
+static
+int flecs_journal_write_file(
+    ecs_journal_writer_t *j,
+    uint64_t offset,
+    const void *data,
+    size_t size)
+{
+#ifdef ECS_TARGET_WINDOWS
+    while (size) {
+        DWORD written = 0;
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        OVERLAPPED ov = {0};
+        ov.Offset = (DWORD)offset;
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+        if (!WriteFile(j->file, data, chunk, &written, &ov) || !written) {
+            return -1;
+        }
+        data = ECS_OFFSET(data, written);
+        offset += written;
+        size -= written;
+    }
+#else
+    while (size) {
+        ssize_t written = pwrite(j->fd, data, size, (off_t)offset);
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data = ECS_OFFSET(data, written);
+        offset += (uint64_t)written;
+        size -= (size_t)written;
+    }
+#endif
+    return 0;
+}
+
+/* Write the records appended since the last flush, then the header */
+static
+int flecs_journal_flush(
+    ecs_journal_writer_t *j)
+{
+    ecs_journal_header_t *hdr = &j->header;
+    if (j->failed) {
+        return -1;
+    }
+
+    /* Records don't wrap around the end of the ring, but the buffer can */
+    uint64_t offset = j->flushed;
+    const char *data = j->buf;
+    while (offset < hdr->head) {
+        uint64_t start = offset % j->capacity;
+        uint64_t size = hdr->head - offset;
+        if (size > (j->capacity - start)) {
+            size = j->capacity - start;
+        }
+        if (flecs_journal_write_file(j, 
+            (uint64_t)ECS_SIZEOF(ecs_journal_header_t) + start, 
+            data, (size_t)size)) 
+        {
+            goto error;
+        }
+        data += size;
+        offset += size;
+    }
+
+    if (flecs_journal_write_file(j, 0, hdr, 
+        (size_t)ECS_SIZEOF(ecs_journal_header_t))) 
+    {
+        goto error;
+    }
+
+    /* The file has the record as it is now, so it can't grow anymore. Values
+     * can't refer to a commit that may be dropped before them. */
+    j->range = NULL;
+    j->commit = NULL;
+
+    /* Keep checkpoints spread out over the ring */
+    int32_t count = j->checkpoint_count;
+    uint64_t last = count ? j->checkpoints[(j->checkpoint_first + count - 1) % 
+        FLECS_JOURNAL_CHECKPOINT_COUNT] : hdr->tail;
+    if (count < FLECS_JOURNAL_CHECKPOINT_COUNT && 
+        (hdr->head - last) >= (j->capacity / FLECS_JOURNAL_CHECKPOINT_COUNT)) 
+    {
+        j->checkpoints[(j->checkpoint_first + count) % 
+            FLECS_JOURNAL_CHECKPOINT_COUNT] = hdr->head;
+        j->checkpoint_count ++;
+    }
+
+    j->flushed = hdr->head;
+    return 0;
+error:
+    ecs_err("journal: failed to write: %s", ecs_os_strerror(errno));
+    j->failed = true;
+    return -1;
+}
+
+/* Move the tail to the first checkpoint that leaves room for size bytes. The
+ * buffer is at most half the ring, so the last flush is always far enough. */
+static
+void flecs_journal_make_room(
+    ecs_journal_writer_t *j,
+    uint64_t size)
+{
+    ecs_journal_header_t *hdr = &j->header;
+    uint64_t tail = hdr->head + size - j->capacity;
+    if ((hdr->head + size) <= j->capacity || tail <= hdr->tail) {
+        return;
+    }
+
+    while (j->checkpoint_count) {
+        uint64_t checkpoint = j->checkpoints[j->checkpoint_first];
+        j->checkpoint_first = (j->checkpoint_first + 1) % 
+            FLECS_JOURNAL_CHECKPOINT_COUNT;
+        j->checkpoint_count --;
+        if (checkpoint >= tail) {
+            hdr->tail = checkpoint;
+            return;
+        }
+    }
+
+    ecs_assert(j->flushed >= tail, ECS_INTERNAL_ERROR, NULL);
+    hdr->tail = j->flushed;
+}
+
+/* Move the head, records end before or at the end of the ring */
+static
+void flecs_journal_advance(
+    ecs_journal_writer_t *j,
+    uint64_t size)
+{
+    j->header.head += size;
+    j->offset += size;
+    if (j->offset == j->capacity) {
+        j->offset = 0;
+    }
+}
+
+static
+void* flecs_journal_append(
+    ecs_journal_writer_t *j,
+    ecs_journal_op_t op,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    ecs_size_t payload_size)
+{
+    ecs_assert(payload_size >= 0, ECS_INVALID_PARAMETER, NULL);
+    uint64_t size = (uint64_t)ECS_ALIGN(
+        (size_t)(ECS_SIZEOF(ecs_journal_record_t) + payload_size), 8);
+    if (j->failed || size > j->buf_size) {
+        return NULL;
+    }
+
+    ecs_journal_header_t *hdr = &j->header;
+    if ((hdr->head - j->flushed + size) > j->buf_size) {
+        /* Only complete records are flushed, so not after the append */
+        if (flecs_journal_flush(j)) {
+            return NULL;
+        }
+    }
+
+    /* The pad is written by itself, so it doesn't take up the buffer */
+    uint64_t remaining = j->capacity - j->offset;
+    if (remaining < size) {
+        if (flecs_journal_flush(j)) {
+            return NULL;
+        }
+        flecs_journal_make_room(j, remaining);
+        ecs_journal_record_t pad = { .op = EcsJournalOpPad, 
+            .size = (uint32_t)remaining };
+        if (flecs_journal_write_file(j, (uint64_t)ECS_SIZEOF(
+            ecs_journal_header_t) + j->offset, &pad, 
+                (size_t)(remaining < ECS_SIZEOF(pad) ? 
+                    remaining : ECS_SIZEOF(pad))))
+        {
+            ecs_err("journal: failed to write: %s", ecs_os_strerror(errno));
+            j->failed = true;
+            return NULL;
+        }
+        flecs_journal_advance(j, remaining);
+        j->flushed = hdr->head;
+    }
+
+    flecs_journal_make_room(j, size);
+    ecs_journal_record_t *r = ECS_CAST(ecs_journal_record_t*, 
+        &j->buf[hdr->head - j->flushed]);
+    r->op = (uint8_t)op;
+    r->reserved = 0;
+    r->alignment = 0;
+    r->size = (uint32_t)size;
+    r->entity = entity;
+    r->id = id;
+    flecs_journal_advance(j, size);
+    hdr->record_count ++;
+    j->range = NULL;
+    return ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+}
+
+/* Number of entities after the first in a range record, given where they
+ * start and the size of the value that follows each entity */
+static
+int32_t flecs_journal_range_count(
+    const ecs_journal_record_t *r,
+    const void *elems,
+    ecs_size_t value_size)
+{
+    uintptr_t start = (uintptr_t)elems - (uintptr_t)r;
+    return (int32_t)(((uintptr_t)r->size - start) / 
+        (uintptr_t)(ECS_SIZEOF(uint64_t) + value_size));
+}
+
+/* Number of bytes that can be appended to the last record */
+static
+uint64_t flecs_journal_range_max(
+    ecs_journal_writer_t *j)
+{
+    ecs_journal_record_t *r = j->range;
+    if (!r || !j->offset || r->size >= j->range_limit) {
+        return 0;
+    }
+
+    /* The record is at the end of the ring and can't wrap around */
+    uint64_t space = j->range_limit - r->size;
+    if (space > (j->capacity - j->offset)) {
+        space = j->capacity - j->offset;
+    }
+    uint64_t buffered = j->header.head - j->flushed;
+    if (space > (j->buf_size - buffered)) {
+        space = j->buf_size - buffered;
+    }
+    return space;
+}
+
+/* Number of elements that can be appended to the last record */
+static
+int32_t flecs_journal_range_space(
+    ecs_journal_writer_t *j,
+    ecs_size_t elem_size)
+{
+    return (int32_t)(flecs_journal_range_max(j) / (uint64_t)elem_size);
+}
+
+/* Grow the last record by size bytes, if it is a range that can grow */
+static
+void* flecs_journal_extend(
+    ecs_journal_writer_t *j,
+    ecs_journal_op_t op,
+    ecs_id_t id,
+    ecs_size_t size)
+{
+    ecs_journal_record_t *r = j->range;
+    if (!r || r->op != op || r->id != id) {
+        return NULL;
+    }
+
+    uint64_t grow = (uint64_t)size;
+    if (flecs_journal_range_max(j) < grow) {
+        return NULL;
+    }
+
+    ecs_journal_header_t *hdr = &j->header;
+    void *result = &j->buf[hdr->head - j->flushed];
+    flecs_journal_make_room(j, grow);
+    r->size += (uint32_t)grow;
+    flecs_journal_advance(j, grow);
+    return result;
+}
+
+/* Component ids are in an array, other entities in the map */
+static
+uint64_t* flecs_journal_declared(
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity)
+{
+    if (entity < ECS_HI_COMPONENT_ID) {
+        return &j->declared_lo[entity];
+    }
+    return ecs_map_ensure(&j->declared, entity);
+}
+
+static
+void flecs_journal_undeclare(
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity)
+{
+    if (entity < ECS_HI_COMPONENT_ID) {
+        j->declared_lo[entity] = 0;
+    } else {
+        ecs_map_remove(&j->declared, entity);
+    }
+}
+
+static
+void flecs_journal_declare(
+    ecs_world_t *world,
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity)
+{
+    if (!entity || flecs_journal_is_builtin((uint32_t)entity)) {
+        return;
+    }
+
+    /* Components are declared for almost every record, so check those before
+     * looking up the entity */
+    if (entity < ECS_HI_COMPONENT_ID && 
+        j->declared_lo[entity] > j->header.tail) 
+    {
+        return;
+    }
+
+    /* Unnamed entities are created on replay when they're first used. Check
+     * the table flags first, so most entities don't need a map lookup. */
+    ecs_record_t *record = flecs_entities_try(world, entity);
+    if (!record || !record->table || !(record->table->flags & 
+        (EcsTableHasName | EcsTableHasBuiltins))) 
+    {
+        return;
+    }
+
+    /* Declared if the record is still in the ring */
+    uint64_t *declared = flecs_journal_declared(j, entity);
+    if (*declared > j->header.tail) {
+        return;
+    }
+
+    const char *name = ecs_get_name(world, entity);
+    const ecs_type_info_t *ti = flecs_type_info_get(world, entity);
+    if (!name && !ti) {
+        *declared = UINT64_MAX;
+        return;
+    }
+
+    char *path = name ? ecs_get_fullpath(world, entity) : NULL;
+    ecs_size_t len = path ? ecs_os_strlen(path) : 0;
+    uint32_t *payload = flecs_journal_append(j, EcsJournalOpDeclare, 
+        entity, 0, ECS_SIZEOF(uint32_t) + len + 1);
+    if (payload) {
+        ecs_journal_record_t *r = ECS_OFFSET(payload, 
+            -ECS_SIZEOF(ecs_journal_record_t));
+        payload[0] = ti ? (uint32_t)ti->size : 0;
+        r->alignment = ti ? (uint16_t)ti->alignment : 0;
+        char *str = ECS_OFFSET(payload, ECS_SIZEOF(uint32_t));
+        if (len) {
+            ecs_os_memcpy(str, path, len);
+        }
+        str[len] = '\0';
+        *flecs_journal_declared(j, entity) = j->header.head - r->size + 1;
+    }
+    ecs_os_free(path);
+}
+
+static
+void flecs_journal_declare_id(
+    ecs_world_t *world,
+    ecs_journal_writer_t *j,
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        flecs_journal_declare(world, j, ecs_pair_first(world, id));
+        flecs_journal_declare(world, j, ecs_pair_second(world, id));
+    } else {
+        flecs_journal_declare(world, j, id & ECS_COMPONENT_MASK);
+    }
+}
+
+static
+void flecs_journal_write(
+    ecs_world_t *world,
+    ecs_journal_writer_t *j,
+    ecs_journal_kind_t kind,
+    ecs_entity_t entity,
+    ecs_type_t *add,
+    ecs_type_t *remove)
+{
+    if (kind == EcsJournalMove) {
+        int32_t i, add_count = add ? add->count : 0;
+        int32_t remove_count = remove ? remove->count : 0;
+        if (!add_count && !remove_count) {
+            return;
+        }
+
+        flecs_journal_declare(world, j, entity);
+
+        /* Same ids as the last commit, add the entity to its range */
+        ecs_journal_record_t *range = j->range;
+        if (range && range->op == EcsJournalOpCommit) {
+            const uint32_t *counts = ECS_OFFSET(range, 
+                ECS_SIZEOF(ecs_journal_record_t));
+            const ecs_id_t *ids = ECS_OFFSET(counts, 
+                2 * ECS_SIZEOF(uint32_t));
+            if (counts[0] == (uint32_t)add_count && 
+                counts[1] == (uint32_t)remove_count &&
+                (!add_count || !ecs_os_memcmp(ids, add->array, 
+                    add_count * ECS_SIZEOF(ecs_id_t))) &&
+                (!remove_count || !ecs_os_memcmp(&ids[add_count], 
+                    remove->array, remove_count * ECS_SIZEOF(ecs_id_t))))
+            {
+                ecs_entity_t *e = flecs_journal_extend(j, EcsJournalOpCommit, 
+                    0, ECS_SIZEOF(ecs_entity_t));
+                if (e) {
+                    *e = entity;
+                    return;
+                }
+            }
+        }
+
+        for (i = 0; i < add_count; i ++) {
+            flecs_journal_declare_id(world, j, add->array[i]);
+        }
+        for (i = 0; i < remove_count; i ++) {
+            flecs_journal_declare_id(world, j, remove->array[i]);
+        }
+
+        uint32_t *payload = flecs_journal_append(j, EcsJournalOpCommit, 
+            entity, 0, 2 * ECS_SIZEOF(uint32_t) + 
+                (add_count + remove_count) * ECS_SIZEOF(ecs_id_t));
+        if (payload) {
+            payload[0] = (uint32_t)add_count;
+            payload[1] = (uint32_t)remove_count;
+            ecs_id_t *ids = ECS_OFFSET(payload, 2 * ECS_SIZEOF(uint32_t));
+            if (add_count) {
+                ecs_os_memcpy_n(ids, add->array, ecs_id_t, add_count);
+            }
+            if (remove_count) {
+                ecs_os_memcpy_n(&ids[add_count], remove->array, ecs_id_t, 
+                    remove_count);
+            }
+            j->range = j->commit = ECS_OFFSET(payload, 
+                -ECS_SIZEOF(ecs_journal_record_t));
+        }
+    } else if (kind == EcsJournalClear) {
+        flecs_journal_append(j, EcsJournalOpClear, entity, 0, 0);
+    } else if (kind == EcsJournalDelete) {
+        /* Entities that never had components don't exist on replay */
+        ecs_record_t *record = flecs_entities_try(world, entity);
+        if (!record || !record->table) {
+            return;
+        }
+
+        /* Only entities with a name or builtin component were declared */
+        if (record->table->flags & (EcsTableHasName | EcsTableHasBuiltins)) {
+            flecs_journal_undeclare(j, entity);
+        }
+
+        ecs_entity_t *e = flecs_journal_extend(j, EcsJournalOpDelete, 0, 
+            ECS_SIZEOF(ecs_entity_t));
+        if (e) {
+            *e = entity;
+            return;
+        }
+
+        void *payload = flecs_journal_append(
+            j, EcsJournalOpDelete, entity, 0, 0);
+        if (payload) {
+            j->range = ECS_OFFSET(payload, -ECS_SIZEOF(ecs_journal_record_t));
+        }
+    } else if (kind == EcsJournalDeleteWith) {
+        flecs_journal_declare_id(world, j, entity);
+        flecs_journal_append(j, EcsJournalOpDeleteWith, 0, entity, 0);
+    } else if (kind == EcsJournalRemoveAll) {
+        flecs_journal_declare_id(world, j, entity);
+        flecs_journal_append(j, EcsJournalOpRemoveAll, 0, entity, 0);
+    }
+}
+
 static int flecs_journal_sp = 0;
 
 void flecs_journal_begin(
@@ -60,6 +645,12 @@ void flecs_journal_begin(
 {
     flecs_journal_sp ++;
 
+    /* New ids can be created from stages, which are not recorded. Entities
+     * are created on replay when they are first used. */
+    if (kind != EcsJournalNew && world->journal) {
+        flecs_journal_write(world, world->journal, kind, entity, add, remove);
+    }
+
     if (ecs_os_api.log_level_ < FLECS_JOURNAL_LOG_LEVEL) {
         return;
     }
@@ -128,4 +719,808 @@ void flecs_journal_end(void) {
     ecs_log_pop();
 }
 
+/* Append a value to the last Set record if it's for the same id, or write a
+ * new record. The entity and id must have been declared. */
+static
+void flecs_journal_write_set(
+    ecs_journal_writer_t *j,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    const ecs_type_info_t *ti,
+    const void *ptr)
+{
+    /* Values with a copy hook can own resources, replay just adds those */
+    ecs_size_t size = ti->hooks.copy ? 0 : ti->size;
+    ecs_size_t aligned = ECS_ALIGN(size, 8);
+
+    uint64_t *elem = flecs_journal_extend(j, EcsJournalOpSet, id, 
+        ECS_SIZEOF(ecs_entity_t) + aligned);
+    if (elem) {
+        elem[0] = entity;
+        if (size) {
+            ecs_os_memcpy(&elem[1], ptr, size);
+        }
+        return;
+    }
+
+    uint32_t *payload = flecs_journal_append(j, EcsJournalOpSet, entity, id, 
+        2 * ECS_SIZEOF(uint32_t) + aligned);
+    if (payload) {
+        ecs_journal_record_t *r = ECS_OFFSET(payload, 
+            -ECS_SIZEOF(ecs_journal_record_t));
+        r->alignment = (uint16_t)ti->alignment;
+        payload[0] = (uint32_t)size;
+        payload[1] = 0;
+        if (size) {
+            ecs_os_memcpy(&payload[2], ptr, size);
+        }
+        j->range = r;
+    }
+}
+
+/* Write the values of entities that were just committed without repeating the
+ * entities. Returns false if the entities aren't the last of the commit. */
+static
+bool flecs_journal_write_values(
+    ecs_journal_writer_t *j,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    ecs_size_t size,
+    const void *ptr)
+{
+    ecs_journal_record_t *c = j->commit;
+    if (!c) {
+        return false;
+    }
+
+    const uint32_t *counts = ECS_OFFSET(c, ECS_SIZEOF(ecs_journal_record_t));
+    const uint64_t *committed = ECS_OFFSET(counts, 2 * ECS_SIZEOF(uint32_t) +
+        (int32_t)(counts[0] + counts[1]) * ECS_SIZEOF(ecs_id_t));
+    int32_t skip = 1 + flecs_journal_range_count(c, committed, 0) - count;
+    if (skip < 0) {
+        return false;
+    }
+    if (!skip) {
+        if (entities[0] != c->entity || (count > 1 && ecs_os_memcmp(
+            committed, &entities[1], (count - 1) * ECS_SIZEOF(uint64_t)))) 
+        {
+            return false;
+        }
+    } else if (ecs_os_memcmp(&committed[skip - 1], entities, 
+        count * ECS_SIZEOF(uint64_t))) 
+    {
+        return false;
+    }
+
+    /* The commit must still be in the buffer after the append */
+    ecs_size_t payload_size = 2 * ECS_SIZEOF(uint32_t) + count * size;
+    uint64_t record_size = (uint64_t)ECS_ALIGN(
+        (size_t)(ECS_SIZEOF(ecs_journal_record_t) + payload_size), 8);
+    if ((j->header.head - j->flushed + record_size) > j->buf_size ||
+        (j->capacity - j->offset) < record_size)
+    {
+        return false;
+    }
+
+    uint32_t *payload = flecs_journal_append(j, EcsJournalOpSetValues, 0, id,
+        payload_size);
+    if (payload) {
+        payload[0] = (uint32_t)size;
+        payload[1] = (uint32_t)count;
+        if (size) {
+            ecs_os_memcpy(&payload[2], ptr, count * size);
+        }
+    }
+    return true;
+}
+
+void flecs_journal_set(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_journal_writer_t *j = world->journal;
+    if (!j) {
+        return;
+    }
+
+    const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+    const void *ptr = ecs_get_id(world, entity, id);
+    if (!ti || !ptr) {
+        return;
+    }
+
+    flecs_journal_declare(world, j, entity);
+
+    if (id == ecs_pair(ecs_id(EcsIdentifier), EcsName)) {
+        const char *name = ((const EcsIdentifier*)ptr)->value;
+        ecs_size_t len = name ? ecs_os_strlen(name) : 0;
+        char *str = flecs_journal_append(j, EcsJournalOpName, entity, 0, 
+            len + 1);
+        if (str) {
+            if (len) {
+                ecs_os_memcpy(str, name, len);
+            }
+            str[len] = '\0';
+        }
+
+        /* Declare the entity with its new path when it's used again, so the
+         * name survives the Name record being overwritten */
+        flecs_journal_undeclare(j, entity);
+        return;
+    }
+
+    ecs_journal_record_t *range = j->range;
+    if (!range || range->op != EcsJournalOpSet || range->id != id) {
+        flecs_journal_declare_id(world, j, id);
+    }
+
+    flecs_journal_write_set(j, entity, id, ti, ptr);
+}
+
+void flecs_journal_set_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t row,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_journal_writer_t *j = world->journal;
+    if (!j || !count) {
+        return;
+    }
+
+    ecs_assert(table->storage_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    const ecs_table_record_t *tr = flecs_table_record_get(
+        world, table->storage_table, id);
+    if (!tr || id == ecs_pair(ecs_id(EcsIdentifier), EcsName)) {
+        /* Names are recorded one at a time */
+        int32_t i;
+        ecs_entity_t *entities = ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, row);
+        for (i = 0; i < count; i ++) {
+            flecs_journal_set(world, entities[i], id);
+        }
+        return;
+    }
+
+    const ecs_type_info_t *ti = table->type_info[tr->column];
+    const ecs_entity_t *entities = ecs_vec_get_t(
+        &table->data.entities, ecs_entity_t, row);
+    const void *ptr = ecs_vec_get(
+        &table->data.columns[tr->column], ti->size, row);
+
+    ecs_size_t size = ti->hooks.copy ? 0 : ti->size;
+
+    /* The entities were declared by the commit */
+    flecs_journal_declare_id(world, j, id);
+    if (flecs_journal_write_values(j, entities, count, id, size, ptr)) {
+        return;
+    }
+
+    /* Check the table once instead of looking up each entity */
+    bool declare = (table->flags & (EcsTableHasName | EcsTableHasBuiltins)) 
+        != 0;
+    ecs_size_t elem_size = ECS_SIZEOF(ecs_entity_t) + ECS_ALIGN(size, 8);
+
+    int32_t i = 0;
+    while (i < count) {
+        if (declare) {
+            flecs_journal_declare(world, j, entities[i]);
+        }
+
+        ecs_journal_record_t *range = j->range;
+        if (!range || range->op != EcsJournalOpSet || range->id != id) {
+            flecs_journal_declare_id(world, j, id);
+            flecs_journal_write_set(j, entities[i], id, ti, ptr);
+            ptr = ECS_OFFSET(ptr, ti->size);
+            i ++;
+            continue;
+        }
+
+        /* Append as many values as fit in the range in one go */
+        int32_t n = declare ? 1 : flecs_journal_range_space(j, elem_size);
+        if (n > (count - i)) {
+            n = count - i;
+        }
+        uint64_t *elem = NULL;
+        if (n) {
+            elem = flecs_journal_extend(j, EcsJournalOpSet, id, n * elem_size);
+        }
+        if (!elem) {
+            j->range = NULL;
+            continue;
+        }
+
+        int32_t last = i + n;
+        for (; i < last; i ++) {
+            elem[0] = entities[i];
+            if (size) {
+                ecs_os_memcpy(&elem[1], ptr, size);
+            }
+            elem = ECS_OFFSET(elem, elem_size);
+            ptr = ECS_OFFSET(ptr, ti->size);
+        }
+    }
+}
+
+static
+void flecs_journal_close_file(
+    ecs_journal_writer_t *j)
+{
+#ifdef ECS_TARGET_WINDOWS
+    if (j->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(j->file);
+    }
+#else
+    if (j->fd != -1) {
+        close(j->fd);
+    }
+#endif
+}
+
+int ecs_journal_open(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_size_t size)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(filename != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_journal_close(world);
+
+    if (!size) {
+        size = ECS_JOURNAL_DEFAULT_SIZE;
+    }
+
+    ecs_journal_writer_t *j = ecs_os_calloc_t(ecs_journal_writer_t);
+    j->capacity = (uint64_t)ECS_ALIGN(size, 8);
+    uint64_t file_size = (uint64_t)ECS_SIZEOF(ecs_journal_header_t) + 
+        j->capacity;
+
+    /* The file has its full size from the start, so a reader can load the
+     * ring in one go, even if it hasn't been filled yet. */
+#ifdef ECS_TARGET_WINDOWS
+    j->file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 
+        FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (j->file == INVALID_HANDLE_VALUE) {
+        goto error_open;
+    }
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)file_size;
+    if (!SetFilePointerEx(j->file, end, NULL, FILE_BEGIN) || 
+        !SetEndOfFile(j->file)) 
+    {
+        goto error_open;
+    }
+#else
+    j->fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (j->fd == -1) {
+        goto error_open;
+    }
+    if (ftruncate(j->fd, (off_t)file_size) != 0) {
+        goto error_open;
+    }
+#endif
+
+    j->range_limit = j->capacity / 4;
+    if (j->range_limit > FLECS_JOURNAL_RANGE_MAX) {
+        j->range_limit = FLECS_JOURNAL_RANGE_MAX;
+    }
+
+    j->buf_size = j->capacity / 2;
+    if (j->buf_size > FLECS_JOURNAL_FLUSH_SIZE) {
+        j->buf_size = FLECS_JOURNAL_FLUSH_SIZE;
+    }
+    j->buf = ecs_os_malloc((ecs_size_t)j->buf_size);
+    if (!j->buf) {
+        goto error_open;
+    }
+
+    ecs_os_memcpy(j->header.magic, FLECS_JOURNAL_MAGIC, 4);
+    j->header.version = FLECS_JOURNAL_VERSION;
+    j->header.capacity = j->capacity;
+    if (flecs_journal_flush(j)) {
+        ecs_os_free(j->buf);
+        flecs_journal_close_file(j);
+        ecs_os_free(j);
+        return -1;
+    }
+
+    ecs_map_init(&j->declared, NULL);
+
+    world->journal = j;
+    return 0;
+error_open:
+    ecs_err("journal: failed to open '%s': %s", filename, 
+        ecs_os_strerror(errno));
+    flecs_journal_close_file(j);
+    ecs_os_free(j);
+error:
+    return -1;
+}
+
+int ecs_journal_flush(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_journal_writer_t *j = world->journal;
+    if (!j) {
+        return 0;
+    }
+    return flecs_journal_flush(j);
+}
+
+void ecs_journal_close(
+    ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_journal_writer_t *j = world->journal;
+    if (j) {
+        flecs_journal_flush(j);
+        flecs_journal_close_file(j);
+        ecs_map_fini(&j->declared);
+        ecs_os_free(j->buf);
+        ecs_os_free(j);
+        world->journal = NULL;
+    }
+}
+
+typedef struct {
+    ecs_world_t *world;
+    ecs_vec_t entities;     /* vec<entity>, indexed by recorded entity index */
+    ecs_map_t declared;     /* map<recorded entity index, declare record> */
+    ecs_vec_t ids;          /* Translated ids of commit record */
+    const ecs_journal_record_t *commit; /* Last commit record */
+    ecs_journal_replay_t *result;
+} ecs_journal_reader_t;
+
+static
+ecs_entity_t* flecs_journal_replay_slot(
+    ecs_journal_reader_t *reader,
+    uint32_t index)
+{
+    ecs_assert(index < INT32_MAX, ECS_INVALID_PARAMETER, NULL);
+    int32_t count = ecs_vec_count(&reader->entities);
+    if ((int32_t)index >= count) {
+        int32_t grow = (int32_t)index + 1 - count;
+        ecs_entity_t *slots = ecs_vec_grow_t(NULL, &reader->entities, 
+            ecs_entity_t, grow);
+        ecs_os_memset_n(slots, 0, ecs_entity_t, grow);
+    }
+    return ecs_vec_get_t(&reader->entities, ecs_entity_t, (int32_t)index);
+}
+
+static
+ecs_entity_t flecs_journal_replay_entity(
+    ecs_journal_reader_t *reader,
+    uint32_t index)
+{
+    ecs_world_t *world = reader->world;
+
+    if (flecs_journal_is_builtin(index)) {
+        return index;
+    }
+
+    ecs_entity_t *entity = flecs_journal_replay_slot(reader, index);
+    if (*entity && ecs_is_alive(world, *entity)) {
+        return *entity;
+    }
+
+    ecs_entity_t result = 0;
+    const ecs_journal_record_t *decl = ecs_map_get_deref(
+        &reader->declared, ecs_journal_record_t, index);
+    if (decl) {
+        const uint32_t *size = ECS_OFFSET(decl, 
+            ECS_SIZEOF(ecs_journal_record_t));
+        const char *path = ECS_OFFSET(size, ECS_SIZEOF(uint32_t));
+        if (path[0]) {
+            /* Don't search the lookup path, Tag is not flecs.core.Tag */
+            result = ecs_lookup_path_w_sep(world, 0, path, ".", NULL, false);
+            if (!result) {
+                result = ecs_new_from_fullpath(world, path);
+            }
+        } else {
+            result = ecs_new_id(world);
+        }
+
+        if (size[0] && !ecs_has(world, result, EcsComponent)) {
+            ecs_component_init(world, &(ecs_component_desc_t){
+                .entity = result,
+                .type.size = (ecs_size_t)size[0],
+                .type.alignment = decl->alignment
+            });
+        }
+    } else {
+        result = ecs_new_id(world);
+    }
+
+    *flecs_journal_replay_slot(reader, index) = result;
+    return result;
+}
+
+static
+ecs_id_t flecs_journal_replay_id(
+    ecs_journal_reader_t *reader,
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t first = flecs_journal_replay_entity(
+            reader, ECS_PAIR_FIRST(id));
+        ecs_entity_t second = flecs_journal_replay_entity(
+            reader, ECS_PAIR_SECOND(id));
+        return ecs_pair(first, second);
+    }
+
+    return (id & ECS_ID_FLAGS_MASK) | 
+        flecs_journal_replay_entity(reader, (uint32_t)id);
+}
+
+/* Systems, observers and queries can't be restored from the journal, the
+ * entities that held them are replayed as plain entities */
+static
+bool flecs_journal_replay_skip(
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        return ECS_PAIR_FIRST(id) == ecs_id(EcsPoly);
+    }
+    return id == EcsQuery || id == EcsObserver || id == EcsSystem;
+}
+
+/* Check that the payload of a record fits in the record */
+static
+bool flecs_journal_record_valid(
+    const ecs_journal_record_t *r)
+{
+    if (r->op == EcsJournalOpPad) {
+        /* Can be smaller than a record header at the end of the ring */
+        return true;
+    }
+    if (r->size < ECS_SIZEOF(ecs_journal_record_t)) {
+        return false;
+    }
+
+    uint32_t payload = r->size - (uint32_t)ECS_SIZEOF(ecs_journal_record_t);
+    const uint32_t *data = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+
+    switch(r->op) {
+    case EcsJournalOpCommit: {
+        if (payload < 2 * ECS_SIZEOF(uint32_t)) {
+            return false;
+        }
+        uint64_t ids = (uint64_t)data[0] + data[1];
+        return (2 * ECS_SIZEOF(uint32_t) + ids * ECS_SIZEOF(ecs_id_t)) <= 
+            payload;
+    }
+    case EcsJournalOpSet: {
+        if (payload < 2 * ECS_SIZEOF(uint32_t)) {
+            return false;
+        }
+        uint64_t elem = (uint64_t)ECS_ALIGN(data[0], 8);
+        uint64_t rest = payload - 2 * ECS_SIZEOF(uint32_t);
+        return elem <= rest && 
+            !((rest - elem) % (ECS_SIZEOF(uint64_t) + elem));
+    }
+    case EcsJournalOpSetValues:
+        if (payload < 2 * ECS_SIZEOF(uint32_t)) {
+            return false;
+        }
+        return (2 * ECS_SIZEOF(uint32_t) + (uint64_t)data[0] * data[1]) <=
+            payload;
+    default:
+        return true;
+    }
+}
+
+static
+void flecs_journal_replay_commit(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint32_t *counts = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    const ecs_id_t *ids = ECS_OFFSET(counts, 2 * ECS_SIZEOF(uint32_t));
+    int32_t i, add_count = (int32_t)counts[0];
+    int32_t count = add_count + (int32_t)counts[1];
+
+    ecs_vec_clear(&reader->ids);
+    ecs_id_t *dst_ids = ecs_vec_grow_t(NULL, &reader->ids, ecs_id_t, count);
+    int32_t dst_count = 0, dst_add_count = 0;
+    for (i = 0; i < count; i ++) {
+        if (flecs_journal_replay_skip(ids[i])) {
+            continue;
+        }
+        dst_ids[dst_count ++] = flecs_journal_replay_id(reader, ids[i]);
+        dst_add_count += i < add_count;
+    }
+
+    reader->commit = r;
+
+    ecs_type_t added = { .array = dst_ids, .count = dst_add_count };
+    ecs_type_t removed = { .array = &dst_ids[dst_add_count], 
+        .count = dst_count - dst_add_count };
+
+    /* The first entity is in the record, the others follow the ids */
+    const uint64_t *entities = (const uint64_t*)&ids[count];
+    int32_t e_i, entity_count = 1 + flecs_journal_range_count(r, entities, 0);
+    for (e_i = 0; e_i < entity_count; e_i ++) {
+        uint64_t index = e_i ? entities[e_i - 1] : r->entity;
+        ecs_entity_t e = flecs_journal_replay_entity(reader, (uint32_t)index);
+        ecs_table_t *table = ecs_get_table(world, e);
+        for (i = 0; i < added.count; i ++) {
+            table = ecs_table_add_id(world, table, added.array[i]);
+        }
+        for (i = 0; i < removed.count; i ++) {
+            table = ecs_table_remove_id(world, table, removed.array[i]);
+        }
+        ecs_commit(world, e, NULL, table, &added, &removed);
+        reader->result->op_count ++;
+    }
+}
+
+static
+void flecs_journal_replay_set(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint32_t *payload = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    ecs_size_t size = (ecs_size_t)payload[0];
+    ecs_size_t aligned = ECS_ALIGN(size, 8);
+    int32_t count = 1 + flecs_journal_range_count(
+        r, ECS_OFFSET(&payload[2], aligned), aligned);
+
+    if (flecs_journal_replay_skip(r->id)) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    ecs_id_t id = flecs_journal_replay_id(reader, r->id);
+    const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+    if (!ti || (size && ti->size != size)) {
+        /* Component has a different size than in the recording world */
+        reader->result->skip_count += count;
+        return;
+    }
+
+    /* The first value is for the entity in the record, the others are 
+     * preceded by their entity */
+    const void *value = &payload[2];
+    uint64_t index = r->entity;
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = flecs_journal_replay_entity(reader, (uint32_t)index);
+        if (!size) {
+            ecs_add_id(world, e, id);
+        } else {
+            ecs_set_id(world, e, id, (size_t)size, value);
+        }
+        reader->result->op_count ++;
+
+        const uint64_t *next = ECS_OFFSET(value, aligned);
+        index = next[0];
+        value = &next[1];
+    }
+}
+
+static
+void flecs_journal_replay_values(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint32_t *payload = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    ecs_size_t size = (ecs_size_t)payload[0];
+    int32_t count = (int32_t)payload[1];
+
+    /* The commit is in the ring, unless the values are corrupt */
+    const ecs_journal_record_t *c = reader->commit;
+    if (!c || flecs_journal_replay_skip(r->id)) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    const uint32_t *counts = ECS_OFFSET(c, ECS_SIZEOF(ecs_journal_record_t));
+    const uint64_t *committed = ECS_OFFSET(counts, 2 * ECS_SIZEOF(uint32_t) +
+        (int32_t)(counts[0] + counts[1]) * ECS_SIZEOF(ecs_id_t));
+    int32_t committed_count = 1 + flecs_journal_range_count(c, committed, 0);
+    if (count > committed_count) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    ecs_id_t id = flecs_journal_replay_id(reader, r->id);
+    const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+    if (!ti || (size && ti->size != size)) {
+        reader->result->skip_count += count;
+        return;
+    }
+
+    const void *value = &payload[2];
+    int32_t i;
+    for (i = committed_count - count; i < committed_count; i ++) {
+        uint64_t index = i ? committed[i - 1] : c->entity;
+        ecs_entity_t e = flecs_journal_replay_entity(reader, (uint32_t)index);
+        if (!size) {
+            ecs_add_id(world, e, id);
+        } else {
+            ecs_set_id(world, e, id, (size_t)size, value);
+        }
+        reader->result->op_count ++;
+        value = ECS_OFFSET(value, size);
+    }
+}
+
+static
+void flecs_journal_replay_delete(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    const uint64_t *entities = ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t));
+    int32_t i, count = 1 + flecs_journal_range_count(r, entities, 0);
+    for (i = 0; i < count; i ++) {
+        uint64_t index = i ? entities[i - 1] : r->entity;
+        ecs_entity_t *e = flecs_journal_replay_slot(reader, (uint32_t)index);
+        if (!*e || !ecs_is_alive(world, *e)) {
+            reader->result->skip_count ++;
+        } else {
+            ecs_delete(world, *e);
+            *e = 0;
+            reader->result->op_count ++;
+        }
+    }
+}
+
+static
+void flecs_journal_replay_record(
+    ecs_journal_reader_t *reader,
+    const ecs_journal_record_t *r)
+{
+    ecs_world_t *world = reader->world;
+    ecs_journal_replay_t *result = reader->result;
+
+    switch(r->op) {
+    case EcsJournalOpDeclare:
+        /* Entities created after this point use the latest declaration */
+        *ecs_map_ensure(&reader->declared, (uint32_t)r->entity) = 
+            (ecs_map_val_t)r;
+        return;
+    case EcsJournalOpCommit:
+        flecs_journal_replay_commit(reader, r);
+        return;
+    case EcsJournalOpSet:
+        flecs_journal_replay_set(reader, r);
+        return;
+    case EcsJournalOpSetValues:
+        flecs_journal_replay_values(reader, r);
+        return;
+    case EcsJournalOpDelete:
+        flecs_journal_replay_delete(reader, r);
+        return;
+    case EcsJournalOpName:
+        ecs_set_name(world, 
+            flecs_journal_replay_entity(reader, (uint32_t)r->entity),
+            ECS_OFFSET(r, ECS_SIZEOF(ecs_journal_record_t)));
+        break;
+    case EcsJournalOpClear: {
+        ecs_entity_t *e = flecs_journal_replay_slot(
+            reader, (uint32_t)r->entity);
+        if (!*e || !ecs_is_alive(world, *e)) {
+            result->skip_count ++;
+            return;
+        }
+        ecs_clear(world, *e);
+        break;
+    }
+    case EcsJournalOpDeleteWith:
+        ecs_delete_with(world, flecs_journal_replay_id(reader, r->id));
+        break;
+    case EcsJournalOpRemoveAll:
+        ecs_remove_all(world, flecs_journal_replay_id(reader, r->id));
+        break;
+    default:
+        return;
+    }
+
+    result->op_count ++;
+}
+
+int ecs_journal_replay(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_journal_replay_t *result)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(filename != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_journal_replay_t dummy;
+    if (!result) {
+        result = &dummy;
+    }
+    ecs_os_zeromem(result);
+
+    FILE *file;
+    ecs_os_fopen(&file, filename, "rb");
+    if (!file) {
+        ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
+        return -1;
+    }
+
+    ecs_journal_header_t hdr;
+    if (fread(&hdr, ECS_SIZEOF(hdr), 1, file) != 1 || 
+        ecs_os_memcmp(hdr.magic, FLECS_JOURNAL_MAGIC, 4) ||
+        hdr.version != FLECS_JOURNAL_VERSION || (hdr.capacity % 8) ||
+        hdr.tail > hdr.head || (hdr.head - hdr.tail) > hdr.capacity)
+    {
+        ecs_err("journal: '%s' is not a valid journal", filename);
+        fclose(file);
+        return -1;
+    }
+
+    char *ring = ecs_os_malloc((ecs_size_t)hdr.capacity);
+    size_t read = fread(ring, 1, (size_t)hdr.capacity, file);
+    fclose(file);
+    if (read != (size_t)hdr.capacity) {
+        ecs_err("journal: '%s' is truncated", filename);
+        ecs_os_free(ring);
+        return -1;
+    }
+
+    ecs_journal_reader_t reader = { .world = world, .result = result };
+    ecs_vec_init_t(NULL, &reader.entities, ecs_entity_t, 0);
+    ecs_map_init(&reader.declared, NULL);
+    ecs_vec_init_t(NULL, &reader.ids, ecs_id_t, 0);
+
+    /* Collect the first declaration of each entity, since a declaration that
+     * was overwritten is only written again after records that use it. */
+    uint64_t offset;
+    const ecs_journal_record_t *r;
+    for (offset = hdr.tail; offset < hdr.head; offset += r->size) {
+        r = ECS_OFFSET(ring, offset % hdr.capacity);
+        if (!r->size || (r->size % 8) || 
+            ((offset % hdr.capacity) + r->size) > hdr.capacity ||
+            !flecs_journal_record_valid(r)) 
+        {
+            ecs_err("journal: '%s' has an invalid record", filename);
+            goto error;
+        }
+        if (r->op == EcsJournalOpDeclare) {
+            ecs_map_val_t *decl = ecs_map_ensure(
+                &reader.declared, (uint32_t)r->entity);
+            if (!*decl) {
+                *decl = (ecs_map_val_t)r;
+            }
+        }
+        if (r->op != EcsJournalOpPad) {
+            result->record_count ++;
+        }
+    }
+
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    for (offset = hdr.tail; offset < hdr.head; offset += r->size) {
+        r = ECS_OFFSET(ring, offset % hdr.capacity);
+        flecs_journal_replay_record(&reader, r);
+    }
+
+    result->time_spent = (ecs_ftime_t)ecs_time_measure(&t);
+
+    ecs_vec_fini_t(NULL, &reader.ids, ecs_id_t);
+    ecs_map_fini(&reader.declared);
+    ecs_vec_fini_t(NULL, &reader.entities, ecs_entity_t);
+    ecs_os_free(ring);
+    return 0;
+error:
+    ecs_vec_fini_t(NULL, &reader.ids, ecs_id_t);
+    ecs_map_fini(&reader.declared);
+    ecs_vec_fini_t(NULL, &reader.entities, ecs_entity_t);
+    ecs_os_free(ring);
+    return -1;
+}
+
 #endif
@@ -80,12 +80,13 @@ void flecs_json_string_escape(
     ecs_strbuf_t *buf,
     const char *value)
 {
-    ecs_size_t length = ecs_stresc(NULL, 0, '"', value);
-    if (length == ecs_os_strlen(value)) {
+    ecs_size_t len = ecs_os_strlen(value);
+    if (!flecs_json_needs_escape(value, len)) {
         ecs_strbuf_appendch(buf, '"');
-        ecs_strbuf_appendstrn(buf, value, length);
+        ecs_strbuf_appendstrn(buf, value, len);
         ecs_strbuf_appendch(buf, '"');
     } else {
+        ecs_size_t length = ecs_stresc(NULL, 0, '"', value);
         char *out = ecs_os_malloc(length + 3);
         ecs_stresc(out + 1, length, '"', value);
         out[0] = '"';
@@ -95,6 +96,42 @@ void flecs_json_string_escape(
     }
 }
 
+/* Characters that ecs_stresc escapes, for a '"' delimiter */
+#define flecs_json_escaped(ch)\
+    (((ch) >= '\a' && (ch) <= '\r') || (ch) == '"' || (ch) == '\\')
+
+bool flecs_json_needs_escape(
+    const char *value,
+    ecs_size_t len)
+{
+    /* Test 8 characters at a time, with the "has zero byte" bit trick. Words
+     * with a character below 0x0E (which includes all escaped control
+     * characters), a '"' or a '\\' are inspected per character. */
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    ecs_size_t i = 0;
+
+    for (; (i + 8) <= len; i += 8) {
+        uint64_t w, q, b;
+        ecs_os_memcpy(&w, &value[i], 8);
+        q = w ^ (ones * '"');
+        b = w ^ (ones * '\\');
+        if ((((w - ones * 0x0E) & ~w) | ((q - ones) & ~q) | 
+            ((b - ones) & ~b)) & highs) 
+        {
+            break;
+        }
+    }
+
+    for (; i < len; i ++) {
+        if (flecs_json_escaped(value[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void flecs_json_member(
     ecs_strbuf_t *buf,
     const char *name)
@@ -44,6 +44,10 @@ void flecs_json_string_escape(
     ecs_strbuf_t *buf,
     const char *value);
 
+bool flecs_json_needs_escape(
+    const char *value,
+    ecs_size_t len);
+
 void flecs_json_member(
     ecs_strbuf_t *buf,
     const char *name);
@@ -79,4 +83,31 @@ void flecs_json_id(
 ecs_primitive_kind_t flecs_json_op_to_primitive_kind(
     ecs_meta_type_op_kind_t kind);
 
+/* Serializer plan, compiled from the type ops of a type and cached on its
+ * EcsMetaTypeSerialized component. A plan flattens nested structs and small
+ * inline arrays into a list of steps, where each step appends a precomputed
+ * literal (braces, separators and member names) followed by a value. */
+typedef struct ecs_json_ser_step_t {
+    int32_t lit;                  /* Offset of literal in plan literals */
+    int32_t lit_len;              /* Length of literal appended before value */
+    int32_t op;                   /* Type op of value, -1 if step has no value */
+    ecs_size_t offset;            /* Offset of value */
+    ecs_meta_type_op_kind_t kind; /* Kind of value */
+    bool elements;                /* Value is an inline array that's too large
+                                   * to unroll, serialized by type ops */
+} ecs_json_ser_step_t;
+
+typedef struct ecs_json_ser_plan_t {
+    ecs_json_ser_step_t *steps;
+    int32_t step_count;
+    char *literals;
+    int32_t size_hint;            /* Expected length of a serialized value */
+} ecs_json_ser_plan_t;
+
+ecs_json_ser_plan_t* flecs_json_ser_plan_init(
+    const ecs_vector_t *ops);
+
+void flecs_json_ser_plan_free(
+    ecs_json_ser_plan_t *plan);
+
 #endif
@@ -10,7 +10,7 @@
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *ser, 
+    const EcsMetaTypeSerialized *ser, 
     const void *base, 
     ecs_strbuf_t *str);
 
@@ -30,6 +30,15 @@ int json_ser_type_op(
     const void *base,
     ecs_strbuf_t *str);
 
+static
+int flecs_json_ser_plan_array(
+    const ecs_world_t *world,
+    const EcsMetaTypeSerialized *ser,
+    const void *ptr,
+    int32_t count,
+    ecs_size_t size,
+    ecs_strbuf_t *str);
+
 /* Serialize enumeration */
 static
 int json_ser_enum(
@@ -148,6 +157,11 @@ int json_ser_type_elements(
     const EcsComponent *comp = ecs_get(world, type, EcsComponent);
     ecs_assert(comp != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (ser->json_plan && elem_count) {
+        return flecs_json_ser_plan_array(
+            world, ser, base, elem_count, comp->size, str);
+    }
+
     ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
     int32_t op_count = ecs_vector_count(ser->ops);
 
@@ -320,16 +334,554 @@ error:
     return -1;
 }
 
+/* Inline arrays with more elements are not unrolled in a serializer plan */
+#define FLECS_JSON_PLAN_MAX_UNROLL (64)
+
+/* Types with a longer literal (member names) don't get a plan */
+#define FLECS_JSON_PLAN_MAX_LITERAL (512)
+
+/* Size of the stack buffer of the plan writer, fits the longest literal and
+ * value of a step. */
+#define FLECS_JSON_WRITER_STACK_SIZE (1024)
+
+/* Max size of heap chunks handed over to the output buffer */
+#define FLECS_JSON_WRITER_CHUNK_SIZE (64 * 1024)
+
+typedef struct flecs_json_plan_builder_t {
+    ecs_vec_t steps;        /* vec<ecs_json_ser_step_t> */
+    ecs_vec_t literals;     /* vec<char> */
+    int32_t lit;            /* Start of the literal of the next step */
+    int32_t value_count;
+
+    /* Mirrors the list stack of ecs_strbuf_t, so that separators end up in
+     * the same places as when serializing with type ops */
+    int32_t list_count[ECS_STRBUF_MAX_LIST_DEPTH];
+    int32_t list_sp;
+    bool invalid;
+} flecs_json_plan_builder_t;
+
+static
+void flecs_json_plan_lit(
+    flecs_json_plan_builder_t *b,
+    const char *str,
+    int32_t len)
+{
+    if (!len) {
+        return;
+    }
+    char *dst = ecs_vec_grow_t(NULL, &b->literals, char, len);
+    ecs_os_memcpy(dst, str, len);
+}
+
+#define flecs_json_plan_litl(b, str)\
+    flecs_json_plan_lit(b, str, sizeof(str) - 1)
+
+static
+void flecs_json_plan_push(
+    flecs_json_plan_builder_t *b,
+    const char *open)
+{
+    flecs_json_plan_lit(b, open, 1);
+    if (++ b->list_sp >= ECS_STRBUF_MAX_LIST_DEPTH) {
+        b->invalid = true;
+        b->list_sp --;
+    }
+    b->list_count[b->list_sp] = 0;
+}
+
+static
+void flecs_json_plan_pop(
+    flecs_json_plan_builder_t *b,
+    const char *close)
+{
+    flecs_json_plan_lit(b, close, 1);
+    if (b->list_sp) {
+        b->list_sp --;
+    }
+}
+
+static
+void flecs_json_plan_next(
+    flecs_json_plan_builder_t *b)
+{
+    if (b->list_count[b->list_sp] ++) {
+        flecs_json_plan_litl(b, ", ");
+    }
+}
+
+static
+void flecs_json_plan_step(
+    flecs_json_plan_builder_t *b,
+    int32_t op,
+    ecs_meta_type_op_kind_t kind,
+    ecs_size_t offset,
+    bool elements)
+{
+    int32_t lit_end = ecs_vec_count(&b->literals);
+    if (lit_end - b->lit > FLECS_JSON_PLAN_MAX_LITERAL) {
+        b->invalid = true;
+    }
+
+    ecs_json_ser_step_t *step = ecs_vec_append_t(
+        NULL, &b->steps, ecs_json_ser_step_t);
+    step->lit = b->lit;
+    step->lit_len = lit_end - b->lit;
+    step->op = op;
+    step->offset = offset;
+    step->kind = kind;
+    step->elements = elements;
+    b->lit = lit_end;
+
+    if (op != -1) {
+        b->value_count ++;
+    }
+}
+
+/* Compile ops into steps, follows the same logic as json_ser_type_ops */
+static
+void flecs_json_plan_ops(
+    flecs_json_plan_builder_t *b,
+    const ecs_meta_type_op_t *ops_base,
+    const ecs_meta_type_op_t *ops,
+    int32_t op_count,
+    ecs_size_t offset,
+    int32_t in_array)
+{
+    for (int i = 0; i < op_count; i ++) {
+        const ecs_meta_type_op_t *op = &ops[i];
+
+        if (in_array <= 0) {
+            if (op->name) {
+                flecs_json_plan_next(b);
+                flecs_json_plan_litl(b, "\"");
+                flecs_json_plan_lit(b, op->name, ecs_os_strlen(op->name));
+                flecs_json_plan_litl(b, "\":");
+            }
+
+            int32_t elem_count = op->count;
+            if (elem_count > FLECS_JSON_PLAN_MAX_UNROLL) {
+                flecs_json_plan_step(b, (int32_t)(op - ops_base), op->kind, 
+                    offset + op->offset, true);
+                i += op->op_count - 1;
+                continue;
+            } else if (elem_count > 1) {
+                flecs_json_plan_push(b, "[");
+                for (int e = 0; e < elem_count; e ++) {
+                    flecs_json_plan_next(b);
+                    flecs_json_plan_ops(b, ops_base, op, op->op_count, 
+                        offset + e * op->size, 1);
+                }
+                flecs_json_plan_pop(b, "]");
+
+                i += op->op_count - 1;
+                continue;
+            }
+        }
+
+        switch(op->kind) {
+        case EcsOpPush:
+            flecs_json_plan_push(b, "{");
+            in_array --;
+            break;
+        case EcsOpPop:
+            flecs_json_plan_pop(b, "}");
+            in_array ++;
+            break;
+        default:
+            flecs_json_plan_step(b, (int32_t)(op - ops_base), op->kind, 
+                offset + op->offset, false);
+            break;
+        }
+    }
+}
+
+ecs_json_ser_plan_t* flecs_json_ser_plan_init(
+    const ecs_vector_t *v_ops)
+{
+    const ecs_meta_type_op_t *ops = ecs_vector_first(
+        v_ops, ecs_meta_type_op_t);
+    int32_t op_count = ecs_vector_count(v_ops);
+    if (!op_count) {
+        return NULL;
+    }
+
+    flecs_json_plan_builder_t b = {0};
+    ecs_vec_init_t(NULL, &b.steps, ecs_json_ser_step_t, op_count);
+    ecs_vec_init_t(NULL, &b.literals, char, 64);
+
+    flecs_json_plan_ops(&b, ops, ops, op_count, 0, 0);
+
+    /* Trailing literal (closing braces) */
+    if (ecs_vec_count(&b.literals) != b.lit) {
+        flecs_json_plan_step(&b, -1, 0, 0, false);
+    }
+
+    ecs_json_ser_plan_t *plan = NULL;
+    if (!b.invalid) {
+        /* Store plan in a single allocation */
+        int32_t step_count = ecs_vec_count(&b.steps);
+        int32_t lit_count = ecs_vec_count(&b.literals);
+        ecs_size_t steps_size = step_count * ECS_SIZEOF(ecs_json_ser_step_t);
+        plan = ecs_os_malloc(ECS_SIZEOF(ecs_json_ser_plan_t) + 
+            steps_size + lit_count);
+        plan->steps = ECS_OFFSET(plan, ECS_SIZEOF(ecs_json_ser_plan_t));
+        plan->step_count = step_count;
+        plan->literals = ECS_OFFSET(plan->steps, steps_size);
+        plan->size_hint = lit_count + b.value_count * 8;
+        ecs_os_memcpy(plan->steps, ecs_vec_first(&b.steps), steps_size);
+        ecs_os_memcpy(plan->literals, ecs_vec_first(&b.literals), lit_count);
+    }
+
+    ecs_vec_fini_t(NULL, &b.steps, ecs_json_ser_step_t);
+    ecs_vec_fini_t(NULL, &b.literals, char);
+
+    return plan;
+}
+
+void flecs_json_ser_plan_free(
+    ecs_json_ser_plan_t *plan)
+{
+    ecs_os_free(plan);
+}
+
+/* Writes the output of a plan straight to memory. Output either goes to a
+ * stack buffer that is copied to the strbuf, or, for large arrays, to heap
+ * chunks that are handed over to the strbuf without copying. */
+typedef struct flecs_json_writer_t {
+    ecs_strbuf_t *str;
+    char *buf;              /* Start of output not yet added to str */
+    char *ptr;              /* Write position */
+    char *end;              /* End of the current buffer */
+    ecs_size_t chunk_size;  /* Size of heap chunks, 0 if writer uses stack */
+    char stack[FLECS_JSON_WRITER_STACK_SIZE];
+} flecs_json_writer_t;
+
+static
+void flecs_json_writer_init(
+    flecs_json_writer_t *w,
+    ecs_strbuf_t *str,
+    ecs_size_t size_hint)
+{
+    w->str = str;
+    w->chunk_size = 0;
+    if (size_hint > FLECS_JSON_WRITER_STACK_SIZE && !str->buf && !str->max) {
+        w->chunk_size = size_hint < FLECS_JSON_WRITER_CHUNK_SIZE ? 
+            size_hint : FLECS_JSON_WRITER_CHUNK_SIZE;
+        w->buf = w->ptr = w->end = NULL;
+    } else {
+        w->buf = w->ptr = w->stack;
+        w->end = w->stack + FLECS_JSON_WRITER_STACK_SIZE;
+    }
+}
+
+/* Add pending output to str, so it can be appended to directly */
+static
+void flecs_json_writer_sync(
+    flecs_json_writer_t *w)
+{
+    if (w->ptr != w->buf) {
+        ecs_strbuf_appendstrn(w->str, w->buf, (int32_t)(w->ptr - w->buf));
+        w->ptr = w->buf;
+    }
+}
+
+static
+void flecs_json_writer_fini(
+    flecs_json_writer_t *w)
+{
+    if (w->chunk_size && w->buf) {
+        int32_t written = (int32_t)(w->ptr - w->buf);
+        if (written > ECS_STRBUF_ELEMENT_SIZE) {
+            ecs_strbuf_appendstr_zerocpyn(w->str, w->buf, written);
+        } else {
+            flecs_json_writer_sync(w);
+            ecs_os_free(w->buf);
+        }
+    } else {
+        flecs_json_writer_sync(w);
+    }
+}
+
+static
+char* flecs_json_writer_grow(
+    flecs_json_writer_t *w,
+    ecs_size_t size)
+{
+    if (w->chunk_size) {
+        if (w->ptr != w->buf) {
+            ecs_strbuf_appendstr_zerocpyn(
+                w->str, w->buf, (int32_t)(w->ptr - w->buf));
+        } else {
+            ecs_os_free(w->buf);
+        }
+        if (size < w->chunk_size) {
+            size = w->chunk_size;
+        }
+        w->buf = w->ptr = ecs_os_malloc(size);
+        w->end = w->buf + size;
+    } else {
+        ecs_assert(size <= FLECS_JSON_WRITER_STACK_SIZE, 
+            ECS_INTERNAL_ERROR, NULL);
+        flecs_json_writer_sync(w);
+    }
+    return w->ptr;
+}
+
+/* Return a pointer with at least size bytes of space */
+static
+char* flecs_json_writer_reserve(
+    flecs_json_writer_t *w,
+    ecs_size_t size)
+{
+    if ((w->end - w->ptr) >= size) {
+        return w->ptr;
+    }
+    return flecs_json_writer_grow(w, size);
+}
+
+static
+void flecs_json_writer_string(
+    flecs_json_writer_t *w,
+    const char *value,
+    ecs_size_t len)
+{
+    if (len > FLECS_JSON_PLAN_MAX_LITERAL) {
+        flecs_json_writer_sync(w);
+        ecs_strbuf_appendch(w->str, '"');
+        ecs_strbuf_appendstrn(w->str, value, len);
+        ecs_strbuf_appendch(w->str, '"');
+    } else {
+        char *ptr = flecs_json_writer_reserve(w, len + 2);
+        ptr[0] = '"';
+        ecs_os_memcpy(&ptr[1], value, len);
+        ptr[len + 1] = '"';
+        w->ptr = &ptr[len + 2];
+    }
+}
+
+static
+int flecs_json_writer_enum(
+    const ecs_world_t *world,
+    flecs_json_writer_t *w,
+    const ecs_meta_type_op_t *op,
+    const void *ptr)
+{
+    const EcsEnum *enum_type = ecs_get(world, op->type, EcsEnum);
+    ecs_check(enum_type != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t value = *(int32_t*)ptr;
+    ecs_enum_constant_t *constant = ecs_map_get_deref(&enum_type->constants,
+        ecs_enum_constant_t, (ecs_map_key_t)value);
+    if (!constant) {
+        goto error;
+    }
+
+    const char *name = ecs_get_name(world, constant->constant);
+    flecs_json_writer_string(w, name, ecs_os_strlen(name));
+
+    return 0;
+error:
+    return -1;
+}
+
+/* Serialize a value with a plan */
+static
+int flecs_json_ser_plan(
+    const ecs_world_t *world,
+    const ecs_meta_type_op_t *ops,
+    const ecs_json_ser_plan_t *plan,
+    const void *base,
+    flecs_json_writer_t *w)
+{
+    const ecs_json_ser_step_t *steps = plan->steps;
+    int32_t s, step_count = plan->step_count;
+
+    for (s = 0; s < step_count; s ++) {
+        const ecs_json_ser_step_t *step = &steps[s];
+        char *ptr = flecs_json_writer_reserve(w, 
+            step->lit_len + FLECS_FTOA_SIZE);
+        ecs_os_memcpy(ptr, &plan->literals[step->lit], step->lit_len);
+        ptr += step->lit_len;
+
+        if (step->op == -1) {
+            w->ptr = ptr;
+            continue;
+        }
+
+        const void *vptr = ECS_OFFSET(base, step->offset);
+        const ecs_meta_type_op_t *op = &ops[step->op];
+
+        if (step->elements) {
+            w->ptr = ptr;
+            flecs_json_writer_sync(w);
+            if (json_ser_elements(world, (ecs_meta_type_op_t*)op, 
+                op->op_count, ECS_OFFSET(vptr, -op->offset), op->count, 
+                op->size, w->str))
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        switch(step->kind) {
+        case EcsOpBool:
+            if (*(bool*)vptr) {
+                ecs_os_memcpy(ptr, "true", 4);
+                ptr += 4;
+            } else {
+                ecs_os_memcpy(ptr, "false", 5);
+                ptr += 5;
+            }
+            break;
+        case EcsOpChar: {
+            char ch = *(char*)vptr;
+            if (ch) {
+                *ptr++ = '"';
+                ptr = ecs_chresc(ptr, ch, '"');
+                *ptr++ = '"';
+            } else {
+                *ptr++ = '0';
+            }
+            break;
+        }
+        case EcsOpByte:
+        case EcsOpU8:
+            ptr = flecs_utoa(ptr, *(uint8_t*)vptr);
+            break;
+        case EcsOpU16:
+            ptr = flecs_utoa(ptr, *(uint16_t*)vptr);
+            break;
+        case EcsOpU32:
+            ptr = flecs_utoa(ptr, *(uint32_t*)vptr);
+            break;
+        case EcsOpU64:
+            ptr = flecs_utoa(ptr, *(uint64_t*)vptr);
+            break;
+        case EcsOpI8:
+            ptr = flecs_itoa(ptr, *(int8_t*)vptr);
+            break;
+        case EcsOpI16:
+            ptr = flecs_itoa(ptr, *(int16_t*)vptr);
+            break;
+        case EcsOpI32:
+            ptr = flecs_itoa(ptr, *(int32_t*)vptr);
+            break;
+        case EcsOpI64:
+            ptr = flecs_itoa(ptr, *(int64_t*)vptr);
+            break;
+        case EcsOpIPtr:
+            ptr = flecs_itoa(ptr, *(intptr_t*)vptr);
+            break;
+        case EcsOpF32:
+            ptr += flecs_ftoa(ptr, (ecs_f64_t)*(ecs_f32_t*)vptr, 10, '"');
+            break;
+        case EcsOpF64:
+            ptr += flecs_ftoa(ptr, *(ecs_f64_t*)vptr, 10, '"');
+            break;
+        case EcsOpString: {
+            const char *value = *(char**)vptr;
+            if (!value) {
+                ecs_os_memcpy(ptr, "null", 4);
+                ptr += 4;
+                break;
+            }
+
+            w->ptr = ptr;
+            ecs_size_t len = ecs_os_strlen(value);
+            if (!flecs_json_needs_escape(value, len)) {
+                flecs_json_writer_string(w, value, len);
+            } else {
+                flecs_json_writer_sync(w);
+                flecs_json_string_escape(w->str, value);
+            }
+            continue;
+        }
+        case EcsOpEnum:
+            w->ptr = ptr;
+            if (flecs_json_writer_enum(world, w, op, vptr)) {
+                return -1;
+            }
+            continue;
+        default:
+            /* Values that are appended by the type op (entities, bitmasks,
+             * collections) */
+            w->ptr = ptr;
+            flecs_json_writer_sync(w);
+            if (json_ser_type_op(world, (ecs_meta_type_op_t*)op, 
+                ECS_OFFSET(vptr, -op->offset), w->str)) 
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        w->ptr = ptr;
+    }
+
+    return 0;
+}
+
+/* Serialize value or array of values with a plan */
+static
+int flecs_json_ser_plan_array(
+    const ecs_world_t *world,
+    const EcsMetaTypeSerialized *ser,
+    const void *ptr,
+    int32_t count,
+    ecs_size_t size,
+    ecs_strbuf_t *str)
+{
+    const ecs_json_ser_plan_t *plan = ser->json_plan;
+    const ecs_meta_type_op_t *ops = ecs_vector_first(
+        ser->ops, ecs_meta_type_op_t);
+    flecs_json_writer_t w;
+    int result = 0;
+
+    if (!count) {
+        flecs_json_writer_init(&w, str, 0);
+        result = flecs_json_ser_plan(world, ops, plan, ptr, &w);
+    } else {
+        /* Size chunks of output for the whole array */
+        flecs_json_writer_init(&w, str, count * plan->size_hint);
+        *flecs_json_writer_reserve(&w, 1) = '[';
+        w.ptr ++;
+
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            if (i) {
+                char *sep = flecs_json_writer_reserve(&w, 2);
+                sep[0] = ',';
+                sep[1] = ' ';
+                w.ptr += 2;
+            }
+            if ((result = flecs_json_ser_plan(world, ops, plan, ptr, &w))) {
+                break;
+            }
+            ptr = ECS_OFFSET(ptr, size);
+        }
+
+        *flecs_json_writer_reserve(&w, 1) = ']';
+        w.ptr ++;
+    }
+
+    flecs_json_writer_fini(&w);
+    return result;
+}
+
 /* Iterate over the type ops of a type */
 static
 int json_ser_type(
     const ecs_world_t *world,
-    ecs_vector_t *v_ops,
+    const EcsMetaTypeSerialized *ser,
     const void *base, 
     ecs_strbuf_t *str) 
 {
-    ecs_meta_type_op_t *ops = ecs_vector_first(v_ops, ecs_meta_type_op_t);
-    int32_t count = ecs_vector_count(v_ops);
+    if (ser->json_plan) {
+        return flecs_json_ser_plan_array(world, ser, base, 0, 0, str);
+    }
+
+    ecs_meta_type_op_t *ops = ecs_vector_first(ser->ops, ecs_meta_type_op_t);
+    int32_t count = ecs_vector_count(ser->ops);
     return json_ser_type_ops(world, ops, count, base, str, 0);
 }
 
@@ -342,14 +894,17 @@ int array_to_json_buf_w_type_data(
     const EcsComponent *comp,
     const EcsMetaTypeSerialized *ser)
 {
-    if (count) {
+    if (count && ser->json_plan) {
+        return flecs_json_ser_plan_array(
+            world, ser, ptr, count, comp->size, buf);
+    } else if (count) {
         ecs_size_t size = comp->size;
 
         flecs_json_array_push(buf);
 
         do {
             ecs_strbuf_list_next(buf);
-            if (json_ser_type(world, ser->ops, ptr, buf)) {
+            if (json_ser_type(world, ser, ptr, buf)) {
                 return -1;
             }
 
@@ -358,7 +913,7 @@ int array_to_json_buf_w_type_data(
 
         flecs_json_array_pop(buf);
     } else {
-        if (json_ser_type(world, ser->ops, ptr, buf)) {
+        if (json_ser_type(world, ser, ptr, buf)) {
             return -1;
         }
     }
@@ -590,7 +1145,7 @@ int flecs_json_append_type_values(
                     ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
 
                     flecs_json_next(buf);
-                    if (json_ser_type(world, ser->ops, ptr, buf) != 0) {
+                    if (json_ser_type(world, ser, ptr, buf) != 0) {
                         /* Entity contains invalid value */
                         return -1;
                     }
@@ -42,6 +42,23 @@ void ecs_meta_dtor_serialized(
     }
 
     ecs_vector_free(ptr->ops);
+
+#ifdef FLECS_JSON
+    flecs_json_ser_plan_free(ptr->json_plan);
+    ptr->json_plan = NULL;
+#endif
+}
+
+/* Called from ECS_COPY, which can't contain the FLECS_JSON check itself */
+static
+void flecs_meta_serialized_init_plan(
+    EcsMetaTypeSerialized *ptr)
+{
+#ifdef FLECS_JSON
+    ptr->json_plan = flecs_json_ser_plan_init(ptr->ops);
+#else
+    ptr->json_plan = NULL;
+#endif
 }
 
 static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
@@ -58,12 +75,16 @@ static ECS_COPY(EcsMetaTypeSerialized, dst, src, {
             op->members = flecs_name_index_copy(op->members);
         }
     }
+
+    flecs_meta_serialized_init_plan(dst);
 })
 
 static ECS_MOVE(EcsMetaTypeSerialized, dst, src, {
     ecs_meta_dtor_serialized(dst);
     dst->ops = src->ops;
+    dst->json_plan = src->json_plan;
     src->ops = NULL;
+    src->json_plan = NULL;
 })
 
 static ECS_DTOR(EcsMetaTypeSerialized, ptr, { 
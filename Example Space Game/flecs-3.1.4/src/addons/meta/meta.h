@@ -16,6 +16,15 @@ void ecs_meta_type_serialized_init(
 void ecs_meta_dtor_serialized(
     EcsMetaTypeSerialized *ptr);
 
+#ifdef FLECS_JSON
+/* Serializer plans are compiled from the type ops by the JSON addon */
+struct ecs_json_ser_plan_t* flecs_json_ser_plan_init(
+    const ecs_vector_t *ops);
+
+void flecs_json_ser_plan_free(
+    struct ecs_json_ser_plan_t *plan);
+#endif
+
 
 bool flecs_unit_validate(
     ecs_world_t *world,
@@ -298,6 +298,10 @@ void ecs_meta_type_serialized_init(
         }
 
         ptr->ops = ops;
+
+#ifdef FLECS_JSON
+        ptr->json_plan = flecs_json_ser_plan_init(ops);
+#endif
     }
 }
 
@@ -0,0 +1,851 @@
+/**
+ * @file addons/os_alloc.c
+ * @brief Thread caching allocator for the OS API.
+ *
+ * Allocations up to 256KB are rounded up to one of a fixed set of size classes.
+ * Every thread has a cache with a list of free blocks per class, and only
+ * takes a lock when its list runs empty or grows too long. In that case it
+ * exchanges a batch of blocks with the central heap of the class.
+ *
+ * The central heap of a class carves blocks from chunks that hold at least 16
+ * blocks. Chunks are made of 64KB pages, and the chunks of all classes are cut
+ * from shared 2MB regions mapped from the OS, so a class that is barely used
+ * doesn't reserve a region of its own. Chunks that don't fit in a region are
+ * mapped by themselves. A two level map stores for each page how far it is
+ * from the start of its chunk, which is how free() finds the chunk of a block
+ * and tells blocks apart from memory that was allocated with malloc() before
+ * the allocator was installed. Larger allocations get their own mapping,
+ * which is returned to the OS when freed.
+ */
+
+/* MAP_ANONYMOUS and madvise are not part of the _POSIX_C_SOURCE that the
+ * private headers set, so request the default glibc feature set first. */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "../private_api.h"
+
+#ifdef FLECS_OS_ALLOC
+
+#ifdef ECS_TARGET_WINDOWS
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#define FLECS_ALLOC_PAGE_SHIFT (16)
+#define FLECS_ALLOC_PAGE_SIZE ((size_t)1 << FLECS_ALLOC_PAGE_SHIFT)
+#define FLECS_ALLOC_REGION_SIZE ((size_t)2 * 1024 * 1024)
+#define FLECS_ALLOC_HEADER_SIZE (64)
+#define FLECS_ALLOC_CHUNK_BLOCKS (16) /* Chunks of 256KB blocks are 65 pages */
+#define FLECS_ALLOC_SMALL_CLASS_COUNT (8) /* 16 byte steps up to 128 bytes */
+#define FLECS_ALLOC_MAX_CLASS_SIZE (256 * 1024)
+#define FLECS_ALLOC_BATCH_BYTES (32 * 1024)
+#define FLECS_ALLOC_BATCH_MAX (64)
+#define FLECS_ALLOC_MAP_LEAF_SHIFT (16)
+#define FLECS_ALLOC_MAP_LEAF_SIZE ((size_t)1 << FLECS_ALLOC_MAP_LEAF_SHIFT)
+#define FLECS_ALLOC_MAP_ROOT_SIZE (1 << 16) /* Covers 48 bit addresses */
+#define FLECS_ALLOC_LARGE (-1)
+
+#ifdef ECS_TARGET_MSVC
+#define FLECS_ALLOC_TLS __declspec(thread)
+#else
+#define FLECS_ALLOC_TLS __thread
+#endif
+
+/* Locks are held for a short time, except when a new chunk is mapped */
+#ifdef ECS_TARGET_WINDOWS
+typedef volatile LONG flecs_alloc_lock_t;
+#define flecs_alloc_try_lock(lock) (!InterlockedExchange(lock, 1))
+#define flecs_alloc_unlock(lock) InterlockedExchange(lock, 0)
+#define flecs_alloc_yield() SwitchToThread()
+#define flecs_alloc_add(ptr, value) InterlockedExchangeAdd64(ptr, value)
+#define flecs_alloc_cas(ptr, old, value)\
+    (InterlockedCompareExchange64(ptr, value, old) == (old))
+#define flecs_alloc_load32(ptr) ReadNoFence((volatile LONG*)(ptr))
+#define flecs_alloc_store32(ptr, value)\
+    WriteNoFence((volatile LONG*)(ptr), value)
+#define flecs_alloc_load64(ptr) ReadNoFence64(ptr)
+#define flecs_alloc_store64(ptr, value) WriteNoFence64(ptr, value)
+#else
+typedef volatile int32_t flecs_alloc_lock_t;
+#define flecs_alloc_try_lock(lock) (!__sync_lock_test_and_set(lock, 1))
+#define flecs_alloc_unlock(lock) __sync_lock_release(lock)
+#define flecs_alloc_yield() sched_yield()
+#define flecs_alloc_add(ptr, value) __sync_fetch_and_add(ptr, value)
+#define flecs_alloc_cas(ptr, old, value)\
+    __sync_bool_compare_and_swap(ptr, old, value)
+#define flecs_alloc_load32(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define flecs_alloc_store32(ptr, value)\
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#define flecs_alloc_load64(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define flecs_alloc_store64(ptr, value)\
+    __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#endif
+
+typedef struct flecs_alloc_block_t {
+    struct flecs_alloc_block_t *next;
+} flecs_alloc_block_t;
+
+/* Stored at the start of each chunk */
+typedef struct flecs_alloc_chunk_t {
+    int32_t size_class;         /* FLECS_ALLOC_LARGE for large allocations */
+    size_t size;                /* Mapped size of chunk */
+} flecs_alloc_chunk_t;
+
+/* Central heap of a size class */
+typedef union flecs_alloc_class_t {
+    struct {
+        flecs_alloc_lock_t lock;
+        int32_t size;
+        int32_t batch;          /* Blocks exchanged with a thread cache */
+        flecs_alloc_block_t *free; /* Blocks returned by thread caches */
+        char *cur;              /* Unused part of the current chunk */
+        char *end;
+        size_t chunk_size;
+    } h;
+    char padding[64];           /* Don't share cache lines between locks */
+} flecs_alloc_class_t;
+
+typedef struct flecs_alloc_bin_t {
+    flecs_alloc_block_t *first;
+    int32_t count;
+} flecs_alloc_bin_t;
+
+/* The counts of a thread cache are only written by its thread, but are read by
+ * ecs_os_alloc_stats_get on other threads, so they're accessed atomically */
+typedef struct flecs_alloc_cache_t {
+    flecs_alloc_bin_t bins[ECS_OS_ALLOC_CLASS_COUNT];
+    int64_t alloc_count[ECS_OS_ALLOC_CLASS_COUNT]; /* Allocated by thread */
+    int64_t free_count[ECS_OS_ALLOC_CLASS_COUNT];  /* Freed by thread */
+    struct flecs_alloc_cache_t *next;
+    bool in_use;                /* Caches of exited threads are reused */
+} flecs_alloc_cache_t;
+
+static struct {
+    flecs_alloc_class_t classes[ECS_OS_ALLOC_CLASS_COUNT];
+    flecs_alloc_lock_t lock;    /* Protects map, cache list and OS mappings */
+    uint8_t *map[FLECS_ALLOC_MAP_ROOT_SIZE];
+    char *region_cur;           /* Unused part of the current region */
+    char *region_end;
+    flecs_alloc_cache_t *caches;
+    int64_t outstanding_bytes;  /* Bytes handed out to thread caches */
+    int64_t peak_bytes;
+    int64_t reserved_bytes;
+    int64_t large_alloc_count;
+    int64_t large_live_bytes;
+    bool huge_pages;
+    bool no_hugetlb;            /* Explicit huge pages are not available */
+    bool initialized;
+#ifdef ECS_TARGET_WINDOWS
+    DWORD thread_exit_key;
+#else
+    pthread_key_t thread_exit_key;
+#endif
+} flecs_alloc;
+
+static FLECS_ALLOC_TLS flecs_alloc_cache_t *flecs_alloc_thread_cache;
+
+static
+void flecs_alloc_lock(
+    flecs_alloc_lock_t *lock)
+{
+    int32_t spin = 0;
+    while (!flecs_alloc_try_lock(lock)) {
+        if (++ spin > 64) {
+            flecs_alloc_yield();
+            spin = 0;
+        }
+    }
+}
+
+static
+int32_t flecs_alloc_class_of(
+    size_t size)
+{
+    if (size <= 128) {
+        return size ? (int32_t)((size + 15) >> 4) - 1 : 0;
+    }
+
+    /* Four classes for each power of two above 128 bytes */
+    size_t s = size - 1;
+    int32_t log2 = 7;
+    while (s >> (log2 + 1)) {
+        log2 ++;
+    }
+
+    return FLECS_ALLOC_SMALL_CLASS_COUNT + (log2 - 7) * 4 +
+        (int32_t)((s - ((size_t)1 << log2)) >> (log2 - 2));
+}
+
+static
+int32_t flecs_alloc_class_size(
+    int32_t size_class)
+{
+    if (size_class < FLECS_ALLOC_SMALL_CLASS_COUNT) {
+        return (size_class + 1) * 16;
+    }
+
+    int32_t c = size_class - FLECS_ALLOC_SMALL_CLASS_COUNT;
+    int32_t log2 = 7 + c / 4;
+    return (1 << log2) + ((c % 4) + 1) * (1 << (log2 - 2));
+}
+
+static
+void flecs_alloc_update_outstanding(
+    int64_t delta)
+{
+    int64_t value = flecs_alloc_add(&flecs_alloc.outstanding_bytes, delta);
+    value += delta;
+    if (delta > 0) {
+        int64_t peak;
+        while (value >
+            (peak = flecs_alloc_load64(&flecs_alloc.peak_bytes)))
+        {
+            if (flecs_alloc_cas(&flecs_alloc.peak_bytes, peak, value)) {
+                break;
+            }
+        }
+    }
+}
+
+/* Map memory from the OS at a region aligned address, so that regions can be
+ * backed by huge pages. Must be called with the allocator lock held. */
+static
+void* flecs_alloc_os_map(
+    size_t size)
+{
+#ifdef ECS_TARGET_WINDOWS
+    for (;;) {
+        char *raw = VirtualAlloc(NULL, size + FLECS_ALLOC_REGION_SIZE,
+            MEM_RESERVE, PAGE_NOACCESS);
+        if (!raw) {
+            return NULL;
+        }
+
+        VirtualFree(raw, 0, MEM_RELEASE);
+        char *aligned = (char*)(((uintptr_t)raw + FLECS_ALLOC_REGION_SIZE - 1) &
+            ~(uintptr_t)(FLECS_ALLOC_REGION_SIZE - 1));
+        void *result = VirtualAlloc(aligned, size,
+            MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (result) {
+            return result;
+        }
+
+        /* Another thread mapped memory in the range, try again */
+    }
+#else
+#ifdef MAP_HUGETLB
+    if (flecs_alloc.huge_pages && !flecs_alloc.no_hugetlb &&
+        !(size & (FLECS_ALLOC_REGION_SIZE - 1)))
+    {
+        /* Explicit huge pages are aligned to their size. This only succeeds
+         * if the system has huge pages reserved, otherwise fall back to
+         * transparent huge pages. */
+        void *result = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (result != MAP_FAILED) {
+            return result;
+        }
+        flecs_alloc.no_hugetlb = true;
+    }
+#endif
+
+    size_t map_size = size + FLECS_ALLOC_REGION_SIZE;
+    char *raw = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+
+    char *aligned = (char*)(((uintptr_t)raw + FLECS_ALLOC_REGION_SIZE - 1) &
+        ~(uintptr_t)(FLECS_ALLOC_REGION_SIZE - 1));
+    if (aligned != raw) {
+        munmap(raw, (size_t)(aligned - raw));
+    }
+    size_t tail = (size_t)((raw + map_size) - (aligned + size));
+    if (tail) {
+        munmap(aligned + size, tail);
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (flecs_alloc.huge_pages) {
+        madvise(aligned, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    return aligned;
+#endif
+}
+
+static
+void flecs_alloc_os_unmap(
+    void *ptr,
+    size_t size)
+{
+#ifdef ECS_TARGET_WINDOWS
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
+#endif
+}
+
+/* Mark the pages of a chunk as owned (or not owned) by the allocator. An owned
+ * page stores its distance to the start of the chunk plus one. Must be called
+ * with the allocator lock held. */
+static
+bool flecs_alloc_map_set(
+    void *ptr,
+    size_t size,
+    bool owned)
+{
+    uintptr_t first = (uintptr_t)ptr >> FLECS_ALLOC_PAGE_SHIFT, index;
+    uintptr_t last = first + (size >> FLECS_ALLOC_PAGE_SHIFT);
+    for (index = first; index < last; index ++) {
+        uintptr_t root = index >> FLECS_ALLOC_MAP_LEAF_SHIFT;
+        if (root >= FLECS_ALLOC_MAP_ROOT_SIZE) {
+            return false;
+        }
+
+        uint8_t *leaf = flecs_alloc.map[root];
+        if (!leaf) {
+            leaf = calloc(1, FLECS_ALLOC_MAP_LEAF_SIZE);
+            if (!leaf) {
+                return false;
+            }
+            flecs_alloc.map[root] = leaf;
+        }
+
+        leaf[index & (FLECS_ALLOC_MAP_LEAF_SIZE - 1)] =
+            owned ? (uint8_t)(index - first + 1) : 0;
+    }
+
+    return true;
+}
+
+static
+flecs_alloc_chunk_t* flecs_alloc_chunk_of(
+    void *ptr)
+{
+    uintptr_t index = (uintptr_t)ptr >> FLECS_ALLOC_PAGE_SHIFT;
+    uintptr_t root = index >> FLECS_ALLOC_MAP_LEAF_SHIFT;
+    if (root >= FLECS_ALLOC_MAP_ROOT_SIZE) {
+        return NULL;
+    }
+
+    uint8_t *leaf = flecs_alloc.map[root];
+    if (!leaf) {
+        return NULL;
+    }
+
+    uint8_t distance = leaf[index & (FLECS_ALLOC_MAP_LEAF_SIZE - 1)];
+    if (!distance) {
+        return NULL;
+    }
+
+    return (flecs_alloc_chunk_t*)((index - (distance - 1u)) <<
+        FLECS_ALLOC_PAGE_SHIFT);
+}
+
+/* Cut a chunk for a size class from the current region. The rest of a region
+ * that is too small for the chunk is left unused. */
+static
+flecs_alloc_chunk_t* flecs_alloc_region_take(
+    size_t size)
+{
+    if ((size_t)(flecs_alloc.region_end - flecs_alloc.region_cur) < size) {
+        char *region = flecs_alloc_os_map(FLECS_ALLOC_REGION_SIZE);
+        if (!region) {
+            return NULL;
+        }
+
+        /* Create the map leaves of the region up front, so marking the pages
+         * of its chunks can't fail */
+        if (!flecs_alloc_map_set(region, FLECS_ALLOC_REGION_SIZE, false)) {
+            flecs_alloc_os_unmap(region, FLECS_ALLOC_REGION_SIZE);
+            return NULL;
+        }
+
+        flecs_alloc.region_cur = region;
+        flecs_alloc.region_end = region + FLECS_ALLOC_REGION_SIZE;
+        flecs_alloc.reserved_bytes += (int64_t)FLECS_ALLOC_REGION_SIZE;
+    }
+
+    flecs_alloc_chunk_t *chunk = (flecs_alloc_chunk_t*)flecs_alloc.region_cur;
+    flecs_alloc.region_cur += size;
+    return chunk;
+}
+
+static
+flecs_alloc_chunk_t* flecs_alloc_chunk_new(
+    int32_t size_class,
+    size_t size)
+{
+    /* Use whole pages, so that no memory the allocator doesn't own ends up in
+     * a page that is marked as owned */
+    size = (size + FLECS_ALLOC_PAGE_SIZE - 1) & ~(FLECS_ALLOC_PAGE_SIZE - 1);
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_chunk_t *chunk;
+    if (size_class != FLECS_ALLOC_LARGE && size < FLECS_ALLOC_REGION_SIZE) {
+        chunk = flecs_alloc_region_take(size);
+        if (chunk) {
+            flecs_alloc_map_set(chunk, size, true);
+        }
+    } else {
+        /* Pointers passed to free() only point into the first page of a
+         * large allocation, and a page can't be further than 255 pages from
+         * the start of its chunk, so only the first page is marked. */
+        size_t marked = size_class == FLECS_ALLOC_LARGE ?
+            FLECS_ALLOC_PAGE_SIZE : size;
+        chunk = flecs_alloc_os_map(size);
+        if (chunk) {
+            if (flecs_alloc_map_set(chunk, marked, true)) {
+                flecs_alloc.reserved_bytes += (int64_t)size;
+            } else {
+                flecs_alloc_map_set(chunk, marked, false);
+                flecs_alloc_os_unmap(chunk, size);
+                chunk = NULL;
+            }
+        }
+    }
+
+    if (chunk) {
+        chunk->size_class = size_class;
+        chunk->size = size;
+    }
+    flecs_alloc_unlock(&flecs_alloc.lock);
+
+    return chunk;
+}
+
+static
+void* flecs_alloc_large(
+    size_t size)
+{
+    flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_new(
+        FLECS_ALLOC_LARGE, size + FLECS_ALLOC_HEADER_SIZE);
+    if (!chunk) {
+        /* Address space is not covered by the map, leave it to the C lib */
+        return malloc(size);
+    }
+
+    flecs_alloc_add(&flecs_alloc.large_alloc_count, 1);
+    flecs_alloc_add(&flecs_alloc.large_live_bytes, (int64_t)chunk->size);
+    flecs_alloc_update_outstanding((int64_t)chunk->size);
+
+    return ECS_OFFSET(chunk, FLECS_ALLOC_HEADER_SIZE);
+}
+
+static
+void flecs_alloc_large_free(
+    flecs_alloc_chunk_t *chunk)
+{
+    int64_t size = (int64_t)chunk->size;
+    flecs_alloc_add(&flecs_alloc.large_live_bytes, -size);
+    flecs_alloc_update_outstanding(-size);
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_map_set(chunk, FLECS_ALLOC_PAGE_SIZE, false);
+    flecs_alloc.reserved_bytes -= size;
+    flecs_alloc_os_unmap(chunk, chunk->size);
+    flecs_alloc_unlock(&flecs_alloc.lock);
+}
+
+static
+void flecs_alloc_thread_exit(
+    void *ptr);
+
+static
+flecs_alloc_cache_t* flecs_alloc_cache_new(void) {
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_cache_t *cache = flecs_alloc.caches;
+    while (cache && cache->in_use) {
+        cache = cache->next;
+    }
+
+    if (!cache) {
+        cache = calloc(1, sizeof(flecs_alloc_cache_t));
+        if (cache) {
+            cache->next = flecs_alloc.caches;
+            flecs_alloc.caches = cache;
+        }
+    }
+
+    if (cache) {
+        cache->in_use = true;
+    }
+    flecs_alloc_unlock(&flecs_alloc.lock);
+
+    if (cache) {
+        /* Register the cache so its blocks are returned when the thread exits */
+#ifdef ECS_TARGET_WINDOWS
+        FlsSetValue(flecs_alloc.thread_exit_key, cache);
+#else
+        pthread_setspecific(flecs_alloc.thread_exit_key, cache);
+#endif
+        flecs_alloc_thread_cache = cache;
+    }
+
+    return cache;
+}
+
+/* Move count blocks from a thread cache bin to the central heap */
+static
+void flecs_alloc_bin_release(
+    flecs_alloc_bin_t *bin,
+    int32_t size_class,
+    int32_t count)
+{
+    flecs_alloc_class_t *cl = &flecs_alloc.classes[size_class];
+    flecs_alloc_block_t *first = bin->first, *last = first;
+    int32_t i;
+    for (i = 1; i < count; i ++) {
+        last = last->next;
+    }
+
+    bin->first = last->next;
+    flecs_alloc_store32(&bin->count, bin->count - count);
+
+    flecs_alloc_lock(&cl->h.lock);
+    last->next = cl->h.free;
+    cl->h.free = first;
+    flecs_alloc_unlock(&cl->h.lock);
+
+    flecs_alloc_update_outstanding(-(int64_t)count * cl->h.size);
+}
+
+/* Fill an empty thread cache bin with a batch from the central heap */
+static
+bool flecs_alloc_bin_refill(
+    flecs_alloc_bin_t *bin,
+    int32_t size_class)
+{
+    flecs_alloc_class_t *cl = &flecs_alloc.classes[size_class];
+    int32_t size = cl->h.size, batch = cl->h.batch, count = 0;
+    size_t chunk_size = cl->h.chunk_size;
+    flecs_alloc_block_t *first = NULL;
+
+    flecs_alloc_lock(&cl->h.lock);
+    while (count < batch) {
+        flecs_alloc_block_t *block = cl->h.free;
+        if (block) {
+            cl->h.free = block->next;
+        } else {
+            if ((cl->h.end - cl->h.cur) < size) {
+                flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_new(
+                    size_class, chunk_size);
+                if (!chunk) {
+                    break;
+                }
+                cl->h.cur = ECS_OFFSET(chunk, FLECS_ALLOC_HEADER_SIZE);
+                cl->h.end = ECS_OFFSET(chunk, chunk->size);
+            }
+            block = (flecs_alloc_block_t*)cl->h.cur;
+            cl->h.cur += size;
+        }
+
+        block->next = first;
+        first = block;
+        count ++;
+    }
+    flecs_alloc_unlock(&cl->h.lock);
+
+    if (!count) {
+        return false;
+    }
+
+    bin->first = first;
+    flecs_alloc_store32(&bin->count, count);
+    flecs_alloc_update_outstanding((int64_t)count * size);
+
+    return true;
+}
+
+static
+void flecs_alloc_thread_exit(
+    void *ptr)
+{
+    flecs_alloc_cache_t *cache = ptr;
+    int32_t i;
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        flecs_alloc_bin_t *bin = &cache->bins[i];
+        if (bin->count) {
+            flecs_alloc_bin_release(bin, i, bin->count);
+        }
+    }
+
+    flecs_alloc_thread_cache = NULL;
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    cache->in_use = false;
+    flecs_alloc_unlock(&flecs_alloc.lock);
+}
+
+#ifdef ECS_TARGET_WINDOWS
+static
+void WINAPI flecs_alloc_fls_callback(
+    void *ptr)
+{
+    if (ptr) {
+        flecs_alloc_thread_exit(ptr);
+    }
+}
+#endif
+
+static
+void* flecs_alloc_block(
+    size_t size)
+{
+    if (size > FLECS_ALLOC_MAX_CLASS_SIZE) {
+        return flecs_alloc_large(size);
+    }
+
+    flecs_alloc_cache_t *cache = flecs_alloc_thread_cache;
+    if (!cache) {
+        cache = flecs_alloc_cache_new();
+        if (!cache) {
+            return NULL;
+        }
+    }
+
+    int32_t size_class = flecs_alloc_class_of(size);
+    flecs_alloc_bin_t *bin = &cache->bins[size_class];
+    flecs_alloc_block_t *block = bin->first;
+    if (!block) {
+        if (!flecs_alloc_bin_refill(bin, size_class)) {
+            return NULL;
+        }
+        block = bin->first;
+    }
+
+    bin->first = block->next;
+    flecs_alloc_store32(&bin->count, bin->count - 1);
+    flecs_alloc_store64(&cache->alloc_count[size_class],
+        cache->alloc_count[size_class] + 1);
+
+    return block;
+}
+
+static
+void flecs_alloc_block_free(
+    void *ptr)
+{
+    flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_of(ptr);
+    if (!chunk) {
+        /* Allocated before the allocator was installed */
+        free(ptr);
+        return;
+    }
+
+    int32_t size_class = chunk->size_class;
+    if (size_class == FLECS_ALLOC_LARGE) {
+        flecs_alloc_large_free(chunk);
+        return;
+    }
+
+    flecs_alloc_cache_t *cache = flecs_alloc_thread_cache;
+    if (!cache) {
+        cache = flecs_alloc_cache_new();
+        if (!cache) {
+            /* Can't cache the block, give it straight back to the heap */
+            flecs_alloc_bin_t bin = { ptr, 1 };
+            ((flecs_alloc_block_t*)ptr)->next = NULL;
+            flecs_alloc_bin_release(&bin, size_class, 1);
+            return;
+        }
+    }
+
+    flecs_alloc_bin_t *bin = &cache->bins[size_class];
+    flecs_alloc_block_t *block = ptr;
+    block->next = bin->first;
+    bin->first = block;
+    flecs_alloc_store32(&bin->count, bin->count + 1);
+    flecs_alloc_store64(&cache->free_count[size_class],
+        cache->free_count[size_class] + 1);
+
+    /* Keep up to two batches, so alternating allocs and frees don't cause a
+     * batch to be exchanged each time */
+    int32_t batch = flecs_alloc.classes[size_class].h.batch;
+    if (bin->count > 2 * batch) {
+        flecs_alloc_bin_release(bin, size_class, batch);
+    }
+}
+
+static
+void* flecs_alloc_malloc(
+    ecs_size_t size)
+{
+    ecs_os_linc(&ecs_os_api_malloc_count);
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+    return flecs_alloc_block((size_t)size);
+}
+
+static
+void* flecs_alloc_calloc(
+    ecs_size_t size)
+{
+    ecs_os_linc(&ecs_os_api_calloc_count);
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+    void *result = flecs_alloc_block((size_t)size);
+    if (result) {
+        ecs_os_memset(result, 0, size);
+    }
+    return result;
+}
+
+static
+void* flecs_alloc_realloc(
+    void *ptr,
+    ecs_size_t size)
+{
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!ptr) {
+        /* If not actually reallocing, treat as malloc */
+        ecs_os_linc(&ecs_os_api_malloc_count);
+        return flecs_alloc_block((size_t)size);
+    }
+
+    ecs_os_linc(&ecs_os_api_realloc_count);
+
+    flecs_alloc_chunk_t *chunk = flecs_alloc_chunk_of(ptr);
+    if (!chunk) {
+        return realloc(ptr, (size_t)size);
+    }
+
+    size_t old_size;
+    if (chunk->size_class == FLECS_ALLOC_LARGE) {
+        old_size = chunk->size - FLECS_ALLOC_HEADER_SIZE;
+        if ((size_t)size <= old_size &&
+            (size_t)size > FLECS_ALLOC_MAX_CLASS_SIZE)
+        {
+            return ptr;
+        }
+    } else {
+        old_size = (size_t)flecs_alloc_class_size(chunk->size_class);
+        if ((size_t)size <= FLECS_ALLOC_MAX_CLASS_SIZE &&
+            flecs_alloc_class_of((size_t)size) == chunk->size_class)
+        {
+            return ptr;
+        }
+    }
+
+    void *result = flecs_alloc_block((size_t)size);
+    if (result) {
+        ecs_os_memcpy(result, ptr, ECS_MIN((size_t)size, old_size));
+        flecs_alloc_block_free(ptr);
+    }
+
+    return result;
+}
+
+static
+void flecs_alloc_free(
+    void *ptr)
+{
+    if (ptr) {
+        ecs_os_linc(&ecs_os_api_free_count);
+        flecs_alloc_block_free(ptr);
+    }
+}
+
+static
+void flecs_alloc_init(
+    bool huge_pages)
+{
+    flecs_alloc.huge_pages = huge_pages;
+
+    int32_t i;
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        flecs_alloc_class_t *cl = &flecs_alloc.classes[i];
+        int32_t size = flecs_alloc_class_size(i);
+        int32_t batch = FLECS_ALLOC_BATCH_BYTES / size;
+        size_t chunk_size = FLECS_ALLOC_HEADER_SIZE +
+            (size_t)size * FLECS_ALLOC_CHUNK_BLOCKS;
+        cl->h.size = size;
+        cl->h.batch = ECS_MAX(2, ECS_MIN(batch, FLECS_ALLOC_BATCH_MAX));
+        cl->h.chunk_size = ECS_MAX(chunk_size, FLECS_ALLOC_PAGE_SIZE);
+    }
+
+#ifdef ECS_TARGET_WINDOWS
+    flecs_alloc.thread_exit_key = FlsAlloc(flecs_alloc_fls_callback);
+#else
+    pthread_key_create(&flecs_alloc.thread_exit_key, flecs_alloc_thread_exit);
+#endif
+
+    flecs_alloc.initialized = true;
+}
+
+void ecs_os_alloc_set_api(
+    ecs_os_api_t *os_api,
+    bool huge_pages)
+{
+    ecs_assert(os_api != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    if (!flecs_alloc.initialized) {
+        flecs_alloc_init(huge_pages);
+    }
+
+    os_api->malloc_ = flecs_alloc_malloc;
+    os_api->calloc_ = flecs_alloc_calloc;
+    os_api->realloc_ = flecs_alloc_realloc;
+    os_api->free_ = flecs_alloc_free;
+}
+
+bool ecs_os_alloc_stats_get(
+    ecs_os_alloc_stats_t *stats)
+{
+    ecs_assert(stats != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_os_zeromem(stats);
+
+    if (!flecs_alloc.initialized) {
+        return false;
+    }
+
+    int32_t i;
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        stats->class_size[i] = flecs_alloc.classes[i].h.size;
+    }
+
+    flecs_alloc_lock(&flecs_alloc.lock);
+    flecs_alloc_cache_t *cache;
+    for (cache = flecs_alloc.caches; cache; cache = cache->next) {
+        for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+            int64_t alloc_count = flecs_alloc_load64(&cache->alloc_count[i]);
+            int64_t free_count = flecs_alloc_load64(&cache->free_count[i]);
+            int32_t cached = flecs_alloc_load32(&cache->bins[i].count);
+            stats->class_alloc_count[i] += alloc_count;
+            stats->class_live_count[i] += alloc_count - free_count;
+            stats->cached_bytes += (int64_t)cached * stats->class_size[i];
+        }
+        stats->thread_count += cache->in_use;
+    }
+    stats->reserved_bytes = flecs_alloc.reserved_bytes;
+    flecs_alloc_unlock(&flecs_alloc.lock);
+
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        stats->live_bytes += stats->class_live_count[i] * stats->class_size[i];
+    }
+
+    stats->large_alloc_count =
+        flecs_alloc_load64(&flecs_alloc.large_alloc_count);
+    stats->large_live_bytes =
+        flecs_alloc_load64(&flecs_alloc.large_live_bytes);
+    stats->live_bytes += stats->large_live_bytes;
+    stats->peak_bytes = flecs_alloc_load64(&flecs_alloc.peak_bytes);
+
+    return true;
+}
+
+#endif
@@ -601,7 +601,7 @@ void flecs_run_pipeline(
         world->info.system_time_total += (ecs_ftime_t)ecs_time_measure(&st);
     }
 
-    flecs_worker_end(world, stage);
+    flecs_worker_end(world, stage, pq);
 
     return;
 }
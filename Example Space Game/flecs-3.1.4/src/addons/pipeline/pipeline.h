@@ -35,6 +35,11 @@ typedef struct ecs_pipeline_state_t {
     int32_t cur_i;              /* Index in current result */
     int32_t ran_since_merge;    /* Index in current op */
     bool no_readonly;           /* Is pipeline in readonly mode */
+
+    /* Sync point statistics, only written by the main thread */
+    int64_t sync_count_total;       /* Number of sync points */
+    double sync_time_total;         /* Time spent in sync points (wait & merge) */
+    double sync_wait_time_total;    /* Time spent waiting on workers */
 } ecs_pipeline_state_t;
 
 typedef struct EcsPipeline {
@@ -68,7 +73,8 @@ bool flecs_worker_begin(
 
 void flecs_worker_end(
     ecs_world_t *world,
-    ecs_stage_t *stage);
+    ecs_stage_t *stage,
+    ecs_pipeline_state_t *pq);
 
 bool flecs_worker_sync(
     ecs_world_t *world,
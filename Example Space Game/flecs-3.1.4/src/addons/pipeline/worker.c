@@ -9,11 +9,146 @@
 #ifdef FLECS_PIPELINE
 #include "pipeline.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Bounds for the number of times a thread polls a barrier before it parks on
+ * a condition variable. Most sync points are short, so spinning avoids a round
+ * trip through the kernel for each merge. The budget adapts per thread, so
+ * that threads stop spinning when that doesn't pay off, for example when there
+ * are more threads than cores. */
+#define FLECS_WORKER_SPIN_MIN (16)
+#define FLECS_WORKER_SPIN_MAX (4096)
+
 typedef struct ecs_worker_state_t {
     ecs_stage_t *stage;
     ecs_pipeline_state_t *pq;
 } ecs_worker_state_t;
 
+/* Read barrier counter written by other threads (acquire semantics) */
+static
+int32_t flecs_worker_load(
+    int32_t *ptr)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    int32_t result = *(volatile int32_t*)ptr;
+    _ReadWriteBarrier();
+    return result;
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchange((volatile long*)ptr, 0, 0);
+#else
+    return *(volatile int32_t*)ptr;
+#endif
+}
+
+/* Hint to the CPU that the thread is spinning */
+static
+void flecs_worker_pause(void) {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __yield();
+#endif
+}
+
+/* Get spin budget for thread. Threads start out with the maximum budget. */
+static
+int32_t flecs_spin_get(
+    ecs_stage_t *stage)
+{
+    return stage->sync_spin ? stage->sync_spin : FLECS_WORKER_SPIN_MAX;
+}
+
+/* Grow spin budget if spinning was enough to pass the barrier, shrink if not */
+static
+void flecs_spin_update(
+    ecs_stage_t *stage,
+    int32_t spin,
+    bool spin_passed)
+{
+    if (spin_passed) {
+        spin *= 2;
+        spin = spin > FLECS_WORKER_SPIN_MAX ? FLECS_WORKER_SPIN_MAX : spin;
+    } else {
+        spin /= 2;
+    }
+    stage->sync_spin = spin < FLECS_WORKER_SPIN_MIN ? FLECS_WORKER_SPIN_MIN : spin;
+}
+
+/* Wake up main thread if it parked while waiting on workers */
+static
+void flecs_wake_main(
+    ecs_world_t *world)
+{
+    ecs_os_mutex_lock(world->sync_mutex);
+    if (world->main_parked) {
+        ecs_os_cond_signal(world->sync_cond);
+    }
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
+/* Wait on main thread until a counter incremented by workers reaches value */
+static
+void flecs_wait_main(
+    ecs_world_t *world,
+    int32_t *counter,
+    int32_t value)
+{
+    ecs_stage_t *stage = &world->stages[0];
+    int32_t i, spin = flecs_spin_get(stage);
+    for (i = 0; i < spin; i ++) {
+        if (flecs_worker_load(counter) == value) {
+            flecs_spin_update(stage, spin, true);
+            return;
+        }
+        flecs_worker_pause();
+    }
+
+    flecs_spin_update(stage, spin, false);
+
+    ecs_os_mutex_lock(world->sync_mutex);
+    while (flecs_worker_load(counter) != value) {
+        world->main_parked = true;
+        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+    }
+    world->main_parked = false;
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
+/* Wait on worker thread until main thread moves past generation */
+static
+void flecs_wait_worker(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    int32_t generation)
+{
+    int32_t i, spin = flecs_spin_get(stage);
+    for (i = 0; i < spin; i ++) {
+        if (flecs_worker_load(&world->worker_generation) != generation) {
+            flecs_spin_update(stage, spin, true);
+            return;
+        }
+        flecs_worker_pause();
+    }
+
+    flecs_spin_update(stage, spin, false);
+
+    ecs_os_mutex_lock(world->sync_mutex);
+    while (flecs_worker_load(&world->worker_generation) == generation) {
+        world->workers_parked ++;
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+        world->workers_parked --;
+    }
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
 /* Worker thread */
 static
 void* flecs_worker(void *arg) {
@@ -28,15 +163,16 @@ void* flecs_worker(void *arg) {
     ecs_dbg_2("worker %d: start", stage->id);
 
     /* Start worker, increase counter so main thread knows how many
-     * workers are ready */
-    ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running ++;
-
-    if (!(world->flags & EcsWorldQuitWorkers)) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+     * workers are ready. The generation must be read before the counter is
+     * increased, as the main thread may release workers right after. */
+    int32_t generation = flecs_worker_load(&world->worker_generation);
+    if (ecs_os_ainc(&world->workers_running) == 
+        (ecs_get_stage_count(world) - 1)) 
+    {
+        flecs_wake_main(world);
     }
 
-    ecs_os_mutex_unlock(world->sync_mutex);
+    flecs_wait_worker(world, stage, generation);
 
     while (!(world->flags & EcsWorldQuitWorkers)) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
@@ -50,9 +186,7 @@ void* flecs_worker(void *arg) {
 
     ecs_dbg_2("worker %d: finalizing", stage->id);
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    world->workers_running --;
-    ecs_os_mutex_unlock(world->sync_mutex);
+    ecs_os_adec(&world->workers_running);
 
     ecs_dbg_2("worker %d: stop", stage->id);
 
@@ -119,14 +253,7 @@ void flecs_wait_for_workers(
         return;
     }
 
-    bool wait = true;
-    do {
-        ecs_os_mutex_lock(world->sync_mutex);
-        if (world->workers_running == (stage_count - 1)) {
-            wait = false;
-        }
-        ecs_os_mutex_unlock(world->sync_mutex);
-    } while (wait);
+    flecs_wait_main(world, &world->workers_running, stage_count - 1);
 }
 
 /* Wait until all threads are waiting on sync point */
@@ -141,17 +268,11 @@ void flecs_wait_for_sync(
 
     ecs_dbg_3("#[bold]pipeline: waiting for worker sync");
 
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != (stage_count - 1)) {
-        ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
-    }
-
-    /* We shouldn't have been signalled unless all workers are waiting on sync */
-    ecs_assert(world->workers_waiting == (stage_count - 1), 
-        ECS_INTERNAL_ERROR, NULL);
+    flecs_wait_main(world, &world->workers_waiting, stage_count - 1);
 
+    /* Workers don't touch the counter again until they are released by the
+     * next generation, which publishes the reset. */
     world->workers_waiting = 0;
-    ecs_os_mutex_unlock(world->sync_mutex);
 
     ecs_dbg_3("#[bold]pipeline: workers synced");
 }
@@ -159,23 +280,25 @@ void flecs_wait_for_sync(
 /* Synchronize workers */
 static
 void flecs_sync_worker(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t stage_count = ecs_get_stage_count(world);
     if (stage_count <= 1) {
         return;
     }
 
-    /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == (stage_count - 1)) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    /* Read generation before signalling that the thread is waiting, so that
+     * the release by the main thread can't be missed */
+    int32_t generation = flecs_worker_load(&world->worker_generation);
+
+    /* Only wake main thread when all threads are waiting */
+    if (ecs_os_ainc(&world->workers_waiting) == (stage_count - 1)) {
+        flecs_wake_main(world);
     }
 
     /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    flecs_wait_worker(world, stage, generation);
 }
 
 /* Signal workers that they can start/resume work */
@@ -189,8 +312,15 @@ void flecs_signal_workers(
     }
 
     ecs_dbg_3("#[bold]pipeline: signal workers");
+
+    /* Spinning workers resume as soon as they see the new generation. Only
+     * go through the condition variable if a worker has parked. */
+    ecs_os_ainc(&world->worker_generation);
+
     ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
+    if (world->workers_parked) {
+        ecs_os_cond_broadcast(world->worker_cond);
+    }
     ecs_os_mutex_unlock(world->sync_mutex);
 }
 
@@ -285,24 +415,43 @@ bool flecs_worker_begin(
 
 void flecs_worker_end(
     ecs_world_t *world,
-    ecs_stage_t *stage)
+    ecs_stage_t *stage,
+    ecs_pipeline_state_t *pq)
 {
     ecs_poly_assert(world, ecs_world_t);
     ecs_poly_assert(stage, ecs_stage_t);
 
-    if (flecs_is_multithreaded(world)) {
-        if (flecs_is_main_thread(stage)) {
-            flecs_wait_for_sync(world);
-        } else {
-            flecs_sync_worker(world);
+    if (!flecs_is_main_thread(stage)) {
+        if (flecs_is_multithreaded(world)) {
+            flecs_sync_worker(world, stage);
         }
+        return;
     }
 
-    if (flecs_is_main_thread(stage)) {
-        if (ecs_stage_is_readonly(world)) {
-            ecs_readonly_end(world);
+    ecs_time_t t = {0};
+    bool measure_time = world->flags & EcsWorldMeasureSystemTime;
+    if (measure_time) {
+        ecs_time_measure(&t);
+    }
+
+    if (flecs_is_multithreaded(world)) {
+        flecs_wait_for_sync(world);
+        if (measure_time) {
+            double wait_time = ecs_time_measure(&t);
+            pq->sync_wait_time_total += wait_time;
+            pq->sync_time_total += wait_time;
         }
     }
+
+    if (ecs_stage_is_readonly(world)) {
+        ecs_readonly_end(world);
+    }
+
+    if (measure_time) {
+        pq->sync_time_total += ecs_time_measure(&t);
+    }
+
+    pq->sync_count_total ++;
 }
 
 bool flecs_worker_sync(
@@ -317,7 +466,7 @@ bool flecs_worker_sync(
     bool main_thread = flecs_is_main_thread(stage);
 
     /* Synchronize workers */
-    flecs_worker_end(world, stage);
+    flecs_worker_end(world, stage, pq);
 
     /* Store the current state of the schedule after we synchronized the
      * threads, to avoid race conditions. */
@@ -17,6 +17,32 @@
 
 #define STACK_MAX_SIZE (64)
 
+/* Initial size of the buffer that files are read into */
+#define PLECS_READ_SIZE (64 * 1024)
+
+/* Entity of the statement that is being parsed. The entity isn't created
+ * until the statement is done: its ids are added to the row and its values
+ * parsed into the row, so the entity can be created in bulk. */
+typedef struct {
+    ecs_entity_t entity;
+    const char *name;
+    ecs_id_t ids[ECS_ID_CACHE_SIZE];
+    void *values[ECS_ID_CACHE_SIZE];
+    int32_t id_count;
+} plecs_row_t;
+
+/* Rows of consecutive statements that have the same ids, created with a
+ * single ecs_bulk_init when a statement with different ids is parsed */
+typedef struct {
+    ecs_id_t ids[ECS_ID_CACHE_SIZE];
+    const ecs_type_info_t *type_info[ECS_ID_CACHE_SIZE];
+    ecs_vec_t values[ECS_ID_CACHE_SIZE]; /* vec<void*>, values of component */
+    ecs_vec_t entities;
+    ecs_hashmap_t names; /* names of the rows, for lookups */
+    int32_t id_count;
+    bool observed;
+} plecs_batch_t;
+
 typedef struct {
     const char *name;
     const char *code;
@@ -41,6 +67,19 @@ typedef struct {
     char *annot[STACK_MAX_SIZE];
     int32_t annot_count;
 
+    /* Cache with identifiers that were resolved in a scope */
+    ecs_map_t lookup_cache;     /* map<scope, name index> */
+    ecs_hashmap_t lookup_names; /* identifiers in the cache */
+
+    int32_t entity_count;
+    int32_t cache_hit_count;
+    int32_t bulk_count;
+
+    /* Entities that are created in bulk, if the world isn't deferred */
+    plecs_row_t row;
+    plecs_batch_t batch;
+    bool bulk;
+
 #ifdef FLECS_EXPR
     ecs_vars_t vars;
     char var_name[256];
@@ -58,6 +97,398 @@ typedef struct {
     int32_t errors;
 } plecs_state_t;
 
+static
+void plecs_cache_clear(
+    plecs_state_t *state)
+{
+    ecs_map_iter_t it = ecs_map_iter(&state->lookup_cache);
+    while (ecs_map_next(&it)) {
+        ecs_hashmap_t *names = ecs_map_ptr(&it);
+        flecs_hashmap_iter_t nit = flecs_hashmap_iter(names);
+        ecs_hashed_string_t *key;
+        while (_flecs_hashmap_next(&nit, ECS_SIZEOF(ecs_hashed_string_t), 
+            &key, ECS_SIZEOF(uint64_t))) 
+        {
+            ecs_os_free(key->value);
+        }
+        flecs_name_index_fini(names);
+        ecs_os_free(names);
+    }
+
+    ecs_map_clear(&state->lookup_cache);
+    flecs_name_index_fini(&state->lookup_names);
+    flecs_name_index_init(&state->lookup_names, NULL);
+}
+
+static
+ecs_entity_t plecs_cache_get(
+    const ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t scope,
+    const ecs_hashed_string_t *key)
+{
+    ecs_hashmap_t *names = ecs_map_get_deref(
+        &state->lookup_cache, ecs_hashmap_t, scope);
+    if (!names) {
+        return 0;
+    }
+
+    ecs_entity_t e = flecs_name_index_find(
+        names, key->value, key->length, key->hash);
+    if (e && !ecs_is_alive(world, e)) {
+        return 0;
+    }
+
+    return e;
+}
+
+static
+void plecs_cache_set(
+    plecs_state_t *state,
+    ecs_entity_t scope,
+    const ecs_hashed_string_t *key,
+    ecs_entity_t e)
+{
+    ecs_hashmap_t **names = ecs_map_ensure_ref(
+        &state->lookup_cache, ecs_hashmap_t, scope);
+    if (!names[0]) {
+        names[0] = ecs_os_calloc_t(ecs_hashmap_t);
+        flecs_name_index_init(names[0], NULL);
+    }
+
+    uint64_t *ptr = (uint64_t*)flecs_name_index_find_ptr(
+        names[0], key->value, key->length, key->hash);
+    if (ptr) {
+        ptr[0] = e;
+        return;
+    }
+
+    /* The cache owns the identifiers, the name set points to the same string */
+    char *path = ecs_os_strdup(key->value);
+    flecs_name_index_ensure(names[0], e, path, key->length, key->hash);
+    if (!flecs_name_index_find(
+        &state->lookup_names, path, key->length, key->hash)) 
+    {
+        flecs_name_index_ensure(
+            &state->lookup_names, 1, path, key->length, key->hash);
+    }
+}
+
+/* A new entity can shadow an identifier that resolved to an entity in a
+ * parent scope or a using scope, which invalidates the cache. */
+static
+void plecs_cache_invalidate(
+    plecs_state_t *state,
+    const char *path)
+{
+    const char *name = strrchr(path, '.');
+    name = name ? name + 1 : path;
+
+    if (flecs_name_index_find(&state->lookup_names, path, 0, 0) ||
+        flecs_name_index_find(&state->lookup_names, name, 0, 0)) 
+    {
+        plecs_cache_clear(state);
+    }
+}
+
+static
+void plecs_value_free(
+    ecs_world_t *world,
+    const ecs_type_info_t *ti,
+    void *ptr)
+{
+    ecs_value_fini_w_type_info(world, ti, ptr);
+    flecs_free(&world->allocator, ti->size, ptr);
+}
+
+/* Create the entities of the batch in the table for its ids */
+static
+void plecs_batch_flush(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    plecs_batch_t *batch = &state->batch;
+    int32_t i, j, count = ecs_vec_count(&batch->entities);
+    if (!count) {
+        return;
+    }
+
+    /* The values of each row were parsed in memory of their own, move them to
+     * the array per component that ecs_bulk_init moves into the table */
+    ecs_bulk_desc_t desc = {
+        .entities = ecs_vec_first(&batch->entities),
+        .count = count
+    };
+    void *data[ECS_ID_CACHE_SIZE] = {0};
+
+    for (i = 0; i < batch->id_count; i ++) {
+        desc.ids[i] = batch->ids[i];
+
+        const ecs_type_info_t *ti = batch->type_info[i];
+        if (!ti) {
+            continue;
+        }
+
+        ecs_size_t size = ti->size;
+        void **values = ecs_vec_first(&batch->values[i]);
+        data[i] = ecs_os_malloc(size * count);
+        for (j = 0; j < count; j ++) {
+            void *dst = ECS_ELEM(data[i], size, j);
+            if (ti->hooks.move_ctor) {
+                ti->hooks.move_ctor(dst, values[j], 1, ti);
+                ecs_value_fini_w_type_info(world, ti, values[j]);
+            } else {
+                ecs_os_memcpy(dst, values[j], size);
+            }
+            flecs_free(&world->allocator, size, values[j]);
+        }
+        ecs_vec_clear(&batch->values[i]);
+    }
+
+    desc.data = data;
+    ecs_bulk_init(world, &desc);
+    state->bulk_count ++;
+
+    for (i = 0; i < batch->id_count; i ++) {
+        const ecs_type_info_t *ti = batch->type_info[i];
+        if (ti) {
+            ecs_xtor_t dtor = ti->hooks.dtor;
+            if (dtor) {
+                dtor(data[i], count, ti);
+            }
+            ecs_os_free(data[i]);
+        }
+    }
+
+    ecs_vec_clear(&batch->entities);
+    flecs_name_index_fini(&batch->names);
+    flecs_name_index_init(&batch->names, NULL);
+}
+
+/* Add the row of the last statement to the batch. A row is created by itself
+ * if it has a component that wasn't assigned a value, as ecs_bulk_init would
+ * invoke OnSet for it, or if its components have OnAdd or OnSet observers, as
+ * those would run for all rows at once while the world is deferred. The pairs
+ * of a row are its parent and name, for which the builtin observers and hooks
+ * handle any number of entities. */
+static
+void plecs_row_commit(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    plecs_row_t *row = &state->row;
+    plecs_batch_t *batch = &state->batch;
+    ecs_entity_t e = row->entity;
+    if (!e) {
+        return;
+    }
+
+    row->entity = 0;
+
+    int32_t i, count = row->id_count;
+    if (count != batch->id_count || ecs_os_memcmp(row->ids, batch->ids, 
+        count * ECS_SIZEOF(ecs_id_t))) 
+    {
+        plecs_batch_flush(world, state);
+
+        ecs_flags32_t observed = EcsIdHasOnAdd|EcsIdHasOnSet;
+        batch->observed = world->idr_wildcard->flags & observed;
+        for (i = 0; i < count; i ++) {
+            ecs_id_t id = batch->ids[i] = row->ids[i];
+            batch->type_info[i] = ecs_get_type_info(world, id);
+            if (!ECS_IS_PAIR(id)) {
+                ecs_id_record_t *idr = flecs_id_record_get(world, id);
+                batch->observed |= idr && (idr->flags & observed);
+            }
+        }
+        batch->id_count = count;
+    }
+
+    bool batched = !batch->observed;
+    for (i = 0; batched && i < count; i ++) {
+        batched = !batch->type_info[i] || row->values[i];
+    }
+
+    if (batched) {
+        ecs_vec_append_t(NULL, &batch->entities, ecs_entity_t)[0] = e;
+        for (i = 0; i < count; i ++) {
+            if (batch->type_info[i]) {
+                ecs_vec_append_t(NULL, &batch->values[i], void*)[0] = 
+                    row->values[i];
+            }
+        }
+        flecs_name_index_ensure(&batch->names, e, row->name, 0, 0);
+        return;
+    }
+
+    plecs_batch_flush(world, state);
+
+    for (i = 0; i < count; i ++) {
+        void *value = row->values[i];
+        if (value) {
+            const ecs_type_info_t *ti = batch->type_info[i];
+            ecs_set_id(world, e, row->ids[i], flecs_itosize(ti->size), value);
+            plecs_value_free(world, ti, value);
+        } else {
+            ecs_add_id(world, e, row->ids[i]);
+        }
+    }
+}
+
+/* Create the entities that weren't created yet */
+static
+void plecs_flush(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    plecs_row_commit(world, state);
+    plecs_batch_flush(world, state);
+}
+
+/* Start the row for the entity of a new statement. Returns 0 if the entity
+ * can't be created in bulk, in which case it's created right away. */
+static
+ecs_entity_t plecs_row_new(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    const char *path)
+{
+    if (!state->bulk || strchr(path, '.') || ecs_get_with(world)) {
+        return 0;
+    }
+
+    plecs_row_commit(world, state);
+
+    plecs_row_t *row = &state->row;
+    row->entity = ecs_new_id(world);
+    row->id_count = 0;
+
+    ecs_entity_t scope = ecs_get_scope(world);
+    if (scope) {
+        row->ids[row->id_count] = ecs_childof(scope);
+        row->values[row->id_count ++] = NULL;
+    }
+
+    EcsIdentifier *name = ecs_value_new(world, ecs_id(EcsIdentifier));
+    name->value = ecs_os_strdup(path);
+    row->name = name->value;
+    row->ids[row->id_count] = ecs_pair(ecs_id(EcsIdentifier), EcsName);
+    row->values[row->id_count ++] = name;
+
+    return row->entity;
+}
+
+/* Add id to the row of the statement. Returns the index of the id in the row, 
+ * or -1 if the entity had to be created, because the id is a pair (which can
+ * replace other ids) or the row is full. */
+static
+int32_t plecs_row_add(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_id_t id)
+{
+    plecs_row_t *row = &state->row;
+    if (!(id & ECS_ID_FLAGS_MASK) && row->id_count < (ECS_ID_CACHE_SIZE - 1)) {
+        int32_t i;
+        for (i = 0; i < row->id_count; i ++) {
+            if (row->ids[i] == id) {
+                return i;
+            }
+        }
+
+        row->ids[i] = id;
+        row->values[i] = NULL;
+        return row->id_count ++;
+    }
+
+    plecs_flush(world, state);
+    return -1;
+}
+
+static
+void plecs_add_id(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t e,
+    ecs_id_t id)
+{
+    if (e == state->row.entity && plecs_row_add(world, state, id) != -1) {
+        return;
+    }
+
+    ecs_add_id(world, e, id);
+}
+
+static
+void* plecs_get_mut(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t e,
+    ecs_id_t id,
+    ecs_entity_t type)
+{
+    if (e == state->row.entity) {
+        int32_t i = plecs_row_add(world, state, id);
+        if (i != -1) {
+            void **value = &state->row.values[i];
+            if (!value[0]) {
+                value[0] = ecs_value_new(world, type);
+            }
+            return value[0];
+        }
+    }
+
+    return ecs_get_mut_id(world, e, id);
+}
+
+/* Find an entity in the current scope that wasn't created yet */
+static
+ecs_entity_t plecs_pending_find(
+    plecs_state_t *state,
+    const char *name)
+{
+    plecs_row_t *row = &state->row;
+    if (row->entity && !ecs_os_strcmp(row->name, name)) {
+        return row->entity;
+    }
+
+    if (!ecs_vec_count(&state->batch.entities)) {
+        return 0;
+    }
+
+    return flecs_name_index_find(&state->batch.names, name, 0, 0);
+}
+
+/* Before a path is resolved in the world, create the entities that weren't 
+ * created yet if the path starts with one of them */
+static
+void plecs_pending_flush(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    const char *path)
+{
+    if (!state->row.entity && !ecs_vec_count(&state->batch.entities)) {
+        return;
+    }
+
+    const char *sep = strchr(path, '.');
+    if (!sep) {
+        if (plecs_pending_find(state, path)) {
+            plecs_flush(world, state);
+        }
+        return;
+    }
+
+    ecs_size_t len = flecs_ito(ecs_size_t, sep - path);
+    char *name = ecs_os_malloc(len + 1);
+    ecs_os_memcpy(name, path, len);
+    name[len] = '\0';
+    if (plecs_pending_find(state, name)) {
+        plecs_flush(world, state);
+    }
+    ecs_os_free(name);
+}
+
 static
 ecs_entity_t plecs_lookup(
     const ecs_world_t *world,
@@ -67,6 +498,7 @@ ecs_entity_t plecs_lookup(
     bool is_subject)
 {
     ecs_entity_t e = 0;
+    ecs_entity_t scope = ecs_get_scope(world);
 
     if (!is_subject) {
         ecs_entity_t oneof = 0;
@@ -81,6 +513,17 @@ ecs_entity_t plecs_lookup(
                     world, oneof, path, NULL, NULL, false);
             }
         }
+
+        /* Identifiers that aren't subjects are resolved recursively and in
+         * the using scopes, which is expensive for components that are used
+         * by every statement in a scope. */
+        ecs_hashed_string_t key = flecs_get_hashed_string(path, 0, 0);
+        e = plecs_cache_get(world, state, scope, &key);
+        if (e) {
+            state->cache_hit_count ++;
+            return e;
+        }
+
         int using_scope = state->using_frame - 1;
         for (; using_scope >= 0; using_scope--) {
             e = ecs_lookup_path_w_sep(
@@ -89,13 +532,25 @@ ecs_entity_t plecs_lookup(
                 break;
             }
         }
-    }
 
-    if (!e) {
-        e = ecs_lookup_path_w_sep(world, 0, path, NULL, NULL, !is_subject);
+        /* Entities of statements that weren't created yet are only found
+         * here while parsing values, which only need the entity id */
+        if (!e && (e = plecs_pending_find(state, path))) {
+            return e;
+        }
+
+        if (!e) {
+            e = ecs_lookup_path_w_sep(world, 0, path, NULL, NULL, true);
+        }
+
+        if (e) {
+            plecs_cache_set(state, scope, &key, e);
+        }
+
+        return e;
     }
 
-    return e;
+    return ecs_lookup_path_w_sep(world, 0, path, NULL, NULL, false);
 }
 
 /* Lookup action used for deserializing entity refs in component values */
@@ -110,6 +565,29 @@ ecs_entity_t plecs_lookup_action(
 }
 #endif
 
+static
+ecs_entity_t plecs_new_entity(
+    ecs_world_t *world,
+    plecs_state_t *state,
+    ecs_entity_t e,
+    const char *path,
+    bool is_stmt_subject)
+{
+    plecs_cache_invalidate(state, path);
+    state->entity_count ++;
+
+    /* The subject of a statement is created in bulk with the subjects of the
+     * statements after it that have the same ids */
+    if (is_stmt_subject) {
+        ecs_entity_t row = plecs_row_new(world, state, path);
+        if (row) {
+            return row;
+        }
+    }
+
+    return ecs_add_path(world, e, 0, path);
+}
+
 static
 ecs_entity_t plecs_ensure_entity(
     ecs_world_t *world,
@@ -130,6 +608,7 @@ ecs_entity_t plecs_ensure_entity(
     }
 
     if (!e) {
+        plecs_pending_flush(world, state, path);
         e = plecs_lookup(world, path, state, rel, is_subject);
     }
 
@@ -150,7 +629,7 @@ ecs_entity_t plecs_ensure_entity(
             e = ecs_new_id(world);
         }
 
-        e = ecs_add_path(world, e, 0, path);
+        e = plecs_new_entity(world, state, e, path, is_subject && !rel);
         ecs_assert(e != 0, ECS_INTERNAL_ERROR, NULL);
     } else {
         /* If entity exists, make sure it gets the right scope and with */
@@ -339,10 +818,10 @@ int plecs_create_term(
 
     if (subj) {
         if (!obj) {
-            ecs_add_id(world, subj, pred);
+            plecs_add_id(world, state, subj, pred);
             state->last_assign_id = pred;
         } else {
-            ecs_add_pair(world, subj, pred, obj);
+            plecs_add_id(world, state, subj, ecs_pair(pred, obj));
             state->last_object = obj;
             state->last_assign_id = ecs_pair(pred, obj);
         }
@@ -388,13 +867,14 @@ int plecs_create_term(
 
         state->using[state->using_frame ++] = pred;
         state->using_frames[state->sp] = state->using_frame;
+        plecs_cache_clear(state);
 
     /* If this is not a with/using clause, add with frames to subject */
     } else {
         if (subj) {
             int32_t i, frame_count = state->with_frames[state->sp];
             for (i = 0; i < frame_count; i ++) {
-                ecs_add_id(world, subj, state->with[i]);
+                plecs_add_id(world, state, subj, state->with[i]);
             }
         }
     }
@@ -402,7 +882,7 @@ int plecs_create_term(
     /* If an id was provided by itself, add default scope type to it */
     ecs_entity_t default_scope_type = state->default_scope_type[state->sp];
     if (pred_as_subj && default_scope_type) {
-        ecs_add_id(world, subj, default_scope_type);
+        plecs_add_id(world, state, subj, default_scope_type);
     }
 
     /* If annotations preceded the statement, append */
@@ -413,6 +893,10 @@ int plecs_create_term(
             return -1;
         }
 
+        if (subj == state->row.entity) {
+            plecs_flush(world, state);
+        }
+
         plecs_apply_annotations(world, subj, state);
     }
 
@@ -548,7 +1032,7 @@ const char* plecs_parse_assign_expr(
         return NULL;
     }
 
-    void *value_ptr = ecs_get_mut_id(world, assign_to, assign_id);
+    void *value_ptr = plecs_get_mut(world, state, assign_to, assign_id, type);
 
     ptr = ecs_parse_expr(world, ptr, &(ecs_value_t){type, value_ptr}, 
         &(ecs_parse_expr_desc_t){
@@ -562,7 +1046,9 @@ const char* plecs_parse_assign_expr(
         return NULL;
     }
 
-    ecs_modified_id(world, assign_to, assign_id);
+    if (assign_to != state->row.entity) {
+        ecs_modified_id(world, assign_to, assign_id);
+    }
 #endif
 
     return ptr;
@@ -711,6 +1197,9 @@ const char* plecs_parse_scope_open(
         return NULL;
     }
 
+    /* Entities are created in bulk per scope */
+    plecs_flush(world, state);
+
     state->sp ++;
 
     ecs_entity_t scope = 0;
@@ -781,6 +1270,8 @@ const char* plecs_parse_scope_close(
         return NULL;
     }
 
+    plecs_flush(world, state);
+
     state->scope[state->sp] = 0;
     state->default_scope_type[state->sp] = 0;
     state->sp --;
@@ -801,7 +1292,10 @@ const char* plecs_parse_scope_close(
     }
 
     state->with_frame = state->with_frames[state->sp];
-    state->using_frame = state->using_frames[state->sp];
+    if (state->using_frame != state->using_frames[state->sp]) {
+        state->using_frame = state->using_frames[state->sp];
+        plecs_cache_clear(state);
+    }
     state->last_subject = 0;
     state->assign_stmt = false;
 
@@ -846,7 +1340,7 @@ const char *plecs_parse_plecs_term(
     }
 
     if (decl_id && state->last_subject) {
-        ecs_add_id(world, state->last_subject, decl_id);
+        plecs_add_id(world, state, state->last_subject, decl_id);
     }
 
     state->decl_type = false;
@@ -1083,114 +1577,335 @@ error:
     return NULL;
 }
 
-int ecs_plecs_from_str(
+static
+void plecs_state_init(
+    ecs_world_t *world,
+    plecs_state_t *state)
+{
+    (void)world;
+    ecs_map_init(&state->lookup_cache, NULL);
+    flecs_name_index_init(&state->lookup_names, NULL);
+
+    /* ecs_bulk_init can't be deferred */
+    state->bulk = ecs_poly_is(world, ecs_world_t) && !ecs_is_deferred(world) &&
+        !(world->flags & EcsWorldReadonly);
+    ecs_vec_init_t(NULL, &state->batch.entities, ecs_entity_t, 0);
+    int32_t i;
+    for (i = 0; i < ECS_ID_CACHE_SIZE; i ++) {
+        ecs_vec_init_t(NULL, &state->batch.values[i], void*, 0);
+    }
+    flecs_name_index_init(&state->batch.names, NULL);
+#ifdef FLECS_EXPR
+    ecs_vars_init(world, &state->vars);
+#endif
+}
+
+/* Restore scope & with of the world and check that the script was complete */
+static
+int plecs_state_fini(
     ecs_world_t *world,
     const char *name,
-    const char *expr) 
+    const char *expr,
+    plecs_state_t *state,
+    ecs_entity_t prev_scope,
+    ecs_entity_t prev_with,
+    int result)
 {
-    const char *ptr = expr;
-    ecs_term_t term = {0};
-    plecs_state_t state = {0};
+    plecs_flush(world, state);
+    plecs_clear_annotations(state);
 
-    if (!expr) {
-        return 0;
+    if (!result) {
+        ecs_set_scope(world, prev_scope);
+        ecs_set_with(world, prev_with);
+
+        if (state->sp != 0) {
+            ecs_parser_error(name, expr, 0, "missing end of scope");
+            result = -1;
+        } else if (state->assign_stmt) {
+            ecs_parser_error(name, expr, 0, "unfinished assignment");
+            result = -1;
+        } else if (state->errors) {
+            result = -1;
+        }
     }
 
-    state.scope[0] = 0;
-    ecs_entity_t prev_scope = ecs_set_scope(world, 0);
-    ecs_entity_t prev_with = ecs_set_with(world, 0);
+    if (result) {
+        ecs_set_scope(world, state->scope[0]);
+        ecs_set_with(world, prev_with);
+    }
+
+    plecs_cache_clear(state);
+    ecs_map_fini(&state->lookup_cache);
+    flecs_name_index_fini(&state->lookup_names);
 
+    int32_t i;
+    for (i = 0; i < ECS_ID_CACHE_SIZE; i ++) {
+        ecs_vec_fini_t(NULL, &state->batch.values[i], void*);
+    }
+    ecs_vec_fini_t(NULL, &state->batch.entities, ecs_entity_t);
+    flecs_name_index_fini(&state->batch.names);
 #ifdef FLECS_EXPR
-    ecs_vars_init(world, &state.vars);
+    ecs_vars_fini(&state->vars);
 #endif
+    return result;
+}
+
+/* Parse all statements in a string */
+static
+int plecs_parse_stmts(
+    ecs_world_t *world,
+    const char *name,
+    const char *expr,
+    plecs_state_t *state)
+{
+    const char *ptr = expr;
 
     do {
-        expr = ptr = plecs_parse_stmt(world, name, expr, ptr, &state);
+        expr = ptr = plecs_parse_stmt(world, name, expr, ptr, state);
         if (!ptr) {
-            goto error;
+            return -1;
         }
+    } while (ptr[0]);
+
+    return 0;
+}
 
-        if (!ptr[0]) {
-            break; /* End of expression */
+static
+bool plecs_stmt_continues(
+    char ch)
+{
+    return ch == ',' || ch == ':' || ch == '-' || ch == '=' || ch == '@';
+}
+
+/* Find the end of the last complete statement in a buffer with the start of
+ * a file. Statements can span multiple lines, so a newline only ends one when
+ * it isn't in a string, value or pair, when the line doesn't end with a token
+ * that continues the statement (like ',' and ':-'), when the next line doesn't
+ * start with one (like '{' and ','), and when the line isn't an annotation.
+ * Returns zero if the buffer doesn't contain a complete statement. The buffer
+ * must be terminated at len, as runs of characters that can't change the
+ * state (identifiers, numbers, spaces) are skipped with strcspn. */
+static
+ecs_size_t plecs_chunk_end(
+    const char *buf,
+    ecs_size_t len)
+{
+    ecs_size_t i, end = 0, newline = 0;
+    int32_t depth = 0; /* nesting of (), [] and braces of values */
+    bool assign = false; /* in assignment, braces enclose values */
+    bool stmt_start = true;
+    char prev = 0; /* last token character */
+
+    for (i = 0; i < len; i ++) {
+        /* Only the first and last non-space character of a run matter: the
+         * first ends the statement on the previous line unless it continues
+         * it, the last is the token a newline checks. */
+        ecs_size_t run = (ecs_size_t)strcspn(&buf[i], "\n/\"@-=()[]{}");
+        ecs_size_t first = i, last = i + run;
+        while (first < last && isspace(buf[first])) {
+            first ++;
+        }
+        while (last > first && isspace(buf[last - 1])) {
+            last --;
+        }
+        if (first < last) {
+            if (newline && buf[first] != ':' && buf[first] != ',') {
+                end = newline;
+                assign = false;
+            }
+            newline = 0;
+            prev = buf[last - 1];
+            stmt_start = false;
         }
-    } while (true);
 
-    ecs_set_scope(world, prev_scope);
-    ecs_set_with(world, prev_with);
-    plecs_clear_annotations(&state);
+        i += run;
+        if (i >= len) {
+            break;
+        }
 
-    if (state.sp != 0) {
-        ecs_parser_error(name, expr, 0, "missing end of scope");
-        goto error;
-    }
+        char ch = buf[i];
 
-    if (state.assign_stmt) {
-        ecs_parser_error(name, expr, 0, "unfinished assignment");
-        goto error;
+        if (ch == TOK_NEWLINE) {
+            if (!depth && !plecs_stmt_continues(prev)) {
+                newline = i + 1;
+            }
+            continue;
+        }
+
+        if (ch == '/' && (i + 1) < len && buf[i + 1] == '/') {
+            while (i < len && buf[i] != TOK_NEWLINE) {
+                i ++;
+            }
+            i --; /* Process the newline */
+            continue;
+        }
+
+        if (newline) {
+            if (ch != '{') {
+                end = newline;
+                assign = false;
+                stmt_start = true;
+            }
+            newline = 0;
+        }
+
+        if (ch == '"') {
+            for (i ++; i < len && buf[i] != '"'; i ++) {
+                if (buf[i] == '\\') {
+                    i ++;
+                }
+            }
+            if (i >= len) {
+                break;
+            }
+        } else if (stmt_start && ch == '@') {
+            /* Annotations apply to the statement on the next line */
+            while (i < len && buf[i] != TOK_NEWLINE) {
+                i ++;
+            }
+            i --;
+            prev = ch;
+            continue;
+        } else if (ch == '-' && (stmt_start || prev == ':')) {
+            assign = true;
+        } else if (ch == '=') {
+            assign = true;
+        } else if (ch == '(' || ch == '[') {
+            depth ++;
+        } else if (ch == ')' || ch == ']') {
+            depth -= depth != 0;
+        } else if (ch == '{') {
+            depth += depth || assign; /* Scope open ends the statement */
+        } else if (ch == '}') {
+            depth -= depth != 0; /* Scope close ends the statement */
+        }
+
+        prev = ch;
+        stmt_start = false;
     }
 
-    if (state.errors) {
-        goto error;
+    return end;
+}
+
+int ecs_plecs_from_str(
+    ecs_world_t *world,
+    const char *name,
+    const char *expr) 
+{
+    plecs_state_t state = {0};
+
+    if (!expr) {
+        return 0;
     }
 
-#ifdef FLECS_EXPR
-    ecs_vars_fini(&state.vars);
-#endif
-    return 0;
-error:
-#ifdef FLECS_EXPR
-    ecs_vars_fini(&state.vars);
-#endif
-    ecs_set_scope(world, state.scope[0]);
-    ecs_set_with(world, prev_with);
-    ecs_term_fini(&term);
-    return -1;
+    state.scope[0] = 0;
+    ecs_entity_t prev_scope = ecs_set_scope(world, 0);
+    ecs_entity_t prev_with = ecs_set_with(world, 0);
+    plecs_state_init(world, &state);
+
+    int result = plecs_parse_stmts(world, name, expr, &state);
+    return plecs_state_fini(
+        world, name, expr, &state, prev_scope, prev_with, result);
 }
 
 int ecs_plecs_from_file(
     ecs_world_t *world,
     const char *filename) 
+{
+    return ecs_plecs_from_file_w_stats(world, filename, NULL);
+}
+
+int ecs_plecs_from_file_w_stats(
+    ecs_world_t *world,
+    const char *filename,
+    ecs_plecs_load_t *stats)
 {
     FILE* file;
-    char* content = NULL;
-    int32_t bytes;
-    size_t size;
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
 
     /* Open file for reading */
     ecs_os_fopen(&file, filename, "r");
     if (!file) {
         ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
-        goto error;
+        return -1;
     }
 
-    /* Determine file size */
-    fseek(file, 0 , SEEK_END);
-    bytes = (int32_t)ftell(file);
-    if (bytes == -1) {
-        goto error;
-    }
-    rewind(file);
+    plecs_state_t state = {0};
+    ecs_entity_t prev_scope = ecs_set_scope(world, 0);
+    ecs_entity_t prev_with = ecs_set_with(world, 0);
+    plecs_state_init(world, &state);
 
-    /* Load contents in memory */
-    content = ecs_os_malloc(bytes + 1);
-    size = (size_t)bytes;
-    if (!(size = fread(content, 1, size, file)) && bytes) {
-        ecs_err("%s: read zero bytes instead of %d", filename, size);
-        ecs_os_free(content);
-        content = NULL;
-        goto error;
-    } else {
-        content[size] = '\0';
-    }
+    ecs_size_t size = PLECS_READ_SIZE, count = 0;
+    char *buf = ecs_os_malloc(size + 1);
+    int64_t byte_count = 0;
+    int32_t read_count = 0;
+    bool eof = false;
+    int result = 0;
+
+    do {
+        /* Read after the part of the previous read that wasn't parsed yet */
+        if (!eof) {
+            ecs_size_t read = (ecs_size_t)fread(
+                &buf[count], 1, (size_t)(size - count), file);
+            if (read < (size - count)) {
+                if (ferror(file)) {
+                    ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
+                    result = -1;
+                    break;
+                }
+                eof = true;
+            }
+            count += read;
+            byte_count += read;
+            read_count ++;
+        }
+
+        /* Parse complete statements, the rest is parsed after the next read */
+        buf[count] = '\0';
+        ecs_size_t end = eof ? count : plecs_chunk_end(buf, count);
+        if (!end) {
+            if (count == size) {
+                /* Statement doesn't fit in the buffer */
+                size *= 2;
+                buf = ecs_os_realloc(buf, size + 1);
+            }
+            continue;
+        }
+
+        char ch = buf[end];
+        buf[end] = '\0';
+        result = plecs_parse_stmts(world, filename, buf, &state);
+        buf[end] = ch;
+        if (result) {
+            break;
+        }
+
+        count -= end;
+        ecs_os_memmove(buf, &buf[end], count);
+    } while (!eof || count);
 
     fclose(file);
+    ecs_os_free(buf);
+
+    if (stats) {
+        stats->byte_count = byte_count;
+        stats->read_count = read_count;
+        stats->buffer_size = size;
+        stats->entity_count = state.entity_count;
+        stats->cache_hit_count = state.cache_hit_count;
+    }
+
+    result = plecs_state_fini(
+        world, filename, NULL, &state, prev_scope, prev_with, result);
+
+    if (stats) {
+        /* The last entities are created when the state is cleaned up */
+        stats->bulk_count = state.bulk_count;
+        stats->time_spent = (ecs_ftime_t)ecs_time_measure(&t);
+    }
 
-    int result = ecs_plecs_from_str(world, filename, content);
-    ecs_os_free(content);
     return result;
-error:
-    ecs_os_free(content);
-    return -1;
 }
 
 #endif
@@ -25,6 +25,9 @@ typedef struct {
     ecs_map_t reply_cache;
     int32_t rc;
     ecs_ftime_t time;
+#ifdef FLECS_STATS
+    ecs_stats_stream_t stats_stream; /* Sampled once a client requests it */
+#endif
 } ecs_rest_ctx_t;
 
 /* Global statistics */
@@ -45,6 +48,7 @@ int64_t ecs_rest_delete_error_count = 0;
 int64_t ecs_rest_world_stats_count = 0;
 int64_t ecs_rest_pipeline_stats_count = 0;
 int64_t ecs_rest_stats_error_count = 0;
+int64_t ecs_rest_stats_stream_count = 0;
 
 static
 void flecs_rest_free_reply_cache(ecs_map_t *reply_cache) {
@@ -59,6 +63,16 @@ void flecs_rest_free_reply_cache(ecs_map_t *reply_cache) {
     }
 }
 
+/* Kept out of the hook macros, directives in macro arguments aren't portable */
+static
+void flecs_rest_fini_stats_stream(ecs_rest_ctx_t *impl) {
+#ifdef FLECS_STATS
+    ecs_stats_stream_fini(&impl->stats_stream);
+#else
+    (void)impl;
+#endif
+}
+
 static ECS_COPY(EcsRest, dst, src, {
     ecs_rest_ctx_t *impl = src->impl;
     if (impl) {
@@ -83,6 +97,7 @@ static ECS_DTOR(EcsRest, ptr, {
         if (!impl->rc) {
             ecs_http_server_fini(impl->srv);
             flecs_rest_free_reply_cache(&impl->reply_cache);
+            flecs_rest_fini_stats_stream(impl);
             ecs_os_free(impl);
         }
     }
@@ -580,6 +595,7 @@ void flecs_world_stats_to_json(
     ECS_GAUGE_APPEND(reply, stats, tables.storage_count, "Component storages for all tables");
     ECS_COUNTER_APPEND(reply, stats, tables.create_count, "Number of new tables created");
     ECS_COUNTER_APPEND(reply, stats, tables.delete_count, "Number of tables deleted");
+    ECS_COUNTER_APPEND(reply, stats, tables.realloc_count, "Number of table storage resizes");
 
     ECS_GAUGE_APPEND(reply, stats, ids.count, "Component, tag and pair ids in use");
     ECS_GAUGE_APPEND(reply, stats, ids.tag_count, "Tag ids in use");
@@ -604,6 +620,10 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
     ECS_COUNTER_APPEND(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
     ECS_GAUGE_APPEND(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_live_bytes, "Bytes in use, thread caching allocator");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_peak_bytes, "Peak bytes in use or cached, thread caching allocator");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_cached_bytes, "Bytes in thread caches, thread caching allocator");
+    ECS_GAUGE_APPEND(reply, stats, memory.os_alloc_reserved_bytes, "Bytes reserved from OS, thread caching allocator");
 
     ECS_COUNTER_APPEND(reply, stats, rest.request_count, "Received requests");
     ECS_COUNTER_APPEND(reply, stats, rest.entity_count, "Received entity/ requests");
@@ -618,6 +638,7 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, rest.world_stats_count, "Received world stats requests");
     ECS_COUNTER_APPEND(reply, stats, rest.pipeline_stats_count, "Received pipeline stats requests");
     ECS_COUNTER_APPEND(reply, stats, rest.stats_error_count, "Failed stats requests");
+    ECS_COUNTER_APPEND(reply, stats, rest.stats_stream_count, "Received stats stream requests");
 
     ECS_COUNTER_APPEND(reply, stats, http.request_received_count, "Received requests");
     ECS_COUNTER_APPEND(reply, stats, http.request_invalid_count, "Received invalid requests");
@@ -742,6 +763,54 @@ bool flecs_rest_reply_stats(
 }
 #endif
 
+#ifdef FLECS_STATS
+static
+bool flecs_rest_reply_stats_stream(
+    ecs_world_t *world,
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    const char *seq_str = ecs_http_get_param(req, "seq");
+    int64_t seq = seq_str ? atoll(seq_str) : 0;
+    if (seq < 0) {
+        seq = 0;
+    }
+
+    bool names = false;
+    flecs_rest_bool_param(req, "names", &names);
+
+    /* Sampling starts with the first request, so applications that don't
+     * use the stream don't pay for it */
+    ecs_stats_stream_t *stream = &impl->stats_stream;
+    if (!stream->samples) {
+        ecs_stats_stream_init(stream, 0);
+        ecs_stats_stream_sample(world, stream);
+    }
+
+    ecs_size_t size = 0;
+    char *data = ecs_stats_stream_encode(stream, seq, names, &size);
+    ecs_strbuf_appendstr_zerocpyn(&reply->body, data, size);
+    reply->content_type = "application/octet-stream";
+    ecs_os_linc(&ecs_rest_stats_stream_count);
+    return true;
+}
+#else
+static
+bool flecs_rest_reply_stats_stream(
+    ecs_world_t *world,
+    ecs_rest_ctx_t *impl,
+    const ecs_http_request_t* req,
+    ecs_http_reply_t *reply)
+{
+    (void)world;
+    (void)impl;
+    (void)req;
+    (void)reply;
+    return false;
+}
+#endif
+
 static
 void flecs_rest_reply_table_append_type(
     ecs_world_t *world,
@@ -852,6 +921,10 @@ bool flecs_rest_reply(
         } else if (!ecs_os_strcmp(req->path, "query")) {
             return flecs_rest_reply_query(world, impl, req, reply);
 
+        /* Stats stream endpoint */
+        } else if (!ecs_os_strcmp(req->path, "stats/stream")) {
+            return flecs_rest_reply_stats_stream(world, impl, req, reply);
+
         /* Stats endpoint */
         } else if (!ecs_os_strncmp(req->path, "stats/", 6)) {
             return flecs_rest_reply_stats(world, req, reply);
@@ -935,6 +1008,11 @@ void DequeueRest(ecs_iter_t *it) {
         ecs_rest_ctx_t *ctx = rest[i].impl;
         if (ctx) {
             ctx->time += it->delta_time;
+#ifdef FLECS_STATS
+            if (ctx->stats_stream.samples) {
+                ecs_stats_stream_sample(it->world, &ctx->stats_stream);
+            }
+#endif
             ecs_http_server_dequeue(ctx->srv, it->delta_time);
         }
     } 
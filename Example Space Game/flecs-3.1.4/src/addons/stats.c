@@ -296,6 +296,7 @@ void ecs_world_stats_get(
     }
     ECS_COUNTER_RECORD(&s->tables.create_count, t, world->info.table_create_total);
     ECS_COUNTER_RECORD(&s->tables.delete_count, t, world->info.table_delete_total);
+    ECS_COUNTER_RECORD(&s->tables.realloc_count, t, world->info.table_realloc_total);
     ECS_GAUGE_RECORD(&s->tables.count, t, world->info.table_count);
     ECS_GAUGE_RECORD(&s->tables.empty_count, t, world->info.empty_table_count);
     ECS_GAUGE_RECORD(&s->tables.tag_only_count, t, world->info.tag_table_count);
@@ -332,6 +333,15 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->memory.stack_free_count, t, ecs_stack_allocator_free_count);
     ECS_GAUGE_RECORD(&s->memory.stack_outstanding_alloc_count, t, outstanding_allocs);
 
+#ifdef FLECS_OS_ALLOC
+    ecs_os_alloc_stats_t alloc_stats;
+    ecs_os_alloc_stats_get(&alloc_stats);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_live_bytes, t, alloc_stats.live_bytes);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_peak_bytes, t, alloc_stats.peak_bytes);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_cached_bytes, t, alloc_stats.cached_bytes);
+    ECS_GAUGE_RECORD(&s->memory.os_alloc_reserved_bytes, t, alloc_stats.reserved_bytes);
+#endif
+
 #ifdef FLECS_REST
     ECS_COUNTER_RECORD(&s->rest.request_count, t, ecs_rest_request_count);
     ECS_COUNTER_RECORD(&s->rest.entity_count, t, ecs_rest_entity_count);
@@ -346,6 +356,7 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->rest.world_stats_count, t, ecs_rest_world_stats_count);
     ECS_COUNTER_RECORD(&s->rest.pipeline_stats_count, t, ecs_rest_pipeline_stats_count);
     ECS_COUNTER_RECORD(&s->rest.stats_error_count, t, ecs_rest_stats_error_count);
+    ECS_COUNTER_RECORD(&s->rest.stats_stream_count, t, ecs_rest_stats_stream_count);
 #endif
 
 #ifdef FLECS_HTTP
@@ -628,7 +639,10 @@ bool ecs_pipeline_stats_get(
         }
     }
 
-    s->t = t_next(s->t);
+    int32_t t = s->t = t_next(s->t);
+    ECS_COUNTER_RECORD(&s->sync_count, t, pq->sync_count_total);
+    ECS_COUNTER_RECORD(&s->sync_time, t, pq->sync_time_total);
+    ECS_COUNTER_RECORD(&s->sync_wait_time, t, pq->sync_wait_time_total);
 
     return true;
 error:
@@ -668,7 +682,9 @@ void ecs_pipeline_stats_reduce(
         sys_dst->query.t = dst->t;
         ecs_system_stats_reduce(sys_dst, sys_src);
     }
-    dst->t = t_next(dst->t);
+
+    flecs_stats_reduce(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
+        ECS_METRIC_FIRST(src), (dst->t = t_next(dst->t)), src->t);
 }
 
 void ecs_pipeline_stats_reduce_last(
@@ -685,7 +701,9 @@ void ecs_pipeline_stats_reduce_last(
         sys_dst->query.t = dst->t;
         ecs_system_stats_reduce_last(sys_dst, sys_src, count);
     }
-    dst->t = t_prev(dst->t);
+
+    flecs_stats_reduce_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst), 
+        ECS_METRIC_FIRST(src), (dst->t = t_prev(dst->t)), src->t, count);
 }
 
 void ecs_pipeline_stats_repeat_last(
@@ -697,7 +715,9 @@ void ecs_pipeline_stats_repeat_last(
         sys->query.t = stats->t;
         ecs_system_stats_repeat_last(sys);
     }
-    stats->t = t_next(stats->t);
+
+    flecs_stats_repeat_last(ECS_METRIC_FIRST(stats), ECS_METRIC_LAST(stats),
+        (stats->t = t_next(stats->t)));
 }
 
 void ecs_pipeline_stats_copy_last(
@@ -714,6 +734,9 @@ void ecs_pipeline_stats_copy_last(
         sys_dst->query.t = dst->t;
         ecs_system_stats_copy_last(sys_dst, sys_src);
     }
+
+    flecs_stats_copy_last(ECS_METRIC_FIRST(dst), ECS_METRIC_LAST(dst),
+        ECS_METRIC_FIRST(src), dst->t, t_next(src->t));
 }
 
 #endif
@@ -767,6 +790,7 @@ void ecs_world_stats_log(
     flecs_gauge_print("table cache record count", t, &s->tables.record_count);
     flecs_counter_print("table create count", t, &s->tables.create_count);
     flecs_counter_print("table delete count", t, &s->tables.delete_count);
+    flecs_counter_print("table realloc count", t, &s->tables.realloc_count);
     ecs_trace("");
     flecs_counter_print("add commands", t, &s->commands.add_count);
     flecs_counter_print("remove commands", t, &s->commands.remove_count);
@@ -785,4 +809,391 @@ error:
     return;
 }
 
+static const struct {
+    const char *name;
+    ecs_stats_stream_kind_t kind;
+} flecs_stats_stream_metrics[ECS_STATS_STREAM_METRIC_COUNT] = {
+    {"frame.frame_count", EcsStatsStreamCounter},
+    {"frame.merge_count", EcsStatsStreamCounter},
+    {"frame.rematch_count", EcsStatsStreamCounter},
+    {"frame.pipeline_build_count", EcsStatsStreamCounter},
+    {"frame.systems_ran", EcsStatsStreamCounter},
+    {"frame.observers_ran", EcsStatsStreamCounter},
+    {"frame.event_emit_count", EcsStatsStreamCounter},
+    {"performance.world_time_raw_us", EcsStatsStreamCounter},
+    {"performance.world_time_us", EcsStatsStreamCounter},
+    {"performance.frame_time_us", EcsStatsStreamCounter},
+    {"performance.system_time_us", EcsStatsStreamCounter},
+    {"performance.emit_time_us", EcsStatsStreamCounter},
+    {"performance.merge_time_us", EcsStatsStreamCounter},
+    {"performance.rematch_time_us", EcsStatsStreamCounter},
+    {"entities.count", EcsStatsStreamGauge},
+    {"entities.not_alive_count", EcsStatsStreamGauge},
+    {"ids.count", EcsStatsStreamGauge},
+    {"ids.tag_count", EcsStatsStreamGauge},
+    {"ids.component_count", EcsStatsStreamGauge},
+    {"ids.pair_count", EcsStatsStreamGauge},
+    {"ids.wildcard_count", EcsStatsStreamGauge},
+    {"ids.type_count", EcsStatsStreamGauge},
+    {"ids.create_count", EcsStatsStreamCounter},
+    {"ids.delete_count", EcsStatsStreamCounter},
+    {"tables.count", EcsStatsStreamGauge},
+    {"tables.empty_count", EcsStatsStreamGauge},
+    {"tables.tag_only_count", EcsStatsStreamGauge},
+    {"tables.trivial_only_count", EcsStatsStreamGauge},
+    {"tables.record_count", EcsStatsStreamGauge},
+    {"tables.storage_count", EcsStatsStreamGauge},
+    {"tables.create_count", EcsStatsStreamCounter},
+    {"tables.delete_count", EcsStatsStreamCounter},
+    {"tables.realloc_count", EcsStatsStreamCounter},
+    {"commands.add_count", EcsStatsStreamCounter},
+    {"commands.remove_count", EcsStatsStreamCounter},
+    {"commands.delete_count", EcsStatsStreamCounter},
+    {"commands.clear_count", EcsStatsStreamCounter},
+    {"commands.set_count", EcsStatsStreamCounter},
+    {"commands.get_mut_count", EcsStatsStreamCounter},
+    {"commands.modified_count", EcsStatsStreamCounter},
+    {"commands.other_count", EcsStatsStreamCounter},
+    {"commands.discard_count", EcsStatsStreamCounter},
+    {"commands.batched_entity_count", EcsStatsStreamCounter},
+    {"commands.batched_count", EcsStatsStreamCounter},
+    {"memory.alloc_count", EcsStatsStreamCounter},
+    {"memory.realloc_count", EcsStatsStreamCounter},
+    {"memory.free_count", EcsStatsStreamCounter},
+    {"memory.block_alloc_count", EcsStatsStreamCounter},
+    {"memory.block_free_count", EcsStatsStreamCounter},
+    {"memory.stack_alloc_count", EcsStatsStreamCounter},
+    {"memory.stack_free_count", EcsStatsStreamCounter},
+    {"memory.os_alloc_live_bytes", EcsStatsStreamGauge},
+    {"memory.os_alloc_peak_bytes", EcsStatsStreamGauge},
+    {"memory.os_alloc_cached_bytes", EcsStatsStreamGauge},
+    {"memory.os_alloc_reserved_bytes", EcsStatsStreamGauge},
+    {"pipeline.system_count", EcsStatsStreamGauge},
+    {"pipeline.active_system_count", EcsStatsStreamGauge},
+    {"pipeline.rebuild_count", EcsStatsStreamCounter},
+    {"pipeline.sync_count", EcsStatsStreamCounter},
+    {"pipeline.sync_time_us", EcsStatsStreamCounter},
+    {"pipeline.sync_wait_time_us", EcsStatsStreamCounter}
+};
+
+#define ECS_STATS_STREAM_US(value)\
+    ((int64_t)((double)(value) * 1000000.0))
+
+void ecs_stats_stream_init(
+    ecs_stats_stream_t *stream,
+    int32_t capacity)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(capacity >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!capacity) {
+        capacity = ECS_STATS_STREAM_DEFAULT_CAPACITY;
+    }
+
+    stream->samples = ecs_os_calloc_n(int64_t, 
+        capacity * ECS_STATS_STREAM_METRIC_COUNT);
+    stream->capacity = capacity;
+    stream->seq = 0;
+error:
+    return;
+}
+
+void ecs_stats_stream_fini(
+    ecs_stats_stream_t *stream)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_os_free(stream->samples);
+    ecs_os_zeromem(stream);
+error:
+    return;
+}
+
+static
+int64_t* flecs_stats_stream_frame(
+    const ecs_stats_stream_t *stream,
+    int64_t seq)
+{
+    return &stream->samples[(seq % stream->capacity) * 
+        ECS_STATS_STREAM_METRIC_COUNT];
+}
+
+void ecs_stats_stream_sample(
+    const ecs_world_t *world,
+    ecs_stats_stream_t *stream)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(stream->samples != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    int64_t *v = flecs_stats_stream_frame(stream, ++ stream->seq);
+    const ecs_world_info_t *info = &world->info;
+    int32_t i = 0;
+
+    v[i ++] = info->frame_count_total;
+    v[i ++] = info->merge_count_total;
+    v[i ++] = info->rematch_count_total;
+    v[i ++] = info->pipeline_build_count_total;
+    v[i ++] = info->systems_ran_frame;
+    v[i ++] = info->observers_ran_frame;
+    v[i ++] = (int64_t)world->event_id;
+
+    v[i ++] = ECS_STATS_STREAM_US(info->world_time_total_raw);
+    v[i ++] = ECS_STATS_STREAM_US(info->world_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->frame_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->system_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->emit_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->merge_time_total);
+    v[i ++] = ECS_STATS_STREAM_US(info->rematch_time_total);
+
+    v[i ++] = flecs_sparse_count(ecs_eis(world));
+    v[i ++] = flecs_sparse_not_alive_count(ecs_eis(world));
+
+    v[i ++] = info->id_count;
+    v[i ++] = info->tag_id_count;
+    v[i ++] = info->component_id_count;
+    v[i ++] = info->pair_id_count;
+    v[i ++] = info->wildcard_id_count;
+    v[i ++] = ecs_sparse_count(&world->type_info);
+    v[i ++] = info->id_create_total;
+    v[i ++] = info->id_delete_total;
+
+    v[i ++] = info->table_count;
+    v[i ++] = info->empty_table_count;
+    v[i ++] = info->tag_table_count;
+    v[i ++] = info->trivial_table_count;
+    v[i ++] = info->table_record_count;
+    v[i ++] = info->table_storage_count;
+    v[i ++] = info->table_create_total;
+    v[i ++] = info->table_delete_total;
+    v[i ++] = info->table_realloc_total;
+
+    v[i ++] = info->cmd.add_count;
+    v[i ++] = info->cmd.remove_count;
+    v[i ++] = info->cmd.delete_count;
+    v[i ++] = info->cmd.clear_count;
+    v[i ++] = info->cmd.set_count;
+    v[i ++] = info->cmd.get_mut_count;
+    v[i ++] = info->cmd.modified_count;
+    v[i ++] = info->cmd.other_count;
+    v[i ++] = info->cmd.discard_count;
+    v[i ++] = info->cmd.batched_entity_count;
+    v[i ++] = info->cmd.batched_command_count;
+
+    v[i ++] = ecs_os_api_malloc_count + ecs_os_api_calloc_count;
+    v[i ++] = ecs_os_api_realloc_count;
+    v[i ++] = ecs_os_api_free_count;
+    v[i ++] = ecs_block_allocator_alloc_count;
+    v[i ++] = ecs_block_allocator_free_count;
+    v[i ++] = ecs_stack_allocator_alloc_count;
+    v[i ++] = ecs_stack_allocator_free_count;
+
+#ifdef FLECS_OS_ALLOC
+    ecs_os_alloc_stats_t alloc_stats;
+    ecs_os_alloc_stats_get(&alloc_stats);
+    v[i ++] = alloc_stats.live_bytes;
+    v[i ++] = alloc_stats.peak_bytes;
+    v[i ++] = alloc_stats.cached_bytes;
+    v[i ++] = alloc_stats.reserved_bytes;
+#else
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+#endif
+
+    /* Individual systems are not streamed, see ecs_stats_stream_sample docs */
+#ifdef FLECS_PIPELINE
+    const EcsPipeline *pqc = world->pipeline ? 
+        ecs_get(world, world->pipeline, EcsPipeline) : NULL;
+    const ecs_pipeline_state_t *pq = pqc ? pqc->state : NULL;
+
+    /* Don't use ecs_query_entity_count, as sampling should not process the
+     * pending tables of the world. The pipeline does that before it runs. */
+    int32_t system_count = 0;
+    if (pq) {
+        ecs_table_cache_hdr_t *cur;
+        for (cur = pq->query->cache.tables.first; cur; cur = cur->next) {
+            system_count += ecs_table_count(cur->table);
+        }
+    }
+
+    v[i ++] = system_count;
+    v[i ++] = pq ? ecs_vec_count(&pq->systems) : 0;
+    v[i ++] = pq ? pq->rebuild_count : 0;
+    v[i ++] = pq ? pq->sync_count_total : 0;
+    v[i ++] = pq ? ECS_STATS_STREAM_US(pq->sync_time_total) : 0;
+    v[i ++] = pq ? ECS_STATS_STREAM_US(pq->sync_wait_time_total) : 0;
+#else
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+    v[i ++] = 0;
+#endif
+
+    ecs_assert(i == ECS_STATS_STREAM_METRIC_COUNT, ECS_INTERNAL_ERROR, NULL);
+error:
+    return;
+}
+
+const char* ecs_stats_stream_metric_name(
+    int32_t index,
+    ecs_stats_stream_kind_t *kind)
+{
+    if (index < 0 || index >= ECS_STATS_STREAM_METRIC_COUNT) {
+        return NULL;
+    }
+    if (kind) {
+        *kind = flecs_stats_stream_metrics[index].kind;
+    }
+    return flecs_stats_stream_metrics[index].name;
+}
+
+typedef struct {
+    char *ptr;
+    ecs_size_t count;
+    ecs_size_t size;
+} flecs_stats_stream_buf_t;
+
+static
+uint8_t* flecs_stats_stream_reserve(
+    flecs_stats_stream_buf_t *buf,
+    ecs_size_t size)
+{
+    if ((buf->count + size) > buf->size) {
+        ecs_size_t new_size = buf->size * 2;
+        if (new_size < (buf->count + size)) {
+            new_size = buf->count + size;
+        }
+        buf->ptr = ecs_os_realloc(buf->ptr, new_size);
+        buf->size = new_size;
+    }
+    return (uint8_t*)&buf->ptr[buf->count];
+}
+
+static
+void flecs_stats_stream_uint(
+    flecs_stats_stream_buf_t *buf,
+    uint64_t value)
+{
+    uint8_t *ptr = flecs_stats_stream_reserve(buf, 10), *start = ptr;
+    while (value >= 0x80) {
+        *(ptr ++) = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *(ptr ++) = (uint8_t)value;
+    buf->count += (ecs_size_t)(ptr - start);
+}
+
+static
+void flecs_stats_stream_int(
+    flecs_stats_stream_buf_t *buf,
+    int64_t value)
+{
+    flecs_stats_stream_uint(buf, 
+        ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static
+void flecs_stats_stream_bytes(
+    flecs_stats_stream_buf_t *buf,
+    const void *data,
+    ecs_size_t size)
+{
+    ecs_os_memcpy(flecs_stats_stream_reserve(buf, size), data, size);
+    buf->count += size;
+}
+
+static
+void flecs_stats_stream_encode_frame(
+    flecs_stats_stream_buf_t *buf,
+    const int64_t *prev,
+    const int64_t *cur)
+{
+    /* Reserve the worst case so the changed count can be patched in place. A
+     * single byte varint is enough as long as there are less than 128 metrics */
+    flecs_stats_stream_reserve(buf, 1 + ECS_STATS_STREAM_METRIC_COUNT * 11);
+    ecs_size_t count_offset = buf->count ++;
+
+    int32_t i, changed = 0, last = -1;
+    for (i = 0; i < ECS_STATS_STREAM_METRIC_COUNT; i ++) {
+        int64_t value = prev ? (cur[i] - prev[i]) : cur[i];
+        if (value) {
+            flecs_stats_stream_uint(buf, (uint64_t)(i - last - 1));
+            flecs_stats_stream_int(buf, value);
+            last = i;
+            changed ++;
+        }
+    }
+
+    ecs_assert(changed < 128, ECS_INTERNAL_ERROR, NULL);
+    buf->ptr[count_offset] = (char)changed;
+}
+
+char* ecs_stats_stream_encode(
+    const ecs_stats_stream_t *stream,
+    int64_t since,
+    bool names,
+    ecs_size_t *size)
+{
+    ecs_check(stream != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(since >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    flecs_stats_stream_buf_t buf = {0};
+    flecs_stats_stream_bytes(&buf, "FLST", 4);
+    flecs_stats_stream_uint(&buf, 1);
+    flecs_stats_stream_uint(&buf, ECS_STATS_STREAM_METRIC_COUNT);
+    flecs_stats_stream_uint(&buf, names);
+
+    int32_t i;
+    if (names) {
+        for (i = 0; i < ECS_STATS_STREAM_METRIC_COUNT; i ++) {
+            const char *name = flecs_stats_stream_metrics[i].name;
+            ecs_size_t len = ecs_os_strlen(name);
+            uint8_t kind = (uint8_t)flecs_stats_stream_metrics[i].kind;
+            flecs_stats_stream_bytes(&buf, &kind, 1);
+            flecs_stats_stream_uint(&buf, (uint64_t)len);
+            flecs_stats_stream_bytes(&buf, name, len);
+        }
+    }
+
+    /* Oldest frame that is still in the stream */
+    int64_t last = stream->seq;
+    int64_t oldest = last - stream->capacity + 1;
+    if (oldest < 1) {
+        oldest = 1;
+    }
+
+    /* Encode against the client frame if we still have it. If the client is
+     * too far behind or ahead (the stream was recreated) send all frames. */
+    int64_t base = 0, first = oldest;
+    if (since >= oldest && since <= last) {
+        base = since;
+        first = since + 1;
+    }
+
+    int64_t frame_count = last - first + 1;
+
+    flecs_stats_stream_uint(&buf, frame_count ? (uint64_t)first : 0);
+    flecs_stats_stream_uint(&buf, (uint64_t)frame_count);
+    flecs_stats_stream_uint(&buf, frame_count ? (uint64_t)base : 0);
+
+    const int64_t *prev = base ? flecs_stats_stream_frame(stream, base) : NULL;
+    int64_t seq;
+    for (seq = first; seq < (first + frame_count); seq ++) {
+        const int64_t *cur = flecs_stats_stream_frame(stream, seq);
+        flecs_stats_stream_encode_frame(&buf, prev, cur);
+        prev = cur;
+    }
+
+    *size = buf.count;
+    return buf.ptr;
+error:
+    return NULL;
+}
+
 #endif
@@ -57,6 +57,10 @@ void ecs_on_set(EcsIdentifier)(ecs_iter_t *it) {
     ecs_id_t pair = ecs_childof(0);
     ecs_hashmap_t *index = NULL;
 
+    if (kind != EcsSymbol) {
+        flecs_lookup_cache_invalidate(world);
+    }
+
     if (kind == EcsSymbol) {
         index = &world->symbols;
     } else if (kind == EcsAlias) {
@@ -444,6 +448,9 @@ void flecs_on_parent_change(ecs_iter_t *it) {
     ecs_world_t *world = it->world;
     ecs_table_t *other_table = it->other_table, *table = it->table;
 
+    /* Paths of children change too, also when the entity has no name */
+    flecs_lookup_cache_invalidate(it->real_world);
+
     EcsIdentifier *names = ecs_table_get_pair(it->real_world, 
         table, EcsIdentifier, EcsName, it->offset);
     bool has_name = names != NULL;
@@ -30,6 +30,9 @@
 #define EXP_THRESHOLD   (3)
 #define INT64_MAX_F ((double)INT64_MAX)
 
+/* Largest double below which every integer is exactly representable (2^53) */
+#define EXACT_INT_MAX_F (9007199254740992.0)
+
 static const double rounders[MAX_PRECISION + 1] =
 {
 	0.5,				// 0
@@ -45,75 +48,96 @@ static const double rounders[MAX_PRECISION + 1] =
 	0.00000000005		// 10
 };
 
+static const uint64_t powers_of_10[MAX_PRECISION + 1] =
+{
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 
+    10000000ull, 100000000ull, 1000000000ull, 10000000000ull
+};
+
+/* Two digits at a time halves the number of divisions when converting
+ * integers, the same table trick Ryu and Grisu use to print their digits. */
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* Write the last 'count' digits of v, with leading zeros, ending at end */
 static
-char* flecs_strbuf_itoa(
+void flecs_strbuf_digits(
+    char *end,
+    uint64_t v,
+    int32_t count)
+{
+    while (count >= 2) {
+        uint64_t pair = (v % 100) * 2;
+        v /= 100;
+        end -= 2;
+        end[0] = digit_pairs[pair];
+        end[1] = digit_pairs[pair + 1];
+        count -= 2;
+    }
+    if (count) {
+        end[-1] = (char)('0' + (v % 10));
+    }
+}
+
+char* flecs_utoa(
     char *buf,
-    int64_t v)
+    uint64_t v)
 {
-    char *ptr = buf;
-    char * p1;
-	char c;
+    int32_t count = 1;
+    uint64_t t = v;
+    while (t >= 10) {
+        t /= 10;
+        count ++;
+    }
 
-	if (!v) {
-		*ptr++ = '0';
-    } else {
-        if (v < 0) {
-            ptr[0] = '-';
-            ptr ++;
-            v *= -1;
-        }
+    flecs_strbuf_digits(buf + count, v, count);
+    return buf + count;
+}
 
-		char *p = ptr;
-		while (v) {
-            int64_t vdiv = v / 10;
-            int64_t vmod = v - (vdiv * 10);
-			p[0] = (char)('0' + vmod);
-            p ++;
-			v = vdiv;
-		}
-
-		p1 = p;
-
-		while (p > ptr) {
-			c = *--p;
-			*p = *ptr;
-			*ptr++ = c;
-		}
-		ptr = p1;
-	}
-    return ptr;
+char* flecs_itoa(
+    char *buf,
+    int64_t v)
+{
+    if (v < 0) {
+        *buf++ = '-';
+        /* Negate as unsigned so that INT64_MIN doesn't overflow */
+        return flecs_utoa(buf, 0 - (uint64_t)v);
+    }
+    return flecs_utoa(buf, (uint64_t)v);
 }
 
-static
-int flecs_strbuf_ftoa(
-    ecs_strbuf_t *out, 
+int32_t flecs_ftoa(
+    char *buf,
     double f, 
-    int precision,
+    int32_t precision,
     char nan_delim)
 {
-    char buf[64];
 	char * ptr = buf;
 	char c;
 	int64_t intPart;
     int64_t exp = 0;
 
-    if (isnan(f)) {
+    if (isnan(f) || isinf(f)) {
+        const char *str = isnan(f) ? "NaN" : "Inf";
         if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "NaN");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "NaN");
+            *ptr++ = nan_delim;
         }
-    }
-    if (isinf(f)) {
+        ecs_os_memcpy(ptr, str, 3);
+        ptr += 3;
         if (nan_delim) {
-            ecs_strbuf_appendch(out, nan_delim);
-            ecs_strbuf_appendlit(out, "Inf");
-            return ecs_strbuf_appendch(out, nan_delim);
-        } else {
-            return ecs_strbuf_appendlit(out, "Inf");
+            *ptr++ = nan_delim;
         }
+        *ptr = '\0';
+        return (int32_t)(ptr - buf);
     }
 
 	if (precision > MAX_PRECISION) {
@@ -135,30 +159,54 @@ int flecs_strbuf_ftoa(
 		else precision = 0;
 	}
 
-	if (precision) {
-		f += rounders[precision];
-    }
+    if (f * (double)powers_of_10[precision] < EXACT_INT_MAX_F) {
+        /* Scale the fraction so that the digits after the dot become an
+         * integer. Rounding the scaled fraction is the same as adding the
+         * rounder, and the digits no longer depend on repeated (inexact)
+         * multiplications. Only done while the scaled number is below 2^53,
+         * above that a double can't hold every integer and the scaled value
+         * would lose the low digits. The integer part is split off first
+         * (exactly), so only the fraction goes through the multiplication. */
+        uint64_t scale = powers_of_10[precision];
+        uint64_t int_v = (uint64_t)f;
+        uint64_t frac_v = (uint64_t)((f - (double)int_v) * (double)scale + 0.5);
+        if (frac_v >= scale) {
+            frac_v -= scale;
+            int_v ++;
+        }
 
-    /* Make sure that number can be represented as 64bit int, increase exp */
-    while (f > INT64_MAX_F) {
-        f /= 1000 * 1000 * 1000;
-        exp += 9;
-    }
+        ptr = flecs_utoa(ptr, int_v);
+        if (precision) {
+            *ptr++ = '.';
+            flecs_strbuf_digits(ptr + precision, frac_v, precision);
+            ptr += precision;
+        }
+    } else {
+        if (precision) {
+            f += rounders[precision];
+        }
 
-	intPart = (int64_t)f;
-	f -= (double)intPart;
+        /* Make sure that number can be represented as 64bit int, increase exp */
+        while (f > INT64_MAX_F) {
+            f /= 1000 * 1000 * 1000;
+            exp += 9;
+        }
 
-    ptr = flecs_strbuf_itoa(ptr, intPart);
+        intPart = (int64_t)f;
+        f -= (double)intPart;
 
-	if (precision) {
-		*ptr++ = '.';
-		while (precision--) {
-			f *= 10.0;
-			c = (char)f;
-			*ptr++ = (char)('0' + c);
-			f -= c;
-		}
-	}
+        ptr = flecs_itoa(ptr, intPart);
+
+        if (precision) {
+            *ptr++ = '.';
+            while (precision--) {
+                f *= 10.0;
+                c = (char)f;
+                *ptr++ = (char)('0' + c);
+                f -= c;
+            }
+        }
+    }
 	*ptr = 0;
 
     /* Remove trailing 0s */
@@ -210,7 +258,7 @@ int flecs_strbuf_ftoa(
 
 
         ptr[0] = 'e';
-        ptr = flecs_strbuf_itoa(ptr + 1, exp);
+        ptr = flecs_itoa(ptr + 1, exp);
 
         if (nan_delim) {
             ptr[0] = nan_delim;
@@ -220,7 +268,7 @@ int flecs_strbuf_ftoa(
         ptr[0] = '\0';
     }
     
-    return ecs_strbuf_appendstrn(out, buf, (int32_t)(ptr - buf));
+    return (int32_t)(ptr - buf);
 }
 
 /* Add an extra element to the buffer */
@@ -395,8 +443,8 @@ bool flecs_strbuf_appendstr(
 
     int32_t memLeftInElement = flecs_strbuf_memLeftInCurrentElement(b);
     int32_t memLeft = flecs_strbuf_memLeft(b);
-    if (memLeft <= 0) {
-        return false;
+    if (memLeft <= 0 || n <= 0) {
+        return memLeft > 0;
     }
 
     /* Never write more than what the buffer can store */
@@ -404,12 +452,19 @@ bool flecs_strbuf_appendstr(
         n = memLeft;
     }
 
+    /* An element is never filled past its size. Clamped anyway so that the
+     * copy sizes below are provably in range, also when asserts are off. */
+    if (memLeftInElement < 0) {
+        memLeftInElement = 0;
+    }
+
+    /* str does not have to be terminated after n, copy exactly n chars */
     if (n <= memLeftInElement) {
         /* Element was large enough to fit string */
-        ecs_os_strncpy(flecs_strbuf_ptr(b), str, n);
+        ecs_os_memcpy(flecs_strbuf_ptr(b), str, n);
         b->current->pos += n;
     } else if ((n - memLeftInElement) < memLeft) {
-        ecs_os_strncpy(flecs_strbuf_ptr(b), str, memLeftInElement);
+        ecs_os_memcpy(flecs_strbuf_ptr(b), str, memLeftInElement);
 
         /* Element was not large enough, but buffer still has space */
         b->current->pos += memLeftInElement;
@@ -421,22 +476,15 @@ bool flecs_strbuf_appendstr(
             flecs_strbuf_grow(b);
 
             /* Copy the remainder to the new buffer */
-            if (n) {
-                /* If a max number of characters to write is set, only a
-                 * subset of the string should be copied to the buffer */
-                ecs_os_strncpy(
-                    flecs_strbuf_ptr(b),
-                    str + memLeftInElement,
-                    (size_t)n);
-            } else {
-                ecs_os_strcpy(flecs_strbuf_ptr(b), str + memLeftInElement);
-            }
+            ecs_os_memcpy(flecs_strbuf_ptr(b), str + memLeftInElement, n);
 
             /* Update to number of characters copied to new buffer */
             b->current->pos += n;
         } else {
-            /* String doesn't fit in a single element, strdup */
-            char *remainder = ecs_os_strdup(str + memLeftInElement);
+            /* String doesn't fit in a single element, copy the remainder */
+            char *remainder = ecs_os_malloc(n + 1);
+            ecs_os_memcpy(remainder, str + memLeftInElement, n);
+            remainder[n] = '\0';
             flecs_strbuf_grow_str(b, remainder, remainder, n);
         }
     } else {
@@ -523,7 +571,7 @@ bool ecs_strbuf_appendint(
 {
     ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL); 
     char numbuf[32];
-    char *ptr = flecs_strbuf_itoa(numbuf, v);
+    char *ptr = flecs_itoa(numbuf, v);
     return ecs_strbuf_appendstrn(b, numbuf, flecs_ito(int32_t, ptr - numbuf));
 }
 
@@ -533,7 +581,14 @@ bool ecs_strbuf_appendflt(
     char nan_delim)
 {
     ecs_assert(b != NULL, ECS_INVALID_PARAMETER, NULL); 
-    return flecs_strbuf_ftoa(b, flt, 10, nan_delim);
+    char numbuf[FLECS_FTOA_SIZE];
+    int32_t len = flecs_ftoa(numbuf, flt, 10, nan_delim);
+    ecs_assert(len < FLECS_FTOA_SIZE, ECS_INTERNAL_ERROR, NULL);
+    /* Also clamp in release, so the compiler can see the copy fits numbuf */
+    if (len >= FLECS_FTOA_SIZE) {
+        len = FLECS_FTOA_SIZE - 1;
+    }
+    return ecs_strbuf_appendstrn(b, numbuf, len);
 }
 
 bool ecs_strbuf_appendstr_zerocpy(
@@ -686,6 +741,9 @@ void ecs_strbuf_reset(
         do {
             next = e->next;
             if (e != (ecs_strbuf_element*)&b->firstElement) {
+                if (!e->buffer_embedded) {
+                    ecs_os_free(((ecs_strbuf_element_str*)e)->alloc_str);
+                }
                 ecs_os_free(e);
             }
         } while ((e = next));
@@ -524,6 +524,10 @@ void flecs_notify_on_add(
 {
     ecs_assert(added != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (flags & EcsEventNoOnAdd) {
+        return;
+    }
+
     if (added->count) {
         ecs_flags32_t table_flags = table->flags;
 
@@ -861,6 +865,27 @@ const ecs_entity_t* flecs_bulk_new(
         flecs_notify_on_set(world, table, row, count, NULL, true);
     }
 
+#ifdef FLECS_JOURNAL
+    if (world->journal) {
+        /* Entity by entity, then value by value, so each ends up in one
+         * journal record */
+        ecs_entity_t *created = ecs_vec_get_t(
+            &data->entities, ecs_entity_t, row);
+        for (i = 0; i < count; i ++) {
+            flecs_journal(world, EcsJournalMove, created[i], 
+                &diff->added, NULL);
+        }
+        if (component_data) {
+            for (i = 0; i < component_ids->count; i ++) {
+                if (component_data[i]) {
+                    flecs_journal_set_range(world, table, row, count, 
+                        component_ids->array[i]);
+                }
+            }
+        }
+    }
+#endif
+
     flecs_defer_end(world, &world->stages[0]);
 
     if (row_out) {
@@ -1105,7 +1130,7 @@ bool ecs_commit(
         diff.added = *added;
     }
     if (removed) {
-        diff.added = *removed;
+        diff.removed = *removed;
     }
     
     flecs_commit(world, entity, record, table, &diff, true, 0);
@@ -1170,6 +1195,14 @@ ecs_entity_t ecs_new_id(
         ecs_entity_t_lo(entity) <= unsafe_world->info.max_id, 
         ECS_OUT_OF_RANGE, NULL);
 
+    /* Lets a delete in the same batch drop the commands for the entity. Not
+     * done on the main stage while other threads may be using it. */
+    if (ecs_poly_is(world, ecs_stage_t) || 
+        !(unsafe_world->flags & EcsWorldMultiThreaded)) 
+    {
+        flecs_defer_new_entity((ecs_stage_t*)stage, entity);
+    }
+
     flecs_journal(world, EcsJournalNew, entity, 0, 0);
 
     return entity;
@@ -1262,6 +1295,7 @@ ecs_entity_t ecs_new_w_id(
         ecs_table_diff_t table_diff;
         flecs_table_diff_build_noalloc(&diff, &table_diff);
         ecs_record_t *r = flecs_entities_get(world, entity);
+        flecs_journal(world, EcsJournalMove, entity, &table_diff.added, NULL);
         flecs_new_entity(world, entity, r, table, &table_diff, true, true);
         flecs_table_diff_builder_fini(world, &diff);
     } else {
@@ -1916,6 +1950,8 @@ void ecs_clear(
 
     ecs_table_t *table = r->table;
     if (table) {
+        flecs_journal_begin(world, EcsJournalClear, entity, NULL, NULL);
+
         ecs_table_diff_t diff = {
             .removed = table->type
         };
@@ -1926,6 +1962,8 @@ void ecs_clear(
         if (r->row & EcsEntityObservedAcyclic) {
             flecs_table_observer_add(table, -1);
         }
+
+        flecs_journal_end();
     }    
 
     flecs_defer_end(world, stage);
@@ -2376,13 +2414,13 @@ void ecs_delete_with(
     ecs_world_t *world,
     ecs_id_t id)
 {
-    flecs_journal_begin(world, EcsJournalDeleteWith, id, NULL, NULL);
-
     ecs_stage_t *stage = flecs_stage_from_world(&world);
     if (flecs_defer_on_delete_action(stage, id, EcsDelete)) {
         return;
     }
 
+    flecs_journal_begin(world, EcsJournalDeleteWith, id, NULL, NULL);
+
     flecs_on_delete(world, id, EcsDelete, false);
     flecs_defer_end(world, stage);
 
@@ -2393,13 +2431,13 @@ void ecs_remove_all(
     ecs_world_t *world,
     ecs_id_t id)
 {
-    flecs_journal_begin(world, EcsJournalRemoveAll, id, NULL, NULL);
-
     ecs_stage_t *stage = flecs_stage_from_world(&world);
     if (flecs_defer_on_delete_action(stage, id, EcsRemove)) {
         return;
     }
 
+    flecs_journal_begin(world, EcsJournalRemoveAll, id, NULL, NULL);
+
     flecs_on_delete(world, id, EcsRemove, false);
     flecs_defer_end(world, stage);
 
@@ -2535,6 +2573,7 @@ ecs_entity_t ecs_clone(
     ecs_type_t src_type = src_table->type;
     ecs_table_diff_t diff = { .added = src_type };
     ecs_record_t *dst_r = flecs_entities_get(world, dst);
+    flecs_journal(world, EcsJournalMove, dst, &diff.added, NULL);
     flecs_new_entity(world, dst, dst_r, src_table, &diff, true, true);
     int32_t row = ECS_RECORD_TO_ROW(dst_r->row);
 
@@ -2542,6 +2581,12 @@ ecs_entity_t ecs_clone(
         flecs_table_move(world, dst, src, src_table,
             row, src_table, ECS_RECORD_TO_ROW(src_r->row), true);
         flecs_notify_on_set(world, src_table, row, 1, NULL, true);
+#ifdef FLECS_JOURNAL
+        int32_t i;
+        for (i = 0; i < src_type.count; i ++) {
+            flecs_journal_set(world, dst, src_type.array[i]);
+        }
+#endif
     }
 
 done:
@@ -2861,7 +2906,7 @@ void flecs_modified_id_if(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
-    if (!flecs_table_record_get(world, table, id)) {
+    if (!table || !flecs_table_record_get(world, table, id)) {
         flecs_defer_end(world, stage);
         return;
     }
@@ -2870,6 +2915,7 @@ void flecs_modified_id_if(
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
     flecs_table_mark_dirty(world, table, id);
+    flecs_journal_set(world, entity, id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -2902,6 +2948,7 @@ void ecs_modified_id(
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
     flecs_table_mark_dirty(world, table, id);
+    flecs_journal_set(world, entity, id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -2947,6 +2994,7 @@ void flecs_copy_ptr_w_id(
             world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
     }
 
+    flecs_journal_set(world, entity, id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -2988,6 +3036,7 @@ void flecs_move_ptr_w_id(
 
     flecs_table_mark_dirty(world, r->table, id);
 
+    /* Mut and Emplace are followed by a Modified, which is journaled */
     if (cmd_kind == EcsOpSet) {
         ecs_table_t *table = r->table;
         if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
@@ -2995,6 +3044,7 @@ void flecs_move_ptr_w_id(
             flecs_notify_on_set(
                 world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
         }
+        flecs_journal_set(world, entity, id);
     }
 
     flecs_defer_end(world, stage);
@@ -4038,6 +4088,83 @@ bool flecs_remove_invalid(
     return true;
 }
 
+/* Skip earlier commands for an entity that set the same id as the command at
+ * cur, as only the last value is visible after the merge. Skipped commands are
+ * discarded (their values destructed) by the merge loop. */
+static
+void flecs_cmd_collapse(
+    ecs_cmd_t *cmds,
+    int32_t start,
+    int32_t cur,
+    ecs_cmd_kind_t kind)
+{
+    ecs_id_t id = cmds[cur].id;
+    int32_t prev = start;
+    while (prev != cur) {
+        ecs_cmd_t *cmd = &cmds[prev];
+        int32_t next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        if (cmd->id == id) {
+            ecs_cmd_kind_t prev_kind = cmd->kind;
+            if (kind == EcsOpSet) {
+                if (prev_kind == EcsOpSet || prev_kind == EcsOpMut) {
+                    cmd->kind = EcsOpSkip;
+                }
+            } else if (prev_kind == kind) {
+                cmd->kind = EcsOpSkip;
+            }
+        }
+        prev = next_for_entity;
+    }
+}
+
+/* Remove ids from the diff that were added and then removed again before the
+ * merge, like a tag that only exists for a frame. The entity didn't have those
+ * ids before and won't have them after, so no events are emitted for them. Ids
+ * that were removed and then added again are kept, as that resets the value
+ * of (for example) an overridden component. */
+static
+void flecs_cmd_diff_collapse(
+    const ecs_world_t *world,
+    ecs_table_diff_builder_t *diff,
+    const ecs_table_t *src_table)
+{
+    int32_t added_count = ecs_vec_count(&diff->added);
+    int32_t removed_count = ecs_vec_count(&diff->removed);
+    if (!added_count || !removed_count) {
+        return;
+    }
+
+    ecs_id_t *added = ecs_vec_first_t(&diff->added, ecs_id_t);
+    ecs_id_t *removed = ecs_vec_first_t(&diff->removed, ecs_id_t);
+    int32_t i = 0, j;
+    while (i < removed_count) {
+        for (j = 0; j < added_count; j ++) {
+            if (added[j] == removed[i]) {
+                break;
+            }
+        }
+        if (j == added_count || (src_table && 
+            ecs_search(world, src_table, removed[i], NULL) != -1)) 
+        {
+            i ++;
+            continue;
+        }
+
+        added_count --;
+        removed_count --;
+        ecs_os_memmove(&added[j], &added[j + 1], 
+            (added_count - j) * ECS_SIZEOF(ecs_id_t));
+        ecs_os_memmove(&removed[i], &removed[i + 1], 
+            (removed_count - i) * ECS_SIZEOF(ecs_id_t));
+    }
+
+    diff->added.count = added_count;
+    diff->removed.count = removed_count;
+}
+
 static
 void flecs_cmd_batch_for_entity(
     ecs_world_t *world,
@@ -4095,6 +4222,7 @@ void flecs_cmd_batch_for_entity(
             /* Add is batched, but keep Modified */
             cmd->kind = EcsOpModified;
             kind = EcsOpAdd;
+            flecs_cmd_collapse(cmds, start, cur, EcsOpModified);
 
             /* fallthrough */
         case EcsOpAdd:
@@ -4102,6 +4230,8 @@ void flecs_cmd_batch_for_entity(
             world->info.cmd.batched_command_count ++;
             break;
         case EcsOpSet:
+            flecs_cmd_collapse(cmds, start, cur, EcsOpSet);
+            /* fallthrough */
         case EcsOpMut:
             table = flecs_find_table_add(world, table, id, diff);
             world->info.cmd.batched_command_count ++;
@@ -4131,6 +4261,8 @@ void flecs_cmd_batch_for_entity(
     } while ((cur = next_for_entity));
 
     /* Move entity to destination table in single operation */
+    bool has_remove = ecs_vec_count(&diff->removed) != 0;
+    flecs_cmd_diff_collapse(world, diff, r ? r->table : NULL);
     flecs_table_diff_build_noalloc(diff, &table_diff);
     flecs_defer_begin(world, &world->stages[0]);
     flecs_commit(world, entity, r, table, &table_diff, true, 0);
@@ -4140,7 +4272,7 @@ void flecs_cmd_batch_for_entity(
     /* If ids were both removed and set, check if there are ids that were both
      * set and removed. If so, skip the set command so that the id won't get
      * re-added */
-    if (has_set && table_diff.removed.count) {
+    if (has_set && has_remove) {
         cur = start;
         do {
             cmd = &cmds[cur];
@@ -4171,6 +4303,419 @@ void flecs_cmd_batch_for_entity(
     }
 }
 
+/* Return the number of commands for an entity if they are stored next to each
+ * other in the queue and only add, set or mark components modified, or 0 if
+ * not. Modified commands aren't linked with the other commands of an entity,
+ * which is why the commands are found by scanning ahead. */
+static
+int32_t flecs_cmd_run_len(
+    ecs_cmd_t *cmds,
+    int32_t first,
+    int32_t count)
+{
+    if (cmds[first].next_for_entity >= 0) {
+        return 0; /* Not the first of multiple commands for an entity */
+    }
+
+    ecs_entity_t e = cmds[first].entity;
+    int32_t cur, end, linked = 0;
+    for (end = first; end < count && cmds[end].entity == e; end ++) {
+        ecs_cmd_kind_t kind = cmds[end].kind;
+        if (kind == EcsOpModified) {
+            continue;
+        }
+        if (kind != EcsOpAdd && kind != EcsOpSet && kind != EcsOpMut) {
+            return 0;
+        }
+        linked ++;
+    }
+
+    /* All linked commands for the entity must be in the range */
+    cur = first;
+    do {
+        int32_t next_for_entity = cmds[cur].next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        linked --;
+        if (!next_for_entity) {
+            break;
+        }
+        if (next_for_entity <= cur || next_for_entity >= end) {
+            return 0;
+        }
+        cur = next_for_entity;
+    } while (true);
+
+    if (linked) {
+        return 0;
+    }
+
+    return end - first;
+}
+
+/* Merge the commands of a run of entities that were queued one after another
+ * with the same commands, and that are in the same table, like a burst of
+ * instances created from a prefab. All entities are moved to the destination
+ * table first, after which OnAdd and OnSet are emitted once for the range of
+ * rows instead of once per entity. Returns the number of merged commands, or 0
+ * if the commands at start don't begin a run. */
+static
+int32_t flecs_cmd_batch_for_run(
+    ecs_world_t *world,
+    ecs_table_diff_builder_t *diff,
+    ecs_cmd_t *cmds,
+    int32_t start,
+    int32_t count)
+{
+    int32_t len = flecs_cmd_run_len(cmds, start, count);
+    if (!len) {
+        return 0;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, cmds[start].entity);
+    if (!r) {
+        return 0;
+    }
+
+    /* Find entities with the same commands that follow the first one */
+    ecs_table_t *src_table = r->table;
+    int32_t i, entity_count = 1, cur = start + len;
+    while ((cur + len) <= count) {
+        ecs_entity_t e = cmds[cur].entity;
+        if (flecs_cmd_run_len(cmds, cur, count) != len) {
+            break;
+        }
+        if (!flecs_entities_is_valid(world, e)) {
+            break;
+        }
+        ecs_record_t *er = flecs_entities_get(world, e);
+        if (!er || er->table != src_table) {
+            break;
+        }
+        for (i = 0; i < len; i ++) {
+            ecs_cmd_t *cmd = &cmds[cur + i], *first = &cmds[start + i];
+            if (cmd->kind != first->kind || cmd->id != first->id) {
+                break;
+            }
+        }
+        if (i != len) {
+            break;
+        }
+        entity_count ++;
+        cur += len;
+    }
+
+    if (entity_count < 2) {
+        return 0;
+    }
+
+    /* Find the destination table. Skip runs that remove ids, as OnRemove would
+     * have to be emitted for rows that aren't next to each other. */
+    ecs_table_t *table = src_table;
+    int32_t value_count = 0, modified_count = 0;
+    for (i = 0; i < len; i ++) {
+        ecs_cmd_t *cmd = &cmds[start + i];
+        if (cmd->kind == EcsOpModified) {
+            modified_count ++;
+            continue;
+        }
+
+        ecs_id_t id = cmd->id;
+        if (!flecs_remove_invalid(world, id, &id) || (id != cmd->id)) {
+            goto skip;
+        }
+        table = flecs_find_table_add(world, table, id, diff);
+        value_count += cmd->kind != EcsOpAdd;
+    }
+
+    ecs_table_diff_t table_diff;
+    flecs_table_diff_build_noalloc(diff, &table_diff);
+    if (table == src_table || !table->type.count || table_diff.removed.count) {
+        goto skip;
+    }
+
+    for (i = 0; i < len; i ++) {
+        ecs_cmd_t *cmd = &cmds[start + i];
+        if (cmd->kind != EcsOpAdd) {
+            if (!table->storage_table || !flecs_table_record_get(
+                world, table->storage_table, cmd->id)) 
+            {
+                goto skip;
+            }
+        }
+    }
+
+    /* Move entities without notifying, so that they end up in adjacent rows */
+    int32_t row = ecs_table_count(table);
+    for (i = 0; i < entity_count; i ++) {
+        ecs_entity_t e = cmds[start + i * len].entity;
+        ecs_record_t *er = flecs_entities_get(world, e);
+        flecs_commit(world, e, er, table, &table_diff, true, EcsEventNoOnAdd);
+        ecs_assert(er->table == table, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(ECS_RECORD_TO_ROW(er->row) == (row + i), 
+            ECS_INTERNAL_ERROR, NULL);
+    }
+
+    world->info.cmd.batched_entity_count += entity_count;
+    world->info.cmd.batched_command_count += 
+        (len - modified_count) * entity_count;
+
+    ecs_stage_t *stage = &world->stages[0];
+    flecs_defer_begin(world, stage);
+    flecs_notify_on_add(world, table, src_table, row, entity_count, 
+        &table_diff.added, 0);
+    flecs_defer_end(world, stage);
+    flecs_table_diff_builder_clear(diff);
+
+    if (!value_count && !modified_count) {
+        return len * entity_count;
+    }
+
+    /* Observers for OnAdd could have changed the entities, in which case the
+     * values are assigned one entity at a time. */
+    bool in_place = true;
+    for (i = 0; i < entity_count; i ++) {
+        ecs_entity_t e = cmds[start + i * len].entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            in_place = false;
+            break;
+        }
+        ecs_record_t *er = flecs_entities_get(world, e);
+        if (er->table != table || ECS_RECORD_TO_ROW(er->row) != (row + i)) {
+            in_place = false;
+            break;
+        }
+    }
+
+    for (cur = start; cur < (start + len * entity_count); cur ++) {
+        ecs_cmd_t *cmd = &cmds[cur];
+        ecs_cmd_kind_t kind = cmd->kind;
+        if (kind == EcsOpAdd) {
+            continue;
+        }
+
+        ecs_entity_t e = cmd->entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            world->info.cmd.discard_count ++;
+            flecs_discard_cmd(world, cmd);
+            continue;
+        }
+
+        if (kind == EcsOpModified) {
+            if (!in_place) {
+                flecs_modified_id_if(world, e, cmd->id);
+            }
+            world->info.cmd.modified_count ++;
+            continue;
+        }
+
+        if (kind == EcsOpSet) {
+            world->info.cmd.set_count ++;
+        } else {
+            world->info.cmd.get_mut_count ++;
+        }
+
+        void *value = cmd->is._1.value;
+        ecs_size_t size = cmd->is._1.size;
+        if (!in_place) {
+            flecs_move_ptr_w_id(world, stage, e, cmd->id, 
+                flecs_itosize(size), value, kind);
+        } else {
+            const ecs_table_record_t *tr = flecs_table_record_get(
+                world, table->storage_table, cmd->id);
+            int32_t column = tr->column;
+            const ecs_type_info_t *ti = table->type_info[column];
+            void *ptr = ecs_vec_get(&table->data.columns[column], ti->size, 
+                row + (cur - start) / len);
+            ecs_move_t move = ti->hooks.move;
+            if (move) {
+                move(ptr, value, 1, ti);
+            } else {
+                ecs_os_memcpy(ptr, value, size);
+            }
+        }
+        flecs_stack_free(value, size);
+    }
+
+    if (in_place) {
+        flecs_defer_begin(world, stage);
+        for (i = 0; i < len; i ++) {
+            ecs_cmd_t *cmd = &cmds[start + i];
+            if (cmd->kind != EcsOpSet && cmd->kind != EcsOpModified) {
+                continue;
+            }
+
+            /* Emit once for ids that were set more than once */
+            int32_t j;
+            for (j = 0; j < i; j ++) {
+                ecs_cmd_t *prev = &cmds[start + j];
+                if (prev->id == cmd->id && (prev->kind == EcsOpSet || 
+                    prev->kind == EcsOpModified)) 
+                {
+                    break;
+                }
+            }
+            if (j != i) {
+                continue;
+            }
+
+            ecs_type_t ids = { .array = &cmd->id, .count = 1 };
+            flecs_notify_on_set(world, table, row, entity_count, &ids, true);
+            flecs_table_mark_dirty(world, table, cmd->id);
+
+            flecs_journal_set_range(world, table, row, entity_count, cmd->id);
+        }
+        flecs_defer_end(world, stage);
+    }
+
+    return len * entity_count;
+skip:
+    flecs_table_diff_builder_clear(diff);
+    return 0;
+}
+
+/* Delete entities that are stored in the same table. If the table has remove
+ * actions, the entities are first swapped to the last rows of the table so that
+ * OnRemove is emitted once for all of them. */
+static
+void flecs_cmd_delete_w_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_cmd_t *cmds,
+    int32_t count)
+{
+    ecs_stage_t *stage = &world->stages[0];
+    int32_t i;
+
+    for (i = 0; i < count; i ++) {
+        flecs_journal(world, EcsJournalDelete, cmds[i].entity, NULL, NULL);
+    }
+
+    flecs_defer_begin(world, stage);
+    if (table->flags & (EcsTableHasOnRemove|EcsTableHasUnSet|EcsTableHasIsA|
+        EcsTableHasObserved)) 
+    {
+        int32_t last = ecs_table_count(table);
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, cmds[i].entity);
+            flecs_table_swap(world, table, ECS_RECORD_TO_ROW(r->row), -- last);
+        }
+
+        flecs_notify_on_remove(world, table, NULL, last, count, &table->type);
+        for (i = last + count - 1; i >= last; i --) {
+            flecs_table_delete(world, table, i, true);
+        }
+    } else {
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, cmds[i].entity);
+            flecs_table_delete(world, table, ECS_RECORD_TO_ROW(r->row), true);
+        }
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = cmds[i].entity;
+        ecs_record_t *r = flecs_entities_get(world, e);
+        r->row = 0;
+        r->table = NULL;
+        flecs_entities_remove(world, e);
+    }
+
+    world->info.cmd.delete_count += count;
+    flecs_defer_end(world, stage);
+}
+
+/* Merge a run of delete commands, like the ones queued by a system that
+ * destructs expired bullets. Entities that are used as an id or relationship
+ * target are deleted one at a time, as their cleanup can delete or move other
+ * entities. The others are grouped by table and removed from their table
+ * together. Returns the number of merged commands, or 0 if the command at
+ * start doesn't begin a run. */
+static
+int32_t flecs_cmd_delete_run(
+    ecs_world_t *world,
+    ecs_cmd_t *cmds,
+    int32_t start,
+    int32_t count)
+{
+    int32_t i, j, end;
+    for (end = start; end < count; end ++) {
+        if (cmds[end].kind != EcsOpDelete) {
+            break;
+        }
+    }
+
+    if ((end - start) < 2) {
+        return 0;
+    }
+
+    for (i = start; i < end; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        ecs_entity_t e = cmd->entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            world->info.cmd.discard_count ++;
+            cmd->kind = EcsOpSkip;
+            continue;
+        }
+
+        ecs_record_t *r = flecs_entities_get(world, e);
+        if (!r->table || ECS_RECORD_TO_ROW_FLAGS(r->row)) {
+            ecs_delete(world, e);
+            world->info.cmd.delete_count ++;
+            cmd->kind = EcsOpSkip;
+        }
+    }
+
+    /* Deleting one group can run observers that delete or move entities of
+     * the next, which is why each group is collected right before deleting */
+    for (i = start; i < end; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        if (cmd->kind == EcsOpSkip) {
+            continue;
+        }
+
+        ecs_entity_t e = cmd->entity;
+        if (!flecs_entities_is_valid(world, e)) {
+            world->info.cmd.discard_count ++;
+            continue;
+        }
+
+        ecs_table_t *table = flecs_entities_get(world, e)->table;
+        int32_t group_end = i + 1;
+        for (j = i + 1; j < end; j ++) {
+            ecs_cmd_t *other = &cmds[j];
+            if (other->kind == EcsOpSkip) {
+                continue;
+            }
+            if (!flecs_entities_is_valid(world, other->entity)) {
+                continue;
+            }
+            if (flecs_entities_get(world, other->entity)->table != table) {
+                continue;
+            }
+
+            /* Commands in a run only differ by entity, swap them to group */
+            ecs_cmd_t tmp = cmds[group_end];
+            cmds[group_end] = *other;
+            *other = tmp;
+            group_end ++;
+        }
+
+        if (table) {
+            flecs_cmd_delete_w_table(world, table, cmd, group_end - i);
+        } else {
+            for (j = i; j < group_end; j ++) {
+                ecs_delete(world, cmds[j].entity);
+                world->info.cmd.delete_count ++;
+            }
+        }
+
+        i = group_end - 1;
+    }
+
+    return end - start;
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool flecs_defer_end(
     ecs_world_t *world,
@@ -4222,6 +4767,12 @@ bool flecs_defer_end(
                 if (merge_to_world && (cmd->next_for_entity < 0)) {
                     /* Batch commands for entity to limit archetype moves */
                     if (is_alive) {
+                        int32_t merged = flecs_cmd_batch_for_run(
+                            world, &diff, cmds, i, count);
+                        if (merged) {
+                            i += merged - 1;
+                            continue;
+                        }
                         flecs_cmd_batch_for_entity(world, &diff, e, cmds, i);
                     } else {
                         world->info.cmd.discard_count ++;
@@ -4238,6 +4789,15 @@ bool flecs_defer_end(
                     continue;
                 }
 
+                if (merge_to_world && (kind == EcsOpDelete)) {
+                    int32_t merged = flecs_cmd_delete_run(
+                        world, cmds, i, count);
+                    if (merged) {
+                        i += merged - 1;
+                        continue;
+                    }
+                }
+
                 ecs_id_t id = cmd->id;
 
                 switch(kind) {
@@ -4303,7 +4863,11 @@ bool flecs_defer_end(
                     world->info.cmd.clear_count ++;
                     break;
                 case EcsOpOnDeleteAction:
+                    flecs_journal_begin(world, e == EcsDelete ? 
+                        EcsJournalDeleteWith : EcsJournalRemoveAll, 
+                        id, NULL, NULL);
                     flecs_on_delete(world, id, e, false);
+                    flecs_journal_end();
                     world->info.cmd.other_count ++;
                     break;
                 case EcsOpEnable:
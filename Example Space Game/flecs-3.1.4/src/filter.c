@@ -1594,7 +1594,12 @@ bool flecs_term_match_table(
             oper = EcsOptional;
         }
 
-        match_table = ecs_get_table(world, src_id);
+        /* Source can already be deleted when tables are created while the
+         * world is cleaning up */
+        match_table = NULL;
+        if (ecs_is_valid(world, src_id)) {
+            match_table = ecs_get_table(world, src_id);
+        }
         if (match_table) {
         } else if (oper != EcsOptional) {
             return false;
@@ -1749,7 +1754,10 @@ bool flecs_filter_match_table(
         }
 
         if (!ecs_term_match_this(term)) {
-            match_table = ecs_get_table(world, src_id);
+            match_table = NULL;
+            if (ecs_is_valid(world, src_id)) {
+                match_table = ecs_get_table(world, src_id);
+            }
         } else {
             if (ECS_BIT_IS_SET(iter_flags, EcsIterIgnoreThis)) {
                 or_result = true;
@@ -223,6 +223,184 @@ void flecs_on_set_symbol(ecs_iter_t *it) {
     }
 }
 
+/* Key of the lookup cache. A lookup is cached with all the arguments that
+ * determine its result, so that repeated lookups of the same path are resolved
+ * with a single hash probe. The cache owns the strings of the keys it stores. */
+typedef struct {
+    ecs_hashed_string_t path;
+    const char *sep;
+    const char *prefix;
+    ecs_entity_t parent;        /* Parent, or scope if no parent was provided */
+    uint64_t lookup_path;       /* Hash of lookup path for recursive lookups */
+    uint64_t hash;
+    bool recursive;
+} ecs_lookup_key_t;
+
+static
+uint64_t flecs_lookup_key_hash(
+    const void *ptr)
+{
+    const ecs_lookup_key_t *key = ptr;
+    return key->hash;
+}
+
+static
+int flecs_lookup_key_strcmp(
+    const char *str1,
+    const char *str2)
+{
+    if (str1 == str2) {
+        return 0;
+    }
+    if (!str1 || !str2) {
+        return (str1 != NULL) - (str2 != NULL);
+    }
+    return ecs_os_strcmp(str1, str2);
+}
+
+static
+int flecs_lookup_key_compare(
+    const void *ptr1,
+    const void *ptr2)
+{
+    const ecs_lookup_key_t *key1 = ptr1;
+    const ecs_lookup_key_t *key2 = ptr2;
+    if (key1->parent != key2->parent) {
+        return (key1->parent > key2->parent) - (key1->parent < key2->parent);
+    }
+    if (key1->recursive != key2->recursive) {
+        return key1->recursive - key2->recursive;
+    }
+    if (key1->lookup_path != key2->lookup_path) {
+        return (key1->lookup_path > key2->lookup_path) - 
+            (key1->lookup_path < key2->lookup_path);
+    }
+
+    ecs_size_t len1 = key1->path.length, len2 = key2->path.length;
+    if (len1 != len2) {
+        return (len1 > len2) - (len1 < len2);
+    }
+
+    int result = ecs_os_memcmp(key1->path.value, key2->path.value, len1);
+    if (result) {
+        return result;
+    }
+
+    result = flecs_lookup_key_strcmp(key1->sep, key2->sep);
+    if (result) {
+        return result;
+    }
+
+    return flecs_lookup_key_strcmp(key1->prefix, key2->prefix);
+}
+
+static
+void flecs_lookup_key_init(
+    const ecs_world_t *stage,
+    ecs_lookup_key_t *key,
+    ecs_entity_t parent,
+    const char *path,
+    const char *sep,
+    const char *prefix,
+    bool recursive)
+{
+    key->path = flecs_get_hashed_string(path, 0, 0);
+    key->sep = sep;
+    key->prefix = prefix;
+    key->parent = parent ? parent : ecs_get_scope(stage);
+    key->lookup_path = 0;
+    key->recursive = recursive;
+
+    /* The lookup path can be modified without calling ecs_set_lookup_path, so
+     * its contents are part of the key */
+    const ecs_entity_t *lookup_path = ecs_get_lookup_path(stage);
+    if (recursive && lookup_path) {
+        int32_t count = 0;
+        while (lookup_path[count]) {
+            count ++;
+        }
+        key->lookup_path = flecs_hash(lookup_path, 
+            count * ECS_SIZEOF(ecs_entity_t));
+    }
+
+    uint64_t h[4] = { key->path.hash, key->parent, key->lookup_path,
+        ((uint64_t)recursive << 16) | ((uint64_t)(sep ? sep[0] : 0) << 8) |
+            (uint64_t)(prefix ? prefix[0] : 0) };
+    key->hash = flecs_hash(h, ECS_SIZEOF(h));
+}
+
+static
+void flecs_lookup_cache_clear(
+    ecs_world_t *world)
+{
+    flecs_hashmap_iter_t it = flecs_hashmap_iter(&world->lookup_cache);
+    ecs_lookup_key_t *key;
+    while (_flecs_hashmap_next(&it, ECS_SIZEOF(ecs_lookup_key_t), 
+        &key, ECS_SIZEOF(ecs_entity_t))) 
+    {
+        ecs_os_free(key->path.value);
+        ecs_os_free((char*)key->sep);
+        ecs_os_free((char*)key->prefix);
+    }
+
+    flecs_hashmap_fini(&world->lookup_cache);
+    flecs_hashmap_init(&world->lookup_cache, ecs_lookup_key_t, ecs_entity_t,
+        flecs_lookup_key_hash, flecs_lookup_key_compare, &world->allocator);
+    world->lookup_cache_dirty = false;
+}
+
+static
+ecs_entity_t flecs_lookup_cache_get(
+    const ecs_world_t *world,
+    const ecs_lookup_key_t *key)
+{
+    ecs_entity_t *e = flecs_hashmap_get(
+        &world->lookup_cache, key, ecs_entity_t);
+    if (e && ecs_is_alive(world, *e)) {
+        return *e;
+    }
+    return 0;
+}
+
+static
+void flecs_lookup_cache_set(
+    ecs_world_t *world,
+    const ecs_lookup_key_t *key,
+    ecs_entity_t e)
+{
+    flecs_hashmap_result_t r = flecs_hashmap_ensure(
+        &world->lookup_cache, key, ecs_entity_t);
+    ecs_entity_t *value = r.value;
+    if (!value[0]) {
+        /* New entry, intern the strings of the key */
+        ecs_lookup_key_t *elem = r.key;
+        elem->path.value = ecs_os_memdup(key->path.value, key->path.length + 1);
+        elem->sep = key->sep ? ecs_os_strdup(key->sep) : NULL;
+        elem->prefix = key->prefix ? ecs_os_strdup(key->prefix) : NULL;
+    }
+    value[0] = e;
+}
+
+void flecs_lookup_cache_invalidate(
+    ecs_world_t *world)
+{
+    /* The cache is cleared by the next lookup, so that a burst of renames or
+     * reparents doesn't clear it more than once */
+    if (world->flags & EcsWorldLookupCache) {
+        world->lookup_cache_dirty = true;
+    }
+}
+
+void flecs_lookup_cache_fini(
+    ecs_world_t *world)
+{
+    if (world->flags & EcsWorldLookupCache) {
+        flecs_lookup_cache_clear(world);
+        flecs_hashmap_fini(&world->lookup_cache);
+        world->flags &= ~EcsWorldLookupCache;
+    }
+}
+
 void flecs_bootstrap_hierarchy(ecs_world_t *world) {
     ecs_observer_init(world, &(ecs_observer_desc_t){
         .entity = ecs_entity(world, {.add = {ecs_childof(EcsFlecsInternals)}}),
@@ -392,6 +570,41 @@ ecs_entity_t ecs_lookup_path_w_sep(
         return e;
     }
 
+    if (!sep) {
+        sep = ".";
+    }
+
+    /* Don't write to the cache while the world is readonly, as lookups may
+     * then run on multiple threads */
+    ecs_lookup_key_t key;
+    bool cache = (world->flags & EcsWorldLookupCache) && sep[0];
+    bool cache_write = cache && !(world->flags & EcsWorldReadonly);
+    if (cache) {
+        if (world->lookup_cache_dirty) {
+            if (cache_write) {
+                flecs_lookup_cache_clear((ecs_world_t*)world);
+            } else {
+                cache = false;
+            }
+        }
+    }
+
+    if (cache) {
+        flecs_lookup_key_init(stage, &key, parent, path, sep, prefix, recursive);
+        e = flecs_lookup_cache_get(world, &key);
+        if (cache_write) {
+            ecs_world_t *w = (ecs_world_t*)world;
+            if (e) {
+                w->info.lookup_cache_hit_total ++;
+            } else {
+                w->info.lookup_cache_miss_total ++;
+            }
+        }
+        if (e) {
+            return e;
+        }
+    }
+
     e = flecs_name_index_find(&world->aliases, path, 0, 0);
     if (e) {
         return e;
@@ -410,10 +623,6 @@ ecs_entity_t ecs_lookup_path_w_sep(
         lookup_path_cur ++;
     }
 
-    if (!sep) {
-        sep = ".";
-    }
-
     parent = flecs_get_parent_from_path(stage, parent, &path, prefix, true);
 
     if (!sep[0]) {
@@ -470,11 +679,33 @@ tail:
         ecs_os_free(elem);
     }
 
+    if (cur && cache_write) {
+        flecs_lookup_cache_set((ecs_world_t*)world, &key, cur);
+    }
+
     return cur;
 error:
     return 0;
 }
 
+bool ecs_enable_lookup_cache(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    bool old_value = (world->flags & EcsWorldLookupCache) != 0;
+    if (enable && !old_value) {
+        flecs_hashmap_init(&world->lookup_cache, ecs_lookup_key_t, 
+            ecs_entity_t, flecs_lookup_key_hash, flecs_lookup_key_compare,
+            &world->allocator);
+        world->lookup_cache_dirty = false;
+        world->flags |= EcsWorldLookupCache;
+    } else if (!enable && old_value) {
+        flecs_lookup_cache_fini(world);
+    }
+    return old_value;
+}
+
 ecs_entity_t ecs_set_scope(
     ecs_world_t *world,
     ecs_entity_t scope)
@@ -62,6 +62,14 @@ ecs_entity_t flecs_get_oneof(
     const ecs_world_t *world,
     ecs_entity_t e);
 
+/* Invalidate the lookup cache after an entity name or parent changed */
+void flecs_lookup_cache_invalidate(
+    ecs_world_t *world);
+
+/* Free the lookup cache */
+void flecs_lookup_cache_fini(
+    ecs_world_t *world);
+
 void flecs_notify_on_remove(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -291,6 +299,26 @@ void ecs_colorize_buf(
 bool flecs_isident(
     char ch);
 
+/* Minimum size of the buffer passed to flecs_ftoa */
+#define FLECS_FTOA_SIZE (64)
+
+/* Write integer to buffer, returns end of the written string (not terminated) */
+char* flecs_itoa(
+    char *buf,
+    int64_t v);
+
+char* flecs_utoa(
+    char *buf,
+    uint64_t v);
+
+/* Write floating point number in the format of ecs_strbuf_appendflt to buffer,
+ * returns the number of characters written */
+int32_t flecs_ftoa(
+    char *buf,
+    double f,
+    int32_t precision,
+    char nan_delim);
+
 int32_t flecs_search_relation_w_idr(
     const ecs_world_t *world,
     const ecs_table_t *table,
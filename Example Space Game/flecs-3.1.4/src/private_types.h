@@ -191,6 +191,8 @@ struct ecs_table_t {
     int32_t refcount;                /* Increased when used as storage table */
     int32_t lock;                    /* Prevents modifications */
     int32_t observed_count;          /* Number of observed entities in table */
+    int32_t reserve_count;           /* Storage kept by ecs_table_reserve */
+    int32_t realloc_count;           /* Number of times storage was resized */
     uint16_t record_count;           /* Table record count including wildcards */
 };
 
@@ -338,6 +340,7 @@ struct ecs_query_t {
     /* Table sorting */
     ecs_entity_t order_by_component;
     ecs_order_by_action_t order_by;
+    ecs_order_by_key_action_t order_by_key;
     ecs_sort_table_action_t sort_table;
     ecs_vector_t *table_slices;
 
@@ -461,8 +464,9 @@ typedef struct ecs_cmd_t {
 
 /* Entity specific metadata for command in defer queue */
 typedef struct ecs_cmd_entry_t {
-    int32_t first;
+    int32_t first; /* If -1, entity was created but has no commands yet */
     int32_t last; /* If -1, a delete command was inserted */
+    bool is_new;  /* Entity was created in the same batch */
 } ecs_cmd_entry_t;
 
 /** A stage is a context that allows for safely using the API from multiple 
@@ -485,6 +489,7 @@ struct ecs_stage_t {
     ecs_world_t *thread_ctx;     /* Points to stage when a thread stage */
     ecs_world_t *world;          /* Reference to world */
     ecs_os_thread_t thread;      /* Thread handle (0 if no threading is used) */
+    int32_t sync_spin;           /* Adaptive spin budget for sync points */
 
     /* One-shot actions to be executed after the merge */
     ecs_vector_t *post_frame_actions;
@@ -552,6 +557,11 @@ typedef struct ecs_action_elem_t {
 
 /** The world stores and manages all ECS data. An application can have more than
  * one world, but data is not shared between worlds. */
+#ifdef FLECS_JOURNAL
+/** Binary journal writer (see addons/journal.c) */
+typedef struct ecs_journal_writer_t ecs_journal_writer_t;
+#endif
+
 struct ecs_world_t {
     ecs_header_t hdr;
 
@@ -578,6 +588,9 @@ struct ecs_world_t {
     /* Is entity range checking enabled? */
     bool range_check_enabled;
 
+    /* Factor by which table storage grows when it runs out of space */
+    int32_t table_growth_factor;
+
     /* --  Data storage -- */
     ecs_store_t store;
 
@@ -594,6 +607,8 @@ struct ecs_world_t {
     /* -- Identifiers -- */
     ecs_hashmap_t aliases;
     ecs_hashmap_t symbols;
+    ecs_hashmap_t lookup_cache;  /* hashmap<lookup arguments, entity> */
+    bool lookup_cache_dirty;     /* Names or parents changed since last lookup */
 
     /* -- Staging -- */
     ecs_stage_t *stages;         /* Stages */
@@ -605,6 +620,9 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;   /* Mutex for job_cond */
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
+    int32_t workers_parked;      /* Number of workers blocked on worker_cond */
+    int32_t worker_generation;   /* Increases each time workers are released */
+    bool main_parked;            /* Is main thread blocked on sync_cond */
 
     /* -- Time management -- */
     ecs_time_t world_start_time; /* Timestamp of simulation start */
@@ -626,6 +644,10 @@ struct ecs_world_t {
 
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
+
+#ifdef FLECS_JOURNAL
+    ecs_journal_writer_t *journal; /* Binary journal, if open */
+#endif
 };
 
 #endif
@@ -941,6 +941,111 @@ void flecs_query_sort_table(
     }
 }
 
+/* Key & original row of an entity, used by the radix sort */
+typedef struct flecs_sort_key_t {
+    uint64_t key;
+    int32_t row;
+} flecs_sort_key_t;
+
+/* Stable LSD radix sort on 8 bit digits. Digits that are the same for all keys
+ * are skipped, so 32 bit keys take at most 4 passes. Returns the array that
+ * holds the result, which is either keys or tmp. */
+static
+flecs_sort_key_t* flecs_query_radix_sort(
+    flecs_sort_key_t *keys,
+    flecs_sort_key_t *tmp,
+    int32_t count)
+{
+    int32_t histogram[8][256] = {{0}};
+    uint64_t first = keys[0].key, diff = 0;
+    int32_t i, d;
+    for (i = 0; i < count; i ++) {
+        uint64_t key = keys[i].key;
+        diff |= key ^ first;
+        for (d = 0; d < 8; d ++) {
+            histogram[d][(key >> (d * 8)) & 0xFF] ++;
+        }
+    }
+
+    for (d = 0; d < 8; d ++) {
+        if (!((diff >> (d * 8)) & 0xFF)) {
+            continue; /* All keys have the same digit */
+        }
+
+        int32_t offset = 0, *h = histogram[d];
+        for (i = 0; i < 256; i ++) {
+            int32_t c = h[i];
+            h[i] = offset;
+            offset += c;
+        }
+
+        for (i = 0; i < count; i ++) {
+            tmp[h[(keys[i].key >> (d * 8)) & 0xFF] ++] = keys[i];
+        }
+
+        flecs_sort_key_t *t = keys;
+        keys = tmp;
+        tmp = t;
+    }
+
+    return keys;
+}
+
+/* Sort table by integer key. Keys are extracted once and radix sorted together
+ * with their rows, after which the table is reordered in one pass. */
+static
+void flecs_query_sort_table_by_key(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column_index,
+    ecs_order_by_key_action_t key_of)
+{
+    ecs_data_t *data = &table->data;
+    int32_t count = flecs_table_data_count(data);
+    if (count < 2) {
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vec_first(&data->entities);
+
+    void *ptr = NULL;
+    int32_t size = 0;
+    if (column_index != -1) {
+        ecs_type_info_t *ti = table->type_info[column_index];
+        ecs_vec_t *column = &data->columns[column_index];
+        size = ti->size;
+        ptr = ecs_vec_first(column);
+    }
+
+    flecs_sort_key_t *keys = ecs_os_malloc_n(flecs_sort_key_t, count * 2);
+    bool sorted = true;
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        keys[i].key = key_of(entities[i], ECS_ELEM(ptr, size, i));
+        keys[i].row = i;
+        sorted &= !i || (keys[i - 1].key <= keys[i].key);
+    }
+
+    if (sorted) {
+        /* Common when rows were only added at the end with larger keys, or when
+         * another column in the table changed */
+        ecs_os_free(keys);
+        return;
+    }
+
+    flecs_sort_key_t *result = flecs_query_radix_sort(keys, &keys[count], count);
+
+    /* The buffer that didn't hold the result is free, reuse it for the rows */
+    int32_t *rows = (int32_t*)(result == keys ? &keys[count] : keys);
+    for (i = 0; i < count; i ++) {
+        rows[i] = result[i].row;
+    }
+
+    flecs_table_permute(world, table, rows);
+
+    ecs_os_free(keys);
+}
+
 /* Helper struct for building sorted table ranges */
 typedef struct sort_helper_t {
     ecs_query_table_match_t *match;
@@ -950,6 +1055,7 @@ typedef struct sort_helper_t {
     int32_t elem_size;
     int32_t count;
     bool shared;
+    uint64_t key; /* Key of current row when ordering by key */
 } sort_helper_t;
 
 static
@@ -977,6 +1083,107 @@ ecs_entity_t e_from_helper(
     }
 }
 
+/* Compare helpers by the key of their current row. Ties go to the table that
+ * comes first, which matches the order in which order_by merges tables. */
+static
+bool flecs_sort_helper_lt(
+    const sort_helper_t *helper,
+    int32_t h1,
+    int32_t h2)
+{
+    uint64_t k1 = helper[h1].key, k2 = helper[h2].key;
+    return (k1 < k2) || ((k1 == k2) && (h1 < h2));
+}
+
+static
+void flecs_sort_heap_down(
+    const sort_helper_t *helper,
+    int32_t *heap,
+    int32_t count,
+    int32_t i)
+{
+    for (;;) {
+        int32_t l = i * 2 + 1, r = l + 1, min = i;
+        if (l < count && flecs_sort_helper_lt(helper, heap[l], heap[min])) {
+            min = l;
+        }
+        if (r < count && flecs_sort_helper_lt(helper, heap[r], heap[min])) {
+            min = r;
+        }
+        if (min == i) {
+            break;
+        }
+
+        int32_t t = heap[i];
+        heap[i] = heap[min];
+        heap[min] = t;
+        i = min;
+    }
+}
+
+/* Merge tables that are sorted by key using a min heap. Each step emits the 
+ * run of rows from the top table that sorts before the next table as a single
+ * slice, so no comparator is called and tables that don't interleave produce
+ * one slice. */
+static
+void flecs_query_merge_sorted_by_key(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t count)
+{
+    ecs_order_by_key_action_t key_of = query->order_by_key;
+    int32_t *heap = ecs_os_malloc_n(int32_t, count);
+    int32_t i, heap_count = count;
+
+    for (i = 0; i < count; i ++) {
+        sort_helper_t *h = &helper[i];
+        h->key = key_of(e_from_helper(h), ptr_from_helper(h));
+        heap[i] = i;
+    }
+
+    for (i = count / 2 - 1; i >= 0; i --) {
+        flecs_sort_heap_down(helper, heap, count, i);
+    }
+
+    while (heap_count) {
+        int32_t top = heap[0];
+        sort_helper_t *h = &helper[top];
+        int32_t start = h->row;
+
+        /* The table that sorts next is one of the children of the root */
+        int32_t next = -1;
+        if (heap_count > 1) {
+            next = heap[1];
+        }
+        if (heap_count > 2 && flecs_sort_helper_lt(helper, heap[2], next)) {
+            next = heap[2];
+        }
+
+        do {
+            h->row ++;
+            if (h->row == h->count) {
+                break;
+            }
+            h->key = key_of(e_from_helper(h), ptr_from_helper(h));
+        } while (next == -1 || flecs_sort_helper_lt(helper, top, next));
+
+        ecs_query_table_node_t *slice = ecs_vector_add(
+            &query->table_slices, ecs_query_table_node_t);
+        ecs_assert(slice != NULL, ECS_INTERNAL_ERROR, NULL);
+        slice->match = h->match;
+        slice->offset = start;
+        slice->count = h->row - start;
+
+        if (h->row == h->count) {
+            heap[0] = heap[-- heap_count];
+        }
+
+        flecs_sort_heap_down(helper, heap, heap_count, 0);
+    }
+
+    ecs_os_free(heap);
+}
+
 static
 void flecs_query_build_sorted_table_range(
     ecs_query_t *query,
@@ -1044,52 +1251,56 @@ void flecs_query_build_sorted_table_range(
 
     ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
+    if (query->order_by_key) {
+        flecs_query_merge_sorted_by_key(query, helper, to_sort);
+    } else {
+        bool proceed;
+        do {
+            int32_t j, min = 0;
+            proceed = true;
+
+            ecs_entity_t e1;
+            while (!(e1 = e_from_helper(&helper[min]))) {
+                min ++;
+                if (min == to_sort) {
+                    proceed = false;
+                    break;
+                }
+            }
 
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
+            if (!proceed) {
                 break;
             }
-        }
 
-        if (!proceed) {
-            break;
-        }
-
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
-            }
+            for (j = min + 1; j < to_sort; j++) {
+                ecs_entity_t e2 = e_from_helper(&helper[j]);
+                if (!e2) {
+                    continue;
+                }
 
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
+                const void *ptr1 = ptr_from_helper(&helper[min]);
+                const void *ptr2 = ptr_from_helper(&helper[j]);
 
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
-                e1 = e_from_helper(&helper[min]);
+                if (compare(e1, ptr1, e2, ptr2) > 0) {
+                    min = j;
+                    e1 = e_from_helper(&helper[min]);
+                }
             }
-        }
 
-        sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->match != cur_helper->match) {
-            cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
-            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
-            cur->match = cur_helper->match;
-            cur->offset = cur_helper->row;
-            cur->count = 1;
-        } else {
-            cur->count ++;
-        }
+            sort_helper_t *cur_helper = &helper[min];
+            if (!cur || cur->match != cur_helper->match) {
+                cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
+                ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
+                cur->match = cur_helper->match;
+                cur->offset = cur_helper->row;
+                cur->count = 1;
+            } else {
+                cur->count ++;
+            }
 
-        cur_helper->row ++;
-    } while (proceed);
+            cur_helper->row ++;
+        } while (proceed);
+    }
 
     /* Iterate through the vector of slices to set the prev/next ptrs. This
      * can't be done while building the vector, as reallocs may occur */
@@ -1144,7 +1355,8 @@ void flecs_query_sort_tables(
     ecs_query_t *query)
 {
     ecs_order_by_action_t compare = query->order_by;
-    if (!compare) {
+    ecs_order_by_key_action_t key_of = query->order_by_key;
+    if (!compare && !key_of) {
         return;
     }
 
@@ -1216,7 +1428,11 @@ void flecs_query_sort_tables(
         }
 
         /* Something has changed, sort the table. Prefers using flecs_query_sort_table when available */
-        flecs_query_sort_table(world, table, column, compare, sort);
+        if (key_of) {
+            flecs_query_sort_table_by_key(world, table, column, key_of);
+        } else {
+            flecs_query_sort_table(world, table, column, compare, sort);
+        }
         tables_sorted = true;
     }
 
@@ -1634,6 +1850,7 @@ void flecs_query_order_by(
     ecs_query_t *query,
     ecs_entity_t order_by_component,
     ecs_order_by_action_t order_by,
+    ecs_order_by_key_action_t order_by_key,
     ecs_sort_table_action_t action)
 {
     ecs_check(query != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -1641,6 +1858,7 @@ void flecs_query_order_by(
 
     query->order_by_component = order_by_component;
     query->order_by = order_by;
+    query->order_by_key = order_by_key;
     query->sort_table = action;
 
     ecs_vector_free(query->table_slices);
@@ -1951,10 +2169,10 @@ ecs_query_t* ecs_query_init(
         result->parent = desc->parent;
     }
 
-    if (desc->order_by) {
+    if (desc->order_by || desc->order_by_key) {
         flecs_query_order_by(
             world, result, desc->order_by_component, desc->order_by,
-            desc->sort_table);
+            desc->order_by_key, desc->sort_table);
     }
 
     if (!ecs_query_table_count(result) && result->filter.term_count) {
@@ -2028,7 +2246,9 @@ ecs_iter_t ecs_query_iter(
         .last = NULL
     };
 
-    if (query->order_by && query->list.info.table_count) {
+    if ((query->order_by || query->order_by_key) && 
+        query->list.info.table_count) 
+    {
         it.node = ecs_vector_first(query->table_slices, ecs_query_table_node_t);
     }
 
@@ -27,6 +27,30 @@ ecs_cmd_t* flecs_cmd_alloc(
     return cmd;
 }
 
+/* Commands queued for an entity that is created and deleted in the same batch
+ * have no visible effect. Skip them, so that the merge doesn't create the
+ * entity in a table right before deleting it. Entities that existed before the
+ * batch keep their commands, so observers still see e.g. OnSet before the
+ * entity is deleted. */
+static
+void flecs_cmd_skip_for_entity(
+    ecs_vec_t *cmds,
+    int32_t first)
+{
+    ecs_cmd_t *arr = ecs_vec_first_t(cmds, ecs_cmd_t);
+    int32_t cur = first;
+    do {
+        ecs_cmd_t *cmd = &arr[cur];
+        int32_t next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        cmd->kind = EcsOpSkip;
+        cmd->next_for_entity = 0;
+        cur = next_for_entity;
+    } while (cur);
+}
+
 static
 ecs_cmd_t* flecs_cmd_new(
     ecs_stage_t *stage, 
@@ -46,7 +70,10 @@ ecs_cmd_t* flecs_cmd_new(
                 return NULL;
             }
 
-            if (can_batch) {
+            if (can_batch && entry->first == -1) {
+                /* First command for an entity created in this batch */
+                entry->first = cur;
+            } else if (can_batch) {
                 ecs_cmd_t *arr = ecs_vec_first_t(cmds, ecs_cmd_t);
                 ecs_assert(arr[last].entity == e, ECS_INTERNAL_ERROR, NULL);
                 ecs_cmd_t *last_op = &arr[last];
@@ -56,11 +83,14 @@ ecs_cmd_t* flecs_cmd_new(
                      * is the first for an entity */
                     last_op->next_for_entity *= -1;
                 }
+            } else if (is_delete && entry->is_new && entry->first != -1) {
+                flecs_cmd_skip_for_entity(cmds, entry->first);
             }
         } else if (can_batch || is_delete) {
             entry = flecs_sparse_ensure_t(&stage->cmd_entries, 
                 ecs_cmd_entry_t, e);
             entry->first = cur;
+            entry->is_new = false;
         }
         if (can_batch) {
             entry->last = cur;
@@ -167,6 +197,19 @@ bool flecs_defer_cmd(
     return false;
 }
 
+void flecs_defer_new_entity(
+    ecs_stage_t *stage,
+    ecs_entity_t entity)
+{
+    if (stage->defer > 0) {
+        ecs_cmd_entry_t *entry = flecs_sparse_ensure_t(
+            &stage->cmd_entries, ecs_cmd_entry_t, entity);
+        entry->first = -1; /* No commands queued yet */
+        entry->last = 0;
+        entry->is_new = true;
+    }
+}
+
 bool flecs_defer_modified(
     ecs_stage_t *stage,
     ecs_entity_t entity,
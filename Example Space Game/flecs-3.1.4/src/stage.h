@@ -28,6 +28,11 @@ bool flecs_defer_begin(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+/* Entity was created while deferred, by the batch that is being recorded */
+void flecs_defer_new_entity(
+    ecs_stage_t *stage,
+    ecs_entity_t entity);
+
 bool flecs_defer_modified(
     ecs_stage_t *stage,
     ecs_entity_t entity,
@@ -385,6 +385,8 @@ void flecs_table_init_flags(
                     table->sw_count ++;
                 } else if (r == ecs_id(EcsPoly)) {
                     table->flags |= EcsTableHasBuiltins;
+                } else if (id == ecs_pair(ecs_id(EcsIdentifier), EcsName)) {
+                    table->flags |= EcsTableHasName;
                 }
             } else {
                 if (ECS_HAS_ID_FLAG(id, TOGGLE)) {
@@ -1421,13 +1423,15 @@ void* flecs_table_grow_column(
             ecs_vec_set_size(&world->allocator, column, size, dst_size);
         }
 
-        result = ecs_vec_grow(&world->allocator, column, size, to_add);
+        if (to_add) {
+            result = ecs_vec_grow(&world->allocator, column, size, to_add);
 
-        ecs_xtor_t ctor;
-        if (construct && (ctor = ti->hooks.ctor)) {
-            /* If new elements need to be constructed and component has a
-             * constructor, construct */
-            ctor(result, to_add, ti);
+            ecs_xtor_t ctor;
+            if (construct && (ctor = ti->hooks.ctor)) {
+                /* If new elements need to be constructed and component has a
+                 * constructor, construct */
+                ctor(result, to_add, ti);
+            }
         }
     }
 
@@ -1436,6 +1440,52 @@ void* flecs_table_grow_column(
     return result;
 }
 
+/* Resize storage of the entity, record and component vectors of a table to the
+ * same size, without changing the number of entities in the table. */
+static
+void flecs_table_resize_data(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t size)
+{
+    ecs_vec_set_size_t(&world->allocator, &data->entities, ecs_entity_t, size);
+    size = data->entities.size; /* Vector sizes are rounded to a power of 2 */
+    ecs_vec_set_size_t(&world->allocator, &data->records, ecs_record_t*, size);
+
+    int32_t i, column_count = table->storage_count;
+    for (i = 0; i < column_count; i ++) {
+        flecs_table_grow_column(world, &data->columns[i], table->type_info[i], 
+            0, size, false);
+    }
+
+    table->realloc_count ++;
+    world->info.table_realloc_total ++;
+}
+
+/* Make room for count entities in a table. When the table is full it grows by
+ * the world's growth factor, so the column appends that follow don't have to 
+ * reallocate one by one. */
+static
+void flecs_table_ensure_size(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t count)
+{
+    int32_t size = data->entities.size;
+    if (count <= size) {
+        return;
+    }
+
+    size *= world->table_growth_factor;
+    if (size < count) {
+        size = count;
+    }
+
+    flecs_table_resize_data(world, table, data, size);
+}
+
 static
 int32_t flecs_table_grow_data(
     ecs_world_t *world,
@@ -1548,6 +1598,7 @@ int32_t flecs_table_append(
     int32_t count = data->entities.count;
     int32_t column_count = table->storage_count;
     ecs_vec_t *columns = table->data.columns;
+    flecs_table_ensure_size(world, table, data, count + 1);
 
     /* Grow buffer with entity ids, set new element to new entity */
     ecs_entity_t *e = ecs_vec_append_t(&world->allocator, 
@@ -1958,8 +2009,9 @@ int32_t flecs_table_appendn(
 
     flecs_table_check_sanity(table);
     int32_t cur_count = flecs_table_data_count(data);
+    flecs_table_ensure_size(world, table, data, cur_count + to_add);
     int32_t result = flecs_table_grow_data(
-        world, table, data, to_add, cur_count + to_add, ids);
+        world, table, data, to_add, data->entities.size, ids);
     flecs_table_check_sanity(table);
 
     return result;
@@ -1976,14 +2028,68 @@ void flecs_table_set_size(
 
     flecs_table_check_sanity(table);
 
-    int32_t cur_count = flecs_table_data_count(data);
-
-    if (cur_count < size) {
-        flecs_table_grow_data(world, table, data, 0, size, NULL);
+    if (data->entities.size < size) {
+        flecs_table_resize_data(world, table, data, size);
         flecs_table_check_sanity(table);
     }
 }
 
+void ecs_table_reserve(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, NULL);
+
+    if (count > table->reserve_count) {
+        table->reserve_count = count;
+        flecs_table_set_size(world, table, &table->data, count);
+    }
+error:
+    return;
+}
+
+int32_t ecs_table_get_realloc_count(
+    const ecs_table_t *table)
+{
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    return table->realloc_count;
+error:
+    return 0;
+}
+
+static
+int64_t flecs_table_storage_bytes(
+    const ecs_table_t *table)
+{
+    const ecs_data_t *data = &table->data;
+    int64_t result = (int64_t)ecs_vec_size(&data->entities) * ECS_SIZEOF(ecs_entity_t);
+    result += (int64_t)ecs_vec_size(&data->records) * ECS_SIZEOF(ecs_record_t*);
+    int32_t i, count = table->storage_count;
+    for (i = 0; i < count; i ++) {
+        result += (int64_t)ecs_vec_size(&data->columns[i]) * 
+            table->type_info[i]->size;
+    }
+    return result;
+}
+
+int64_t ecs_get_table_storage_bytes(
+    const ecs_world_t *world)
+{
+    world = ecs_get_world(world);
+    int64_t result = flecs_table_storage_bytes(&world->store.root);
+    int32_t i, count = flecs_sparse_count(&world->store.tables);
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get_dense_t(&world->store.tables,
+            ecs_table_t, i);
+        result += flecs_table_storage_bytes(table);
+    }
+    return result;
+}
+
 bool flecs_table_shrink(
     ecs_world_t *world,
     ecs_table_t *table)
@@ -1995,6 +2101,17 @@ bool flecs_table_shrink(
     flecs_table_check_sanity(table);
 
     ecs_data_t *data = &table->data;
+
+    /* Tables with reserved storage only give back what they grew beyond it */
+    int32_t reserve_count = table->reserve_count;
+    if (reserve_count) {
+        if (flecs_next_pow_of_2(reserve_count) < data->entities.size) {
+            flecs_table_resize_data(world, table, data, reserve_count);
+            return true;
+        }
+        return false;
+    }
+
     bool has_payload = data->entities.array != NULL;
     ecs_vec_reclaim_t(&world->allocator, &data->entities, ecs_entity_t);
     ecs_vec_reclaim_t(&world->allocator, &data->records, ecs_record_t*);
@@ -2140,6 +2257,107 @@ void flecs_table_swap(
     flecs_table_check_sanity(table);
 }
 
+static
+void flecs_table_permute_swap(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *rows,
+    int32_t count)
+{
+    /* Track where each row is while swapping, since earlier swaps move rows 
+     * that haven't been placed yet */
+    int32_t *pos = ecs_os_malloc_n(int32_t, count * 2);
+    int32_t *row_at = &pos[count];
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        pos[i] = i;
+        row_at[i] = i;
+    }
+
+    for (i = 0; i < count; i ++) {
+        int32_t row = rows[i];
+        int32_t cur = pos[row];
+        if (cur != i) {
+            int32_t displaced = row_at[i];
+            flecs_table_swap(world, table, i, cur);
+            row_at[i] = row;
+            row_at[cur] = displaced;
+            pos[row] = i;
+            pos[displaced] = cur;
+        }
+    }
+
+    ecs_os_free(pos);
+}
+
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *rows)
+{
+    ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
+
+    flecs_table_check_sanity(table);
+
+    int32_t i, count = ecs_table_count(table);
+    if (count < 2) {
+        return;
+    }
+
+    /* Union and bitset columns only support swapping rows */
+    if (table->sw_count || table->bs_count) {
+        flecs_table_permute_swap(world, table, rows, count);
+        return;
+    }
+
+    /* Like flecs_table_swap, elements are relocated with memcpy */
+    ecs_type_info_t **type_info = table->type_info;
+    int32_t column_count = table->storage_count;
+    int32_t elem_size = ECS_SIZEOF(ecs_record_t*);
+    for (i = 0; i < column_count; i ++) {
+        elem_size = ECS_MAX(elem_size, type_info[i]->size);
+    }
+
+    flecs_table_mark_table_dirty(world, table, 0);
+
+    /* Gather each column into a temporary buffer in the new order. This moves
+     * every element once, where swapping moves it up to three times and has
+     * to update the records of both entities each time */
+    void *tmp = ecs_os_malloc(elem_size * count);
+    ecs_data_t *data = &table->data;
+    ecs_entity_t *entities = data->entities.array;
+    ecs_record_t **records = data->records.array;
+
+    ecs_entity_t *tmp_entities = tmp;
+    for (i = 0; i < count; i ++) {
+        tmp_entities[i] = entities[rows[i]];
+    }
+    ecs_os_memcpy_n(entities, tmp_entities, ecs_entity_t, count);
+
+    ecs_record_t **tmp_records = tmp;
+    for (i = 0; i < count; i ++) {
+        ecs_record_t *r = records[rows[i]];
+        r->row = ECS_ROW_TO_RECORD(i, ECS_RECORD_TO_ROW_FLAGS(r->row));
+        tmp_records[i] = r;
+    }
+    ecs_os_memcpy_n(records, tmp_records, ecs_record_t*, count);
+
+    int32_t c;
+    for (c = 0; c < column_count; c ++) {
+        int32_t size = type_info[c]->size;
+        void *ptr = data->columns[c].array;
+        for (i = 0; i < count; i ++) {
+            ecs_os_memcpy(ECS_ELEM(tmp, size, i), 
+                ECS_ELEM(ptr, size, rows[i]), size);
+        }
+        ecs_os_memcpy(ptr, tmp, size * count);
+    }
+
+    ecs_os_free(tmp);
+
+    flecs_table_check_sanity(table);
+}
+
 static
 void flecs_merge_column(
     ecs_world_t *world,
@@ -2151,7 +2369,8 @@ void flecs_merge_column(
 {
     int32_t dst_count = dst->count;
 
-    if (!dst_count) {
+    /* Take over the src buffer unless dst has enough storage (reserved) */
+    if (!dst_count && dst->size < src->count) {
         ecs_vec_fini(&world->allocator, dst, size);
         *dst = *src;
         src->array = NULL;
@@ -2220,6 +2439,12 @@ void flecs_merge_table_data(
         return;
     }
 
+    /* Grow destination storage up front so the columns only need to copy */
+    if (dst_count) {
+        flecs_table_ensure_size(world, dst_table, dst_data, 
+            src_count + dst_count);
+    }
+
     /* Merge entities */
     flecs_merge_column(world, &dst_data->entities, &src_data->entities, 
         ECS_SIZEOF(ecs_entity_t), 0, NULL);
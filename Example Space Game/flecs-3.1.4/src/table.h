@@ -153,6 +153,12 @@ void flecs_table_swap(
     int32_t row_1,
     int32_t row_2);
 
+/* Reorder table rows so that row i holds what was in rows[i] */
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *rows);
+
 ecs_table_t *flecs_table_traverse_add(
     ecs_world_t *world,
     ecs_table_t *table,
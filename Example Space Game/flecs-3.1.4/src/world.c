@@ -727,6 +727,7 @@ ecs_world_t *ecs_mini(void) {
     flecs_name_index_init(&world->symbols, &world->allocator);
 
     world->info.time_scale = 1.0;
+    world->table_growth_factor = 2;
 
     if (ecs_os_has_time()) {
         ecs_os_get_time(&world->world_start_time);
@@ -1180,6 +1181,11 @@ int ecs_fini(
 
     world->flags |= EcsWorldQuit;
 
+#ifdef FLECS_JOURNAL
+    /* Don't record the cleanup of the world */
+    ecs_journal_close(world);
+#endif
+
     /* Delete root entities first using regular APIs. This ensures that cleanup
      * policies get a chance to execute. */
     ecs_dbg_1("#[bold]cleanup root entities");
@@ -1232,6 +1238,7 @@ int ecs_fini(
     flecs_observable_fini(&world->observable);
     flecs_name_index_fini(&world->aliases);
     flecs_name_index_fini(&world->symbols);
+    flecs_lookup_cache_fini(world);
     ecs_set_stage_count(world, 0);
     ecs_log_pop_1();
 
@@ -1357,6 +1364,17 @@ bool ecs_enable_range_check(
     return old_value;
 }
 
+void ecs_set_table_growth_factor(
+    ecs_world_t *world,
+    int32_t factor)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(factor >= 2, ECS_INVALID_PARAMETER, NULL);
+    world->table_growth_factor = factor;
+error:
+    return;
+}
+
 void ecs_set_entity_generation(
     ecs_world_t *world,
     ecs_entity_t entity_with_generation)
@@ -1633,6 +1651,10 @@ void ecs_frame_end(
         flecs_stage_merge_post_frame(world, &stages[i]);
     }
 
+#ifdef FLECS_JOURNAL
+    ecs_journal_flush(world);
+#endif
+
     flecs_stop_measure_frame(world);
 error:
     return;
@@ -1925,7 +1947,9 @@ int32_t ecs_delete_empty_tables(
             }
 
             uint16_t gen = ++ table->generation;
-            if (delete_generation && (gen > delete_generation)) {
+            if (delete_generation && (gen > delete_generation) && 
+                !table->reserve_count) 
+            {
                 if (flecs_table_release(world, table)) {
                     delete_count ++;
                 }
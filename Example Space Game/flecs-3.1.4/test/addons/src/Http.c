@@ -1,5 +1,19 @@
 #include <addons.h>
 
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET test_socket_t;
+#define test_sock_close closesocket
+#else
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+typedef int test_socket_t;
+#define test_sock_close close
+#endif
+
 static bool OnRequest(
     const ecs_http_request_t* request, 
     ecs_http_reply_t *reply,
@@ -68,3 +82,441 @@ void Http_stop_start() {
     
     ecs_http_server_fini(srv);
 }
+
+static int32_t request_count = 0;
+
+static bool OnEcho(
+    const ecs_http_request_t* request, 
+    ecs_http_reply_t *reply,
+    void *ctx)
+{
+    request_count ++;
+
+    if (!ecs_os_strcmp(request->path, "missing")) {
+        return false;
+    }
+
+    if (!ecs_os_strcmp(request->path, "large")) {
+        /* Many strbuf chunks, with an owned and a borrowed string */
+        int32_t i;
+        for (i = 0; i < 10000; i ++) {
+            ecs_strbuf_append(&reply->body, "%d,", i);
+        }
+        ecs_strbuf_appendstr_zerocpy(&reply->body, ecs_os_strdup("owned,"));
+        ecs_strbuf_appendstr_zerocpy_const(&reply->body, "borrowed");
+        return true;
+    }
+
+    ecs_strbuf_appendstr(&reply->body, request->path);
+    const char *value = ecs_http_get_param(request, "value");
+    if (value) {
+        ecs_strbuf_appendch(&reply->body, ':');
+        ecs_strbuf_appendstr(&reply->body, value);
+    }
+    if (request->body) {
+        ecs_strbuf_appendch(&reply->body, ':');
+        ecs_strbuf_appendstr(&reply->body, request->body);
+    }
+    return true;
+}
+
+static
+ecs_http_server_t* http_server_new(uint16_t port) {
+    ecs_set_os_api_impl();
+
+    ecs_http_server_t *srv = ecs_http_server_init(&(ecs_http_server_desc_t){
+        .port = port,
+        .callback = OnEcho
+    });
+    test_assert(srv != NULL);
+    test_int(ecs_http_server_start(srv), 0);
+    request_count = 0;
+    return srv;
+}
+
+static
+test_socket_t http_connect(uint16_t port) {
+#ifdef _WIN32
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    /* Server socket is created by the server thread, retry until it listens */
+    int32_t retry;
+    for (retry = 0; retry < 1000; retry ++) {
+        test_socket_t sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (!connect(sock, (struct sockaddr*)&addr, sizeof(addr))) {
+            return sock;
+        }
+        test_sock_close(sock);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+
+    test_assert(false);
+    return 0;
+}
+
+static
+void http_send_str(test_socket_t sock, const char *str) {
+    int len = (int)strlen(str);
+    test_int(send(sock, str, len, 0), len);
+}
+
+/* Returns true if the socket has data (or was closed) */
+static
+bool http_readable(test_socket_t sock) {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(sock, &fds);
+    struct timeval tv = {0, 1000};
+    return select((int)sock + 1, &fds, NULL, NULL, &tv) > 0;
+}
+
+/* Receives a single reply while dequeueing requests */
+static
+char* http_recv_reply(
+    ecs_http_server_t *srv,
+    test_socket_t sock,
+    ecs_strbuf_t *data,
+    int32_t *data_len)
+{
+    int32_t i;
+    for (i = 0; i < 5000; i ++) {
+        char *str = ecs_strbuf_get(data);
+        int32_t len = *data_len;
+        char *end = str ? strstr(str, "\r\n\r\n") : NULL;
+        if (end) {
+            const char *cl = strstr(str, "Content-Length: ");
+            test_assert(cl != NULL);
+            int32_t reply_len = 
+                (int32_t)(end - str) + 4 + atoi(cl + 16);
+            if (len >= reply_len) {
+                /* Keep the data of the next reply */
+                ecs_strbuf_appendstrn(data, str + reply_len, len - reply_len);
+                *data_len = len - reply_len;
+                str[reply_len] = '\0';
+                return str;
+            }
+        }
+        if (str) {
+            ecs_strbuf_appendstrn(data, str, len);
+            ecs_os_free(str);
+        }
+
+        ecs_http_server_dequeue(srv, 0);
+
+        if (http_readable(sock)) {
+            char buf[4096];
+            int r = (int)recv(sock, buf, sizeof(buf) - 1, 0);
+            if (r <= 0) {
+                break;
+            }
+            buf[r] = '\0';
+            ecs_strbuf_appendstrn(data, buf, r);
+            *data_len += r;
+        }
+    }
+    return NULL;
+}
+
+static
+char* http_request(
+    ecs_http_server_t *srv,
+    test_socket_t sock,
+    const char *request)
+{
+    ecs_strbuf_t data = ECS_STRBUF_INIT;
+    int32_t data_len = 0;
+    http_send_str(sock, request);
+    char *reply = http_recv_reply(srv, sock, &data, &data_len);
+    test_int(data_len, 0);
+    ecs_strbuf_reset(&data);
+    return reply;
+}
+
+static
+const char* http_body(const char *reply) {
+    const char *body = strstr(reply, "\r\n\r\n");
+    test_assert(body != NULL);
+    return body + 4;
+}
+
+/* Returns true if the server closed the connection */
+static
+bool http_closed(ecs_http_server_t *srv, test_socket_t sock) {
+    int32_t i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_http_server_dequeue(srv, 0);
+        if (http_readable(sock)) {
+            char buf[16];
+            return recv(sock, buf, sizeof(buf), 0) <= 0;
+        }
+    }
+    return false;
+}
+
+void Http_get() {
+    ecs_http_server_t *srv = http_server_new(27754);
+    test_socket_t sock = http_connect(27754);
+
+    char *reply = http_request(srv, sock, 
+        "GET /hello?value=world HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    test_assert(reply != NULL);
+    test_assert(!strncmp(reply, "HTTP/1.1 200 OK\r\n", 17));
+    test_assert(strstr(reply, "Content-Length: 11\r\n") != NULL);
+    test_assert(strstr(reply, "Connection: close") == NULL);
+    test_str(http_body(reply), "hello:world");
+    ecs_os_free(reply);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_post_body() {
+    ecs_http_server_t *srv = http_server_new(27755);
+    test_socket_t sock = http_connect(27755);
+
+    char *reply = http_request(srv, sock, 
+        "POST /data HTTP/1.1\r\ncontent-length: 5\r\n\r\nhello");
+    test_assert(reply != NULL);
+    test_str(http_body(reply), "data:hello");
+    ecs_os_free(reply);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_not_found() {
+    ecs_http_server_t *srv = http_server_new(27756);
+    test_socket_t sock = http_connect(27756);
+
+    char *reply = http_request(srv, sock, "GET /missing HTTP/1.1\r\n\r\n");
+    test_assert(reply != NULL);
+    test_assert(!strncmp(reply, "HTTP/1.1 404", 12));
+    ecs_os_free(reply);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_keep_alive() {
+    ecs_http_server_t *srv = http_server_new(27757);
+    test_socket_t sock = http_connect(27757);
+
+    int32_t i;
+    for (i = 0; i < 3; i ++) {
+        char *reply = http_request(srv, sock, "GET /again HTTP/1.1\r\n\r\n");
+        test_assert(reply != NULL);
+        test_str(http_body(reply), "again");
+        ecs_os_free(reply);
+    }
+
+    test_int(request_count, 3);
+    test_bool(http_closed(srv, sock), false);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_pipelined() {
+    ecs_http_server_t *srv = http_server_new(27758);
+    test_socket_t sock = http_connect(27758);
+
+    http_send_str(sock, 
+        "GET /first HTTP/1.1\r\n\r\n"
+        "OPTIONS /second HTTP/1.1\r\n\r\n"
+        "GET /third HTTP/1.1\r\n\r\n");
+
+    ecs_strbuf_t data = ECS_STRBUF_INIT;
+    int32_t data_len = 0;
+
+    char *reply = http_recv_reply(srv, sock, &data, &data_len);
+    test_assert(reply != NULL);
+    test_str(http_body(reply), "first");
+    ecs_os_free(reply);
+
+    reply = http_recv_reply(srv, sock, &data, &data_len);
+    test_assert(reply != NULL);
+    test_assert(strstr(reply, "Access-Control-Allow-Methods") != NULL);
+    test_str(http_body(reply), "");
+    ecs_os_free(reply);
+
+    reply = http_recv_reply(srv, sock, &data, &data_len);
+    test_assert(reply != NULL);
+    test_str(http_body(reply), "third");
+    ecs_os_free(reply);
+
+    test_int(data_len, 0);
+    ecs_strbuf_reset(&data);
+    test_int(request_count, 2);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_split_request() {
+    ecs_http_server_t *srv = http_server_new(27759);
+    test_socket_t sock = http_connect(27759);
+
+    http_send_str(sock, "GET /sp");
+    ecs_os_sleep(0, 10 * 1000 * 1000);
+    ecs_http_server_dequeue(srv, 0);
+    http_send_str(sock, "lit?value=1 HTTP/1.1\r\n");
+    ecs_os_sleep(0, 10 * 1000 * 1000);
+    ecs_http_server_dequeue(srv, 0);
+    test_int(request_count, 0);
+
+    char *reply = http_request(srv, sock, "\r\n");
+    test_assert(reply != NULL);
+    test_str(http_body(reply), "split:1");
+    ecs_os_free(reply);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_connection_close() {
+    ecs_http_server_t *srv = http_server_new(27761);
+    test_socket_t sock = http_connect(27761);
+
+    char *reply = http_request(srv, sock, 
+        "GET /bye HTTP/1.1\r\nConnection: close\r\n\r\n");
+    test_assert(reply != NULL);
+    test_assert(strstr(reply, "Connection: close\r\n") != NULL);
+    test_str(http_body(reply), "bye");
+    ecs_os_free(reply);
+
+    test_bool(http_closed(srv, sock), true);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_http_1_0_close() {
+    ecs_http_server_t *srv = http_server_new(27762);
+    test_socket_t sock = http_connect(27762);
+
+    char *reply = http_request(srv, sock, "GET /old HTTP/1.0\r\n\r\n");
+    test_assert(reply != NULL);
+    test_str(http_body(reply), "old");
+    ecs_os_free(reply);
+
+    test_bool(http_closed(srv, sock), true);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_invalid_request() {
+    ecs_http_server_t *srv = http_server_new(27763);
+    test_socket_t sock = http_connect(27763);
+
+    char *reply = http_request(srv, sock, "BREW /coffee HTTP/1.1\r\n\r\n");
+    test_assert(reply != NULL);
+    test_assert(!strncmp(reply, "HTTP/1.1 400", 12));
+    ecs_os_free(reply);
+
+    test_bool(http_closed(srv, sock), true);
+    test_int(request_count, 0);
+
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_large_reply() {
+    ecs_http_server_t *srv = http_server_new(27764);
+    test_socket_t sock = http_connect(27764);
+
+    ecs_strbuf_t expect = ECS_STRBUF_INIT;
+    int32_t i;
+    for (i = 0; i < 10000; i ++) {
+        ecs_strbuf_append(&expect, "%d,", i);
+    }
+    ecs_strbuf_appendlit(&expect, "owned,borrowed");
+    char *expect_str = ecs_strbuf_get(&expect);
+
+    /* Twice, to check the connection is reusable after a multi-chunk send */
+    for (i = 0; i < 2; i ++) {
+        char *reply = http_request(srv, sock, "GET /large HTTP/1.1\r\n\r\n");
+        test_assert(reply != NULL);
+        test_str(http_body(reply), expect_str);
+        ecs_os_free(reply);
+    }
+
+    ecs_os_free(expect_str);
+    test_sock_close(sock);
+    ecs_http_server_fini(srv);
+}
+
+void Http_dequeue_bounded() {
+    ecs_http_server_t *srv = http_server_new(27765);
+
+    int64_t received = ecs_http_request_received_count;
+
+    test_socket_t socks[80];
+    int32_t i;
+    for (i = 0; i < 80; i ++) {
+        socks[i] = http_connect(27765);
+        http_send_str(socks[i], "GET /many HTTP/1.1\r\n\r\n");
+    }
+
+    /* Wait until all requests are waiting for the main thread */
+    for (i = 0; i < 1000; i ++) {
+        if ((ecs_http_request_received_count - received) == 80) {
+            break;
+        }
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    test_int(ecs_http_request_received_count - received, 80);
+
+    /* A single dequeue doesn't handle all requests */
+    ecs_http_server_dequeue(srv, 0);
+    test_assert(request_count > 0);
+    test_assert(request_count < 80);
+
+    for (i = 0; i < 80; i ++) {
+        ecs_strbuf_t data = ECS_STRBUF_INIT;
+        int32_t data_len = 0;
+        char *reply = http_recv_reply(srv, socks[i], &data, &data_len);
+        test_assert(reply != NULL);
+        test_str(http_body(reply), "many");
+        ecs_os_free(reply);
+        ecs_strbuf_reset(&data);
+        test_sock_close(socks[i]);
+    }
+
+    test_int(request_count, 80);
+    ecs_http_server_fini(srv);
+}
+
+void Http_stop_w_open_connections() {
+    ecs_http_server_t *srv = http_server_new(27766);
+    test_socket_t sock_1 = http_connect(27766);
+    test_socket_t sock_2 = http_connect(27766);
+
+    char *reply = http_request(srv, sock_1, "GET /one HTTP/1.1\r\n\r\n");
+    test_assert(reply != NULL);
+    ecs_os_free(reply);
+
+    /* Request that is never dequeued */
+    http_send_str(sock_2, "GET /two HTTP/1.1\r\n\r\n");
+    ecs_os_sleep(0, 10 * 1000 * 1000);
+
+    ecs_http_server_stop(srv);
+    test_int(ecs_http_server_start(srv), 0);
+
+    test_socket_t sock_3 = http_connect(27766);
+    reply = http_request(srv, sock_3, "GET /three HTTP/1.1\r\n\r\n");
+    test_assert(reply != NULL);
+    test_str(http_body(reply), "three");
+    ecs_os_free(reply);
+
+    test_sock_close(sock_1);
+    test_sock_close(sock_2);
+    test_sock_close(sock_3);
+    ecs_http_server_fini(srv);
+}
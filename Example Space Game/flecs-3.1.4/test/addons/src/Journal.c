@@ -0,0 +1,568 @@
+#include <addons.h>
+
+/* The binary journal is part of the journal addon, which is not enabled by
+ * default. When the addon is not built the tests are quarantined, so that they
+ * don't show up as passed. Build flecs with FLECS_JOURNAL to run them. */
+
+#ifndef FLECS_JOURNAL
+#define journal_skip() test_quarantine("FLECS_JOURNAL not defined")
+#endif
+
+#ifdef FLECS_JOURNAL
+
+#define JOURNAL_FILE "journal_test.bin"
+
+static
+ecs_world_t* replay_world(ecs_journal_replay_t *result) {
+    ecs_world_t *world = ecs_init();
+    test_int(ecs_journal_replay(world, JOURNAL_FILE, result), 0);
+    return world;
+}
+
+#endif
+
+void Journal_replay_set() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_new_id(world);
+        ecs_set(world, e, Position, {i, i * 2});
+    }
+
+    ecs_fini(world);
+
+    ecs_journal_replay_t result = {0};
+    world = ecs_init();
+    ecs_id(Position) = 0;
+    ECS_COMPONENT_DEFINE(world, Position);
+    test_int(ecs_journal_replay(world, JOURNAL_FILE, &result), 0);
+    test_assert(result.record_count > 0);
+    test_assert(result.op_count > 0);
+    test_int(result.skip_count, 0);
+
+    ecs_filter_t *f = ecs_filter(world, { .terms = {{ ecs_id(Position) }}});
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    int32_t count = 0;
+    while (ecs_filter_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        for (i = 0; i < it.count; i ++) {
+            test_int(p[i].x, count);
+            test_int(p[i].y, count * 2);
+            count ++;
+        }
+    }
+    test_int(count, 10);
+
+    ecs_filter_fini(f);
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_named() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ecs_entity_t parent = ecs_new_entity(world, "Parent");
+    ecs_entity_t e = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_set_name(world, e, "Child");
+    ecs_set(world, e, Position, {10, 20});
+
+    ecs_fini(world);
+
+    world = replay_world(NULL);
+
+    ecs_entity_t child = ecs_lookup_fullpath(world, "Parent.Child");
+    test_assert(child != 0);
+    test_assert(ecs_has_pair(world, child, EcsChildOf, 
+        ecs_lookup(world, "Parent")));
+
+    /* Component was created from the journal */
+    ecs_entity_t comp = ecs_lookup(world, "Position");
+    test_assert(comp != 0);
+    const EcsComponent *ptr = ecs_get(world, comp, EcsComponent);
+    test_assert(ptr != NULL);
+    test_int(ptr->size, ECS_SIZEOF(Position));
+
+    const Position *p = ecs_get_id(world, child, comp);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_pair() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ecs_entity_t likes = ecs_new_entity(world, "Likes");
+    ecs_entity_t bob = ecs_new_entity(world, "Bob");
+    ecs_entity_t alice = ecs_new_entity(world, "Alice");
+    ecs_add_pair(world, alice, likes, bob);
+    ecs_add_id(world, alice, ECS_OVERRIDE | likes);
+
+    ecs_fini(world);
+
+    world = replay_world(NULL);
+
+    likes = ecs_lookup(world, "Likes");
+    bob = ecs_lookup(world, "Bob");
+    alice = ecs_lookup(world, "Alice");
+    test_assert(likes != 0);
+    test_assert(bob != 0);
+    test_assert(alice != 0);
+    test_assert(ecs_has_pair(world, alice, likes, bob));
+    test_assert(ecs_has_id(world, alice, ECS_OVERRIDE | likes));
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_remove() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ecs_entity_t e = ecs_new_entity(world, "e");
+    ecs_add(world, e, Tag);
+    ecs_set(world, e, Position, {1, 2});
+    ecs_remove(world, e, Position);
+
+    ecs_fini(world);
+
+    world = replay_world(NULL);
+
+    e = ecs_lookup(world, "e");
+    test_assert(e != 0);
+    test_assert(ecs_has_id(world, e, ecs_lookup(world, "Tag")));
+    test_assert(!ecs_has_id(world, e, ecs_lookup(world, "Position")));
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_delete() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_TAG(world, Tag);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ecs_entity_t e1 = ecs_new(world, Tag);
+    ecs_new(world, Tag);
+    ecs_entity_t e3 = ecs_new_entity(world, "e3");
+    ecs_add(world, e3, Tag);
+    ecs_delete(world, e1);
+    ecs_clear(world, e3);
+
+    ecs_fini(world);
+
+    world = replay_world(NULL);
+
+    ecs_entity_t tag = ecs_lookup(world, "Tag");
+    test_assert(tag != 0);
+    test_int(ecs_count_id(world, tag), 1);
+
+    /* Clear also removed the name */
+    test_assert(ecs_lookup(world, "e3") == 0);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_delete_with() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ecs_new(world, TagA);
+    ecs_new(world, TagA);
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+    ecs_new(world, TagB);
+
+    ecs_remove_all(world, TagA);
+    ecs_delete_with(world, TagB);
+
+    ecs_fini(world);
+
+    world = replay_world(NULL);
+
+    ecs_entity_t tag_a = ecs_lookup(world, "TagA");
+    ecs_entity_t tag_b = ecs_lookup(world, "TagB");
+    test_int(ecs_count_id(world, tag_a), 0);
+    test_int(ecs_count_id(world, tag_b), 0);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_deferred() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ecs_entity_t e = ecs_new_entity(world, "e");
+    ecs_set(world, e, Position, {1, 2});
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Velocity, {3, 4});
+    Position *p = ecs_get_mut(world, e, Position);
+    p->x = 5;
+    ecs_modified(world, e, Position);
+    ecs_defer_end(world);
+
+    ecs_fini(world);
+
+    world = replay_world(NULL);
+
+    e = ecs_lookup(world, "e");
+    test_assert(e != 0);
+    const Position *pp = ecs_get_id(world, e, ecs_lookup(world, "Position"));
+    test_assert(pp != NULL);
+    test_int(pp->x, 5);
+    test_int(pp->y, 2);
+    const Velocity *vp = ecs_get_id(world, e, ecs_lookup(world, "Velocity"));
+    test_assert(vp != NULL);
+    test_int(vp->x, 3);
+    test_int(vp->y, 4);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_bulk() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    const ecs_entity_t *ids = ecs_bulk_init(world, &(ecs_bulk_desc_t){
+        .count = 100,
+        .ids = { ecs_id(Position) }
+    });
+
+    /* Batched sets for new entities are merged in place */
+    ecs_defer_begin(world);
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, ids[i], Position, {i, i});
+    }
+    ecs_defer_end(world);
+
+    ecs_fini(world);
+
+    world = replay_world(NULL);
+
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+    test_int(ecs_count_id(world, pos), 100);
+
+    int32_t sum = 0;
+    ecs_iter_t it = ecs_term_iter(world, &(ecs_term_t){ pos });
+    while (ecs_term_next(&it)) {
+        Position *p = ecs_field_w_size(&it, sizeof(Position), 1);
+        for (i = 0; i < it.count; i ++) {
+            test_int(p[i].x, p[i].y);
+            sum += (int32_t)p[i].x;
+        }
+    }
+    test_int(sum, 99 * 100 / 2);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_bulk_w_data() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    Position p[100];
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        p[i].x = i;
+        p[i].y = i * 2;
+    }
+
+    /* The values refer to the entities of the commit */
+    ecs_bulk_init(world, &(ecs_bulk_desc_t){
+        .count = 100,
+        .ids = { ecs_id(Position) },
+        .data = (void*[]){ p }
+    });
+
+    ecs_fini(world);
+
+    ecs_journal_replay_t result = {0};
+    world = replay_world(&result);
+    test_assert(result.record_count < 5);
+    test_int(result.skip_count, 0);
+
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+    test_int(ecs_count_id(world, pos), 100);
+
+    int32_t sum = 0;
+    ecs_iter_t it = ecs_term_iter(world, &(ecs_term_t){ pos });
+    while (ecs_term_next(&it)) {
+        Position *v = ecs_field_w_size(&it, sizeof(Position), 1);
+        for (i = 0; i < it.count; i ++) {
+            test_int(v[i].y, v[i].x * 2);
+            sum += (int32_t)v[i].x;
+        }
+    }
+    test_int(sum, 99 * 100 / 2);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_ring_wrap() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 4096), 0);
+
+    ecs_entity_t e = ecs_new_entity(world, "e");
+    int32_t i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_set(world, e, Position, {i, i});
+    }
+
+    ecs_fini(world);
+
+    /* Only the most recent records fit in the ring. The declarations of the
+     * entity and component were overwritten, so they are re-declared. */
+    ecs_journal_replay_t result = {0};
+    world = replay_world(&result);
+    test_assert(result.record_count > 0);
+    test_assert(result.record_count < 1000);
+
+    e = ecs_lookup(world, "e");
+    test_assert(e != 0);
+    const Position *p = ecs_get_id(world, e, ecs_lookup(world, "Position"));
+    test_assert(p != NULL);
+    test_int(p->x, 999);
+    test_int(p->y, 999);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_invalid_file() {
+#ifdef FLECS_JOURNAL
+    FILE *f = fopen(JOURNAL_FILE, "wb");
+    test_assert(f != NULL);
+    fputs("not a journal", f);
+    fclose(f);
+
+    ecs_world_t *world = ecs_init();
+    ecs_log_set_level(-4);
+    test_assert(ecs_journal_replay(world, JOURNAL_FILE, NULL) != 0);
+    test_assert(ecs_journal_replay(world, "missing_journal.bin", NULL) != 0);
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+#ifdef FLECS_JOURNAL
+static
+void Move(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+#endif
+
+void Journal_replay_system() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ECS_SYSTEM(world, Move, EcsOnUpdate, Position);
+    ecs_entity_t e = ecs_new_entity(world, "e");
+    ecs_set(world, e, Position, {10, 20});
+    ecs_progress(world, 0);
+
+    ecs_fini(world);
+
+    /* The system is replayed as a plain entity */
+    world = replay_world(NULL);
+
+    ecs_entity_t move = ecs_lookup(world, "Move");
+    test_assert(move != 0);
+    test_assert(!ecs_has_id(world, move, EcsSystem));
+
+    ecs_progress(world, 0);
+
+    e = ecs_lookup(world, "e");
+    const Position *p = ecs_get_id(world, e, ecs_lookup(world, "Position"));
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_replay_spawn_burst() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    /* Entities that get the same ids share commit and set records */
+    ecs_entity_t ids[100];
+    int32_t i;
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i ++) {
+        ids[i] = ecs_new_id(world);
+        ecs_set(world, ids[i], Position, {i, i * 2});
+        ecs_set(world, ids[i], Velocity, {i, 1});
+    }
+    ecs_defer_end(world);
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i += 2) {
+        ecs_delete(world, ids[i]);
+    }
+    ecs_defer_end(world);
+
+    ecs_fini(world);
+
+    ecs_journal_replay_t result = {0};
+    world = replay_world(&result);
+    test_assert(result.record_count < 20);
+    test_int(result.skip_count, 0);
+
+    ecs_entity_t pos = ecs_lookup(world, "Position");
+    ecs_entity_t vel = ecs_lookup(world, "Velocity");
+    test_int(ecs_count_id(world, pos), 50);
+    test_int(ecs_count_id(world, vel), 50);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_term_iter(world, &(ecs_term_t){ pos });
+    while (ecs_term_next(&it)) {
+        Position *p = ecs_field_w_size(&it, sizeof(Position), 1);
+        for (i = 0; i < it.count; i ++) {
+            test_int(p[i].y, p[i].x * 2);
+            test_int((int32_t)p[i].x % 2, 1);
+            const Velocity *v = ecs_get_id(world, it.entities[i], vel);
+            test_assert(v != NULL);
+            test_int(v->x, p[i].x);
+            test_int(v->y, 1);
+            count ++;
+        }
+    }
+    test_int(count, 50);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
+
+void Journal_flush() {
+#ifdef FLECS_JOURNAL
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+
+    test_int(ecs_journal_open(world, JOURNAL_FILE, 0), 0);
+
+    ecs_entity_t e = ecs_new_entity(world, "e");
+    ecs_set(world, e, Position, {10, 20});
+
+    /* Records are written to the file when flushed, or at the end of a frame */
+    test_int(ecs_journal_flush(world), 0);
+
+    ecs_world_t *replay = replay_world(NULL);
+    e = ecs_lookup(replay, "e");
+    test_assert(e != 0);
+    const Position *p = ecs_get_id(replay, e, ecs_lookup(replay, "Position"));
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    ecs_fini(replay);
+
+    ecs_set(world, ecs_lookup(world, "e"), Position, {30, 40});
+    ecs_progress(world, 0);
+
+    replay = replay_world(NULL);
+    e = ecs_lookup(replay, "e");
+    p = ecs_get_id(replay, e, ecs_lookup(replay, "Position"));
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    ecs_fini(replay);
+
+    ecs_fini(world);
+    remove(JOURNAL_FILE);
+#else
+    journal_skip();
+#endif
+}
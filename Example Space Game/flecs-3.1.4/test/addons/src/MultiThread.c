@@ -1370,3 +1370,65 @@ void MultiThread_run_single_thread_on_main() {
 
     ecs_fini(world);
 }
+
+static int32_t sync_task_invoked = 0;
+
+static
+void SyncTask(ecs_iter_t *it) {
+    sync_task_invoked ++;
+}
+
+void MultiThread_many_sync_points() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+
+    int i, ENTITIES = 100, THREADS = 4, FRAMES = 50, SYSTEMS = 4;
+
+    /* Alternating between multi threaded and single threaded systems inserts
+     * a sync point after each system */
+    for (i = 0; i < SYSTEMS; i ++) {
+        ecs_system(world, {
+            .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+            .query.filter.terms = {{ ecs_id(Position) }},
+            .multi_threaded = true,
+            .callback = Progress
+        });
+
+        ecs_system(world, {
+            .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+            .multi_threaded = false,
+            .callback = SyncTask
+        });
+    }
+
+    ecs_entity_t *handles = ecs_os_alloca(sizeof(ecs_entity_t) * ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_measure_system_time(world, true);
+
+    for (i = 0; i < FRAMES; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    for (i = 0; i < ENTITIES; i ++) {
+        const Position *p = ecs_get(world, handles[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, SYSTEMS * FRAMES);
+    }
+
+    test_int(sync_task_invoked, SYSTEMS * FRAMES);
+
+    ecs_pipeline_stats_t stats = {0};
+    test_bool(ecs_pipeline_stats_get(world, ecs_get_pipeline(world), &stats), true);
+    test_int(stats.sync_count.counter.value[1], (SYSTEMS * 2 + 1) * FRAMES);
+    test_assert(stats.sync_time.counter.value[1] > 0);
+    test_assert(stats.sync_time.counter.value[1] >= 
+        stats.sync_wait_time.counter.value[1]);
+    ecs_pipeline_stats_fini(&stats);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,335 @@
+#include <addons.h>
+
+static
+ecs_os_api_t alloc_api(void) {
+    ecs_os_set_api_defaults();
+    ecs_os_api_t os_api = ecs_os_api;
+    ecs_os_alloc_set_api(&os_api, false);
+    return os_api;
+}
+
+static
+int64_t live_bytes(void) {
+    ecs_os_alloc_stats_t stats;
+    test_bool(ecs_os_alloc_stats_get(&stats), true);
+    return stats.live_bytes;
+}
+
+void OsAlloc_set_api() {
+    ecs_os_alloc_stats_t stats;
+    test_bool(ecs_os_alloc_stats_get(&stats), false);
+    test_int(stats.live_bytes, 0);
+
+    ecs_os_api_t os_api = alloc_api();
+    test_assert(os_api.malloc_ != ecs_os_api.malloc_);
+    test_assert(os_api.calloc_ != ecs_os_api.calloc_);
+    test_assert(os_api.realloc_ != ecs_os_api.realloc_);
+    test_assert(os_api.free_ != ecs_os_api.free_);
+
+    test_bool(ecs_os_alloc_stats_get(&stats), true);
+    test_int(stats.class_size[0], 16);
+    test_int(stats.class_size[ECS_OS_ALLOC_CLASS_COUNT - 1], 256 * 1024);
+}
+
+void OsAlloc_malloc_free() {
+    ecs_os_api_t os_api = alloc_api();
+    int64_t base = live_bytes();
+
+    void *ptrs[64];
+    int32_t i;
+    for (i = 0; i < 64; i ++) {
+        int32_t size = 1 + i * 97;
+        ptrs[i] = os_api.malloc_(size);
+        test_assert(ptrs[i] != NULL);
+        test_assert(((uintptr_t)ptrs[i] % 16) == 0);
+        ecs_os_memset(ptrs[i], i, size);
+    }
+
+    test_assert(live_bytes() > base);
+
+    for (i = 0; i < 64; i ++) {
+        unsigned char *ptr = ptrs[i];
+        test_int(ptr[0], i);
+        test_int(ptr[i * 97], i);
+        os_api.free_(ptr);
+    }
+
+    test_int(live_bytes(), base);
+}
+
+void OsAlloc_reuse_block() {
+    ecs_os_api_t os_api = alloc_api();
+
+    void *ptr = os_api.malloc_(100);
+    os_api.free_(ptr);
+
+    /* The block is at the front of the thread cache */
+    test_assert(os_api.malloc_(100) == ptr);
+    test_assert(os_api.malloc_(100) != ptr);
+}
+
+void OsAlloc_size_class_stats() {
+    ecs_os_api_t os_api = alloc_api();
+
+    ecs_os_alloc_stats_t before, after;
+    ecs_os_alloc_stats_get(&before);
+
+    void *ptr_1 = os_api.malloc_(20);
+    void *ptr_2 = os_api.malloc_(30);
+    void *ptr_3 = os_api.malloc_(200);
+
+    ecs_os_alloc_stats_get(&after);
+
+    /* 20 and 30 bytes are in the 32 byte class, 200 is in the 224 byte class */
+    test_int(after.class_size[1], 32);
+    test_int(after.class_alloc_count[1] - before.class_alloc_count[1], 2);
+    test_int(after.class_live_count[1] - before.class_live_count[1], 2);
+    test_int(after.class_size[10], 224);
+    test_int(after.class_alloc_count[10] - before.class_alloc_count[10], 1);
+    test_int(after.live_bytes - before.live_bytes, 32 + 32 + 224);
+
+    os_api.free_(ptr_1);
+    os_api.free_(ptr_2);
+    os_api.free_(ptr_3);
+
+    ecs_os_alloc_stats_get(&after);
+    test_int(after.class_alloc_count[1] - before.class_alloc_count[1], 2);
+    test_int(after.class_live_count[1] - before.class_live_count[1], 0);
+    test_int(after.live_bytes, before.live_bytes);
+    test_assert(after.cached_bytes > 0);
+    test_assert(after.peak_bytes >= after.live_bytes + after.cached_bytes);
+}
+
+void OsAlloc_calloc() {
+    ecs_os_api_t os_api = alloc_api();
+
+    unsigned char *ptr = os_api.malloc_(64);
+    ecs_os_memset(ptr, 0xFF, 64);
+    os_api.free_(ptr);
+
+    unsigned char *zero = os_api.calloc_(64);
+    test_assert(zero == ptr);
+
+    int32_t i;
+    for (i = 0; i < 64; i ++) {
+        test_int(zero[i], 0);
+    }
+
+    os_api.free_(zero);
+}
+
+void OsAlloc_realloc() {
+    ecs_os_api_t os_api = alloc_api();
+    int64_t base = live_bytes();
+
+    int32_t *ptr = os_api.realloc_(NULL, 4 * ECS_SIZEOF(int32_t));
+    int32_t i, count = 4;
+    for (i = 0; i < count; i ++) {
+        ptr[i] = i;
+    }
+
+    /* Stays in the same size class */
+    test_assert(os_api.realloc_(ptr, 3 * ECS_SIZEOF(int32_t)) == ptr);
+
+    /* Grow through the size classes into a large allocation */
+    while (count < 256 * 1024) {
+        int32_t new_count = count * 2;
+        ptr = os_api.realloc_(ptr, new_count * ECS_SIZEOF(int32_t));
+        test_assert(ptr != NULL);
+        for (i = 0; i < count; i ++) {
+            test_int(ptr[i], i);
+        }
+        for (; i < new_count; i ++) {
+            ptr[i] = i;
+        }
+        count = new_count;
+    }
+
+    /* And back to a small block */
+    ptr = os_api.realloc_(ptr, 8 * ECS_SIZEOF(int32_t));
+    for (i = 0; i < 8; i ++) {
+        test_int(ptr[i], i);
+    }
+
+    os_api.free_(ptr);
+    test_int(live_bytes(), base);
+}
+
+void OsAlloc_large() {
+    ecs_os_api_t os_api = alloc_api();
+
+    ecs_os_alloc_stats_t before, after;
+    ecs_os_alloc_stats_get(&before);
+
+    int32_t size = 3 * 1024 * 1024;
+    char *ptr = os_api.malloc_(size);
+    test_assert(ptr != NULL);
+    ptr[0] = 1;
+    ptr[size - 1] = 2;
+
+    ecs_os_alloc_stats_get(&after);
+    test_int(after.large_alloc_count - before.large_alloc_count, 1);
+    test_assert(after.large_live_bytes >= size);
+    test_assert(after.reserved_bytes > before.reserved_bytes);
+
+    /* Fits in the existing mapping */
+    test_assert(os_api.realloc_(ptr, size - 1000) == ptr);
+
+    os_api.free_(ptr);
+
+    ecs_os_alloc_stats_get(&after);
+    test_int(after.large_live_bytes, before.large_live_bytes);
+    test_int(after.reserved_bytes, before.reserved_bytes);
+}
+
+void OsAlloc_blocks_across_pages() {
+    ecs_os_api_t os_api = alloc_api();
+    int64_t base = live_bytes();
+
+    /* Chunks of the 64KB class span 17 pages */
+    char *ptrs[40];
+    int32_t i;
+    for (i = 0; i < 40; i ++) {
+        ptrs[i] = os_api.malloc_(60000);
+        test_assert(ptrs[i] != NULL);
+        ptrs[i][59999] = (char)i;
+    }
+
+    /* The class is found from the chunk of the block, so a block stays where
+     * it is if the new size is in the same class */
+    for (i = 0; i < 40; i ++) {
+        test_assert(os_api.realloc_(ptrs[i], 65536) == ptrs[i]);
+        test_int(ptrs[i][59999], i);
+    }
+
+    for (i = 0; i < 40; i ++) {
+        os_api.free_(ptrs[i]);
+    }
+
+    test_int(live_bytes(), base);
+}
+
+void OsAlloc_reserve_per_class() {
+    ecs_os_api_t os_api = alloc_api();
+
+    ecs_os_alloc_stats_t before, after;
+    ecs_os_alloc_stats_get(&before);
+
+    /* Small classes share regions, so a block of each class doesn't reserve
+     * a region per class */
+    void *ptrs[ECS_OS_ALLOC_CLASS_COUNT];
+    int32_t i;
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        ptrs[i] = os_api.malloc_(before.class_size[i]);
+        test_assert(ptrs[i] != NULL);
+    }
+
+    ecs_os_alloc_stats_get(&after);
+    test_assert(after.reserved_bytes - before.reserved_bytes <
+        ECS_OS_ALLOC_CLASS_COUNT * 1024 * 1024);
+
+    for (i = 0; i < ECS_OS_ALLOC_CLASS_COUNT; i ++) {
+        os_api.free_(ptrs[i]);
+    }
+}
+
+void OsAlloc_free_foreign() {
+    ecs_os_api_t os_api = alloc_api();
+    int64_t base = live_bytes();
+
+    /* Memory allocated before the allocator was installed */
+    void *ptr_1 = malloc(100);
+    void *ptr_2 = malloc(100);
+    os_api.free_(ptr_1);
+
+    char *ptr_3 = os_api.realloc_(ptr_2, 1000);
+    test_assert(ptr_3 != NULL);
+    ptr_3[999] = 1;
+    os_api.free_(ptr_3);
+
+    test_int(live_bytes(), base);
+}
+
+#define THREAD_ALLOC_COUNT (1000)
+
+typedef struct alloc_thread_ctx_t {
+    ecs_os_api_t os_api;
+    void **foreign; /* Blocks allocated by the main thread */
+    int32_t foreign_count;
+} alloc_thread_ctx_t;
+
+static
+void* alloc_thread(void *arg) {
+    alloc_thread_ctx_t *ctx = arg;
+    void *ptrs[THREAD_ALLOC_COUNT];
+    int32_t round, i;
+    for (round = 0; round < 10; round ++) {
+        for (i = 0; i < THREAD_ALLOC_COUNT; i ++) {
+            ptrs[i] = ctx->os_api.malloc_(8 + (i % 50) * 8);
+            *(int32_t*)ptrs[i] = i;
+        }
+        for (i = 0; i < THREAD_ALLOC_COUNT; i ++) {
+            test_int(*(int32_t*)ptrs[i], i);
+            ctx->os_api.free_(ptrs[i]);
+        }
+    }
+
+    for (i = 0; i < ctx->foreign_count; i ++) {
+        ctx->os_api.free_(ctx->foreign[i]);
+    }
+
+    return NULL;
+}
+
+void OsAlloc_threads() {
+    ecs_os_api_t os_api = alloc_api();
+    ecs_os_set_api(&os_api);
+    int64_t base = live_bytes();
+
+    alloc_thread_ctx_t ctx[4];
+    ecs_os_thread_t threads[4];
+    void *foreign[4][100];
+    int32_t t, i;
+    for (t = 0; t < 4; t ++) {
+        for (i = 0; i < 100; i ++) {
+            foreign[t][i] = os_api.malloc_(48);
+        }
+        ctx[t].os_api = os_api;
+        ctx[t].foreign = foreign[t];
+        ctx[t].foreign_count = 100;
+        threads[t] = ecs_os_thread_new(alloc_thread, &ctx[t]);
+    }
+
+    for (t = 0; t < 4; t ++) {
+        ecs_os_thread_join(threads[t]);
+    }
+
+    /* Exited threads returned their caches to the central heap */
+    ecs_os_alloc_stats_t stats;
+    ecs_os_alloc_stats_get(&stats);
+    test_int(stats.live_bytes, base);
+    test_int(stats.thread_count, 1);
+}
+
+void OsAlloc_world() {
+    ecs_os_api_t os_api = alloc_api();
+    ecs_os_set_api(&os_api);
+
+    ecs_world_t *world = ecs_init();
+    test_assert(live_bytes() > 0);
+
+    ECS_COMPONENT(world, Position);
+
+    int32_t i;
+    for (i = 0; i < 10000; i ++) {
+        ecs_entity_t e = ecs_new_id(world);
+        ecs_set(world, e, Position, {i, i});
+    }
+
+    ecs_world_stats_t stats = {0};
+    ecs_world_stats_get(world, &stats);
+    test_assert(stats.memory.os_alloc_live_bytes.gauge.avg[stats.t] > 0);
+    test_assert(stats.memory.os_alloc_reserved_bytes.gauge.avg[stats.t] > 0);
+
+    ecs_fini(world);
+}
@@ -4089,3 +4089,495 @@ void Plecs_scope_w_component_after_const_var() {
 
     ecs_fini(world);
 }
+
+#define PLECS_FILE "plecs_test.flecs"
+
+static
+void plecs_write_file(const char *str) {
+    FILE *f = fopen(PLECS_FILE, "w");
+    test_assert(f != NULL);
+    fputs(str, f);
+    fclose(f);
+}
+
+void Plecs_from_file() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    plecs_write_file(
+    HEAD "Parent {"
+    LINE "  Child :- Position{10, 20}"
+    LINE "}");
+
+    test_assert(ecs_plecs_from_file(world, PLECS_FILE) == 0);
+
+    ecs_entity_t child = ecs_lookup_fullpath(world, "Parent.Child");
+    test_assert(child != 0);
+    const Position *p = ecs_get(world, child, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+    remove(PLECS_FILE);
+}
+
+void Plecs_from_file_w_stats() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    const char *expr =
+    HEAD "Parent {"
+    LINE "  Child_1 :- Position{10, 20}"
+    LINE "  Child_2 :- Position{30, 40}"
+    LINE "}";
+    plecs_write_file(expr);
+
+    ecs_plecs_load_t stats = {0};
+    test_assert(ecs_plecs_from_file_w_stats(world, PLECS_FILE, &stats) == 0);
+    test_int(stats.byte_count, ecs_os_strlen(expr));
+    test_int(stats.read_count, 1);
+    test_int(stats.entity_count, 3);
+    test_int(stats.cache_hit_count, 1);
+    test_int(stats.buffer_size, 64 * 1024);
+    test_assert(stats.time_spent > 0);
+
+    ecs_fini(world);
+    remove(PLECS_FILE);
+}
+
+void Plecs_from_file_not_found() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_log_set_level(-4);
+    test_assert(ecs_plecs_from_file(world, "not_a_file.flecs") != 0);
+
+    ecs_fini(world);
+}
+
+void Plecs_from_file_stmts_across_reads() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ECS_TAG(world, Likes);
+
+    /* Write statements that span lines until the file needs multiple reads */
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    int32_t i, count = 4000;
+    ecs_strbuf_appendstr(&buf, "Level {\n");
+    for (i = 0; i < count; i ++) {
+        ecs_strbuf_append(&buf, 
+            "  // entity %d\n"
+            "  @brief \"entity { %d\"\n"
+            "  E%d\n"
+            "    :- Position{\n"
+            "      x: %d,\n"
+            "      y: %d\n"
+            "    },\n"
+            "    Likes\n", i, i, i, i, i * 2);
+    }
+    ecs_strbuf_appendstr(&buf, "}\n");
+    char *expr = ecs_strbuf_get(&buf);
+    test_assert(ecs_os_strlen(expr) > 64 * 1024 * 2);
+    plecs_write_file(expr);
+    ecs_os_free(expr);
+
+    ecs_plecs_load_t stats = {0};
+    test_assert(ecs_plecs_from_file_w_stats(world, PLECS_FILE, &stats) == 0);
+    test_assert(stats.read_count > 2);
+    test_int(stats.buffer_size, 64 * 1024);
+    test_int(stats.entity_count, count + 1);
+
+    for (i = 0; i < count; i ++) {
+        char path[32];
+        ecs_os_sprintf(path, "Level.E%d", i);
+        ecs_entity_t e = ecs_lookup_fullpath(world, path);
+        test_assert(e != 0);
+        test_assert(ecs_has(world, e, Likes));
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+#ifdef FLECS_DOC
+        char brief[32];
+        ecs_os_sprintf(brief, "\"entity { %d\"", i);
+        test_str(ecs_doc_get_brief(world, e), brief);
+#endif
+    }
+
+    ecs_fini(world);
+    remove(PLECS_FILE);
+}
+
+void Plecs_from_file_stmt_larger_than_read() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    /* A value that spans more lines than fit in a read */
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    int32_t i;
+    ecs_strbuf_appendstr(&buf, "Foo :- Position{\n");
+    for (i = 0; i < 10000; i ++) {
+        ecs_strbuf_appendstr(&buf, "  // padding line of a large value\n");
+    }
+    ecs_strbuf_appendstr(&buf, "  x: 10, y: 20\n}\nBar\n");
+    char *expr = ecs_strbuf_get(&buf);
+    plecs_write_file(expr);
+    ecs_os_free(expr);
+
+    ecs_plecs_load_t stats = {0};
+    test_assert(ecs_plecs_from_file_w_stats(world, PLECS_FILE, &stats) == 0);
+    test_assert(stats.buffer_size > 64 * 1024);
+
+    ecs_entity_t foo = ecs_lookup_fullpath(world, "Foo");
+    test_assert(foo != 0);
+    const Position *p = ecs_get(world, foo, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    test_assert(ecs_lookup_fullpath(world, "Bar") != 0);
+
+    ecs_fini(world);
+    remove(PLECS_FILE);
+}
+
+void Plecs_new_entity_in_same_stmt() {
+    ecs_world_t *world = ecs_init();
+
+    const char *expr =
+    HEAD "Likes(Alice, Alice)";
+
+    test_assert(ecs_plecs_from_str(world, NULL, expr) == 0);
+
+    ecs_entity_t likes = ecs_lookup_fullpath(world, "Likes");
+    ecs_entity_t alice = ecs_lookup_fullpath(world, "Alice");
+    test_assert(likes != 0);
+    test_assert(alice != 0);
+    test_assert(ecs_has_pair(world, alice, likes, alice));
+    test_int(ecs_count_id(world, ecs_pair(likes, EcsWildcard)), 1);
+
+    ecs_fini(world);
+}
+
+void Plecs_new_entities_w_path_in_same_stmt() {
+    ecs_world_t *world = ecs_init();
+
+    const char *expr =
+    HEAD "Parent.Foo, Parent.Bar";
+
+    test_assert(ecs_plecs_from_str(world, NULL, expr) == 0);
+
+    ecs_entity_t parent = ecs_lookup_fullpath(world, "Parent");
+    ecs_entity_t foo = ecs_lookup_fullpath(world, "Parent.Foo");
+    ecs_entity_t bar = ecs_lookup_fullpath(world, "Parent.Bar");
+    test_assert(parent != 0);
+    test_assert(foo != 0);
+    test_assert(bar != 0);
+    test_assert(ecs_has_pair(world, foo, EcsChildOf, parent));
+    test_assert(ecs_has_pair(world, bar, EcsChildOf, parent));
+
+    ecs_fini(world);
+}
+
+void Plecs_inherit_w_assign_in_same_stmt() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    const char *expr =
+    HEAD "Base :- Position{10, 20}"
+    LINE "Inst : Base :- Position{y: 30}";
+
+    test_assert(ecs_plecs_from_str(world, NULL, expr) == 0);
+
+    ecs_entity_t base = ecs_lookup_fullpath(world, "Base");
+    ecs_entity_t inst = ecs_lookup_fullpath(world, "Inst");
+    test_assert(base != 0);
+    test_assert(inst != 0);
+    test_assert(ecs_has_pair(world, inst, EcsIsA, base));
+    test_assert(ecs_owns(world, inst, Position));
+
+    const Position *p = ecs_get(world, inst, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 30);
+
+    ecs_fini(world);
+}
+
+void Plecs_cached_identifier_shadowed() {
+    ecs_world_t *world = ecs_init();
+
+    const char *expr =
+    HEAD "Foo"
+    LINE "Parent {"
+    LINE "  Child_1 :- Foo"
+    LINE "  Foo"
+    LINE "  Child_2 :- Foo"
+    LINE "}";
+
+    test_assert(ecs_plecs_from_str(world, NULL, expr) == 0);
+
+    ecs_entity_t foo = ecs_lookup_fullpath(world, "Foo");
+    ecs_entity_t parent_foo = ecs_lookup_fullpath(world, "Parent.Foo");
+    ecs_entity_t child_1 = ecs_lookup_fullpath(world, "Parent.Child_1");
+    ecs_entity_t child_2 = ecs_lookup_fullpath(world, "Parent.Child_2");
+    test_assert(foo != 0);
+    test_assert(parent_foo != 0);
+    test_assert(foo != parent_foo);
+    test_assert(child_1 != 0);
+    test_assert(child_2 != 0);
+
+    test_assert(ecs_has_id(world, child_1, foo));
+    test_assert(!ecs_has_id(world, child_1, parent_foo));
+    test_assert(ecs_has_id(world, child_2, parent_foo));
+    test_assert(!ecs_has_id(world, child_2, foo));
+
+    ecs_fini(world);
+}
+
+void Plecs_cached_identifier_after_using() {
+    ecs_world_t *world = ecs_init();
+
+    const char *expr =
+    HEAD "Foo"
+    LINE "Ns.Foo"
+    LINE "Child_1 :- Foo"
+    LINE "using Ns"
+    LINE "Child_2 :- Foo";
+
+    test_assert(ecs_plecs_from_str(world, NULL, expr) == 0);
+
+    ecs_entity_t foo = ecs_lookup_fullpath(world, "Foo");
+    ecs_entity_t ns_foo = ecs_lookup_fullpath(world, "Ns.Foo");
+    ecs_entity_t child_1 = ecs_lookup_fullpath(world, "Child_1");
+    ecs_entity_t child_2 = ecs_lookup_fullpath(world, "Child_2");
+    test_assert(foo != 0);
+    test_assert(ns_foo != 0);
+    test_assert(child_1 != 0);
+    test_assert(child_2 != 0);
+
+    test_assert(ecs_has_id(world, child_1, foo));
+    test_assert(ecs_has_id(world, child_2, ns_foo));
+    test_assert(!ecs_has_id(world, child_2, foo));
+
+    ecs_fini(world);
+}
+
+void Plecs_bulk_create_same_components() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ECS_TAG(world, Foo);
+
+    plecs_write_file(
+    HEAD "Parent {"
+    LINE "  Child_1 :- Position{10, 20}"
+    LINE "  Child_2 :- Position{30, 40}"
+    LINE "  Child_3 :- Position{50, 60}"
+    LINE "  Child_4 :- Position{70, 80}, Foo"
+    LINE "}");
+
+    ecs_plecs_load_t stats = {0};
+    test_assert(ecs_plecs_from_file_w_stats(world, PLECS_FILE, &stats) == 0);
+    test_int(stats.entity_count, 5);
+    test_int(stats.bulk_count, 3); /* Parent, Child_1..3, Child_4 */
+
+    ecs_entity_t parent = ecs_lookup_fullpath(world, "Parent");
+    test_assert(parent != 0);
+
+    int32_t i;
+    ecs_table_t *table = NULL;
+    for (i = 0; i < 4; i ++) {
+        char path[32];
+        ecs_os_sprintf(path, "Parent.Child_%d", i + 1);
+        ecs_entity_t child = ecs_lookup_fullpath(world, path);
+        test_assert(child != 0);
+        test_assert(ecs_has_pair(world, child, EcsChildOf, parent));
+        test_assert(ecs_has_id(world, child, Foo) == (i == 3));
+        if (i < 3) {
+            if (table) {
+                test_assert(ecs_get_table(world, child) == table);
+            }
+            table = ecs_get_table(world, child);
+        }
+
+        const Position *p = ecs_get(world, child, Position);
+        test_assert(p != NULL);
+        test_int(p->x, 10 + i * 20);
+        test_int(p->y, 20 + i * 20);
+    }
+
+    ecs_fini(world);
+    remove(PLECS_FILE);
+}
+
+void Plecs_bulk_create_entity_in_value() {
+    ecs_world_t *world = ecs_init();
+
+    typedef struct {
+        ecs_entity_t target;
+    } Target;
+
+    ecs_entity_t ecs_id(Target) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Target"}),
+        .members = {
+            {"target", ecs_id(ecs_entity_t)}
+        }
+    });
+
+    const char *expr =
+    HEAD "Parent {"
+    LINE "  Child_1 :- Target{Parent}"
+    LINE "  Child_2 :- Target{Child_1}"
+    LINE "}";
+
+    test_assert(ecs_plecs_from_str(world, NULL, expr) == 0);
+
+    ecs_entity_t parent = ecs_lookup_fullpath(world, "Parent");
+    ecs_entity_t child_1 = ecs_lookup_fullpath(world, "Parent.Child_1");
+    ecs_entity_t child_2 = ecs_lookup_fullpath(world, "Parent.Child_2");
+    test_assert(parent != 0);
+    test_assert(child_1 != 0);
+    test_assert(child_2 != 0);
+    test_assert(ecs_get_table(world, child_1) == ecs_get_table(world, child_2));
+
+    const Target *t = ecs_get(world, child_1, Target);
+    test_assert(t != NULL);
+    test_uint(t->target, parent);
+
+    /* Child_1 is created with Child_2, after its value is parsed */
+    t = ecs_get(world, child_2, Target);
+    test_assert(t != NULL);
+    test_uint(t->target, child_1);
+
+    ecs_fini(world);
+}
+
+void Plecs_bulk_create_redeclare() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ECS_TAG(world, Foo);
+
+    const char *expr =
+    HEAD "Child_1 :- Position{10, 20}"
+    LINE "Child_2 :- Position{30, 40}"
+    LINE "Child_1 :- Foo"
+    LINE "Child_1.Grandchild :- Position{50, 60}";
+
+    test_assert(ecs_plecs_from_str(world, NULL, expr) == 0);
+
+    ecs_entity_t child_1 = ecs_lookup_fullpath(world, "Child_1");
+    ecs_entity_t child_2 = ecs_lookup_fullpath(world, "Child_2");
+    ecs_entity_t grandchild = ecs_lookup_fullpath(world, "Child_1.Grandchild");
+    test_assert(child_1 != 0);
+    test_assert(child_2 != 0);
+    test_assert(grandchild != 0);
+    test_assert(ecs_has_id(world, child_1, Foo));
+    test_assert(!ecs_has_id(world, child_2, Foo));
+    test_assert(ecs_has_pair(world, grandchild, EcsChildOf, child_1));
+
+    const Position *p = ecs_get(world, child_1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get(world, grandchild, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+
+    ecs_fini(world);
+}
+
+static int plecs_on_set_count = 0;
+
+static
+void PlecsOnSetPosition(ecs_iter_t *it) {
+    plecs_on_set_count += it->count;
+}
+
+void Plecs_bulk_create_w_observer() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t ecs_id(Position) = ecs_struct(world, {
+        .entity = ecs_entity(world, {.name = "Position"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = PlecsOnSetPosition
+    });
+
+    plecs_write_file(
+    HEAD "Child_1 :- Position{10, 20}"
+    LINE "Child_2 :- Position{30, 40}");
+
+    ecs_plecs_load_t stats = {0};
+    plecs_on_set_count = 0;
+    test_assert(ecs_plecs_from_file_w_stats(world, PLECS_FILE, &stats) == 0);
+    test_int(stats.bulk_count, 0);
+    test_int(plecs_on_set_count, 2);
+
+    const Position *p = ecs_get(world, ecs_lookup(world, "Child_2"), Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+    remove(PLECS_FILE);
+}
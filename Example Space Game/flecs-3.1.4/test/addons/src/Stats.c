@@ -242,6 +242,39 @@ void Stats_get_pipeline_stats_after_progress_2_systems_one_merge() {
     ecs_fini(world);
 }
 
+void Stats_get_pipeline_stats_sync_points() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    
+    ecs_new(world, Position); // Make sure systems are active
+
+    ECS_SYSTEM(world, FooSys, EcsOnUpdate, [out] Position());
+    ECS_SYSTEM(world, BarSys, EcsOnUpdate, Position);
+
+    ecs_entity_t pipeline = ecs_get_pipeline(world);
+    test_assert(pipeline != 0);
+
+    ecs_progress(world, 0);
+
+    ecs_pipeline_stats_t stats = {0};
+    test_bool(ecs_pipeline_stats_get(world, pipeline, &stats), true);
+    test_int(stats.t, 1);
+    /* One sync point per merge, plus the one at the end of the frame */
+    test_int(stats.sync_count.counter.value[1], 3);
+
+    ecs_progress(world, 0);
+
+    test_bool(ecs_pipeline_stats_get(world, pipeline, &stats), true);
+    test_int(stats.t, 2);
+    test_int(stats.sync_count.counter.value[2], 6);
+    test_int(stats.sync_count.gauge.avg[2], 3);
+
+    ecs_pipeline_stats_fini(&stats);
+
+    ecs_fini(world);
+}
+
 void Stats_get_entity_count() {
     ecs_world_t *world = ecs_init();
 
@@ -294,3 +327,339 @@ void Stats_get_not_alive_entity_count() {
 
     ecs_fini(world);
 }
+
+typedef struct {
+    const uint8_t *ptr;
+    const uint8_t *end;
+} stream_reader_t;
+
+static
+uint64_t stream_uint(stream_reader_t *r) {
+    uint64_t value = 0;
+    int32_t shift = 0;
+    while (r->ptr < r->end) {
+        uint8_t b = *(r->ptr ++);
+        value |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return value;
+}
+
+static
+int64_t stream_int(stream_reader_t *r) {
+    uint64_t value = stream_uint(r);
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* Decodes the stream into values, returns the sequence number of the last
+ * frame. Each decoded frame is checked against the frame in the stream. */
+static
+int64_t stream_decode(
+    const ecs_stats_stream_t *stream,
+    const char *data, 
+    ecs_size_t size,
+    int64_t *values,
+    int32_t *frame_count_out,
+    int64_t *base_out)
+{
+    stream_reader_t r = { (const uint8_t*)data, (const uint8_t*)data + size };
+    test_assert(!ecs_os_memcmp(data, "FLST", 4));
+    r.ptr += 4;
+    test_int(stream_uint(&r), 1);
+    test_int(stream_uint(&r), ECS_STATS_STREAM_METRIC_COUNT);
+    if (stream_uint(&r)) {
+        int32_t i;
+        for (i = 0; i < ECS_STATS_STREAM_METRIC_COUNT; i ++) {
+            ecs_stats_stream_kind_t kind;
+            const char *name = ecs_stats_stream_metric_name(i, &kind);
+            test_int(*(r.ptr ++), kind);
+            uint64_t len = stream_uint(&r);
+            test_int(len, ecs_os_strlen(name));
+            test_assert(!ecs_os_strncmp((const char*)r.ptr, name, (int)len));
+            r.ptr += len;
+        }
+    }
+
+    int64_t first = (int64_t)stream_uint(&r);
+    int64_t frame_count = (int64_t)stream_uint(&r);
+    int64_t base = (int64_t)stream_uint(&r);
+    if (!base) {
+        ecs_os_memset(values, 0, 
+            ECS_SIZEOF(int64_t) * ECS_STATS_STREAM_METRIC_COUNT);
+    }
+
+    int64_t seq;
+    for (seq = first; seq < (first + frame_count); seq ++) {
+        uint64_t i, changed = stream_uint(&r);
+        int64_t index = -1;
+        for (i = 0; i < changed; i ++) {
+            index += (int64_t)stream_uint(&r) + 1;
+            test_assert(index < ECS_STATS_STREAM_METRIC_COUNT);
+            values[index] += stream_int(&r);
+        }
+
+        const int64_t *expect = &stream->samples[
+            (seq % stream->capacity) * ECS_STATS_STREAM_METRIC_COUNT];
+        test_assert(!ecs_os_memcmp(values, expect, 
+            ECS_SIZEOF(int64_t) * ECS_STATS_STREAM_METRIC_COUNT));
+    }
+
+    test_assert(r.ptr == r.end);
+
+    *frame_count_out = (int32_t)frame_count;
+    *base_out = base;
+    return frame_count ? first + frame_count - 1 : 0;
+}
+
+void Stats_stream_metric_names() {
+    int32_t i;
+    for (i = 0; i < ECS_STATS_STREAM_METRIC_COUNT; i ++) {
+        test_assert(ecs_stats_stream_metric_name(i, NULL) != NULL);
+    }
+
+    ecs_stats_stream_kind_t kind;
+    test_str(ecs_stats_stream_metric_name(0, &kind), "frame.frame_count");
+    test_int(kind, EcsStatsStreamCounter);
+    test_str(ecs_stats_stream_metric_name(14, &kind), "entities.count");
+    test_int(kind, EcsStatsStreamGauge);
+    test_assert(ecs_stats_stream_metric_name(-1, NULL) == NULL);
+    test_assert(ecs_stats_stream_metric_name(
+        ECS_STATS_STREAM_METRIC_COUNT, NULL) == NULL);
+}
+
+void Stats_stream_sample() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_stats_stream_t stream;
+    ecs_stats_stream_init(&stream, 0);
+    test_int(stream.capacity, ECS_STATS_STREAM_DEFAULT_CAPACITY);
+    test_int(stream.seq, 0);
+
+    ecs_stats_stream_sample(world, &stream);
+    test_int(stream.seq, 1);
+    int64_t entity_count = stream.samples[
+        1 * ECS_STATS_STREAM_METRIC_COUNT + 14];
+    test_assert(entity_count > 0);
+
+    ecs_new_id(world);
+    ecs_progress(world, 0);
+    ecs_stats_stream_sample(world, &stream);
+    test_int(stream.seq, 2);
+
+    const int64_t *v = &stream.samples[2 * ECS_STATS_STREAM_METRIC_COUNT];
+    test_int(v[0], 1); /* frame.frame_count */
+    test_int(v[14], entity_count + 1); /* entities.count */
+
+    ecs_stats_stream_fini(&stream);
+    test_assert(stream.samples == NULL);
+
+    ecs_fini(world);
+}
+
+static
+int32_t stream_metric_index(
+    const char *name)
+{
+    int32_t i;
+    for (i = 0; i < ECS_STATS_STREAM_METRIC_COUNT; i ++) {
+        if (!ecs_os_strcmp(ecs_stats_stream_metric_name(i, NULL), name)) {
+            return i;
+        }
+    }
+    test_assert(false);
+    return -1;
+}
+
+void Stats_stream_sample_pipeline() {
+    ecs_world_t *world = ecs_init();
+
+    int32_t system_count = stream_metric_index("pipeline.system_count");
+    int32_t active_count = stream_metric_index("pipeline.active_system_count");
+    int32_t rebuild_count = stream_metric_index("pipeline.rebuild_count");
+    int32_t sync_count = stream_metric_index("pipeline.sync_count");
+
+    ecs_stats_stream_t stream;
+    ecs_stats_stream_init(&stream, 0);
+
+    ecs_progress(world, 0);
+    ecs_stats_stream_sample(world, &stream);
+    const int64_t *v1 = &stream.samples[1 * ECS_STATS_STREAM_METRIC_COUNT];
+    test_assert(v1[sync_count] > 0);
+
+    ECS_TAG(world, Tag);
+    ECS_SYSTEM(world, FooSys, EcsOnUpdate, Tag);
+    ECS_SYSTEM(world, BarSys, EcsOnUpdate, 0);
+
+    ecs_progress(world, 0);
+    ecs_stats_stream_sample(world, &stream);
+    const int64_t *v2 = &stream.samples[2 * ECS_STATS_STREAM_METRIC_COUNT];
+    test_int(v2[system_count], v1[system_count] + 2);
+    test_int(v2[active_count], v1[active_count] + 1);
+    test_int(v2[rebuild_count], v1[rebuild_count] + 1);
+    test_assert(v2[sync_count] > v1[sync_count]);
+
+    ecs_new(world, Tag);
+    ecs_progress(world, 0);
+    ecs_stats_stream_sample(world, &stream);
+    const int64_t *v3 = &stream.samples[3 * ECS_STATS_STREAM_METRIC_COUNT];
+    test_int(v3[system_count], v1[system_count] + 2);
+    test_int(v3[active_count], v1[active_count] + 2);
+    test_int(v3[rebuild_count], v1[rebuild_count] + 2);
+
+    ecs_stats_stream_fini(&stream);
+
+    ecs_fini(world);
+}
+
+void Stats_stream_encode_empty() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_stats_stream_t stream;
+    ecs_stats_stream_init(&stream, 4);
+
+    int64_t values[ECS_STATS_STREAM_METRIC_COUNT];
+    int32_t frame_count;
+    int64_t base;
+    ecs_size_t size;
+    char *data = ecs_stats_stream_encode(&stream, 0, false, &size);
+    test_int(stream_decode(&stream, data, size, values, &frame_count, &base), 0);
+    test_int(frame_count, 0);
+    test_int(base, 0);
+    ecs_os_free(data);
+
+    ecs_stats_stream_fini(&stream);
+    ecs_fini(world);
+}
+
+void Stats_stream_encode_all() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_stats_stream_t stream;
+    ecs_stats_stream_init(&stream, 8);
+
+    int32_t i;
+    for (i = 0; i < 3; i ++) {
+        ecs_new_id(world);
+        ecs_progress(world, 0);
+        ecs_stats_stream_sample(world, &stream);
+    }
+
+    int64_t values[ECS_STATS_STREAM_METRIC_COUNT];
+    int32_t frame_count;
+    int64_t base;
+    ecs_size_t size;
+    char *data = ecs_stats_stream_encode(&stream, 0, true, &size);
+    test_int(stream_decode(&stream, data, size, values, &frame_count, &base), 3);
+    test_int(frame_count, 3);
+    test_int(base, 0);
+    ecs_os_free(data);
+
+    ecs_stats_stream_fini(&stream);
+    ecs_fini(world);
+}
+
+void Stats_stream_encode_since() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_stats_stream_t stream;
+    ecs_stats_stream_init(&stream, 8);
+
+    int64_t values[ECS_STATS_STREAM_METRIC_COUNT];
+    int32_t frame_count;
+    int64_t base, seq = 0;
+    ecs_size_t size;
+    char *data;
+
+    int32_t i;
+    for (i = 0; i < 5; i ++) {
+        ecs_new_id(world);
+        ecs_progress(world, 0);
+        ecs_stats_stream_sample(world, &stream);
+        ecs_stats_stream_sample(world, &stream);
+
+        data = ecs_stats_stream_encode(&stream, seq, false, &size);
+        int64_t prev = seq;
+        seq = stream_decode(&stream, data, size, values, &frame_count, &base);
+        test_int(seq, (i + 1) * 2);
+        test_int(frame_count, 2);
+        test_int(base, prev);
+        ecs_os_free(data);
+    }
+
+    /* Nothing new */
+    data = ecs_stats_stream_encode(&stream, seq, false, &size);
+    test_int(stream_decode(&stream, data, size, values, &frame_count, &base), 0);
+    test_int(frame_count, 0);
+    ecs_os_free(data);
+
+    ecs_stats_stream_fini(&stream);
+    ecs_fini(world);
+}
+
+void Stats_stream_encode_only_changed() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_stats_stream_t stream;
+    ecs_stats_stream_init(&stream, 8);
+    ecs_stats_stream_sample(world, &stream);
+    ecs_stats_stream_sample(world, &stream);
+
+    ecs_size_t size;
+    char *data = ecs_stats_stream_encode(&stream, 1, false, &size);
+
+    /* Magic, version, count, names, first, frame count, base, changed */
+    test_int(size, 4 + 1 + 1 + 1 + 1 + 1 + 1 + 1);
+    test_int(data[size - 1], 0);
+    ecs_os_free(data);
+
+    ecs_stats_stream_fini(&stream);
+    ecs_fini(world);
+}
+
+void Stats_stream_encode_since_overwritten() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_stats_stream_t stream;
+    ecs_stats_stream_init(&stream, 4);
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        ecs_new_id(world);
+        ecs_progress(world, 0);
+        ecs_stats_stream_sample(world, &stream);
+    }
+
+    int64_t values[ECS_STATS_STREAM_METRIC_COUNT];
+    int32_t frame_count;
+    int64_t base;
+    ecs_size_t size;
+
+    /* Frame 2 is no longer in the stream, send everything from frame 7 */
+    char *data = ecs_stats_stream_encode(&stream, 2, false, &size);
+    test_int(stream_decode(&stream, data, size, values, &frame_count, &base), 10);
+    test_int(frame_count, 4);
+    test_int(base, 0);
+    ecs_os_free(data);
+
+    /* Oldest frame can still be used as base */
+    ecs_os_memcpy(values, &stream.samples[(7 % 4) * ECS_STATS_STREAM_METRIC_COUNT],
+        ECS_SIZEOF(int64_t) * ECS_STATS_STREAM_METRIC_COUNT);
+    data = ecs_stats_stream_encode(&stream, 7, false, &size);
+    test_int(stream_decode(&stream, data, size, values, &frame_count, &base), 10);
+    test_int(frame_count, 3);
+    test_int(base, 7);
+    ecs_os_free(data);
+
+    /* Client is ahead of the stream */
+    data = ecs_stats_stream_encode(&stream, 20, false, &size);
+    test_int(stream_decode(&stream, data, size, values, &frame_count, &base), 10);
+    test_int(frame_count, 4);
+    test_int(base, 0);
+    ecs_os_free(data);
+
+    ecs_stats_stream_fini(&stream);
+    ecs_fini(world);
+}
@@ -338,6 +338,20 @@ void Plecs_const_var_struct(void);
 void Plecs_const_var_redeclare(void);
 void Plecs_const_var_scoped(void);
 void Plecs_scope_w_component_after_const_var(void);
+void Plecs_from_file(void);
+void Plecs_from_file_w_stats(void);
+void Plecs_from_file_not_found(void);
+void Plecs_from_file_stmts_across_reads(void);
+void Plecs_from_file_stmt_larger_than_read(void);
+void Plecs_new_entity_in_same_stmt(void);
+void Plecs_new_entities_w_path_in_same_stmt(void);
+void Plecs_inherit_w_assign_in_same_stmt(void);
+void Plecs_cached_identifier_shadowed(void);
+void Plecs_cached_identifier_after_using(void);
+void Plecs_bulk_create_same_components(void);
+void Plecs_bulk_create_entity_in_value(void);
+void Plecs_bulk_create_redeclare(void);
+void Plecs_bulk_create_w_observer(void);
 
 // Testsuite 'Doc'
 void Doc_get_set_name(void);
@@ -816,6 +830,15 @@ void Stats_get_pipeline_stats_after_progress_2_systems(void);
 void Stats_get_pipeline_stats_after_progress_2_systems_one_merge(void);
 void Stats_get_entity_count(void);
 void Stats_get_not_alive_entity_count(void);
+void Stats_get_pipeline_stats_sync_points(void);
+void Stats_stream_metric_names(void);
+void Stats_stream_sample(void);
+void Stats_stream_sample_pipeline(void);
+void Stats_stream_encode_empty(void);
+void Stats_stream_encode_all(void);
+void Stats_stream_encode_since(void);
+void Stats_stream_encode_only_changed(void);
+void Stats_stream_encode_since_overwritten(void);
 
 // Testsuite 'Run'
 void Run_setup(void);
@@ -893,6 +916,7 @@ void MultiThread_bulk_new_in_no_readonly_w_multithread(void);
 void MultiThread_bulk_new_in_no_readonly_w_multithread_2(void);
 void MultiThread_run_first_worker_on_main(void);
 void MultiThread_run_single_thread_on_main(void);
+void MultiThread_many_sync_points(void);
 
 // Testsuite 'MultiThreadStaging'
 void MultiThreadStaging_setup(void);
@@ -974,10 +998,52 @@ void Http_teardown(void);
 void Http_teardown_started(void);
 void Http_teardown_stopped(void);
 void Http_stop_start(void);
+void Http_get(void);
+void Http_post_body(void);
+void Http_not_found(void);
+void Http_keep_alive(void);
+void Http_pipelined(void);
+void Http_split_request(void);
+void Http_connection_close(void);
+void Http_http_1_0_close(void);
+void Http_invalid_request(void);
+void Http_large_reply(void);
+void Http_dequeue_bounded(void);
+void Http_stop_w_open_connections(void);
 
 // Testsuite 'Rest'
 void Rest_teardown(void);
 
+// Testsuite 'OsAlloc'
+void OsAlloc_set_api(void);
+void OsAlloc_malloc_free(void);
+void OsAlloc_reuse_block(void);
+void OsAlloc_size_class_stats(void);
+void OsAlloc_calloc(void);
+void OsAlloc_realloc(void);
+void OsAlloc_large(void);
+void OsAlloc_blocks_across_pages(void);
+void OsAlloc_reserve_per_class(void);
+void OsAlloc_free_foreign(void);
+void OsAlloc_threads(void);
+void OsAlloc_world(void);
+
+// Testsuite 'Journal'
+void Journal_replay_set(void);
+void Journal_replay_named(void);
+void Journal_replay_pair(void);
+void Journal_replay_remove(void);
+void Journal_replay_delete(void);
+void Journal_replay_delete_with(void);
+void Journal_replay_deferred(void);
+void Journal_replay_bulk(void);
+void Journal_replay_bulk_w_data(void);
+void Journal_ring_wrap(void);
+void Journal_replay_invalid_file(void);
+void Journal_replay_system(void);
+void Journal_replay_spawn_burst(void);
+void Journal_flush(void);
+
 bake_test_case Parser_testcases[] = {
     {
         "resolve_this",
@@ -2289,6 +2355,62 @@ bake_test_case Plecs_testcases[] = {
     {
         "scope_w_component_after_const_var",
         Plecs_scope_w_component_after_const_var
+    },
+    {
+        "from_file",
+        Plecs_from_file
+    },
+    {
+        "from_file_w_stats",
+        Plecs_from_file_w_stats
+    },
+    {
+        "from_file_not_found",
+        Plecs_from_file_not_found
+    },
+    {
+        "from_file_stmts_across_reads",
+        Plecs_from_file_stmts_across_reads
+    },
+    {
+        "from_file_stmt_larger_than_read",
+        Plecs_from_file_stmt_larger_than_read
+    },
+    {
+        "new_entity_in_same_stmt",
+        Plecs_new_entity_in_same_stmt
+    },
+    {
+        "new_entities_w_path_in_same_stmt",
+        Plecs_new_entities_w_path_in_same_stmt
+    },
+    {
+        "inherit_w_assign_in_same_stmt",
+        Plecs_inherit_w_assign_in_same_stmt
+    },
+    {
+        "cached_identifier_shadowed",
+        Plecs_cached_identifier_shadowed
+    },
+    {
+        "cached_identifier_after_using",
+        Plecs_cached_identifier_after_using
+    },
+    {
+        "bulk_create_same_components",
+        Plecs_bulk_create_same_components
+    },
+    {
+        "bulk_create_entity_in_value",
+        Plecs_bulk_create_entity_in_value
+    },
+    {
+        "bulk_create_redeclare",
+        Plecs_bulk_create_redeclare
+    },
+    {
+        "bulk_create_w_observer",
+        Plecs_bulk_create_w_observer
     }
 };
 
@@ -4118,6 +4240,42 @@ bake_test_case Stats_testcases[] = {
     {
         "get_not_alive_entity_count",
         Stats_get_not_alive_entity_count
+    },
+    {
+        "get_pipeline_stats_sync_points",
+        Stats_get_pipeline_stats_sync_points
+    },
+    {
+        "stream_metric_names",
+        Stats_stream_metric_names
+    },
+    {
+        "stream_sample",
+        Stats_stream_sample
+    },
+    {
+        "stream_sample_pipeline",
+        Stats_stream_sample_pipeline
+    },
+    {
+        "stream_encode_empty",
+        Stats_stream_encode_empty
+    },
+    {
+        "stream_encode_all",
+        Stats_stream_encode_all
+    },
+    {
+        "stream_encode_since",
+        Stats_stream_encode_since
+    },
+    {
+        "stream_encode_only_changed",
+        Stats_stream_encode_only_changed
+    },
+    {
+        "stream_encode_since_overwritten",
+        Stats_stream_encode_since_overwritten
     }
 };
 
@@ -4408,6 +4566,10 @@ bake_test_case MultiThread_testcases[] = {
     {
         "run_single_thread_on_main",
         MultiThread_run_single_thread_on_main
+    },
+    {
+        "many_sync_points",
+        MultiThread_many_sync_points
     }
 };
 
@@ -4699,6 +4861,54 @@ bake_test_case Http_testcases[] = {
     {
         "stop_start",
         Http_stop_start
+    },
+    {
+        "get",
+        Http_get
+    },
+    {
+        "post_body",
+        Http_post_body
+    },
+    {
+        "not_found",
+        Http_not_found
+    },
+    {
+        "keep_alive",
+        Http_keep_alive
+    },
+    {
+        "pipelined",
+        Http_pipelined
+    },
+    {
+        "split_request",
+        Http_split_request
+    },
+    {
+        "connection_close",
+        Http_connection_close
+    },
+    {
+        "http_1_0_close",
+        Http_http_1_0_close
+    },
+    {
+        "invalid_request",
+        Http_invalid_request
+    },
+    {
+        "large_reply",
+        Http_large_reply
+    },
+    {
+        "dequeue_bounded",
+        Http_dequeue_bounded
+    },
+    {
+        "stop_w_open_connections",
+        Http_stop_w_open_connections
     }
 };
 
@@ -4709,6 +4919,116 @@ bake_test_case Rest_testcases[] = {
     }
 };
 
+bake_test_case OsAlloc_testcases[] = {
+    {
+        "set_api",
+        OsAlloc_set_api
+    },
+    {
+        "malloc_free",
+        OsAlloc_malloc_free
+    },
+    {
+        "reuse_block",
+        OsAlloc_reuse_block
+    },
+    {
+        "size_class_stats",
+        OsAlloc_size_class_stats
+    },
+    {
+        "calloc",
+        OsAlloc_calloc
+    },
+    {
+        "realloc",
+        OsAlloc_realloc
+    },
+    {
+        "large",
+        OsAlloc_large
+    },
+    {
+        "blocks_across_pages",
+        OsAlloc_blocks_across_pages
+    },
+    {
+        "reserve_per_class",
+        OsAlloc_reserve_per_class
+    },
+    {
+        "free_foreign",
+        OsAlloc_free_foreign
+    },
+    {
+        "threads",
+        OsAlloc_threads
+    },
+    {
+        "world",
+        OsAlloc_world
+    }
+};
+
+bake_test_case Journal_testcases[] = {
+    {
+        "replay_set",
+        Journal_replay_set
+    },
+    {
+        "replay_named",
+        Journal_replay_named
+    },
+    {
+        "replay_pair",
+        Journal_replay_pair
+    },
+    {
+        "replay_remove",
+        Journal_replay_remove
+    },
+    {
+        "replay_delete",
+        Journal_replay_delete
+    },
+    {
+        "replay_delete_with",
+        Journal_replay_delete_with
+    },
+    {
+        "replay_deferred",
+        Journal_replay_deferred
+    },
+    {
+        "replay_bulk",
+        Journal_replay_bulk
+    },
+    {
+        "replay_bulk_w_data",
+        Journal_replay_bulk_w_data
+    },
+    {
+        "ring_wrap",
+        Journal_ring_wrap
+    },
+    {
+        "replay_invalid_file",
+        Journal_replay_invalid_file
+    },
+    {
+        "replay_system",
+        Journal_replay_system
+    },
+    {
+        "replay_spawn_burst",
+        Journal_replay_spawn_burst
+    },
+    {
+        "flush",
+        Journal_flush
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "Parser",
@@ -4721,7 +5041,7 @@ static bake_test_suite suites[] = {
         "Plecs",
         NULL,
         NULL,
-        147,
+        161,
         Plecs_testcases
     },
     {
@@ -4826,7 +5146,7 @@ static bake_test_suite suites[] = {
         "Stats",
         NULL,
         NULL,
-        10,
+        19,
         Stats_testcases
     },
     {
@@ -4840,7 +5160,7 @@ static bake_test_suite suites[] = {
         "MultiThread",
         MultiThread_setup,
         NULL,
-        50,
+        51,
         MultiThread_testcases
     },
     {
@@ -4875,7 +5195,7 @@ static bake_test_suite suites[] = {
         "Http",
         NULL,
         NULL,
-        4,
+        16,
         Http_testcases
     },
     {
@@ -4884,9 +5204,23 @@ static bake_test_suite suites[] = {
         NULL,
         1,
         Rest_testcases
+    },
+    {
+        "OsAlloc",
+        NULL,
+        NULL,
+        12,
+        OsAlloc_testcases
+    },
+    {
+        "Journal",
+        NULL,
+        NULL,
+        14,
+        Journal_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("addons", argc, argv, suites, 25);
+    return bake_test_run("addons", argc, argv, suites, 27);
 }
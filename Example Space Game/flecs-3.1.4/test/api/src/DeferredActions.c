@@ -3253,3 +3253,246 @@ void DeferredActions_absent_get_mut_for_entity_w_tag() {
 
     ecs_fini(world);
 }
+
+void DeferredActions_defer_new_add_set_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_COMPONENT(world, Position);
+
+    Probe ctx = {0};
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ .id = TagA }},
+        .events = {EcsOnAdd},
+        .callback = System,
+        .ctx = &ctx
+    });
+
+    int32_t discarded = ecs_get_world_info(world)->cmd.discard_count;
+
+    ecs_defer_begin(world);
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add(world, e, TagA);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_delete(world, e);
+    ecs_defer_end(world);
+
+    /* Commands for an entity deleted in the same batch are never applied */
+    test_assert(!ecs_is_alive(world, e));
+    test_int(ctx.invoked, 0);
+    test_int(ecs_get_world_info(world)->cmd.discard_count - discarded, 2);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_existing_set_remove_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_set(world, e, Position, {10, 20});
+
+    Probe ctx = {0};
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ .id = ecs_id(Position) }},
+        .events = {EcsOnRemove},
+        .callback = System,
+        .ctx = &ctx
+    });
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {30, 40});
+    ecs_remove(world, e, TagA);
+    ecs_delete(world, e);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_is_alive(world, e));
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_uint(ctx.e[0], e);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_new_get_mut_modified_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_defer_begin(world);
+    ecs_entity_t e = ecs_new_id(world);
+    Position *p = ecs_get_mut(world, e, Position);
+    p->x = 10;
+    p->y = 20;
+    ecs_modified(world, e, Position);
+    ecs_delete(world, e);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_is_alive(world, e));
+
+    ecs_fini(world);
+}
+
+static int32_t set_delete_on_set = 0;
+static Position set_delete_on_remove = {0, 0};
+
+static
+void SetDeleteOnSet(ecs_iter_t *it) {
+    set_delete_on_set += it->count;
+}
+
+static
+void SetDeleteOnRemove(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    set_delete_on_remove = p[0];
+}
+
+void DeferredActions_defer_existing_set_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_OBSERVER(world, SetDeleteOnSet, EcsOnSet, Position);
+    ECS_OBSERVER(world, SetDeleteOnRemove, EcsOnRemove, Position);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    test_int(set_delete_on_set, 1);
+
+    int32_t discarded = ecs_get_world_info(world)->cmd.discard_count;
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {30, 40});
+    ecs_delete(world, e);
+    ecs_defer_end(world);
+
+    /* The entity existed before the batch, so the set is still applied */
+    test_assert(!ecs_is_alive(world, e));
+    test_int(set_delete_on_set, 2);
+    test_int(set_delete_on_remove.x, 30);
+    test_int(set_delete_on_remove.y, 40);
+    test_int(ecs_get_world_info(world)->cmd.discard_count - discarded, 0);
+
+    ecs_fini(world);
+}
+
+static int32_t set_twice_on_set = 0;
+
+static
+void SetTwiceOnSet(ecs_iter_t *it) {
+    set_twice_on_set += it->count;
+}
+
+void DeferredActions_defer_set_twice_collapse() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+    ECS_OBSERVER(world, SetTwiceOnSet, EcsOnSet, Position);
+
+    ecs_entity_t e = ecs_new(world, Tag);
+    int32_t discarded = ecs_get_world_info(world)->cmd.discard_count;
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Position, {30, 40});
+    ecs_defer_end(world);
+
+    /* Only the last value is applied */
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    test_int(set_twice_on_set, 1);
+    test_int(ecs_get_world_info(world)->cmd.discard_count - discarded, 1);
+
+    ecs_fini(world);
+}
+
+static int32_t add_remove_invoked = 0;
+
+static
+void AddRemoveOnAdd(ecs_iter_t *it) {
+    add_remove_invoked += it->count;
+}
+
+static
+void AddRemoveOnRemove(ecs_iter_t *it) {
+    add_remove_invoked += it->count;
+}
+
+void DeferredActions_defer_add_remove_collapse() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_OBSERVER(world, AddRemoveOnAdd, EcsOnAdd, TagA);
+    ECS_OBSERVER(world, AddRemoveOnRemove, EcsOnRemove, TagA);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_table_t *table = ecs_get_table(world, e);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, TagA);
+    ecs_remove(world, e, TagA);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e, TagA));
+    test_assert(ecs_get_table(world, e) == table);
+    test_int(add_remove_invoked, 0);
+
+    ecs_fini(world);
+}
+
+static int32_t delete_run_removed = 0;
+static float delete_run_x = 0;
+
+static
+void DeleteRunOnRemove(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        delete_run_x += p[i].x;
+    }
+    delete_run_removed += it->count;
+}
+
+void DeferredActions_defer_delete_run() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_OBSERVER(world, DeleteRunOnRemove, EcsOnRemove, Position);
+
+    ecs_entity_t e[6];
+    int32_t i;
+    for (i = 0; i < 6; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i + 1, 0});
+    }
+    ecs_set(world, e[4], Velocity, {1, 1});
+    ecs_set(world, e[5], Velocity, {1, 1});
+
+    ecs_defer_begin(world);
+    ecs_delete(world, e[0]);
+    ecs_delete(world, e[4]);
+    ecs_delete(world, e[2]);
+    ecs_delete(world, e[5]);
+    ecs_defer_end(world);
+
+    test_int(delete_run_removed, 4);
+    test_int(delete_run_x, 1 + 5 + 3 + 6);
+    test_assert(!ecs_is_alive(world, e[0]));
+    test_assert(!ecs_is_alive(world, e[2]));
+    test_assert(!ecs_is_alive(world, e[4]));
+    test_assert(!ecs_is_alive(world, e[5]));
+
+    /* Entities that weren't deleted keep their values */
+    test_assert(ecs_is_alive(world, e[1]));
+    test_assert(ecs_is_alive(world, e[3]));
+    test_int(ecs_get(world, e[1], Position)->x, 2);
+    test_int(ecs_get(world, e[3], Position)->x, 4);
+    test_int(ecs_count(world, Position), 2);
+    test_int(ecs_count(world, Velocity), 0);
+
+    ecs_fini(world);
+}
@@ -641,3 +641,239 @@ void Lookup_lookup_core_entity_from_wrong_scope() {
 
     ecs_fini(world);
 }
+
+void Lookup_cache_lookup_path() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t parent = ecs_new_entity(world, "parent");
+    ecs_entity_t child = ecs_new_entity(world, "parent.child");
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t hits = info->lookup_cache_hit_total;
+    int64_t misses = info->lookup_cache_miss_total;
+
+    test_uint(child, ecs_lookup_fullpath(world, "parent.child"));
+    test_int(info->lookup_cache_hit_total, hits);
+    test_int(info->lookup_cache_miss_total, misses + 1);
+
+    test_uint(child, ecs_lookup_fullpath(world, "parent.child"));
+    test_uint(child, ecs_lookup_path(world, parent, "child"));
+    test_uint(child, ecs_lookup_path(world, parent, "child"));
+    test_int(info->lookup_cache_hit_total, hits + 2);
+    test_int(info->lookup_cache_miss_total, misses + 2);
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_lookup_w_sep() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t child = ecs_new_entity(world, "parent.child");
+
+    test_uint(child, ecs_lookup_path_w_sep(
+        world, 0, "parent::child", "::", "::", true));
+    test_uint(0, ecs_lookup_path_w_sep(
+        world, 0, "parent::child", ".", NULL, true));
+    test_uint(child, ecs_lookup_path_w_sep(
+        world, 0, "::parent::child", "::", "::", true));
+    test_uint(child, ecs_lookup_path_w_sep(
+        world, 0, "parent::child", "::", "::", true));
+    test_uint(0, ecs_lookup_path_w_sep(
+        world, 0, "parent::child", ".", NULL, true));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_lookup_in_scope() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t p1 = ecs_new_entity(world, "p1");
+    ecs_entity_t p2 = ecs_new_entity(world, "p2");
+    ecs_entity_t c1 = ecs_new_entity(world, "p1.child");
+    ecs_entity_t c2 = ecs_new_entity(world, "p2.child");
+
+    ecs_set_scope(world, p1);
+    test_uint(c1, ecs_lookup_fullpath(world, "child"));
+    ecs_set_scope(world, p2);
+    test_uint(c2, ecs_lookup_fullpath(world, "child"));
+    ecs_set_scope(world, p1);
+    test_uint(c1, ecs_lookup_fullpath(world, "child"));
+    ecs_set_scope(world, 0);
+    test_uint(0, ecs_lookup_fullpath(world, "child"));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_invalidate_on_rename() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t e = ecs_new_entity(world, "Foo");
+    test_uint(e, ecs_lookup_fullpath(world, "Foo"));
+    test_uint(e, ecs_lookup_fullpath(world, "Foo"));
+
+    ecs_set_name(world, e, "Bar");
+    test_uint(0, ecs_lookup_fullpath(world, "Foo"));
+    test_uint(e, ecs_lookup_fullpath(world, "Bar"));
+
+    ecs_entity_t f = ecs_new_entity(world, "Foo");
+    test_uint(f, ecs_lookup_fullpath(world, "Foo"));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_invalidate_on_reparent() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t p1 = ecs_new_entity(world, "p1");
+    ecs_entity_t p2 = ecs_new_entity(world, "p2");
+    ecs_entity_t mid = ecs_new_w_pair(world, EcsChildOf, p1);
+    ecs_entity_t child = ecs_new_w_pair(world, EcsChildOf, mid);
+    ecs_set_name(world, child, "child");
+
+    test_uint(child, ecs_lookup_path(world, mid, "child"));
+    test_uint(child, ecs_lookup_path(world, mid, "child"));
+
+    ecs_set_name(world, mid, "mid");
+    test_uint(child, ecs_lookup_fullpath(world, "p1.mid.child"));
+
+    ecs_add_pair(world, mid, EcsChildOf, p2);
+    test_uint(0, ecs_lookup_fullpath(world, "p1.mid.child"));
+    test_uint(child, ecs_lookup_fullpath(world, "p2.mid.child"));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_invalidate_on_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t parent = ecs_new_entity(world, "parent");
+    ecs_entity_t child = ecs_new_entity(world, "parent.child");
+    test_uint(child, ecs_lookup_fullpath(world, "parent.child"));
+
+    ecs_delete(world, parent);
+    test_uint(0, ecs_lookup_fullpath(world, "parent.child"));
+
+    ecs_entity_t e = ecs_new_entity(world, "parent.child");
+    test_assert(e != child);
+    test_uint(e, ecs_lookup_fullpath(world, "parent.child"));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_invalidate_on_alias() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t e = ecs_new_entity(world, "Foo");
+    ecs_entity_t f = ecs_new_entity(world, "parent.Foo");
+    test_uint(e, ecs_lookup_fullpath(world, "Foo"));
+
+    ecs_set_alias(world, f, "Foo");
+    test_uint(f, ecs_lookup_fullpath(world, "Foo"));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_shadowed_recursive() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t e = ecs_new_entity(world, "Foo");
+    ecs_entity_t parent = ecs_new_entity(world, "parent");
+    test_uint(e, ecs_lookup_path(world, parent, "Foo"));
+
+    ecs_entity_t f = ecs_new_entity(world, "parent.Foo");
+    test_uint(f, ecs_lookup_path(world, parent, "Foo"));
+    test_uint(e, ecs_lookup_path(world, 0, "Foo"));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_lookup_path_changed() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t p1 = ecs_new_entity(world, "p1");
+    ecs_entity_t p2 = ecs_new_entity(world, "p2");
+    ecs_entity_t c1 = ecs_new_entity(world, "p1.child");
+    ecs_entity_t c2 = ecs_new_entity(world, "p2.child");
+
+    ecs_entity_t lookup_path[] = { p1, 0 };
+    ecs_entity_t *old_path = ecs_set_lookup_path(world, lookup_path);
+    test_uint(c1, ecs_lookup_fullpath(world, "child"));
+
+    lookup_path[0] = p2;
+    test_uint(c2, ecs_lookup_fullpath(world, "child"));
+
+    ecs_set_lookup_path(world, old_path);
+    test_uint(0, ecs_lookup_fullpath(world, "child"));
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_disable() {
+    ecs_world_t *world = ecs_mini();
+
+    test_bool(false, ecs_enable_lookup_cache(world, true));
+    test_bool(true, ecs_enable_lookup_cache(world, true));
+
+    ecs_entity_t e = ecs_new_entity(world, "parent.child");
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t hits = info->lookup_cache_hit_total;
+    int64_t misses = info->lookup_cache_miss_total;
+
+    test_uint(e, ecs_lookup_fullpath(world, "parent.child"));
+    test_uint(e, ecs_lookup_fullpath(world, "parent.child"));
+
+    test_bool(true, ecs_enable_lookup_cache(world, false));
+    test_uint(e, ecs_lookup_fullpath(world, "parent.child"));
+
+    test_int(info->lookup_cache_hit_total, hits + 1);
+    test_int(info->lookup_cache_miss_total, misses + 1);
+
+    ecs_fini(world);
+}
+
+void Lookup_cache_readonly() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_enable_lookup_cache(world, true);
+
+    ecs_entity_t e = ecs_new_entity(world, "parent.child");
+    ecs_entity_t f = ecs_new_entity(world, "parent.other");
+    test_uint(e, ecs_lookup_fullpath(world, "parent.child"));
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t hits = info->lookup_cache_hit_total;
+    int64_t misses = info->lookup_cache_miss_total;
+
+    ecs_readonly_begin(world);
+    test_uint(e, ecs_lookup_fullpath(world, "parent.child"));
+    test_uint(f, ecs_lookup_fullpath(world, "parent.other"));
+    test_uint(f, ecs_lookup_fullpath(world, "parent.other"));
+    ecs_readonly_end(world);
+
+    /* Readonly lookups aren't counted or added to the cache */
+    test_int(info->lookup_cache_hit_total, hits);
+    test_int(info->lookup_cache_miss_total, misses);
+
+    test_uint(f, ecs_lookup_fullpath(world, "parent.other"));
+    test_int(info->lookup_cache_miss_total, misses + 1);
+
+    ecs_fini(world);
+}
@@ -4573,3 +4573,323 @@ void Observer_cache_test_15() {
 
     ecs_fini(world);
 }
+
+void Observer_on_add_deferred_batch() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_entity_t o = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = {EcsOnAdd},
+        .callback = Observer,
+        .ctx = &ctx
+    });
+    test_assert(o != 0);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e1, Position);
+    ecs_add(world, e1, Velocity);
+    ecs_add(world, e2, Position);
+    ecs_add(world, e2, Velocity);
+    ecs_add(world, e3, Position);
+    ecs_add(world, e3, Velocity);
+    test_int(ctx.invoked, 0);
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+    test_int(ctx.system, o);
+    test_int(ctx.event, EcsOnAdd);
+    test_int(ctx.e[0], e1);
+    test_int(ctx.e[1], e2);
+    test_int(ctx.e[2], e3);
+
+    test_assert(ecs_has(world, e1, Velocity));
+    test_assert(ecs_has(world, e2, Velocity));
+    test_assert(ecs_has(world, e3, Velocity));
+
+    ecs_fini(world);
+}
+
+static
+void Observer_w_batch_value(ecs_iter_t *it) {
+    probe_system_w_ctx(it, it->ctx);
+
+    Position *p = ecs_field(it, Position, 1);
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        test_int(p[i].x, it->entities[i]);
+        test_int(p[i].y, 20);
+    }
+}
+
+void Observer_on_set_deferred_batch() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_entity_t o = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = {EcsOnSet},
+        .callback = Observer_w_batch_value,
+        .ctx = &ctx
+    });
+    test_assert(o != 0);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {e1, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_set(world, e2, Position, {e2, 20});
+    ecs_set(world, e2, Velocity, {1, 2});
+    ecs_set(world, e3, Position, {e3, 20});
+    ecs_set(world, e3, Velocity, {1, 2});
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+    test_int(ctx.event, EcsOnSet);
+    test_int(ctx.e[0], e1);
+    test_int(ctx.e[1], e2);
+    test_int(ctx.e[2], e3);
+
+    const Velocity *v = ecs_get(world, e3, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+void Observer_on_set_deferred_batch_set_twice() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    Probe ctx = {0};
+    ecs_entity_t o = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = {EcsOnSet},
+        .callback = Observer_w_batch_value,
+        .ctx = &ctx
+    });
+    test_assert(o != 0);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {0, 0});
+    ecs_set(world, e1, Position, {e1, 20});
+    ecs_set(world, e2, Position, {0, 0});
+    ecs_set(world, e2, Position, {e2, 20});
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 2);
+
+    ecs_fini(world);
+}
+
+void Observer_on_add_deferred_batch_w_prefab() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    ecs_set(world, base, Position, {10, 20});
+    ecs_add_id(world, base, ECS_OVERRIDE | ecs_id(Position));
+
+    Probe ctx = {0};
+    ecs_entity_t o = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = {EcsOnAdd},
+        .callback = Observer,
+        .ctx = &ctx
+    });
+    test_assert(o != 0);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add_pair(world, e1, EcsIsA, base);
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_add_pair(world, e2, EcsIsA, base);
+    ecs_set(world, e2, Velocity, {1, 2});
+    ecs_add_pair(world, e3, EcsIsA, base);
+    ecs_set(world, e3, Velocity, {1, 2});
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+
+    ecs_entity_t e[] = {e1, e2, e3};
+    int32_t i;
+    for (i = 0; i < 3; i ++) {
+        test_assert(ecs_owns(world, e[i], Position));
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, 1);
+        test_int(v->y, 2);
+    }
+
+    ecs_fini(world);
+}
+
+void Observer_on_add_deferred_batch_different_cmds() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    Probe ctx = {0};
+    ecs_entity_t o = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = {EcsOnAdd},
+        .callback = Observer,
+        .ctx = &ctx
+    });
+    test_assert(o != 0);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e1, Position);
+    ecs_add(world, e1, Velocity);
+    ecs_add(world, e2, Position);
+    ecs_add(world, e2, Mass);
+    ecs_add(world, e3, Position);
+    ecs_add(world, e3, Mass);
+    ecs_defer_end(world);
+
+    /* e2 and e3 end up in another table than e1 */
+    test_int(ctx.invoked, 2);
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e1);
+    test_int(ctx.e[1], e2);
+    test_int(ctx.e[2], e3);
+
+    ecs_fini(world);
+}
+
+static
+void Observer_delete_2nd(ecs_iter_t *it) {
+    probe_system_w_ctx(it, it->ctx);
+
+    if (it->count > 1) {
+        ecs_delete(it->world, it->entities[1]);
+    }
+}
+
+void Observer_on_add_deferred_batch_observer_deletes() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_entity_t o = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = {EcsOnAdd},
+        .callback = Observer_delete_2nd,
+        .ctx = &ctx
+    });
+    test_assert(o != 0);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e1, Position);
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_add(world, e2, Position);
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_add(world, e3, Position);
+    ecs_set(world, e3, Velocity, {5, 6});
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 3);
+
+    test_assert(ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+    test_assert(ecs_is_alive(world, e3));
+
+    const Velocity *v = ecs_get(world, e1, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    v = ecs_get(world, e3, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 5);
+    test_int(v->y, 6);
+
+    ecs_fini(world);
+}
+
+void Observer_on_set_deferred_batch_w_modified() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_entity_t o = ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = {EcsOnSet},
+        .callback = Observer_w_batch_value,
+        .ctx = &ctx
+    });
+    test_assert(o != 0);
+
+    ecs_entity_t e[4];
+    int32_t i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_new_id(world);
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 4; i ++) {
+        ecs_add(world, e[i], Velocity);
+        Position *p = ecs_get_mut(world, e[i], Position);
+        p->x = e[i];
+        p->y = 20;
+        ecs_modified(world, e[i], Position);
+    }
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 4);
+    for (i = 0; i < 4; i ++) {
+        test_int(ctx.e[i], e[i]);
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, e[i]);
+    }
+
+    ecs_fini(world);
+}
@@ -23,6 +23,15 @@ int compare_entity(
     return (e1 > e2) - (e1 < e2);
 }
 
+static
+uint64_t key_position(
+    ecs_entity_t e,
+    const void *ptr)
+{
+    const Position *p = ptr;
+    return (uint64_t)p->x;
+}
+
 void Sorting_sort_by_component() {
     ecs_world_t *world = ecs_mini();
 
@@ -1756,3 +1765,388 @@ void Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term() {
 
     ecs_fini(world);
 }
+
+void Sorting_sort_by_key() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 5);
+
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e1);
+    test_assert(it.entities[3] == e5);
+    test_assert(it.entities[4] == e3);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_same_value() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {2, 0});
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    /* Radix sort is stable, equal keys keep their order */
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 5);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e1);
+    test_assert(it.entities[3] == e3);
+    test_assert(it.entities[4] == e5);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_3_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {6, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+    ecs_entity_t e6 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e7 = ecs_set(world, 0, Position, {7, 0});
+
+    ecs_add(world, e5, Velocity);
+    ecs_add(world, e6, Mass);
+    ecs_add(world, e7, Mass);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e1);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e5);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e6);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e3);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e7);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_shared_component() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t base_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t base_2 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t base_3 = ecs_set(world, 0, Position, {7, 0});
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {6, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+    ecs_entity_t e6 = ecs_new_w_pair(world, EcsIsA, base_3);
+    ecs_entity_t e7 = ecs_new_w_pair(world, EcsIsA, base_2);
+    ecs_entity_t e8 = ecs_new_w_pair(world, EcsIsA, base_1);
+    ecs_entity_t e9 = ecs_new_w_pair(world, EcsIsA, base_1);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position(self|up)",
+        .filter.instanced = true,
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position,
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == base_1);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_assert(it.entities[0] == e8);
+    test_assert(it.entities[1] == e9);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == base_2);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e7);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 4);
+    test_assert(it.entities[0] == e5);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e1);
+    test_assert(it.entities[3] == base_3);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e6);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_after_set() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e1);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_set(world, e2, Position, {4, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {0, 0});
+
+    it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 4);
+    test_assert(it.entities[0] == e4);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e1);
+    test_assert(it.entities[3] == e2);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_after_delete() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 4);
+    test_assert(!ecs_query_next(&it));
+
+    /* Moves the last row into the deleted slot */
+    ecs_delete(world, e2);
+
+    it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_assert(it.entities[0] == e3);
+    test_assert(it.entities[1] == e1);
+    test_assert(it.entities[2] == e4);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_wide_keys() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    /* Keys that differ in several digits, spread over two tables */
+    int i, count = 5000;
+    for (i = 0; i < count; i ++) {
+        int32_t v = rand() % 1000000;
+        ecs_entity_t e = ecs_set(world, 0, Position, {(float)v, 0});
+        if (v % 2) {
+            ecs_add(world, e, Velocity);
+        }
+    }
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    int32_t total = 0;
+    float prev = -1;
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        int32_t j;
+        for (j = 0; j < it.count; j ++) {
+            test_assert(p[j].x >= prev);
+            prev = p[j].x;
+        }
+        total += it.count;
+    }
+
+    test_int(total, count);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_match_order_by() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    /* Keys are unique within a table but every key is in each table, so the
+     * merge has to break ties between tables the same way order_by does */
+    int i;
+    for (i = 0; i < 300; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {(float)((300 - i) / 3), 0});
+        if (i % 3 == 1) {
+            ecs_add(world, e, Velocity);
+        } else if (i % 3 == 2) {
+            ecs_add(world, e, Mass);
+        }
+    }
+
+    ecs_query_t *q_key = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_entity_t key_order[300];
+    ecs_iter_t it = ecs_query_iter(world, q_key);
+    int32_t count = 0;
+    while (ecs_query_next(&it)) {
+        int32_t j;
+        for (j = 0; j < it.count; j ++) {
+            key_order[count ++] = it.entities[j];
+        }
+    }
+    test_int(count, 300);
+
+    ecs_query_t *q_cmp = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    it = ecs_query_iter(world, q_cmp);
+    count = 0;
+    while (ecs_query_next(&it)) {
+        int32_t j;
+        for (j = 0; j < it.count; j ++) {
+            test_assert(key_order[count ++] == it.entities[j]);
+        }
+    }
+    test_int(count, 300);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_entity_lookup() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e[64];
+    int i;
+    for (i = 0; i < 64; i ++) {
+        e[i] = ecs_set(world, 0, Position, {(float)((i * 37) % 64), 0});
+        ecs_set(world, e[i], Velocity, {(float)i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 64);
+    test_assert(!ecs_query_next(&it));
+
+    /* Records must follow the rows they were moved to */
+    for (i = 0; i < 64; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_assert(p != NULL);
+        test_assert(v != NULL);
+        test_int(p->x, (i * 37) % 64);
+        test_int(v->x, i);
+    }
+
+    ecs_fini(world);
+}
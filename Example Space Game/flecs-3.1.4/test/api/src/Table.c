@@ -339,3 +339,269 @@ void Table_get_depth_2_paths() {
 
     ecs_fini(world);
 }
+
+void Table_reserve() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    test_assert(table != NULL);
+    test_int(ecs_table_get_realloc_count(table), 1);
+
+    ecs_table_reserve(world, table, 100);
+    test_int(ecs_table_get_realloc_count(table), 2);
+    test_assert(ecs_has(world, e, Position));
+
+    int i;
+    for (i = 0; i < 99; i ++) {
+        ecs_new(world, Position);
+    }
+
+    test_int(ecs_table_count(table), 100);
+    test_int(ecs_table_get_realloc_count(table), 2);
+
+    ecs_fini(world);
+}
+
+void Table_reserve_less_than_reserved() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    test_assert(table != NULL);
+
+    ecs_table_reserve(world, table, 100);
+    test_int(ecs_table_get_realloc_count(table), 2);
+
+    ecs_table_reserve(world, table, 10);
+    test_int(ecs_table_get_realloc_count(table), 2);
+
+    ecs_fini(world);
+}
+
+void Table_reserve_w_component_values() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_table_t *table = ecs_get_table(world, e1);
+
+    ecs_table_reserve(world, table, 1000);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Table_reserve_delete_all() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    ecs_table_reserve(world, table, 64);
+    int32_t realloc_count = ecs_table_get_realloc_count(table);
+
+    /* Churn: fill and empty the table a few times */
+    ecs_entity_t ids[64];
+    int i, j;
+    ecs_delete(world, e);
+    for (j = 0; j < 4; j ++) {
+        for (i = 0; i < 64; i ++) {
+            ids[i] = ecs_new(world, Position);
+        }
+        for (i = 0; i < 64; i ++) {
+            ecs_delete(world, ids[i]);
+        }
+    }
+
+    test_int(ecs_table_count(table), 0);
+    test_int(ecs_table_get_realloc_count(table), realloc_count);
+
+    ecs_fini(world);
+}
+
+void Table_reserve_keep_after_delete_empty_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    ecs_table_reserve(world, table, 64);
+    ecs_delete(world, e);
+    int32_t realloc_count = ecs_table_get_realloc_count(table);
+
+    /* Table is neither deleted nor shrunk */
+    ecs_delete_empty_tables(world, 0, 0, 1, 0, 0); /* Increase to 1 */
+    ecs_delete_empty_tables(world, 0, 0, 1, 0, 0);
+    ecs_delete_empty_tables(world, 0, 1, 0, 0, 0);
+    test_int(ecs_table_get_realloc_count(table), realloc_count);
+
+    int i;
+    for (i = 0; i < 64; i ++) {
+        ecs_new(world, Position);
+    }
+
+    test_assert(ecs_get_table(world, ecs_new(world, Position)) == table);
+    test_int(ecs_table_get_realloc_count(table), realloc_count + 1);
+
+    ecs_fini(world);
+}
+
+void Table_reserve_shrink_to_reserved() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    ecs_table_reserve(world, table, 16);
+
+    /* Grow past the reservation, then empty the table */
+    ecs_entity_t ids[100];
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ids[i] = ecs_new(world, Position);
+    }
+    for (i = 0; i < 100; i ++) {
+        ecs_delete(world, ids[i]);
+    }
+    ecs_delete(world, e);
+    int32_t realloc_count = ecs_table_get_realloc_count(table);
+
+    /* Storage shrinks back to the reserved size and no further */
+    ecs_delete_empty_tables(world, 0, 1, 0, 0, 0); /* Increase to 1 */
+    test_int(ecs_table_get_realloc_count(table), realloc_count);
+    ecs_delete_empty_tables(world, 0, 1, 0, 0, 0);
+    test_int(ecs_table_get_realloc_count(table), realloc_count + 1);
+    ecs_delete_empty_tables(world, 0, 1, 0, 0, 0);
+    test_int(ecs_table_get_realloc_count(table), realloc_count + 1);
+
+    for (i = 0; i < 16; i ++) {
+        ids[i] = ecs_new(world, Position);
+    }
+    test_int(ecs_table_get_realloc_count(table), realloc_count + 1);
+
+    ecs_fini(world);
+}
+
+void Table_bulk_init_reserved() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    ecs_table_reserve(world, table, 128);
+    int32_t realloc_count = ecs_table_get_realloc_count(table);
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 100);
+    test_assert(ids != NULL);
+    test_int(ecs_table_count(table), 101);
+    test_int(ecs_table_get_realloc_count(table), realloc_count);
+
+    ecs_fini(world);
+}
+
+void Table_growth_factor() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    test_int(ecs_table_get_realloc_count(table), 1);
+
+    /* Default factor of 2 grows storage as 2, 4, 8, 16, ... 1024 */
+    int i;
+    for (i = 1; i < 1000; i ++) {
+        ecs_new(world, Position);
+    }
+    test_int(ecs_table_get_realloc_count(table), 10);
+
+    ECS_TAG(world, Tag);
+    ecs_set_table_growth_factor(world, 8);
+    e = ecs_new(world, Position);
+    ecs_add(world, e, Tag);
+    table = ecs_get_table(world, e);
+    test_int(ecs_table_get_realloc_count(table), 1);
+
+    /* A factor of 8 grows storage as 2, 16, 128, 1024 */
+    for (i = 1; i < 1000; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add(world, e, Tag);
+    }
+    test_int(ecs_table_get_realloc_count(table), 4);
+
+    ecs_fini(world);
+}
+
+void Table_growth_factor_invalid() {
+    install_test_abort();
+
+    ecs_world_t *world = ecs_mini();
+
+    test_expect_abort();
+    ecs_set_table_growth_factor(world, 1);
+}
+
+void Table_realloc_count_in_world_info() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t realloc_total = info->table_realloc_total;
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    ecs_table_reserve(world, table, 100);
+
+    test_int(info->table_realloc_total, realloc_total + 2);
+
+    ecs_fini(world);
+}
+
+void Table_storage_bytes() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    int64_t bytes = ecs_get_table_storage_bytes(world);
+    test_assert(bytes > 0);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e);
+    ecs_table_reserve(world, table, 100);
+
+    /* Entity, record and Position column for 100 rows */
+    int64_t row_size = ECS_SIZEOF(ecs_entity_t) + ECS_SIZEOF(ecs_record_t*) +
+        ECS_SIZEOF(Position);
+    int64_t with_position = ecs_get_table_storage_bytes(world);
+    test_assert(with_position >= bytes + 100 * row_size);
+
+    /* Tags have no column */
+    ECS_TAG(world, Tag);
+    ecs_add(world, e, Velocity);
+    ecs_add(world, e, Tag);
+    test_assert(ecs_get_table_storage_bytes(world) > with_position);
+
+    ecs_fini(world);
+}
@@ -743,6 +743,17 @@ void Lookup_lookup_invalid_digit(void);
 void Lookup_lookup_child_invalid_digit(void);
 void Lookup_lookup_digit_from_wrong_scope(void);
 void Lookup_lookup_core_entity_from_wrong_scope(void);
+void Lookup_cache_lookup_path(void);
+void Lookup_cache_lookup_w_sep(void);
+void Lookup_cache_lookup_in_scope(void);
+void Lookup_cache_invalidate_on_rename(void);
+void Lookup_cache_invalidate_on_reparent(void);
+void Lookup_cache_invalidate_on_delete(void);
+void Lookup_cache_invalidate_on_alias(void);
+void Lookup_cache_shadowed_recursive(void);
+void Lookup_cache_lookup_path_changed(void);
+void Lookup_cache_disable(void);
+void Lookup_cache_readonly(void);
 
 // Testsuite 'Singleton'
 void Singleton_add_singleton(void);
@@ -881,6 +892,15 @@ void Sorting_sort_relation_marked(void);
 void Sorting_dont_resort_after_set_unsorted_component(void);
 void Sorting_dont_resort_after_set_unsorted_component_w_tag(void);
 void Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term(void);
+void Sorting_sort_by_key(void);
+void Sorting_sort_by_key_same_value(void);
+void Sorting_sort_by_key_3_tables(void);
+void Sorting_sort_by_key_shared_component(void);
+void Sorting_sort_by_key_after_set(void);
+void Sorting_sort_by_key_after_delete(void);
+void Sorting_sort_by_key_wide_keys(void);
+void Sorting_sort_by_key_match_order_by(void);
+void Sorting_sort_by_key_entity_lookup(void);
 
 // Testsuite 'SortingEntireTable'
 void SortingEntireTable_sort_by_component(void);
@@ -1773,6 +1793,13 @@ void Observer_cache_test_12(void);
 void Observer_cache_test_13(void);
 void Observer_cache_test_14(void);
 void Observer_cache_test_15(void);
+void Observer_on_add_deferred_batch(void);
+void Observer_on_set_deferred_batch(void);
+void Observer_on_set_deferred_batch_set_twice(void);
+void Observer_on_add_deferred_batch_w_prefab(void);
+void Observer_on_add_deferred_batch_different_cmds(void);
+void Observer_on_add_deferred_batch_observer_deletes(void);
+void Observer_on_set_deferred_batch_w_modified(void);
 
 // Testsuite 'ObserverOnSet'
 void ObserverOnSet_set_1_of_1(void);
@@ -2212,6 +2239,13 @@ void DeferredActions_defer_existing_get_mut_no_on_set(void);
 void DeferredActions_get_mut_override(void);
 void DeferredActions_set_override(void);
 void DeferredActions_absent_get_mut_for_entity_w_tag(void);
+void DeferredActions_defer_new_add_set_delete(void);
+void DeferredActions_defer_existing_set_remove_delete(void);
+void DeferredActions_defer_new_get_mut_modified_delete(void);
+void DeferredActions_defer_existing_set_delete(void);
+void DeferredActions_defer_set_twice_collapse(void);
+void DeferredActions_defer_add_remove_collapse(void);
+void DeferredActions_defer_delete_run(void);
 
 // Testsuite 'SingleThreadStaging'
 void SingleThreadStaging_setup(void);
@@ -2315,6 +2349,17 @@ void Table_get_from_stage(void);
 void Table_get_depth(void);
 void Table_get_depth_non_acyclic(void);
 void Table_get_depth_2_paths(void);
+void Table_reserve(void);
+void Table_reserve_less_than_reserved(void);
+void Table_reserve_w_component_values(void);
+void Table_reserve_delete_all(void);
+void Table_reserve_keep_after_delete_empty_tables(void);
+void Table_reserve_shrink_to_reserved(void);
+void Table_bulk_init_reserved(void);
+void Table_growth_factor(void);
+void Table_growth_factor_invalid(void);
+void Table_realloc_count_in_world_info(void);
+void Table_storage_bytes(void);
 
 // Testsuite 'Poly'
 void Poly_iter_query(void);
@@ -5183,6 +5228,50 @@ bake_test_case Lookup_testcases[] = {
     {
         "lookup_core_entity_from_wrong_scope",
         Lookup_lookup_core_entity_from_wrong_scope
+    },
+    {
+        "cache_lookup_path",
+        Lookup_cache_lookup_path
+    },
+    {
+        "cache_lookup_w_sep",
+        Lookup_cache_lookup_w_sep
+    },
+    {
+        "cache_lookup_in_scope",
+        Lookup_cache_lookup_in_scope
+    },
+    {
+        "cache_invalidate_on_rename",
+        Lookup_cache_invalidate_on_rename
+    },
+    {
+        "cache_invalidate_on_reparent",
+        Lookup_cache_invalidate_on_reparent
+    },
+    {
+        "cache_invalidate_on_delete",
+        Lookup_cache_invalidate_on_delete
+    },
+    {
+        "cache_invalidate_on_alias",
+        Lookup_cache_invalidate_on_alias
+    },
+    {
+        "cache_shadowed_recursive",
+        Lookup_cache_shadowed_recursive
+    },
+    {
+        "cache_lookup_path_changed",
+        Lookup_cache_lookup_path_changed
+    },
+    {
+        "cache_disable",
+        Lookup_cache_disable
+    },
+    {
+        "cache_readonly",
+        Lookup_cache_readonly
     }
 };
 
@@ -5711,6 +5800,42 @@ bake_test_case Sorting_testcases[] = {
     {
         "dont_resort_after_set_unsorted_component_w_tag_w_out_term",
         Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term
+    },
+    {
+        "sort_by_key",
+        Sorting_sort_by_key
+    },
+    {
+        "sort_by_key_same_value",
+        Sorting_sort_by_key_same_value
+    },
+    {
+        "sort_by_key_3_tables",
+        Sorting_sort_by_key_3_tables
+    },
+    {
+        "sort_by_key_shared_component",
+        Sorting_sort_by_key_shared_component
+    },
+    {
+        "sort_by_key_after_set",
+        Sorting_sort_by_key_after_set
+    },
+    {
+        "sort_by_key_after_delete",
+        Sorting_sort_by_key_after_delete
+    },
+    {
+        "sort_by_key_wide_keys",
+        Sorting_sort_by_key_wide_keys
+    },
+    {
+        "sort_by_key_match_order_by",
+        Sorting_sort_by_key_match_order_by
+    },
+    {
+        "sort_by_key_entity_lookup",
+        Sorting_sort_by_key_entity_lookup
     }
 };
 
@@ -9239,6 +9364,34 @@ bake_test_case Observer_testcases[] = {
     {
         "cache_test_15",
         Observer_cache_test_15
+    },
+    {
+        "on_add_deferred_batch",
+        Observer_on_add_deferred_batch
+    },
+    {
+        "on_set_deferred_batch",
+        Observer_on_set_deferred_batch
+    },
+    {
+        "on_set_deferred_batch_set_twice",
+        Observer_on_set_deferred_batch_set_twice
+    },
+    {
+        "on_add_deferred_batch_w_prefab",
+        Observer_on_add_deferred_batch_w_prefab
+    },
+    {
+        "on_add_deferred_batch_different_cmds",
+        Observer_on_add_deferred_batch_different_cmds
+    },
+    {
+        "on_add_deferred_batch_observer_deletes",
+        Observer_on_add_deferred_batch_observer_deletes
+    },
+    {
+        "on_set_deferred_batch_w_modified",
+        Observer_on_set_deferred_batch_w_modified
     }
 };
 
@@ -10929,6 +11082,34 @@ bake_test_case DeferredActions_testcases[] = {
     {
         "absent_get_mut_for_entity_w_tag",
         DeferredActions_absent_get_mut_for_entity_w_tag
+    },
+    {
+        "defer_new_add_set_delete",
+        DeferredActions_defer_new_add_set_delete
+    },
+    {
+        "defer_existing_set_remove_delete",
+        DeferredActions_defer_existing_set_remove_delete
+    },
+    {
+        "defer_new_get_mut_modified_delete",
+        DeferredActions_defer_new_get_mut_modified_delete
+    },
+    {
+        "defer_existing_set_delete",
+        DeferredActions_defer_existing_set_delete
+    },
+    {
+        "defer_set_twice_collapse",
+        DeferredActions_defer_set_twice_collapse
+    },
+    {
+        "defer_add_remove_collapse",
+        DeferredActions_defer_add_remove_collapse
+    },
+    {
+        "defer_delete_run",
+        DeferredActions_defer_delete_run
     }
 };
 
@@ -11318,6 +11499,50 @@ bake_test_case Table_testcases[] = {
     {
         "get_depth_2_paths",
         Table_get_depth_2_paths
+    },
+    {
+        "reserve",
+        Table_reserve
+    },
+    {
+        "reserve_less_than_reserved",
+        Table_reserve_less_than_reserved
+    },
+    {
+        "reserve_w_component_values",
+        Table_reserve_w_component_values
+    },
+    {
+        "reserve_delete_all",
+        Table_reserve_delete_all
+    },
+    {
+        "reserve_keep_after_delete_empty_tables",
+        Table_reserve_keep_after_delete_empty_tables
+    },
+    {
+        "reserve_shrink_to_reserved",
+        Table_reserve_shrink_to_reserved
+    },
+    {
+        "bulk_init_reserved",
+        Table_bulk_init_reserved
+    },
+    {
+        "growth_factor",
+        Table_growth_factor
+    },
+    {
+        "growth_factor_invalid",
+        Table_growth_factor_invalid
+    },
+    {
+        "realloc_count_in_world_info",
+        Table_realloc_count_in_world_info
+    },
+    {
+        "storage_bytes",
+        Table_storage_bytes
     }
 };
 
@@ -11663,7 +11888,7 @@ static bake_test_suite suites[] = {
         "Lookup",
         Lookup_setup,
         NULL,
-        44,
+        55,
         Lookup_testcases
     },
     {
@@ -11691,7 +11916,7 @@ static bake_test_suite suites[] = {
         "Sorting",
         NULL,
         NULL,
-        33,
+        42,
         Sorting_testcases
     },
     {
@@ -11747,7 +11972,7 @@ static bake_test_suite suites[] = {
         "Observer",
         NULL,
         NULL,
-        105,
+        112,
         Observer_testcases
     },
     {
@@ -11817,7 +12042,7 @@ static bake_test_suite suites[] = {
         "DeferredActions",
         NULL,
         NULL,
-        111,
+        118,
         DeferredActions_testcases
     },
     {
@@ -11838,7 +12063,7 @@ static bake_test_suite suites[] = {
         "Table",
         NULL,
         NULL,
-        13,
+        24,
         Table_testcases
     },
     {
@@ -624,3 +624,56 @@ void Observer_get_query() {
 
     test_int(count, 3);
 }
+
+void Observer_on_set_deferred_batch_iter() {
+    flecs::world world;
+
+    int32_t invoked = 0, count = 0;
+
+    world.observer<const Position>()
+        .event(flecs::OnSet)
+        .iter([&](flecs::iter& it, const Position *p) {
+            invoked ++;
+            for (auto i : it) {
+                test_int(p[i].x, count);
+                count ++;
+            }
+        });
+
+    world.defer_begin();
+    for (int i = 0; i < 10; i ++) {
+        world.entity()
+            .set<Position>({i, 0})
+            .set<Velocity>({1, 2});
+    }
+    test_int(invoked, 0);
+    world.defer_end();
+
+    test_int(invoked, 1);
+    test_int(count, 10);
+}
+
+void Observer_on_add_deferred_batch_each() {
+    flecs::world world;
+
+    auto base = world.prefab().set_override<Position>({10, 20});
+
+    int32_t count = 0;
+
+    world.observer<const Position>()
+        .event(flecs::OnSet)
+        .each([&](flecs::entity e, const Position& p) {
+            test_assert(e.is_a(base));
+            test_int(p.x, 10);
+            test_int(p.y, 20);
+            count ++;
+        });
+
+    world.defer_begin();
+    for (int i = 0; i < 10; i ++) {
+        world.entity().is_a(base).set<Velocity>({1, 2});
+    }
+    world.defer_end();
+
+    test_int(count, 10);
+}
@@ -596,6 +596,64 @@ void System_order_by_id() {
     test_int(count, 5);
 }
 
+void System_order_by_key_type() {
+    flecs::world world;
+
+    world.entity().set<Position>({3, 0});
+    world.entity().set<Position>({1, 0});
+    world.entity().set<Position>({5, 0});
+    world.entity().set<Position>({2, 0}).add<Velocity>();
+    world.entity().set<Position>({4, 0}).add<Velocity>();
+
+    float last_val = 0;
+    int32_t count = 0;
+
+    auto sys = world.system<const Position>()
+        .order_by_key<Position>(
+            [](flecs::entity_t e, const Position *p) {
+                return static_cast<uint64_t>(p->x);
+            })
+        .each([&](flecs::entity e, const Position& p) {
+            test_assert(p.x > last_val);
+            last_val = p.x;
+            count ++;
+        });
+
+    sys.run();
+
+    test_int(count, 5);
+}
+
+void System_order_by_key_id() {
+    flecs::world world;
+
+    auto pos = world.component<Position>();
+
+    world.entity().set<Position>({3, 0});
+    world.entity().set<Position>({1, 0});
+    world.entity().set<Position>({5, 0});
+    world.entity().set<Position>({2, 0});
+    world.entity().set<Position>({4, 0});
+
+    float last_val = 0;
+    int32_t count = 0;
+
+    auto sys = world.system<const Position>()
+        .order_by_key(pos, [](flecs::entity_t e, const void *p) {
+                return static_cast<uint64_t>(
+                    static_cast<const Position*>(p)->x);
+            })
+        .each([&](flecs::entity e, const Position& p) {
+            test_assert(p.x > last_val);
+            last_val = p.x;
+            count ++;
+        });
+
+    sys.run();
+
+    test_int(count, 5);
+}
+
 void System_order_by_type_after_create() {
     flecs::world world;
 
@@ -2146,3 +2204,65 @@ void System_nested_rate_tick_source() {
     test_int(2, sys_a_invoked);
     test_int(1, sys_b_invoked);
 }
+
+namespace singleton_fini {
+    struct Pos { float x; };
+    struct Vel { float x; };
+    struct Acc { float x; };
+    struct Target { float x; };
+    struct Hostile { };
+    struct Spent { };
+}
+
+void System_fini_w_singleton_term() {
+    using namespace singleton_fini;
+
+    int32_t moved = 0, targeted = 0, removed = 0;
+
+    {
+        flecs::world world;
+
+        world.component<Target>().on_remove([&](Target&) {
+            removed ++;
+        });
+
+        world.set<Target>({1});
+
+        world.system<Vel, const Acc>()
+            .iter([&](flecs::iter& it, Vel*, const Acc*) {
+                moved += it.count();
+            });
+
+        world.system<Pos, const Target>()
+            .term_at(2).singleton()
+            .with<Vel>()
+            .with<Hostile>()
+            .without<Spent>()
+            .iter([&](flecs::iter& it, Pos*, const Target* t) {
+                test_int(t->x, 1);
+                targeted += it.count();
+            });
+
+        for (int i = 0; i < 4; i ++) {
+            auto e = world.entity()
+                .set<Pos>({0})
+                .set<Vel>({0})
+                .set<Acc>({0});
+            if (i == 0) {
+                e.add<Hostile>();
+            } else if (i == 1) {
+                e.add<Spent>();
+            }
+        }
+
+        world.progress();
+
+        test_int(moved, 4);
+        test_int(targeted, 1);
+        test_int(removed, 0);
+    }
+
+    // world cleanup removes the singleton once, and must not match tables
+    // against it after it is gone
+    test_int(removed, 1);
+}
@@ -1657,3 +1657,46 @@ void World_get_ref() {
     auto space = ecs.get_ref<Space>();
     test_int(12, space->v);
 }
+
+void World_lookup_cache() {
+    flecs::world ecs;
+
+    auto cache = ecs.lookup_cache();
+    test_bool(false, cache.enable());
+
+    auto e = ecs.entity("Parent::Child");
+    int64_t hits = cache.hit_count();
+    int64_t misses = cache.miss_count();
+
+    test_assert(ecs.lookup("Parent::Child") == e);
+    test_assert(ecs.lookup("Parent::Child") == e);
+    test_int(cache.hit_count(), hits + 1);
+    test_int(cache.miss_count(), misses + 1);
+
+    // entity() doesn't search parent scopes, so it has its own cache entry
+    test_assert(ecs.entity("Parent::Child") == e);
+    test_assert(ecs.entity("Parent::Child") == e);
+    test_int(cache.hit_count(), hits + 2);
+    test_int(cache.miss_count(), misses + 2);
+
+    test_bool(true, cache.disable());
+    test_assert(ecs.lookup("Parent::Child") == e);
+    test_int(cache.hit_count(), hits + 2);
+}
+
+void World_lookup_cache_rename() {
+    flecs::world ecs;
+
+    ecs.lookup_cache().enable();
+
+    auto e = ecs.entity("Parent::Child");
+    test_assert(ecs.lookup("Parent::Child") == e);
+
+    e.set_name("Other");
+    test_assert(ecs.lookup("Parent::Child") == 0);
+    test_assert(ecs.lookup("Parent::Other") == e);
+
+    e.child_of(ecs.entity("Grandparent"));
+    test_assert(ecs.lookup("Parent::Other") == 0);
+    test_assert(ecs.lookup("Grandparent::Other") == e);
+}
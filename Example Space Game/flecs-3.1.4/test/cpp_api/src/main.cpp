@@ -439,6 +439,9 @@ void System_startup_system(void);
 void System_interval_tick_source(void);
 void System_rate_tick_source(void);
 void System_nested_rate_tick_source(void);
+void System_fini_w_singleton_term(void);
+void System_order_by_key_type(void);
+void System_order_by_key_id(void);
 
 // Testsuite 'Event'
 void Event_evt_1_id_entity(void);
@@ -792,6 +795,8 @@ void Observer_on_add_expr(void);
 void Observer_observer_w_filter_term(void);
 void Observer_run_callback(void);
 void Observer_get_query(void);
+void Observer_on_set_deferred_batch_iter(void);
+void Observer_on_add_deferred_batch_each(void);
 
 // Testsuite 'Filter'
 void Filter_term_each_component(void);
@@ -1054,6 +1059,8 @@ void World_register_nested_w_root_name(void);
 void World_set_lookup_path(void);
 void World_run_post_frame(void);
 void World_component_w_low_id(void);
+void World_lookup_cache(void);
+void World_lookup_cache_rename(void);
 
 // Testsuite 'Singleton'
 void Singleton_set_get_singleton(void);
@@ -2826,6 +2833,18 @@ bake_test_case System_testcases[] = {
     {
         "nested_rate_tick_source",
         System_nested_rate_tick_source
+    },
+    {
+        "fini_w_singleton_term",
+        System_fini_w_singleton_term
+    },
+    {
+        "order_by_key_type",
+        System_order_by_key_type
+    },
+    {
+        "order_by_key_id",
+        System_order_by_key_id
     }
 };
 
@@ -4198,6 +4217,14 @@ bake_test_case Observer_testcases[] = {
     {
         "get_query",
         Observer_get_query
+    },
+    {
+        "on_set_deferred_batch_iter",
+        Observer_on_set_deferred_batch_iter
+    },
+    {
+        "on_add_deferred_batch_each",
+        Observer_on_add_deferred_batch_each
     }
 };
 
@@ -5206,6 +5233,14 @@ bake_test_case World_testcases[] = {
     {
         "component_w_low_id",
         World_component_w_low_id
+    },
+    {
+        "lookup_cache",
+        World_lookup_cache
+    },
+    {
+        "lookup_cache_rename",
+        World_lookup_cache_rename
     }
 };
 
@@ -5551,7 +5586,7 @@ static bake_test_suite suites[] = {
         "System",
         NULL,
         NULL,
-        64,
+        67,
         System_testcases
     },
     {
@@ -5607,7 +5642,7 @@ static bake_test_suite suites[] = {
         "Observer",
         NULL,
         NULL,
-        23,
+        25,
         Observer_testcases
     },
     {
@@ -5663,7 +5698,7 @@ static bake_test_suite suites[] = {
         "World",
         NULL,
         NULL,
-        92,
+        94,
         World_testcases
     },
     {
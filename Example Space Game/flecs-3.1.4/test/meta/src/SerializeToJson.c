@@ -4187,3 +4187,266 @@ void SerializeToJson_serialize_paged_iterator_w_vars() {
 
     ecs_fini(world);
 }
+
+void SerializeToJson_struct_string_escape_long() {
+    typedef struct {
+        char* x;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_string_t)}
+        }
+    });
+
+    T value = {"Hello World, with a \"quote\"\tand a tab"};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, 
+        "{\"x\":\"Hello World, with a \\\"quote\\\"\\tand a tab\"}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_string_long() {
+    typedef struct {
+        char* x;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_string_t)}
+        }
+    });
+
+    char str[1001];
+    ecs_os_memset(str, 'a', 1000);
+    str[1000] = '\0';
+
+    T value = {str};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_int(ecs_os_strlen(expr), 1000 + 8);
+    test_assert(!ecs_os_strncmp(expr, "{\"x\":\"aaaa", 10));
+    test_str(&expr[1000 + 4], "aa\"}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_float_round() {
+    typedef struct {
+        ecs_f64_t x;
+        ecs_f64_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_f64_t)},
+            {"y", ecs_id(ecs_f64_t)}
+        }
+    });
+
+    /* Exactly halfway between two 10 digit fractions, rounds up */
+    T value = {182.83544921875, -0.00000000005};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "{\"x\":182.8354492188, \"y\":-0.0000000001}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_double_large_fraction() {
+    typedef struct {
+        ecs_f64_t x;
+        ecs_f64_t y;
+        ecs_f64_t z;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_f64_t)},
+            {"y", ecs_id(ecs_f64_t)},
+            {"z", ecs_id(ecs_f64_t)}
+        }
+    });
+
+    /* Scaled by 10^10 these no longer fit in the 53 bit mantissa */
+    T value = {123456789.123, 9876543.21, 12345.678};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, 
+        "{\"x\":123456789.1229999959, \"y\":9876543.2100000008, \"z\":12345.678}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_entity_between_floats() {
+    typedef struct {
+        ecs_f32_t x;
+        ecs_entity_t e;
+        ecs_f32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_f32_t)},
+            {"e", ecs_id(ecs_entity_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    ecs_entity_t p = ecs_new_entity(world, "Parent");
+    ecs_entity_t c = ecs_new_entity(world, "Parent.Child");
+    test_assert(p != 0);
+
+    T value = {10.5, c, 20};
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "{\"x\":10.5, \"e\":\"Parent.Child\", \"y\":20}");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_struct_large_inline_array() {
+    typedef struct {
+        ecs_i32_t x[100];
+        ecs_i32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t), 100},
+            {"y", ecs_id(ecs_i32_t)}
+        }
+    });
+
+    T value;
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendlit(&buf, "{\"x\":[");
+    for (int i = 0; i < 100; i ++) {
+        value.x[i] = i * 3;
+        if (i) {
+            ecs_strbuf_appendlit(&buf, ", ");
+        }
+        ecs_strbuf_appendint(&buf, i * 3);
+    }
+    ecs_strbuf_appendlit(&buf, "], \"y\":-5}");
+    value.y = -5;
+    char *expect = ecs_strbuf_get(&buf);
+
+    char *expr = ecs_ptr_to_json(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, expect);
+    ecs_os_free(expr);
+    ecs_os_free(expect);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_array_struct_w_enum() {
+    typedef enum {
+        Red, Green, Blue
+    } E;
+
+    typedef struct {
+        E c;
+        ecs_u8_t v[2];
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t e = ecs_enum_init(world, &(ecs_enum_desc_t){
+        .entity = ecs_entity(world, {.name = "E"}),
+        .constants = {
+            {"Red"}, {"Green"}, {"Blue"}
+        }
+    });
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"c", e},
+            {"v", ecs_id(ecs_u8_t), 2}
+        }
+    });
+
+    T value[] = {{Red, {1, 2}}, {Blue, {3, 4}}, {Green, {255, 0}}};
+    char *expr = ecs_array_to_json(world, t, value, 3);
+    test_assert(expr != NULL);
+    test_str(expr, 
+        "[{\"c\":\"Red\", \"v\":[1, 2]}, "
+        "{\"c\":\"Blue\", \"v\":[3, 4]}, "
+        "{\"c\":\"Green\", \"v\":[255, 0]}]");
+    ecs_os_free(expr);
+
+    ecs_fini(world);
+}
+
+void SerializeToJson_array_struct_large() {
+    typedef struct {
+        ecs_i32_t x;
+        ecs_f32_t y;
+    } T;
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_struct_init(world, &(ecs_struct_desc_t){
+        .entity = ecs_entity(world, {.name = "T"}),
+        .members = {
+            {"x", ecs_id(ecs_i32_t)},
+            {"y", ecs_id(ecs_f32_t)}
+        }
+    });
+
+    /* Large enough to be written in more than one chunk */
+    int32_t i, count = 10000;
+    T *value = ecs_os_malloc_n(T, count);
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_strbuf_appendch(&buf, '[');
+    for (i = 0; i < count; i ++) {
+        value[i].x = i - 5000;
+        value[i].y = (float)i * 0.5f;
+        if (i) {
+            ecs_strbuf_appendlit(&buf, ", ");
+        }
+        ecs_strbuf_appendlit(&buf, "{\"x\":");
+        ecs_strbuf_appendint(&buf, i - 5000);
+        ecs_strbuf_appendlit(&buf, ", \"y\":");
+        ecs_strbuf_appendflt(&buf, (double)i * 0.5, '"');
+        ecs_strbuf_appendch(&buf, '}');
+    }
+    ecs_strbuf_appendch(&buf, ']');
+    char *expect = ecs_strbuf_get(&buf);
+
+    char *expr = ecs_array_to_json(world, t, value, count);
+    test_assert(expr != NULL);
+    test_str(expr, expect);
+    ecs_os_free(expr);
+    ecs_os_free(expect);
+    ecs_os_free(value);
+
+    ecs_fini(world);
+}
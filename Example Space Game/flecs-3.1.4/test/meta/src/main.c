@@ -594,6 +594,14 @@ void SerializeToJson_serialize_paged_iterator(void);
 void SerializeToJson_serialize_paged_iterator_w_optional_component(void);
 void SerializeToJson_serialize_paged_iterator_w_optional_tag(void);
 void SerializeToJson_serialize_paged_iterator_w_vars(void);
+void SerializeToJson_struct_string_escape_long(void);
+void SerializeToJson_struct_string_long(void);
+void SerializeToJson_struct_float_round(void);
+void SerializeToJson_struct_double_large_fraction(void);
+void SerializeToJson_struct_entity_between_floats(void);
+void SerializeToJson_struct_large_inline_array(void);
+void SerializeToJson_array_struct_w_enum(void);
+void SerializeToJson_array_struct_large(void);
 
 // Testsuite 'SerializeTypeInfoToJson'
 void SerializeTypeInfoToJson_bool(void);
@@ -3024,6 +3032,38 @@ bake_test_case SerializeToJson_testcases[] = {
     {
         "serialize_paged_iterator_w_vars",
         SerializeToJson_serialize_paged_iterator_w_vars
+    },
+    {
+        "struct_string_escape_long",
+        SerializeToJson_struct_string_escape_long
+    },
+    {
+        "struct_string_long",
+        SerializeToJson_struct_string_long
+    },
+    {
+        "struct_float_round",
+        SerializeToJson_struct_float_round
+    },
+    {
+        "struct_double_large_fraction",
+        SerializeToJson_struct_double_large_fraction
+    },
+    {
+        "struct_entity_between_floats",
+        SerializeToJson_struct_entity_between_floats
+    },
+    {
+        "struct_large_inline_array",
+        SerializeToJson_struct_large_inline_array
+    },
+    {
+        "array_struct_w_enum",
+        SerializeToJson_array_struct_w_enum
+    },
+    {
+        "array_struct_large",
+        SerializeToJson_array_struct_large
     }
 };
 
@@ -3719,7 +3759,7 @@ static bake_test_suite suites[] = {
         "SerializeToJson",
         NULL,
         NULL,
-        119,
+        127,
         SerializeToJson_testcases
     },
     {